@@ -143,6 +143,7 @@ COMMON_SRC = \
             sensors/adcinternal.c \
             sensors/battery.c \
             sensors/current.c \
+            sensors/esc_state.c \
             sensors/voltage.c \
             target/config_helper.c \
             fc/init.c \
@@ -170,6 +171,7 @@ COMMON_SRC = \
             flight/mixer.c \
             flight/mixer_init.c \
             flight/mixer_tricopter.c \
+            flight/nav_filter.c \
             flight/pid.c \
             flight/pid_init.c \
             flight/position.c \
@@ -255,6 +257,8 @@ COMMON_SRC = \
             io/rcdevice_cam.c \
             io/rcdevice.c \
             io/gps.c \
+            io/gps_fix.c \
+            io/gps_framer.c \
             io/ledstrip.c \
             io/pidaudio.c \
             osd/osd.c \
@@ -264,6 +268,7 @@ COMMON_SRC = \
             sensors/rangefinder.c \
             sensors/opticalflow.c \
             telemetry/telemetry.c \
+            telemetry/telemetry_sensors.c \
             telemetry/crsf.c \
             telemetry/ghst.c \
             telemetry/srxl.c \
@@ -271,8 +276,11 @@ COMMON_SRC = \
             telemetry/hott.c \
             telemetry/jetiexbus.c \
             telemetry/smartport.c \
+            telemetry/smartport_response.c \
             telemetry/ltm.c \
             telemetry/mavlink.c \
+            telemetry/mavlink_frame.c \
+            telemetry/mavlink_params.c \
             telemetry/msp_shared.c \
             telemetry/ibus.c \
             telemetry/ibus_shared.c \
@@ -468,6 +476,7 @@ SPEED_OPTIMISED_SRC += \
             scheduler/scheduler.c \
             sensors/acceleration.c \
             sensors/boardalignment.c \
+            sensors/esc_state.c \
             sensors/gyro.c \
             $(CMSIS_SRC) \
             $(DEVICE_STDPERIPH_SRC) \
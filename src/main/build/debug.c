@@ -126,4 +126,10 @@ const char * const debugModeNames[DEBUG_COUNT] = {
     [DEBUG_AUTOPILOT_POSITION] = "AUTOPILOT_POSITION",
     [DEBUG_CHIRP] = "CHIRP",
     [DEBUG_COG_PROCESSING] = "COG_PROCESSING",
+    [DEBUG_GYRO_FIFO] = "GYRO_FIFO",
+    [DEBUG_MSP_DISPLAYPORT] = "MSP_DISPLAYPORT",
+    [DEBUG_MAX7456_DRAW] = "MAX7456_DRAW",
+    [DEBUG_LED_STRIP] = "LED_STRIP",
+    [DEBUG_GPS_TIMING] = "GPS_TIMING",
+    [DEBUG_NAV_FILTER] = "NAV_FILTER",
 };
@@ -128,6 +128,12 @@ typedef enum {
     DEBUG_AUTOPILOT_POSITION,
     DEBUG_CHIRP,
     DEBUG_COG_PROCESSING,
+    DEBUG_GYRO_FIFO,
+    DEBUG_MSP_DISPLAYPORT,
+    DEBUG_MAX7456_DRAW,
+    DEBUG_LED_STRIP,
+    DEBUG_GPS_TIMING,
+    DEBUG_NAV_FILTER,
     DEBUG_COUNT
 } debugType_e;
 
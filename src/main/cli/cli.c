@@ -84,6 +84,7 @@ bool cliMode = false;
 #include "drivers/sensor.h"
 #include "drivers/serial.h"
 #include "drivers/serial_escserial.h"
+#include "drivers/serial_uart.h"
 #include "drivers/sound_beeper.h"
 #include "drivers/stack_check.h"
 #include "drivers/system.h"
@@ -164,12 +165,15 @@ bool cliMode = false;
 #include "sensors/battery.h"
 #include "sensors/boardalignment.h"
 #include "sensors/compass.h"
+#include "sensors/esc_state.h"
 #include "sensors/gyro.h"
 #include "sensors/gyro_init.h"
 #include "sensors/sensors.h"
 
 #include "telemetry/frsky_hub.h"
+#include "telemetry/smartport_response.h"
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_sensors.h"
 
 #include "cli.h"
 
@@ -714,7 +718,7 @@ static void restoreConfigs(uint16_t notToRestoreGroupId)
     configIsInCopy = false;
 }
 
-#if defined(USE_RESOURCE_MGMT) || defined(USE_TIMER_MGMT)
+#if defined(USE_RESOURCE_MGMT) || defined(USE_TIMER_MGMT) || defined(USE_UART)
 static bool isReadingConfigFromCopy(void)
 {
     return configIsInCopy;
@@ -1286,6 +1290,50 @@ static void printSerial(dumpFlags_t dumpMask, const serialConfig_t *serialConfig
     }
 }
 
+#ifdef USE_SERIAL_STATS
+static void cliSerialStats(const char *cmdName, const char *cmdline)
+{
+    const bool reset = cmdline && strcasecmp(cmdline, "reset") == 0;
+    if (!reset && !isEmpty(cmdline)) {
+        cliShowParseError(cmdName);
+        return;
+    }
+
+    cliPrintLine("# port baud rx_bytes tx_bytes rx_overruns tx_stalls rx_max/size tx_max/size rx_wait_max_us tx_max_ms");
+    for (unsigned i = 0; i < SERIAL_PORT_COUNT; i++) {
+        const serialPortUsage_t *usage = findSerialPortUsageByIdentifier(serialPortIdentifiers[i]);
+        if (!usage || !usage->serialPort) {
+            continue;
+        }
+
+        serialPort_t *port = usage->serialPort;
+        const serialPortStats_t *stats = &port->stats;
+        const uint32_t baudRate = serialGetBaudRate(port);
+        // Time taken to send the deepest transmit backlog seen, at 10 bits per byte
+        const uint32_t txMaxMs = baudRate ? (stats->txHighWater * 10000U) / baudRate : 0;
+
+        cliPrintLinef("%s %u %u %u %u %u %u/%u %u/%u %u %u",
+            serialName(usage->identifier, invalidName),
+            baudRate,
+            stats->rxBytes,
+            stats->txBytes,
+            stats->rxOverruns,
+            stats->txStalls,
+            stats->rxHighWater,
+            port->rxBufferSize,
+            stats->txHighWater,
+            port->txBufferSize,
+            stats->rxLatencyMaxUs,
+            txMaxMs
+            );
+
+        if (reset) {
+            serialResetStats(port);
+        }
+    }
+}
+#endif
+
 static void cliSerial(const char *cmdName, char *cmdline)
 {
     const char *format = "serial %s %d %ld %ld %ld %ld";
@@ -1294,6 +1342,13 @@ static void cliSerial(const char *cmdName, char *cmdline)
         return;
     }
 
+#ifdef USE_SERIAL_STATS
+    if (strncasecmp(cmdline, "stats", 5) == 0 && (cmdline[5] == '\0' || cmdline[5] == ' ')) {
+        cliSerialStats(cmdName, nextArg(cmdline));
+        return;
+    }
+#endif
+
     serialPortConfig_t portConfig;
     memset(&portConfig, 0 , sizeof(portConfig));
 
@@ -1393,6 +1448,116 @@ static void cliSerial(const char *cmdName, char *cmdline)
         );
 }
 
+#ifdef USE_UART
+static int serialBufferResourceIndex(serialPortIdentifier_e identifier)
+{
+    const serialType_e type = serialType(identifier);
+    if (type != SERIALTYPE_UART && type != SERIALTYPE_LPUART) {
+        return -1;
+    }
+    const int resourceIndex = serialResourceIndex(identifier);
+    return resourceIndex < UARTDEV_CONFIG_MAX ? resourceIndex : -1;
+}
+
+static void printSerialBuffer(dumpFlags_t dumpMask, const char *headingStr)
+{
+    const pgRegistry_t *pg = pgFind(PG_SERIAL_UART_CONFIG);
+    const serialUartConfig_t *currentConfig;
+    const serialUartConfig_t *defaultConfig;
+
+    if (isReadingConfigFromCopy()) {
+        currentConfig = (serialUartConfig_t *)pg->copy;
+        defaultConfig = (serialUartConfig_t *)pg->address;
+    } else {
+        currentConfig = (serialUartConfig_t *)pg->address;
+        defaultConfig = NULL;
+    }
+
+    const char *format = "serialbuffer %s %d %d";
+    headingStr = cliPrintSectionHeading(dumpMask, false, headingStr);
+    for (unsigned i = 0; i < SERIAL_PORT_COUNT; i++) {
+        const serialPortIdentifier_e identifier = serialPortIdentifiers[i];
+        const int resourceIndex = serialBufferResourceIndex(identifier);
+        if (resourceIndex < 0) {
+            continue;
+        }
+
+        const serialUartConfig_t *config = &currentConfig[resourceIndex];
+        bool equalsDefault = false;
+        if (defaultConfig) {
+            const serialUartConfig_t *configDefault = &defaultConfig[resourceIndex];
+            equalsDefault = config->rxBufferSize == configDefault->rxBufferSize
+                && config->txBufferSize == configDefault->txBufferSize;
+            headingStr = cliPrintSectionHeading(dumpMask, !equalsDefault, headingStr);
+            cliDefaultPrintLinef(dumpMask, equalsDefault, format,
+                serialName(identifier, invalidName),
+                configDefault->rxBufferSize,
+                configDefault->txBufferSize
+            );
+        }
+        cliDumpPrintLinef(dumpMask, equalsDefault, format,
+            serialName(identifier, invalidName),
+            config->rxBufferSize,
+            config->txBufferSize
+        );
+    }
+}
+
+// The sizes the ports were given at init, smaller than configured when the pool ran out
+static void printSerialBufferInUse(serialPortIdentifier_e identifier)
+{
+    uint16_t rxBufferSize;
+    uint16_t txBufferSize;
+    if (uartGetBufferSizes(identifier, &rxBufferSize, &txBufferSize)) {
+        cliPrintLinef("# %s in use: %d %d", serialName(identifier, invalidName), rxBufferSize, txBufferSize);
+    }
+}
+
+static void cliSerialBuffer(const char *cmdName, char *cmdline)
+{
+    if (isEmpty(cmdline)) {
+        printSerialBuffer(DUMP_MASTER, NULL);
+        for (unsigned i = 0; i < SERIAL_PORT_COUNT; i++) {
+            printSerialBufferInUse(serialPortIdentifiers[i]);
+        }
+        return;
+    }
+
+    char *ptr = cmdline;
+    const char *tok = strsep(&ptr, " ");
+    const serialPortIdentifier_e identifier = findSerialPortByName(tok, strcasecmp);
+    const int resourceIndex = serialBufferResourceIndex(identifier);
+    if (resourceIndex < 0) {
+        cliShowParseError(cmdName);
+        return;
+    }
+
+    // larger sizes than the default or the pool could never be given
+    const int maxSizes[2] = { uartRxBufferSizeMax(), uartTxBufferSizeMax() };
+    int sizes[2];
+    for (unsigned i = 0; i < ARRAYLEN(sizes); i++) {
+        tok = strsep(&ptr, " ");
+        if (!tok) {
+            cliShowInvalidArgumentCountError(cmdName);
+            return;
+        }
+        sizes[i] = atoi(tok);
+        // 0 selects the default size
+        if (sizes[i] != 0 && (sizes[i] < UART_BUFFER_SIZE_MIN || sizes[i] > maxSizes[i])) {
+            cliShowArgumentRangeError(cmdName, i == 0 ? "RX SIZE" : "TX SIZE", UART_BUFFER_SIZE_MIN, maxSizes[i]);
+            return;
+        }
+    }
+
+    serialUartConfig_t *config = serialUartConfigMutable(resourceIndex);
+    config->rxBufferSize = sizes[0];
+    config->txBufferSize = sizes[1];
+
+    cliDumpPrintLinef(0, false, "serialbuffer %s %d %d", serialName(identifier, invalidName), config->rxBufferSize, config->txBufferSize);
+    printSerialBufferInUse(identifier);
+}
+#endif
+
 #if defined(USE_SERIAL_PASSTHROUGH)
 static void cbCtrlLine_reset(void *context, uint16_t ctrl)
 {
@@ -4754,6 +4919,21 @@ static void cliStatus(const char *cmdName, char *cmdline)
 #endif
     cliPrintLinefeed();
 
+#ifdef USE_SPI
+    // Time devices spent waiting for transfers of other devices on the same SPI bus
+    for (unsigned i = 0; spiGetWaitStats(i); i++) {
+        const volatile busWaitStats_t *waitStats = spiGetWaitStats(i);
+        const extDevice_t *dev = waitStats->dev;
+        if (i == 0) {
+            cliPrintLine("SPI bus waits:");
+        }
+        cliPrintLinef(" SPI%d %s: count %u, avg %uus, max %uus",
+            SPI_DEV_TO_CFG(spiDeviceByInstance(dev->bus->busType_u.spi.instance)),
+            ownerNames[IOGetOwner(dev->busType_u.spi.csnPin)],
+            waitStats->count, waitStats->totalUs / waitStats->count, waitStats->maxUs);
+    }
+#endif
+
 #if defined(USE_SENSOR_NAMES)
     const uint32_t detectedSensorsMask = sensorsMask();
     for (uint32_t i = 0; ; i++) {
@@ -4952,6 +5132,47 @@ static void cliTasks(const char *cmdName, char *cmdline)
     }
 }
 
+#ifdef USE_TELEMETRY
+static void cliTelemetrySensors(const char *cmdName, char *cmdline)
+{
+    UNUSED(cmdName);
+    UNUSED(cmdline);
+
+    const timeUs_t currentTimeUs = micros();
+
+    cliPrintLine("      Sensor prio interval keepalive size     sent unchanged rate/hz");
+    for (telemetrySensorId_e id = 0; id < TELEMETRY_SENSOR_COUNT; id++) {
+        telemetrySensorStats_t stats;
+        telemetrySensorGetStats(id, currentTimeUs, &stats);
+        if (!stats.registered) {
+            continue;
+        }
+        const telemetrySensorInfo_t *info = telemetrySensorInfo(id);
+        cliPrintLinef("%12s %4d %8d %9d %4d %8u %9u %4d.%02d",
+            info->name, info->priority, info->intervalMs, info->keepaliveMs, stats.size,
+            stats.sent, stats.unchanged, stats.rateCentiHz / 100, stats.rateCentiHz % 100);
+    }
+}
+#endif
+
+#ifdef USE_TELEMETRY_SMARTPORT
+static void cliSmartPortStats(const char *cmdName, char *cmdline)
+{
+    UNUSED(cmdName);
+    UNUSED(cmdline);
+
+    cliPrintLine("Sensor       hits   misses");
+    const smartPortResponseStats_t *stats;
+    for (unsigned i = 0; (stats = smartPortResponseGetStats(i)); i++) {
+        if (stats->valueId == SMARTPORT_RESPONSE_ID_OTHER) {
+            cliPrintLinef("other  %9u %8u", stats->hits, stats->misses);
+        } else {
+            cliPrintLinef("0x%04x %9u %8u", stats->valueId, stats->hits, stats->misses);
+        }
+    }
+}
+#endif
+
 static void printVersion(bool printBoardInfo)
 {
     cliPrintf("# %s / %s (%s) %s %s / %s (%s) MSP API: %s",
@@ -6188,11 +6409,11 @@ static void cliDshotTelemetryInfo(const char *cmdName, char *cmdline)
         cliPrintLinefeed();
 
 #ifdef USE_DSHOT_TELEMETRY_STATS
-        cliPrintLine("Motor    Type   eRPM    RPM     Hz Invalid   TEMP    VCC   CURR  ST/EV   DBG1   DBG2   DBG3");
-        cliPrintLine("=====  ====== ====== ====== ====== ======= ====== ====== ====== ====== ====== ====== ======");
+        cliPrintLine("Motor    Type   eRPM    RPM     Hz Invalid   TEMP    VCC   CURR  ST/EV   DBG1   DBG2   DBG3 DESYNC");
+        cliPrintLine("=====  ====== ====== ====== ====== ======= ====== ====== ====== ====== ====== ====== ====== ======");
 #else
-        cliPrintLine("Motor    Type   eRPM    RPM     Hz   TEMP    VCC   CURR  ST/EV   DBG1   DBG2   DBG3");
-        cliPrintLine("=====  ====== ====== ====== ====== ====== ====== ====== ====== ====== ====== ======");
+        cliPrintLine("Motor    Type   eRPM    RPM     Hz   TEMP    VCC   CURR  ST/EV   DBG1   DBG2   DBG3 DESYNC");
+        cliPrintLine("=====  ====== ====== ====== ====== ====== ====== ====== ====== ====== ====== ====== ======");
 #endif
 
         for (uint8_t i = 0; i < getMotorCount(); i++) {
@@ -6217,7 +6438,10 @@ static void cliDshotTelemetryInfo(const char *cmdName, char *cmdline)
             }
 #endif
 
-            cliPrintLinef(" %6d %3d.%02d %6d %6d %6d %6d %6d",
+            escState_t escState;
+            const int desyncCount = escStateRead(i, &escState) ? escState.desyncCount : 0;
+
+            cliPrintLinef(" %6d %3d.%02d %6d %6d %6d %6d %6d %6d",
                     dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_TEMPERATURE],
                     dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_VOLTAGE] / 4,
                     25 * (dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_VOLTAGE] % 4),
@@ -6225,7 +6449,8 @@ static void cliDshotTelemetryInfo(const char *cmdName, char *cmdline)
                     dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_STATE_EVENTS],
                     dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_DEBUG1],
                     dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_DEBUG2],
-                    dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_DEBUG3]
+                    dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_DEBUG3],
+                    desyncCount
             );
         }
         cliPrintLinefeed();
@@ -6333,6 +6558,9 @@ static void printConfig(const char *cmdName, char *cmdline, bool doDiff)
         printFeature(dumpMask, featureConfig_Copy.enabledFeatures, featureConfig()->enabledFeatures, "feature");
 
         printSerial(dumpMask, &serialConfig_Copy, serialConfig(), "serial");
+#ifdef USE_UART
+        printSerialBuffer(dumpMask, "serialbuffer");
+#endif
 
         if (!(dumpMask & HARDWARE_ONLY)) {
 #ifndef USE_QUAD_MIXER_ONLY
@@ -6642,7 +6870,14 @@ const clicmd_t cmdTable[] = {
 #ifdef USE_SDCARD
     CLI_COMMAND_DEF("sd_info", "sdcard info", NULL, cliSdInfo),
 #endif
+#ifdef USE_SERIAL_STATS
+    CLI_COMMAND_DEF("serial", "configure serial ports or show their traffic", "<> | <port> <function> <msp baud> <gps baud> <telemetry baud> <blackbox baud> | stats [reset]", cliSerial),
+#else
     CLI_COMMAND_DEF("serial", "configure serial ports", NULL, cliSerial),
+#endif
+#ifdef USE_UART
+    CLI_COMMAND_DEF("serialbuffer", "set UART buffer sizes, 0 for default (takes effect after reboot)", "<> | <port> <rx size> <tx size>", cliSerialBuffer),
+#endif
 #if defined(USE_SERIAL_PASSTHROUGH)
 #if defined(USE_PINIO)
     CLI_COMMAND_DEF("serialpassthrough", "passthrough serial data data from port 1 to VCP / port 2", "<id1> [<baud1>] [<mode1>] [none|<dtr pinio>|reset] [<id2>] [<baud2>] [<mode2>]", cliSerialPassthrough),
@@ -6665,9 +6900,15 @@ const clicmd_t cmdTable[] = {
         "\treset\r\n"
         "\tload <mixer>\r\n"
         "\treverse <servo> <source> r|n", cliServoMix),
+#endif
+#ifdef USE_TELEMETRY_SMARTPORT
+    CLI_COMMAND_DEF("smartport_stats", "show SmartPort and FPort telemetry responses sent and missed", NULL, cliSmartPortStats),
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
+#ifdef USE_TELEMETRY
+    CLI_COMMAND_DEF("telemetry_sensors", "show telemetry sensor schedule", NULL, cliTelemetrySensors),
+#endif
 #ifdef USE_TIMER_MGMT
     CLI_COMMAND_DEF("timer", "show/set timers", "<> | <pin> list | <pin> [af<alternate function>|none|<option(deprecated)>] | list | show", cliTimer),
 #endif
@@ -46,6 +46,7 @@
 #include "cms/cms_menu_quick.h"
 #include "cms/cms_types.h"
 
+#include "common/crc.h"
 #include "common/maths.h"
 #include "common/typeconversion.h"
 
@@ -380,6 +381,12 @@ static int cmsDisplayWrite(displayPort_t *instance, uint8_t x, uint8_t y, uint8_
     return displayWrite(instance, x, y, attr, buffer);
 }
 
+// Hash of the value last written to each screen row, zero if unknown. Polled values are only
+// sent to the display when they change, which matters for displays on a telemetry link.
+static uint32_t runtimeValueHash[CMS_MAX_ROWS];
+// Whether the slider marker is shown on each screen row
+static bool runtimeSliderOverride[CMS_MAX_ROWS];
+
 static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row, uint8_t maxSize)
 {
     int colpos;
@@ -391,6 +398,19 @@ static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row
 #else
     colpos = smallScreen ? rightMenuColumn - maxSize : rightMenuColumn;
 #endif
+
+    if (row < CMS_MAX_ROWS) {
+        uint32_t hash = fnv_update(FNV_OFFSET_BASIS, &colpos, sizeof(colpos));
+        hash = fnv_update(hash, buff, strlen(buff));
+        if (hash == 0) {
+            hash = 1; // zero marks the row as unknown
+        }
+        if (hash == runtimeValueHash[row]) {
+            return 0;
+        }
+        runtimeValueHash[row] = hash;
+    }
+
     cnt = cmsDisplayWrite(pDisplay, colpos, row, DISPLAYPORT_SEVERITY_NORMAL, buff);
     return cnt;
 }
@@ -727,6 +747,8 @@ static void cmsDrawMenu(displayPort_t *pDisplay, uint32_t currentTimeUs)
     uint32_t room = displayTxBytesFree(pDisplay);
 
     if (displayWasCleared) {
+        memset(runtimeValueHash, 0, sizeof(runtimeValueHash));
+        memset(runtimeSliderOverride, 0, sizeof(runtimeSliderOverride));
         for (p = pageTop, i= 0; (p <= pageTop + pageMaxRow); p++, i++) {
             SET_PRINTLABEL(runtimeEntryFlags[i]);
             SET_PRINTVALUE(runtimeEntryFlags[i]);
@@ -786,9 +808,12 @@ static void cmsDrawMenu(displayPort_t *pDisplay, uint32_t currentTimeUs)
             }
         }
 
-        // Highlight values overridden by sliders
-        if (rowSliderOverride(p->flags)) {
-            displayWriteChar(pDisplay, leftMenuColumn - 1, top + i * linesPerMenuItem, DISPLAYPORT_SEVERITY_NORMAL, 'S');
+        // Highlight values overridden by sliders, checked on every pass as the sliders can be
+        // switched while the menu is shown, but only written when the marker changes
+        const bool sliderOverride = rowSliderOverride(p->flags);
+        if (sliderOverride != runtimeSliderOverride[i]) {
+            displayWriteChar(pDisplay, leftMenuColumn - 1, top + i * linesPerMenuItem, DISPLAYPORT_SEVERITY_NORMAL, sliderOverride ? 'S' : ' ');
+            runtimeSliderOverride[i] = sliderOverride;
         }
 
     // Print values
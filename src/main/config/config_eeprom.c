@@ -44,6 +44,15 @@
 #include "drivers/flash/flash.h"
 #include "drivers/system.h"
 
+#if defined(CONFIG_IN_FLASH) || defined(CONFIG_IN_FILE)
+// Config storage that can be programmed in place after the last write. Saves append the changed PGs
+// to a journal behind the snapshot and only rewrite (and erase) when the journal runs out of space.
+#define USE_CONFIG_JOURNAL
+#define CONFIG_BANK_COUNT       2
+#else
+#define CONFIG_BANK_COUNT       1
+#endif
+
 static uint16_t eepromConfigSize;
 
 typedef enum {
@@ -55,10 +64,13 @@ typedef enum {
 #define CRC_START_VALUE         0xFFFF
 #define CRC_CHECK_VALUE         0x1D0F  // pre-calculated value of CRC that includes the CRC itself
 
+#define CONFIG_JOURNAL_MAGIC    0x4A
+
 // Header for the saved copy.
 typedef struct {
     uint8_t eepromConfigVersion;
     uint8_t magic_be;           // magic number, should be 0xBE
+    uint16_t generation;        // incremented on every full write, the valid bank with the newest generation is used
 } PG_PACKED configHeader_t;
 
 // Header for each stored PG.
@@ -80,6 +92,25 @@ typedef struct {
 } PG_PACKED configFooter_t;
 // checksum is appended just after footer. It is not included in footer to make checksum calculation consistent
 
+// Header for each journal entry appended after the saved copy.
+// An entry holds the records of the PGs changed by one save, followed by a checksum. The checksum is seeded with
+// the checksum of the previous entry (or the saved copy) so that stale entries from an older copy are rejected.
+typedef struct {
+    uint16_t size;              // size of the entry including header, records and checksum, excluding padding
+    uint8_t magic;              // CONFIG_JOURNAL_MAGIC, erased flash terminates the journal
+    uint8_t reserved;
+} PG_PACKED configJournalHeader_t;
+
+// Location of a valid saved copy and its journal.
+typedef struct {
+    const uint8_t *start;       // header of the saved copy
+    const uint8_t *recordsEnd;  // footer of the saved copy
+    const uint8_t *journalStart;
+    const uint8_t *journalEnd;  // first byte after the last valid journal entry
+    uint16_t generation;
+    uint16_t chainCrc;          // stored checksum of the last valid entry, seeds the next one
+} configBank_t;
+
 // Used to check the compiler packing at build time.
 typedef struct {
     uint8_t byte;
@@ -295,6 +326,7 @@ void initEEPROM(void)
 
     STATIC_ASSERT(sizeof(configFooter_t) == 2, footer_size_failed);
     STATIC_ASSERT(sizeof(configRecord_t) == 6, record_size_failed);
+    STATIC_ASSERT(sizeof(configJournalHeader_t) == 4, journal_header_size_failed);
 
 #if defined(CONFIG_IN_FILE)
     bool eepromLoaded = loadEEPROMFromFile();
@@ -317,22 +349,84 @@ void initEEPROM(void)
 #endif
 }
 
-bool isEEPROMVersionValid(void)
+static size_t configStorageSize(void)
 {
-    const uint8_t *p = &__config_start;
-    const configHeader_t *header = (const configHeader_t *)p;
+    return &__config_end - &__config_start;
+}
 
-    if (header->eepromConfigVersion != EEPROM_CONF_VERSION) {
-        return false;
+// The storage is split into two erase-aligned banks when it spans more than one flash page,
+// so that a full write never erases the copy that is currently in use.
+static size_t configBankSize(void)
+{
+#ifdef USE_CONFIG_JOURNAL
+    const size_t halfSize = configStorageSize() / 2;
+    if (halfSize >= FLASH_PAGE_SIZE) {
+        return halfSize - (halfSize % FLASH_PAGE_SIZE);
     }
+#endif
+    return configStorageSize();
+}
 
-    return true;
+static size_t configPaddedSize(size_t size)
+{
+    return (size + CONFIG_STREAMER_BUFFER_SIZE - 1) / CONFIG_STREAMER_BUFFER_SIZE * CONFIG_STREAMER_BUFFER_SIZE;
 }
 
-// Scan the EEPROM config. Returns true if the config is valid.
-bool isEEPROMStructureValid(void)
+static size_t configSnapshotSize(void)
+{
+    size_t size = sizeof(configHeader_t) + sizeof(configFooter_t) + sizeof(uint16_t);
+    PG_FOREACH(reg) {
+        size += sizeof(configRecord_t) + pgSize(reg);
+    }
+    return configPaddedSize(size);
+}
+
+// Banks only alternate when a complete copy fits into one of them, otherwise the first bank spans the whole storage.
+static bool configBanksAlternate(void)
+{
+    return configBankSize() < configStorageSize() && configSnapshotSize() <= configBankSize();
+}
+
+static bool isRecordValid(const uint8_t *p, const uint8_t *end)
+{
+    const configRecord_t *record = (const configRecord_t *)p;
+
+    return p + sizeof(*record) <= end
+        && record->size >= sizeof(*record)
+        && p + record->size <= end;
+}
+
+#ifdef USE_CONFIG_JOURNAL
+static const uint8_t *scanJournal(configBank_t *bank)
+{
+    const uint8_t *p = bank->journalStart;
+
+    while (p + sizeof(configJournalHeader_t) + sizeof(uint16_t) <= &__config_end) {
+        const configJournalHeader_t *entry = (const configJournalHeader_t *)p;
+
+        if (entry->magic != CONFIG_JOURNAL_MAGIC
+            || entry->size < sizeof(*entry) + sizeof(uint16_t)
+            || p + entry->size > &__config_end) {
+            break;
+        }
+
+        if (crc16_ccitt_update(bank->chainCrc, p, entry->size) != CRC_CHECK_VALUE) {
+            // Incomplete or stale entry, the journal ends here.
+            break;
+        }
+
+        bank->chainCrc = *(const uint16_t *)(p + entry->size - sizeof(uint16_t));
+        p += configPaddedSize(entry->size);
+    }
+
+    return p;
+}
+#endif
+
+// Check the saved copy at start and locate the end of its journal. Returns true if the copy is valid.
+static bool scanBank(configBank_t *bank, const uint8_t *start)
 {
-    const uint8_t *p = &__config_start;
+    const uint8_t *p = start;
     const configHeader_t *header = (const configHeader_t *)p;
 
     if (header->magic_be != 0xBE) {
@@ -361,6 +455,8 @@ bool isEEPROMStructureValid(void)
         p += record->size;
     }
 
+    bank->recordsEnd = p;
+
     const configFooter_t *footer = (const configFooter_t *)p;
     crc = crc16_ccitt_update(crc, footer, sizeof(*footer));
     p += sizeof(*footer);
@@ -368,12 +464,72 @@ bool isEEPROMStructureValid(void)
     // include stored CRC in the CRC calculation
     const uint16_t *storedCrc = (const uint16_t *)p;
     crc = crc16_ccitt_update(crc, storedCrc, sizeof(*storedCrc));
-    p += sizeof(storedCrc);
-
-    eepromConfigSize = p - &__config_start;
+    p += sizeof(*storedCrc);
 
     // CRC has the property that if the CRC itself is included in the calculation the resulting CRC will have constant value
-    return crc == CRC_CHECK_VALUE;
+    if (crc != CRC_CHECK_VALUE) {
+        return false;
+    }
+
+    bank->start = start;
+    bank->generation = header->generation;
+    bank->chainCrc = *storedCrc;
+    bank->journalStart = start + configPaddedSize(p - start);
+#ifdef USE_CONFIG_JOURNAL
+    bank->journalEnd = scanJournal(bank);
+#else
+    bank->journalEnd = bank->journalStart;
+#endif
+
+    return true;
+}
+
+// Find the valid bank with the newest generation. Returns false if there is none.
+static bool findActiveBank(configBank_t *bank)
+{
+    bool found = false;
+    const uint8_t *start = &__config_start;
+
+    for (int i = 0; i < CONFIG_BANK_COUNT && start + sizeof(configHeader_t) < &__config_end; i++) {
+        configBank_t candidate;
+        if (scanBank(&candidate, start)
+            && (!found || (int16_t)(candidate.generation - bank->generation) > 0)) {
+            *bank = candidate;
+            found = true;
+        }
+        start += configBankSize();
+    }
+
+    return found;
+}
+
+bool isEEPROMVersionValid(void)
+{
+    configBank_t bank;
+    if (!findActiveBank(&bank)) {
+        return false;
+    }
+
+    const configHeader_t *header = (const configHeader_t *)bank.start;
+
+    if (header->eepromConfigVersion != EEPROM_CONF_VERSION) {
+        return false;
+    }
+
+    return true;
+}
+
+// Scan the EEPROM config. Returns true if the config is valid.
+bool isEEPROMStructureValid(void)
+{
+    configBank_t bank;
+    if (!findActiveBank(&bank)) {
+        return false;
+    }
+
+    eepromConfigSize = bank.journalEnd - bank.start;
+
+    return true;
 }
 
 uint16_t getEEPROMConfigSize(void)
@@ -395,26 +551,40 @@ size_t getEEPROMStorageSize(void)
 #endif
 }
 
-// find config record for reg + classification (profile info) in EEPROM
-// return NULL when record is not found
-// this function assumes that EEPROM content is valid
-static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFlags_e classification)
+// find the last config record for reg + classification (profile info) in [p, end)
+static const configRecord_t *findRecord(const uint8_t *p, const uint8_t *end, const pgRegistry_t *reg, configRecordFlags_e classification)
 {
-    const uint8_t *p = &__config_start;
-    p += sizeof(configHeader_t);             // skip header
-    while (true) {
+    const configRecord_t *found = NULL;
+    while (isRecordValid(p, end)) {
         const configRecord_t *record = (const configRecord_t *)p;
-        if (record->size == 0
-            || p + record->size >= &__config_end
-            || record->size < sizeof(*record))
-            break;
         if (pgN(reg) == record->pgn
-            && (record->flags & CR_CLASSIFICATION_MASK) == classification)
-            return record;
+            && (record->flags & CR_CLASSIFICATION_MASK) == classification) {
+            found = record;
+        }
         p += record->size;
     }
-    // record not found
-    return NULL;
+    return found;
+}
+
+// find config record for reg + classification (profile info) in EEPROM, journal entries override the saved copy
+// return NULL when record is not found
+// this function assumes that EEPROM content is valid
+static const configRecord_t *findEEPROM(const configBank_t *bank, const pgRegistry_t *reg, configRecordFlags_e classification)
+{
+    const configRecord_t *found = findRecord(bank->start + sizeof(configHeader_t), bank->recordsEnd, reg, classification);
+
+#ifdef USE_CONFIG_JOURNAL
+    for (const uint8_t *p = bank->journalStart; p < bank->journalEnd; ) {
+        const configJournalHeader_t *entry = (const configJournalHeader_t *)p;
+        const configRecord_t *record = findRecord(p + sizeof(*entry), p + entry->size - sizeof(uint16_t), reg, classification);
+        if (record) {
+            found = record;
+        }
+        p += configPaddedSize(entry->size);
+    }
+#endif
+
+    return found;
 }
 
 // Initialize all PG records from EEPROM.
@@ -424,8 +594,11 @@ bool loadEEPROM(void)
 {
     bool success = true;
 
+    configBank_t bank;
+    const bool bankFound = findActiveBank(&bank);
+
     PG_FOREACH(reg) {
-        const configRecord_t *rec = findEEPROM(reg, CR_CLASSICATION_SYSTEM);
+        const configRecord_t *rec = bankFound ? findEEPROM(&bank, reg, CR_CLASSICATION_SYSTEM) : NULL;
         if (rec) {
             // config from EEPROM is available, use it to initialize PG. pgLoad will handle version mismatch
             if (!pgLoad(reg, rec->pg, rec->size - offsetof(configRecord_t, pg), rec->version)) {
@@ -442,64 +615,189 @@ bool loadEEPROM(void)
     return success;
 }
 
-static bool writeSettingsToEEPROM(void)
+static bool isPgChanged(const pgRegistry_t *reg)
+{
+    return *reg->fnv_hash != fnv_update(FNV_OFFSET_BASIS, reg->address, pgSize(reg));
+}
+
+static uint16_t writeRecordToEEPROM(config_streamer_t *streamer, const pgRegistry_t *reg, uint16_t crc)
+{
+    const uint16_t regSize = pgSize(reg);
+    configRecord_t record = {
+        .size = sizeof(configRecord_t) + regSize,
+        .pgn = pgN(reg),
+        .version = pgVersion(reg),
+        .flags = 0,
+    };
+
+    record.flags |= CR_CLASSICATION_SYSTEM;
+    config_streamer_write(streamer, (uint8_t *)&record, sizeof(record));
+    crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
+    config_streamer_write(streamer, reg->address, regSize);
+    crc = crc16_ccitt_update(crc, reg->address, regSize);
+
+    return crc;
+}
+
+static void writeCrcToEEPROM(config_streamer_t *streamer, uint16_t crc)
+{
+    // include inverted CRC in big endian format in the CRC
+    const uint16_t invertedBigEndianCrc = ~(((crc & 0xFF) << 8) | (crc >> 8));
+    config_streamer_write(streamer, (uint8_t *)&invertedBigEndianCrc, sizeof(crc));
+}
+
+// Write a complete copy of all PGs. The copy goes into the bank that is not in use if the banks alternate.
+static bool writeSnapshotToEEPROM(const configBank_t *activeBank)
 {
-    bool dirtyConfig = !isEEPROMVersionValid() || !isEEPROMStructureValid();
+    const uint8_t *start = &__config_start;
+    if (activeBank && activeBank->start == &__config_start && configBanksAlternate()) {
+        start += configBankSize();
+    }
 
     configHeader_t header = {
         .eepromConfigVersion =  EEPROM_CONF_VERSION,
         .magic_be =             0xBE,
+        .generation =           activeBank ? activeBank->generation + 1 : 0,
     };
 
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
+
+    config_streamer_start(&streamer, (uintptr_t)start, &__config_end - start);
+
+    config_streamer_write(&streamer, (uint8_t *)&header, sizeof(header));
+    uint16_t crc = CRC_START_VALUE;
+    crc = crc16_ccitt_update(crc, (uint8_t *)&header, sizeof(header));
     PG_FOREACH(reg) {
-        if (*reg->fnv_hash != fnv_update(FNV_OFFSET_BASIS, reg->address, pgSize(reg))) {
-            dirtyConfig = true;
+        crc = writeRecordToEEPROM(&streamer, reg, crc);
+    }
+
+    configFooter_t footer = {
+        .terminator = 0,
+    };
+
+    config_streamer_write(&streamer, (uint8_t *)&footer, sizeof(footer));
+    crc = crc16_ccitt_update(crc, (uint8_t *)&footer, sizeof(footer));
+
+    writeCrcToEEPROM(&streamer, crc);
+
+    config_streamer_flush(&streamer);
+
+    if (config_streamer_finish(&streamer) != 0) {
+        return false;
+    }
+
+    // The previous copy stays valid, make sure the new one took over.
+    configBank_t written;
+    return findActiveBank(&written)
+        && written.start == start
+        && written.generation == header.generation;
+}
+
+#ifdef USE_CONFIG_JOURNAL
+// Flash can only be programmed where it is erased. The streamer erases each page it enters at the page boundary.
+static bool isEEPROMAreaErased(const uint8_t *p, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        if ((p + i - &__config_start) % FLASH_PAGE_SIZE == 0) {
+            break;
+        }
+        if (p[i] != CONFIG_ERASED_BYTE) {
+            return false;
         }
     }
 
-    // Only write the config if it has changed
-    if (dirtyConfig) {
-        config_streamer_t streamer;
-        config_streamer_init(&streamer);
+    return true;
+}
 
-        config_streamer_start(&streamer, (uintptr_t)&__config_start, &__config_end - &__config_start);
+// Append the changed PGs to the journal of the active bank.
+// Returns false if there is no room or the write could not be verified, a full write is needed then.
+static bool appendSettingsToJournal(const configBank_t *bank)
+{
+    const uint8_t *limit;
+    if (configBanksAlternate()) {
+        limit = bank->start + configBankSize();
+    } else if (bank->start == &__config_start) {
+        limit = &__config_end;
+    } else {
+        // left behind by a different bank layout
+        return false;
+    }
 
-        config_streamer_write(&streamer, (uint8_t *)&header, sizeof(header));
-        uint16_t crc = CRC_START_VALUE;
-        crc = crc16_ccitt_update(crc, (uint8_t *)&header, sizeof(header));
-        PG_FOREACH(reg) {
-            const uint16_t regSize = pgSize(reg);
-            configRecord_t record = {
-                .size = sizeof(configRecord_t) + regSize,
-                .pgn = pgN(reg),
-                .version = pgVersion(reg),
-                .flags = 0,
-            };
-
-            record.flags |= CR_CLASSICATION_SYSTEM;
-            config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record));
-            crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
-            config_streamer_write(&streamer, reg->address, regSize);
-            crc = crc16_ccitt_update(crc, reg->address, regSize);
+    configJournalHeader_t header = {
+        .size = sizeof(configJournalHeader_t) + sizeof(uint16_t),
+        .magic = CONFIG_JOURNAL_MAGIC,
+        .reserved = 0,
+    };
+    PG_FOREACH(reg) {
+        if (isPgChanged(reg)) {
+            header.size += sizeof(configRecord_t) + pgSize(reg);
         }
+    }
 
-        configFooter_t footer = {
-            .terminator = 0,
-        };
+    const uint8_t *entryStart = bank->journalEnd;
+    const size_t paddedSize = configPaddedSize(header.size);
 
-        config_streamer_write(&streamer, (uint8_t *)&footer, sizeof(footer));
-        crc = crc16_ccitt_update(crc, (uint8_t *)&footer, sizeof(footer));
+    if (entryStart + paddedSize > limit || !isEEPROMAreaErased(entryStart, paddedSize)) {
+        return false;
+    }
 
-        // include inverted CRC in big endian format in the CRC
-        const uint16_t invertedBigEndianCrc = ~(((crc & 0xFF) << 8) | (crc >> 8));
-        config_streamer_write(&streamer, (uint8_t *)&invertedBigEndianCrc, sizeof(crc));
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
 
-        config_streamer_flush(&streamer);
+    config_streamer_start(&streamer, (uintptr_t)entryStart, limit - entryStart);
 
-        return (config_streamer_finish(&streamer) == 0);
-    } else {
+    config_streamer_write(&streamer, (uint8_t *)&header, sizeof(header));
+    uint16_t crc = crc16_ccitt_update(bank->chainCrc, (uint8_t *)&header, sizeof(header));
+    PG_FOREACH(reg) {
+        if (isPgChanged(reg)) {
+            crc = writeRecordToEEPROM(&streamer, reg, crc);
+        }
+    }
+
+    writeCrcToEEPROM(&streamer, crc);
+
+    config_streamer_flush(&streamer);
+
+    if (config_streamer_finish(&streamer) != 0) {
+        return false;
+    }
+
+    // The entry only counts if it extends the journal of the bank that is still in use.
+    configBank_t written;
+    return findActiveBank(&written)
+        && written.start == bank->start
+        && written.journalEnd == entryStart + paddedSize;
+}
+#endif
+
+static bool writeSettingsToEEPROM(void)
+{
+    configBank_t bank;
+    const bool bankFound = findActiveBank(&bank);
+    const bool bankValid = bankFound
+        && ((const configHeader_t *)bank.start)->eepromConfigVersion == EEPROM_CONF_VERSION;
+
+    bool dirtyConfig = !bankValid;
+
+    PG_FOREACH(reg) {
+        if (isPgChanged(reg)) {
+            dirtyConfig = true;
+        }
+    }
+
+    // Only write the config if it has changed
+    if (!dirtyConfig) {
         return true;
     }
+
+#ifdef USE_CONFIG_JOURNAL
+    if (bankValid && appendSettingsToJournal(&bank)) {
+        return true;
+    }
+#endif
+
+    return writeSnapshotToEEPROM(bankFound ? &bank : NULL);
 }
 
 void writeConfigToEEPROM(void)
@@ -522,6 +820,10 @@ void writeConfigToEEPROM(void)
     }
 
     if (success) {
+        // the stored config now matches RAM, later saves only need to write what changes from here
+        PG_FOREACH(reg) {
+            *reg->fnv_hash = fnv_update(FNV_OFFSET_BASIS, reg->address, pgSize(reg));
+        }
         return;
     }
 
@@ -21,5 +21,8 @@
 
 #pragma once
 
+// Value of erased config storage, the journal is only appended where the storage still reads as erased
+#define CONFIG_ERASED_BYTE 0xFF
+
 // TODO: potentially move sdcard and external flash also
 bool loadEEPROMFromFile(void);
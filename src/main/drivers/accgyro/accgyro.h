@@ -41,6 +41,12 @@
 #define GYRO_SCALE_2000DPS (2000.0f / (1 << 15))   // 16.384 dps/lsb scalefactor for 2000dps sensors
 #define GYRO_SCALE_4000DPS (4000.0f / (1 << 15))   //  8.192 dps/lsb scalefactor for 4000dps sensors
 
+#ifdef USE_GYRO_FIFO
+#define GYRO_FIFO_MAX_SAMPLES 8
+// Command byte, up to three status bytes and GYRO_FIFO_MAX_SAMPLES frames of at most 8 bytes
+#define GYRO_FIFO_BUF_SIZE (4 + GYRO_FIFO_MAX_SAMPLES * 8)
+#endif
+
 // Gyro hardware types were updated in PR #14087 (removed GYRO_L3G4200D, GYRO_MPU3050)
 typedef enum {
     GYRO_NONE = 0,
@@ -117,7 +123,7 @@ typedef struct gyroDev_s {
     uint32_t gyroSyncEXTI;
     int32_t gyroShortPeriod;
     int32_t gyroDmaMaxDuration;
-    busSegment_t segments[2];
+    busSegment_t segments[3];                                // the FIFO burst read uses two segments plus the terminator
     volatile bool dataReady;
     bool gyro_high_fsr;
     uint8_t hardware_lpf;
@@ -131,6 +137,13 @@ typedef struct gyroDev_s {
     uint16_t accSampleRateHz;
     uint8_t accDataReg;
     uint8_t gyroDataReg;
+#ifdef USE_GYRO_FIFO
+    uint8_t *fifoBuf;                                        // DMA buffer for FIFO burst reads
+    uint32_t fifoTimestamp;                                  // cycle count at which the last burst was triggered, the newest sample was taken just before
+    uint8_t fifoDepth;                                       // samples read per FIFO burst, 0 if the FIFO isn't used
+    uint8_t fifoCount;                                       // samples decoded from the last burst, oldest first
+    int16_t fifoSamples[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT];
+#endif
 } gyroDev_t;
 
 typedef struct accDev_s {
@@ -216,7 +216,15 @@ bool mpuGyroRead(gyroDev_t *gyro)
 #ifdef USE_SPI_GYRO
 bool mpuAccReadSPI(accDev_t *acc)
 {
-    switch (acc->gyro->gyroModeSPI) {
+    gyroModeSPI_e gyroModeSPI = acc->gyro->gyroModeSPI;
+#ifdef USE_GYRO_FIFO
+    // The gyro burst only reads the FIFO, so the acc registers have to be read separately
+    if (acc->gyro->fifoDepth && gyroModeSPI == GYRO_EXTI_INT_DMA) {
+        gyroModeSPI = GYRO_EXTI_INT;
+    }
+#endif
+
+    switch (gyroModeSPI) {
     case GYRO_EXTI_INT:
     case GYRO_EXTI_NO_INT:
     {
@@ -338,6 +346,78 @@ bool mpuGyroReadSPI(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_FIFO
+// Called once the gyro interrupt has been checked, in place of the GYRO_EXTI_INIT handling of mpuGyroReadSPI().
+// Sets up a burst read of len bytes starting at reg into fifoBuf[1], triggered by the FIFO interrupt if DMA is available.
+void mpuGyroFifoInit(gyroDev_t *gyro, uint8_t reg, uint8_t len)
+{
+    gyro->fifoBuf[0] = reg | 0x80;
+    gyro->fifoCount = 0;
+
+    // The register address is sent from the first segment, the FIFO contents are then clocked out without a tx buffer
+    gyro->segments[0].u.buffers.txData = gyro->fifoBuf;
+    gyro->segments[0].u.buffers.rxData = NULL;
+    gyro->segments[0].len = sizeof(uint8_t);
+    gyro->segments[0].negateCS = false;
+    gyro->segments[0].callback = NULL;
+
+    gyro->segments[1].u.buffers.txData = NULL;
+    gyro->segments[1].u.buffers.rxData = &gyro->fifoBuf[1];
+    gyro->segments[1].len = len;
+    gyro->segments[1].negateCS = true;
+    gyro->segments[1].callback = NULL;
+
+    // We need some offset from the gyro interrupts to ensure sampling after the interrupt
+    gyro->gyroDmaMaxDuration = 5;
+    if (gyro->detectedEXTI > GYRO_EXTI_DETECT_THRESHOLD) {
+#ifdef USE_DMA
+        if (spiUseDMA(&gyro->dev)) {
+            gyro->dev.callbackArg = (uint32_t)gyro;
+            gyro->segments[1].callback = mpuIntCallback;
+            gyro->gyroModeSPI = GYRO_EXTI_INT_DMA;
+        } else
+#endif
+        {
+            // Interrupts are present, but no DMA
+            gyro->gyroModeSPI = GYRO_EXTI_INT;
+        }
+    } else {
+        gyro->gyroModeSPI = GYRO_EXTI_NO_INT;
+    }
+}
+
+// Returns true if fifoBuf holds a burst which hasn't been decoded yet
+bool mpuGyroFifoRead(gyroDev_t *gyro)
+{
+    switch (gyro->gyroModeSPI) {
+    case GYRO_EXTI_INT:
+    case GYRO_EXTI_NO_INT:
+        gyro->fifoTimestamp = getCycleCounter();
+
+        spiSequence(&gyro->dev, gyro->segments);
+
+        // Wait for completion
+        spiWait(&gyro->dev);
+
+        return true;
+
+    case GYRO_EXTI_INT_DMA:
+        // The burst was started by the FIFO interrupt
+        if (!gyro->dataReady) {
+            return false;
+        }
+        gyro->dataReady = false;
+        gyro->fifoTimestamp = gyro->gyroLastEXTI;
+
+        return true;
+
+    case GYRO_EXTI_INIT:
+    default:
+        return false;
+    }
+}
+#endif
+
 typedef uint8_t (*gyroSpiDetectFn_t)(const extDevice_t *dev);
 
 static gyroSpiDetectFn_t gyroSpiDetectFnTable[] = {
@@ -383,6 +463,9 @@ static bool detectSPISensorsAndUpdateDetectionResult(gyroDev_t *gyro, const gyro
         return false;
     }
 
+    // Gyro reads must not be held up by transfers of other devices sharing the bus
+    spiSetPriority(&gyro->dev, true);
+
     gyro->dev.busType_u.spi.csnPin = IOGetByTag(config->csnTag);
 
     IOInit(gyro->dev.busType_u.spi.csnPin, OWNER_GYRO_CS, RESOURCE_INDEX(config->index));
@@ -231,6 +231,8 @@ void mpuPreInit(const struct gyroDeviceConfig_s *config);
 bool mpuDetect(struct gyroDev_s *gyro, const struct gyroDeviceConfig_s *config);
 uint8_t mpuGyroDLPF(struct gyroDev_s *gyro);
 uint8_t mpuGyroReadRegister(const extDevice_t *dev, uint8_t reg);
+void mpuGyroFifoInit(struct gyroDev_s *gyro, uint8_t reg, uint8_t len);
+bool mpuGyroFifoRead(struct gyroDev_s *gyro);
 
 struct accDev_s;
 bool mpuAccRead(struct accDev_s *acc);
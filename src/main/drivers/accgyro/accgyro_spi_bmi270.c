@@ -126,6 +126,7 @@ typedef enum {
     BMI270_VAL_FIFO_CONFIG_0 = 0x00,         // don't stop when full, disable sensortime frame
     BMI270_VAL_FIFO_CONFIG_1 = 0x80,         // only gyro data in FIFO, use headerless mode
     BMI270_VAL_FIFO_DOWNS = 0x00,            // select unfiltered gyro data with no downsampling (6.4KHz samples)
+    BMI270_VAL_FIFO_DOWNS_FILTERED = 0x08,   // select filtered gyro data with no downsampling (gyro ODR samples)
     BMI270_VAL_FIFO_WTM_0 = 0x06,            // set the FIFO watermark level to 1 gyro sample (6 bytes)
     BMI270_VAL_FIFO_WTM_1 = 0x00,            // FIFO watermark MSB
 } bmi270ConfigValues_e;
@@ -205,6 +206,16 @@ static uint8_t getBmiOsrMode(void)
     }
 }
 
+static bool bmi270FifoBatched(const gyroDev_t *gyro)
+{
+#ifdef USE_GYRO_FIFO
+    return gyro->fifoDepth != 0;
+#else
+    UNUSED(gyro);
+    return false;
+#endif
+}
+
 static void bmi270Config(gyroDev_t *gyro)
 {
     extDevice_t *dev = &gyro->dev;
@@ -212,7 +223,8 @@ static void bmi270Config(gyroDev_t *gyro)
     // If running in hardware_lpf experimental mode then switch to FIFO-based,
     // 6.4KHz sampling, unfiltered data vs. the default 3.2KHz with hardware filtering
 #ifdef USE_GYRO_DLPF_EXPERIMENTAL
-    const bool fifoMode = (gyro->hardware_lpf == GYRO_HARDWARE_LPF_EXPERIMENTAL);
+    // When batching FIFO reads the FIFO is only set up once the data ready interrupt has been detected
+    const bool fifoMode = (gyro->hardware_lpf == GYRO_HARDWARE_LPF_EXPERIMENTAL) && !bmi270FifoBatched(gyro);
 #else
     const bool fifoMode = false;
 #endif
@@ -329,7 +341,13 @@ static bool bmi270AccRead(accDev_t *acc)
 {
     extDevice_t *dev = &acc->gyro->dev;
 
-    switch (acc->gyro->gyroModeSPI) {
+    gyroModeSPI_e gyroModeSPI = acc->gyro->gyroModeSPI;
+    // The gyro burst only reads the FIFO, so the acc registers have to be read separately
+    if (bmi270FifoBatched(acc->gyro) && gyroModeSPI == GYRO_EXTI_INT_DMA) {
+        gyroModeSPI = GYRO_EXTI_INT;
+    }
+
+    switch (gyroModeSPI) {
     case GYRO_EXTI_INT:
     case GYRO_EXTI_NO_INT:
     {
@@ -515,8 +533,89 @@ static bool bmi270GyroReadFifo(gyroDev_t *gyro)
 }
 #endif
 
+#ifdef USE_GYRO_FIFO
+// Dummy byte followed by the FIFO length
+#define BMI270_FIFO_STATUS_SIZE 3
+
+// Queue the gyro samples in the FIFO and interrupt once fifoDepth of them are ready
+static void bmi270FifoEnable(gyroDev_t *gyro)
+{
+    extDevice_t *dev = &gyro->dev;
+    const uint16_t watermark = gyro->fifoDepth * BMI270_FIFO_FRAME_SIZE;
+
+#ifdef USE_GYRO_DLPF_EXPERIMENTAL
+    // Unfiltered 6.4KHz samples as in the single sample FIFO mode
+    const uint8_t fifoDowns = (gyro->hardware_lpf == GYRO_HARDWARE_LPF_EXPERIMENTAL) ? BMI270_VAL_FIFO_DOWNS : BMI270_VAL_FIFO_DOWNS_FILTERED;
+#else
+    const uint8_t fifoDowns = BMI270_VAL_FIFO_DOWNS_FILTERED;
+#endif
+
+    bmi270RegisterWrite(dev, BMI270_REG_FIFO_CONFIG_0, BMI270_VAL_FIFO_CONFIG_0, 1);
+    bmi270RegisterWrite(dev, BMI270_REG_FIFO_CONFIG_1, BMI270_VAL_FIFO_CONFIG_1, 1);
+    bmi270RegisterWrite(dev, BMI270_REG_FIFO_DOWNS, fifoDowns, 1);
+    bmi270RegisterWrite(dev, BMI270_REG_FIFO_WTM_0, watermark & 0xff, 1);
+    bmi270RegisterWrite(dev, BMI270_REG_FIFO_WTM_1, watermark >> 8, 1);
+
+    // Interrupt driven by FIFO watermark level
+    bmi270RegisterWrite(dev, BMI270_REG_INT_MAP_DATA, BMI270_VAL_INT_MAP_FIFO_WM_INT1, 1);
+
+    bmi270RegisterWrite(dev, BMI270_REG_CMD, BMI270_VAL_CMD_FIFOFLUSH, 1);
+}
+
+static bool bmi270GyroReadFifoBurst(gyroDev_t *gyro)
+{
+    if (gyro->gyroModeSPI == GYRO_EXTI_INIT) {
+        // Data ready interrupts have been counted until now, switch over to the FIFO before reading anything
+        bmi270FifoEnable(gyro);
+        mpuGyroFifoInit(gyro, BMI270_REG_FIFO_LENGTH_LSB, BMI270_FIFO_STATUS_SIZE + gyro->fifoDepth * BMI270_FIFO_FRAME_SIZE);
+        return true;
+    }
+
+    gyro->fifoCount = 0;
+
+    if (!mpuGyroFifoRead(gyro)) {
+        return true;
+    }
+
+    const uint8_t *fifoData = &gyro->fifoBuf[1];
+    const unsigned fifoLength = ((fifoData[2] & 0x3f) << 8) | fifoData[1];
+    const unsigned frameCount = MIN(fifoLength / BMI270_FIFO_FRAME_SIZE, gyro->fifoDepth);
+    const uint8_t *frame = &fifoData[BMI270_FIFO_STATUS_SIZE];
+
+    for (unsigned i = 0; i < frameCount; i++, frame += BMI270_FIFO_FRAME_SIZE) {
+        const int16_t gyroX = (int16_t)((frame[1] << 8) | frame[0]);
+        const int16_t gyroY = (int16_t)((frame[3] << 8) | frame[2]);
+        const int16_t gyroZ = (int16_t)((frame[5] << 8) | frame[4]);
+
+        // Invalid FIFO data reads as 0x8000 on all axes (pg. 43 of datasheet)
+        if ((gyroX != INT16_MIN) || (gyroY != INT16_MIN) || (gyroZ != INT16_MIN)) {
+            gyro->fifoSamples[gyro->fifoCount][X] = gyroX;
+            gyro->fifoSamples[gyro->fifoCount][Y] = gyroY;
+            gyro->fifoSamples[gyro->fifoCount][Z] = gyroZ;
+            gyro->fifoCount++;
+        }
+    }
+
+    // A partially read frame is never removed from the FIFO, and the watermark interrupt only fires as the FIFO
+    // level rises past the threshold, so flush if either would otherwise leave the FIFO stuck
+    const unsigned remaining = fifoLength - frameCount * BMI270_FIFO_FRAME_SIZE;
+    if ((remaining % BMI270_FIFO_FRAME_SIZE) || (remaining >= gyro->fifoDepth * BMI270_FIFO_FRAME_SIZE)) {
+        bmi270RegisterWrite(&gyro->dev, BMI270_REG_CMD, BMI270_VAL_CMD_FIFOFLUSH, 0);
+    }
+
+    return true;
+}
+#endif
+
 static bool bmi270GyroRead(gyroDev_t *gyro)
 {
+#ifdef USE_GYRO_FIFO
+    if (gyro->fifoDepth) {
+        // running in batched FIFO mode
+        return bmi270GyroReadFifoBurst(gyro);
+    }
+#endif
+
 #ifdef USE_GYRO_DLPF_EXPERIMENTAL
     if (gyro->hardware_lpf == GYRO_HARDWARE_LPF_EXPERIMENTAL) {
         // running in 6.4KHz FIFO mode
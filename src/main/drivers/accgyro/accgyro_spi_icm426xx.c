@@ -125,6 +125,33 @@
 #define ICM426XX_UI_DRDY_INT1_EN_DISABLED           (0 << 3)
 #define ICM426XX_UI_DRDY_INT1_EN_ENABLED            (1 << 3)
 
+#define ICM426XX_UI_FIFO_THS_INT1_EN_ENABLED         (1 << 2)
+
+// --- Registers for FIFO burst reads ------------------------
+#define ICM426XX_RA_FIFO_CONFIG                     0x16  // User Bank 0
+#define ICM426XX_FIFO_MODE_STREAM                   (1 << 6)
+
+#define ICM426XX_RA_FIFO_COUNTH                     0x2E  // User Bank 0, followed by FIFO_COUNTL and FIFO_DATA
+
+#define ICM426XX_RA_SIGNAL_PATH_RESET               0x4B  // User Bank 0
+#define ICM426XX_FIFO_FLUSH                         (1 << 1)
+
+#define ICM426XX_RA_INTF_CONFIG0                    0x4C  // User Bank 0
+#define ICM426XX_FIFO_COUNT_REC                     (1 << 6)
+
+#define ICM426XX_RA_FIFO_CONFIG1                    0x5F  // User Bank 0
+#define ICM426XX_FIFO_TEMP_EN                       (1 << 2)
+#define ICM426XX_FIFO_GYRO_EN                       (1 << 1)
+#define ICM426XX_RA_FIFO_CONFIG2                    0x60  // User Bank 0, watermark bits 7:0
+#define ICM426XX_RA_FIFO_CONFIG3                    0x61  // User Bank 0, watermark bits 11:8
+
+// FIFO packet 2: header, big endian gyro X/Y/Z and 8-bit temperature
+#define ICM426XX_FIFO_STATUS_SIZE                   2
+#define ICM426XX_FIFO_FRAME_SIZE                    8
+#define ICM426XX_FIFO_HEADER_MSG                    (1 << 7)  // set if the FIFO is empty
+#define ICM426XX_FIFO_HEADER_GYRO                   (1 << 5)
+// ----------------------------------------------------------
+
 // specific to CLKIN configuration
 #define ICM426XX_INTF_CONFIG5                       0x7B  // User Bank 1
 #define ICM426XX_INTF_CONFIG1_CLKIN                 (1 << 2)
@@ -405,6 +432,84 @@ void icm426xxGyroInit(gyroDev_t *gyro)
     delay(15);
 }
 
+#ifdef USE_GYRO_FIFO
+static void icm426xxFifoFlush(const extDevice_t *dev)
+{
+    spiWriteReg(dev, ICM426XX_RA_SIGNAL_PATH_RESET, ICM426XX_FIFO_FLUSH);
+}
+
+// Queue the gyro samples in the FIFO and interrupt once fifoDepth of them are ready
+static void icm426xxFifoEnable(gyroDev_t *gyro)
+{
+    const extDevice_t *dev = &gyro->dev;
+
+    setUserBank(dev, ICM426XX_BANK_SELECT0);
+
+    // Count the FIFO contents in packets rather than bytes
+    const uint8_t intfConfig0Value = spiReadRegMsk(dev, ICM426XX_RA_INTF_CONFIG0);
+    spiWriteReg(dev, ICM426XX_RA_INTF_CONFIG0, intfConfig0Value | ICM426XX_FIFO_COUNT_REC);
+
+    spiWriteReg(dev, ICM426XX_RA_FIFO_CONFIG1, ICM426XX_FIFO_TEMP_EN | ICM426XX_FIFO_GYRO_EN);
+    spiWriteReg(dev, ICM426XX_RA_FIFO_CONFIG2, gyro->fifoDepth);
+    spiWriteReg(dev, ICM426XX_RA_FIFO_CONFIG3, 0);
+    spiWriteReg(dev, ICM426XX_RA_FIFO_CONFIG, ICM426XX_FIFO_MODE_STREAM);
+
+    // Interrupt on the FIFO watermark rather than on every sample
+    spiWriteReg(dev, ICM426XX_RA_INT_SOURCE0, ICM426XX_UI_FIFO_THS_INT1_EN_ENABLED);
+
+    icm426xxFifoFlush(dev);
+}
+
+static bool icm426xxGyroReadFifo(gyroDev_t *gyro)
+{
+    if (gyro->gyroModeSPI == GYRO_EXTI_INIT) {
+        // Data ready interrupts have been counted until now, switch over to the FIFO before reading anything
+        icm426xxFifoEnable(gyro);
+        mpuGyroFifoInit(gyro, ICM426XX_RA_FIFO_COUNTH, ICM426XX_FIFO_STATUS_SIZE + gyro->fifoDepth * ICM426XX_FIFO_FRAME_SIZE);
+        return true;
+    }
+
+    gyro->fifoCount = 0;
+
+    if (!mpuGyroFifoRead(gyro)) {
+        return true;
+    }
+
+    const uint8_t *fifoData = &gyro->fifoBuf[1];
+    const unsigned packetCount = (fifoData[0] << 8) | fifoData[1];
+    const uint8_t *frame = &fifoData[ICM426XX_FIFO_STATUS_SIZE];
+
+    for (unsigned i = 0; i < MIN(packetCount, gyro->fifoDepth); i++, frame += ICM426XX_FIFO_FRAME_SIZE) {
+        if ((frame[0] & ICM426XX_FIFO_HEADER_MSG) || !(frame[0] & ICM426XX_FIFO_HEADER_GYRO)) {
+            break;
+        }
+        gyro->fifoSamples[gyro->fifoCount][X] = (int16_t)((frame[1] << 8) | frame[2]);
+        gyro->fifoSamples[gyro->fifoCount][Y] = (int16_t)((frame[3] << 8) | frame[4]);
+        gyro->fifoSamples[gyro->fifoCount][Z] = (int16_t)((frame[5] << 8) | frame[6]);
+        gyro->fifoCount++;
+    }
+
+    // The watermark interrupt only fires as the FIFO level reaches the threshold, so if the reads have fallen a
+    // whole burst behind drop the backlog rather than stall
+    if (packetCount >= 2 * gyro->fifoDepth) {
+        icm426xxFifoFlush(&gyro->dev);
+    }
+
+    return true;
+}
+#endif
+
+static bool icm426xxGyroReadSPI(gyroDev_t *gyro)
+{
+#ifdef USE_GYRO_FIFO
+    if (gyro->fifoDepth) {
+        return icm426xxGyroReadFifo(gyro);
+    }
+#endif
+
+    return mpuGyroReadSPI(gyro);
+}
+
 bool icm426xxSpiGyroDetect(gyroDev_t *gyro)
 {
     switch (gyro->mpuDetectionResult.sensor) {
@@ -420,7 +525,7 @@ bool icm426xxSpiGyroDetect(gyroDev_t *gyro)
     }
 
     gyro->initFn = icm426xxGyroInit;
-    gyro->readFn = mpuGyroReadSPI;
+    gyro->readFn = icm426xxGyroReadSPI;
 
     return true;
 }
@@ -864,7 +864,15 @@ static void lsm6dsv16xAccInit(accDev_t *acc)
 
 static bool lsm6dsv16xAccReadSPI(accDev_t *acc)
 {
-    switch (acc->gyro->gyroModeSPI) {
+    gyroModeSPI_e gyroModeSPI = acc->gyro->gyroModeSPI;
+#ifdef USE_GYRO_FIFO
+    // The gyro burst only reads the FIFO, so the acc registers have to be read separately
+    if (acc->gyro->fifoDepth && gyroModeSPI == GYRO_EXTI_INT_DMA) {
+        gyroModeSPI = GYRO_EXTI_INT;
+    }
+#endif
+
+    switch (gyroModeSPI) {
     case GYRO_EXTI_INT:
     case GYRO_EXTI_NO_INT:
     {
@@ -1086,6 +1094,83 @@ static bool lsm6dsv16xGyroReadSPI(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_FIFO
+// Each FIFO word is a tag byte followed by little endian X/Y/Z data
+#define LSM6DSV_FIFO_FRAME_SIZE 7
+
+// Batch the gyro samples in the FIFO and interrupt once fifoDepth of them have been batched
+static void lsm6dsv16xFifoEnable(gyroDev_t *gyro)
+{
+    const extDevice_t *dev = &gyro->dev;
+
+    spiWriteReg(dev, LSM6DSV_FIFO_CTRL1, gyro->fifoDepth);
+
+    // Batch the gyro at its 8kHz output data rate, and no acc samples
+    spiWriteReg(dev, LSM6DSV_FIFO_CTRL3,
+                LSM6DSV_ENCODE_BITS(LSM6DSV_FIFO_CTRL3_BDR_GY_7680HZ,
+                                    LSM6DSV_FIFO_CTRL3_BDR_GY_MASK,
+                                    LSM6DSV_FIFO_CTRL3_BDR_GY_SHIFT));
+
+    spiWriteReg(dev, LSM6DSV_FIFO_CTRL4,
+                LSM6DSV_ENCODE_BITS(LSM6DSV_FIFO_CTRL4_FIFO_MODE_CONT,
+                                    LSM6DSV_FIFO_CTRL4_FIFO_MODE_MASK,
+                                    LSM6DSV_FIFO_CTRL4_FIFO_MODE_SHIFT));
+
+    // The batch counter interrupt is pulsed every fifoDepth gyro samples, unlike the FIFO threshold interrupt
+    // which stays asserted while the FIFO level is above the threshold
+    spiWriteReg(dev, LSM6DSV_COUNTER_BDR_REG1,
+                LSM6DSV_ENCODE_BITS(LSM6DSV_COUNTER_BDR_REG1_TRIG_COUNTER_BDR_GYRO,
+                                    LSM6DSV_COUNTER_BDR_REG1_TRIG_COUNTER_BDR_MASK,
+                                    LSM6DSV_COUNTER_BDR_REG1_TRIG_COUNTER_BDR_SHIFT));
+    spiWriteReg(dev, LSM6DSV_COUNTER_BDR_REG2, gyro->fifoDepth);
+
+    spiWriteReg(dev, LSM6DSV_INT1_CTRL, LSM6DSV_INT1_CTRL_INT1_CNT_BDR);
+}
+
+static bool lsm6dsv16xGyroReadFifo(gyroDev_t *gyro)
+{
+    if (gyro->gyroModeSPI == GYRO_EXTI_INIT) {
+        // Data ready interrupts have been counted until now, switch over to the FIFO before reading anything
+        lsm6dsv16xFifoEnable(gyro);
+        // The register address rolls back from FIFO_DATA_OUT_Z_H to FIFO_DATA_OUT_TAG, so words can be burst read
+        mpuGyroFifoInit(gyro, LSM6DSV_FIFO_DATA_OUT_TAG, gyro->fifoDepth * LSM6DSV_FIFO_FRAME_SIZE);
+        return true;
+    }
+
+    gyro->fifoCount = 0;
+
+    if (!mpuGyroFifoRead(gyro)) {
+        return true;
+    }
+
+    const uint8_t *frame = &gyro->fifoBuf[1];
+
+    for (unsigned i = 0; i < gyro->fifoDepth; i++, frame += LSM6DSV_FIFO_FRAME_SIZE) {
+        // Words read from an empty FIFO are tagged as such
+        if (LSM6DSV_DECODE_BITS(frame[0], LSM6DSV_FIFO_DATA_OUT_TAG_SENSOR_MASK, LSM6DSV_FIFO_DATA_OUT_TAG_SENSOR_SHIFT) != LSM6DSV_FIFO_DATA_OUT_TAG_SENSOR_FIFO_GYRO_NC) {
+            continue;
+        }
+        gyro->fifoSamples[gyro->fifoCount][X] = (int16_t)((frame[2] << 8) | frame[1]);
+        gyro->fifoSamples[gyro->fifoCount][Y] = (int16_t)((frame[4] << 8) | frame[3]);
+        gyro->fifoSamples[gyro->fifoCount][Z] = (int16_t)((frame[6] << 8) | frame[5]);
+        gyro->fifoCount++;
+    }
+
+    return true;
+}
+#endif
+
+static bool lsm6dsv16xGyroRead(gyroDev_t *gyro)
+{
+#ifdef USE_GYRO_FIFO
+    if (gyro->fifoDepth) {
+        return lsm6dsv16xGyroReadFifo(gyro);
+    }
+#endif
+
+    return lsm6dsv16xGyroReadSPI(gyro);
+}
+
 bool lsm6dsv16xSpiGyroDetect(gyroDev_t *gyro)
 {
     if (gyro->mpuDetectionResult.sensor != LSM6DSV16X_SPI) {
@@ -1093,7 +1178,7 @@ bool lsm6dsv16xSpiGyroDetect(gyroDev_t *gyro)
     }
 
     gyro->initFn = lsm6dsv16xGyroInit;
-    gyro->readFn = lsm6dsv16xGyroReadSPI;
+    gyro->readFn = lsm6dsv16xGyroRead;
 
     return true;
 }
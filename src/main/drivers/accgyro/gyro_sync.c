@@ -92,5 +92,11 @@ uint16_t gyroSetSampleRate(gyroDev_t *gyro)
 
     gyro->mpuDividerDrops  = 0; // we no longer use the gyro's sample divider
     gyro->accSampleRateHz = accSampleRateHz;
+#ifdef USE_GYRO_FIFO
+    // The gyro task runs once per burst of FIFO samples
+    if (gyro->fifoDepth) {
+        gyroSampleRateHz /= gyro->fifoDepth;
+    }
+#endif
     return gyroSampleRateHz;
 }
@@ -44,6 +44,18 @@ typedef enum {
 
 struct extDevice_s;
 
+#define BUS_WAIT_STATS_DEVICE_COUNT 4
+
+// Time a device spent waiting for transfers of other devices on the same bus
+typedef struct busWaitStats_s {
+    const struct extDevice_s *dev;
+    uint32_t queuedCycles;      // Cycle counter when the pending transfer was queued
+    bool waiting;
+    uint32_t count;             // Number of transfers which had to wait
+    uint32_t totalUs;
+    uint32_t maxUs;
+} busWaitStats_t;
+
 // Bus interface, independent of connected device
 typedef struct busDevice_s {
     busType_e busType;
@@ -52,6 +64,8 @@ typedef struct busDevice_s {
             SPI_TypeDef *instance;
             uint16_t speed;
             bool leadingEdge;
+            // Updated as transfers are queued and started, which may be from an interrupt
+            volatile busWaitStats_t waitStats[BUS_WAIT_STATS_DEVICE_COUNT];
         } spi;
         struct busI2C_s {
             I2CDevice device;
@@ -76,6 +90,9 @@ typedef struct busDevice_s {
 #endif // USE_DMA
     volatile struct busSegment_s* volatile curSegment;
     bool initSegment;
+    // Transfer of a priority device waiting to be started at the next chip select negation
+    const struct extDevice_s *priorityDev;
+    volatile struct busSegment_s *prioritySegments;
 } busDevice_t;
 
 // External device has an associated bus and bus dependent address
@@ -110,6 +127,8 @@ typedef struct extDevice_s {
     uint8_t *txBuf, *rxBuf;
     // Connected devices on the same bus may support different speeds
     uint32_t callbackArg;
+    // Transfers of a priority device are started ahead of queued transfers of other devices
+    bool priority;
 } extDevice_t;
 
 /* Each SPI access may comprise multiple parts, for example, wait/write enable/write/data each of which
@@ -36,6 +36,7 @@
 #include "drivers/io.h"
 #include "drivers/motor.h"
 #include "drivers/nvic.h"
+#include "drivers/system.h"
 #include "pg/bus_spi.h"
 
 #define NUM_QUEUE_SEGS 5
@@ -432,6 +433,97 @@ void spiLinkSegments(const extDevice_t *dev, busSegment_t *firstSegment, busSegm
     endSegment->u.link.segments = secondSegment;
 }
 
+void spiSetPriority(extDevice_t *dev, bool priority)
+{
+    dev->priority = priority;
+}
+
+const volatile busWaitStats_t *spiGetWaitStats(unsigned index)
+{
+    for (int device = 0; device < SPIDEV_COUNT; device++) {
+        const volatile busWaitStats_t *waitStats = spiBusDevice[device].busType_u.spi.waitStats;
+        for (int i = 0; i < BUS_WAIT_STATS_DEVICE_COUNT; i++, waitStats++) {
+            if (waitStats->count && index-- == 0) {
+                return waitStats;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// Wait statistics of a device, kept by its bus, NULL if it has none and none are to be added or there is no room
+static FAST_CODE volatile busWaitStats_t *spiWaitStats(const extDevice_t *dev, bool add)
+{
+    volatile busWaitStats_t *waitStats = dev->bus->busType_u.spi.waitStats;
+
+    for (int i = 0; i < BUS_WAIT_STATS_DEVICE_COUNT; i++, waitStats++) {
+        if (!waitStats->dev) {
+            if (!add) {
+                return NULL;
+            }
+            // First wait for this device
+            waitStats->dev = dev;
+        }
+        if (waitStats->dev == dev) {
+            return waitStats;
+        }
+    }
+
+    return NULL;
+}
+
+// Note the time at which a transfer had to be queued behind another one
+static FAST_CODE void spiWaitStart(const extDevice_t *dev)
+{
+    volatile busWaitStats_t *waitStats = spiWaitStats(dev, true);
+
+    if (waitStats) {
+        waitStats->queuedCycles = getCycleCounter();
+        waitStats->waiting = true;
+    }
+}
+
+// Start a transfer which had been queued, accounting for the time it waited
+static FAST_CODE void spiSequenceStartQueued(const extDevice_t *dev)
+{
+    volatile busWaitStats_t *waitStats = spiWaitStats(dev, false);
+
+    // Segment lists linked by the driver itself didn't wait for another device
+    if (waitStats && waitStats->waiting) {
+        const uint32_t waitUs = clockCyclesToMicros(getCycleCounter() - waitStats->queuedCycles);
+
+        waitStats->waiting = false;
+        waitStats->count++;
+        waitStats->totalUs += waitUs;
+        if (waitUs > waitStats->maxUs) {
+            waitStats->maxUs = waitUs;
+        }
+    }
+
+    spiSequenceStart(dev);
+}
+
+// Start the pending priority transfer, following it with the given transfer which may be NULL
+static FAST_CODE void spiSequenceStartPriority(busDevice_t *bus, const extDevice_t *resumeDev, volatile busSegment_t *resumeSegments)
+{
+    const extDevice_t *priorityDev = bus->priorityDev;
+    busSegment_t *prioritySegments = (busSegment_t *)bus->prioritySegments;
+    busSegment_t *endSegment;
+
+    bus->priorityDev = NULL;
+    bus->prioritySegments = NULL;
+
+    // Find the last segment of the priority transfer
+    for (endSegment = prioritySegments; endSegment->len; endSegment++);
+
+    endSegment->u.link.dev = resumeDev;
+    endSegment->u.link.segments = resumeSegments;
+
+    bus->curSegment = prioritySegments;
+    spiSequenceStartQueued(priorityDev);
+}
+
 // DMA transfer setup and start
 void spiSequence(const extDevice_t *dev, busSegment_t *segments)
 {
@@ -449,6 +541,11 @@ void spiSequence(const extDevice_t *dev, busSegment_t *segments)
             // Safe to discard the volatile qualifier as we're in an atomic block
             busSegment_t *endCmpSegment = (busSegment_t *)bus->curSegment;
 
+            if (segments == bus->prioritySegments) {
+                // Already waiting to be started
+                return;
+            }
+
             if (endCmpSegment) {
                 while (true) {
                     // Find the last segment of the current transfer
@@ -471,9 +568,19 @@ void spiSequence(const extDevice_t *dev, busSegment_t *segments)
                     }
                 }
 
-                // Record the dev and segments parameters in the terminating segment entry
-                endCmpSegment->u.link.dev = dev;
-                endCmpSegment->u.link.segments = segments;
+                spiWaitStart(dev);
+
+                if (dev->priority && !bus->priorityDev) {
+                    /* Rather than waiting for all queued transfers to complete, start this one as soon as
+                     * chip select is next negated, which may be part way through the current transfer.
+                     */
+                    bus->priorityDev = dev;
+                    bus->prioritySegments = segments;
+                } else {
+                    // Record the dev and segments parameters in the terminating segment entry
+                    endCmpSegment->u.link.dev = dev;
+                    endCmpSegment->u.link.segments = segments;
+                }
             }
 
             return;
@@ -505,6 +612,8 @@ FAST_IRQ_HANDLER void spiIrqHandler(const extDevice_t *dev)
 {
     busDevice_t *bus = dev->bus;
     busSegment_t *nextSegment;
+    // Chip select was negated at the end of the completed segment, so another device may take the bus
+    const bool csNegated = bus->curSegment->negateCS;
 
     if (bus->curSegment->callback) {
         switch(bus->curSegment->callback(dev->callbackArg)) {
@@ -536,19 +645,30 @@ FAST_IRQ_HANDLER void spiIrqHandler(const extDevice_t *dev)
     nextSegment = (busSegment_t *)bus->curSegment + 1;
 
     if (nextSegment->len == 0) {
-        // If a following transaction has been linked, start it
-        if (nextSegment->u.link.dev) {
+        if (bus->priorityDev) {
+            // Start the priority transaction ahead of any which have been linked
+            const extDevice_t *nextDev = nextSegment->u.link.dev;
+            volatile busSegment_t *nextSegments = nextSegment->u.link.segments;
+            nextSegment->u.link.dev = NULL;
+            nextSegment->u.link.segments = NULL;
+            spiSequenceStartPriority(bus, nextDev, nextSegments);
+        } else if (nextSegment->u.link.dev) {
+            // If a following transaction has been linked, start it
             const extDevice_t *nextDev = nextSegment->u.link.dev;
             busSegment_t *nextSegments = (busSegment_t *)nextSegment->u.link.segments;
             // The end of the segment list has been reached
             bus->curSegment = nextSegments;
             nextSegment->u.link.dev = NULL;
             nextSegment->u.link.segments = NULL;
-            spiSequenceStart(nextDev);
+            spiSequenceStartQueued(nextDev);
         } else {
             // The end of the segment list has been reached, so mark transactions as complete
             bus->curSegment = (busSegment_t *)BUS_SPI_FREE;
         }
+    } else if (csNegated && bus->priorityDev) {
+        // Preempt the rest of this segment list, which is resumed once the priority transaction completes
+        spiWaitStart(dev);
+        spiSequenceStartPriority(bus, dev, nextSegment);
     } else {
         // Do as much processing as possible before asserting CS to avoid violating minimum high time
         bool negateCS = bus->curSegment->negateCS;
@@ -623,15 +743,23 @@ FAST_CODE void spiProcessSegmentsPolled(const extDevice_t *dev)
         }
     }
 
-    // If a following transaction has been linked, start it
-    if (bus->curSegment->u.link.dev) {
+    if (bus->priorityDev) {
+        // Start the priority transaction ahead of any which have been linked
+        busSegment_t *endSegment = (busSegment_t *)bus->curSegment;
+        const extDevice_t *nextDev = endSegment->u.link.dev;
+        volatile busSegment_t *nextSegments = endSegment->u.link.segments;
+        endSegment->u.link.dev = NULL;
+        endSegment->u.link.segments = NULL;
+        spiSequenceStartPriority(bus, nextDev, nextSegments);
+    } else if (bus->curSegment->u.link.dev) {
+        // If a following transaction has been linked, start it
         busSegment_t *endSegment = (busSegment_t *)bus->curSegment;
         const extDevice_t *nextDev = endSegment->u.link.dev;
         busSegment_t *nextSegments = (busSegment_t *)endSegment->u.link.segments;
         bus->curSegment = nextSegments;
         endSegment->u.link.dev = NULL;
         endSegment->u.link.segments = NULL;
-        spiSequenceStart(nextDev);
+        spiSequenceStartQueued(nextDev);
     } else {
         // The end of the segment list has been reached, so mark transactions as complete
         bus->curSegment = (busSegment_t *)BUS_SPI_FREE;
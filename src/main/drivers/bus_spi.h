@@ -99,6 +99,10 @@ bool spiIsBusy(const extDevice_t *dev);
 
 // Link two segment lists
 void spiLinkSegments(const extDevice_t *dev, busSegment_t *firstSegment, busSegment_t *secondSegment);
+// Give transfers of this device priority over those of other devices on the same bus
+void spiSetPriority(extDevice_t *dev, bool priority);
+// Devices which had to wait for the bus, index from 0 until NULL is returned
+const volatile busWaitStats_t *spiGetWaitStats(unsigned index);
 
 /*
  * Routine naming convention is:
@@ -24,6 +24,7 @@
 
 #include "platform.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/display_canvas.h"
@@ -31,9 +32,160 @@
 
 #include "display.h"
 
+/*
+ * Buffered displays
+ *
+ * Writes to a buffered display only update the back canvas. Committing a transaction presents
+ * the back canvas by copying its changed cells to the front canvas, which displayDrawScreen()
+ * then sends to the device a few runs at a time as the link allows. Drawing the next frame
+ * therefore doesn't wait for the previous one to be sent. A frame committed while the front
+ * canvas is still being sent is merged into it: its cells behind the point reached are sent
+ * on the next pass. The device draws the screen at the end of every pass, so a busy link
+ * delays frames rather than losing them, at the cost of a screen that can show cells of
+ * both frames until the next pass.
+ *
+ * The drain is polled from the OSD task rather than driven by the serial port. The task is
+ * only scheduled while the port has room for the next run, see displayIsDrawReady().
+ */
+
+#define DISPLAY_BUFFER_MAX_RUN 30           // longest string passed to the device at once
+#define DISPLAY_BUFFER_RUN_OVERHEAD 16      // allowance for the device's framing of each string
+#define DISPLAY_BUFFER_MAX_DRAW_CELLS 256   // cells sent per call to displayDrawScreen()
+
+#define DISPLAY_BUFFER_IS_DIRTY(buffer, pos) ((buffer)->dirtyBits[(pos) / 32] & (1U << ((pos) % 32)))
+
+static unsigned displayBufferCells(const displayPort_t *instance)
+{
+    return MIN(instance->rows * instance->cols, instance->buffer->size);
+}
+
+static void displayBufferClear(displayPort_t *instance)
+{
+    displayBuffer_t *buffer = instance->buffer;
+
+    for (unsigned i = 0; i < buffer->size; i++) {
+        buffer->back[i] = DISPLAY_BUFFER_CELL_BLANK;
+    }
+}
+
+static void displayBufferWrite(displayPort_t *instance, uint8_t x, uint8_t y, uint8_t attr, const char *text)
+{
+    if (y >= instance->rows || (y + 1) * instance->cols > instance->buffer->size) {
+        return;
+    }
+
+    uint16_t *cell = &instance->buffer->back[y * instance->cols + x];
+    for (int col = x; *text && col < instance->cols; col++) {
+        *cell++ = DISPLAY_BUFFER_CELL(*text++, attr);
+    }
+}
+
+// Copy the changed cells of the back canvas to the front canvas and start sending them
+static void displayBufferPresent(displayPort_t *instance)
+{
+    displayBuffer_t *buffer = instance->buffer;
+    const unsigned cells = displayBufferCells(instance);
+
+    // Re-send one row with each frame so that a device which has lost its canvas recovers
+    if (++buffer->refreshRow >= instance->rows) {
+        buffer->refreshRow = 0;
+    }
+    const unsigned refreshStart = buffer->refreshRow * instance->cols;
+
+    for (unsigned i = 0; i < cells; i++) {
+        if (buffer->back[i] != buffer->front[i] || (i >= refreshStart && i < refreshStart + instance->cols)) {
+            buffer->front[i] = buffer->back[i];
+            buffer->dirtyBits[i / 32] |= 1U << (i % 32);
+        }
+    }
+
+    // Cells behind the point reached by a frame still being sent go on its next pass
+    if (!buffer->draining) {
+        buffer->drainPos = 0;
+        buffer->draining = true;
+    }
+}
+
+static bool displayBufferIsDirty(const displayBuffer_t *buffer)
+{
+    for (int i = 0; i < DISPLAY_BUFFER_DIRTY_WORDS(buffer->size); i++) {
+        if (buffer->dirtyBits[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Send runs of unsent cells to the device, returns true if there is more to send
+static bool displayBufferDrain(displayPort_t *instance)
+{
+    displayBuffer_t *buffer = instance->buffer;
+    const unsigned cells = displayBufferCells(instance);
+    unsigned budget = DISPLAY_BUFFER_MAX_DRAW_CELLS;
+    unsigned pos = buffer->drainPos;
+    char text[DISPLAY_BUFFER_MAX_RUN + 1];
+
+    if (!buffer->draining) {
+        return false;
+    }
+
+    while (pos < cells) {
+        if (!DISPLAY_BUFFER_IS_DIRTY(buffer, pos)) {
+            pos++;
+            continue;
+        }
+
+        // A run continues along the row over unsent cells with the same attribute
+        const uint8_t col = pos % instance->cols;
+        const uint8_t attr = buffer->front[pos] >> 8;
+        unsigned len = 0;
+        while (len < DISPLAY_BUFFER_MAX_RUN && col + len < instance->cols && DISPLAY_BUFFER_IS_DIRTY(buffer, pos + len)
+               && (buffer->front[pos + len] >> 8) == attr) {
+            text[len] = buffer->front[pos + len] & 0xff;
+            len++;
+        }
+        text[len] = '\0';
+
+        if (len > budget) {
+            break;
+        }
+        if (displayTxBytesFree(instance) < len + DISPLAY_BUFFER_RUN_OVERHEAD) {
+            buffer->waitTxBytes = len + DISPLAY_BUFFER_RUN_OVERHEAD;
+            break;
+        }
+        buffer->waitTxBytes = 0;
+
+        instance->vTable->writeString(instance, col, pos / instance->cols, attr, text);
+
+        for (unsigned i = pos; i < pos + len; i++) {
+            buffer->dirtyBits[i / 32] &= ~(1U << (i % 32));
+        }
+        budget -= len;
+        pos += len;
+    }
+
+    buffer->drainPos = pos;
+
+    if (pos < cells) {
+        return true;
+    }
+
+    // The pass is complete, so have the device show it. Cells of a frame merged during the
+    // pass that were behind it are sent on another one.
+    instance->vTable->drawScreen(instance);
+    buffer->drainPos = 0;
+    buffer->draining = displayBufferIsDirty(buffer);
+
+    return buffer->draining;
+}
+
 void displayClearScreen(displayPort_t *instance, displayClearOption_e options)
 {
-    instance->vTable->clearScreen(instance, options);
+    if (instance->buffer) {
+        displayBufferClear(instance);
+    } else {
+        instance->vTable->clearScreen(instance, options);
+    }
     instance->cleared = true;
     instance->cursorRow = -1;
 }
@@ -41,6 +193,10 @@ void displayClearScreen(displayPort_t *instance, displayClearOption_e options)
 // Return true if screen still being transferred
 bool displayDrawScreen(displayPort_t *instance)
 {
+    if (instance->buffer) {
+        return displayBufferDrain(instance);
+    }
+
     return instance->vTable->drawScreen(instance);
 }
 
@@ -52,7 +208,11 @@ int displayScreenSize(const displayPort_t *instance)
 void displayGrab(displayPort_t *instance)
 {
     instance->vTable->grab(instance);
-    instance->vTable->clearScreen(instance, DISPLAY_CLEAR_WAIT);
+    if (instance->buffer) {
+        displayBufferClear(instance);
+    } else {
+        instance->vTable->clearScreen(instance, DISPLAY_CLEAR_WAIT);
+    }
     ++instance->grabCount;
 }
 
@@ -99,6 +259,11 @@ int displayWrite(displayPort_t *instance, uint8_t x, uint8_t y, uint8_t attr, co
         return 0;
     }
 
+    if (instance->buffer) {
+        displayBufferWrite(instance, x, y, attr, text);
+        return 0;
+    }
+
     return instance->vTable->writeString(instance, x, y, attr, text);
 }
 
@@ -106,6 +271,13 @@ int displayWriteChar(displayPort_t *instance, uint8_t x, uint8_t y, uint8_t attr
 {
     instance->posX = x + 1;
     instance->posY = y;
+
+    if (instance->buffer) {
+        const char text[2] = { c, '\0' };
+        displayBufferWrite(instance, x, y, attr, text);
+        return 0;
+    }
+
     return instance->vTable->writeChar(instance, x, y, attr, c);
 }
 
@@ -196,6 +368,10 @@ void displayBeginTransaction(displayPort_t *instance, displayTransactionOption_e
 
 void displayCommitTransaction(displayPort_t *instance)
 {
+    if (instance->buffer) {
+        displayBufferPresent(instance);
+    }
+
     if (instance->vTable->commitTransaction) {
         instance->vTable->commitTransaction(instance);
     }
@@ -234,8 +410,63 @@ void displayInit(displayPort_t *instance, const displayPortVTable_t *vTable, dis
     instance->useFullscreen = false;
     instance->grabCount = 0;
     instance->deviceType = deviceType;
+    instance->buffer = NULL;
 
     displayBeginTransaction(instance, DISPLAY_TRANSACTION_OPT_NONE);
     displayClearScreen(instance, DISPLAY_CLEAR_WAIT);
     displayCommitTransaction(instance);
 }
+
+// Draw the display asynchronously from a front and back canvas of size cells each. dirtyBits
+// must have DISPLAY_BUFFER_DIRTY_WORDS(size) entries. The device's canvas is assumed to be
+// unknown, so the first frame is sent in full.
+void displayBufferInit(displayPort_t *instance, displayBuffer_t *buffer, uint16_t *back, uint16_t *front, uint32_t *dirtyBits, uint16_t size)
+{
+    buffer->back = back;
+    buffer->front = front;
+    buffer->dirtyBits = dirtyBits;
+    buffer->size = size;
+    buffer->refreshRow = 0;
+
+    instance->buffer = buffer;
+
+    displayBufferClear(instance);
+    displayBufferReset(instance, DISPLAY_BUFFER_CELL_INVALID);
+}
+
+// Note that every cell of the device's canvas is now cell, for example after the device has
+// been cleared. Any frame still being sent is abandoned.
+void displayBufferReset(displayPort_t *instance, uint16_t cell)
+{
+    displayBuffer_t *buffer = instance->buffer;
+
+    if (!buffer) {
+        return;
+    }
+
+    for (unsigned i = 0; i < buffer->size; i++) {
+        buffer->front[i] = cell;
+    }
+    memset(buffer->dirtyBits, 0, DISPLAY_BUFFER_DIRTY_WORDS(buffer->size) * sizeof(uint32_t));
+    buffer->drainPos = 0;
+    buffer->waitTxBytes = 0;
+    buffer->draining = false;
+}
+
+bool displayIsBuffered(const displayPort_t *instance)
+{
+    return instance->buffer != NULL;
+}
+
+// Return true if a buffered display has a committed frame not yet completely sent
+bool displayIsDrawPending(const displayPort_t *instance)
+{
+    // can be called before initialised
+    return instance && instance->buffer && instance->buffer->draining;
+}
+
+// Return true if a buffered display has a frame to send and the device has room for the next run
+bool displayIsDrawReady(const displayPort_t *instance)
+{
+    return displayIsDrawPending(instance) && displayTxBytesFree(instance) >= instance->buffer->waitTxBytes;
+}
@@ -96,6 +96,7 @@ typedef enum {
 struct displayCanvas_s;
 struct osdCharacter_s;
 struct displayPortVTable_s;
+struct displayBuffer_s;
 
 typedef struct displayPort_s {
     const struct displayPortVTable_s *vTable;
@@ -116,6 +117,9 @@ typedef struct displayPort_s {
 
     // The type of display device
     displayPortDeviceType_e deviceType;
+
+    // Front/back canvas if the device is drawn asynchronously, see displayBufferInit()
+    struct displayBuffer_s *buffer;
 } displayPort_t;
 
 typedef struct displayPortVTable_s {
@@ -143,6 +147,23 @@ typedef struct displayPortVTable_s {
     void (*setBackgroundType)(displayPort_t *displayPort, displayPortBackground_e backgroundType);
 } displayPortVTable_t;
 
+// Cells of a buffered display hold the character in the low byte and the attribute in the high byte
+#define DISPLAY_BUFFER_CELL(c, attr) ((uint16_t)(uint8_t)(c) | ((uint16_t)(attr) << 8))
+#define DISPLAY_BUFFER_CELL_BLANK DISPLAY_BUFFER_CELL(' ', DISPLAYPORT_SEVERITY_NORMAL)
+#define DISPLAY_BUFFER_CELL_INVALID 0xffff
+#define DISPLAY_BUFFER_DIRTY_WORDS(cells) (((cells) + 31) / 32)
+
+typedef struct displayBuffer_s {
+    uint16_t *back;             // canvas drawn into by the OSD and CMS
+    uint16_t *front;            // last committed frame, as being sent to the device
+    uint32_t *dirtyBits;        // cells of the front canvas not yet sent
+    uint16_t size;              // cells available in each canvas
+    uint16_t drainPos;          // cell from which sending continues
+    uint8_t refreshRow;         // row re-sent with each frame in case the device lost it
+    uint8_t waitTxBytes;        // transmit space needed by the run the drain is waiting for
+    bool draining;              // front canvas not yet completely sent
+} displayBuffer_t;
+
 void displayGrab(displayPort_t *instance);
 void displayRelease(displayPort_t *instance);
 void displayReleaseAll(displayPort_t *instance);
@@ -170,3 +191,8 @@ bool displayLayerSelect(displayPort_t *instance, displayPortLayer_e layer);
 bool displayLayerCopy(displayPort_t *instance, displayPortLayer_e destLayer, displayPortLayer_e sourceLayer);
 void displaySetBackgroundType(displayPort_t *instance, displayPortBackground_e backgroundType);
 bool displaySupportsOsdSymbols(displayPort_t *instance);
+void displayBufferInit(displayPort_t *instance, displayBuffer_t *buffer, uint16_t *back, uint16_t *front, uint32_t *dirtyBits, uint16_t size);
+void displayBufferReset(displayPort_t *instance, uint16_t cell);
+bool displayIsBuffered(const displayPort_t *instance);
+bool displayIsDrawPending(const displayPort_t *instance);
+bool displayIsDrawReady(const displayPort_t *instance);
@@ -46,12 +46,15 @@
 
 #include "drivers/dshot_command.h"
 #include "drivers/nvic.h"
+#include "drivers/time.h"
 
 
 #include "pg/rpm_filter.h"
 
 #include "rx/rx.h"
 
+#include "sensors/esc_state.h"
+
 #define ERPM_PER_LSB            100.0f
 
 FAST_DATA_ZERO_INIT uint8_t dshotMotorCount = 0;
@@ -150,6 +153,9 @@ FAST_DATA_ZERO_INIT static float minMotorFrequencyHz;
 FAST_DATA_ZERO_INIT static float erpmToHz;
 FAST_DATA_ZERO_INIT static float dshotRpmAverage;
 FAST_DATA_ZERO_INIT static float dshotRpm[MAX_SUPPORTED_MOTORS];
+#ifdef USE_DSHOT_TELEMETRY_STATS
+FAST_DATA_ZERO_INIT static timeUs_t escStateErrorRateUpdatedUs;
+#endif
 
 void initDshotTelemetry(const timeUs_t looptimeUs)
 {
@@ -295,6 +301,27 @@ static void dshotUpdateTelemetryData(uint8_t motorIndex, dshotTelemetryType_t ty
     }
 }
 
+// The ESC state store uses 0.01V and 0.01A for all sources
+static void dshotUpdateEscState(uint8_t motorIndex, dshotTelemetryType_t type, uint32_t value, timeUs_t currentTimeUs)
+{
+    switch (type) {
+    case DSHOT_TELEMETRY_TYPE_eRPM:
+        escStateSet(motorIndex, ESC_STATE_ERPM, value, ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+        break;
+    case DSHOT_TELEMETRY_TYPE_TEMPERATURE:
+        escStateSet(motorIndex, ESC_STATE_TEMPERATURE, value, ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+        break;
+    case DSHOT_TELEMETRY_TYPE_VOLTAGE:
+        escStateSet(motorIndex, ESC_STATE_VOLTAGE, value * 25, ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+        break;
+    case DSHOT_TELEMETRY_TYPE_CURRENT:
+        escStateSet(motorIndex, ESC_STATE_CURRENT, value * 100, ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+        break;
+    default:
+        break;
+    }
+}
+
 FAST_CODE_NOINLINE void updateDshotTelemetry(void)
 {
     if (!useDshotTelemetry) {
@@ -309,6 +336,15 @@ FAST_CODE_NOINLINE void updateDshotTelemetry(void)
     const unsigned motorCount = dshotMotorCount;
     uint32_t erpmTotal = 0;
     uint32_t rpmSamples = 0;
+    const timeUs_t currentTimeUs = micros();
+
+#ifdef USE_DSHOT_TELEMETRY_STATS
+    // the invalid frame rate only changes with each stats bucket
+    const bool updateErrorRate = cmpTimeUs(currentTimeUs, escStateErrorRateUpdatedUs) >= DSHOT_TELEMETRY_QUALITY_BUCKET_MS * 1000;
+    if (updateErrorRate) {
+        escStateErrorRateUpdatedUs = currentTimeUs;
+    }
+#endif
 
     // Decode all telemetry data now to discharge interrupt from this task
     for (uint8_t k = 0; k < motorCount; k++) {
@@ -317,8 +353,10 @@ FAST_CODE_NOINLINE void updateDshotTelemetry(void)
 
         dshot_decode_telemetry_value(k, &value, &type);
 
+        escStateBeginUpdate(k);
         if (value != DSHOT_TELEMETRY_INVALID) {
             dshotUpdateTelemetryData(k, type, value);
+            dshotUpdateEscState(k, type, value, currentTimeUs);
 
             if (type == DSHOT_TELEMETRY_TYPE_eRPM) {
                 dshotRpm[k] = erpmToRpm(value);
@@ -326,6 +364,12 @@ FAST_CODE_NOINLINE void updateDshotTelemetry(void)
                 rpmSamples++;
             }
         }
+#ifdef USE_DSHOT_TELEMETRY_STATS
+        if (updateErrorRate && isDshotMotorTelemetryActive(k)) {
+            escStateSet(k, ESC_STATE_ERROR_RATE, getDshotTelemetryMotorInvalidPercent(k), ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+        }
+#endif
+        escStateEndUpdate(k, currentTimeUs);
     }
 
     // Update average
@@ -391,6 +435,7 @@ bool isDshotTelemetryActive(void)
 void dshotCleanTelemetryData(void)
 {
     memset(&dshotTelemetryState, 0, sizeof(dshotTelemetryState));
+    escStateReset();
 }
 
 #endif // USE_DSHOT_TELEMETRY
@@ -108,6 +108,56 @@ static uint32_t decode_bb_value(uint32_t value, uint16_t buffer[], uint32_t coun
     return value;
 }
 
+// Checks the levels found make up a frame, then adjusts the preamble skip and decodes the value
+static uint32_t decode_bb_frame(uint32_t value, uint32_t bits, uint32_t startMargin, timeUs_t now, uint16_t buffer[], uint32_t count, uint32_t bit)
+{
+    // length of last sequence has to be inferred since the last bit with inverted dshot is high
+    if (bits < 18) {
+        return DSHOT_TELEMETRY_NOEDGE;
+    }
+
+    // length of last sequence has to be inferred since the last bit with inverted dshot is high
+    const int nlen = 21 - bits;
+    if (nlen < 0) {
+        return DSHOT_TELEMETRY_NOEDGE;
+    }
+
+    // Data appears valid
+    if (startMargin < minMargin) {
+        minMargin = startMargin;
+    }
+
+    if (cmpTimeUs(now, nextMarginCheckUs) >= 0) {
+        nextMarginCheckUs += MARGIN_CHECK_INTERVAL_US;
+
+        // Handle a skipped check
+        if (nextMarginCheckUs < now) {
+            nextMarginCheckUs = now + DSHOT_TELEMETRY_START_MARGIN;
+        }
+
+        if (minMargin > DSHOT_TELEMETRY_START_MARGIN) {
+            preambleSkip = minMargin - DSHOT_TELEMETRY_START_MARGIN;
+        } else {
+            preambleSkip = 0;
+        }
+
+        minMargin = UINT32_MAX;
+    }
+
+#ifdef DEBUG_BBDECODE
+    sequence[sequenceIndex] = sequence[sequenceIndex] + (nlen) * 3;
+    sequenceIndex++;
+#endif
+
+    // The anticipated edges were observed
+    if (nlen > 0) {
+        value <<= nlen;
+        value |= 1 << (nlen - 1);
+    }
+
+    return decode_bb_value(value, buffer, count, bit);
+}
+
 #ifdef USE_DSHOT_BITBAND
 uint32_t decode_bb_bitband( uint16_t buffer[], uint32_t count, uint32_t bit)
 {
@@ -213,51 +263,7 @@ uint32_t decode_bb_bitband( uint16_t buffer[], uint32_t count, uint32_t bit)
         }
     }
 
-    // length of last sequence has to be inferred since the last bit with inverted dshot is high
-    if (bits < 18) {
-        return DSHOT_TELEMETRY_NOEDGE;
-    }
-
-    // length of last sequence has to be inferred since the last bit with inverted dshot is high
-    const int nlen = 21 - bits;
-    if (nlen < 0) {
-        return DSHOT_TELEMETRY_NOEDGE;
-    }
-
-    // Data appears valid
-    if (startMargin < minMargin) {
-        minMargin = startMargin;
-    }
-
-    if (cmpTimeUs(now, nextMarginCheckUs) >= 0) {
-        nextMarginCheckUs += MARGIN_CHECK_INTERVAL_US;
-
-        // Handle a skipped check
-        if (nextMarginCheckUs < now) {
-            nextMarginCheckUs = now + DSHOT_TELEMETRY_START_MARGIN;
-        }
-
-        if (minMargin > DSHOT_TELEMETRY_START_MARGIN) {
-            preambleSkip = minMargin - DSHOT_TELEMETRY_START_MARGIN;
-        } else {
-            preambleSkip = 0;
-        }
-
-        minMargin = UINT32_MAX;
-    }
-
-#ifdef DEBUG_BBDECODE
-    sequence[sequenceIndex] = sequence[sequenceIndex] + (nlen) * 3;
-    sequenceIndex++;
-#endif
-
-    // The anticipated edges were observed
-    if (nlen > 0) {
-        value <<= nlen;
-        value |= 1 << (nlen - 1);
-    }
-
-    return decode_bb_value(value, buffer, count, bit);
+    return decode_bb_frame(value, bits, startMargin, now, buffer, count, bit);
 }
 
 #else // USE_DSHOT_BITBAND
@@ -270,12 +276,6 @@ FAST_CODE uint32_t decode_bb( uint16_t buffer[], uint32_t count, uint32_t bit)
     sequenceIndex = 0;
 #endif
     uint32_t mask = 1 << bit;
-
-#ifdef DEBUG_BBDECODE
-    uint32_t sequence[MAX_GCR_EDGES];
-    memset(sequence, 0, sizeof(sequence));
-    int sequenceIndex = 0;
-#endif
     uint16_t lastValue = 0;
     uint32_t value = 0;
 
@@ -344,52 +344,128 @@ FAST_CODE uint32_t decode_bb( uint16_t buffer[], uint32_t count, uint32_t bit)
         }
     }
 
-    // length of last sequence has to be inferred since the last bit with inverted dshot is high
-    if (bits < 18) {
-        return DSHOT_TELEMETRY_NOEDGE;
-    }
+    return decode_bb_frame(value, bits, startMargin, now, buffer, count, bit);
+}
+#endif // USE_DSHOT_BITBAND
 
-    // length of last sequence has to be inferred since the last bit with inverted dshot is high
-    const int nlen = 21 - bits;
-    if (nlen < 0) {
-        return DSHOT_TELEMETRY_NOEDGE;
-    }
+#ifndef DEBUG_BBDECODE
+typedef struct bbPinDecode_s {
+    uint32_t value;
+    uint32_t bits;
+    uint32_t lastEdge;          // sample of the last level change
+    uint32_t end;               // level changes from this sample on are past the frame
+    uint32_t startMargin;       // samples up to and including the start bit
+} bbPinDecode_t;
+
+// Decodes the pins in one pass over the samples.
+// The levels of the pins are compared a sample word at a time, only the pins that changed are looked at.
+// The frames are read as decode_bb() reads them one pin at a time, only the preamble skip is shared by the pass.
+static FAST_CODE void decode_bb_pins(uint16_t buffer[], uint32_t count, uint16_t pinMask, uint32_t values[DSHOT_BB_PORT_PIN_COUNT])
+{
+    const timeUs_t now = micros();
+    bbPinDecode_t pins[DSHOT_BB_PORT_PIN_COUNT];
 
-    // Data appears valid
-    if (startMargin < minMargin) {
-        minMargin = startMargin;
-    }
+    // a frame must start early enough to leave room for its shortest form
+    const uint32_t startEnd = count > MIN_VALID_BBSAMPLES ? count - MIN_VALID_BBSAMPLES - 1 : 0;
+    uint32_t waiting = pinMask;     // looking for the start bit
+    uint32_t active = 0;            // decoding
+    uint32_t found = 0;
+    uint32_t lastEnd = 0;
+    uint32_t previous = 0;
 
-    if (cmpTimeUs(now, nextMarginCheckUs) >= 0) {
-        nextMarginCheckUs += MARGIN_CHECK_INTERVAL_US;
+    DEBUG_SET(DEBUG_DSHOT_TELEMETRY_COUNTS, 3, preambleSkip);
 
-        // Handle a skipped check
-        if (nextMarginCheckUs < now) {
-            nextMarginCheckUs = now + DSHOT_TELEMETRY_START_MARGIN;
+    for (uint32_t i = preambleSkip; i < count; i++) {
+        const uint32_t sample = buffer[i];
+        uint32_t edges = (sample ^ previous) & active;
+        previous = sample;
+
+        while (edges) {
+            const unsigned pin = __builtin_ctz(edges);
+            edges &= edges - 1;
+            bbPinDecode_t *pinDecode = &pins[pin];
+            if (i >= pinDecode->end) {
+                active &= ~(1 << pin);
+                continue;
+            }
+            // A level of length n gets decoded to a sequence of bits of
+            // the form 1000 with a length of (n+1) / 3 to account for 3x
+            // oversampling.
+            const int len = MAX((int)(i - pinDecode->lastEdge + 1) / 3, 1);
+            pinDecode->bits += len;
+            pinDecode->value <<= len;
+            pinDecode->value |= 1 << (len - 1);
+            pinDecode->lastEdge = i;
         }
 
-        if (minMargin > DSHOT_TELEMETRY_START_MARGIN) {
-            preambleSkip = minMargin - DSHOT_TELEMETRY_START_MARGIN;
-        } else {
-            preambleSkip = 0;
+        if (waiting) {
+            if (i >= startEnd) {
+                // the pins still high sent no telemetry
+                waiting = 0;
+            } else {
+                // the first low level is the start bit
+                uint32_t starts = ~sample & waiting;
+                waiting &= ~starts;
+                active |= starts;
+                found |= starts;
+                while (starts) {
+                    const unsigned pin = __builtin_ctz(starts);
+                    starts &= starts - 1;
+                    bbPinDecode_t *pinDecode = &pins[pin];
+                    pinDecode->value = 0;
+                    pinDecode->bits = 0;
+                    pinDecode->lastEdge = i;
+                    pinDecode->startMargin = i + 1;
+                    pinDecode->end = i + MIN(count - (i + 1), (uint32_t)MAX_VALID_BBSAMPLES);
+                    lastEnd = MAX(lastEnd, pinDecode->end);
+                }
+            }
         }
 
-        minMargin = UINT32_MAX;
+        if (!waiting && i + 1 >= lastEnd) {
+            break;
+        }
     }
 
-#ifdef DEBUG_BBDECODE
-    sequence[sequenceIndex] = sequence[sequenceIndex] + (nlen) * 3;
-    sequenceIndex++;
-#endif
-
-    // The anticipated edges were observed
-    if (nlen > 0) {
-        value <<= nlen;
-        value |= 1 << (nlen - 1);
+    for (unsigned pin = 0; pin < DSHOT_BB_PORT_PIN_COUNT; pin++) {
+        if (!(pinMask & (1 << pin))) {
+            continue;
+        }
+        if (!(found & (1 << pin))) {
+            // not returning telemetry is ok if the esc cpu is overburdened
+            if (preambleSkip > 0) {
+                // Increase the start margin
+                preambleSkip--;
+            }
+            values[pin] = DSHOT_TELEMETRY_NOEDGE;
+            continue;
+        }
+        const bbPinDecode_t *pinDecode = &pins[pin];
+        values[pin] = decode_bb_frame(pinDecode->value, pinDecode->bits, pinDecode->startMargin, now, buffer, count, pin);
     }
+}
+#endif // DEBUG_BBDECODE
 
-    return decode_bb_value(value, buffer, count, bit);
+// Decodes the telemetry of all motors on a GPIO port
+FAST_CODE void decode_bb_port(uint16_t buffer[], uint32_t count, uint16_t pinMask, uint32_t values[DSHOT_BB_PORT_PIN_COUNT])
+{
+    // A single pin is quicker with the per pin decoders.
+    // DEBUG_BBDECODE keeps to those, they record the edges of a bad frame for dshot_telemetry_info.
+#ifndef DEBUG_BBDECODE
+    if (pinMask & (pinMask - 1)) {
+        decode_bb_pins(buffer, count, pinMask, values);
+        return;
+    }
+#endif
+    for (unsigned pin = 0; pin < DSHOT_BB_PORT_PIN_COUNT; pin++) {
+        if (pinMask & (1 << pin)) {
+#ifdef USE_DSHOT_BITBAND
+            values[pin] = decode_bb_bitband(buffer, count, pin);
+#else
+            values[pin] = decode_bb(buffer, count, pin);
+#endif
+        }
+    }
 }
-#endif // USE_DSHOT_BITBAND
 
 #endif
@@ -22,10 +22,15 @@
 
 #if defined(USE_DSHOT) && defined(USE_DSHOT_TELEMETRY)
 
+#define DSHOT_BB_PORT_PIN_COUNT 16
+
 #ifdef USE_DSHOT_BITBAND
 uint32_t decode_bb_bitband( uint16_t buffer[], uint32_t count, uint32_t bit);
 #else
 uint32_t decode_bb(uint16_t buffer[], uint32_t count, uint32_t mask);
 #endif
 
+// Decodes the pins of pinMask from the samples of their GPIO port, values[pin] receives what decode_bb() would return
+void decode_bb_port(uint16_t buffer[], uint32_t count, uint16_t pinMask, uint32_t values[DSHOT_BB_PORT_PIN_COUNT]);
+
 #endif
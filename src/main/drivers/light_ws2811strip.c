@@ -36,6 +36,7 @@
 #ifdef USE_LED_STRIP
 
 #include "build/build_config.h"
+#include "build/debug.h"
 
 #include "common/color.h"
 #include "common/colorconversion.h"
@@ -74,6 +75,12 @@ uint16_t BIT_COMPARE_0 = 0;
 
 static hsvColor_t ledColorBuffer[WS2811_DATA_BUFFER_SIZE];
 
+#if !defined(USE_WS2811_SINGLE_COLOUR)
+// Scaled colour currently encoded in ledStripDMABuffer for each LED, so that unchanged LEDs are not re-encoded
+static hsvColor_t ledEncodedColor[WS2811_DATA_BUFFER_SIZE];
+static ledStripFormatRGB_e ledEncodedFormat;
+#endif
+
 #if !defined(USE_WS2811_SINGLE_COLOUR)
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
@@ -122,6 +129,7 @@ void setUsedLedCount(unsigned ledCount)
 void ws2811LedStripInit(ioTag_t ioTag)
 {
     memset(ledStripDMABuffer, 0, sizeof(ledStripDMABuffer));
+    needsFullRefresh = true;
 
     ledStripIoTag = ioTag;
 }
@@ -149,6 +157,11 @@ bool isWS2811LedStripReady(void)
     return ws2811Initialised && !ws2811LedDataTransferInProgress;
 }
 
+static bool hsvColorEqual(const hsvColor_t *a, const hsvColor_t *b)
+{
+    return a->h == b->h && a->s == b->s && a->v == b->v;
+}
+
 STATIC_UNIT_TESTED void updateLEDDMABuffer(ledStripFormatRGB_e ledFormat, rgbColor24bpp_t *color, unsigned ledIndex)
 {
     uint32_t bits_per_led;
@@ -196,6 +209,20 @@ bool ws2811UpdateStrip(ledStripFormatRGB_e ledFormat, uint8_t brightness)
         return false;
     }
 
+#if !defined(USE_WS2811_SINGLE_COLOUR)
+    if (ledFormat != ledEncodedFormat) {
+        // Every LED has to be re-encoded in the new format, so restart any partial update
+        ledEncodedFormat = ledFormat;
+        needsFullRefresh = true;
+        ledIndex = 0;
+    }
+#endif
+
+    // Neighbouring LEDs are usually the same colour, so reuse the last conversion (black converts to zero)
+    static hsvColor_t convertedHsv;
+    static rgbColor24bpp_t convertedRgb;
+    static uint8_t encodedCount = 0;
+
     // fill transmit buffer with correct compare values to achieve
     // correct pulse widths according to color values
     const unsigned ledUpdateCount = needsFullRefresh ? WS2811_DATA_BUFFER_SIZE : usedLedCount;
@@ -205,9 +232,23 @@ bool ws2811UpdateStrip(ledStripFormatRGB_e ledFormat, uint8_t brightness)
         // Scale the LED brightness
         scaledLed.v = scaledLed.v * brightness / 100;
 
-        rgbColor24bpp_t *rgb24 = hsvToRgb24(&scaledLed);
+#if !defined(USE_WS2811_SINGLE_COLOUR)
+        // The bits of an unchanged LED are still in the DMA buffer from the previous update
+        hsvColor_t *encoded = &ledEncodedColor[ledIndex];
+        if (!needsFullRefresh && hsvColorEqual(encoded, &scaledLed)) {
+            ledIndex++;
+            continue;
+        }
+        *encoded = scaledLed;
+#endif
+
+        if (!hsvColorEqual(&convertedHsv, &scaledLed)) {
+            convertedRgb = *hsvToRgb24(&scaledLed);
+            convertedHsv = scaledLed;
+        }
 
-        updateLEDDMABuffer(ledFormat, rgb24, ledIndex++);
+        updateLEDDMABuffer(ledFormat, &convertedRgb, ledIndex++);
+        encodedCount++;
 
         if (cmpTimeUs(micros(), startTime) > LED_TARGET_UPDATE_US) {
             return false;
@@ -216,6 +257,9 @@ bool ws2811UpdateStrip(ledStripFormatRGB_e ledFormat, uint8_t brightness)
     ledIndex = 0;
     needsFullRefresh = false;
 
+    DEBUG_SET(DEBUG_LED_STRIP, DEBUG_LED_STRIP_ENCODED, encodedCount);
+    encodedCount = 0;
+
 #ifdef USE_LED_STRIP_CACHE_MGMT
     SCB_CleanDCache_by_Addr(ledStripDMABuffer, WS2811_DMA_BUF_CACHE_ALIGN_BYTES);
 #endif
@@ -28,6 +28,8 @@
 
 #include "build/debug.h"
 
+#include "common/maths.h"
+
 #include "pg/max7456.h"
 #include "pg/vcd.h"
 
@@ -57,6 +59,12 @@
 #define DEBUG_MAX7456_SPICLOCK_DIVISOR     2
 #define DEBUG_MAX7456_SPICLOCK_X100        3
 
+// DEBUG_MAX7456_DRAW
+#define DEBUG_MAX7456_DRAW_BYTES           0 // SPI bytes queued by the last max7456DrawScreen() call
+#define DEBUG_MAX7456_DRAW_US              1 // SPI transfer time of those bytes
+#define DEBUG_MAX7456_DRAW_MAX_US          2 // Worst case SPI transfer time of any call
+#define DEBUG_MAX7456_DRAW_DIRTY           3 // Cells still to be sent
+
 // VM0 bits
 #define VIDEO_BUFFER_DISABLE        0x01
 #define MAX7456_RESET               0x02
@@ -203,6 +211,18 @@ uint16_t maxScreenSize = VIDEO_BUFFER_CHARS_PAL;
 
 static uint8_t shadowBuffer[VIDEO_BUFFER_CHARS_PAL];
 
+// The comparison is made as characters are written, setting a bit in dirtyBits for
+// each foreground cell which differs from shadowBuffer, so max7456DrawScreen() only
+// visits the cells to be sent. Clearing the layer dirties all non-blank shadow cells.
+
+#define DIRTY_WORD_COUNT ((VIDEO_BUFFER_CHARS_PAL + 31) / 32)
+
+static uint32_t dirtyBits[DIRTY_WORD_COUNT];
+static uint32_t shadowNonBlankBits[DIRTY_WORD_COUNT];
+
+// Dirty cells separated by up to this many clean cells are sent in one auto-increment burst
+#define MAX_BURST_GAP           2
+
 //Max bytes to update in one call to max7456DrawScreen()
 
 #define MAX_BYTES2SEND          250
@@ -222,6 +242,7 @@ static uint8_t  vosRegValue; // VOS (Vertical offset register) value
 static bool fontIsLoading       = false;
 
 static uint8_t max7456DeviceType;
+static uint32_t max7456SpiClockHz;
 
 static displayPortBackground_e deviceBackgroundType = DISPLAY_BACKGROUND_TRANSPARENT;
 
@@ -240,6 +261,47 @@ static uint8_t *getActiveLayerBuffer(void)
     return getLayerBuffer(activeLayer);
 }
 
+static void setCell(uint16_t pos, uint8_t c)
+{
+    getActiveLayerBuffer()[pos] = c;
+
+    if (activeLayer == DISPLAYPORT_LAYER_FOREGROUND) {
+        if (c != shadowBuffer[pos]) {
+            dirtyBits[pos / 32] |= 1U << (pos % 32);
+        } else {
+            dirtyBits[pos / 32] &= ~(1U << (pos % 32));
+        }
+    }
+}
+
+static void setShadowCell(uint16_t pos, uint8_t c)
+{
+    shadowBuffer[pos] = c;
+
+    dirtyBits[pos / 32] &= ~(1U << (pos % 32));
+    if (c != ' ') {
+        shadowNonBlankBits[pos / 32] |= 1U << (pos % 32);
+    } else {
+        shadowNonBlankBits[pos / 32] &= ~(1U << (pos % 32));
+    }
+}
+
+// Return the first cell at or after pos with the given dirty state, or maxScreenSize
+static uint16_t findCell(uint16_t pos, bool dirty)
+{
+    while (pos < maxScreenSize) {
+        uint32_t word = dirty ? dirtyBits[pos / 32] : ~dirtyBits[pos / 32];
+        word &= ~0U << (pos % 32);
+        if (word) {
+            pos = (pos & ~31) + __builtin_ctz(word);
+            break;
+        }
+        pos = (pos & ~31) + 32;
+    }
+
+    return MIN(pos, maxScreenSize);
+}
+
 static void max7456SetRegisterVM1(void)
 {
     uint8_t backgroundGray = BACKGROUND_BRIGHTNESS_28; // this is the device default background gray level
@@ -273,12 +335,18 @@ uint8_t max7456GetRowsCount(void)
 static void max7456ClearShadowBuffer(void)
 {
     memset(shadowBuffer, 0, maxScreenSize);
+    memset(shadowNonBlankBits, 0xff, sizeof(shadowNonBlankBits));
+    memset(dirtyBits, 0xff, sizeof(dirtyBits));
 }
 
 // Buffer is filled with the whitespace character (0x20)
 static void max7456ClearLayer(displayPortLayer_e layer)
 {
     memset(getLayerBuffer(layer), 0x20, VIDEO_BUFFER_CHARS_PAL);
+
+    if (layer == DISPLAYPORT_LAYER_FOREGROUND) {
+        memcpy(dirtyBits, shadowNonBlankBits, sizeof(dirtyBits));
+    }
 }
 
 static void max7456ReInit(void)
@@ -343,6 +411,8 @@ max7456InitStatus_e max7456Init(const max7456Config_t *max7456Config, const vcdP
     max7456DeviceDetected = false;
     deviceBackgroundType = DISPLAY_BACKGROUND_TRANSPARENT;
 
+    max7456ClearShadowBuffer();
+
     // initialize all layers
     for (unsigned i = 0; i < MAX7456_SUPPORTED_LAYER_COUNT; i++) {
         max7456ClearLayer(i);
@@ -425,6 +495,7 @@ max7456InitStatus_e max7456Init(const max7456Config_t *max7456Config, const vcdP
 #endif
 
     spiSetClkDivisor(dev, max7456SpiClockDiv);
+    max7456SpiClockHz = spiCalculateClock(max7456SpiClockDiv);
 
     // force soft reset on Max7456
     spiWriteReg(dev, MAX7456ADD_VM0, MAX7456_RESET);
@@ -492,19 +563,17 @@ void max7456ClearScreen(void)
 
 void max7456WriteChar(uint8_t x, uint8_t y, uint8_t c)
 {
-    uint8_t *buffer = getActiveLayerBuffer();
     if (x < CHARS_PER_LINE && y < VIDEO_LINES_PAL) {
-        buffer[y * CHARS_PER_LINE + x] = c;
+        setCell(y * CHARS_PER_LINE + x, c);
     }
 }
 
 void max7456Write(uint8_t x, uint8_t y, const char *text)
 {
     if (y < VIDEO_LINES_PAL) {
-        uint8_t *buffer = getActiveLayerBuffer();
         const uint32_t bufferYOffset = y * CHARS_PER_LINE;
         for (int i = 0, bufferXOffset = x; text[i] && bufferXOffset < CHARS_PER_LINE; i++, bufferXOffset++) {
-            buffer[bufferYOffset + bufferXOffset] = text[i];
+            setCell(bufferYOffset + bufferXOffset, text[i]);
         }
     }
 }
@@ -532,6 +601,10 @@ bool max7456LayerCopy(displayPortLayer_e destLayer, displayPortLayer_e sourceLay
 {
     if ((sourceLayer != destLayer) && max7456LayerSupported(sourceLayer) && max7456LayerSupported(destLayer)) {
         memcpy(getLayerBuffer(destLayer), getLayerBuffer(sourceLayer), VIDEO_BUFFER_CHARS_PAL);
+        if (destLayer == DISPLAYPORT_LAYER_FOREGROUND) {
+            // Let max7456DrawScreen() find what changed
+            memset(dirtyBits, 0xff, sizeof(dirtyBits));
+        }
         return true;
     } else {
         return false;
@@ -545,12 +618,7 @@ bool max7456DmaInProgress(void)
 
 bool max7456BuffersSynced(void)
 {
-    for (int i = 0; i < maxScreenSize; i++) {
-        if (displayLayers[DISPLAYPORT_LAYER_FOREGROUND].buffer[i] != shadowBuffer[i]) {
-            return false;
-        }
-    }
-    return true;
+    return findCell(0, true) == maxScreenSize;
 }
 
 bool max7456ReInitIfRequired(bool forceStallCheck)
@@ -622,114 +690,123 @@ static busStatus_e max7456_callbackReady(uint32_t arg)
 }
 
 // Return true if screen still being transferred
+//
+// Runs of dirty cells are sent as auto-increment bursts in a single spiSequence() of at
+// most MAX_BYTES2SEND bytes, so each call occupies the bus for no more than
+// MAX_BYTES2SEND * 8 SPI clocks (200us at 10MHz) regardless of how much has changed.
 bool max7456DrawScreen(void)
 {
-    static uint16_t pos = 0;
+    static timeDelta_t maxTransferUs = 0;
     // This routine doesn't block so need to use static data
     static busSegment_t segments[] = {
             {.u.link = {NULL, NULL}, 0, true, max7456_callbackReady},
             {.u.link = {NULL, NULL}, 0, true, NULL},
     };
 
-    if (!fontIsLoading) {
-        uint8_t *buffer = getActiveLayerBuffer();
-        int spiBufIndex = 0;
-        int maxSpiBufStartIndex;
-        timeDelta_t maxEncodeTime;
-        bool setAddress = true;
-        bool autoInc = false;
-        int posLimit = pos + (maxScreenSize / 2);
+    if (fontIsLoading) {
+        return false;
+    }
+
+    // Abort for now if the bus is still busy
+    if (spiIsBusy(dev)) {
+        // Not finished yet
+        return true;
+    }
+
+    uint8_t *buffer = getLayerBuffer(DISPLAYPORT_LAYER_FOREGROUND);
+    int spiBufIndex = 0;
+    bool autoInc = false;
 
 #ifdef USE_DMA
-        const bool useDma = spiUseSDO_DMA(dev);
+    const bool useDma = spiUseSDO_DMA(dev);
 #else
-        const bool useDma = false;
+    const bool useDma = false;
 #endif
-        maxSpiBufStartIndex = useDma ? MAX_BYTES2SEND : MAX_BYTES2SEND_POLLED;
-        maxEncodeTime = useDma ? MAX_ENCODE_US : MAX_ENCODE_US_POLLED;
+    const int maxSpiBufIndex = useDma ? MAX_BYTES2SEND : MAX_BYTES2SEND_POLLED;
+    const timeDelta_t maxEncodeTime = useDma ? MAX_ENCODE_US : MAX_ENCODE_US_POLLED;
 
-        // Abort for now if the bus is still busy
-        if (spiIsBusy(dev)) {
-            // Not finished yet
-            return true;
-        }
+    const timeUs_t startTime = micros();
 
-        timeUs_t startTime = micros();
+    uint16_t pos = findCell(0, true);
 
-        // Allow for an ESCAPE, a reset of DMM and a two byte MAX7456ADD_DMM command at end of buffer
-        maxSpiBufStartIndex -= 4;
+    while ((pos < maxScreenSize) && (cmpTimeUs(micros(), startTime) < maxEncodeTime)) {
+        // Find the end of this burst, bridging short gaps of unchanged cells
+        uint16_t end = findCell(pos, false);
+        uint16_t next = findCell(end, true);
+        while ((next < maxScreenSize) && (next - end <= MAX_BURST_GAP)) {
+            end = findCell(next, false);
+            next = findCell(end, true);
+        }
 
-        // Initialise the transfer buffer
-        while ((spiBufIndex < maxSpiBufStartIndex) && (pos < posLimit) && (cmpTimeUs(micros(), startTime) < maxEncodeTime)) {
-            if (buffer[pos] != shadowBuffer[pos]) {
-                if (buffer[pos] == 0xff) {
-                    buffer[pos] = ' ';
-                }
+        const bool burst = (end - pos) > 1;
 
-                if (setAddress || !autoInc) {
-                    if (buffer[pos + 1] != shadowBuffer[pos + 1]) {
-                        // It's worth auto incrementing
-                        spiBuf[spiBufIndex++] = MAX7456ADD_DMM;
-                        spiBuf[spiBufIndex++] = displayMemoryModeReg | DMM_AUTO_INC;
-                        autoInc = true;
-                    } else {
-                        // It's not worth auto incrementing
-                        spiBuf[spiBufIndex++] = MAX7456ADD_DMM;
-                        spiBuf[spiBufIndex++] = displayMemoryModeReg;
-                        autoInc = false;
-                    }
+        // Mode change, address and, for a burst, the END_STRING terminator
+        const int overhead = ((burst != autoInc) ? 2 : 0) + 4 + (burst ? 2 : 0);
+        const int count = MIN(end - pos, (maxSpiBufIndex - spiBufIndex - overhead) / 2);
 
-                    spiBuf[spiBufIndex++] = MAX7456ADD_DMAH;
-                    spiBuf[spiBufIndex++] = pos >> 8;
-                    spiBuf[spiBufIndex++] = MAX7456ADD_DMAL;
-                    spiBuf[spiBufIndex++] = pos & 0xff;
+        if (count < 1) {
+            break;
+        }
 
-                    setAddress = false;
-                }
+        if (burst != autoInc) {
+            spiBuf[spiBufIndex++] = MAX7456ADD_DMM;
+            spiBuf[spiBufIndex++] = burst ? (displayMemoryModeReg | DMM_AUTO_INC) : displayMemoryModeReg;
+            autoInc = burst;
+        }
 
-                spiBuf[spiBufIndex++] = MAX7456ADD_DMDI;
-                spiBuf[spiBufIndex++] = buffer[pos];
+        spiBuf[spiBufIndex++] = MAX7456ADD_DMAH;
+        spiBuf[spiBufIndex++] = pos >> 8;
+        spiBuf[spiBufIndex++] = MAX7456ADD_DMAL;
+        spiBuf[spiBufIndex++] = pos & 0xff;
 
-                shadowBuffer[pos] = buffer[pos];
-            } else {
-                if (!setAddress) {
-                    setAddress = true;
-                    if (autoInc) {
-                        spiBuf[spiBufIndex++] = MAX7456ADD_DMDI;
-                        spiBuf[spiBufIndex++] = END_STRING;
-                    }
-                }
+        for (int i = 0; i < count; i++, pos++) {
+            if (buffer[pos] == 0xff) {
+                buffer[pos] = ' ';
             }
 
-            if (++pos >= maxScreenSize) {
-                pos = 0;
-                break;
-            }
-        }
+            spiBuf[spiBufIndex++] = MAX7456ADD_DMDI;
+            spiBuf[spiBufIndex++] = buffer[pos];
 
-        if (autoInc) {
-            if (!setAddress) {
-                spiBuf[spiBufIndex++] = MAX7456ADD_DMDI;
-                spiBuf[spiBufIndex++] = END_STRING;
-            }
+            setShadowCell(pos, buffer[pos]);
+        }
 
-            spiBuf[spiBufIndex++] = MAX7456ADD_DMM;
-            spiBuf[spiBufIndex++] = displayMemoryModeReg;
+        if (burst) {
+            // END_STRING also takes the device out of auto-increment mode
+            spiBuf[spiBufIndex++] = MAX7456ADD_DMDI;
+            spiBuf[spiBufIndex++] = END_STRING;
+            autoInc = false;
         }
 
-        if (spiBufIndex) {
-            segments[0].u.buffers.txData = spiBuf;
-            segments[0].len = spiBufIndex;
+        pos = findCell(pos, true);
+    }
+
+    if (spiBufIndex) {
+        segments[0].u.buffers.txData = spiBuf;
+        segments[0].len = spiBufIndex;
 
-            max7456ActiveDma = true;
+        max7456ActiveDma = true;
 
-            spiSequence(dev, &segments[0]);
+        spiSequence(dev, &segments[0]);
 
-            // Non-blocking, so transfer still in progress if using DMA
+        // Non-blocking, so transfer still in progress if using DMA
+    }
+
+    if (debugMode == DEBUG_MAX7456_DRAW) {
+        const timeDelta_t transferUs = max7456SpiClockHz ? (spiBufIndex * 8 * 1000000LL) / max7456SpiClockHz : 0;
+        maxTransferUs = MAX(maxTransferUs, transferUs);
+
+        int dirtyCount = 0;
+        for (uint16_t i = findCell(0, true); i < maxScreenSize; i = findCell(i + 1, true)) {
+            dirtyCount++;
         }
+
+        DEBUG_SET(DEBUG_MAX7456_DRAW, DEBUG_MAX7456_DRAW_BYTES, spiBufIndex);
+        DEBUG_SET(DEBUG_MAX7456_DRAW, DEBUG_MAX7456_DRAW_US, transferUs);
+        DEBUG_SET(DEBUG_MAX7456_DRAW, DEBUG_MAX7456_DRAW_MAX_US, maxTransferUs);
+        DEBUG_SET(DEBUG_MAX7456_DRAW, DEBUG_MAX7456_DRAW_DIRTY, dirtyCount);
     }
 
-    return (pos != 0);
+    return (pos < maxScreenSize);
 }
 
 // should not be used when armed
@@ -20,12 +20,40 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
+#include "common/maths.h"
+#include "common/utils.h"
+
 #include "io/serial.h"
 #include "serial.h"
 
+#ifdef USE_SERIAL_STATS
+// Account for count bytes about to be queued when txFree bytes are free in the transmit buffer
+static void serialStatsTx(serialPort_t *instance, uint32_t txFree, int count)
+{
+    instance->stats.txBytes += count;
+    if (txFree < (uint32_t)count) {
+        instance->stats.txStalls++;
+    }
+    if (instance->txBufferSize > txFree) {
+        const uint32_t queued = MIN(instance->txBufferSize - 1 - txFree + count, instance->txBufferSize);
+        instance->stats.txHighWater = MAX(instance->stats.txHighWater, MIN(queued, (uint32_t)UINT16_MAX));
+    }
+}
+#endif
+
+void serialResetStats(serialPort_t *instance)
+{
+#ifdef USE_SERIAL_STATS
+    memset(&instance->stats, 0, sizeof(instance->stats));
+#else
+    UNUSED(instance);
+#endif
+}
+
 void serialPrint(serialPort_t *instance, const char *str)
 {
     uint8_t ch;
@@ -41,11 +69,29 @@ uint32_t serialGetBaudRate(serialPort_t *instance)
 
 void serialWrite(serialPort_t *instance, uint8_t ch)
 {
+#ifdef USE_SERIAL_STATS
+    // The room seen at the last sample cannot shrink until it has been written, so the
+    // level is only sampled again once it is used up rather than for every byte
+    serialPortStats_t *stats = &instance->stats;
+    if (stats->txWritesUnsampled) {
+        stats->txWritesUnsampled--;
+        stats->txBytes++;
+    } else {
+        const uint32_t txFree = serialTxBytesFree(instance);
+        serialStatsTx(instance, txFree, 1);
+        stats->txWritesUnsampled = MIN(txFree ? txFree - 1 : 0, (uint32_t)UINT16_MAX);
+    }
+#endif
     instance->vTable->serialWrite(instance, ch);
 }
 
 void serialWriteBufNoFlush(serialPort_t *instance, const uint8_t *data, int count)
 {
+#ifdef USE_SERIAL_STATS
+    // Sampled once for the whole buffer, the next single byte write samples again
+    serialStatsTx(instance, serialTxBytesFree(instance), count);
+    instance->stats.txWritesUnsampled = 0;
+#endif
     if (instance->vTable->writeBuf) {
         instance->vTable->writeBuf(instance, data, count);
     } else {
@@ -54,7 +100,7 @@ void serialWriteBufNoFlush(serialPort_t *instance, const uint8_t *data, int coun
         };
 
         for (const uint8_t *p = data; count > 0; count--, p++) {
-            serialWrite(instance, *p);
+            instance->vTable->serialWrite(instance, *p);
         }
     }
 }
@@ -71,6 +117,24 @@ uint32_t serialTxBytesFree(const serialPort_t *instance)
 
 uint8_t serialRead(serialPort_t *instance)
 {
+#ifdef USE_SERIAL_STATS
+    serialPortStats_t *stats = &instance->stats;
+    stats->rxBytes++;
+    // The level is sampled when the bytes seen waiting at the last sample have been read,
+    // which is once for each pass draining the buffer rather than for every byte
+    if (stats->rxReadsUnsampled) {
+        stats->rxReadsUnsampled--;
+    } else {
+        const uint32_t waiting = MIN(instance->vTable->serialTotalRxWaiting(instance), (uint32_t)UINT16_MAX);
+        stats->rxHighWater = MAX(stats->rxHighWater, waiting);
+        stats->rxReadsUnsampled = waiting ? waiting - 1 : 0;
+    }
+    // The buffer holds the timed byte, so the receiver does not time another one meanwhile
+    if (stats->rxArrivalPending) {
+        stats->rxLatencyMaxUs = MAX(stats->rxLatencyMaxUs, (uint32_t)cmpTimeUs(micros(), stats->rxArrivalUs));
+        stats->rxArrivalPending = false;
+    }
+#endif
     return instance->vTable->serialRead(instance);
 }
 
@@ -110,6 +174,17 @@ void serialSetBaudRateCb(serialPort_t *serialPort, void (*cb)(serialPort_t *cont
     }
 }
 
+void serialSetIdleCallback(serialPort_t *serialPort, serialIdleCallbackPtr cb)
+{
+    // Drivers which only take the idle line interrupt for ports with a callback reconfigure
+    // the port, the others just call it from their receive interrupt.
+    if (serialPort->vTable->setIdleCallback) {
+        serialPort->vTable->setIdleCallback(serialPort, cb);
+    } else {
+        serialPort->idleCallback = cb;
+    }
+}
+
 void serialBeginWrite(serialPort_t *instance)
 {
     if (instance->vTable->beginWrite)
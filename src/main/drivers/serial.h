@@ -24,6 +24,7 @@
 #include "drivers/io_types.h"
 #include "drivers/resource.h"
 #include "drivers/serial_resource.h"
+#include "drivers/time.h"
 
 #include "pg/pg.h"
 
@@ -75,6 +76,21 @@ typedef enum {
 typedef void (*serialReceiveCallbackPtr)(uint16_t data, void *rxCallbackData);   // used by serial drivers to return frames to app
 typedef void (*serialIdleCallbackPtr)(void);
 
+// Traffic counters kept for every open port, used to size buffers and baud rates
+typedef struct serialPortStats_s {
+    uint32_t rxBytes;       // Bytes read by the application or passed to the receive callback
+    uint32_t txBytes;       // Bytes queued for transmission
+    uint16_t rxOverruns;    // Bytes lost by the receiver or written into a full receive buffer
+    uint16_t txStalls;      // Writes which found too little room in the transmit buffer
+    uint16_t rxHighWater;   // Most bytes seen waiting in the receive buffer
+    uint16_t txHighWater;   // Most bytes seen queued in the transmit buffer
+    uint32_t rxLatencyMaxUs; // Longest a byte received into an empty buffer waited to be read
+    timeUs_t rxArrivalUs;   // When a byte was received into the empty buffer, valid while rxArrivalPending
+    bool rxArrivalPending;
+    uint16_t rxReadsUnsampled;  // Reads left before the receive buffer level is sampled again
+    uint16_t txWritesUnsampled; // Single byte writes left before the transmit buffer level is sampled again
+} serialPortStats_t;
+
 typedef struct serialPort_s {
 
     const struct serialPortVTable *vTable;
@@ -99,6 +115,10 @@ typedef struct serialPort_s {
     serialIdleCallbackPtr idleCallback;
 
     int8_t identifier;  // actually serialPortIdentifier_e; avoid circular header dependency
+
+#ifdef USE_SERIAL_STATS
+    serialPortStats_t stats;
+#endif
 } serialPort_t;
 
 typedef struct serialPinConfig_s {
@@ -127,6 +147,7 @@ struct serialPortVTable {
     void (*setMode)(serialPort_t *instance, portMode_e mode);
     void (*setCtrlLineStateCb)(serialPort_t *instance, void (*cb)(void *instance, uint16_t ctrlLineState), void *context);
     void (*setBaudRateCb)(serialPort_t *instance, void (*cb)(serialPort_t *context, uint32_t baud), serialPort_t *context);
+    void (*setIdleCallback)(serialPort_t *instance, serialIdleCallbackPtr cb);
 
     void (*writeBuf)(serialPort_t *instance, const void *data, int count);
     // Optional functions used to buffer large writes.
@@ -144,10 +165,49 @@ void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_e mode);
 void serialSetCtrlLineStateCb(serialPort_t *instance, void (*cb)(void *context, uint16_t ctrlLineState), void *context);
 void serialSetBaudRateCb(serialPort_t *instance, void (*cb)(serialPort_t *context, uint32_t baud), serialPort_t *context);
+void serialSetIdleCallback(serialPort_t *instance, serialIdleCallbackPtr cb);
 bool isSerialTransmitBufferEmpty(const serialPort_t *instance);
 void serialPrint(serialPort_t *instance, const char *str);
 uint32_t serialGetBaudRate(serialPort_t *instance);
 
+void serialResetStats(serialPort_t *instance);
+
+// Called by drivers from their receive interrupt. Bytes stored in the receive buffer are
+// counted as they are read, but bytes passed to the receive callback never reach serialRead().
+static inline void serialStatsRxCallback(serialPort_t *instance)
+{
+#ifdef USE_SERIAL_STATS
+    instance->stats.rxBytes++;
+#else
+    (void)instance;
+#endif
+}
+
+static inline void serialStatsRxOverrun(serialPort_t *instance)
+{
+#ifdef USE_SERIAL_STATS
+    instance->stats.rxOverruns++;
+#else
+    (void)instance;
+#endif
+}
+
+// Called before a received byte is stored at rxBufferHead. A byte stored into an empty buffer
+// is timed until serialRead() reads it, which gives how late the application serves the port.
+static inline void serialStatsRxStore(serialPort_t *instance)
+{
+#ifdef USE_SERIAL_STATS
+    if (instance->rxBufferHead == instance->rxBufferTail) {
+        instance->stats.rxArrivalUs = micros();
+        instance->stats.rxArrivalPending = true;
+    } else if ((instance->rxBufferHead + 1) % instance->rxBufferSize == instance->rxBufferTail) {
+        instance->stats.rxOverruns++;
+    }
+#else
+    (void)instance;
+#endif
+}
+
 // A shim that adapts the bufWriter API to the serialWriteBuf() API.
 void serialWriteBufShim(void *instance, const uint8_t *data, int count);
 void serialWriteBufBlockingShim(void *instance, const uint8_t *data, int count);
@@ -268,8 +268,10 @@ static void extractAndStoreRxByteBL(escSerial_t *escSerial)
     uint8_t rxByte = (escSerial->internalRxBuffer >> 1) & 0xFF;
 
     if (escSerial->port.rxCallback) {
+        serialStatsRxCallback(&escSerial->port);
         escSerial->port.rxCallback(rxByte, escSerial->port.rxCallbackData);
     } else {
+        serialStatsRxStore(&escSerial->port);
         escSerial->port.rxBuffer[escSerial->port.rxBufferHead] = rxByte;
         escSerial->port.rxBufferHead = (escSerial->port.rxBufferHead + 1) % escSerial->port.rxBufferSize;
     }
@@ -544,8 +546,10 @@ static void extractAndStoreRxByteEsc(escSerial_t *escSerial)
     uint8_t rxByte = (escSerial->internalRxBuffer) & 0xFF;
 
     if (escSerial->port.rxCallback) {
+        serialStatsRxCallback(&escSerial->port);
         escSerial->port.rxCallback(rxByte, escSerial->port.rxCallbackData);
     } else {
+        serialStatsRxStore(&escSerial->port);
         escSerial->port.rxBuffer[escSerial->port.rxBufferHead] = rxByte;
         escSerial->port.rxBufferHead = (escSerial->port.rxBufferHead + 1) % escSerial->port.rxBufferSize;
     }
@@ -851,6 +855,7 @@ const struct serialPortVTable escSerialVTable[] = {
         .setMode = escSerialSetMode,
         .setCtrlLineStateCb = NULL,
         .setBaudRateCb = NULL,
+        .setIdleCallback = NULL,
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL
@@ -428,8 +428,10 @@ static void extractAndStoreRxByte(softSerial_t *softSerial)
     uint8_t rxByte = (softSerial->internalRxBuffer >> 1) & 0xFF;
 
     if (softSerial->port.rxCallback) {
+        serialStatsRxCallback(&softSerial->port);
         softSerial->port.rxCallback(rxByte, softSerial->port.rxCallbackData);
     } else {
+        serialStatsRxStore(&softSerial->port);
         softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
         softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
     }
@@ -613,6 +615,7 @@ static const struct serialPortVTable softSerialVTable = {
     .setMode = softSerialSetMode,
     .setCtrlLineStateCb = NULL,
     .setBaudRateCb = NULL,
+    .setIdleCallback = NULL,
     .writeBuf = NULL,
     .beginWrite = NULL,
     .endWrite = NULL
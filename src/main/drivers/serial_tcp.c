@@ -259,6 +259,7 @@ void tcpDataIn(tcpPort_t *instance, uint8_t* ch, int size)
 
     while (size--) {
 //        printf("%c", *ch);
+        serialStatsRxStore(&s->port);
         s->port.rxBuffer[s->port.rxBufferHead] = *(ch++);
         if (s->port.rxBufferHead + 1 >= s->port.rxBufferSize) {
             s->port.rxBufferHead = 0;
@@ -280,6 +281,7 @@ static const struct serialPortVTable tcpVTable = {
         .setMode = NULL,
         .setCtrlLineStateCb = NULL,
         .setBaudRateCb = NULL,
+        .setIdleCallback = NULL,
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
@@ -109,6 +109,81 @@ UART_BUFFERS(Lp1);  // TODO - maybe some other naming scheme ?
 
 #undef UART_BUFFERS
 
+#if UART_TX_BUFFER_POOL_SIZE > 0
+UART_TX_BUFFER_ATTRIBUTE static volatile uint8_t uartTxBufferPool[UART_TX_BUFFER_POOL_SIZE] __attribute__((aligned(UART_BUFFER_ALIGN)));
+#define UART_TX_BUFFER_POOL uartTxBufferPool
+#else
+#define UART_TX_BUFFER_POOL NULL
+#endif
+#if UART_RX_BUFFER_POOL_SIZE > 0
+UART_RX_BUFFER_ATTRIBUTE static volatile uint8_t uartRxBufferPool[UART_RX_BUFFER_POOL_SIZE] __attribute__((aligned(UART_BUFFER_ALIGN)));
+#define UART_RX_BUFFER_POOL uartRxBufferPool
+#else
+#define UART_RX_BUFFER_POOL NULL
+#endif
+static uint16_t uartTxBufferPoolUsed;
+static uint16_t uartRxBufferPoolUsed;
+
+// Use the port's own static buffer when the requested size fits, otherwise carve it from the pool.
+// Falls back to the default buffer if the pool is exhausted, uartGetBufferSizes() reports what was given.
+static volatile uint8_t *uartAllocateBuffer(volatile uint8_t *defaultBuffer, uint16_t defaultSize, uint16_t requestedSize,
+                                            volatile uint8_t *pool, uint16_t poolSize, uint16_t *poolUsed, uint16_t *size)
+{
+    *size = defaultSize;
+    if (requestedSize == 0) {
+        return defaultBuffer;
+    }
+
+    const uint16_t bufferSize = constrain(requestedSize, UART_BUFFER_SIZE_MIN, UART_BUFFER_SIZE_MAX);
+    if (bufferSize <= defaultSize) {
+        *size = bufferSize;
+        return defaultBuffer;
+    }
+
+    const uint16_t allocSize = (bufferSize + UART_BUFFER_ALIGN - 1) & ~(UART_BUFFER_ALIGN - 1);
+    if (allocSize > poolSize - *poolUsed) {
+        return defaultBuffer;
+    }
+
+    volatile uint8_t *buffer = &pool[*poolUsed];
+    *poolUsed += allocSize;
+    *size = bufferSize;
+    return buffer;
+}
+
+// Called once at init, buffers are never returned to the pool
+void uartAllocateBuffers(uartDevice_t *uartdev, int resourceIndex)
+{
+    const uartHardware_t *hardware = uartdev->hardware;
+    const serialUartConfig_t *config = serialUartConfig(resourceIndex);
+
+    uartdev->txBuffer = uartAllocateBuffer(hardware->txBuffer, hardware->txBufferSize, config->txBufferSize,
+                                           UART_TX_BUFFER_POOL, UART_TX_BUFFER_POOL_SIZE, &uartTxBufferPoolUsed, &uartdev->txBufferSize);
+    uartdev->rxBuffer = uartAllocateBuffer(hardware->rxBuffer, hardware->rxBufferSize, config->rxBufferSize,
+                                           UART_RX_BUFFER_POOL, UART_RX_BUFFER_POOL_SIZE, &uartRxBufferPoolUsed, &uartdev->rxBufferSize);
+}
+
+uint16_t uartRxBufferSizeMax(void)
+{
+    return MIN(MAX(UART_RX_BUFFER_SIZE, UART_RX_BUFFER_POOL_SIZE), UART_BUFFER_SIZE_MAX);
+}
+
+uint16_t uartTxBufferSizeMax(void)
+{
+    return MIN(MAX(UART_TX_BUFFER_SIZE, UART_TX_BUFFER_POOL_SIZE), UART_BUFFER_SIZE_MAX);
+}
+
+bool uartGetBufferSizes(serialPortIdentifier_e identifier, uint16_t *rxBufferSize, uint16_t *txBufferSize)
+{
+    const uartDevice_t *uartdev = uartDeviceFromIdentifier(identifier);
+    if (!uartdev || !uartdev->rxBuffer) {
+        return false;
+    }
+    *rxBufferSize = uartdev->rxBufferSize;
+    *txBufferSize = uartdev->txBufferSize;
+    return true;
+}
+
 // store only devices configured for target (USE_UARTx)
 // some entries may be unused, for example because of pin configuration
 // uartDeviceIdx_e is direct index into this table
@@ -233,6 +308,14 @@ static void uartSetMode(serialPort_t *instance, portMode_e mode)
     uartReconfigure(uartPort);
 }
 
+static void uartSetIdleCallback(serialPort_t *instance, serialIdleCallbackPtr cb)
+{
+    uartPort_t *uartPort = (uartPort_t *)instance;
+    uartPort->port.idleCallback = cb;
+    // the idle line interrupt is only enabled for ports with a callback
+    uartReconfigure(uartPort);
+}
+
 static uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     const uartPort_t *uartPort = (const uartPort_t*)instance;
@@ -439,6 +522,7 @@ const struct serialPortVTable uartVTable[] = {
         .setMode = uartSetMode,
         .setCtrlLineStateCb = NULL,
         .setBaudRateCb = NULL,
+        .setIdleCallback = uartSetIdleCallback,
         .writeBuf = uartWriteBuf,
         .beginWrite = uartBeginWrite,
         .endWrite = uartEndWrite,
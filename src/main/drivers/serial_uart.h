@@ -62,3 +62,9 @@ typedef struct uartPort_s {
 
 void uartPinConfigure(const serialPinConfig_t *pSerialPinConfig);
 serialPort_t *uartOpen(serialPortIdentifier_e identifier, serialReceiveCallbackPtr rxCallback, void *rxCallbackData, uint32_t baudRate, portMode_e mode, portOptions_e options);
+
+// Largest buffer sizes a port can be configured with, its default or a buffer from the pool
+uint16_t uartRxBufferSizeMax(void);
+uint16_t uartTxBufferSizeMax(void);
+// Sizes of the buffers a port was given at init, false if the port is not in use
+bool uartGetBufferSizes(serialPortIdentifier_e identifier, uint16_t *rxBufferSize, uint16_t *txBufferSize);
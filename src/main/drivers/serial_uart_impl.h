@@ -44,6 +44,25 @@
 #endif
 #endif
 
+// Ports configured with a buffer larger than the default take it from these pools once at init.
+// Pool allocations are rounded up to a cache line so DMA buffers never share one.
+// Only the MCUs with RAM to spare have pools by default, a target may define its own sizes.
+#define UART_BUFFER_ALIGN       32
+#ifndef UART_RX_BUFFER_POOL_SIZE
+#if defined(STM32H7) || defined(AT32F435)
+#define UART_RX_BUFFER_POOL_SIZE    4096
+#else
+#define UART_RX_BUFFER_POOL_SIZE    0
+#endif
+#endif
+#ifndef UART_TX_BUFFER_POOL_SIZE
+#if defined(STM32H7) || defined(AT32F435)
+#define UART_TX_BUFFER_POOL_SIZE    8192
+#else
+#define UART_TX_BUFFER_POOL_SIZE    0
+#endif
+#endif
+
 #if !UART_TRAIT_AF_PIN && !UART_TRAIT_AF_PORT
 #error "Must specify either AF mode for MCU"
 #endif
@@ -156,8 +175,10 @@ typedef struct uartDevice_s {
     const uartHardware_t *hardware;
     uartPinDef_t rx;
     uartPinDef_t tx;
-    volatile uint8_t *rxBuffer;
+    volatile uint8_t *rxBuffer;         // set by uartAllocateBuffers()
     volatile uint8_t *txBuffer;
+    uint16_t rxBufferSize;
+    uint16_t txBufferSize;
 #if UART_TRAIT_PINSWAP
     bool pinSwap;
 #endif
@@ -168,6 +189,7 @@ extern uartDevice_t uartDevice[UARTDEV_COUNT];  // indexed by uartDeviceIdx_e;
 
 uartDeviceIdx_e uartDeviceIdxFromIdentifier(serialPortIdentifier_e identifier);
 uartDevice_t* uartDeviceFromIdentifier(serialPortIdentifier_e identifier);
+void uartAllocateBuffers(uartDevice_t *uartdev, int resourceIndex);
 
 extern const struct serialPortVTable uartVTable[];
 
@@ -82,6 +82,7 @@ void uartPinConfigure(const serialPinConfig_t *pSerialPinConfig)
 #if UART_TRAIT_PINSWAP
             uartdev->pinSwap = swap;
 #endif
+            uartAllocateBuffers(uartdev, resourceIndex);
         }
     }
 }
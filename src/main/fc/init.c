@@ -99,6 +99,7 @@
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/gps_rescue.h"
+#include "flight/nav_filter.h"
 #include "flight/pid.h"
 #include "flight/pid_init.h"
 #include "flight/position.h"
@@ -815,6 +816,9 @@ void init(void)
 
     positionInit();
     autopilotInit();
+#ifdef USE_NAV_FILTER
+    navFilterInit();
+#endif
 
 #if defined(USE_VTX_COMMON) || defined(USE_VTX_CONTROL)
     vtxTableInit();
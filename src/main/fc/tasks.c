@@ -57,6 +57,7 @@
 #include "flight/gps_rescue.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
+#include "flight/nav_filter.h"
 #include "flight/pid.h"
 #include "flight/position.h"
 #include "flight/pos_hold.h"
@@ -401,6 +402,10 @@ task_attribute_t task_attributes[TASK_COUNT] = {
     [TASK_POSHOLD] = DEFINE_TASK("POSHOLD", NULL, NULL, updatePosHold, TASK_PERIOD_HZ(POSHOLD_TASK_RATE_HZ), TASK_PRIORITY_LOW),
 #endif
 
+#ifdef USE_NAV_FILTER
+    [TASK_NAV_FILTER] = DEFINE_TASK("NAV_FILTER", NULL, NULL, updateNavFilter, TASK_PERIOD_HZ(NAV_FILTER_TASK_RATE_HZ), TASK_PRIORITY_LOW),
+#endif
+
 #ifdef USE_MAG
     [TASK_COMPASS] = DEFINE_TASK("COMPASS", NULL, NULL, taskUpdateMag, TASK_PERIOD_HZ(TASK_COMPASS_RATE_HZ), TASK_PRIORITY_LOW),
 #endif
@@ -575,6 +580,12 @@ void tasksInit(void)
     setTaskEnabled(TASK_POSHOLD, featureIsEnabled(FEATURE_GPS));
 #endif
 
+#ifdef USE_NAV_FILTER
+    // flown on with altitude_source NAV_FILTER, or run to log the estimate
+    setTaskEnabled(TASK_NAV_FILTER, (isAltitudeFromNavFilter() || debugMode == DEBUG_NAV_FILTER)
+        && sensors(SENSOR_ACC) && (sensors(SENSOR_BARO) || featureIsEnabled(FEATURE_GPS)));
+#endif
+
 #ifdef USE_MAG
     setTaskEnabled(TASK_COMPASS, sensors(SENSOR_MAG));
 #endif
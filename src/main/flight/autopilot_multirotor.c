@@ -34,6 +34,7 @@
 
 #include "flight/imu.h"
 #include "flight/position.h"
+#include "io/gps_fix.h"
 #include "rx/rx.h"
 #include "sensors/gyro.h"
 
@@ -78,7 +79,8 @@ typedef struct autopilotState_s {
     float vaLpfCutoff;                  // velocity + acceleration lowpass filter cutoff
     bool sticksActive;
     float maxAngle;
-    vector2_t pidSumBF;                 // pid output, updated on each GPS update, rotated to body frame
+    vector2_t pidSumIDA;                // I, D and A terms in earth frame, updated on each GPS update
+    vector2_t pidSumBF;                 // pid output, rotated to body frame
     pt3Filter_t upsampleLpfBF[RP_AXIS_COUNT];    // upsampling filter
     efPidAxis_t efAxis[EF_AXIS_COUNT];
 } autopilotState_t;
@@ -125,6 +127,7 @@ void resetPositionControl(const gpsLocation_t *initialTargetLocation, unsigned t
     // from pos_hold.c (or other client) when initiating position hold at target location
     ap.targetLocation = *initialTargetLocation;
     ap.sticksActive = false;
+    ap.pidSumIDA = (vector2_t){{0, 0}};
     // set sanity check distance according to groundspeed at start, minimum of 10m
     ap.sanityCheckDistance = sanityCheckDistance(gpsSol.groundSpeed);
     for (unsigned i = 0; i < ARRAYLEN(ap.efAxis); i++) {
@@ -232,17 +235,32 @@ static void setTargetLocationByAxis(const gpsLocation_t* newTargetLocation, axis
     }
 }
 
+// location of the craft now, extrapolated from the last GPS fix
+void getPredictedLocation(gpsLocation_t *location)
+{
+    if (!gpsFixPredict(location, micros())) {
+        *location = gpsSol.llh;
+    }
+}
+
 bool positionControl(void)
 {
     unsigned debugAxis = gyroConfig()->gyro_filter_debug_axis;
     static vector2_t debugGpsDistance = { 0 };     // keep last calculated distance for DEBUG
     static vector2_t debugPidSumEF = { 0 };        // and last pidsum in EF
     static uint16_t gpsStamp = 0;
+
+    gpsLocation_t currentLocation;
+    getPredictedLocation(&currentLocation);
+
     if (gpsHasNewData(&gpsStamp)) {
-        const float gpsDataInterval = getGpsDataIntervalSeconds(); // interval for current GPS data value 0.05 - 2.5s
+        gpsFixUsed(micros());
+        DEBUG_SET(DEBUG_GPS_TIMING, 1, gpsFixGetStats()->fixToUseUs);
+        const float gpsDataInterval = getGpsDataIntervalSeconds(); // interval for current GPS data value 0.04 - 2.5s
         const float gpsDataFreq = getGpsDataFrequencyHz();
 
-        // get lat and long distances from current location (gpsSol.llh) to target location
+        // get lat and long distances from the fix location (gpsSol.llh) to target location
+        // I, D and A run on the fixes, so that their velocity and acceleration are sampled at the GPS rate
         vector2_t gpsDistance;
         GPS_distance2d(&gpsSol.llh, &ap.targetLocation, &gpsDistance); // X is EW/lon, Y is NS/lat
         debugGpsDistance = gpsDistance;
@@ -258,7 +276,7 @@ bool positionControl(void)
         // update filters according to current GPS update rate
         const float vaGain = pt1FilterGain(ap.vaLpfCutoff, gpsDataInterval);
         const float iTermLeakGain = 1.0f - pt1FilterGainFromDelay(2.5f, gpsDataInterval);   // 2.5s time constant
-        vector2_t pidSum = { 0 };       // P+I in loop, D+A added after the axis loop (after limiting it)
+        vector2_t pidSum = { 0 };       // I in loop, D+A added after the axis loop (after limiting it), P is added on every call
         vector2_t pidDA;                // D+A
 
         for (axisEF_e efAxisIdx = LON; efAxisIdx <= LAT; efAxisIdx++) {
@@ -266,9 +284,8 @@ bool positionControl(void)
             // separate PID controllers for longitude (EastWest or EW, X) and latitude (NorthSouth or NS, Y)
             const float axisDistance = gpsDistance.v[efAxisIdx];
 
-            // ** P **
+            // ** P ** for debug only, the output uses the predicted location
             const float pidP = axisDistance * positionPidCoeffs.Kp;
-            pidSum.v[efAxisIdx] += pidP;
 
             // ** I **
             // only add to iTerm while in hold phase
@@ -305,7 +322,7 @@ bool positionControl(void)
                 pidD *= 1.6f; // aribitrary D boost to stop more quickly than usual
                 // detect when axis has nearly stopped by sign reversal of velocity (comparing sign of velocityFiltered, which is delayed, to velocity)
                 if (velocity * velocityFiltered < 0.0f) {
-                    setTargetLocationByAxis(&gpsSol.llh, efAxisIdx);  // reset target location for this axis, forcing P to zero
+                    setTargetLocationByAxis(&currentLocation, efAxisIdx);  // reset target location for this axis, forcing P to zero
                     efAxis->previousDistance = 0.0f;                  // ensure minimal D jump from the updated location
                     efAxis->isStopping = false;                       // end the 'stopping' phase
                     if (ap.efAxis[LAT].isStopping == ap.efAxis[LON].isStopping) {
@@ -337,35 +354,46 @@ bool positionControl(void)
 
         // add constrained DA to sum
         vector2Add(&pidSum, &pidSum, &pidDA);
-        debugPidSumEF = pidSum;
-        vector2_t anglesBF;
+        ap.pidSumIDA = pidSum;
 
         if (ap.sticksActive) {
-            // if a Position Hold deadband is set, and sticks are outside deadband, allow pilot control in angle mode
-            anglesBF = (vector2_t){{0, 0}};             // set output PIDS to 0; upsampling filter will smooth this
-            // reset target location each cycle (and set previousDistance to zero in for loop), to keep D current, and avoid a spike when stopping
-            ap.targetLocation = gpsSol.llh;
             // keep updating sanity check distance while sticks are out because speed may get high
             ap.sanityCheckDistance = sanityCheckDistance(gpsSol.groundSpeed);
-        } else {
-            // ** Rotate pid Sum to body frame, and convert it into pitch and roll **
-            // attitude.values.yaw increases clockwise from north
-            // PID is running in ENU, adapt angle (to 0deg = EAST);
-            //  rotation is from EarthFrame to BodyFrame, no change of sign from heading
-            const float angle = DECIDEGREES_TO_RADIANS(attitude.values.yaw - 900);
-            vector2_t pidBodyFrame;   // pid output in body frame; X is forward, Y is left
-            vector2Rotate(&pidBodyFrame, &pidSum, angle);         // rotate by angle counterclockwise
-            anglesBF.v[AI_ROLL] = -pidBodyFrame.y;         // negative roll to fly left
-            anglesBF.v[AI_PITCH] = pidBodyFrame.x;         // positive pitch for forward
-             // limit angle vector to maxAngle
-            const float mag = vector2Norm(&anglesBF);
-            if (mag > ap.maxAngle && mag > 0.0f) {
-                vector2Scale(&anglesBF, &anglesBF, ap.maxAngle / mag);
-            }
         }
-        ap.pidSumBF = anglesBF;    // this value will be upsampled
     }
 
+    vector2_t anglesBF;
+    if (ap.sticksActive) {
+        // if a Position Hold deadband is set, and sticks are outside deadband, allow pilot control in angle mode
+        anglesBF = (vector2_t){{0, 0}};             // set output PIDS to 0; upsampling filter will smooth this
+        // reset target location each cycle (and set previousDistance to zero in for loop), to keep D current, and avoid a spike when stopping
+        ap.targetLocation = currentLocation;
+    } else {
+        // ** P ** from the predicted location, so that it follows the craft between GPS fixes
+        vector2_t distance;
+        GPS_distance2d(&currentLocation, &ap.targetLocation, &distance);
+        vector2_t pidSum;
+        vector2Scale(&pidSum, &distance, positionPidCoeffs.Kp);
+        vector2Add(&pidSum, &pidSum, &ap.pidSumIDA);
+        debugPidSumEF = pidSum;
+
+        // ** Rotate pid Sum to body frame, and convert it into pitch and roll **
+        // attitude.values.yaw increases clockwise from north
+        // PID is running in ENU, adapt angle (to 0deg = EAST);
+        //  rotation is from EarthFrame to BodyFrame, no change of sign from heading
+        const float angle = DECIDEGREES_TO_RADIANS(attitude.values.yaw - 900);
+        vector2_t pidBodyFrame;   // pid output in body frame; X is forward, Y is left
+        vector2Rotate(&pidBodyFrame, &pidSum, angle);         // rotate by angle counterclockwise
+        anglesBF.v[AI_ROLL] = -pidBodyFrame.y;         // negative roll to fly left
+        anglesBF.v[AI_PITCH] = pidBodyFrame.x;         // positive pitch for forward
+         // limit angle vector to maxAngle
+        const float mag = vector2Norm(&anglesBF);
+        if (mag > ap.maxAngle && mag > 0.0f) {
+            vector2Scale(&anglesBF, &anglesBF, ap.maxAngle / mag);
+        }
+    }
+    ap.pidSumBF = anglesBF;    // this value will be upsampled
+
     // Final output to pid.c Angle Mode at 100Hz with PT3 upsampling
     for (unsigned i = 0; i < RP_AXIS_COUNT; i++) {
         // note: upsampling should really be done in earth frame, to avoid 10Hz wobbles if pilot yaws and the controller is applying significant pitch or roll
@@ -27,6 +27,7 @@ void autopilotInit(void);
 void resetAltitudeControl(void);
 void setSticksActiveStatus(bool areSticksActive);
 void resetPositionControl(const gpsLocation_t *initialTargetLocation, unsigned taskRateHz);
+void getPredictedLocation(gpsLocation_t *location);
 void posControlOutput(void);
 bool positionControl(void);
 void altitudeControl(float targetAltitudeCm, float taskIntervalS, float targetAltitudeStep);
@@ -0,0 +1,398 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Loosely coupled GPS / baro / accelerometer navigation filter.
+ *
+ * The attitude comes from imu.c, so the accelerometer can be rotated to the earth frame before it is
+ * used and the filter is linear. Each earth axis is then an independent Kalman filter with position,
+ * velocity and accelerometer bias as its states: the accelerometer drives the prediction at the task
+ * rate, GPS position and velocity and baro altitude correct it when they arrive. With independent
+ * axes this is the same as the full 9 state filter, at a fraction of the cost, and it needs no
+ * allocation or matrix library.
+ *
+ * Horizontal positions are relative to the first GPS fix. The vertical position is relative to the
+ * altitude at the first altitude measurement; GPS and baro each take their offset to it then, and the
+ * baro offset then slowly follows GPS so that baro drift doesn't pull the estimate away.
+ *
+ * GPS fixes arrive late; they are moved on to the task time with the estimated velocity, over the age
+ * of the fix from its time stamp (see gps_fix.c), before they are compared with the estimate.
+ *
+ * The vertical estimate is the altitude with altitude_source NAV_FILTER, see position.c. The task also
+ * runs with debug_mode NAV_FILTER, to log the estimate against the altitude and position hold ones.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_NAV_FILTER
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+
+#include "fc/runtime_config.h"
+
+#include "flight/imu.h"
+#include "flight/nav_filter.h"
+
+#include "io/gps.h"
+#include "io/gps_fix.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "sensors/sensors.h"
+
+#define NAV_GRAVITY_CMSS            980.665f
+
+#define NAV_ACC_NOISE_CMSS          50.0f   // accelerometer noise and vibration
+#define NAV_ACC_BIAS_DRIFT_CMSS     2.0f    // random walk of the accelerometer bias, per sqrt(s)
+#define NAV_INIT_VEL_CMS            500.0f  // velocity uncertainty before it was measured
+#define NAV_INIT_ACC_BIAS_CMSS      50.0f
+
+#define NAV_GPS_POS_CM              250.0f  // GPS position error when the module doesn't report its accuracy
+#define NAV_GPS_POS_MIN_CM          50.0f
+#define NAV_GPS_ALT_FACTOR          2.0f    // vertical GPS error is larger than horizontal
+#define NAV_GPS_VEL_CMS             50.0f
+#define NAV_GPS_VEL_MIN_CMS         10.0f
+#define NAV_BARO_ALT_CM             100.0f
+#define NAV_BARO_OFFSET_GAIN        0.01f   // baro follows the GPS altitude with a time constant of 100 GPS fixes
+#define NAV_GPS_MAX_AGE_US          GPS_FIX_PREDICT_MAX_US  // older fixes are not moved further than this
+
+#define NAV_GATE_SIGMA              5.0f    // measurements further away than this many sigma are rejected
+#define NAV_REJECT_RESET_COUNT      10      // after that many rejections in a row the state is reset to the measurement
+
+static navFilterAxis_t navAxis[NAV_AXIS_COUNT];
+
+static struct {
+    bool originValid;
+    gpsLocation_t origin;
+    float originCosLat;
+    bool gpsAltOffsetValid;
+    float gpsAltOffsetCm;
+    bool baroOffsetValid;
+    float baroOffsetCm;
+    float lastBaroAltCm;
+    timeUs_t lastUpdateUs;
+} nav;
+
+static void navFilterResetAxis(navFilterAxis_t *axis, float positionCm, float variance)
+{
+    memset(axis, 0, sizeof(*axis));
+    axis->x[NAV_STATE_POS] = positionCm;
+    axis->P[NAV_STATE_POS][NAV_STATE_POS] = variance;
+    axis->P[NAV_STATE_VEL][NAV_STATE_VEL] = sq(NAV_INIT_VEL_CMS);
+    axis->P[NAV_STATE_ACC_BIAS][NAV_STATE_ACC_BIAS] = sq(NAV_INIT_ACC_BIAS_CMSS);
+    axis->valid = true;
+}
+
+void navFilterReset(void)
+{
+    memset(navAxis, 0, sizeof(navAxis));
+    memset(&nav, 0, sizeof(nav));
+}
+
+void navFilterInit(void)
+{
+    navFilterReset();
+}
+
+static void navFilterPredictAxis(navFilterAxis_t *axis, float acc, float dt)
+{
+    const float h = 0.5f * dt * dt;
+    float *x = axis->x;
+    float (*P)[NAV_STATE_COUNT] = axis->P;
+
+    // x = F x, with the bias taken off the measured acceleration
+    const float a = acc - x[NAV_STATE_ACC_BIAS];
+    x[NAV_STATE_POS] += x[NAV_STATE_VEL] * dt + a * h;
+    x[NAV_STATE_VEL] += a * dt;
+
+    // P = F P F' + Q, F = [1 dt -h; 0 1 -dt; 0 0 1]
+    float A[NAV_STATE_COUNT][NAV_STATE_COUNT];
+    for (int j = 0; j < NAV_STATE_COUNT; j++) {
+        A[0][j] = P[0][j] + dt * P[1][j] - h * P[2][j];
+        A[1][j] = P[1][j] - dt * P[2][j];
+        A[2][j] = P[2][j];
+    }
+    for (int i = 0; i < NAV_STATE_COUNT; i++) {
+        P[i][0] = A[i][0] + dt * A[i][1] - h * A[i][2];
+        P[i][1] = A[i][1] - dt * A[i][2];
+        P[i][2] = A[i][2];
+    }
+
+    // acceleration noise enters through [h dt 0], bias drift is a random walk
+    const float qAcc = sq(NAV_ACC_NOISE_CMSS);
+    P[0][0] += qAcc * h * h;
+    P[0][1] += qAcc * h * dt;
+    P[1][0] += qAcc * h * dt;
+    P[1][1] += qAcc * dt * dt;
+    P[2][2] += sq(NAV_ACC_BIAS_DRIFT_CMSS) * dt;
+}
+
+void navFilterPredict(const vector3_t *accEF, float dt)
+{
+    for (int i = 0; i < NAV_AXIS_COUNT; i++) {
+        if (navAxis[i].valid) {
+            navFilterPredictAxis(&navAxis[i], accEF->v[i], dt);
+        }
+    }
+}
+
+// Measurement of a single state, H = [0 .. 1 .. 0]
+static bool navFilterUpdateState(navFilterAxis_t *axis, navState_e state, float z, float variance)
+{
+    float *x = axis->x;
+    float (*P)[NAV_STATE_COUNT] = axis->P;
+
+    const float innovation = z - x[state];
+    const float S = P[state][state] + variance;
+
+    if (sq(innovation) > sq(NAV_GATE_SIGMA) * S) {
+        if (++axis->rejectCount < NAV_REJECT_RESET_COUNT) {
+            return false;
+        }
+        // the estimate has lost the measurement, start over from it
+        if (state == NAV_STATE_POS) {
+            navFilterResetAxis(axis, z, variance);
+        } else {
+            for (int i = 0; i < NAV_STATE_COUNT; i++) {
+                P[i][state] = P[state][i] = 0.0f;
+            }
+            x[state] = z;
+            P[state][state] = variance;
+            axis->rejectCount = 0;
+        }
+        return false;
+    }
+    axis->rejectCount = 0;
+
+    float K[NAV_STATE_COUNT];
+    float Prow[NAV_STATE_COUNT];
+    for (int i = 0; i < NAV_STATE_COUNT; i++) {
+        K[i] = P[i][state] / S;
+        Prow[i] = P[state][i];
+    }
+    for (int i = 0; i < NAV_STATE_COUNT; i++) {
+        x[i] += K[i] * innovation;
+        for (int j = 0; j < NAV_STATE_COUNT; j++) {
+            P[i][j] -= K[i] * Prow[j];
+        }
+    }
+    return true;
+}
+
+bool navFilterUpdatePosition(navAxis_e axis, float positionCm, float variance)
+{
+    if (!navAxis[axis].valid) {
+        navFilterResetAxis(&navAxis[axis], positionCm, variance);
+        return true;
+    }
+    return navFilterUpdateState(&navAxis[axis], NAV_STATE_POS, positionCm, variance);
+}
+
+bool navFilterUpdateVelocity(navAxis_e axis, float velocityCmS, float variance)
+{
+    if (!navAxis[axis].valid) {
+        return false;
+    }
+    return navFilterUpdateState(&navAxis[axis], NAV_STATE_VEL, velocityCmS, variance);
+}
+
+#ifdef USE_GPS
+// A position measured ageS ago, moved on to now with the estimated velocity, whose uncertainty adds to the variance
+static bool navFilterUpdateDelayedPosition(navAxis_e axis, float positionCm, float variance, float ageS)
+{
+    const navFilterAxis_t *state = &navAxis[axis];
+    if (state->valid) {
+        positionCm += state->x[NAV_STATE_VEL] * ageS;
+        variance += state->P[NAV_STATE_VEL][NAV_STATE_VEL] * sq(ageS);
+    }
+    return navFilterUpdatePosition(axis, positionCm, variance);
+}
+
+static void navFilterFuseGps(timeUs_t currentTimeUs)
+{
+    if (!nav.originValid) {
+        nav.origin = gpsSol.llh;
+        nav.originCosLat = MAX(cos_approx(DEGREES_TO_RADIANS((float)gpsSol.llh.lat / GPS_DEGREES_DIVIDER)), 0.01f);
+        nav.originValid = true;
+    }
+
+    // the module reports its accuracy with UBX, otherwise go by the dilution of precision
+    float posSigmaCm = NAV_GPS_POS_CM;
+    if (gpsSol.acc.hAcc) {
+        posSigmaCm = MAX(gpsSol.acc.hAcc * 0.1f, NAV_GPS_POS_MIN_CM);
+    } else if (gpsSol.dop.hdop) {
+        posSigmaCm = MAX(NAV_GPS_POS_CM * gpsSol.dop.hdop * 0.01f, NAV_GPS_POS_MIN_CM);
+    }
+    const float altSigmaCm = gpsSol.acc.vAcc ? MAX(gpsSol.acc.vAcc * 0.1f, NAV_GPS_POS_MIN_CM) : posSigmaCm * NAV_GPS_ALT_FACTOR;
+    const float velSigmaCmS = gpsSol.acc.sAcc ? MAX(gpsSol.acc.sAcc * 0.1f, NAV_GPS_VEL_MIN_CMS) : NAV_GPS_VEL_CMS;
+
+    const float ageS = constrain(cmpTimeUs(currentTimeUs, gpsFixTimeUs()), 0, NAV_GPS_MAX_AGE_US) * 1e-6f;
+
+    const float eastCm = (gpsSol.llh.lon - nav.origin.lon) * EARTH_ANGLE_TO_CM * nav.originCosLat;
+    const float northCm = (gpsSol.llh.lat - nav.origin.lat) * EARTH_ANGLE_TO_CM;
+    navFilterUpdateDelayedPosition(NAV_EAST, eastCm, sq(posSigmaCm), ageS);
+    navFilterUpdateDelayedPosition(NAV_NORTH, northCm, sq(posSigmaCm), ageS);
+
+    float velNorthCmS, velEastCmS;
+    if (gpsFixVelocity(&velNorthCmS, &velEastCmS)) {
+        navFilterUpdateVelocity(NAV_EAST, velEastCmS, sq(velSigmaCmS));
+        navFilterUpdateVelocity(NAV_NORTH, velNorthCmS, sq(velSigmaCmS));
+    }
+
+    if (!nav.gpsAltOffsetValid) {
+        nav.gpsAltOffsetCm = gpsSol.llh.altCm - (navAxis[NAV_UP].valid ? navAxis[NAV_UP].x[NAV_STATE_POS] : 0.0f);
+        nav.gpsAltOffsetValid = true;
+    }
+    const float gpsAltCm = gpsSol.llh.altCm - nav.gpsAltOffsetCm;
+    navFilterUpdateDelayedPosition(NAV_UP, gpsAltCm, sq(altSigmaCm), ageS);
+
+    // the offset the baro took from a single sample, and its drift, are slowly taken out against GPS
+    if (nav.baroOffsetValid) {
+        nav.baroOffsetCm += NAV_BARO_OFFSET_GAIN * (nav.lastBaroAltCm - nav.baroOffsetCm - gpsAltCm);
+    }
+}
+#endif
+
+#ifdef USE_BARO
+static void navFilterFuseBaro(void)
+{
+    // the baro task runs slower than the filter, only fuse new samples
+    static uint16_t baroStamp = 0;
+    if (!baroHasNewData(&baroStamp)) {
+        return;
+    }
+    const float baroAltCm = getBaroAltitude();
+    nav.lastBaroAltCm = baroAltCm;
+
+    if (!nav.baroOffsetValid) {
+        nav.baroOffsetCm = baroAltCm - (navAxis[NAV_UP].valid ? navAxis[NAV_UP].x[NAV_STATE_POS] : 0.0f);
+        nav.baroOffsetValid = true;
+    }
+    navFilterUpdatePosition(NAV_UP, baroAltCm - nav.baroOffsetCm, sq(NAV_BARO_ALT_CM));
+}
+#endif
+
+void updateNavFilter(timeUs_t currentTimeUs)
+{
+    float dt = HZ_TO_INTERVAL(NAV_FILTER_TASK_RATE_HZ);
+    if (nav.lastUpdateUs) {
+        dt = constrainf(cmpTimeUs(currentTimeUs, nav.lastUpdateUs) * 1e-6f, 0.0f, 0.1f);
+    }
+    nav.lastUpdateUs = currentTimeUs;
+
+    // accelerometer in the earth frame; rMat is North West Up, the filter is East North Up
+    const float accScale = acc.dev.acc_1G_rec * NAV_GRAVITY_CMSS;
+    vector3_t accBF;
+    vector3Scale(&accBF, &acc.accADC, accScale);
+    vector3_t accNWU;
+    matrixVectorMul(&accNWU, &rMat, &accBF);
+    const vector3_t accEF = {{ -accNWU.y, accNWU.x, accNWU.z - NAV_GRAVITY_CMSS }};
+
+    navFilterPredict(&accEF, dt);
+
+#ifdef USE_GPS
+    static uint16_t gpsStamp = 0;
+    if (sensors(SENSOR_GPS) && gpsHasNewData(&gpsStamp)) {
+        navFilterFuseGps(currentTimeUs);
+    }
+#endif
+#ifdef USE_BARO
+    if (sensors(SENSOR_BARO) && baroIsCalibrated()) {
+        navFilterFuseBaro();
+    }
+#endif
+
+    DEBUG_SET(DEBUG_NAV_FILTER, 0, lrintf(navAxis[NAV_EAST].x[NAV_STATE_POS]));     // cm
+    DEBUG_SET(DEBUG_NAV_FILTER, 1, lrintf(navAxis[NAV_NORTH].x[NAV_STATE_POS]));
+    DEBUG_SET(DEBUG_NAV_FILTER, 2, lrintf(navAxis[NAV_UP].x[NAV_STATE_POS]));
+    DEBUG_SET(DEBUG_NAV_FILTER, 3, lrintf(navAxis[NAV_EAST].x[NAV_STATE_VEL]));     // cm/s
+    DEBUG_SET(DEBUG_NAV_FILTER, 4, lrintf(navAxis[NAV_NORTH].x[NAV_STATE_VEL]));
+    DEBUG_SET(DEBUG_NAV_FILTER, 5, lrintf(navAxis[NAV_UP].x[NAV_STATE_VEL]));
+    DEBUG_SET(DEBUG_NAV_FILTER, 6, lrintf(sqrtf(navAxis[NAV_NORTH].P[NAV_STATE_POS][NAV_STATE_POS])));  // 1 sigma, cm
+    DEBUG_SET(DEBUG_NAV_FILTER, 7, lrintf(navAxis[NAV_UP].x[NAV_STATE_ACC_BIAS] * 10));               // cm/s/s * 10
+}
+
+bool navFilterIsValid(navAxis_e axis)
+{
+    return navAxis[axis].valid;
+}
+
+static void navFilterGetState(vector3_t *result, navState_e state)
+{
+    for (int i = 0; i < NAV_AXIS_COUNT; i++) {
+        result->v[i] = navAxis[i].x[state];
+    }
+}
+
+static void navFilterGetVariance(vector3_t *result, navState_e state)
+{
+    for (int i = 0; i < NAV_AXIS_COUNT; i++) {
+        result->v[i] = navAxis[i].P[state][state];
+    }
+}
+
+void navFilterGetPosition(vector3_t *positionCm)
+{
+    navFilterGetState(positionCm, NAV_STATE_POS);
+}
+
+void navFilterGetVelocity(vector3_t *velocityCmS)
+{
+    navFilterGetState(velocityCmS, NAV_STATE_VEL);
+}
+
+void navFilterGetPositionVariance(vector3_t *variance)
+{
+    navFilterGetVariance(variance, NAV_STATE_POS);
+}
+
+void navFilterGetVelocityVariance(vector3_t *variance)
+{
+    navFilterGetVariance(variance, NAV_STATE_VEL);
+}
+
+const navFilterAxis_t *navFilterGetAxis(navAxis_e axis)
+{
+    return &navAxis[axis];
+}
+
+bool navFilterGetLocation(gpsLocation_t *location)
+{
+    if (!nav.originValid || !navAxis[NAV_EAST].valid || !navAxis[NAV_NORTH].valid) {
+        return false;
+    }
+
+    *location = nav.origin;
+    location->lat += lrintf(navAxis[NAV_NORTH].x[NAV_STATE_POS] / EARTH_ANGLE_TO_CM);
+    location->lon += lrintf(navAxis[NAV_EAST].x[NAV_STATE_POS] / (EARTH_ANGLE_TO_CM * nav.originCosLat));
+    if (nav.gpsAltOffsetValid) {
+        location->altCm = lrintf(navAxis[NAV_UP].x[NAV_STATE_POS] + nav.gpsAltOffsetCm);
+    }
+    return true;
+}
+
+#endif // USE_NAV_FILTER
@@ -0,0 +1,75 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/time.h"
+#include "common/vector.h"
+
+#include "io/gps.h"
+
+#define NAV_FILTER_TASK_RATE_HZ 100
+
+// Earth frame axes of the estimate; same as the autopilot, X is east, Y is north, Z is up
+typedef enum {
+    NAV_EAST = 0,
+    NAV_NORTH,
+    NAV_UP,
+    NAV_AXIS_COUNT
+} navAxis_e;
+
+// One axis of the filter: position, velocity and accelerometer bias, with their covariance
+typedef enum {
+    NAV_STATE_POS = 0,
+    NAV_STATE_VEL,
+    NAV_STATE_ACC_BIAS,
+    NAV_STATE_COUNT
+} navState_e;
+
+typedef struct navFilterAxis_s {
+    bool valid;                                     // set by the first measurement of the position
+    float x[NAV_STATE_COUNT];                       // cm, cm/s, cm/s/s
+    float P[NAV_STATE_COUNT][NAV_STATE_COUNT];
+    uint8_t rejectCount;                            // consecutive measurements rejected by the innovation gate
+} navFilterAxis_t;
+
+void navFilterInit(void);
+void navFilterReset(void);
+
+// Propagates all axes by dt with the earth frame acceleration, gravity removed, in cm/s/s
+void navFilterPredict(const vector3_t *accEF, float dt);
+
+// Measurements of one axis, variance in cm^2 and (cm/s)^2. Returns false if the measurement was rejected.
+bool navFilterUpdatePosition(navAxis_e axis, float positionCm, float variance);
+bool navFilterUpdateVelocity(navAxis_e axis, float velocityCmS, float variance);
+
+void updateNavFilter(timeUs_t currentTimeUs);
+
+bool navFilterIsValid(navAxis_e axis);
+void navFilterGetPosition(vector3_t *positionCm);
+void navFilterGetVelocity(vector3_t *velocityCmS);
+void navFilterGetPositionVariance(vector3_t *variance);
+void navFilterGetVelocityVariance(vector3_t *variance);
+const navFilterAxis_t *navFilterGetAxis(navAxis_e axis);
+
+// Estimated location, from the horizontal position relative to the origin of the filter. Returns false until GPS was fused.
+bool navFilterGetLocation(gpsLocation_t *location);
@@ -83,7 +83,9 @@ void updatePosHold(timeUs_t currentTimeUs) {
     UNUSED(currentTimeUs);
     if (FLIGHT_MODE(POS_HOLD_MODE)) {
         if (!posHold.isEnabled) {
-            resetPositionControl(&gpsSol.llh, POSHOLD_TASK_RATE_HZ); // sets target location to current location
+            gpsLocation_t currentLocation;
+            getPredictedLocation(&currentLocation);
+            resetPositionControl(&currentLocation, POSHOLD_TASK_RATE_HZ); // sets target location to current location
             posHold.isControlOk = true;
             posHold.isEnabled = true;
         }
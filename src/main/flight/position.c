@@ -35,6 +35,7 @@
 
 #include "flight/position.h"
 #include "flight/imu.h"
+#include "flight/nav_filter.h"
 #include "flight/pid.h"
 
 #include "io/gps.h"
@@ -76,7 +77,8 @@ void positionInit(void)
 typedef enum {
     DEFAULT = 0,
     BARO_ONLY,
-    GPS_ONLY
+    GPS_ONLY,
+    NAV_FILTER
 } altitudeSource_e;
 
 PG_REGISTER_WITH_RESET_TEMPLATE(positionConfig_t, positionConfig, PG_POSITION, 6);
@@ -97,11 +99,23 @@ void calculateEstimatedAltitude(void)
     static float gpsAltOffsetCm = 0.0f;
     static float baroAltOffsetCm = 0.0f;
     static float newBaroAltOffsetCm = 0.0f;
+#ifdef USE_NAV_FILTER
+    static bool useZeroedNavAltitude = false;
+    static float navAltOffsetCm = 0.0f;
+#endif
 
     float baroAltCm = 0.0f;
     float gpsTrust = 0.3f; // if no pDOP value, use 0.3, intended range 0-1;
     bool haveBaroAlt = false; // true if baro exists and has been calibrated on power up
     bool haveGpsAlt = false; // true if GPS is connected and while it has a 3D fix, set each run to false
+#ifdef USE_NAV_FILTER
+    // the filter has fused baro, GPS and accelerometer already, it replaces the mixing below once it has an altitude
+    const bool haveNavAlt = isAltitudeFromNavFilter() && navFilterIsValid(NAV_UP);
+    vector3_t navPositionCm;
+    navFilterGetPosition(&navPositionCm);
+#endif
+    // NAV_FILTER mixes baro and GPS as DEFAULT does until the filter has an altitude
+    const altitudeSource_e altitudeSource = positionConfig()->altitude_source == NAV_FILTER ? DEFAULT : positionConfig()->altitude_source;
 
     // *** Get sensor data
 #ifdef USE_BARO
@@ -140,10 +154,16 @@ void calculateEstimatedAltitude(void)
         if (haveGpsAlt) { // watch for valid GPS altitude data to get a zero value from
             gpsAltOffsetCm = gpsAltCm; // update the zero offset value with the most recent valid gps altitude reading
             useZeroedGpsAltitude = true; // we can use this offset to zero the GPS altitude on arming
-            if (!(positionConfig()->altitude_source == BARO_ONLY)) {
+            if (!(altitudeSource == BARO_ONLY)) {
                 displayAltitudeCm = gpsAltCm; // estimatedAltitude shows most recent ASL GPS altitude in OSD and sensors, while disarmed
             }
         }
+#ifdef USE_NAV_FILTER
+        if (haveNavAlt) {
+            navAltOffsetCm = navPositionCm.z; // zero of the estimate at arming
+            useZeroedNavAltitude = true;
+        }
+#endif
         zeroedAltitudeCm = 0.0f; // always hold relativeAltitude at zero while disarmed
         DEBUG_SET(DEBUG_ALTITUDE, 2, gpsAltCm / 100.0f); // Absolute altitude ASL in metres, max 32,767m
     //  ***  ARMED  ***
@@ -170,8 +190,8 @@ void calculateEstimatedAltitude(void)
         DEBUG_SET(DEBUG_ALTITUDE, 2, lrintf(zeroedAltitudeCm / 10.0f)); // Relative altitude above takeoff, to 0.1m, rolls over at 3,276.7m
 
         // Empirical mixing of GPS and Baro altitudes
-        if (useZeroedGpsAltitude && (positionConfig()->altitude_source == DEFAULT || positionConfig()->altitude_source == GPS_ONLY)) {
-            if (haveBaroAlt && positionConfig()->altitude_source == DEFAULT) {
+        if (useZeroedGpsAltitude && (altitudeSource == DEFAULT || altitudeSource == GPS_ONLY)) {
+            if (haveBaroAlt && altitudeSource == DEFAULT) {
                 // mix zeroed GPS with Baro altitude data, if Baro data exists if are in default altitude control mode
                 const float absDifferenceM = fabsf(zeroedAltitudeCm - baroAltCm) / 100.0f * positionConfig()->altitude_prefer_baro / 100.0f;
                 if (absDifferenceM > 1.0f) { // when there is a large difference, favour Baro
@@ -179,9 +199,14 @@ void calculateEstimatedAltitude(void)
                 }
                 zeroedAltitudeCm = zeroedAltitudeCm * gpsTrust + baroAltCm * (1.0f - gpsTrust);
             }
-        } else if (haveBaroAlt && (positionConfig()->altitude_source == DEFAULT || positionConfig()->altitude_source == BARO_ONLY)) {
+        } else if (haveBaroAlt && (altitudeSource == DEFAULT || altitudeSource == BARO_ONLY)) {
             zeroedAltitudeCm = baroAltCm; // use Baro if no GPS data, or we want Baro only
         }
+#ifdef USE_NAV_FILTER
+        if (haveNavAlt && useZeroedNavAltitude) {
+            zeroedAltitudeCm = navPositionCm.z - navAltOffsetCm;
+        }
+#endif
     }
 
     zeroedAltitudeCm = pt2FilterApply(&altitudeLpf, zeroedAltitudeCm);
@@ -217,6 +242,15 @@ void calculateEstimatedAltitude(void)
 
 #endif //defined(USE_BARO) || defined(USE_GPS)
 
+bool isAltitudeFromNavFilter(void)
+{
+#ifdef USE_NAV_FILTER
+    return positionConfig()->altitude_source == NAV_FILTER;
+#else
+    return false;
+#endif
+}
+
 float getAltitudeCm(void)
 {
     return zeroedAltitudeCm;
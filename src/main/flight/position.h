@@ -41,4 +41,5 @@ int32_t getEstimatedAltitudeCm(void);
 float getAltitudeAsl(void);
 int16_t getEstimatedVario(void);
 bool isAltitudeAvailable(void);
+bool isAltitudeFromNavFilter(void);
 
@@ -39,6 +39,8 @@
 #define CRSF_DISPLAY_PORT_OPEN_DELAY_MS     400
 #define CRSF_DISPLAY_PORT_CLEAR_DELAY_MS    45
 
+STATIC_ASSERT(CRSF_DISPLAY_PORT_ROWS_MAX <= sizeof(((crsfDisplayPortScreen_t *)0)->dirtyRows) * 8, crsfDisplayPortDirtyRowsTooSmall);
+
 static crsfDisplayPortScreen_t crsfScreen;
 static timeMs_t delayTransportUntilMs = 0;
 
@@ -56,6 +58,7 @@ static int crsfClearScreen(displayPort_t *displayPort, displayClearOption_e opti
     memset(crsfScreen.buffer, ' ', sizeof(crsfScreen.buffer));
     crsfScreen.updated = false;
     crsfScreen.reset = true;
+    crsfScreen.dirtyRows = 0;
     delayTransportUntilMs = millis() + CRSF_DISPLAY_PORT_CLEAR_DELAY_MS;
     return 0;
 }
@@ -86,9 +89,10 @@ static int crsfWriteString(displayPort_t *displayPort, uint8_t col, uint8_t row,
     }
     const size_t truncLen = MIN(strlen(s), (size_t)(crsfScreen.cols - col));  // truncate at colCount
     char *rowStart = &crsfScreen.buffer[row * crsfScreen.cols + col];
-    crsfScreen.updated |= memcmp(rowStart, s, truncLen);
-    if (crsfScreen.updated) {
+    if (memcmp(rowStart, s, truncLen)) {
         memcpy(rowStart, s, truncLen);
+        crsfScreen.updated = true;
+        crsfScreen.dirtyRows |= 1 << row;
     }
     return 0;
 }
@@ -180,6 +184,11 @@ void crsfDisplayPortSetDimensions(uint8_t rows, uint8_t cols)
     crsfRedraw(&crsfDisplayPort);
 }
 
+void crsfDisplayPortSetRowUpdates(bool rowUpdates)
+{
+    crsfScreen.rowUpdates = rowUpdates;
+}
+
 void crsfDisplayPortRefresh(void)
 {
     if (!cmsInMenu) {
@@ -188,6 +197,7 @@ void crsfDisplayPortRefresh(void)
     }
     crsfScreen.updated = true;
     crsfScreen.reset = true;
+    crsfScreen.dirtyRows = (1 << crsfScreen.rows) - 1;
     delayTransportUntilMs = millis() + CRSF_DISPLAY_PORT_CLEAR_DELAY_MS;
 }
 
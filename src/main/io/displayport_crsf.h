@@ -32,6 +32,8 @@ typedef struct crsfDisplayPortScreen_s {
     uint8_t rows;
     uint8_t cols;
     bool reset;
+    bool rowUpdates;    // client takes individual rows rather than the whole buffer
+    uint16_t dirtyRows; // rows changed since they were last sent, when rowUpdates is set
 } crsfDisplayPortScreen_t;
 
 void crsfDisplayportRegister(void);
@@ -41,3 +43,4 @@ void crsfDisplayPortMenuExit(void);
 void crsfDisplayPortRefresh(void);
 bool crsfDisplayPortIsReady(void);
 void crsfDisplayPortSetDimensions(uint8_t rows, uint8_t cols);
+void crsfDisplayPortSetRowUpdates(bool rowUpdates);
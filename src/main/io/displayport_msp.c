@@ -27,6 +27,8 @@
 
 #ifdef USE_MSP_DISPLAYPORT
 
+#include "build/debug.h"
+
 #include "cli/cli.h"
 
 #include "common/utils.h"
@@ -46,14 +48,206 @@
 
 static displayPort_t mspDisplayPort;
 static serialPortIdentifier_e displayPortSerial;
+static uint8_t vtxCapabilities;
+
+// Bytes and MSP frames sent since the last drawScreen
+static uint16_t frameBytes;
+static uint8_t frameMessages;
+
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+/*
+ * If the VTX advertises DISPLAYPORT_MSP_CAP_WRITE_RUNS the canvas is drawn locally and only
+ * the cells which differ from what the VTX was last sent are transmitted by drawScreen.
+ *
+ * MSP_DP_WRITE_RUNS payload, spans never cross a row and several are packed per frame:
+ *
+ *   subcmd, { row, col, attr, { chunk }..., 0 }...
+ *
+ *   chunk: n (1..127), glyph[n]               n literal glyphs
+ *          0x80 | n (1..127), glyph           glyph repeated n times
+ *
+ * Otherwise the same canvases are used as the back and front canvas of a buffered display,
+ * see drivers/display.c, which only sends the strings that have changed and paces them to
+ * the space in the MSP transmit buffer.
+ */
+#define MSP_DP_DELTA_MAX_CELLS (OSD_HD_COLS * OSD_HD_ROWS)
+#define MSP_DP_DELTA_MAX_PAYLOAD 250 // Fits in an MSP V1 frame
+#define MSP_DP_DELTA_MAX_GAP 4       // Unchanged cells re-sent rather than starting a new span
+#define MSP_DP_RUN_REPEAT 0x80
+#define MSP_DP_RUN_MAX_LENGTH 0x7f
+#define MSP_DP_RUN_MIN_REPEAT 3
+
+#define MSP_DP_CELL(glyph, attr) ((uint16_t)(glyph) | ((uint16_t)(attr) << 8))
+#define MSP_DP_CELL_GLYPH(cell) ((cell) & 0xff)
+#define MSP_DP_CELL_ATTR(cell) ((cell) >> 8)
+#define MSP_DP_CELL_BLANK MSP_DP_CELL(' ', 0)
+#define MSP_DP_CELL_INVALID 0xffff
+
+static uint16_t canvas[MSP_DP_DELTA_MAX_CELLS];
+static uint16_t vtxCanvas[MSP_DP_DELTA_MAX_CELLS];
+static bool vtxCanvasValid;
+static uint8_t refreshRow;
+
+static displayBuffer_t displayBuffer;
+static uint32_t displayBufferDirtyBits[DISPLAY_BUFFER_DIRTY_WORDS(MSP_DP_DELTA_MAX_CELLS)];
+#endif
 
 static int output(displayPort_t *displayPort, uint8_t cmd, uint8_t *buf, int len)
 {
     UNUSED(displayPort);
 
-    return mspSerialPush(displayPortSerial, cmd, buf, len, MSP_DIRECTION_REPLY, MSP_V1);
+    const int bytes = mspSerialPush(displayPortSerial, cmd, buf, len, MSP_DIRECTION_REPLY, MSP_V1);
+
+    frameBytes += bytes;
+    frameMessages++;
+
+    return bytes;
+}
+
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+static bool deltaEnabled(const displayPort_t *displayPort)
+{
+    return (vtxCapabilities & DISPLAYPORT_MSP_CAP_WRITE_RUNS) && (displayPort->rows * displayPort->cols <= MSP_DP_DELTA_MAX_CELLS);
+}
+
+// Encode count cells of the same attribute as chunks, returns the number of bytes written including the terminator
+STATIC_UNIT_TESTED int mspDpEncodeSpan(uint8_t *buf, const uint16_t *cells, int count)
+{
+    uint8_t *p = buf;
+    int literalStart = 0;
+    int literalCount = 0;
+
+    for (int i = 0; i < count; ) {
+        int repeat = 1;
+        while (i + repeat < count && repeat < MSP_DP_RUN_MAX_LENGTH && MSP_DP_CELL_GLYPH(cells[i + repeat]) == MSP_DP_CELL_GLYPH(cells[i])) {
+            repeat++;
+        }
+
+        if (repeat >= MSP_DP_RUN_MIN_REPEAT || literalCount == MSP_DP_RUN_MAX_LENGTH) {
+            if (literalCount) {
+                *p++ = literalCount;
+                for (int j = literalStart; j < literalStart + literalCount; j++) {
+                    *p++ = MSP_DP_CELL_GLYPH(cells[j]);
+                }
+                literalCount = 0;
+            }
+        }
+
+        if (repeat >= MSP_DP_RUN_MIN_REPEAT) {
+            *p++ = MSP_DP_RUN_REPEAT | repeat;
+            *p++ = MSP_DP_CELL_GLYPH(cells[i]);
+            i += repeat;
+        } else {
+            if (literalCount == 0) {
+                literalStart = i;
+            }
+            literalCount++;
+            i++;
+        }
+    }
+
+    if (literalCount) {
+        *p++ = literalCount;
+        for (int j = literalStart; j < literalStart + literalCount; j++) {
+            *p++ = MSP_DP_CELL_GLYPH(cells[j]);
+        }
+    }
+
+    *p++ = 0;
+
+    return p - buf;
 }
 
+// Use the generic display buffer unless the VTX canvas is handled here
+static void updateBuffering(displayPort_t *displayPort)
+{
+    if (!deltaEnabled(displayPort) && displayPort->rows * displayPort->cols <= MSP_DP_DELTA_MAX_CELLS) {
+        displayBufferInit(displayPort, &displayBuffer, canvas, vtxCanvas, displayBufferDirtyBits, MSP_DP_DELTA_MAX_CELLS);
+    } else {
+        displayPort->buffer = NULL;
+    }
+}
+
+static void resyncVtxCanvas(displayPort_t *displayPort)
+{
+    uint8_t subcmd[] = { MSP_DP_CLEAR_SCREEN };
+    output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
+
+    for (unsigned i = 0; i < ARRAYLEN(vtxCanvas); i++) {
+        vtxCanvas[i] = MSP_DP_CELL_BLANK;
+    }
+    vtxCanvasValid = true;
+}
+
+// Send the cells that differ from the VTX canvas as MSP_DP_WRITE_RUNS, returns the number of cells changed
+static int drawScreenDelta(displayPort_t *displayPort)
+{
+    uint8_t buf[MSP_DP_DELTA_MAX_PAYLOAD];
+    int len = 0;
+    int changed = 0;
+
+    if (!vtxCanvasValid) {
+        resyncVtxCanvas(displayPort);
+    }
+
+    // Re-send one row per frame so a VTX which has lost its canvas recovers
+    if (++refreshRow >= displayPort->rows) {
+        refreshRow = 0;
+    }
+    for (int col = 0; col < displayPort->cols; col++) {
+        vtxCanvas[refreshRow * displayPort->cols + col] = MSP_DP_CELL_INVALID;
+    }
+
+    for (int row = 0; row < displayPort->rows; row++) {
+        uint16_t *cells = &canvas[row * displayPort->cols];
+        uint16_t *vtxCells = &vtxCanvas[row * displayPort->cols];
+        int col = 0;
+
+        while (col < displayPort->cols) {
+            if (cells[col] == vtxCells[col]) {
+                col++;
+                continue;
+            }
+
+            // Extend the span over changed cells of the same attribute, bridging short unchanged gaps
+            const int start = col;
+            const uint8_t attr = MSP_DP_CELL_ATTR(cells[start]);
+            int end = start + 1;
+            for (int i = end; i < displayPort->cols && i - end <= MSP_DP_DELTA_MAX_GAP && MSP_DP_CELL_ATTR(cells[i]) == attr; i++) {
+                if (cells[i] != vtxCells[i]) {
+                    end = i + 1;
+                }
+            }
+            const int count = end - start;
+
+            // Worst case is every cell a literal plus a length byte per chunk, header and terminator
+            if (len + 4 + count + count / MSP_DP_RUN_MAX_LENGTH + 1 > MSP_DP_DELTA_MAX_PAYLOAD) {
+                output(displayPort, MSP_DISPLAYPORT, buf, len);
+                len = 0;
+            }
+            if (len == 0) {
+                buf[len++] = MSP_DP_WRITE_RUNS;
+            }
+
+            buf[len++] = row;
+            buf[len++] = start;
+            buf[len++] = attr;
+            len += mspDpEncodeSpan(&buf[len], &cells[start], count);
+
+            memcpy(&vtxCells[start], &cells[start], count * sizeof(cells[0]));
+            changed += count;
+            col = end;
+        }
+    }
+
+    if (len) {
+        output(displayPort, MSP_DISPLAYPORT, buf, len);
+    }
+
+    return changed;
+}
+#endif // USE_MSP_DISPLAYPORT_DELTA
+
 static int heartbeat(displayPort_t *displayPort)
 {
     uint8_t subcmd[] = { MSP_DP_HEARTBEAT };
@@ -75,6 +269,12 @@ static int release(displayPort_t *displayPort)
 {
     uint8_t subcmd[] = { MSP_DP_RELEASE };
 
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    // The VTX clears its canvas when released
+    vtxCanvasValid = false;
+    displayBufferReset(displayPort, DISPLAY_BUFFER_CELL_BLANK);
+#endif
+
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
 
@@ -82,6 +282,16 @@ static int clearScreen(displayPort_t *displayPort, displayClearOption_e options)
 {
     UNUSED(options);
 
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    if (deltaEnabled(displayPort)) {
+        for (int i = 0; i < displayPort->rows * displayPort->cols; i++) {
+            canvas[i] = MSP_DP_CELL_BLANK;
+        }
+
+        return 0;
+    }
+#endif
+
     uint8_t subcmd[] = { MSP_DP_CLEAR_SCREEN };
 
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
@@ -89,9 +299,25 @@ static int clearScreen(displayPort_t *displayPort, displayClearOption_e options)
 
 static bool drawScreen(displayPort_t *displayPort)
 {
+    int changed = 0;
+
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    if (deltaEnabled(displayPort)) {
+        changed = drawScreenDelta(displayPort);
+    }
+#endif
+
     uint8_t subcmd[] = { MSP_DP_DRAW_SCREEN };
     output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 
+    DEBUG_SET(DEBUG_MSP_DISPLAYPORT, 0, frameBytes);
+    DEBUG_SET(DEBUG_MSP_DISPLAYPORT, 1, frameMessages);
+    DEBUG_SET(DEBUG_MSP_DISPLAYPORT, 2, changed);
+    DEBUG_SET(DEBUG_MSP_DISPLAYPORT, 3, vtxCapabilities);
+
+    frameBytes = 0;
+    frameMessages = 0;
+
     return 0;
 }
 
@@ -105,6 +331,27 @@ static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, uin
 #define MSP_OSD_MAX_STRING_LENGTH 30 // FIXME move this
     uint8_t buf[MSP_OSD_MAX_STRING_LENGTH + 4];
 
+    uint8_t mspAttr = displayPortProfileMsp()->fontSelection[attr & (DISPLAYPORT_SEVERITY_COUNT - 1)] & DISPLAYPORT_MSP_ATTR_FONT;
+
+    if (attr & DISPLAYPORT_BLINK) {
+        mspAttr |= DISPLAYPORT_MSP_ATTR_BLINK;
+    }
+
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    if (deltaEnabled(displayPort)) {
+        if (row >= displayPort->rows) {
+            return 0;
+        }
+
+        uint16_t *cell = &canvas[row * displayPort->cols + col];
+        for (int i = col; *string && i < displayPort->cols; i++) {
+            *cell++ = MSP_DP_CELL(*string++, mspAttr);
+        }
+
+        return 0;
+    }
+#endif
+
     int len = strlen(string);
     if (len >= MSP_OSD_MAX_STRING_LENGTH) {
         len = MSP_OSD_MAX_STRING_LENGTH;
@@ -113,11 +360,7 @@ static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, uin
     buf[0] = MSP_DP_WRITE_STRING;
     buf[1] = row;
     buf[2] = col;
-    buf[3] = displayPortProfileMsp()->fontSelection[attr & (DISPLAYPORT_SEVERITY_COUNT - 1)] & DISPLAYPORT_MSP_ATTR_FONT;
-
-    if (attr & DISPLAYPORT_BLINK) {
-        buf[3] |= DISPLAYPORT_MSP_ATTR_BLINK;
-    }
+    buf[3] = mspAttr;
 
     memcpy(&buf[4], string, len);
 
@@ -159,6 +402,15 @@ static bool isSynced(const displayPort_t *displayPort)
 
 static void redraw(displayPort_t *displayPort)
 {
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    vtxCanvasValid = false;
+
+    if (displayIsBuffered(displayPort)) {
+        clearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+        displayBufferReset(displayPort, DISPLAY_BUFFER_CELL_BLANK);
+    }
+#endif
+
     drawScreen(displayPort);
 }
 
@@ -215,6 +467,10 @@ displayPort_t *displayPortMspInit(void)
         mspDisplayPort.cols = OSD_SD_COLS + displayPortProfileMsp()->colAdjust;
     }
 
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+    updateBuffering(&mspDisplayPort);
+#endif
+
     redraw(&mspDisplayPort);
 
     return &mspDisplayPort;
@@ -228,4 +484,21 @@ void displayPortMspSetSerial(serialPortIdentifier_e serialPort)
 serialPortIdentifier_e displayPortMspGetSerial(void) {
     return displayPortSerial;
 }
+
+void displayPortMspSetCapabilities(uint8_t capabilities)
+{
+    if (capabilities != vtxCapabilities) {
+        vtxCapabilities = capabilities;
+#ifdef USE_MSP_DISPLAYPORT_DELTA
+        // Start from a known VTX canvas on switching protocol
+        vtxCanvasValid = false;
+        for (unsigned i = 0; i < ARRAYLEN(canvas); i++) {
+            canvas[i] = MSP_DP_CELL_BLANK;
+        }
+        if (mspDisplayPort.vTable) {
+            updateBuffering(&mspDisplayPort);
+        }
+#endif
+    }
+}
 #endif // USE_MSP_DISPLAYPORT
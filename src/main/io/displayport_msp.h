@@ -35,6 +35,7 @@ typedef enum {
     MSP_DP_DRAW_SCREEN = 4,     // Trigger a screen draw
     MSP_DP_OPTIONS = 5,         // Not used by Betaflight. Reserved by Ardupilot and INAV
     MSP_DP_SYS = 6,             // Display system element displayportSystemElement_e at given coordinates
+    MSP_DP_WRITE_RUNS = 7,      // Write run-length encoded spans of changed cells, see displayport_msp.c
     MSP_DP_COUNT,
 } displayportMspCommand_e;
 
@@ -44,7 +45,11 @@ typedef enum {
 #define DISPLAYPORT_MSP_ATTR_FONT    (BIT(0) | BIT(1)) // Select bank of 256 characters as per displayPortSeverity_e
 #define DISPLAYPORT_MSP_ATTR_MASK    (DISPLAYPORT_MSP_ATTR_VERSION | DISPLAYPORT_MSP_ATTR_BLINK | DISPLAYPORT_MSP_ATTR_FONT)
 
+// MSP2_SET_DISPLAYPORT_CAPS capability bits
+#define DISPLAYPORT_MSP_CAP_WRITE_RUNS BIT(0) // VTX accepts MSP_DP_WRITE_RUNS and retains its canvas between frames
+
 struct displayPort_s *displayPortMspInit(void);
 void displayPortMspSetSerial(serialPortIdentifier_e serialPort);
 serialPortIdentifier_e displayPortMspGetSerial(void);
+void displayPortMspSetCapabilities(uint8_t capabilities);
 
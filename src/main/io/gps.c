@@ -47,6 +47,8 @@
 #endif
 
 #include "io/gps.h"
+#include "io/gps_fix.h"
+#include "io/gps_framer.h"
 #include "io/gps_virtual.h"
 
 #include "io/serial.h"
@@ -91,6 +93,8 @@ GPS_svinfo_t GPS_svinfo[GPS_SV_MAXSATS_M8N];
 #define GPS_CONFIG_CHANGE_INTERVAL 110       // Time to wait, in ms, between CONFIG steps
 #define GPS_BAUDRATE_TEST_COUNT 3      // Number of times to repeat the test message when setting baudrate
 #define GPS_RECV_TIME_MAX 25           // Max permitted time, in us, for the Receive Data process
+#define GPS_RECV_CHUNK_SIZE 32U        // Bytes read from the port and framed in one go
+#define GPS_RECV_FRAMES_MAX 4          // Max queued frames parsed per GPS task run
 // Decay the estimated max task duration by 1/(1 << GPS_TASK_DECAY_SHIFT) on every invocation
 #define GPS_TASK_DECAY_SHIFT 9         // Smoothing factor for GPS task re-scheduler
 
@@ -98,6 +102,14 @@ static serialPort_t *gpsPort;
 static float gpsDataIntervalSeconds = 0.1f;
 static float gpsDataFrequencyHz = 10.0f;
 
+// velocity of the last nav solution, when the module reports it, otherwise it is derived from speed and course
+static float gpsVelNorthCmS;
+static float gpsVelEastCmS;
+static bool gpsHaveNewVelNed = false;
+
+static timeDelta_t gpsParseTimeUs;     // time spent parsing since the last nav solution
+static timeUs_t gpsParseStartUs;
+
 static uint16_t currentGpsStamp = 0; // logical timer for received position update
 
 typedef struct gpsInitData_s {
@@ -370,9 +382,26 @@ static void logErrorToPacketLog(void)
     *dashboardGpsPacketLogCurrentChar = DASHBOARD_LOG_ERROR;
     gpsData.errors++;
 }
+
+static uint32_t dashboardGpsFramerErrors;                           // Framer errors already counted.
+
+// The framer drops bad frames before they reach the parsers, count its errors here.
+static void logFramerErrorsToPacketLog(void)
+{
+    const uint32_t errors = gpsFramerGetStats()->errors;
+    if (errors != dashboardGpsFramerErrors) {
+        shiftPacketLog();
+        *dashboardGpsPacketLogCurrentChar = DASHBOARD_LOG_ERROR;
+        gpsData.errors += errors - dashboardGpsFramerErrors;
+        dashboardGpsFramerErrors = errors;
+    }
+}
 #endif  // USE_DASHBOARD
 
 static void gpsNewData(uint16_t c);
+static void gpsNewDataBuffer(const uint8_t *data, uint32_t count);
+static bool gpsFrameFilter(gpsFrameType_e type, const uint8_t *id);
+static void gpsRxCallback(uint16_t data, void *rxCallbackData);
 #ifdef USE_GPS_NMEA
 static bool gpsNewFrameNMEA(char c);
 #endif
@@ -401,9 +430,11 @@ void gpsInit(void)
 #endif
     gpsData.updateRateHz = 10; // initialise at 10hz
     gpsData.platformVersion = UBX_VERSION_UNDEF;
+    gpsFixInit();
 
 #ifdef USE_DASHBOARD
     gpsData.errors = 0;
+    dashboardGpsFramerErrors = 0;
     memset(dashboardGpsPacketLog, 0x00, sizeof(dashboardGpsPacketLog));
 #endif
 
@@ -449,8 +480,10 @@ void gpsInit(void)
 #endif
     }
 
-    // no callback - buffer will be consumed in gpsUpdate()
-    gpsPort = openSerialPort(gpsPortConfig->identifier, FUNCTION_GPS, NULL, NULL, baudRates[gpsInitData[gpsData.userBaudRateIndex].baudrateIndex], mode, options);
+    gpsFramerInit(gpsFrameFilter);
+
+    // the callback only frames the received messages, they are parsed in gpsUpdate()
+    gpsPort = openSerialPort(gpsPortConfig->identifier, FUNCTION_GPS, gpsRxCallback, NULL, baudRates[gpsInitData[gpsData.userBaudRateIndex].baudrateIndex], mode, options);
     if (!gpsPort) {
         return;
     }
@@ -1349,8 +1382,8 @@ static void calculateNavInterval (void)
     const uint32_t weekDurationMs = 7 * 24 * 3600 * 1000;
     const uint32_t navDeltaTimeMs = (weekDurationMs + gpsSol.time - gpsData.lastNavSolTs) % weekDurationMs;
     gpsData.lastNavSolTs = gpsSol.time;
-    // constrain the interval between 50ms / 20hz or 2.5s, when we would get a connection failure anyway
-    gpsSol.navIntervalMs = constrain(navDeltaTimeMs, 50, 2500);
+    // constrain the interval between 40ms / 25hz or 2.5s, when we would get a connection failure anyway
+    gpsSol.navIntervalMs = constrain(navDeltaTimeMs, 40, 2500);
 }
 
 #if defined(USE_VIRTUAL_GPS)
@@ -1401,19 +1434,45 @@ void gpsUpdate(timeUs_t currentTimeUs)
         DEBUG_SET(DEBUG_GPS_CONNECTION, 7, serialRxBytesWaiting(gpsPort));
         static uint8_t wait = 0;
         static bool isFast = false;
-        while (serialRxBytesWaiting(gpsPort)) {
+        // a port with RX DMA doesn't call back, its bytes are framed here
+        uint32_t bytesWaiting;
+        while ((bytesWaiting = serialRxBytesWaiting(gpsPort)) && cmpTimeUs(micros(), currentTimeUs) <= GPS_RECV_TIME_MAX) {
+            const uint32_t count = MIN(bytesWaiting, GPS_RECV_CHUNK_SIZE);
+            for (uint32_t i = 0; i < count; i++) {
+                gpsFramerReceive(serialRead(gpsPort));
+            }
+        }
+        // parse a bounded number of complete messages, the rest wait for the next run
+        const timeUs_t recvStartUs = micros();
+        int frameCount = 0;
+        while (frameCount < GPS_RECV_FRAMES_MAX && cmpTimeUs(micros(), recvStartUs) <= GPS_RECV_TIME_MAX) {
+            gpsParseStartUs = micros();
+            if (!gpsFramerProcessFrame(gpsNewDataBuffer)) {
+                break;
+            }
+            gpsParseTimeUs += cmpTimeUs(micros(), gpsParseStartUs);
+            frameCount++;
+        }
+#ifdef USE_DASHBOARD
+        logFramerErrorsToPacketLog();
+#endif
+        if (frameCount) {
+            static timeDelta_t recvTimeMaxUs;
+            const timeDelta_t recvTimeUs = cmpTimeUs(micros(), recvStartUs);
+            recvTimeMaxUs = MAX(recvTimeMaxUs, recvTimeUs);
+            const gpsFramerStats_t *framerStats = gpsFramerGetStats();
+            DEBUG_SET(DEBUG_GPS_TIMING, 4, recvTimeUs);
+            DEBUG_SET(DEBUG_GPS_TIMING, 5, recvTimeMaxUs);
+            DEBUG_SET(DEBUG_GPS_TIMING, 6, framerStats->queueMax);
+            DEBUG_SET(DEBUG_GPS_TIMING, 7, framerStats->dropped + framerStats->errors);
+        }
+        if (frameCount || gpsFramerFrameWaiting() || serialRxBytesWaiting(gpsPort)) {
             wait = 0;
             if (!isFast) {
                 rescheduleTask(TASK_SELF, TASK_PERIOD_HZ(TASK_GPS_RATE_FAST));
                 isFast = true;
             }
-            if (cmpTimeUs(micros(), currentTimeUs) > GPS_RECV_TIME_MAX) {
-                break;
-            }
-            // Add every byte to _buffer, when enough bytes are received, convert data to values
-            gpsNewData(serialRead(gpsPort));
-        }
-        if (wait < 1) {
+        } else if (wait < 1) {
             wait++;
         } else if (wait == 1) {
             wait++;
@@ -1548,6 +1607,8 @@ static void gpsNewData(uint16_t c)
     }
     GPS_update ^= GPS_DIRECT_TICK;
     onGpsNewData();
+    // the handling of the solution is not parse time
+    gpsParseStartUs = micros();
 }
 
 #ifdef USE_GPS_UBLOX
@@ -1829,7 +1890,7 @@ static bool writeGpsSolutionNmea(gpsSolutionData_t *sol, const gpsDataNmea_t *da
         }
         navDeltaTimeMs = (msInTenSeconds + data->time - gpsData.lastNavSolTs) % msInTenSeconds;
         gpsData.lastNavSolTs = data->time;
-        sol->navIntervalMs = constrain(navDeltaTimeMs, 50, 2500);
+        sol->navIntervalMs = constrain(navDeltaTimeMs, 40, 2500);
         // return only one true statement to trigger one "newGpsDataReady" flag per GPS loop
         return true;
 
@@ -2177,6 +2238,28 @@ static uint16_t ubxFrameParsePayloadCounter;
 // Combines message class & ID for a single value to switch on.
 #define CLSMSG(cls, msg) (((cls) << 8) | (msg))
 
+// The messages handled by UBLOX_parse_gps(), all others are discarded as they are received
+static bool ubloxWantedMessage(uint8_t msgClass, uint8_t msgId)
+{
+    switch (CLSMSG(msgClass, msgId)) {
+    case CLSMSG(CLASS_MON, MSG_MON_VER):
+    case CLSMSG(CLASS_NAV, MSG_NAV_POSLLH):
+    case CLSMSG(CLASS_NAV, MSG_NAV_STATUS):
+    case CLSMSG(CLASS_NAV, MSG_NAV_DOP):
+    case CLSMSG(CLASS_NAV, MSG_NAV_SOL):
+    case CLSMSG(CLASS_NAV, MSG_NAV_VELNED):
+    case CLSMSG(CLASS_NAV, MSG_NAV_PVT):
+    case CLSMSG(CLASS_NAV, MSG_NAV_SVINFO):
+    case CLSMSG(CLASS_NAV, MSG_NAV_SAT):
+    case CLSMSG(CLASS_CFG, MSG_CFG_GNSS):
+    case CLSMSG(CLASS_ACK, MSG_ACK_ACK):
+    case CLSMSG(CLASS_ACK, MSG_ACK_NACK):
+        return true;
+    default:
+        return false;
+    }
+}
+
 static bool UBLOX_parse_gps(void)
 {
 //    lastUbxRcvMsgClass = ubxRcvMsgClass;
@@ -2249,6 +2332,9 @@ static bool UBLOX_parse_gps(void)
         gpsSol.speed3d = ubxRcvMsgPayload.ubxNavVelned.speed_3d;       // cm/s
         gpsSol.groundSpeed = ubxRcvMsgPayload.ubxNavVelned.speed_2d;   // cm/s
         gpsSol.groundCourse = (uint16_t) (ubxRcvMsgPayload.ubxNavVelned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+        gpsVelNorthCmS = ubxRcvMsgPayload.ubxNavVelned.ned_north;      // cm/s
+        gpsVelEastCmS = ubxRcvMsgPayload.ubxNavVelned.ned_east;
+        gpsHaveNewVelNed = true;
         ubxHaveNewSpeed = true;
         break;
     case CLSMSG(CLASS_NAV, MSG_NAV_PVT):
@@ -2269,6 +2355,9 @@ static bool UBLOX_parse_gps(void)
         gpsSol.acc.sAcc = ubxRcvMsgPayload.ubxNavPvt.sAcc;
         gpsSol.speed3d = (uint16_t) sqrtf(powf(ubxRcvMsgPayload.ubxNavPvt.gSpeed / 10, 2.0f) + powf(ubxRcvMsgPayload.ubxNavPvt.velD / 10, 2.0f));
         gpsSol.groundSpeed = ubxRcvMsgPayload.ubxNavPvt.gSpeed / 10;    // cm/s
+        gpsVelNorthCmS = ubxRcvMsgPayload.ubxNavPvt.velN * 0.1f;        // mm/s to cm/s
+        gpsVelEastCmS = ubxRcvMsgPayload.ubxNavPvt.velE * 0.1f;
+        gpsHaveNewVelNed = true;
         gpsSol.groundCourse = (uint16_t) (ubxRcvMsgPayload.ubxNavPvt.headMot / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
         gpsSol.dop.pdop = ubxRcvMsgPayload.ubxNavPvt.pDOP;
         ubxHaveNewSpeed = true;
@@ -2522,8 +2611,82 @@ static bool gpsNewFrameUBLOX(uint8_t data)
     // Note this function returns if UBLOX_parse_gps() found new position data, NOT whether this function successfully parsed the frame or not.
     return newPositionDataReceived;
 }
+
+// Takes the payload bytes of the current message in one go, rather than through the byte state machine.
+// Returns the number of bytes used, the rest belong to the checksum and the following messages.
+static uint32_t ubloxParsePayload(const uint8_t *data, uint32_t count)
+{
+    const uint32_t length = MIN(count, (uint32_t)(ubxRcvMsgPayloadLength - ubxFrameParsePayloadCounter));
+    uint8_t checksumA = ubxRcvMsgChecksumA;
+    uint8_t checksumB = ubxRcvMsgChecksumB;
+
+    for (uint32_t i = 0; i < length; i++) {
+        checksumB += (checksumA += data[i]);
+    }
+    ubxRcvMsgChecksumA = checksumA;
+    ubxRcvMsgChecksumB = checksumB;
+
+    // only bytes up to the max supported payload size are kept, the rest is only checksummed
+    if (ubxFrameParsePayloadCounter < UBLOX_PAYLOAD_SIZE) {
+        memcpy(&ubxRcvMsgPayload.rawBytes[ubxFrameParsePayloadCounter], data, MIN(length, (uint32_t)(UBLOX_PAYLOAD_SIZE - ubxFrameParsePayloadCounter)));
+    }
+
+    ubxFrameParsePayloadCounter += length;
+    if (ubxFrameParsePayloadCounter >= ubxRcvMsgPayloadLength) {
+        ubxFrameParseState = UBX_PARSE_CHECKSUM_A;
+    }
+    return length;
+}
 #endif // USE_GPS_UBLOX
 
+static void gpsNewDataBuffer(const uint8_t *data, uint32_t count)
+{
+    while (count > 0) {
+#ifdef USE_GPS_UBLOX
+        if (ubxFrameParseState == UBX_PARSE_PAYLOAD_CONTENT && gpsConfig()->provider == GPS_UBLOX) {
+            // the payload does not complete a message, so nothing is missed by not feeding it to gpsNewData()
+            const uint32_t used = ubloxParsePayload(data, count);
+            data += used;
+            count -= used;
+            continue;
+        }
+#endif
+        gpsNewData(*data++);
+        count--;
+    }
+}
+
+static bool gpsFrameFilter(gpsFrameType_e type, const uint8_t *id)
+{
+    // only the messages the parser of the provider uses are queued
+    switch (gpsConfig()->provider) {
+#ifdef USE_GPS_UBLOX
+    case GPS_UBLOX:
+        return type == GPS_FRAME_UBX && ubloxWantedMessage(id[0], id[1]);
+#endif
+#ifdef USE_GPS_NMEA
+    case GPS_NMEA: {
+        if (type != GPS_FRAME_NMEA) {
+            return false;
+        }
+        // the talker, in the first two characters, doesn't matter
+        const char *sentence = (const char *)&id[2];
+        return strncmp(sentence, "GGA", 3) == 0 || strncmp(sentence, "RMC", 3) == 0
+            || strncmp(sentence, "GSV", 3) == 0 || strncmp(sentence, "GSA", 3) == 0;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+static void gpsRxCallback(uint16_t data, void *rxCallbackData)
+{
+    UNUSED(rxCallbackData);
+
+    gpsFramerReceive(data);
+}
+
 static void gpsHandlePassthrough(uint8_t data)
 {
     gpsNewData(data);
@@ -2559,6 +2722,9 @@ bool gpsPassthrough(serialPort_t *gpsPassthroughPort)
     }
 #endif
 
+    // the passthrough needs the received bytes in the port buffer, rather than in the framer
+    gpsPort->rxCallback = NULL;
+
     serialPassthrough(gpsPort, gpsPassthroughPort, &gpsHandlePassthrough, NULL);
     // allow exitting passthrough mode in future
     return true;
@@ -2682,9 +2848,26 @@ void onGpsNewData(void)
         return;
     }
 
+    const timeUs_t currentTimeUs = micros();
+    if (!gpsHaveNewVelNed) {
+        const float courseRad = DECIDEGREES_TO_RADIANS(gpsSol.groundCourse);
+        gpsVelNorthCmS = gpsSol.groundSpeed * cos_approx(courseRad);
+        gpsVelEastCmS = gpsSol.groundSpeed * sin_approx(courseRad);
+    }
+    gpsHaveNewVelNed = false;
+    // UBX solutions carry their GPS time of week, used to time stamp the fix
+    const bool hasTime = gpsConfig()->provider == GPS_UBLOX;
+    const timeDelta_t parseTimeUs = gpsParseTimeUs + cmpTimeUs(currentTimeUs, gpsParseStartUs);
+    gpsParseTimeUs = 0;
+    gpsFixUpdate(&gpsSol.llh, gpsVelNorthCmS, gpsVelEastCmS, hasTime, gpsSol.time, currentTimeUs, parseTimeUs);
+
+    DEBUG_SET(DEBUG_GPS_TIMING, 0, parseTimeUs);
+    DEBUG_SET(DEBUG_GPS_TIMING, 2, gpsFixGetStats()->transportDelayUs);
+    DEBUG_SET(DEBUG_GPS_TIMING, 3, gpsSol.navIntervalMs);
+
     currentGpsStamp++; // new GPS data available
 
-    gpsDataIntervalSeconds = gpsSol.navIntervalMs * 0.001f; // range for navIntervalMs is constrained to 50 - 2500
+    gpsDataIntervalSeconds = gpsSol.navIntervalMs * 0.001f; // range for navIntervalMs is constrained to 40 - 2500
     gpsDataFrequencyHz = 1.0f / gpsDataIntervalSeconds;
 
     GPS_calculateDistanceAndDirectionToHome();
@@ -391,7 +391,7 @@ void GPS_distance2d(const gpsLocation_t *from, const gpsLocation_t *to, vector2_
 void gpsSetFixState(bool state);
 
 bool gpsHasNewData(uint16_t *stamp);
-float getGpsDataIntervalSeconds(void);  // range 0.05 - 2.5s
-float getGpsDataFrequencyHz(void);      // range 20Hz - 0.4Hz
+float getGpsDataIntervalSeconds(void);  // range 0.04 - 2.5s
+float getGpsDataFrequencyHz(void);      // range 25Hz - 0.4Hz
 
 baudRate_e getGpsPortActualBaudRateIndex(void);
@@ -0,0 +1,154 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Time stamping and extrapolation of GPS fixes.
+ *
+ * The GPS time of each solution is mapped onto the local clock. The fix that arrives the quickest after
+ * its GPS time sets the mapping, since it was delayed the least by the module and the serial link; later
+ * fixes follow the mapping, which creeps towards them to track the drift between the two clocks. Between
+ * fixes the location is extrapolated from the last fix with its velocity, so that position control sees
+ * where the craft is now rather than where it was when the fix was computed.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_GPS
+
+#include "common/maths.h"
+
+#include "io/gps_fix.h"
+
+#define GPS_FIX_WEEK_MS             (7 * 24 * 3600 * 1000)
+#define GPS_FIX_CLOCK_DRIFT_SHIFT   6   // the mapping moves 1/64 of the way to a late fix
+
+typedef struct gpsFixState_s {
+    bool valid;
+    gpsLocation_t llh;
+    float velNorthCmS;
+    float velEastCmS;
+    float lonScale;                 // longitude units per cm at the fix latitude
+    timeUs_t fixTimeUs;             // local time of the fix
+    timeUs_t arrivalUs;
+    bool used;
+
+    bool clockValid;
+    uint32_t clockTimeMs;           // GPS time and local time of the mapping
+    timeUs_t clockLocalUs;
+
+    gpsFixStats_t stats;
+} gpsFixState_t;
+
+static gpsFixState_t gpsFix;
+
+void gpsFixInit(void)
+{
+    memset(&gpsFix, 0, sizeof(gpsFix));
+}
+
+static timeUs_t gpsFixAlignTime(uint32_t timeMs, timeUs_t arrivalUs)
+{
+    if (gpsFix.clockValid) {
+        // GPS time wraps at the end of the week
+        const uint32_t elapsedMs = (GPS_FIX_WEEK_MS + timeMs - gpsFix.clockTimeMs) % GPS_FIX_WEEK_MS;
+        const timeUs_t expectedUs = gpsFix.clockLocalUs + elapsedMs * 1000;
+        const timeDelta_t delayUs = cmpTimeUs(arrivalUs, expectedUs);
+
+        if (delayUs >= 0 && delayUs < GPS_FIX_CLOCK_RESET_US) {
+            gpsFix.clockTimeMs = timeMs;
+            gpsFix.clockLocalUs = expectedUs + (delayUs >> GPS_FIX_CLOCK_DRIFT_SHIFT);
+            gpsFix.stats.transportDelayUs = delayUs;
+            return gpsFix.clockLocalUs;
+        }
+        // arrived quicker than any fix so far, or the GPS time jumped
+    }
+
+    gpsFix.clockValid = true;
+    gpsFix.clockTimeMs = timeMs;
+    gpsFix.clockLocalUs = arrivalUs;
+    gpsFix.stats.transportDelayUs = 0;
+    return arrivalUs;
+}
+
+void gpsFixUpdate(const gpsLocation_t *llh, float velNorthCmS, float velEastCmS, bool hasTime, uint32_t timeMs, timeUs_t arrivalUs, timeDelta_t parseTimeUs)
+{
+    gpsFix.fixTimeUs = hasTime ? gpsFixAlignTime(timeMs, arrivalUs) : arrivalUs;
+    gpsFix.arrivalUs = arrivalUs;
+    gpsFix.llh = *llh;
+    gpsFix.velNorthCmS = velNorthCmS;
+    gpsFix.velEastCmS = velEastCmS;
+    const float cosLat = cos_approx(DEGREES_TO_RADIANS((float)llh->lat / GPS_DEGREES_DIVIDER));
+    gpsFix.lonScale = 1.0f / (EARTH_ANGLE_TO_CM * fmaxf(cosLat, 0.01f));
+    gpsFix.used = false;
+    gpsFix.valid = true;
+
+    gpsFix.stats.fixCount++;
+    gpsFix.stats.parseTimeUs = parseTimeUs;
+    gpsFix.stats.parseTimeMaxUs = MAX(gpsFix.stats.parseTimeMaxUs, parseTimeUs);
+}
+
+bool gpsFixPredict(gpsLocation_t *llh, timeUs_t currentTimeUs)
+{
+    if (!gpsFix.valid) {
+        return false;
+    }
+
+    const timeDelta_t ageUs = constrain(cmpTimeUs(currentTimeUs, gpsFix.fixTimeUs), 0, GPS_FIX_PREDICT_MAX_US);
+    const float ageS = ageUs * 1e-6f;
+
+    *llh = gpsFix.llh;
+    llh->lat += lrintf(gpsFix.velNorthCmS * ageS / EARTH_ANGLE_TO_CM);
+    llh->lon += lrintf(gpsFix.velEastCmS * ageS * gpsFix.lonScale);
+    return true;
+}
+
+void gpsFixUsed(timeUs_t currentTimeUs)
+{
+    if (!gpsFix.valid || gpsFix.used) {
+        return;
+    }
+    gpsFix.used = true;
+    gpsFix.stats.fixToUseUs = cmpTimeUs(currentTimeUs, gpsFix.arrivalUs);
+    gpsFix.stats.fixToUseMaxUs = MAX(gpsFix.stats.fixToUseMaxUs, gpsFix.stats.fixToUseUs);
+}
+
+timeUs_t gpsFixTimeUs(void)
+{
+    return gpsFix.fixTimeUs;
+}
+
+bool gpsFixVelocity(float *velNorthCmS, float *velEastCmS)
+{
+    *velNorthCmS = gpsFix.velNorthCmS;
+    *velEastCmS = gpsFix.velEastCmS;
+    return gpsFix.valid;
+}
+
+const gpsFixStats_t *gpsFixGetStats(void)
+{
+    return &gpsFix.stats;
+}
+
+#endif // USE_GPS
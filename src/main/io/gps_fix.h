@@ -0,0 +1,60 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#include "io/gps.h"
+
+#define GPS_FIX_PREDICT_MAX_US      500000  // a fix is not extrapolated further than this
+#define GPS_FIX_CLOCK_RESET_US      1000000 // a fix this much later than expected restarts the clock alignment
+
+typedef struct gpsFixStats_s {
+    uint32_t fixCount;
+    timeDelta_t parseTimeUs;        // time spent parsing the bytes of the last fix
+    timeDelta_t parseTimeMaxUs;
+    timeDelta_t transportDelayUs;   // arrival of the last fix after the fastest arrival seen, from its GPS time
+    timeDelta_t fixToUseUs;         // arrival of the last fix until it was first used
+    timeDelta_t fixToUseMaxUs;
+} gpsFixStats_t;
+
+void gpsFixInit(void);
+
+// A new navigation solution. timeMs is the GPS time of the solution (UBX iTOW), used to time stamp the fix on
+// the local clock when hasTime is set, otherwise the arrival time is used. Velocities are in cm/s.
+void gpsFixUpdate(const gpsLocation_t *llh, float velNorthCmS, float velEastCmS, bool hasTime, uint32_t timeMs, timeUs_t arrivalUs, timeDelta_t parseTimeUs);
+
+// Location at currentTimeUs, extrapolated from the last fix with its velocity. Returns false if there is no fix.
+bool gpsFixPredict(gpsLocation_t *llh, timeUs_t currentTimeUs);
+
+// Records the fix to use latency the first time the current fix is used
+void gpsFixUsed(timeUs_t currentTimeUs);
+
+// Local time the current fix was valid
+timeUs_t gpsFixTimeUs(void);
+
+// Velocity of the current fix in cm/s. Returns false if there is no fix.
+bool gpsFixVelocity(float *velNorthCmS, float *velEastCmS);
+
+const gpsFixStats_t *gpsFixGetStats(void);
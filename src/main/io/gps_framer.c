@@ -0,0 +1,344 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Framing of the GPS receive stream.
+ *
+ * The receive stage runs per byte, normally in the serial interrupt. It only finds the UBX messages and NMEA
+ * sentences in the stream, asks the filter whether each is wanted once its header is known, and copies the
+ * wanted ones into the queue while checking their checksum. A frame becomes visible to the GPS task only once
+ * it is complete and valid, so the task parses whole messages, and the messages nobody uses are never parsed.
+ *
+ * Frames are stored in the queue as a 16 bit length followed by the bytes of the frame, as received.
+ * There is a single producer and a single consumer, so the indices need no locking.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_GPS
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "io/gps_framer.h"
+
+#define GPS_FRAMER_QUEUE_MASK   (GPS_FRAMER_QUEUE_SIZE - 1)
+#define GPS_FRAMER_HEADER_SIZE  2
+
+#define UBX_SYNC_CHAR_1         0xB5
+#define UBX_SYNC_CHAR_2         0x62
+#define NMEA_START_CHAR         '$'
+
+STATIC_ASSERT((GPS_FRAMER_QUEUE_SIZE & GPS_FRAMER_QUEUE_MASK) == 0, gps_framer_queue_size_not_power_of_2);
+STATIC_ASSERT(GPS_FRAMER_UBX_PAYLOAD_MAX + 8 + GPS_FRAMER_HEADER_SIZE <= GPS_FRAMER_QUEUE_SIZE, gps_framer_queue_too_small);
+
+typedef enum {
+    FRAMER_IDLE = 0,
+    FRAMER_UBX_SYNC_2,
+    FRAMER_UBX_CLASS,
+    FRAMER_UBX_ID,
+    FRAMER_UBX_LENGTH_1,
+    FRAMER_UBX_LENGTH_2,
+    FRAMER_UBX_PAYLOAD,
+    FRAMER_UBX_CHECKSUM_A,
+    FRAMER_UBX_CHECKSUM_B,
+    FRAMER_NMEA_ADDRESS,
+    FRAMER_NMEA_DATA,
+    FRAMER_NMEA_CHECKSUM_1,
+    FRAMER_NMEA_CHECKSUM_2,
+    FRAMER_NMEA_END,
+} gpsFramerState_e;
+
+typedef struct gpsFramer_s {
+    gpsFrameFilterFn filter;
+    gpsFramerState_e state;
+    bool keep;                  // the frame is being copied to the queue
+    uint16_t length;            // bytes of the frame so far, or the UBX payload still to come
+    uint8_t id[GPS_FRAMER_NMEA_ADDRESS_LENGTH];
+    uint8_t idLength;
+    uint8_t checksumA;
+    uint8_t checksumB;
+    uint8_t receivedChecksum;
+    uint16_t writeIndex;        // next byte of the frame being received
+} gpsFramer_t;
+
+// indices are free running, the queue size divides their range
+static uint8_t queue[GPS_FRAMER_QUEUE_SIZE];
+static volatile uint16_t queueHead;     // end of the complete frames, written by the receive stage
+static volatile uint16_t queueTail;     // start of the oldest frame, written by the task
+
+static gpsFramer_t framer;
+static gpsFramerStats_t stats;
+
+void gpsFramerInit(gpsFrameFilterFn filter)
+{
+    memset(&framer, 0, sizeof(framer));
+    memset(&stats, 0, sizeof(stats));
+    queueHead = 0;
+    queueTail = 0;
+    framer.filter = filter;
+}
+
+static void framerWrite(uint8_t c)
+{
+    if (!framer.keep) {
+        return;
+    }
+    if ((uint16_t)(framer.writeIndex - queueTail) >= GPS_FRAMER_QUEUE_SIZE) {
+        // the task is behind, the rest of the frame is still followed to stay in step with the stream
+        framer.keep = false;
+        stats.dropped++;
+        return;
+    }
+    queue[framer.writeIndex++ & GPS_FRAMER_QUEUE_MASK] = c;
+}
+
+static void framerStart(gpsFramerState_e state, uint8_t c)
+{
+    framer.state = state;
+    framer.keep = true;
+    framer.length = 1;
+    framer.idLength = 0;
+    framer.checksumA = 0;
+    framer.checksumB = 0;
+    // room for the length, filled in when the frame is complete
+    framer.writeIndex = queueHead + GPS_FRAMER_HEADER_SIZE;
+    framerWrite(c);
+}
+
+static void framerFilter(gpsFrameType_e type)
+{
+    if (framer.keep && framer.filter && !framer.filter(type, framer.id)) {
+        framer.keep = false;
+        stats.discarded++;
+    }
+}
+
+static void framerCommit(bool valid)
+{
+    framer.state = FRAMER_IDLE;
+    if (!valid) {
+        stats.errors++;
+        return;
+    }
+    if (!framer.keep) {
+        return;
+    }
+    const uint16_t head = queueHead;
+    const uint16_t length = framer.writeIndex - head - GPS_FRAMER_HEADER_SIZE;
+    queue[head & GPS_FRAMER_QUEUE_MASK] = length & 0xff;
+    queue[(head + 1) & GPS_FRAMER_QUEUE_MASK] = length >> 8;
+    // publish the frame once it is all in the queue
+    queueHead = framer.writeIndex;
+    stats.frames++;
+    stats.queueMax = MAX(stats.queueMax, (uint16_t)(framer.writeIndex - queueTail));
+}
+
+static bool framerReceiveUbx(uint8_t c)
+{
+    if (framer.state >= FRAMER_UBX_CLASS && framer.state <= FRAMER_UBX_PAYLOAD) {
+        // checksum over class, id, length and payload
+        framer.checksumA += c;
+        framer.checksumB += framer.checksumA;
+    }
+    switch (framer.state) {
+    case FRAMER_UBX_SYNC_2:
+        if (c != UBX_SYNC_CHAR_2) {
+            framer.state = FRAMER_IDLE;
+            return false;
+        }
+        framer.state = FRAMER_UBX_CLASS;
+        break;
+    case FRAMER_UBX_CLASS:
+        framer.id[0] = c;
+        framer.state = FRAMER_UBX_ID;
+        break;
+    case FRAMER_UBX_ID:
+        framer.id[1] = c;
+        framerFilter(GPS_FRAME_UBX);
+        framer.state = FRAMER_UBX_LENGTH_1;
+        break;
+    case FRAMER_UBX_LENGTH_1:
+        framer.length = c;
+        framer.state = FRAMER_UBX_LENGTH_2;
+        break;
+    case FRAMER_UBX_LENGTH_2:
+        framer.length |= c << 8;
+        if (framer.length > GPS_FRAMER_UBX_PAYLOAD_MAX) {
+            framerCommit(false);
+            return true;
+        }
+        framer.state = framer.length ? FRAMER_UBX_PAYLOAD : FRAMER_UBX_CHECKSUM_A;
+        break;
+    case FRAMER_UBX_PAYLOAD:
+        if (--framer.length == 0) {
+            framer.state = FRAMER_UBX_CHECKSUM_A;
+        }
+        break;
+    case FRAMER_UBX_CHECKSUM_A:
+        if (c != framer.checksumA) {
+            framerCommit(false);
+            return true;
+        }
+        framer.state = FRAMER_UBX_CHECKSUM_B;
+        break;
+    case FRAMER_UBX_CHECKSUM_B:
+        framerWrite(c);
+        framerCommit(c == framer.checksumB);
+        return true;
+    default:
+        break;
+    }
+    framerWrite(c);
+    return true;
+}
+
+static uint8_t hexValue(uint8_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return 0xff;
+}
+
+static bool framerReceiveNmea(uint8_t c)
+{
+    if (c == NMEA_START_CHAR || (c < ' ' && c != '\r' && c != '\n') || c > '~') {
+        // a sentence never contains these, the frame was cut short; look at the byte again as the start of the next
+        framerCommit(false);
+        return false;
+    }
+    if (++framer.length > GPS_FRAMER_NMEA_LENGTH_MAX) {
+        framerCommit(false);
+        return true;
+    }
+    switch (framer.state) {
+    case FRAMER_NMEA_ADDRESS:
+        framer.checksumA ^= c;
+        if (c == ',') {
+            if (framer.idLength != GPS_FRAMER_NMEA_ADDRESS_LENGTH) {
+                framer.keep = false;
+                stats.discarded++;
+            }
+            framerFilter(GPS_FRAME_NMEA);
+            framer.state = FRAMER_NMEA_DATA;
+        } else if (framer.idLength < GPS_FRAMER_NMEA_ADDRESS_LENGTH) {
+            framer.id[framer.idLength++] = c;
+        } else {
+            // longer than any address the parser knows
+            framer.idLength++;
+        }
+        break;
+    case FRAMER_NMEA_DATA:
+        if (c == '*') {
+            framer.state = FRAMER_NMEA_CHECKSUM_1;
+        } else if (c == '\r' || c == '\n') {
+            framerCommit(false);
+            return true;
+        } else {
+            framer.checksumA ^= c;
+        }
+        break;
+    case FRAMER_NMEA_CHECKSUM_1:
+    case FRAMER_NMEA_CHECKSUM_2: {
+        const uint8_t value = hexValue(c);
+        if (value > 0xf) {
+            framerCommit(false);
+            return true;
+        }
+        framer.receivedChecksum = (framer.receivedChecksum << 4) | value;
+        framer.state++;
+        break;
+    }
+    case FRAMER_NMEA_END:
+        if (c == '\n') {
+            framerWrite(c);
+            framerCommit(framer.receivedChecksum == framer.checksumA);
+            return true;
+        }
+        if (c != '\r') {
+            framerCommit(false);
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    framerWrite(c);
+    return true;
+}
+
+void gpsFramerReceive(uint8_t c)
+{
+    bool handled = false;
+    if (framer.state >= FRAMER_NMEA_ADDRESS) {
+        handled = framerReceiveNmea(c);
+    } else if (framer.state != FRAMER_IDLE) {
+        handled = framerReceiveUbx(c);
+    }
+    if (handled) {
+        return;
+    }
+
+    if (c == UBX_SYNC_CHAR_1) {
+        framerStart(FRAMER_UBX_SYNC_2, c);
+    } else if (c == NMEA_START_CHAR) {
+        framerStart(FRAMER_NMEA_ADDRESS, c);
+    }
+}
+
+bool gpsFramerFrameWaiting(void)
+{
+    return queueTail != queueHead;
+}
+
+bool gpsFramerProcessFrame(gpsFrameHandlerFn handler)
+{
+    const uint16_t tail = queueTail;
+    if (tail == queueHead) {
+        return false;
+    }
+    const uint16_t length = queue[tail & GPS_FRAMER_QUEUE_MASK] | (queue[(tail + 1) & GPS_FRAMER_QUEUE_MASK] << 8);
+    const uint16_t start = (tail + GPS_FRAMER_HEADER_SIZE) & GPS_FRAMER_QUEUE_MASK;
+    const uint16_t count = MIN(length, GPS_FRAMER_QUEUE_SIZE - start);
+    handler(&queue[start], count);
+    if (count < length) {
+        handler(&queue[0], length - count);
+    }
+    queueTail = tail + GPS_FRAMER_HEADER_SIZE + length;
+    return true;
+}
+
+const gpsFramerStats_t *gpsFramerGetStats(void)
+{
+    return &stats;
+}
+
+#endif // USE_GPS
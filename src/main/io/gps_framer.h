@@ -0,0 +1,61 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPS_FRAMER_QUEUE_SIZE           1024    // power of 2, holds a full NAV_SAT message and the nav messages of a solution
+#define GPS_FRAMER_UBX_PAYLOAD_MAX      776     // same sanity limit as the UBX parser
+#define GPS_FRAMER_NMEA_LENGTH_MAX      120     // '$' to '\n', the standard allows 82 but some modules exceed it
+#define GPS_FRAMER_NMEA_ADDRESS_LENGTH  5       // talker and sentence, e.g. GPGGA
+
+typedef enum {
+    GPS_FRAME_UBX = 0,
+    GPS_FRAME_NMEA,
+} gpsFrameType_e;
+
+// Called with the header of each frame, returns false to discard the frame before it is queued.
+// UBX frames pass their class and id, NMEA sentences the characters of their address field.
+typedef bool (*gpsFrameFilterFn)(gpsFrameType_e type, const uint8_t *id);
+
+// Receives the bytes of a queued frame, in two parts when the frame wraps around the end of the queue
+typedef void (*gpsFrameHandlerFn)(const uint8_t *data, uint32_t count);
+
+typedef struct gpsFramerStats_s {
+    uint32_t frames;            // frames queued
+    uint32_t discarded;         // frames rejected by the filter
+    uint32_t dropped;           // valid frames that did not fit in the queue
+    uint32_t errors;            // checksum, length and character errors
+    uint16_t queueMax;          // high water mark of the queue, bytes
+} gpsFramerStats_t;
+
+void gpsFramerInit(gpsFrameFilterFn filter);
+
+// Frames one received byte; called from the serial receive callback, or the GPS task when the port uses RX DMA
+void gpsFramerReceive(uint8_t c);
+
+bool gpsFramerFrameWaiting(void);
+
+// Hands the oldest queued frame to the handler and frees it. Returns false if no frame is queued.
+bool gpsFramerProcessFrame(gpsFrameHandlerFn handler);
+
+const gpsFramerStats_t *gpsFramerGetStats(void);
@@ -30,6 +30,7 @@
 #ifdef USE_LED_STRIP
 
 #include "build/build_config.h"
+#include "build/debug.h"
 
 #include "common/axis.h"
 #include "common/color.h"
@@ -185,6 +186,26 @@ STATIC_UNIT_TESTED int8_t lowestXValueForEast;
 
 STATIC_UNIT_TESTED ledCounts_t ledCounts;
 
+// LEDs using each overlay and base function, compiled from the LED configs by reevaluateLedConfig()
+// so that the layers only visit the LEDs they apply to
+STATIC_UNIT_TESTED ledMask_t overlayLeds[LED_OVERLAY_COUNT];
+STATIC_UNIT_TESTED ledMask_t functionLeds[LED_BASEFUNCTION_COUNT];
+
+STATIC_ASSERT(LED_STRIP_MAX_LENGTH <= sizeof(ledMask_t) * 8, ledMask_too_small);
+
+// Return the index of the lowest LED in the mask and remove it from the mask
+static inline int ledMaskPop(ledMask_t *leds)
+{
+#if LED_STRIP_MAX_LENGTH > 32
+    const int ledIndex = __builtin_ctzll(*leds);
+#else
+    const int ledIndex = __builtin_ctz(*leds);
+#endif
+    *leds &= *leds - 1;
+
+    return ledIndex;
+}
+
 static const modeColorIndexes_t defaultModeColors[] = {
     //                          NORTH             EAST               SOUTH            WEST             UP          DOWN
     [LED_MODE_ORIENTATION] = {{ COLOR_WHITE,      COLOR_DARK_VIOLET, COLOR_RED,       COLOR_DEEP_PINK, COLOR_BLUE, COLOR_ORANGE }},
@@ -311,6 +332,9 @@ STATIC_UNIT_TESTED void updateLedCount(void)
 {
     int count = 0, countRing = 0, countScanner= 0;
 
+    memset(overlayLeds, 0, sizeof(overlayLeds));
+    memset(functionLeds, 0, sizeof(functionLeds));
+
     for (int ledIndex = 0; ledIndex < LED_STRIP_MAX_LENGTH; ledIndex++) {
         const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
 
@@ -319,7 +343,20 @@ STATIC_UNIT_TESTED void updateLedCount(void)
 
         count++;
 
-        if (ledGetFunction(ledConfig) == LED_FUNCTION_THRUST_RING)
+        const ledMask_t ledBit = (ledMask_t)1 << ledIndex;
+
+        const int fn = ledGetFunction(ledConfig);
+        if (fn < LED_BASEFUNCTION_COUNT) {
+            functionLeds[fn] |= ledBit;
+        }
+
+        for (int overlay = 0; overlay < LED_OVERLAY_COUNT; overlay++) {
+            if (ledGetOverlayBit(ledConfig, overlay)) {
+                overlayLeds[overlay] |= ledBit;
+            }
+        }
+
+        if (fn == LED_FUNCTION_THRUST_RING)
             countRing++;
 
         if (ledGetOverlayBit(ledConfig, LED_OVERLAY_LARSON_SCANNER))
@@ -677,12 +714,10 @@ static void applyLedFixedLayers(void)
     }
 }
 
-static void applyLedHsv(uint32_t mask, const hsvColor_t *color)
+static void applyLedHsv(ledMask_t leds, const hsvColor_t *color)
 {
-    for (int ledIndex = 0; ledIndex < ledCounts.count; ledIndex++) {
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
-        if ((*ledConfig & mask) == mask)
-            setLedHsv(ledIndex, color);
+    while (leds) {
+        setLedHsv(ledMaskPop(&leds), color);
     }
 }
 
@@ -750,7 +785,7 @@ static void applyLedWarningLayer(bool updateNow, timeUs_t *timer)
     }
 
     if (warningColor) {
-        applyLedHsv(LED_MOV_OVERLAY(LED_FLAG_OVERLAY(LED_OVERLAY_WARNING)), warningColor);
+        applyLedHsv(overlayLeds[LED_OVERLAY_WARNING], warningColor);
     }
 }
 
@@ -822,26 +857,23 @@ static void applyLedVtxLayer(bool updateNow, timeUs_t *timer)
 
     if (showSettings) { // show settings
         uint8_t vtxLedCount = 0;
-        for (int i = 0; i < ledCounts.count && vtxLedCount < 6; ++i) {
-            const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[i];
-            if (ledGetOverlayBit(ledConfig, LED_OVERLAY_VTX)) {
-                hsvColor_t color = {0, 0, 0};
-                if (vtxLedCount == 0) {
-                    color.h = HSV(GREEN).h;
-                    color.s = HSV(GREEN).s;
-                    color.v = blink ? 15 : 0; // blink received settings
-                } else if (vtxLedCount > 0 && power >= vtxLedCount && !(vtxStatus & VTX_STATUS_PIT_MODE)) { // show power
-                    color.h = HSV(ORANGE).h;
-                    color.s = HSV(ORANGE).s;
-                    color.v = blink ? 15 : 0; // blink received settings
-                } else { // turn rest off
-                    color.h = HSV(BLACK).h;
-                    color.s = HSV(BLACK).s;
-                    color.v = HSV(BLACK).v;
-                }
-                setLedHsv(i, &color);
-                ++vtxLedCount;
+        for (ledMask_t leds = overlayLeds[LED_OVERLAY_VTX]; leds && vtxLedCount < 6; ) {
+            hsvColor_t color = {0, 0, 0};
+            if (vtxLedCount == 0) {
+                color.h = HSV(GREEN).h;
+                color.s = HSV(GREEN).s;
+                color.v = blink ? 15 : 0; // blink received settings
+            } else if (vtxLedCount > 0 && power >= vtxLedCount && !(vtxStatus & VTX_STATUS_PIT_MODE)) { // show power
+                color.h = HSV(ORANGE).h;
+                color.s = HSV(ORANGE).s;
+                color.v = blink ? 15 : 0; // blink received settings
+            } else { // turn rest off
+                color.h = HSV(BLACK).h;
+                color.s = HSV(BLACK).s;
+                color.v = HSV(BLACK).v;
             }
+            setLedHsv(ledMaskPop(&leds), &color);
+            ++vtxLedCount;
         }
     }
     else { // show frequency
@@ -849,7 +881,7 @@ static void applyLedVtxLayer(bool updateNow, timeUs_t *timer)
         uint8_t const colorIndex = getColorByVtxFrequency(frequency);
         hsvColor_t color = ledStripStatusModeConfig()->colors[colorIndex];
         color.v = (vtxStatus & VTX_STATUS_PIT_MODE) ? (blink ? 15 : 0) : 255; // blink when in pit mode
-        applyLedHsv(LED_MOV_OVERLAY(LED_FLAG_OVERLAY(LED_OVERLAY_VTX)), &color);
+        applyLedHsv(overlayLeds[LED_OVERLAY_VTX], &color);
     }
 }
 #endif
@@ -884,7 +916,7 @@ static void applyLedBatteryLayer(bool updateNow, timeUs_t *timer)
 
     if (!flash) {
        const hsvColor_t *bgc = getSC(LED_SCOLOR_BACKGROUND);
-       applyLedHsv(LED_MOV_FUNCTION(LED_FUNCTION_BATTERY), bgc);
+       applyLedHsv(functionLeds[LED_FUNCTION_BATTERY], bgc);
     }
 }
 
@@ -913,7 +945,7 @@ static void applyLedRssiLayer(bool updateNow, timeUs_t *timer)
 
     if (!flash) {
         const hsvColor_t *bgc = getSC(LED_SCOLOR_BACKGROUND);
-        applyLedHsv(LED_MOV_FUNCTION(LED_FUNCTION_RSSI), bgc);
+        applyLedHsv(functionLeds[LED_FUNCTION_RSSI], bgc);
     }
 }
 
@@ -951,7 +983,7 @@ static void applyLedGpsLayer(bool updateNow, timeUs_t *timer)
         }
     }
 
-    applyLedHsv(LED_MOV_FUNCTION(LED_FUNCTION_GPS), gpsColor);
+    applyLedHsv(functionLeds[LED_FUNCTION_GPS], gpsColor);
 }
 #endif
 
@@ -991,12 +1023,10 @@ static void applyLedIndicatorLayer(bool updateNow, timeUs_t *timer)
         quadrants |= QUADRANT_SOUTH;
     }
 
-    for (int ledIndex = 0; ledIndex < ledCounts.count; ledIndex++) {
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
-        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_INDICATOR)) {
-            if (getLedQuadrant(ledIndex) & quadrants)
-                setLedHsv(ledIndex, flashColor);
-        }
+    for (ledMask_t leds = overlayLeds[LED_OVERLAY_INDICATOR]; leds; ) {
+        const int ledIndex = ledMaskPop(&leds);
+        if (getLedQuadrant(ledIndex) & quadrants)
+            setLedHsv(ledIndex, flashColor);
     }
 }
 
@@ -1012,24 +1042,23 @@ static void applyLedThrustRingLayer(bool updateNow, timeUs_t *timer)
         *timer += HZ_TO_US(5 + (45 * scaledThrottle) / 100);  // 5 - 50Hz update rate
     }
 
-    for (int ledIndex = 0; ledIndex < ledCounts.count; ledIndex++) {
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
-        if (ledGetFunction(ledConfig) == LED_FUNCTION_THRUST_RING) {
-
-            bool applyColor;
-            if (ARMING_FLAG(ARMED)) {
-                applyColor = (ledRingIndex + rotationPhase) % ledCounts.ringSeqLen < ROTATION_SEQUENCE_LED_WIDTH;
-            } else {
-                applyColor = !(ledRingIndex % 2); // alternating pattern
-            }
+    for (ledMask_t leds = functionLeds[LED_FUNCTION_THRUST_RING]; leds; ) {
+        const int ledIndex = ledMaskPop(&leds);
 
-            if (applyColor) {
-                const hsvColor_t *ringColor = &ledStripStatusModeConfig()->colors[ledGetColor(ledConfig)];
-                setLedHsv(ledIndex, ringColor);
-            }
+        bool applyColor;
+        if (ARMING_FLAG(ARMED)) {
+            applyColor = (ledRingIndex + rotationPhase) % ledCounts.ringSeqLen < ROTATION_SEQUENCE_LED_WIDTH;
+        } else {
+            applyColor = !(ledRingIndex % 2); // alternating pattern
+        }
 
-            ledRingIndex++;
+        if (applyColor) {
+            const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
+            const hsvColor_t *ringColor = &ledStripStatusModeConfig()->colors[ledGetColor(ledConfig)];
+            setLedHsv(ledIndex, ringColor);
         }
+
+        ledRingIndex++;
     }
 }
 
@@ -1044,16 +1073,13 @@ static void applyRainbowLayer(bool updateNow, timeUs_t *timer)
     }
     uint8_t rainbowLedIndex = 0;
 
-    for (unsigned i = 0; i < ledCounts.count; i++) {
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[i];
-        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_RAINBOW)) {
-            hsvColor_t ledColor;
-            ledColor.h = (offset / LED_OVERLAY_RAINBOW_RATE_HZ + rainbowLedIndex * ledStripConfig()->ledstrip_rainbow_delta) % (HSV_HUE_MAX + 1);
-            ledColor.s = 0;
-            ledColor.v = HSV_VALUE_MAX;
-            setLedHsv(i, &ledColor);
-            rainbowLedIndex++;
-        }
+    for (ledMask_t leds = overlayLeds[LED_OVERLAY_RAINBOW]; leds; ) {
+        hsvColor_t ledColor;
+        ledColor.h = (offset / LED_OVERLAY_RAINBOW_RATE_HZ + rainbowLedIndex * ledStripConfig()->ledstrip_rainbow_delta) % (HSV_HUE_MAX + 1);
+        ledColor.s = 0;
+        ledColor.v = HSV_VALUE_MAX;
+        setLedHsv(ledMaskPop(&leds), &ledColor);
+        rainbowLedIndex++;
     }
 }
 
@@ -1105,17 +1131,13 @@ static void applyLarsonScannerLayer(bool updateNow, timeUs_t *timer)
     }
 
     int scannerLedIndex = 0;
-    for (unsigned i = 0; i < ledCounts.count; i++) {
-
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[i];
-
-        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_LARSON_SCANNER)) {
-            hsvColor_t ledColor;
-            getLedHsv(i, &ledColor);
-            ledColor.v = brightnessForLarsonIndex(&larsonParameters, scannerLedIndex);
-            setLedHsv(i, &ledColor);
-            scannerLedIndex++;
-        }
+    for (ledMask_t leds = overlayLeds[LED_OVERLAY_LARSON_SCANNER]; leds; ) {
+        const int ledIndex = ledMaskPop(&leds);
+        hsvColor_t ledColor;
+        getLedHsv(ledIndex, &ledColor);
+        ledColor.v = brightnessForLarsonIndex(&larsonParameters, scannerLedIndex);
+        setLedHsv(ledIndex, &ledColor);
+        scannerLedIndex++;
     }
 }
 
@@ -1135,13 +1157,7 @@ static void applyLedBlinkLayer(bool updateNow, timeUs_t *timer)
 
     bool ledOn = (blinkMask & 1);  // b_b_____...
     if (!ledOn) {
-        for (int i = 0; i < ledCounts.count; ++i) {
-            const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[i];
-
-            if (ledGetOverlayBit(ledConfig, LED_OVERLAY_BLINK)) {
-                setLedHsv(i, getSC(LED_SCOLOR_BLINKBACKGROUND));
-            }
-        }
+        applyLedHsv(overlayLeds[LED_OVERLAY_BLINK], getSC(LED_SCOLOR_BLINKBACKGROUND));
     }
 }
 
@@ -1195,13 +1211,7 @@ static applyLayerFn_timed* layerTable[] = {
 
 static bool isOverlayTypeUsed(ledOverlayId_e overlayType)
 {
-    for (int ledIndex = 0; ledIndex < ledCounts.count; ledIndex++) {
-        const ledConfig_t *ledConfig = &ledStripStatusModeConfig()->ledConfigs[ledIndex];
-        if (ledGetOverlayBit(ledConfig, overlayType)) {
-            return true;
-        }
-    }
-    return false;
+    return overlayLeds[overlayType] != 0;
 }
 
 void updateRequiredOverlay(void)
@@ -1474,6 +1484,7 @@ void ledStripUpdate(timeUs_t currentTimeUs)
     static uint16_t ledStateDurationFractionUs[2] = { 0 };
     static bool applyProfile = true;
     static timeUs_t updateStartTimeUs = 0;
+    static timeDelta_t updateCostUs = 0;
     bool ledCurrentState = applyProfile;
 
     if (updateStartTimeUs != 0) {
@@ -1525,6 +1536,12 @@ void ledStripUpdate(timeUs_t currentTimeUs)
                 // Reschedule waiting for a timer to trigger a LED state change
                 rescheduleTask(TASK_SELF, TASK_PERIOD_HZ(TASK_LEDSTRIP_RATE_WAIT_HZ));
             } else {
+                if (debugMode == DEBUG_LED_STRIP) {
+                    const timeDelta_t layerUs = cmpTimeUs(micros(), currentTimeUs);
+                    DEBUG_SET(DEBUG_LED_STRIP, DEBUG_LED_STRIP_LAYER_US, layerUs);
+                    updateCostUs += layerUs;
+                }
+
                 static bool multipassProfile = false;
                 if (ledProfileSequence == LED_PROFILE_ADVANCE) {
                     // The state leading to advancing from applying the profile layers to updating the DMA buffer is always short
@@ -1543,7 +1560,19 @@ void ledStripUpdate(timeUs_t currentTimeUs)
         } else {
             static bool multipassUpdate = false;
             // Profile is applied, so now update the LEDs
-            if (ws2811UpdateStrip((ledStripFormatRGB_e) ledStripConfig()->ledstrip_grb_rgb, ledStripConfig()->ledstrip_brightness)) {
+            const bool updated = ws2811UpdateStrip((ledStripFormatRGB_e) ledStripConfig()->ledstrip_grb_rgb, ledStripConfig()->ledstrip_brightness);
+
+            if (debugMode == DEBUG_LED_STRIP) {
+                const timeDelta_t encodeUs = cmpTimeUs(micros(), currentTimeUs);
+                DEBUG_SET(DEBUG_LED_STRIP, DEBUG_LED_STRIP_ENCODE_US, encodeUs);
+                updateCostUs += encodeUs;
+                if (updated) {
+                    DEBUG_SET(DEBUG_LED_STRIP, DEBUG_LED_STRIP_UPDATE_US, updateCostUs);
+                    updateCostUs = 0;
+                }
+            }
+
+            if (updated) {
                 // Final pass updating the DMA buffer is always short
                 if (multipassUpdate) {
                     schedulerIgnoreTaskExecTime();
@@ -37,6 +37,12 @@
 #define LED_OVERLAY_COUNT               7
 #define LED_SPECIAL_COLOR_COUNT        11
 
+// DEBUG_LED_STRIP
+#define DEBUG_LED_STRIP_LAYER_US        0 // Time taken by the last pass applying the profile layers
+#define DEBUG_LED_STRIP_ENCODE_US       1 // Time taken by the last pass filling the DMA buffer
+#define DEBUG_LED_STRIP_ENCODED         2 // LEDs re-encoded by the last completed DMA buffer update
+#define DEBUG_LED_STRIP_UPDATE_US       3 // Total time taken by all passes of the last completed update
+
 #define LED_POS_OFFSET                  0
 #define LED_FUNCTION_OFFSET             8
 #define LED_OVERLAY_OFFSET             12
@@ -171,6 +177,13 @@ typedef struct ledCounts_s {
     uint8_t ringSeqLen;
 } ledCounts_t;
 
+// One bit per LED on the strip
+#if LED_STRIP_MAX_LENGTH > 32
+typedef uint64_t ledMask_t;
+#else
+typedef uint32_t ledMask_t;
+#endif
+
 typedef struct ledStripConfig_s {
     uint8_t ledstrip_visual_beeper;
     ioTag_t ioTag;
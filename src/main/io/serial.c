@@ -547,6 +547,7 @@ serialPort_t *openSerialPort(
     }
 
     serialPort->identifier = identifier; // Some versions of *Open() set this member sooner
+    serialResetStats(serialPort);
 
     serialPortUsage->function = function;
     serialPortUsage->serialPort = serialPort;
@@ -567,6 +568,8 @@ void closeSerialPort(serialPort_t *serialPort)
 
     // TODO wait until data has been transmitted.
     serialPort->rxCallback = NULL;
+    // the idle line interrupt is turned off when the port is opened again
+    serialPort->idleCallback = NULL;
 
     serialPortUsage->function = FUNCTION_NONE;
     serialPortUsage->serialPort = NULL;
@@ -94,6 +94,7 @@
 
 #include "io/asyncfatfs/asyncfatfs.h"
 #include "io/beeper.h"
+#include "io/displayport_msp.h"
 #include "io/flashfs.h"
 #include "io/gimbal.h"
 #include "io/gps.h"
@@ -147,6 +148,7 @@
 #include "sensors/battery.h"
 #include "sensors/boardalignment.h"
 #include "sensors/compass.h"
+#include "sensors/esc_state.h"
 #include "sensors/gyro.h"
 #include "sensors/gyro_init.h"
 #include "sensors/rangefinder.h"
@@ -1211,55 +1213,29 @@ case MSP_NAME:
             uint16_t escCurrent = 0;     // 0.01A per unit
             uint16_t escConsumption = 0; // mAh
 
-            bool rpmDataAvailable = false;
-
-#ifdef USE_DSHOT_TELEMETRY
-            if (useDshotTelemetry) {
-                rpm = lrintf(getDshotRpm(i));
-                rpmDataAvailable = true;
-                invalidPct = 10000; // 100.00%
-
-#ifdef USE_DSHOT_TELEMETRY_STATS
-                if (isDshotMotorTelemetryActive(i)) {
-                    invalidPct = getDshotTelemetryMotorInvalidPercent(i);
-                }
-#endif
-
-                // Provide extended dshot telemetry
-                if ((dshotTelemetryState.motorState[i].telemetryTypes & DSHOT_EXTENDED_TELEMETRY_MASK) != 0) {
-                    // Temperature Celsius [0, 1, ..., 255] in degree Celsius, just like Blheli_32 and KISS
-                    if ((dshotTelemetryState.motorState[i].telemetryTypes & (1 << DSHOT_TELEMETRY_TYPE_TEMPERATURE)) != 0) {
-                        escTemperature = dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_TEMPERATURE];
-                    }
-
-                    // Current -> 0-255A step 1A
-                    if ((dshotTelemetryState.motorState[i].telemetryTypes & (1 << DSHOT_TELEMETRY_TYPE_CURRENT)) != 0) {
-                        escCurrent = dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_CURRENT];
-                    }
-
-                    // Voltage -> 0-63,75V step 0,25V
-                    if ((dshotTelemetryState.motorState[i].telemetryTypes & (1 << DSHOT_TELEMETRY_TYPE_VOLTAGE)) != 0) {
-                        escVoltage = dshotTelemetryState.motorState[i].telemetryData[DSHOT_TELEMETRY_TYPE_VOLTAGE] >> 2;
-                    }
-                }
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
+            // DShot and the serial ESC sensor fill the same fields, in these units
+            escState_t escState;
+            const bool escStateValid = escStateRead(i, &escState);
+            if (escStateValid) {
+                rpm = lrintf(erpmToRpm(escState.data[ESC_STATE_ERPM]));
+                escTemperature = escState.data[ESC_STATE_TEMPERATURE];
+                escVoltage = escState.data[ESC_STATE_VOLTAGE];
+                escCurrent = escState.data[ESC_STATE_CURRENT];
+                escConsumption = escState.data[ESC_STATE_CONSUMPTION];
             }
 #endif
 
-#ifdef USE_ESC_SENSOR
-            if (featureIsEnabled(FEATURE_ESC_SENSOR)) {
-                escSensorData_t *escData = getEscSensorData(i);
-                if (!rpmDataAvailable) {  // We want DSHOT telemetry RPM data (if available) to have precedence
-                    rpm = lrintf(erpmToRpm(escData->rpm));
-                    rpmDataAvailable = true;
+#ifdef USE_DSHOT_TELEMETRY
+            if (useDshotTelemetry) {
+                invalidPct = 10000; // 100.00%, until the rate of an active motor is known
+                if (escStateValid && escStateHasField(&escState, ESC_STATE_ERROR_RATE)) {
+                    invalidPct = escState.data[ESC_STATE_ERROR_RATE];
                 }
-                escTemperature = escData->temperature;
-                escVoltage = escData->voltage;
-                escCurrent = escData->current;
-                escConsumption = escData->consumption;
             }
 #endif
 
-            sbufWriteU32(dst, (rpmDataAvailable ? rpm : 0));
+            sbufWriteU32(dst, rpm);
             sbufWriteU16(dst, invalidPct);
             sbufWriteU8(dst, escTemperature);
             sbufWriteU16(dst, escVoltage);
@@ -1704,6 +1680,38 @@ case MSP_NAME:
         break;
     }
 
+#ifdef USE_SERIAL_STATS
+    case MSP2_SERIAL_STATS: {
+        uint8_t count = 0;
+        for (int i = 0; i < SERIAL_PORT_COUNT; i++) {
+            const serialPortUsage_t *usage = findSerialPortUsageByIdentifier(serialPortIdentifiers[i]);
+            if (usage && usage->serialPort) {
+                count++;
+            }
+        }
+        sbufWriteU8(dst, count);
+        for (int i = 0; i < SERIAL_PORT_COUNT; i++) {
+            const serialPortUsage_t *usage = findSerialPortUsageByIdentifier(serialPortIdentifiers[i]);
+            if (!usage || !usage->serialPort) {
+                continue;
+            }
+            const serialPort_t *port = usage->serialPort;
+            sbufWriteU8(dst, usage->identifier);
+            sbufWriteU32(dst, port->baudRate);
+            sbufWriteU32(dst, port->stats.rxBytes);
+            sbufWriteU32(dst, port->stats.txBytes);
+            sbufWriteU16(dst, port->stats.rxOverruns);
+            sbufWriteU16(dst, port->stats.txStalls);
+            sbufWriteU16(dst, port->stats.rxHighWater);
+            sbufWriteU16(dst, port->rxBufferSize);
+            sbufWriteU16(dst, port->stats.txHighWater);
+            sbufWriteU16(dst, port->txBufferSize);
+            sbufWriteU32(dst, port->stats.rxLatencyMaxUs);
+        }
+        break;
+    }
+#endif
+
 #ifdef USE_LED_STRIP_STATUS_MODE
     case MSP_LED_COLORS:
         for (int i = 0; i < LED_CONFIGURABLE_COLOR_COUNT; i++) {
@@ -4473,6 +4481,12 @@ static mspResult_e mspCommonProcessInCommand(mspDescriptor_t srcDesc, int16_t cm
         }
         break;
 #endif //USE_OSD_HD
+
+#ifdef USE_MSP_DISPLAYPORT
+    case MSP2_SET_DISPLAYPORT_CAPS:
+        displayPortMspSetCapabilities(sbufReadU8(src));
+        break;
+#endif
 #endif // OSD
 
     default:
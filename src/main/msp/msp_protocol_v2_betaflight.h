@@ -31,6 +31,8 @@
 #define MSP2_SENSOR_CONFIG_ACTIVE           0x300A
 #define MSP2_SENSOR_OPTICALFLOW             0x300B
 #define MSP2_MCU_INFO                       0x300C
+#define MSP2_SET_DISPLAYPORT_CAPS           0x300D  // VTX advertises the displayport extensions it supports
+#define MSP2_SERIAL_STATS                   0x300E  // traffic counters of the open serial ports
 
 // MSP2_SET_TEXT and MSP2_GET_TEXT variable types
 #define MSP2TEXT_PILOT_NAME                      1
@@ -1329,28 +1329,10 @@ static void osdProcessStats3(void)
 #endif
 }
 
-typedef enum {
-    OSD_STATE_INIT,
-    OSD_STATE_IDLE,
-    OSD_STATE_CHECK,
-    OSD_STATE_PROCESS_STATS1,
-    OSD_STATE_REFRESH_STATS,
-    OSD_STATE_PROCESS_STATS2,
-    OSD_STATE_PROCESS_STATS3,
-    OSD_STATE_UPDATE_ALARMS,
-    OSD_STATE_REFRESH_PREARM,
-    OSD_STATE_UPDATE_CANVAS,
-    // Elements are handled in two steps, drawing into a buffer, and then sending to the display
-    OSD_STATE_DRAW_ELEMENT,
-    OSD_STATE_DISPLAY_ELEMENT,
-    OSD_STATE_UPDATE_HEARTBEAT,
-    OSD_STATE_COMMIT,
-    OSD_STATE_TRANSFER,
-    OSD_STATE_COUNT
-} osdState_e;
-
 osdState_e osdState = OSD_STATE_INIT;
 
+static uint16_t osdStateDurationFractionUs[OSD_STATE_COUNT] = { 0 };
+
 #define OSD_UPDATE_INTERVAL_US (1000000 / osdConfig()->framerate_hz)
 
 // Called periodically by the scheduler
@@ -1376,13 +1358,14 @@ bool osdUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
         }
     }
 
-    return (osdState != OSD_STATE_IDLE);
+    // A buffered display continues sending the last frame while the OSD is otherwise idle,
+    // once the link has room for more of it
+    return (osdState != OSD_STATE_IDLE) || displayIsDrawReady(osdDisplayPort);
 }
 
 // Called when there is OSD update work to be done
 void osdUpdate(timeUs_t currentTimeUs)
 {
-    static uint16_t osdStateDurationFractionUs[OSD_STATE_COUNT] = { 0 };
     static uint32_t osdElementDurationFractionUs[OSD_ITEM_COUNT] = { 0 };
     static bool moreElementsToDraw;
 
@@ -1507,6 +1490,7 @@ void osdUpdate(timeUs_t currentTimeUs)
 #endif // USE_GPS
 
         osdSyncBlink(currentTimeUs);
+        osdSyncElementCache(currentTimeUs);
 
         osdState = OSD_STATE_DRAW_ELEMENT;
 
@@ -1601,8 +1585,9 @@ void osdUpdate(timeUs_t currentTimeUs)
             break;
         }
 
-        // Transfer may be broken into many parts
-        if (displayDrawScreen(osdDisplayPort)) {
+        // Transfer may be broken into many parts. The rest of the frame of a buffered display
+        // is sent from the idle state, so drawing the next frame isn't held up by the link.
+        if (displayDrawScreen(osdDisplayPort) && !displayIsBuffered(osdDisplayPort)) {
             break;
         }
 
@@ -1612,6 +1597,10 @@ void osdUpdate(timeUs_t currentTimeUs)
 
     case OSD_STATE_IDLE:
     default:
+        if (displayIsDrawPending(osdDisplayPort)) {
+            displayDrawScreen(osdDisplayPort);
+        }
+
         osdState = OSD_STATE_IDLE;
         break;
     }
@@ -1628,7 +1617,8 @@ void osdUpdate(timeUs_t currentTimeUs)
     }
 
     if (osdState == OSD_STATE_IDLE) {
-        schedulerSetNextStateTime((osdStateDurationFractionUs[OSD_STATE_CHECK] >> OSD_EXEC_TIME_SHIFT));
+        const osdState_e nextState = displayIsDrawPending(osdDisplayPort) ? OSD_STATE_IDLE : OSD_STATE_CHECK;
+        schedulerSetNextStateTime((osdStateDurationFractionUs[nextState] >> OSD_EXEC_TIME_SHIFT));
     } else if (osdState == OSD_STATE_DRAW_ELEMENT) {
         schedulerSetNextStateTime((osdElementDurationFractionUs[osdGetActiveElement()] >> OSD_EXEC_TIME_SHIFT) + OSD_ELEMENT_MARGIN);
     } else {
@@ -1636,6 +1626,12 @@ void osdUpdate(timeUs_t currentTimeUs)
     }
 }
 
+// Current estimate of the worst case duration of each state, as used to schedule osdUpdate()
+timeDelta_t osdGetStateDurationUs(osdState_e state)
+{
+    return osdStateDurationFractionUs[state] >> OSD_EXEC_TIME_SHIFT;
+}
+
 void osdSuppressStats(bool flag)
 {
     suppressStatsDisplay = flag;
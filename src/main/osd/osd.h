@@ -300,6 +300,26 @@ typedef enum {
     OSD_DISPLAYPORT_DEVICE_FRSKYOSD,
 } osdDisplayPortDevice_e;
 
+typedef enum {
+    OSD_STATE_INIT,
+    OSD_STATE_IDLE,
+    OSD_STATE_CHECK,
+    OSD_STATE_PROCESS_STATS1,
+    OSD_STATE_REFRESH_STATS,
+    OSD_STATE_PROCESS_STATS2,
+    OSD_STATE_PROCESS_STATS3,
+    OSD_STATE_UPDATE_ALARMS,
+    OSD_STATE_REFRESH_PREARM,
+    OSD_STATE_UPDATE_CANVAS,
+    // Elements are handled in two steps, drawing into a buffer, and then sending to the display
+    OSD_STATE_DRAW_ELEMENT,
+    OSD_STATE_DISPLAY_ELEMENT,
+    OSD_STATE_UPDATE_HEARTBEAT,
+    OSD_STATE_COMMIT,
+    OSD_STATE_TRANSFER,
+    OSD_STATE_COUNT
+} osdState_e;
+
 // Make sure the number of warnings do not exceed the available 32bit storage
 STATIC_ASSERT(OSD_WARNING_COUNT <= 32, osdwarnings_overflow);
 
@@ -391,6 +411,7 @@ typedef struct statistic_s {
     int16_t min_rsnr;
 } statistic_t;
 
+extern osdState_e osdState;
 extern timeUs_t resumeRefreshAt;
 extern timeUs_t osdFlyTime;
 extern timeUs_t osdLaunchTime;
@@ -406,6 +427,7 @@ extern uint16_t osdAuxValue;
 void osdInit(displayPort_t *osdDisplayPort, osdDisplayPortDevice_e displayPortDevice);
 bool osdUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 void osdUpdate(timeUs_t currentTimeUs);
+timeDelta_t osdGetStateDurationUs(osdState_e state);
 
 void osdStatSetState(uint8_t statIndex, bool enabled);
 bool osdStatGetState(uint8_t statIndex);
@@ -0,0 +1,170 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The OSD elements compiled into the firmware. This file has no include guard, it is included
+// by osd_elements.c once for each table generated from it with OSD_ELEMENT() defined to
+// extract the required fields. Elements that are compiled out take no space in any table.
+//
+// OSD_ELEMENT(item, draw function, background function, data source)
+//
+// The draw function renders the dynamic part of the element and the background function the
+// static part, either may be NULL. The data source names the entry in osdElementSource[] the
+// element's output is derived from, or NONE to format it on every refresh.
+
+OSD_ELEMENT(OSD_CAMERA_FRAME,            NULL,                            osdBackgroundCameraFrame,      NONE)  // only has background. Added first so it's the lowest "layer" and doesn't cover other elements
+OSD_ELEMENT(OSD_RSSI_VALUE,              osdElementRssi,                  NULL,                          RSSI_VALUE)
+OSD_ELEMENT(OSD_MAIN_BATT_VOLTAGE,       osdElementMainBatteryVoltage,    NULL,                          MAIN_BATT_VOLTAGE)
+OSD_ELEMENT(OSD_CROSSHAIRS,              osdElementCrosshairs,            NULL,                          NONE)  // only has background, but needs to be over other elements (like artificial horizon)
+#ifdef USE_ACC
+OSD_ELEMENT(OSD_ARTIFICIAL_HORIZON,      osdElementArtificialHorizon,     NULL,                          NONE)
+OSD_ELEMENT(OSD_UP_DOWN_REFERENCE,       osdElementUpDownReference,       NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_HORIZON_SIDEBARS,        NULL,                            osdBackgroundHorizonSidebars,  NONE)  // only has background
+OSD_ELEMENT(OSD_ITEM_TIMER_1,            osdElementTimer,                 NULL,                          NONE)
+OSD_ELEMENT(OSD_ITEM_TIMER_2,            osdElementTimer,                 NULL,                          NONE)
+OSD_ELEMENT(OSD_FLYMODE,                 osdElementFlymode,               NULL,                          NONE)
+OSD_ELEMENT(OSD_CRAFT_NAME,              NULL,                            osdBackgroundCraftName,        NONE)  // only has background
+OSD_ELEMENT(OSD_CUSTOM_MSG0,             osdElementCustomMsg,             NULL,                          NONE)
+OSD_ELEMENT(OSD_CUSTOM_MSG1,             osdElementCustomMsg,             NULL,                          NONE)
+OSD_ELEMENT(OSD_CUSTOM_MSG2,             osdElementCustomMsg,             NULL,                          NONE)
+OSD_ELEMENT(OSD_CUSTOM_MSG3,             osdElementCustomMsg,             NULL,                          NONE)
+OSD_ELEMENT(OSD_THROTTLE_POS,            osdElementThrottlePosition,      NULL,                          THROTTLE_POS)
+#ifdef USE_VTX_COMMON
+OSD_ELEMENT(OSD_VTX_CHANNEL,             osdElementVtxChannel,            NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_CURRENT_DRAW,            osdElementCurrentDraw,           NULL,                          CURRENT_DRAW)
+OSD_ELEMENT(OSD_MAH_DRAWN,               osdElementMahDrawn,              NULL,                          MAH_DRAWN)
+OSD_ELEMENT(OSD_WATT_HOURS_DRAWN,        osdElementWattHoursDrawn,        NULL,                          NONE)
+#ifdef USE_GPS
+OSD_ELEMENT(OSD_GPS_SPEED,               osdElementGpsSpeed,              NULL,                          NONE)
+OSD_ELEMENT(OSD_GPS_SATS,                osdElementGpsSats,               NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_ALTITUDE,                osdElementAltitude,              NULL,                          ALTITUDE)
+OSD_ELEMENT(OSD_ROLL_PIDS,               osdElementPidsRoll,              NULL,                          NONE)
+OSD_ELEMENT(OSD_PITCH_PIDS,              osdElementPidsPitch,             NULL,                          NONE)
+OSD_ELEMENT(OSD_YAW_PIDS,                osdElementPidsYaw,               NULL,                          NONE)
+OSD_ELEMENT(OSD_POWER,                   osdElementPower,                 NULL,                          NONE)
+OSD_ELEMENT(OSD_PIDRATE_PROFILE,         osdElementPidRateProfile,        NULL,                          PIDRATE_PROFILE)
+OSD_ELEMENT(OSD_WARNINGS,                osdElementWarnings,              NULL,                          NONE)
+OSD_ELEMENT(OSD_AVG_CELL_VOLTAGE,        osdElementAverageCellVoltage,    NULL,                          AVG_CELL_VOLTAGE)
+OSD_ELEMENT(OSD_READY_MODE,              osdElementReadyMode,             NULL,                          NONE)
+#ifdef USE_GPS
+OSD_ELEMENT(OSD_GPS_LON,                 osdElementGpsCoordinate,         NULL,                          NONE)
+OSD_ELEMENT(OSD_GPS_LAT,                 osdElementGpsCoordinate,         NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_DEBUG,                   osdElementDebug,                 NULL,                          NONE)
+OSD_ELEMENT(OSD_DEBUG2,                  osdElementDebug2,                NULL,                          NONE)
+#ifdef USE_ACC
+OSD_ELEMENT(OSD_PITCH_ANGLE,             osdElementAngleRollPitch,        NULL,                          NONE)
+OSD_ELEMENT(OSD_ROLL_ANGLE,              osdElementAngleRollPitch,        NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_MAIN_BATT_USAGE,         osdElementMainBatteryUsage,      NULL,                          NONE)
+OSD_ELEMENT(OSD_DISARMED,                osdElementDisarmed,              NULL,                          DISARMED)
+#ifdef USE_GPS
+OSD_ELEMENT(OSD_HOME_DIR,                osdElementGpsHomeDirection,      NULL,                          NONE)
+OSD_ELEMENT(OSD_HOME_DIST,               osdElementGpsHomeDistance,       NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_NUMERICAL_HEADING,       osdElementNumericalHeading,      NULL,                          NUMERICAL_HEADING)
+#ifdef USE_VARIO
+OSD_ELEMENT(OSD_NUMERICAL_VARIO,         osdElementNumericalVario,        NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_COMPASS_BAR,             osdElementCompassBar,            NULL,                          NONE)
+#if defined(USE_DSHOT_TELEMETRY) || defined(USE_ESC_SENSOR)
+OSD_ELEMENT(OSD_ESC_TMP,                 osdElementEscTemperature,        NULL,                          ESC_TMP)
+OSD_ELEMENT(OSD_ESC_RPM,                 osdElementEscRpm,                NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_REMAINING_TIME_ESTIMATE, osdElementRemainingTimeEstimate, NULL,                          NONE)
+#ifdef USE_RTC_TIME
+OSD_ELEMENT(OSD_RTC_DATETIME,            osdElementRtcTime,               NULL,                          NONE)
+#endif
+#ifdef USE_OSD_ADJUSTMENTS
+OSD_ELEMENT(OSD_ADJUSTMENT_RANGE,        osdElementAdjustmentRange,       NULL,                          NONE)
+#endif
+#ifdef USE_ADC_INTERNAL
+OSD_ELEMENT(OSD_CORE_TEMPERATURE,        osdElementCoreTemperature,       NULL,                          CORE_TEMPERATURE)
+#endif
+OSD_ELEMENT(OSD_ANTI_GRAVITY,            osdElementAntiGravity,           NULL,                          NONE)
+#ifdef USE_ACC
+OSD_ELEMENT(OSD_G_FORCE,                 osdElementGForce,                NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_MOTOR_DIAG,              osdElementMotorDiagnostics,      NULL,                          NONE)
+#ifdef USE_BLACKBOX
+OSD_ELEMENT(OSD_LOG_STATUS,              osdElementLogStatus,             NULL,                          NONE)
+#endif
+#ifdef USE_ACC
+OSD_ELEMENT(OSD_FLIP_ARROW,              osdElementCrashFlipArrow,        NULL,                          NONE)
+#endif
+#ifdef USE_RX_LINK_QUALITY_INFO
+OSD_ELEMENT(OSD_LINK_QUALITY,            osdElementLinkQuality,           NULL,                          LINK_QUALITY)
+#endif
+#ifdef USE_RX_LINK_UPLINK_POWER
+OSD_ELEMENT(OSD_TX_UPLINK_POWER,         osdElementTxUplinkPower,         NULL,                          NONE)
+#endif
+#ifdef USE_GPS
+OSD_ELEMENT(OSD_FLIGHT_DIST,             osdElementGpsFlightDistance,     NULL,                          NONE)
+#endif
+#ifdef USE_OSD_STICK_OVERLAY
+OSD_ELEMENT(OSD_STICK_OVERLAY_LEFT,      osdElementStickOverlay,          osdBackgroundStickOverlay,     NONE)
+OSD_ELEMENT(OSD_STICK_OVERLAY_RIGHT,     osdElementStickOverlay,          osdBackgroundStickOverlay,     NONE)
+#endif
+OSD_ELEMENT(OSD_PILOT_NAME,              NULL,                            osdBackgroundPilotName,        NONE)  // only has background
+#if defined(USE_DSHOT_TELEMETRY) || defined(USE_ESC_SENSOR)
+OSD_ELEMENT(OSD_ESC_RPM_FREQ,            osdElementEscRpmFreq,            NULL,                          NONE)
+#endif
+#ifdef USE_PROFILE_NAMES
+OSD_ELEMENT(OSD_RATE_PROFILE_NAME,       osdElementRateProfileName,       NULL,                          NONE)
+OSD_ELEMENT(OSD_PID_PROFILE_NAME,        osdElementPidProfileName,        NULL,                          NONE)
+#endif
+#ifdef USE_OSD_PROFILES
+OSD_ELEMENT(OSD_PROFILE_NAME,            osdElementOsdProfileName,        NULL,                          NONE)
+#endif
+#ifdef USE_RX_RSSI_DBM
+OSD_ELEMENT(OSD_RSSI_DBM_VALUE,          osdElementRssiDbm,               NULL,                          RSSI_DBM_VALUE)
+#endif
+#ifdef USE_RX_RSNR
+OSD_ELEMENT(OSD_RSNR_VALUE,              osdElementRsnr,                  NULL,                          NONE)
+#endif
+OSD_ELEMENT(OSD_RC_CHANNELS,             osdElementRcChannels,            NULL,                          NONE)
+#ifdef USE_GPS
+OSD_ELEMENT(OSD_EFFICIENCY,              osdElementEfficiency,            NULL,                          NONE)
+#endif
+#ifdef USE_GPS_LAP_TIMER
+OSD_ELEMENT(OSD_GPS_LAP_TIME_CURRENT,    osdElementGpsLapTimeCurrent,     NULL,                          NONE)
+OSD_ELEMENT(OSD_GPS_LAP_TIME_PREVIOUS,   osdElementGpsLapTimePrevious,    NULL,                          NONE)
+OSD_ELEMENT(OSD_GPS_LAP_TIME_BEST3,      osdElementGpsLapTimeBest3,       NULL,                          NONE)
+#endif // GPS_LAP_TIMER
+#ifdef USE_PERSISTENT_STATS
+OSD_ELEMENT(OSD_TOTAL_FLIGHTS,           osdElementTotalFlights,          NULL,                          TOTAL_FLIGHTS)
+#endif
+OSD_ELEMENT(OSD_AUX_VALUE,               osdElementAuxValue,              NULL,                          NONE)
+#ifdef USE_MSP_DISPLAYPORT
+OSD_ELEMENT(OSD_SYS_GOGGLE_VOLTAGE,      osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_VTX_VOLTAGE,         osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_BITRATE,             osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_DELAY,               osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_DISTANCE,            osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_LQ,                  osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_GOGGLE_DVR,          osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_VTX_DVR,             osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_WARNINGS,            osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_VTX_TEMP,            osdElementSys,                   NULL,                          NONE)
+OSD_ELEMENT(OSD_SYS_FAN_SPEED,           osdElementSys,                   NULL,                          NONE)
+#endif
+
@@ -39,8 +39,9 @@
     expected to blink (have a warning associated). In this case the entire element
     must be handled in the main draw function and you can't use the background capability.
 
-    Add the mapping from the element ID added in the first step to the function
-    created in the third step to the osdElementDrawFunction array.
+    Add an OSD_ELEMENT() entry for the element ID added in the first step with the
+    function created in the third step to osd/osd_element_list.h. Surround it with the
+    same #ifdef as the drawing function so that it takes no flash when compiled out.
 
     Create the function to draw the element's static (background) portion.
     ---------------------------------------------------------------------
@@ -48,8 +49,7 @@
     parts. It should be named like "osdBackgroundSomething()" where the "Something" matches
     the related element function.
 
-    Add the mapping for the element ID to the background drawing function to the
-    osdElementBackgroundFunction array.
+    Add the background drawing function to the element's entry in osd/osd_element_list.h.
 
     Accelerometer reqirement:
     -------------------------
@@ -169,6 +169,7 @@
 #include "sensors/adcinternal.h"
 #include "sensors/barometer.h"
 #include "sensors/battery.h"
+#include "sensors/esc_state.h"
 #include "sensors/sensors.h"
 
 #ifdef USE_GPS_PLUS_CODES
@@ -228,7 +229,7 @@ static const char compassBar[] = {
 };
 
 static unsigned activeOsdElementCount = 0;
-static uint8_t activeOsdElementArray[OSD_ITEM_COUNT];
+static uint8_t activeOsdElementArray[OSD_ITEM_COUNT];   // indices into osdElementDescriptor[]
 static bool backgroundLayerSupported = false;
 
 // Blink control
@@ -246,6 +247,28 @@ static bool displayPendingForeground;
 static bool displayPendingBackground;
 static char elementBuff[OSD_ELEMENT_BUFFER_LENGTH];
 
+// Formatted output of elements with a declared data source, see osdElementSource[]
+#define OSD_ELEMENT_CACHE_COUNT 16
+#define OSD_ELEMENT_CACHE_LENGTH 16
+#define OSD_ELEMENT_CACHE_MAX_AGE_US 1000000
+#define OSD_ELEMENT_NOT_CACHED 0xff
+
+typedef struct osdElementCache_s {
+    timeUs_t drawnAtUs;
+    int32_t value;
+    bool valid;
+    bool drawElement;
+    uint8_t attr;
+    uint8_t elemOffsetX;
+    uint8_t elemOffsetY;
+    char buff[OSD_ELEMENT_CACHE_LENGTH];
+} osdElementCache_t;
+
+static osdElementCache_t elementCache[OSD_ELEMENT_CACHE_COUNT];
+static uint8_t elementCacheSlot[OSD_ITEM_COUNT];
+static unsigned elementCacheCount;
+static timeUs_t elementRefreshTimeUs;
+
 // Return whether element is a SYS element and needs special handling
 #define IS_SYS_OSD_ELEMENT(item) (item >= OSD_SYS_GOGGLE_VOLTAGE) && (item <= OSD_SYS_FAN_SPEED)
 
@@ -275,16 +298,10 @@ typedef int (*getEscRpmOrFreqFnPtr)(int i);
 
 static int getEscRpm(int i)
 {
-#ifdef USE_DSHOT_TELEMETRY
-    if (useDshotTelemetry) {
-        return lrintf(getDshotRpm(i));
-    }
-#endif
-#ifdef USE_ESC_SENSOR
-    if (featureIsEnabled(FEATURE_ESC_SENSOR)) {
-        return lrintf(erpmToRpm(getEscSensorData(i)->rpm));
+    escState_t escState;
+    if (escStateRead(i, &escState)) {
+        return lrintf(erpmToRpm(escState.data[ESC_STATE_ERPM]));
     }
-#endif
     return 0;
 }
 
@@ -1920,168 +1937,204 @@ static const uint8_t osdElementDisplayOrder[] = {
 #endif
 };
 
-// Define the mapping between the OSD element id and the function to draw it
+// Data sources of elements whose output is entirely determined by a single value.
+// These are only re-formatted when the value has moved by at least the threshold
+// or when the element's own refresh interval has elapsed, otherwise the cached
+// string is displayed again. Any state that changes the attribute (alarms, battery
+// state) is folded into the value well above the threshold.
 
-const osdElementDrawFn osdElementDrawFunction[OSD_ITEM_COUNT] = {
-    [OSD_CAMERA_FRAME]            = NULL,  // only has background. Added first so it's the lowest "layer" and doesn't cover other elements
-    [OSD_RSSI_VALUE]              = osdElementRssi,
-    [OSD_MAIN_BATT_VOLTAGE]       = osdElementMainBatteryVoltage,
-    [OSD_CROSSHAIRS]              = osdElementCrosshairs,  // only has background, but needs to be over other elements (like artificial horizon)
-#ifdef USE_ACC
-    [OSD_ARTIFICIAL_HORIZON]      = osdElementArtificialHorizon,
-    [OSD_UP_DOWN_REFERENCE]       = osdElementUpDownReference,
-#endif
-    [OSD_HORIZON_SIDEBARS]        = NULL,  // only has background
-    [OSD_ITEM_TIMER_1]            = osdElementTimer,
-    [OSD_ITEM_TIMER_2]            = osdElementTimer,
-    [OSD_FLYMODE]                 = osdElementFlymode,
-    [OSD_CRAFT_NAME]              = NULL,  // only has background
-    [OSD_CUSTOM_MSG0]             = osdElementCustomMsg,
-    [OSD_CUSTOM_MSG1]             = osdElementCustomMsg,
-    [OSD_CUSTOM_MSG2]             = osdElementCustomMsg,
-    [OSD_CUSTOM_MSG3]             = osdElementCustomMsg,
-    [OSD_THROTTLE_POS]            = osdElementThrottlePosition,
-#ifdef USE_VTX_COMMON
-    [OSD_VTX_CHANNEL]             = osdElementVtxChannel,
-#endif
-    [OSD_CURRENT_DRAW]            = osdElementCurrentDraw,
-    [OSD_MAH_DRAWN]               = osdElementMahDrawn,
-    [OSD_WATT_HOURS_DRAWN]        = osdElementWattHoursDrawn,
-#ifdef USE_GPS
-    [OSD_GPS_SPEED]               = osdElementGpsSpeed,
-    [OSD_GPS_SATS]                = osdElementGpsSats,
+static int32_t osdSourceMainBatteryVoltage(void)
+{
+    return getBatteryVoltage() | (getBatteryState() << 16) | (getBatteryCellCount() << 24);
+}
+
+static int32_t osdSourceAverageCellVoltage(void)
+{
+    return getBatteryAverageCellVoltage() | (getBatteryState() << 16);
+}
+
+static int32_t osdSourceCurrentDraw(void)
+{
+    return ABS(getAmperage());
+}
+
+static int32_t osdSourceMahDrawn(void)
+{
+    return getMAhDrawn();
+}
+
+static int32_t osdSourceRssi(void)
+{
+    return getRssi() | ((getRssiPercent() < osdConfig()->rssi_alarm) << 16);
+}
+
+#ifdef USE_RX_LINK_QUALITY_INFO
+static int32_t osdSourceLinkQuality(void)
+{
+    return rxGetLinkQuality() | (rxGetRfMode() << 16) | ((rxGetLinkQualityPercent() < osdConfig()->link_quality_alarm) << 24);
+}
 #endif
-    [OSD_ALTITUDE]                = osdElementAltitude,
-    [OSD_ROLL_PIDS]               = osdElementPidsRoll,
-    [OSD_PITCH_PIDS]              = osdElementPidsPitch,
-    [OSD_YAW_PIDS]                = osdElementPidsYaw,
-    [OSD_POWER]                   = osdElementPower,
-    [OSD_PIDRATE_PROFILE]         = osdElementPidRateProfile,
-    [OSD_WARNINGS]                = osdElementWarnings,
-    [OSD_AVG_CELL_VOLTAGE]        = osdElementAverageCellVoltage,
-    [OSD_READY_MODE]              = osdElementReadyMode,
-#ifdef USE_GPS
-    [OSD_GPS_LON]                 = osdElementGpsCoordinate,
-    [OSD_GPS_LAT]                 = osdElementGpsCoordinate,
+
+#ifdef USE_RX_RSSI_DBM
+static int32_t osdSourceRssiDbm(void)
+{
+    return (getRssiDbm() & 0xffff) | (getActiveAntenna() << 16);
+}
 #endif
-    [OSD_DEBUG]                   = osdElementDebug,
-    [OSD_DEBUG2]                  = osdElementDebug2,
-#ifdef USE_ACC
-    [OSD_PITCH_ANGLE]             = osdElementAngleRollPitch,
-    [OSD_ROLL_ANGLE]              = osdElementAngleRollPitch,
+
+static int32_t osdSourceThrottlePosition(void)
+{
+    return calculateThrottlePercent();
+}
+
+static int32_t osdSourceNumericalHeading(void)
+{
+    return DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+}
+
+static int32_t osdSourceAltitude(void)
+{
+    int32_t flags = ARMING_FLAG(ARMED) ? (1 << 28) : 0;
+#ifdef USE_BARO
+    flags |= sensors(SENSOR_BARO) ? (1 << 29) : 0;
 #endif
-    [OSD_MAIN_BATT_USAGE]         = osdElementMainBatteryUsage,
-    [OSD_DISARMED]                = osdElementDisarmed,
 #ifdef USE_GPS
-    [OSD_HOME_DIR]                = osdElementGpsHomeDirection,
-    [OSD_HOME_DIST]               = osdElementGpsHomeDistance,
-#endif
-    [OSD_NUMERICAL_HEADING]       = osdElementNumericalHeading,
-#ifdef USE_VARIO
-    [OSD_NUMERICAL_VARIO]         = osdElementNumericalVario,
-#endif
-    [OSD_COMPASS_BAR]             = osdElementCompassBar,
-#if defined(USE_DSHOT_TELEMETRY) || defined(USE_ESC_SENSOR)
-    [OSD_ESC_TMP]                 = osdElementEscTemperature,
-    [OSD_ESC_RPM]                 = osdElementEscRpm,
-#endif
-    [OSD_REMAINING_TIME_ESTIMATE] = osdElementRemainingTimeEstimate,
-#ifdef USE_RTC_TIME
-    [OSD_RTC_DATETIME]            = osdElementRtcTime,
-#endif
-#ifdef USE_OSD_ADJUSTMENTS
-    [OSD_ADJUSTMENT_RANGE]        = osdElementAdjustmentRange,
+    flags |= (sensors(SENSOR_GPS) && STATE(GPS_FIX)) ? (1 << 30) : 0;
 #endif
+    return getEstimatedAltitudeCm() + flags;
+}
+
+static int32_t osdSourceDisarmed(void)
+{
+    return ARMING_FLAG(ARMED);
+}
+
+static int32_t osdSourcePidRateProfile(void)
+{
+    return getCurrentPidProfileIndex() | (getCurrentControlRateProfileIndex() << 8);
+}
+
 #ifdef USE_ADC_INTERNAL
-    [OSD_CORE_TEMPERATURE]        = osdElementCoreTemperature,
-#endif
-    [OSD_ANTI_GRAVITY]            = osdElementAntiGravity,
-#ifdef USE_ACC
-    [OSD_G_FORCE]                 = osdElementGForce,
-#endif
-    [OSD_MOTOR_DIAG]              = osdElementMotorDiagnostics,
-#ifdef USE_BLACKBOX
-    [OSD_LOG_STATUS]              = osdElementLogStatus,
+static int32_t osdSourceCoreTemperature(void)
+{
+    return getCoreTemperatureCelsius() | (osdConfig()->units << 16);
+}
 #endif
-#ifdef USE_ACC
-    [OSD_FLIP_ARROW]              = osdElementCrashFlipArrow,
+
+#ifdef USE_PERSISTENT_STATS
+static int32_t osdSourceTotalFlights(void)
+{
+    return statsConfig()->stats_total_flights;
+}
 #endif
+
+// Indices of the data sources in osdElementSource[], referenced by osd_element_list.h
+
+typedef enum {
+    OSD_SOURCE_NONE = 0,
+    OSD_SOURCE_MAIN_BATT_VOLTAGE,
+    OSD_SOURCE_AVG_CELL_VOLTAGE,
+    OSD_SOURCE_CURRENT_DRAW,
+    OSD_SOURCE_MAH_DRAWN,
+    OSD_SOURCE_RSSI_VALUE,
 #ifdef USE_RX_LINK_QUALITY_INFO
-    [OSD_LINK_QUALITY]            = osdElementLinkQuality,
-#endif
-#ifdef USE_RX_LINK_UPLINK_POWER
-    [OSD_TX_UPLINK_POWER]         = osdElementTxUplinkPower,
+    OSD_SOURCE_LINK_QUALITY,
 #endif
-#ifdef USE_GPS
-    [OSD_FLIGHT_DIST]             = osdElementGpsFlightDistance,
+#ifdef USE_RX_RSSI_DBM
+    OSD_SOURCE_RSSI_DBM_VALUE,
 #endif
-#ifdef USE_OSD_STICK_OVERLAY
-    [OSD_STICK_OVERLAY_LEFT]      = osdElementStickOverlay,
-    [OSD_STICK_OVERLAY_RIGHT]     = osdElementStickOverlay,
+    OSD_SOURCE_THROTTLE_POS,
+    OSD_SOURCE_NUMERICAL_HEADING,
+    OSD_SOURCE_ALTITUDE,
+    OSD_SOURCE_DISARMED,
+    OSD_SOURCE_PIDRATE_PROFILE,
+#ifdef USE_ADC_INTERNAL
+    OSD_SOURCE_CORE_TEMPERATURE,
 #endif
-    [OSD_PILOT_NAME]              = NULL,  // only has background
-#if defined(USE_DSHOT_TELEMETRY) || defined(USE_ESC_SENSOR)
-    [OSD_ESC_RPM_FREQ]            = osdElementEscRpmFreq,
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
+    OSD_SOURCE_ESC_TMP,
 #endif
-#ifdef USE_PROFILE_NAMES
-    [OSD_RATE_PROFILE_NAME]       = osdElementRateProfileName,
-    [OSD_PID_PROFILE_NAME]        = osdElementPidProfileName,
+#ifdef USE_PERSISTENT_STATS
+    OSD_SOURCE_TOTAL_FLIGHTS,
 #endif
-#ifdef USE_OSD_PROFILES
-    [OSD_PROFILE_NAME]            = osdElementOsdProfileName,
+    OSD_SOURCE_COUNT
+} osdElementSourceIndex_e;
+
+// A threshold of zero with no value function re-formats at the refresh interval only.
+
+static const osdElementSource_t osdElementSource[OSD_SOURCE_COUNT] = {
+    [OSD_SOURCE_MAIN_BATT_VOLTAGE]  = { osdSourceMainBatteryVoltage,  1,   0 },
+    [OSD_SOURCE_AVG_CELL_VOLTAGE]   = { osdSourceAverageCellVoltage,  1,   0 },
+    [OSD_SOURCE_CURRENT_DRAW]       = { osdSourceCurrentDraw,         5,   0 },
+    [OSD_SOURCE_MAH_DRAWN]          = { osdSourceMahDrawn,            1,   0 },
+    [OSD_SOURCE_RSSI_VALUE]         = { osdSourceRssi,                1,   0 },
+#ifdef USE_RX_LINK_QUALITY_INFO
+    [OSD_SOURCE_LINK_QUALITY]       = { osdSourceLinkQuality,         1,   0 },
 #endif
 #ifdef USE_RX_RSSI_DBM
-    [OSD_RSSI_DBM_VALUE]          = osdElementRssiDbm,
+    [OSD_SOURCE_RSSI_DBM_VALUE]     = { osdSourceRssiDbm,             1,   0 },
 #endif
-#ifdef USE_RX_RSNR
-    [OSD_RSNR_VALUE]              = osdElementRsnr,
+    [OSD_SOURCE_THROTTLE_POS]       = { osdSourceThrottlePosition,    1,   0 },
+    [OSD_SOURCE_NUMERICAL_HEADING]  = { osdSourceNumericalHeading,    1,   0 },
+    [OSD_SOURCE_ALTITUDE]           = { osdSourceAltitude,            10,  0 },
+    [OSD_SOURCE_DISARMED]           = { osdSourceDisarmed,            1,   0 },
+    [OSD_SOURCE_PIDRATE_PROFILE]    = { osdSourcePidRateProfile,      1,   0 },
+#ifdef USE_ADC_INTERNAL
+    [OSD_SOURCE_CORE_TEMPERATURE]   = { osdSourceCoreTemperature,     1,   0 },
 #endif
-    [OSD_RC_CHANNELS]             = osdElementRcChannels,
-#ifdef USE_GPS
-    [OSD_EFFICIENCY]              = osdElementEfficiency,
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
+    [OSD_SOURCE_ESC_TMP]            = { NULL,                         0,   500 },
 #endif
-#ifdef USE_GPS_LAP_TIMER
-    [OSD_GPS_LAP_TIME_CURRENT]    = osdElementGpsLapTimeCurrent,
-    [OSD_GPS_LAP_TIME_PREVIOUS]   = osdElementGpsLapTimePrevious,
-    [OSD_GPS_LAP_TIME_BEST3]      = osdElementGpsLapTimeBest3,
-#endif // GPS_LAP_TIMER
 #ifdef USE_PERSISTENT_STATS
-    [OSD_TOTAL_FLIGHTS]           = osdElementTotalFlights,
-#endif
-    [OSD_AUX_VALUE]               = osdElementAuxValue,
-#ifdef USE_MSP_DISPLAYPORT
-    [OSD_SYS_GOGGLE_VOLTAGE]      = osdElementSys,
-    [OSD_SYS_VTX_VOLTAGE]         = osdElementSys,
-    [OSD_SYS_BITRATE]             = osdElementSys,
-    [OSD_SYS_DELAY]               = osdElementSys,
-    [OSD_SYS_DISTANCE]            = osdElementSys,
-    [OSD_SYS_LQ]                  = osdElementSys,
-    [OSD_SYS_GOGGLE_DVR]          = osdElementSys,
-    [OSD_SYS_VTX_DVR]             = osdElementSys,
-    [OSD_SYS_WARNINGS]            = osdElementSys,
-    [OSD_SYS_VTX_TEMP]            = osdElementSys,
-    [OSD_SYS_FAN_SPEED]           = osdElementSys,
+    [OSD_SOURCE_TOTAL_FLIGHTS]      = { osdSourceTotalFlights,        1,   1000 },
 #endif
 };
 
-// Define the mapping between the OSD element id and the function to draw its background (static part)
-// Only necessary to define the entries that actually have a background function
+// Everything needed to render an element, packed together so the render loop only touches
+// one entry per element. Only elements compiled into the firmware have a descriptor.
 
-const osdElementDrawFn osdElementBackgroundFunction[OSD_ITEM_COUNT] = {
-    [OSD_CAMERA_FRAME]            = osdBackgroundCameraFrame,
-    [OSD_HORIZON_SIDEBARS]        = osdBackgroundHorizonSidebars,
-    [OSD_CRAFT_NAME]              = osdBackgroundCraftName,
-#ifdef USE_OSD_STICK_OVERLAY
-    [OSD_STICK_OVERLAY_LEFT]      = osdBackgroundStickOverlay,
-    [OSD_STICK_OVERLAY_RIGHT]     = osdBackgroundStickOverlay,
-#endif
-    [OSD_PILOT_NAME]              = osdBackgroundPilotName,
+typedef struct osdElementDescriptor_s {
+    osdElementDrawFn draw;          // draws the dynamic part, NULL if the element only has a background
+    osdElementDrawFn background;    // draws the static part, NULL if none
+    uint8_t item;                   // osd_items_e
+    uint8_t source;                 // osdElementSourceIndex_e
+} osdElementDescriptor_t;
+
+static const osdElementDescriptor_t osdElementDescriptor[] = {
+#define OSD_ELEMENT(item, draw, background, source) { draw, background, item, OSD_SOURCE_ ## source },
+#include "osd/osd_element_list.h"
+#undef OSD_ELEMENT
+};
+
+enum {
+#define OSD_ELEMENT(item, draw, background, source) OSD_DESCRIPTOR_ ## item,
+#include "osd/osd_element_list.h"
+#undef OSD_ELEMENT
+    OSD_DESCRIPTOR_COUNT
+};
+
+STATIC_ASSERT(OSD_DESCRIPTOR_COUNT < 255, osd_too_many_element_descriptors);
+
+// Map from element id to one more than the index of its descriptor, zero if not compiled in
+
+static const uint8_t osdElementDescriptorIndex[OSD_ITEM_COUNT] = {
+#define OSD_ELEMENT(item, draw, background, source) [item] = OSD_DESCRIPTOR_ ## item + 1,
+#include "osd/osd_element_list.h"
+#undef OSD_ELEMENT
 };
 
 static void osdAddActiveElement(osd_items_e element)
 {
-    if (VISIBLE(osdElementConfig()->item_pos[element])) {
-        activeOsdElementArray[activeOsdElementCount++] = element;
+    const uint8_t descriptorIndex = osdElementDescriptorIndex[element];
+
+    // Elements which aren't compiled in have nothing to draw
+    if (descriptorIndex && VISIBLE(osdElementConfig()->item_pos[element])) {
+        activeOsdElementArray[activeOsdElementCount++] = descriptorIndex - 1;
+
+        if (osdElementDescriptor[descriptorIndex - 1].source != OSD_SOURCE_NONE && elementCacheCount < OSD_ELEMENT_CACHE_COUNT) {
+            elementCache[elementCacheCount].valid = false;
+            elementCacheSlot[element] = elementCacheCount++;
+        }
     }
 }
 
@@ -2091,6 +2144,8 @@ static void osdAddActiveElement(osd_items_e element)
 void osdAddActiveElements(void)
 {
     activeOsdElementCount = 0;
+    elementCacheCount = 0;
+    memset(elementCacheSlot, OSD_ELEMENT_NOT_CACHED, sizeof(elementCacheSlot));
 
 #ifdef USE_ACC
     if (sensors(SENSOR_ACC)) {
@@ -2138,12 +2193,55 @@ void osdAddActiveElements(void)
 #endif
 }
 
-static bool osdDrawSingleElement(displayPort_t *osdDisplayPort, uint8_t item)
+// Only call the drawing function of an element with a data source if its value has
+// changed by the threshold or it is due a refresh, otherwise re-use the cached string
+static void osdDrawCachedElement(osdElementCache_t *cache, const osdElementDescriptor_t *descriptor)
 {
+    const osdElementSource_t *source = &osdElementSource[descriptor->source];
+    const timeDelta_t ageUs = cmpTimeUs(elementRefreshTimeUs, cache->drawnAtUs);
+    const int32_t value = source->value ? source->value() : 0;
+    bool redraw = !cache->valid || ageUs >= OSD_ELEMENT_CACHE_MAX_AGE_US;
+
+    if (!redraw && ageUs >= source->refreshMs * 1000) {
+        redraw = !source->value || ABS(value - cache->value) >= source->threshold;
+    }
+
+    if (redraw) {
+        descriptor->draw(&activeElement);
+
+        // Multi-pass elements and long strings are never cached
+        cache->valid = activeElement.rendered && (strlen(activeElement.buff) < OSD_ELEMENT_CACHE_LENGTH);
+        if (cache->valid) {
+            cache->value = value;
+            cache->drawnAtUs = elementRefreshTimeUs;
+            cache->drawElement = activeElement.drawElement;
+            cache->attr = activeElement.attr;
+            cache->elemOffsetX = activeElement.elemOffsetX;
+            cache->elemOffsetY = activeElement.elemOffsetY;
+            strcpy(cache->buff, activeElement.buff);
+        }
+    } else {
+        activeElement.drawElement = cache->drawElement;
+        activeElement.attr = cache->attr;
+        activeElement.elemOffsetX = cache->elemOffsetX;
+        activeElement.elemOffsetY = cache->elemOffsetY;
+        strcpy(activeElement.buff, cache->buff);
+    }
+
+    // The canvas is rebuilt each refresh, so even an unchanged element must be written
+    if (activeElement.drawElement) {
+        displayPendingForeground = true;
+    }
+}
+
+static bool osdDrawSingleElement(displayPort_t *osdDisplayPort, const osdElementDescriptor_t *descriptor)
+{
+    const uint8_t item = descriptor->item;
+
     // By default mark the element as rendered in case it's in the off blink state
     activeElement.rendered = true;
 
-    if (!osdElementDrawFunction[item]) {
+    if (!descriptor->draw) {
         // Element has no drawing function
         return true;
     }
@@ -2168,8 +2266,10 @@ static bool osdDrawSingleElement(displayPort_t *osdDisplayPort, uint8_t item)
     // Call the element drawing function
     if (IS_SYS_OSD_ELEMENT(item)) {
         displaySys(osdDisplayPort, elemPosX, elemPosY, (displayPortSystemElement_e)(item - OSD_SYS_GOGGLE_VOLTAGE + DISPLAYPORT_SYS_GOGGLE_VOLTAGE));
+    } else if (elementCacheSlot[item] != OSD_ELEMENT_NOT_CACHED) {
+        osdDrawCachedElement(&elementCache[elementCacheSlot[item]], descriptor);
     } else {
-        osdElementDrawFunction[item](&activeElement);
+        descriptor->draw(&activeElement);
         if (activeElement.drawElement) {
             displayPendingForeground = true;
         }
@@ -2178,9 +2278,11 @@ static bool osdDrawSingleElement(displayPort_t *osdDisplayPort, uint8_t item)
     return activeElement.rendered;
 }
 
-static bool osdDrawSingleElementBackground(displayPort_t *osdDisplayPort, uint8_t item)
+static bool osdDrawSingleElementBackground(displayPort_t *osdDisplayPort, const osdElementDescriptor_t *descriptor)
 {
-    if (!osdElementBackgroundFunction[item]) {
+    const uint8_t item = descriptor->item;
+
+    if (!descriptor->background) {
         // Element has no background drawing function
         return true;
     }
@@ -2201,7 +2303,7 @@ static bool osdDrawSingleElementBackground(displayPort_t *osdDisplayPort, uint8_
     activeElement.attr = DISPLAYPORT_SEVERITY_NORMAL;
 
     // Call the element background drawing function
-    osdElementBackgroundFunction[item](&activeElement);
+    descriptor->background(&activeElement);
     if (activeElement.drawElement) {
         displayPendingBackground = true;
     }
@@ -2272,19 +2374,19 @@ bool osdDrawNextActiveElement(displayPort_t *osdDisplayPort)
         return false;
     }
 
-    uint8_t item = activeOsdElementArray[activeElementNumber];
+    const osdElementDescriptor_t *descriptor = &osdElementDescriptor[activeOsdElementArray[activeElementNumber]];
 
-    if (!backgroundLayerSupported && osdElementBackgroundFunction[item] && !backgroundRendered) {
+    if (!backgroundLayerSupported && descriptor->background && !backgroundRendered) {
         // If the background layer isn't supported then we
         // have to draw the element's static layer as well.
-        backgroundRendered = osdDrawSingleElementBackground(osdDisplayPort, item);
+        backgroundRendered = osdDrawSingleElementBackground(osdDisplayPort, descriptor);
 
         // After the background always come back to check for foreground
         return true;
     }
 
     // Only advance to the next element if rendering is complete
-    if (osdDrawSingleElement(osdDisplayPort, item)) {
+    if (osdDrawSingleElement(osdDisplayPort, descriptor)) {
         // If rendering is complete then advance to the next element
 
         // Prepare to render the background of the next element
@@ -2395,7 +2497,7 @@ void osdDrawActiveElementsBackground(displayPort_t *osdDisplayPort)
         displayLayerSelect(osdDisplayPort, DISPLAYPORT_LAYER_BACKGROUND);
         displayClearScreen(osdDisplayPort, DISPLAY_CLEAR_WAIT);
         for (unsigned i = 0; i < activeOsdElementCount; i++) {
-            while (!osdDrawSingleElementBackground(osdDisplayPort, activeOsdElementArray[i]));
+            while (!osdDrawSingleElementBackground(osdDisplayPort, &osdElementDescriptor[activeOsdElementArray[i]]));
         }
         displayLayerSelect(osdDisplayPort, DISPLAYPORT_LAYER_FOREGROUND);
     }
@@ -2405,9 +2507,16 @@ void osdElementsInit(bool backgroundLayerFlag)
 {
     backgroundLayerSupported = backgroundLayerFlag;
     activeOsdElementCount = 0;
+    elementCacheCount = 0;
+    memset(elementCacheSlot, OSD_ELEMENT_NOT_CACHED, sizeof(elementCacheSlot));
     pt1FilterInit(&batteryEfficiencyFilt, pt1FilterGain(EFFICIENCY_CUTOFF_HZ, 1.0f / osdConfig()->framerate_hz));
 }
 
+void osdSyncElementCache(timeUs_t currentTimeUs)
+{
+    elementRefreshTimeUs = currentTimeUs;
+}
+
 void osdSyncBlink(timeUs_t currentTimeUs)
 {
     const int period = 1000000/OSD_BLINK_FREQUENCY_HZ;
@@ -2542,7 +2651,7 @@ void osdUpdateAlarms(void)
 static bool osdElementIsActive(osd_items_e element)
 {
     for (unsigned i = 0; i < activeOsdElementCount; i++) {
-        if (activeOsdElementArray[i] == element) {
+        if (osdElementDescriptor[activeOsdElementArray[i]].item == element) {
             return true;
         }
     }
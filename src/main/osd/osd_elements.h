@@ -47,6 +47,12 @@ typedef struct osdElementParms_s {
 
 typedef void (*osdElementDrawFn)(osdElementParms_t *element);
 
+typedef struct osdElementSource_s {
+    int32_t (*value)(void);         // value the element's output is derived from
+    uint16_t threshold;             // change in value which causes the element to be re-formatted
+    uint16_t refreshMs;             // interval at which the element is re-evaluated, 0 for every refresh
+} osdElementSource_t;
+
 int osdConvertTemperatureToSelectedUnit(int tempInDegreesCelcius);
 void osdFormatDistanceString(char *result, int distance, char leadingSymbol);
 bool osdFormatRtcDateTime(char *buffer);
@@ -66,6 +72,7 @@ bool osdDisplayActiveElement(void);
 void osdDrawActiveElementsBackground(displayPort_t *osdDisplayPort);
 void osdElementsInit(bool backgroundLayerFlag);
 void osdSyncBlink(timeUs_t currentTimeUs);
+void osdSyncElementCache(timeUs_t currentTimeUs);
 void osdResetAlarms(void);
 void osdUpdateAlarms(void);
 bool osdElementsNeedAccelerometer(void);
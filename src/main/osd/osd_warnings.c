@@ -63,6 +63,7 @@
 #include "sensors/acceleration.h"
 #include "sensors/adcinternal.h"
 #include "sensors/battery.h"
+#include "sensors/esc_state.h"
 #include "sensors/sensors.h"
 
 const char CRASHFLIP_WARNING[] = ">CRASH FLIP<";
@@ -335,9 +336,13 @@ void renderOsdWarning(char *warningText, bool *blinking, uint8_t *displayAttr)
         warningText[dshotEscErrorLength++] = 'S';
         warningText[dshotEscErrorLength++] = 'C';
 
-        for (uint8_t k = 0; k < getMotorCount(); k++) {
-            // Skip if no extended telemetry at all
-            if ((dshotTelemetryState.motorState[k].telemetryTypes & DSHOT_EXTENDED_TELEMETRY_MASK) == 0) {
+        // each motor takes up to 6 characters, ' ', its number and up to four of 'R', 'T', 'C' and 'D'
+        for (uint8_t k = 0; k < getMotorCount() && dshotEscErrorLength + 6 <= OSD_WARNINGS_MAX_SIZE; k++) {
+            escState_t escState;
+            const bool desync = escStateRead(k, &escState) && escState.desync;
+
+            // Skip if no extended telemetry at all, a desync is found from the eRPM alone
+            if ((dshotTelemetryState.motorState[k].telemetryTypes & DSHOT_EXTENDED_TELEMETRY_MASK) == 0 && !desync) {
                 continue;
             }
 
@@ -364,6 +369,9 @@ void renderOsdWarning(char *warningText, bool *blinking, uint8_t *displayAttr)
                     && dshotTelemetryState.motorState[k].telemetryData[DSHOT_TELEMETRY_TYPE_CURRENT] >= osdConfig()->esc_current_alarm) {
                 warningText[dshotEscErrorLength++] = 'C';
             }
+            if (desync) {
+                warningText[dshotEscErrorLength++] = 'D';
+            }
 
             // If no esc warning data undo esc nr (esc telemetry data types depends on the esc hw/sw)
             if (dshotEscErrorLengthMotorBegin + 2 == dshotEscErrorLength)
@@ -37,7 +37,7 @@
 #include "drivers/dma_reqmap.h"
 
 // TODO(hertz@): UARTDEV_CONFIG_MAX is measured to be exactly 8, which cannot accomodate even all the UARTs below
-PG_REGISTER_ARRAY_WITH_RESET_FN(serialUartConfig_t, UARTDEV_CONFIG_MAX, serialUartConfig, PG_SERIAL_UART_CONFIG, 0);
+PG_REGISTER_ARRAY_WITH_RESET_FN(serialUartConfig_t, UARTDEV_CONFIG_MAX, serialUartConfig, PG_SERIAL_UART_CONFIG, 1);
 
 typedef struct uartDmaopt_s {
     serialPortIdentifier_e identifier;
@@ -89,6 +89,8 @@ void pgResetFn_serialUartConfig(serialUartConfig_t *config)
     for (unsigned i = 0; i < UARTDEV_CONFIG_MAX; i++) {
         config[i].txDmaopt = DMA_OPT_UNUSED;
         config[i].rxDmaopt = DMA_OPT_UNUSED;
+        config[i].txBufferSize = 0;
+        config[i].rxBufferSize = 0;
     }
 
     for (unsigned i = 0; i < ARRAYLEN(uartDmaopt); i++) {
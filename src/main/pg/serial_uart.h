@@ -28,9 +28,14 @@
 
 #define UARTDEV_CONFIG_MAX (RESOURCE_UART_COUNT + RESOURCE_LPUART_COUNT)
 
+#define UART_BUFFER_SIZE_MIN 32
+#define UART_BUFFER_SIZE_MAX 8192
+
 typedef struct serialUartConfig_s {
     int8_t txDmaopt;
     int8_t rxDmaopt;
+    uint16_t txBufferSize;              // 0 uses the default UART_TX_BUFFER_SIZE
+    uint16_t rxBufferSize;              // 0 uses the default UART_RX_BUFFER_SIZE
 } serialUartConfig_t;
 
 PG_DECLARE_ARRAY(serialUartConfig_t, UARTDEV_CONFIG_MAX, serialUartConfig);
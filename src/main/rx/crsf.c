@@ -51,7 +51,7 @@
 
 #include "telemetry/crsf.h"
 
-#define CRSF_TIME_NEEDED_PER_FRAME_US   1750 // a maximally sized 64byte payload will take ~1550us, round up to 1750.
+#define CRSF_TIME_NEEDED_PER_FRAME_US   1750 // a maximally sized 64byte payload will take ~1550us at CRSF_BAUDRATE, round up to 1750.
 #define CRSF_TIME_BETWEEN_FRAMES_US     6667 // At fastest, frames are sent by the transmitter every 6.667 milliseconds, 150 Hz
 
 #define CRSF_DIGITAL_CHANNEL_MIN 172
@@ -69,7 +69,9 @@ STATIC_UNIT_TESTED crsfFrame_t crsfChannelDataFrame;
 STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
 static serialPort_t *serialPort;
+static rxRuntimeState_t *crsfRxRuntimeState;
 static timeUs_t crsfFrameStartAtUs = 0;
+static timeDelta_t crsfFrameTimeoutUs = CRSF_TIME_NEEDED_PER_FRAME_US;
 static uint8_t telemetryBuf[CRSF_FRAME_SIZE_MAX];
 static uint8_t telemetryBufLen = 0;
 static float channelScale = CRSF_RC_CHANNEL_SCALE_LEGACY;
@@ -95,7 +97,12 @@ const uint16_t uplinkTXPowerStatesMw[CRSF_UPLINK_POWER_LEVEL_MW_ITEMS_COUNT] = {
  * Max frame size is 64 bytes
  * A 64 byte frame plus 1 sync byte can be transmitted in 1393 microseconds.
  *
- * CRSF_TIME_NEEDED_PER_FRAME_US is set conservatively at 1500 microseconds
+ * CRSF_TIME_NEEDED_PER_FRAME_US is set conservatively at 1750 microseconds, and scaled with the baud rate
+ * when a faster one is negotiated; at 1000 frames per second a frame follows the last one within a millisecond,
+ * so a fixed 420000 baud timeout would never see the gap it needs to find the start of a frame.
+ *
+ * With RX DMA the bytes collect in the port's buffer and are framed from the idle line interrupt once the
+ * transmitter pauses after a frame, instead of one interrupt per byte.
  *
  * Every frame has the structure:
  * <Device address><Frame length><Type><Payload><CRC>
@@ -358,7 +365,7 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
     debug[2] = currentTimeUs - crsfFrameStartAtUs;
 #endif
 
-    if (cmpTimeUs(currentTimeUs, crsfFrameStartAtUs) > CRSF_TIME_NEEDED_PER_FRAME_US) {
+    if (cmpTimeUs(currentTimeUs, crsfFrameStartAtUs) > crsfFrameTimeoutUs) {
         // We've received a character after max time needed to complete a frame,
         // so this must be the start of a new frame.
 #if defined(USE_CRSF_V3)
@@ -416,7 +423,7 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
                     break;
                 case CRSF_FRAMETYPE_DISPLAYPORT_CMD: {
                     uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
-                    crsfProcessDisplayPortCmd(frameStart);
+                    crsfProcessDisplayPortCmd(frameStart, crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC - CRSF_FRAME_ORIGIN_DEST_SIZE);
                     break;
                 }
 #endif
@@ -597,6 +604,19 @@ STATIC_UNIT_TESTED float crsfReadRawRC(const rxRuntimeState_t *rxRuntimeState, u
     }
 }
 
+// Idle line callback; with RX DMA the frame is in the port's buffer, the state of the framer is kept across idles
+STATIC_UNIT_TESTED void crsfIdle(void)
+{
+    while (serialRxBytesWaiting(serialPort)) {
+        crsfDataReceive(serialRead(serialPort), crsfRxRuntimeState);
+    }
+}
+
+static void crsfSetFrameTimeout(uint32_t baudrate)
+{
+    crsfFrameTimeoutUs = baudrate ? CRSF_TIME_NEEDED_PER_FRAME_US * CRSF_BAUDRATE / baudrate : CRSF_TIME_NEEDED_PER_FRAME_US;
+}
+
 void crsfRxWriteTelemetryData(const void *data, int len)
 {
     len = MIN(len, (int)sizeof(telemetryBuf));
@@ -636,6 +656,7 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeState_t *rxRuntimeState)
     }
 
     uint32_t crsfBaudrate = CRSF_BAUDRATE;
+    crsfRxRuntimeState = rxRuntimeState;
 
 #if defined(USE_CRSF_V3)
     crsfBaudrate = rxConfig->crsf_use_negotiated_baud ? getCrsfCachedBaudrate() : CRSF_BAUDRATE;
@@ -650,6 +671,11 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeState_t *rxRuntimeState)
         CRSF_PORT_OPTIONS | (rxConfig->serialrx_inverted ? SERIAL_INVERTED : 0)
         );
 
+    if (serialPort) {
+        crsfSetFrameTimeout(serialPort->baudRate);
+        serialSetIdleCallback(serialPort, crsfIdle);
+    }
+
     if (rssiSource == RSSI_SOURCE_NONE) {
         rssiSource = RSSI_SOURCE_RX_PROTOCOL_CRSF;
     }
@@ -666,6 +692,7 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeState_t *rxRuntimeState)
 void crsfRxUpdateBaudrate(uint32_t baudrate)
 {
     serialSetBaudRate(serialPort, baudrate);
+    crsfSetFrameTimeout(baudrate);
     persistentObjectWrite(PERSISTENT_OBJECT_SERIALRX_BAUD, baudrate);
 }
 
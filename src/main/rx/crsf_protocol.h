@@ -88,11 +88,17 @@ enum {
     CRSF_DISPLAYPORT_SUBCMD_OPEN = 0x03,  // client request to open cms menu
     CRSF_DISPLAYPORT_SUBCMD_CLOSE = 0x04,  // client request to close cms menu
     CRSF_DISPLAYPORT_SUBCMD_POLL = 0x05,  // client request to poll/refresh cms menu
+    CRSF_DISPLAYPORT_SUBCMD_UPDATE_ROWS = 0x06, // transmit changed rows of the displayport buffer to remote
 };
 
 enum {
     CRSF_DISPLAYPORT_OPEN_ROWS_OFFSET = 1,
     CRSF_DISPLAYPORT_OPEN_COLS_OFFSET = 2,
+    CRSF_DISPLAYPORT_OPEN_FLAGS_OFFSET = 3, // optional, sent by clients that support any of the flags below
+};
+
+enum {
+    CRSF_DISPLAYPORT_OPEN_FLAG_ROW_UPDATES = 0x01, // client accepts CRSF_DISPLAYPORT_SUBCMD_UPDATE_ROWS
 };
 
 enum {
@@ -39,6 +39,7 @@
 #ifdef USE_TELEMETRY
 #include "telemetry/telemetry.h"
 #include "telemetry/smartport.h"
+#include "telemetry/smartport_response.h"
 #endif
 
 #include "pg/rx.h"
@@ -230,14 +231,28 @@ static void fportDataReceive(uint16_t c, void *data)
 }
 
 #if defined(USE_TELEMETRY_SMARTPORT)
+// Arms the response, it is sent by fportSendResponse() in the window of the next telemetry request
 static void smartPortWriteFrameFport(const smartPortPayload_t *payload)
 {
+    uint16_t checksum = 0;
+    smartPortResponseStart();
+    smartPortResponseWrite(FPORT_RESPONSE_FRAME_LENGTH, &checksum);
+    smartPortResponseWrite(FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, &checksum);
+    smartPortArmFrame(payload, checksum);
+}
+
+static void fportSendResponse(void)
+{
+    static timeUs_t lastTelemetryFrameSentUs;
+
     framePosition = 0;
 
-    uint16_t checksum = 0;
-    smartPortSendByte(FPORT_RESPONSE_FRAME_LENGTH, &checksum, fportPort);
-    smartPortSendByte(FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, &checksum, fportPort);
-    smartPortWriteFrameSerial(payload, fportPort, checksum);
+    smartPortResponseSend(fportPort);
+    clearToSend = false;
+
+    const timeUs_t currentTimeUs = micros();
+    DEBUG_SET(DEBUG_FPORT, DEBUG_FPORT_TELEMETRY_INTERVAL, currentTimeUs - lastTelemetryFrameSentUs);
+    lastTelemetryFrameSentUs = currentTimeUs;
 }
 #endif
 
@@ -340,6 +355,20 @@ static uint8_t fportFrameStatus(rxRuntimeState_t *rxRuntimeState)
     if ((mspPayload || hasTelemetryRequest) && cmpTimeUs(micros(), lastTelemetryFrameReceivedUs) >= FPORT_MIN_TELEMETRY_RESPONSE_DELAY_US) {
         hasTelemetryRequest = false;
 
+#if defined(USE_TELEMETRY_SMARTPORT)
+        // the frame status is checked on every scheduler pass, so an armed frame goes out as soon as the window opens;
+        // processing then builds the next one
+        if (clearToSend && smartPortResponseIsArmed()) {
+            if (cmpTimeUs(micros(), lastTelemetryFrameReceivedUs) <= FPORT_MAX_TELEMETRY_RESPONSE_DELAY_US) {
+                fportSendResponse();
+            } else {
+                // too late, the receiver has stopped listening and the line may carry the next RC frame
+                smartPortResponseMiss();
+                clearToSend = false;
+            }
+        }
+#endif
+
         result = (result & ~RX_FRAME_PENDING) | RX_FRAME_PROCESSING_REQUIRED;
     }
 
@@ -356,24 +385,24 @@ static bool fportProcessFrame(const rxRuntimeState_t *rxRuntimeState)
     UNUSED(rxRuntimeState);
 
 #if defined(USE_TELEMETRY_SMARTPORT)
-    static timeUs_t lastTelemetryFrameSentUs;
-
-    timeUs_t currentTimeUs = micros();
-    if (cmpTimeUs(currentTimeUs, lastTelemetryFrameReceivedUs) > FPORT_MAX_TELEMETRY_RESPONSE_DELAY_US) {
-       clearToSend = false;
+    if (clearToSend && cmpTimeUs(micros(), lastTelemetryFrameReceivedUs) > FPORT_MAX_TELEMETRY_RESPONSE_DELAY_US) {
+        // nothing was armed and the frame was built too late for the window
+        smartPortResponseMiss();
+        clearToSend = false;
     }
 
-    if (clearToSend) {
-        processSmartPortTelemetry(mspPayload, &clearToSend, NULL);
+    if (!smartPortResponseIsArmed() || mspPayload) {
+        bool buildFrame = !smartPortResponseIsArmed();
+        processSmartPortTelemetry(mspPayload, &buildFrame, NULL);
 
-        if (clearToSend) {
+        if (buildFrame) {
             smartPortWriteFrameFport(&emptySmartPortFrame);
-
-            clearToSend = false;
         }
+    }
 
-        DEBUG_SET(DEBUG_FPORT, DEBUG_FPORT_TELEMETRY_INTERVAL, currentTimeUs - lastTelemetryFrameSentUs);
-        lastTelemetryFrameSentUs = currentTimeUs;
+    if (clearToSend) {
+        // the window is still open for a frame that had to be built first
+        fportSendResponse();
     }
 
     mspPayload = NULL;
@@ -125,6 +125,9 @@ typedef enum {
 #ifdef USE_POSITION_HOLD
     TASK_POSHOLD,
 #endif
+#ifdef USE_NAV_FILTER
+    TASK_NAV_FILTER,
+#endif
 #ifdef USE_MAG
     TASK_COMPASS,
 #endif
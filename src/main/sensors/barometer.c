@@ -175,6 +175,7 @@ static uint16_t calibrationCycleCount = 0;
 static float baroGroundAltitude = 0.0f;
 static bool baroCalibrated = false;
 static bool baroReady = false;
+static uint16_t baroSampleStamp = 0;        // counts the altitude samples, see baroHasNewData()
 
 void baroPreInit(void)
 {
@@ -468,6 +469,7 @@ uint32_t baroUpdate(timeUs_t currentTimeUs)
                 if (baroIsCalibrated()) {
                     // zero baro altitude
                     baro.altitude = altitude - baroGroundAltitude;
+                    baroSampleStamp++;
                 } else {
                     // establish stable baroGroundAltitude value to zero baro altitude with
                     performBaroCalibrationCycle(altitude);
@@ -515,6 +517,17 @@ float getBaroAltitude(void)
     return baro.altitude;
 }
 
+// Same as gpsHasNewData(), true once for every new altitude sample after calibration.
+// A new sample can have the same altitude as the previous one.
+bool baroHasNewData(uint16_t *stamp)
+{
+    if (*stamp != baroSampleStamp) {
+        *stamp = baroSampleStamp;
+        return true;
+    }
+    return false;
+}
+
 static void performBaroCalibrationCycle(const float altitude)
 {
     baroGroundAltitude += altitude;
@@ -46,6 +46,7 @@
 #include "drivers/serial_uart.h"
 
 #include "esc_sensor.h"
+#include "esc_state.h"
 
 #include "config/config.h"
 
@@ -248,7 +249,7 @@ uint8_t calculateCrc8(const uint8_t *Buf, const uint8_t BufLen)
     return crc;
 }
 
-static uint8_t decodeEscFrame(void)
+static uint8_t decodeEscFrame(timeUs_t currentTimeUs)
 {
     if (!isFrameComplete()) {
         return ESC_SENSOR_FRAME_PENDING;
@@ -268,6 +269,15 @@ static uint8_t decodeEscFrame(void)
 
         combinedDataNeedsUpdate = true;
 
+        const escSensorData_t *escData = &escSensorData[escSensorMotor];
+        escStateBeginUpdate(escSensorMotor);
+        escStateSet(escSensorMotor, ESC_STATE_ERPM, escData->rpm, ESC_STATE_SOURCE_ESC_SENSOR, currentTimeUs);
+        escStateSet(escSensorMotor, ESC_STATE_TEMPERATURE, escData->temperature, ESC_STATE_SOURCE_ESC_SENSOR, currentTimeUs);
+        escStateSet(escSensorMotor, ESC_STATE_VOLTAGE, escData->voltage, ESC_STATE_SOURCE_ESC_SENSOR, currentTimeUs);
+        escStateSet(escSensorMotor, ESC_STATE_CURRENT, escData->current, ESC_STATE_SOURCE_ESC_SENSOR, currentTimeUs);
+        escStateSet(escSensorMotor, ESC_STATE_CONSUMPTION, escData->consumption, ESC_STATE_SOURCE_ESC_SENSOR, currentTimeUs);
+        escStateEndUpdate(escSensorMotor, currentTimeUs);
+
         frameStatus = ESC_SENSOR_FRAME_COMPLETE;
 
         if (escSensorMotor < 4) {
@@ -328,7 +338,7 @@ void escSensorProcess(timeUs_t currentTimeUs)
             break;
         case ESC_SENSOR_TRIGGER_PENDING:
             if (currentTimeMs < escTriggerTimestamp + ESC_REQUEST_TIMEOUT) {
-                uint8_t state = decodeEscFrame();
+                uint8_t state = decodeEscFrame(currentTimeUs);
                 switch (state) {
                     case ESC_SENSOR_FRAME_COMPLETE:
                         selectNextMotor();
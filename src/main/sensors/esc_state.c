@@ -0,0 +1,205 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * One store for the state of each ESC, whichever way its telemetry arrives.
+ *
+ * Bidirectional DShot and the serial ESC sensor write the same fields in the same units. Each field has a preferred
+ * source, the other only fills the field while the preferred one does not keep it fresh, so two sources never
+ * alternate on one field.
+ *
+ * Each motor has a sequence count, odd while its writer is updating it. Readers copy the state and retry if the
+ * count was odd or changed meanwhile, so neither side takes a lock or masks interrupts.
+ *
+ * The eRPM of each motor is sampled into a short history along with the output the mixer commands. A motor that
+ * lost most of its speed within the history while its command stayed up, on consecutive samples, is flagged as
+ * desynchronised; a throttle cut or the motors a roll or yaw snap slows are commanded down and are not flagged.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
+
+#include "common/maths.h"
+
+#include "config/feature.h"
+
+#include "flight/mixer.h"
+
+#include "sensors/esc_state.h"
+
+#define ESC_STATE_READ_RETRIES 4
+
+// orders the state accesses against the sequence count, the targets are single core
+#define ESC_STATE_BARRIER() __asm__ volatile ("" : : : "memory")
+
+// DShot eRPM is received every loop, the serial sensor has the finer voltage and current and the consumption
+static const uint8_t escStatePreferredSource[ESC_STATE_FIELD_COUNT] = {
+    [ESC_STATE_ERPM]        = ESC_STATE_SOURCE_DSHOT,
+    [ESC_STATE_TEMPERATURE] = ESC_STATE_SOURCE_DSHOT,
+    [ESC_STATE_VOLTAGE]     = ESC_STATE_SOURCE_ESC_SENSOR,
+    [ESC_STATE_CURRENT]     = ESC_STATE_SOURCE_ESC_SENSOR,
+    [ESC_STATE_CONSUMPTION] = ESC_STATE_SOURCE_ESC_SENSOR,
+    [ESC_STATE_ERROR_RATE]  = ESC_STATE_SOURCE_DSHOT,
+};
+
+static escState_t escStates[MAX_SUPPORTED_MOTORS];
+static volatile uint32_t escStateSequence[MAX_SUPPORTED_MOTORS];
+
+void escStateReset(void)
+{
+    for (unsigned i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        escStateBeginUpdate(i);
+        memset(&escStates[i], 0, sizeof(escStates[i]));
+        ESC_STATE_BARRIER();
+        escStateSequence[i]++;
+    }
+}
+
+FAST_CODE void escStateBeginUpdate(uint8_t motorIndex)
+{
+    escStateSequence[motorIndex]++;
+    ESC_STATE_BARRIER();
+}
+
+FAST_CODE void escStateSet(uint8_t motorIndex, escStateField_e field, int32_t value, escStateSource_e source, timeUs_t currentTimeUs)
+{
+    escState_t *state = &escStates[motorIndex];
+    if (state->source[field] != source && state->source[field] != ESC_STATE_SOURCE_NONE
+        && source != escStatePreferredSource[field]
+        && cmpTimeUs(currentTimeUs, state->updatedUs[field]) < ESC_STATE_STALE_US) {
+        return;
+    }
+    state->data[field] = value;
+    state->updatedUs[field] = currentTimeUs;
+    state->source[field] = source;
+}
+
+static uint16_t motorCommandPermille(uint8_t motorIndex)
+{
+    const float low = getMotorOutputLow();
+    const float high = getMotorOutputHigh();
+    if (high <= low) {
+        return 0;
+    }
+    return lrintf(constrainf((motor[motorIndex] - low) / (high - low), 0.0f, 1.0f) * 1000);
+}
+
+// Whether the motor lost most of the speed of the fastest sample of the history, while its command was not lowered
+// enough to explain it at any sample since. The speed lags the command, so a command raised again does not count.
+static bool historyShowsDesync(const escState_t *state)
+{
+    if (state->historyCount < ESC_STATE_HISTORY_LENGTH) {
+        return false;
+    }
+    // oldest first
+    unsigned fastest = 0;
+    int32_t maxErpm = 0;
+    for (unsigned i = 0; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        const unsigned index = (state->historyIndex + i) % ESC_STATE_HISTORY_LENGTH;
+        if (state->erpmHistory[index] > maxErpm) {
+            maxErpm = state->erpmHistory[index];
+            fastest = i;
+        }
+    }
+    if (maxErpm < ESC_STATE_DESYNC_MIN_ERPM) {
+        return false;
+    }
+    const int32_t latest = state->erpmHistory[(state->historyIndex + ESC_STATE_HISTORY_LENGTH - 1) % ESC_STATE_HISTORY_LENGTH];
+    if (MAX(latest, 0) * 100 > maxErpm * (100 - ESC_STATE_DESYNC_DROP_PERCENT)) {
+        return false;
+    }
+
+    const uint32_t fastestCommand = state->commandHistory[(state->historyIndex + fastest) % ESC_STATE_HISTORY_LENGTH];
+    if (fastestCommand == 0) {
+        // not commanded, e.g. spun from the motor test or by the wind
+        return false;
+    }
+    for (unsigned i = fastest; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        const uint32_t command = state->commandHistory[(state->historyIndex + i) % ESC_STATE_HISTORY_LENGTH];
+        if (command * 100 < fastestCommand * (100 - ESC_STATE_DESYNC_COMMAND_PERCENT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void checkDesync(escState_t *state)
+{
+    // in 3D mode the output does not order the speed
+    if (featureIsEnabled(FEATURE_3D) || !historyShowsDesync(state)) {
+        state->desyncSamples = 0;
+        state->desync = false;
+        return;
+    }
+    if (state->desyncSamples < ESC_STATE_DESYNC_SAMPLES) {
+        state->desyncSamples++;
+    }
+    if (!state->desync && state->desyncSamples >= ESC_STATE_DESYNC_SAMPLES) {
+        state->desync = true;
+        state->desyncCount++;
+    }
+}
+
+FAST_CODE void escStateEndUpdate(uint8_t motorIndex, timeUs_t currentTimeUs)
+{
+    escState_t *state = &escStates[motorIndex];
+    if (state->source[ESC_STATE_ERPM] != ESC_STATE_SOURCE_NONE
+        && (state->historyCount == 0 || cmpTimeUs(currentTimeUs, state->historySampledUs) >= ESC_STATE_HISTORY_INTERVAL_US)) {
+        state->erpmHistory[state->historyIndex] = state->data[ESC_STATE_ERPM];
+        state->commandHistory[state->historyIndex] = motorCommandPermille(motorIndex);
+        state->historyIndex = (state->historyIndex + 1) % ESC_STATE_HISTORY_LENGTH;
+        state->historyCount = MIN(state->historyCount + 1, ESC_STATE_HISTORY_LENGTH);
+        state->historySampledUs = currentTimeUs;
+        checkDesync(state);
+    }
+    ESC_STATE_BARRIER();
+    escStateSequence[motorIndex]++;
+}
+
+bool escStateRead(uint8_t motorIndex, escState_t *state)
+{
+    if (motorIndex >= MAX_SUPPORTED_MOTORS) {
+        return false;
+    }
+    for (unsigned retry = 0; retry < ESC_STATE_READ_RETRIES; retry++) {
+        const uint32_t sequence = escStateSequence[motorIndex];
+        ESC_STATE_BARRIER();
+        *state = escStates[motorIndex];
+        ESC_STATE_BARRIER();
+        if (!(sequence & 1) && sequence == escStateSequence[motorIndex]) {
+            for (unsigned i = 0; i < ESC_STATE_FIELD_COUNT; i++) {
+                if (escStateHasField(state, i)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+#endif // USE_ESC_SENSOR || USE_DSHOT_TELEMETRY
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#define ESC_STATE_STALE_US              500000  // another source takes over a field not updated for this long
+#define ESC_STATE_HISTORY_LENGTH        8
+#define ESC_STATE_HISTORY_INTERVAL_US   10000   // the history covers the last 80ms
+#define ESC_STATE_DESYNC_MIN_ERPM       50      // 5000 eRPM, slower motors are not checked
+#define ESC_STATE_DESYNC_DROP_PERCENT   50      // speed lost by the motor within the history
+#define ESC_STATE_DESYNC_COMMAND_PERCENT 25     // a command lowered by this much since the fastest sample explains the loss
+#define ESC_STATE_DESYNC_SAMPLES        2       // consecutive samples
+
+typedef enum {
+    ESC_STATE_SOURCE_NONE = 0,
+    ESC_STATE_SOURCE_DSHOT,                     // bidirectional DShot, eRPM and extended telemetry
+    ESC_STATE_SOURCE_ESC_SENSOR,                // serial ESC telemetry
+} escStateSource_e;
+
+typedef enum {
+    ESC_STATE_ERPM = 0,                         // eRPM / 100, as sent by the ESC
+    ESC_STATE_TEMPERATURE,                      // degrees C
+    ESC_STATE_VOLTAGE,                          // 0.01V
+    ESC_STATE_CURRENT,                          // 0.01A
+    ESC_STATE_CONSUMPTION,                      // mAh
+    ESC_STATE_ERROR_RATE,                       // invalid telemetry frames, 0.01%
+    ESC_STATE_FIELD_COUNT
+} escStateField_e;
+
+typedef struct escState_s {
+    int32_t data[ESC_STATE_FIELD_COUNT];
+    timeUs_t updatedUs[ESC_STATE_FIELD_COUNT];
+    uint8_t source[ESC_STATE_FIELD_COUNT];      // escStateSource_e, ESC_STATE_SOURCE_NONE until the field is received
+    int32_t erpmHistory[ESC_STATE_HISTORY_LENGTH];  // oldest first once full
+    uint16_t commandHistory[ESC_STATE_HISTORY_LENGTH];  // motor output of the mixer at each sample, permille
+    uint8_t historyCount;
+    uint8_t historyIndex;                       // next sample to replace
+    timeUs_t historySampledUs;
+    uint8_t desyncSamples;
+    bool desync;                                // the motor lost speed it was not commanded to lose
+    uint16_t desyncCount;
+} escState_t;
+
+// The writer of a motor brackets its updates, readers then never see a half updated state.
+// Each motor has a single writer at a time: an interrupt or a task, never an interrupt preempting a task writing it.
+void escStateBeginUpdate(uint8_t motorIndex);
+void escStateSet(uint8_t motorIndex, escStateField_e field, int32_t value, escStateSource_e source, timeUs_t currentTimeUs);
+void escStateEndUpdate(uint8_t motorIndex, timeUs_t currentTimeUs);
+
+// Copies a consistent snapshot of the motor. Returns false if the motor has no data, or if the
+// writer kept updating it, which only happens when called from an interrupt preempting the writer.
+bool escStateRead(uint8_t motorIndex, escState_t *state);
+
+static inline bool escStateHasField(const escState_t *state, escStateField_e field)
+{
+    return state->source[field] != ESC_STATE_SOURCE_NONE;
+}
+
+void escStateReset(void);
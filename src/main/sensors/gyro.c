@@ -41,6 +41,7 @@
 
 #include "drivers/bus_spi.h"
 #include "drivers/io.h"
+#include "drivers/system.h"
 
 #include "config/config.h"
 #include "fc/runtime_config.h"
@@ -95,7 +96,7 @@ STATIC_UNIT_TESTED gyroDev_t * const gyroDevPtr = &gyro.gyroSensor1.gyroDev;
 #define GYRO_OVERFLOW_TRIGGER_THRESHOLD 31980  // 97.5% full scale (1950dps for 2000dps gyro)
 #define GYRO_OVERFLOW_RESET_THRESHOLD 30340    // 92.5% full scale (1850dps for 2000dps gyro)
 
-PG_REGISTER_WITH_RESET_FN(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 9);
+PG_REGISTER_WITH_RESET_FN(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 10);
 
 #ifndef DEFAULT_GYRO_TO_USE
 #define DEFAULT_GYRO_TO_USE GYRO_CONFIG_USE_GYRO_1
@@ -130,6 +131,7 @@ void pgResetFn_gyroConfig(gyroConfig_t *gyroConfig)
     gyroConfig->gyro_lpf1_dyn_expo = 5;
     gyroConfig->simplified_gyro_filter = true;
     gyroConfig->simplified_gyro_filter_multiplier = SIMPLIFIED_TUNING_DEFAULT;
+    gyroConfig->gyro_fifo_depth = 0;
 }
 
 static bool isGyroSensorCalibrationComplete(const gyroSensor_t *gyroSensor)
@@ -162,7 +164,14 @@ static bool isOnFinalGyroCalibrationCycle(const gyroCalibration_t *gyroCalibrati
 
 static int32_t gyroCalculateCalibratingCycles(void)
 {
-    return (gyroConfig()->gyroCalibrationDuration * 10000) / gyro.sampleLooptime;
+    int32_t cycles = (gyroConfig()->gyroCalibrationDuration * 10000) / gyro.sampleLooptime;
+#ifdef USE_GYRO_FIFO
+    // sampleLooptime is the gyro task period, but in FIFO mode every sample of the burst is a calibration cycle
+    if (gyro.fifoDepth) {
+        cycles *= gyro.fifoDepth;
+    }
+#endif
+    return cycles;
 }
 
 static bool isOnFirstGyroCalibrationCycle(const gyroCalibration_t *gyroCalibration)
@@ -378,13 +387,8 @@ static FAST_CODE_NOINLINE void checkForYawSpin(timeUs_t currentTimeUs)
 }
 #endif // USE_YAW_SPIN_RECOVERY
 
-static FAST_CODE void gyroUpdateSensor(gyroSensor_t *gyroSensor)
+static FAST_CODE void gyroProcessSensorSample(gyroSensor_t *gyroSensor)
 {
-    if (!gyroSensor->gyroDev.readFn(&gyroSensor->gyroDev)) {
-        return;
-    }
-    gyroSensor->gyroDev.dataReady = false;
-
     if (isGyroSensorCalibrationComplete(gyroSensor)) {
         // move 16-bit gyro data into 32-bit variables to avoid overflows in calculations
 
@@ -408,8 +412,82 @@ static FAST_CODE void gyroUpdateSensor(gyroSensor_t *gyroSensor)
     }
 }
 
+static FAST_CODE void gyroUpdateSensor(gyroSensor_t *gyroSensor)
+{
+    if (!gyroSensor->gyroDev.readFn(&gyroSensor->gyroDev)) {
+        return;
+    }
+    gyroSensor->gyroDev.dataReady = false;
+
+    gyroProcessSensorSample(gyroSensor);
+}
+
+static FAST_CODE void gyroAccumulateSample(void)
+{
+    if (gyro.downsampleFilterEnabled) {
+        // using gyro lowpass 2 filter for downsampling
+        gyro.sampleSum[X] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[X], gyro.gyroADC[X]);
+        gyro.sampleSum[Y] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[Y], gyro.gyroADC[Y]);
+        gyro.sampleSum[Z] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[Z], gyro.gyroADC[Z]);
+    } else {
+        // using simple averaging for downsampling
+        gyro.sampleSum[X] += gyro.gyroADC[X];
+        gyro.sampleSum[Y] += gyro.gyroADC[Y];
+        gyro.sampleSum[Z] += gyro.gyroADC[Z];
+        gyro.sampleCount++;
+    }
+}
+
+#ifdef USE_GYRO_FIFO
+// Every sample of the FIFO burst goes through the downsampling stage, so nothing is lost by running the gyro task
+// slower than the sensor's output data rate
+static FAST_CODE void gyroUpdateFifo(gyroSensor_t *gyroSensor)
+{
+    gyroDev_t *gyroDev = &gyroSensor->gyroDev;
+
+    // The driver clears dataReady itself once it has claimed a completed burst
+    if (!gyroDev->readFn(gyroDev)) {
+        return;
+    }
+
+    if (gyroDev->fifoCount) {
+        static uint32_t lastFifoTimestamp;
+        DEBUG_SET(DEBUG_GYRO_FIFO, 1, clockCyclesToMicros(cmpTimeCycles(gyroDev->fifoTimestamp, lastFifoTimestamp)));
+        lastFifoTimestamp = gyroDev->fifoTimestamp;
+    } else {
+        // No burst has completed since the last update, so reuse the previous sample as a late register read would
+        gyroAccumulateSample();
+    }
+    DEBUG_SET(DEBUG_GYRO_FIFO, 0, gyroDev->fifoCount);
+
+    for (int i = 0; i < gyroDev->fifoCount; i++) {
+        gyroDev->gyroADCRaw[X] = gyroDev->fifoSamples[i][X];
+        gyroDev->gyroADCRaw[Y] = gyroDev->fifoSamples[i][Y];
+        gyroDev->gyroADCRaw[Z] = gyroDev->fifoSamples[i][Z];
+
+        gyroProcessSensorSample(gyroSensor);
+
+        if (isGyroSensorCalibrationComplete(gyroSensor)) {
+            gyro.gyroADC[X] = gyroDev->gyroADC.x * gyroDev->scale;
+            gyro.gyroADC[Y] = gyroDev->gyroADC.y * gyroDev->scale;
+            gyro.gyroADC[Z] = gyroDev->gyroADC.z * gyroDev->scale;
+        }
+
+        gyroAccumulateSample();
+    }
+}
+#endif
+
 FAST_CODE void gyroUpdate(void)
 {
+#ifdef USE_GYRO_FIFO
+    if (gyro.fifoDepth) {
+        // FIFO batching is only enabled for a single gyro, see gyroInitSensor()
+        gyroUpdateFifo(container_of(gyro.rawSensorDev, gyroSensor_t, gyroDev));
+        return;
+    }
+#endif
+
     switch (gyro.gyroToUse) {
     case GYRO_CONFIG_USE_GYRO_1:
         gyroUpdateSensor(&gyro.gyroSensor1);
@@ -440,18 +518,7 @@ FAST_CODE void gyroUpdate(void)
 #endif
     }
 
-    if (gyro.downsampleFilterEnabled) {
-        // using gyro lowpass 2 filter for downsampling
-        gyro.sampleSum[X] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[X], gyro.gyroADC[X]);
-        gyro.sampleSum[Y] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[Y], gyro.gyroADC[Y]);
-        gyro.sampleSum[Z] = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[Z], gyro.gyroADC[Z]);
-    } else {
-        // using simple averaging for downsampling
-        gyro.sampleSum[X] += gyro.gyroADC[X];
-        gyro.sampleSum[Y] += gyro.gyroADC[Y];
-        gyro.sampleSum[Z] += gyro.gyroADC[Z];
-        gyro.sampleCount++;
-    }
+    gyroAccumulateSample();
 }
 
 #define GYRO_FILTER_FUNCTION_NAME filterGyro
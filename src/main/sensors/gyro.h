@@ -113,6 +113,9 @@ typedef struct gyro_s {
     biquadFilter_t notchFilter2[XYZ_AXIS_COUNT];
 
     uint16_t accSampleRateHz;
+#ifdef USE_GYRO_FIFO
+    uint8_t fifoDepth;                 // sensor samples read per gyro task, 0 if the FIFO isn't used
+#endif
     uint8_t gyroToUse;
     uint8_t gyroDebugMode;
     bool gyroHasOverflowProtection;
@@ -198,6 +201,7 @@ typedef struct gyroConfig_s {
     uint8_t gyro_lpf1_dyn_expo; // set the curve for dynamic gyro lowpass filter
     uint8_t simplified_gyro_filter;
     uint8_t simplified_gyro_filter_multiplier;
+    uint8_t gyro_fifo_depth;            // samples batched in the sensor FIFO per read, 0 to read every sample on its own
 } gyroConfig_t;
 
 PG_DECLARE(gyroConfig_t, gyroConfig);
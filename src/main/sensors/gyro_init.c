@@ -247,11 +247,19 @@ void gyroInitFilters(void)
       gyro.targetLooptime
     );
 
+    // The downsampling filter is applied to every sensor sample, several of which are read per gyro task in FIFO mode
+    uint32_t sensorSampleLooptime = gyro.sampleLooptime;
+#ifdef USE_GYRO_FIFO
+    if (gyro.fifoDepth) {
+        sensorSampleLooptime /= gyro.fifoDepth;
+    }
+#endif
+
     gyro.downsampleFilterEnabled = gyroInitLowpassFilterLpf(
       FILTER_LPF2,
       gyroConfig()->gyro_lpf2_type,
       gyroConfig()->gyro_lpf2_static_hz,
-      gyro.sampleLooptime
+      sensorSampleLooptime
     );
 
     gyroInitFilterNotch1(gyroConfig()->gyro_soft_notch_hz_1, gyroConfig()->gyro_soft_notch_cutoff_1);
@@ -288,6 +296,23 @@ static void gyroInitSensorFilters(gyroSensor_t *gyroSensor)
 #endif
 }
 
+#ifdef USE_GYRO_FIFO
+static bool gyroFifoSupported(const gyroDev_t *gyroDev)
+{
+    switch (gyroDev->gyroHardware) {
+    case GYRO_ICM42605:
+    case GYRO_ICM42688P:
+    case GYRO_IIM42653:
+    case GYRO_BMI270:
+    case GYRO_LSM6DSV16X:
+        return gyroDev->fifoBuf != NULL;
+
+    default:
+        return false;
+    }
+}
+#endif
+
 void gyroInitSensor(gyroSensor_t *gyroSensor, const gyroDeviceConfig_t *config)
 {
     gyroSensor->gyroDev.gyro_high_fsr = gyroConfig()->gyro_high_fsr;
@@ -295,6 +320,12 @@ void gyroInitSensor(gyroSensor_t *gyroSensor, const gyroDeviceConfig_t *config)
     buildRotationMatrixFromAngles(&gyroSensor->gyroDev.rotationMatrix, &config->customAlignment);
     gyroSensor->gyroDev.mpuIntExtiTag = config->extiTag;
     gyroSensor->gyroDev.hardware_lpf = gyroConfig()->gyro_hardware_lpf;
+#ifdef USE_GYRO_FIFO
+    // The FIFOs of two sensors don't fill in step, so batching is limited to a single gyro
+    if (gyroConfig()->gyro_fifo_depth > 1 && gyro.gyroToUse != GYRO_CONFIG_USE_GYRO_BOTH && gyroFifoSupported(&gyroSensor->gyroDev)) {
+        gyroSensor->gyroDev.fifoDepth = MIN(gyroConfig()->gyro_fifo_depth, GYRO_FIFO_MAX_SAMPLES);
+    }
+#endif
 
     // The targetLooptime gets set later based on the active sensor's gyroSampleRateHz and pid_process_denom
     gyroSensor->gyroDev.gyroSampleRateHz = gyroSetSampleRate(&gyroSensor->gyroDev);
@@ -632,6 +663,10 @@ bool gyroInit(void)
         // SPI DMA buffer required per device
         gyro.gyroSensor2.gyroDev.dev.txBuf = gyroBuf2;
         gyro.gyroSensor2.gyroDev.dev.rxBuf = &gyroBuf2[GYRO_BUF_SIZE / 2];
+#ifdef USE_GYRO_FIFO
+        static DMA_DATA uint8_t gyroFifoBuf2[GYRO_FIFO_BUF_SIZE];
+        gyro.gyroSensor2.gyroDev.fifoBuf = gyroFifoBuf2;
+#endif
 
         gyroInitSensor(&gyro.gyroSensor2, gyroDeviceConfig(1));
         gyro.gyroHasOverflowProtection = gyro.gyroHasOverflowProtection && gyro.gyroSensor2.gyroDev.gyroHasOverflowProtection;
@@ -648,6 +683,10 @@ bool gyroInit(void)
         // SPI DMA buffer required per device
         gyro.gyroSensor1.gyroDev.dev.txBuf = gyroBuf1;
         gyro.gyroSensor1.gyroDev.dev.rxBuf = &gyroBuf1[GYRO_BUF_SIZE / 2];
+#ifdef USE_GYRO_FIFO
+        static DMA_DATA uint8_t gyroFifoBuf1[GYRO_FIFO_BUF_SIZE];
+        gyro.gyroSensor1.gyroDev.fifoBuf = gyroFifoBuf1;
+#endif
         gyroInitSensor(&gyro.gyroSensor1, gyroDeviceConfig(0));
         gyro.gyroHasOverflowProtection =  gyro.gyroHasOverflowProtection && gyro.gyroSensor1.gyroDev.gyroHasOverflowProtection;
         detectedSensors[SENSOR_INDEX_GYRO] = gyro.gyroSensor1.gyroDev.gyroHardware;
@@ -669,6 +708,9 @@ bool gyroInit(void)
     if (gyro.rawSensorDev) {
         gyro.sampleRateHz = gyro.rawSensorDev->gyroSampleRateHz;
         gyro.accSampleRateHz = gyro.rawSensorDev->accSampleRateHz;
+#ifdef USE_GYRO_FIFO
+        gyro.fifoDepth = gyro.rawSensorDev->fifoDepth;
+#endif
     } else {
         gyro.sampleRateHz = 0;
         gyro.accSampleRateHz = 0;
@@ -475,6 +475,12 @@
 #endif
 #endif
 
+// Batched reads of the gyro FIFO, see gyro_fifo_depth
+#if defined(USE_SPI_GYRO) && (defined(USE_GYRO_SPI_ICM42605) || defined(USE_GYRO_SPI_ICM42688P) || defined(USE_ACCGYRO_IIM42653) \
+    || defined(USE_ACCGYRO_BMI270) || defined(USE_ACCGYRO_LSM6DSV16X))
+#define USE_GYRO_FIFO
+#endif
+
 #ifndef SIMULATOR_BUILD
 #ifndef USE_ACC
 #define USE_ACC
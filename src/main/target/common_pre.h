@@ -248,6 +248,7 @@
 #define USE_ESCSERIAL_SIMONK
 #define USE_ALTITUDE_HOLD
 #define USE_POSITION_HOLD
+#define USE_NAV_FILTER
 
 #if !defined(USE_GPS)
 #define USE_GPS
@@ -383,6 +384,9 @@
 #define USE_BATTERY_VOLTAGE_SAG_COMPENSATION
 #define USE_SIMPLIFIED_TUNING
 #define USE_CRAFTNAME_MSGS
+#if TARGET_FLASH_SIZE > 512
+#define USE_SERIAL_STATS
+#endif
 
 #if !defined(CORE_BUILD)
 // CORE_BUILD is only hardware drivers, and the bare minimum
@@ -425,6 +429,9 @@
 #define USE_EXTENDED_CMS_MENUS
 #define USE_MSP_DISPLAYPORT
 #define USE_OSD_OVER_MSP_DISPLAYPORT
+#if TARGET_FLASH_SIZE > 512
+#define USE_MSP_DISPLAYPORT_DELTA
+#endif
 #define USE_OSD_ADJUSTMENTS
 #define USE_OSD_PROFILES
 #define USE_OSD_STICK_OVERLAY
@@ -490,3 +497,7 @@
 #if defined(USE_POSITION_HOLD) && !defined(USE_GPS)
 #error "USE_POSITION_HOLD requires USE_GPS to be defined"
 #endif
+
+#if defined(USE_NAV_FILTER) && !defined(USE_ACC)
+#error "USE_NAV_FILTER requires USE_ACC to be defined"
+#endif
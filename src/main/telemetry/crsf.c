@@ -69,6 +69,7 @@
 #include "sensors/barometer.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_sensors.h"
 #include "telemetry/msp_shared.h"
 
 #include "crsf.h"
@@ -76,6 +77,7 @@
 #define CRSF_CYCLETIME_US                   100000 // 100ms, 10 Hz
 #define CRSF_DEVICEINFO_VERSION             0x01
 #define CRSF_DEVICEINFO_PARAMETER_COUNT     0
+#define CRSF_FRAME_FLIGHT_MODE_PAYLOAD_SIZE_MAX 6 // four character mode, arming state and terminator
 
 #define CRSF_MSP_BUFFER_SIZE 96
 #define CRSF_MSP_LENGTH_OFFSET 1
@@ -83,6 +85,9 @@
 static bool crsfTelemetryEnabled;
 static bool deviceInfoReplyPending;
 static uint8_t crsfFrame[CRSF_FRAME_SIZE_MAX];
+// the device info reply does not change while running, it is built for the first ping and resent for the others
+static uint8_t deviceInfoFrame[CRSF_FRAME_SIZE_MAX];
+static uint8_t deviceInfoFrameSize;
 
 #if defined(USE_MSP_OVER_TELEMETRY)
 typedef struct mspBuffer_s {
@@ -682,6 +687,34 @@ static void crsfFrameDisplayPortChunk(sbuf_t *dst, sbuf_t *src, uint8_t batchId,
     *lengthPtr = sbufPtr(dst) - lengthPtr;
 }
 
+// Complete rows as [row][RLE encoded row], as many as fit in one frame. An encoded row is never
+// longer than the row itself as runs are only encoded from two characters up.
+static void crsfFrameDisplayPortRows(sbuf_t *dst, crsfDisplayPortScreen_t *screen)
+{
+    uint8_t *lengthPtr = sbufPtr(dst);
+    sbufWriteU8(dst, 0);
+    sbufWriteU8(dst, CRSF_FRAMETYPE_DISPLAYPORT_CMD);
+    sbufWriteU8(dst, CRSF_ADDRESS_RADIO_TRANSMITTER);
+    sbufWriteU8(dst, CRSF_ADDRESS_FLIGHT_CONTROLLER);
+    sbufWriteU8(dst, CRSF_DISPLAYPORT_SUBCMD_UPDATE_ROWS);
+    const uint8_t *dstEnd = sbufPtr(dst) + CRSF_DISPLAYPORT_MAX_CHUNK_LENGTH;
+    for (unsigned row = 0; row < screen->rows; row++) {
+        if (!(screen->dirtyRows & (1 << row))) {
+            continue;
+        }
+        if (dstEnd - sbufPtr(dst) < 1 + screen->cols) {
+            break;
+        }
+        sbuf_t rowBuf;
+        uint8_t *rowStart = (uint8_t *)&screen->buffer[row * screen->cols];
+        sbuf_t *src = sbufInit(&rowBuf, rowStart, rowStart + screen->cols);
+        sbufWriteU8(dst, row);
+        cRleEncodeStream(src, dst, dstEnd - sbufPtr(dst));
+        screen->dirtyRows &= ~(1 << row);
+    }
+    *lengthPtr = sbufPtr(dst) - lengthPtr;
+}
+
 static void crsfFrameDisplayPortClear(sbuf_t *dst)
 {
     uint8_t *lengthPtr = sbufPtr(dst);
@@ -695,21 +728,8 @@ static void crsfFrameDisplayPortClear(sbuf_t *dst)
 
 #endif
 
-// schedule array to decide how often each type of frame is sent
-typedef enum {
-    CRSF_FRAME_START_INDEX = 0,
-    CRSF_FRAME_ATTITUDE_INDEX = CRSF_FRAME_START_INDEX,
-    CRSF_FRAME_BARO_ALTITUDE_INDEX,
-    CRSF_FRAME_BATTERY_SENSOR_INDEX,
-    CRSF_FRAME_FLIGHT_MODE_INDEX,
-    CRSF_FRAME_GPS_INDEX,
-    CRSF_FRAME_VARIO_SENSOR_INDEX,
-    CRSF_FRAME_HEARTBEAT_INDEX,
-    CRSF_SCHEDULE_COUNT_MAX
-} crsfFrameTypeIndex_e;
-
+// frame slots per CRSF_CYCLETIME_US, the registered sensors share them
 static uint8_t crsfScheduleCount;
-static uint8_t crsfSchedule[CRSF_SCHEDULE_COUNT_MAX];
 
 #if defined(USE_MSP_OVER_TELEMETRY)
 
@@ -738,66 +758,76 @@ static void crsfSendMspResponse(uint8_t *payload, const uint8_t payloadSize)
 }
 #endif
 
-static void processCrsf(void)
+static bool crsfFrameSensor(sbuf_t *dst, telemetrySensorId_e id)
 {
-    if (!crsfRxIsTelemetryBufEmpty()) {
-        return; // do nothing if telemetry ouptut buffer is not empty yet.
-    }
-
-    static uint8_t crsfScheduleIndex = 0;
-
-    const uint8_t currentSchedule = crsfSchedule[crsfScheduleIndex];
-
-    sbuf_t crsfPayloadBuf;
-    sbuf_t *dst = &crsfPayloadBuf;
-
-    if (currentSchedule & BIT(CRSF_FRAME_ATTITUDE_INDEX)) {
-        crsfInitializeFrame(dst);
+    crsfInitializeFrame(dst);
+    switch (id) {
+    case TELEMETRY_SENSOR_ATTITUDE:
         crsfFrameAttitude(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #if defined(USE_BARO) && defined(USE_VARIO)
-    // send barometric altitude
-    if (currentSchedule & BIT(CRSF_FRAME_BARO_ALTITUDE_INDEX)) {
-        crsfInitializeFrame(dst);
+    case TELEMETRY_SENSOR_ALTITUDE:
+        // send barometric altitude
         crsfFrameAltitude(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #endif
-    if (currentSchedule & BIT(CRSF_FRAME_BATTERY_SENSOR_INDEX)) {
-        crsfInitializeFrame(dst);
+    case TELEMETRY_SENSOR_BATTERY:
         crsfFrameBatterySensor(dst);
-        crsfFinalize(dst);
-    }
-
-    if (currentSchedule & BIT(CRSF_FRAME_FLIGHT_MODE_INDEX)) {
-        crsfInitializeFrame(dst);
+        break;
+    case TELEMETRY_SENSOR_FLIGHT_MODE:
         crsfFrameFlightMode(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #ifdef USE_GPS
-    if (currentSchedule & BIT(CRSF_FRAME_GPS_INDEX)) {
-        crsfInitializeFrame(dst);
+    case TELEMETRY_SENSOR_GPS:
         crsfFrameGps(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #endif
 #ifdef USE_VARIO
-    if (currentSchedule & BIT(CRSF_FRAME_VARIO_SENSOR_INDEX)) {
-        crsfInitializeFrame(dst);
+    case TELEMETRY_SENSOR_VARIO:
         crsfFrameVarioSensor(dst);
-        crsfFinalize(dst);
-    }
+        break;
 #endif
+    default:
+        return false;
+    }
+    return true;
+}
+
+static void processCrsf(timeUs_t currentTimeUs)
+{
+    if (!crsfRxIsTelemetryBufEmpty()) {
+        return; // do nothing if telemetry ouptut buffer is not empty yet.
+    }
+
+    sbuf_t crsfPayloadBuf;
+    sbuf_t *dst = &crsfPayloadBuf;
+
+    // the due sensors whose frame has not changed give way to the next
+    telemetrySensorId_e id;
+    while ((id = telemetrySensorNext(currentTimeUs, CRSF_FRAME_SIZE_MAX)) != TELEMETRY_SENSOR_NONE) {
+        if (!crsfFrameSensor(dst, id)) {
+            break;
+        }
+        if (telemetrySensorCommit(id, currentTimeUs, crsfFrame, dst->ptr - crsfFrame, false)) {
+            crsfFinalize(dst);
+            return;
+        }
+    }
+
+    // nothing due, the slot carries the sensor sent longest ago
+    id = telemetrySensorStalest(currentTimeUs, CRSF_FRAME_SIZE_MAX);
+    if (crsfFrameSensor(dst, id)) {
+        telemetrySensorCommit(id, currentTimeUs, crsfFrame, dst->ptr - crsfFrame, true);
+    } else {
 #if defined(USE_CRSF_V3)
-    if (currentSchedule & BIT(CRSF_FRAME_HEARTBEAT_INDEX)) {
+        // keep telemetry/heartbeat frames going at minimum 50Hz
         crsfInitializeFrame(dst);
         crsfFrameHeartbeat(dst);
-        crsfFinalize(dst);
-    }
+#else
+        return;
 #endif
-
-    crsfScheduleIndex = (crsfScheduleIndex + 1) % crsfScheduleCount;
+    }
+    crsfFinalize(dst);
 }
 
 void crsfScheduleDeviceInfoResponse(void)
@@ -835,46 +865,45 @@ void initCrsfTelemetry(void)
     }
 
     deviceInfoReplyPending = false;
+    deviceInfoFrameSize = 0;
 #if defined(USE_MSP_OVER_TELEMETRY)
     mspReplyPending = false;
 #endif
 
-    int index = 0;
+    telemetrySensorsReset();
     if (sensors(SENSOR_ACC) && telemetryIsSensorEnabled(SENSOR_PITCH | SENSOR_ROLL | SENSOR_HEADING)) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_ATTITUDE_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
 #if defined(USE_BARO) && defined(USE_VARIO)
     if (telemetryIsSensorEnabled(SENSOR_ALTITUDE)) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_BARO_ALTITUDE_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_ALTITUDE, CRSF_FRAME_BARO_ALTITUDE_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
 #endif
     if ((isBatteryVoltageConfigured() && telemetryIsSensorEnabled(SENSOR_VOLTAGE))
         || (isAmperageConfigured() && telemetryIsSensorEnabled(SENSOR_CURRENT | SENSOR_FUEL))) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_BATTERY_SENSOR_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
     if (telemetryIsSensorEnabled(SENSOR_MODE)) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_FLIGHT_MODE_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_FLIGHT_MODE, CRSF_FRAME_FLIGHT_MODE_PAYLOAD_SIZE_MAX + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
 #ifdef USE_GPS
     if (featureIsEnabled(FEATURE_GPS)
        && telemetryIsSensorEnabled(SENSOR_ALTITUDE | SENSOR_LAT_LONG | SENSOR_GROUND_SPEED | SENSOR_HEADING)) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_GPS_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_GPS, CRSF_FRAME_GPS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
 #endif
 #ifdef USE_VARIO
     if ((sensors(SENSOR_BARO) || featureIsEnabled(FEATURE_GPS)) && telemetryIsSensorEnabled(SENSOR_VARIO)) {
-        crsfSchedule[index++] = BIT(CRSF_FRAME_VARIO_SENSOR_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_VARIO, CRSF_FRAME_VARIO_SENSOR_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_NON_PAYLOAD);
     }
 #endif
 
+    int slotCount = telemetrySensorsRegisteredCount();
 #if defined(USE_CRSF_V3)
-    while (index < (CRSF_CYCLETIME_US / CRSF_TELEMETRY_FRAME_INTERVAL_MAX_US) && index < CRSF_SCHEDULE_COUNT_MAX) {
-        // schedule heartbeat to ensure that telemetry/heartbeat frames are sent at minimum 50Hz
-        crsfSchedule[index++] = BIT(CRSF_FRAME_HEARTBEAT_INDEX);
-    }
+    // slots left over by the sensors carry heartbeats
+    slotCount = MAX(slotCount, CRSF_CYCLETIME_US / CRSF_TELEMETRY_FRAME_INTERVAL_MAX_US);
 #endif
-
-    crsfScheduleCount = (uint8_t)index;
+    crsfScheduleCount = (uint8_t)MAX(slotCount, 1);
 
 #if defined(USE_CRSF_CMS_TELEMETRY)
     crsfDisplayportRegister();
@@ -887,14 +916,16 @@ bool checkCrsfTelemetryState(void)
 }
 
 #if defined(USE_CRSF_CMS_TELEMETRY)
-void crsfProcessDisplayPortCmd(uint8_t *frameStart)
+void crsfProcessDisplayPortCmd(uint8_t *frameStart, uint8_t length)
 {
     uint8_t cmd = *frameStart;
     switch (cmd) {
     case CRSF_DISPLAYPORT_SUBCMD_OPEN: ;
         const uint8_t rows = *(frameStart + CRSF_DISPLAYPORT_OPEN_ROWS_OFFSET);
         const uint8_t cols = *(frameStart + CRSF_DISPLAYPORT_OPEN_COLS_OFFSET);
+        const uint8_t flags = (length > CRSF_DISPLAYPORT_OPEN_FLAGS_OFFSET) ? *(frameStart + CRSF_DISPLAYPORT_OPEN_FLAGS_OFFSET) : 0;
         crsfDisplayPortSetDimensions(rows, cols);
+        crsfDisplayPortSetRowUpdates(flags & CRSF_DISPLAYPORT_OPEN_FLAG_ROW_UPDATES);
         crsfDisplayPortMenuOpen();
         break;
     case CRSF_DISPLAYPORT_SUBCMD_CLOSE:
@@ -965,11 +996,17 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
 #endif
 
     if (deviceInfoReplyPending) {
-        sbuf_t crsfPayloadBuf;
-        sbuf_t *dst = &crsfPayloadBuf;
-        crsfInitializeFrame(dst);
-        crsfFrameDeviceInfo(dst);
-        crsfFinalize(dst);
+        if (deviceInfoFrameSize) {
+            crsfRxWriteTelemetryData(deviceInfoFrame, deviceInfoFrameSize);
+        } else {
+            sbuf_t crsfPayloadBuf;
+            sbuf_t *dst = &crsfPayloadBuf;
+            crsfInitializeFrame(dst);
+            crsfFrameDeviceInfo(dst);
+            crsfFinalize(dst);
+            deviceInfoFrameSize = sbufBytesRemaining(dst);
+            memcpy(deviceInfoFrame, crsfFrame, deviceInfoFrameSize);
+        }
         deviceInfoReplyPending = false;
         crsfLastCycleTime = currentTimeUs; // reset telemetry timing due to ad-hoc request
         return;
@@ -987,7 +1024,25 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
         return;
     }
 
-    if (crsfDisplayPortIsReady()) {
+    if (crsfDisplayPortIsReady() && crsfDisplayPortScreen()->rowUpdates) {
+        static timeUs_t rowsLastTimeUs;
+
+        crsfDisplayPortScreen()->updated = false;
+        if (crsfDisplayPortScreen()->dirtyRows &&
+            (cmpTimeUs(currentTimeUs, rowsLastTimeUs) > crsfDisplayPortChunkIntervalUs)) {
+            sbuf_t crsfDisplayPortBuf;
+            sbuf_t *dst = &crsfDisplayPortBuf;
+            crsfInitializeFrame(dst);
+            crsfFrameDisplayPortRows(dst, crsfDisplayPortScreen());
+            crsfFinalize(dst);
+            crsfRxSendTelemetryData();
+            rowsLastTimeUs = currentTimeUs;
+
+            crsfLastCycleTime = currentTimeUs;
+
+            return;
+        }
+    } else if (crsfDisplayPortIsReady()) {
         static uint8_t displayPortBatchId = 0;
         static sbuf_t displayPortSbuf;
         static sbuf_t *src = NULL;
@@ -1024,10 +1079,10 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
 #endif
 
     // Actual telemetry data only needs to be sent at a low frequency, ie 10Hz
-    // Spread out scheduled frames evenly so each frame is sent at the same frequency.
+    // Spread out the frame slots evenly, each slot sends the most overdue sensor.
     if (currentTimeUs >= crsfLastCycleTime + (CRSF_CYCLETIME_US / crsfScheduleCount)) {
         crsfLastCycleTime = currentTimeUs;
-        processCrsf();
+        processCrsf(currentTimeUs);
     }
 }
 
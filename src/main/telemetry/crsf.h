@@ -39,7 +39,7 @@ void crsfHandleDeviceInfoResponse(uint8_t *payload);
 int getCrsfFrame(uint8_t *frame, crsfFrameType_e frameType);
 void crsfProcessCommand(uint8_t *frameStart);
 #if defined(USE_CRSF_CMS_TELEMETRY)
-void crsfProcessDisplayPortCmd(uint8_t *frameStart);
+void crsfProcessDisplayPortCmd(uint8_t *frameStart, uint8_t length);
 #endif
 #if defined(USE_MSP_OVER_TELEMETRY)
 void initCrsfMspBuffer(void);
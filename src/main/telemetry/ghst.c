@@ -62,6 +62,7 @@
 #include "sensors/sensors.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_sensors.h"
 #include "telemetry/msp_shared.h"
 
 #include "telemetry/ghst.h"
@@ -204,18 +205,8 @@ static void ghstFrameMagBaro(sbuf_t *dst)
     sbufWriteU8(dst, flags);
 }
 
-// schedule array to decide how often each type of frame is sent
-typedef enum {
-    GHST_FRAME_START_INDEX = 0,
-    GHST_FRAME_PACK_INDEX = GHST_FRAME_START_INDEX, // Battery (Pack) data
-    GHST_FRAME_GPS_PRIMARY_INDEX,                   // GPS, primary values (Lat, Long, Alt)
-    GHST_FRAME_GPS_SECONDARY_INDEX,                 // GPS, secondary values (Sat Count, DOP, etc.)
-    GHST_FRAME_MAGBARO_INDEX,                       // Magnetometer/Baro values
-    GHST_SCHEDULE_COUNT_MAX
-} ghstFrameTypeIndex_e;
-
+// frame slots per GHST_CYCLETIME_US, the registered sensors share them
 static uint8_t ghstScheduleCount;
-static uint8_t ghstSchedule[GHST_SCHEDULE_COUNT_MAX];
 
 static bool mspReplyPending;
 
@@ -244,42 +235,53 @@ static void ghstSendMspResponse(uint8_t *payload, const uint8_t payloadSize)
 }
 #endif
 
-static void processGhst(void)
+static bool ghstFrameSensor(sbuf_t *dst, telemetrySensorId_e id)
 {
-    static uint8_t ghstScheduleIndex = 0;
-
-    const uint8_t currentSchedule = ghstSchedule[ghstScheduleIndex];
-
-    sbuf_t ghstPayloadBuf;
-    sbuf_t *dst = &ghstPayloadBuf;
-
-    if (currentSchedule & BIT(GHST_FRAME_PACK_INDEX)) {
-        ghstInitializeFrame(dst);
+    ghstInitializeFrame(dst);
+    switch (id) {
+    case TELEMETRY_SENSOR_BATTERY:
         ghstFramePackTelemetry(dst);
-        ghstFinalize(dst);
-    }
-
+        break;
 #if defined(USE_GPS)
-    if (currentSchedule & BIT(GHST_FRAME_GPS_PRIMARY_INDEX)) {
-        ghstInitializeFrame(dst);
+    case TELEMETRY_SENSOR_GPS:
         ghstFrameGpsPrimaryTelemetry(dst);
-        ghstFinalize(dst);
+        break;
+    case TELEMETRY_SENSOR_GPS_EXTRA:
+        ghstFrameGpsSecondaryTelemetry(dst);
+        break;
+#endif
+    case TELEMETRY_SENSOR_ALTITUDE:
+        ghstFrameMagBaro(dst);
+        break;
+    default:
+        return false;
     }
+    return true;
+}
 
-    if (currentSchedule & BIT(GHST_FRAME_GPS_SECONDARY_INDEX)) {
-        ghstInitializeFrame(dst);
-        ghstFrameGpsSecondaryTelemetry(dst);
-        ghstFinalize(dst);
+static void processGhst(timeUs_t currentTimeUs)
+{
+    sbuf_t ghstPayloadBuf;
+    sbuf_t *dst = &ghstPayloadBuf;
+
+    // the due sensors whose frame has not changed give way to the next
+    telemetrySensorId_e id;
+    while ((id = telemetrySensorNext(currentTimeUs, GHST_FRAME_SIZE)) != TELEMETRY_SENSOR_NONE) {
+        if (!ghstFrameSensor(dst, id)) {
+            break;
+        }
+        if (telemetrySensorCommit(id, currentTimeUs, ghstFrame, dst->ptr - ghstFrame, false)) {
+            ghstFinalize(dst);
+            return;
+        }
     }
-#endif
 
-    if (currentSchedule & BIT(GHST_FRAME_MAGBARO_INDEX)) {
-        ghstInitializeFrame(dst);
-        ghstFrameMagBaro(dst);
+    // nothing due, the slot carries the sensor sent longest ago
+    id = telemetrySensorStalest(currentTimeUs, GHST_FRAME_SIZE);
+    if (ghstFrameSensor(dst, id)) {
+        telemetrySensorCommit(id, currentTimeUs, ghstFrame, dst->ptr - ghstFrame, true);
         ghstFinalize(dst);
     }
-
-    ghstScheduleIndex = (ghstScheduleIndex + 1) % ghstScheduleCount;
 }
 
 void initGhstTelemetry(void)
@@ -295,33 +297,34 @@ void initGhstTelemetry(void)
     mspReplyPending = false;
 #endif
 
-    int index = 0;
+    telemetrySensorsReset();
     if ((isBatteryVoltageConfigured() && telemetryIsSensorEnabled(SENSOR_VOLTAGE))
         || (isAmperageConfigured() && telemetryIsSensorEnabled(SENSOR_CURRENT | SENSOR_FUEL))) {
-        ghstSchedule[index++] = BIT(GHST_FRAME_PACK_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, GHST_FRAME_SIZE);
     }
 
 #ifdef USE_GPS
     if (featureIsEnabled(FEATURE_GPS)
        && telemetryIsSensorEnabled(SENSOR_ALTITUDE | SENSOR_LAT_LONG)) {
-        ghstSchedule[index++] = BIT(GHST_FRAME_GPS_PRIMARY_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_GPS, GHST_FRAME_SIZE);
     }
 
     if (featureIsEnabled(FEATURE_GPS)
        && telemetryIsSensorEnabled(SENSOR_GROUND_SPEED | SENSOR_HEADING)) {
-        ghstSchedule[index++] = BIT(GHST_FRAME_GPS_SECONDARY_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_GPS_EXTRA, GHST_FRAME_SIZE);
      }
 #endif
 
 #if defined(USE_BARO) || defined(USE_MAG) || defined(USE_VARIO)
+    // the mag/baro frame is scheduled as the altitude sensor
     if ((sensors(SENSOR_BARO) && telemetryIsSensorEnabled(SENSOR_ALTITUDE))
         || (sensors(SENSOR_MAG) && telemetryIsSensorEnabled(SENSOR_HEADING))
         || (sensors(SENSOR_VARIO) && telemetryIsSensorEnabled(SENSOR_VARIO))) {
-        ghstSchedule[index++] = BIT(GHST_FRAME_MAGBARO_INDEX);
+        telemetrySensorRegister(TELEMETRY_SENSOR_ALTITUDE, GHST_FRAME_SIZE);
     }
 #endif
 
-    ghstScheduleCount = index;
+    ghstScheduleCount = MAX(telemetrySensorsRegisteredCount(), 1);
  }
 
 void setGhstTelemetryState(bool state)
@@ -357,7 +360,7 @@ void handleGhstTelemetry(timeUs_t currentTimeUs)
     // Ready to send telemetry?
     if (currentTimeUs >= ghstLastCycleTime + (GHST_CYCLETIME_US / ghstScheduleCount)) {
         ghstLastCycleTime = currentTimeUs;
-        processGhst();
+        processGhst(currentTimeUs);
     }
 
     // telemetry is sent from the Rx driver, ghstProcessFrame
@@ -36,6 +36,8 @@
 #include "common/color.h"
 #include "common/utils.h"
 
+#include "cli/settings.h"
+
 #include "config/feature.h"
 #include "pg/pg.h"
 #include "pg/pg_ids.h"
@@ -45,6 +47,10 @@
 #include "drivers/sensor.h"
 #include "drivers/time.h"
 
+#include "build/version.h"
+
+#include "scheduler/scheduler.h"
+
 #include "config/config.h"
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
@@ -71,6 +77,8 @@
 
 #include "telemetry/telemetry.h"
 #include "telemetry/mavlink.h"
+#include "telemetry/mavlink_frame.h"
+#include "telemetry/mavlink_params.h"
 
 // mavlink library uses unnames unions that's causes GCC to complain if -Wpedantic is used
 // until this is resolved in mavlink library - ignore -Wpedantic for mavlink code
@@ -79,9 +87,22 @@
 #include "common/mavlink.h"
 #pragma GCC diagnostic pop
 
-#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_TX
-#define TELEMETRY_MAVLINK_MAXRATE 50
-#define TELEMETRY_MAVLINK_DELAY ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
+#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_RXTX
+#define TELEMETRY_MAVLINK_MAXRATE 250 // telemetry task rate
+#define TELEMETRY_MAVLINK_MIN_INTERVAL_US ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
+
+#define MAVLINK_SYSTEM_ID 1
+#define MAVLINK_COMPONENT_ID 1 // MAV_COMP_ID_AUTOPILOT1
+
+// Not in the bundled MAVLink library
+#define MAV_CMD_GET_MESSAGE_INTERVAL 510
+#define MAV_CMD_SET_MESSAGE_INTERVAL 511
+#define MAV_PROTOCOL_CAPABILITY_MAVLINK2 8192
+#define MAVLINK_MSG_ID_MESSAGE_INTERVAL 244
+#define MAVLINK_MSG_ID_MESSAGE_INTERVAL_LEN 6
+#define MAVLINK_MSG_ID_MESSAGE_INTERVAL_CRC 95
+
+#define MAVLINK_STREAM_NONE 0xFF // not switched by data stream requests
 
 extern uint16_t rssi; // FIXME dependency on mw.c
 
@@ -89,51 +110,37 @@ static serialPort_t *mavlinkPort = NULL;
 static const serialPortConfig_t *portConfig;
 
 static bool mavlinkTelemetryEnabled =  false;
+static bool mavlinkPortShared = false;
 static portSharing_e mavlinkPortSharing;
 
-/* MAVLink datastream rates in Hz */
-static const uint8_t mavRates[] = {
-    [MAV_DATA_STREAM_EXTENDED_STATUS] = 2, //2Hz
-    [MAV_DATA_STREAM_RC_CHANNELS] = 5, //5Hz
-    [MAV_DATA_STREAM_POSITION] = 2, //2Hz
-    [MAV_DATA_STREAM_EXTRA1] = 10, //10Hz
-    [MAV_DATA_STREAM_EXTRA2] = 10 //2Hz
-};
-
-#define MAXSTREAMS ARRAYLEN(mavRates)
-
-static uint8_t mavTicks[MAXSTREAMS];
 static mavlink_message_t mavMsg;
-static uint8_t mavBuffer[MAVLINK_MAX_PACKET_LEN];
-static uint32_t lastMavlinkMessage = 0;
-
-static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
+static mavlinkFrameParser_t mavlinkParser;
+static uint8_t mavlinkVersion;
+static uint8_t mavlinkSeq;
+static int mavlinkParamListIndex = -1; // next parameter to send of a parameter list request
+static int mavlinkParamReplyIndex = -1; // parameter read or set whose reply did not fit in the transmit buffer
+
+// Sends the message packed in mavMsg, returns false if it does not fit in the transmit buffer
+static bool mavlinkSendMessage(uint8_t crcExtra)
 {
-    uint8_t rate = (uint8_t) mavRates[streamNum];
-    if (rate == 0) {
-        return 0;
+    const mavlinkFrame_t frame = {
+        .version = mavlinkVersion,
+        .seq = mavlinkSeq,
+        .systemId = MAVLINK_SYSTEM_ID,
+        .componentId = MAVLINK_COMPONENT_ID,
+        .msgId = mavMsg.msgid,
+        .length = mavMsg.len,
+        .payload = (const uint8_t *)_MAV_PAYLOAD(&mavMsg),
+    };
+
+    if (!mavlinkFrameWrite(mavlinkPort, &frame, crcExtra)) {
+        return false;
     }
-
-    if (mavTicks[streamNum] == 0) {
-        // we're triggering now, setup the next trigger point
-        if (rate > TELEMETRY_MAVLINK_MAXRATE) {
-            rate = TELEMETRY_MAVLINK_MAXRATE;
-        }
-
-        mavTicks[streamNum] = (TELEMETRY_MAVLINK_MAXRATE / rate);
-        return 1;
-    }
-
-    // count down at TASK_RATE_HZ
-    mavTicks[streamNum]--;
-    return 0;
+    mavlinkSeq++;
+    return true;
 }
 
-static void mavlinkSerialWrite(uint8_t * buf, uint16_t length)
-{
-    for (int i = 0; i < length; i++)
-        serialWrite(mavlinkPort, buf[i]);
-}
+static void mavlinkInitLink(void);
 
 static int16_t headingOrScaledMilliAmpereHoursDrawn(void)
 {
@@ -176,6 +183,8 @@ void configureMAVLinkTelemetryPort(void)
         return;
     }
 
+    mavlinkPortShared = false;
+    mavlinkInitLink();
     mavlinkTelemetryEnabled = true;
 }
 
@@ -183,7 +192,10 @@ void checkMAVLinkTelemetryState(void)
 {
     if (portConfig && telemetryCheckRxPortShared(portConfig, rxRuntimeState.serialrxProvider)) {
         if (!mavlinkTelemetryEnabled && telemetrySharedPort != NULL) {
+            // the receiver reads the port, nothing is received
             mavlinkPort = telemetrySharedPort;
+            mavlinkPortShared = true;
+            mavlinkInitLink();
             mavlinkTelemetryEnabled = true;
         }
     } else {
@@ -200,10 +212,8 @@ void checkMAVLinkTelemetryState(void)
     }
 }
 
-static void mavlinkSendSystemStatus(void)
+static bool mavlinkSendSystemStatus(void)
 {
-    uint16_t msgLength;
-
     uint32_t onboardControlAndSensors = 35843;
 
     /*
@@ -230,7 +240,7 @@ static void mavlinkSendSystemStatus(void)
         batteryRemaining = isBatteryVoltageConfigured() ? calculateBatteryPercentageRemaining() : batteryRemaining;
     }
 
-    mavlink_msg_sys_status_pack(0, 200, &mavMsg,
+    mavlink_msg_sys_status_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // onboard_control_sensors_present Bitmask showing which onboard controllers and sensors are present.
         //Value of 0: not present. Value of 1: present. Indices: 0: 3D gyro, 1: 3D acc, 2: 3D mag, 3: absolute pressure,
         // 4: differential pressure, 5: GPS, 6: optical flow, 7: computer vision position, 8: laser based position,
@@ -261,14 +271,12 @@ static void mavlinkSendSystemStatus(void)
         0,
         // errors_count4 Autopilot-specific errors
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_SYS_STATUS_CRC);
 }
 
-static void mavlinkSendRCChannelsAndRSSI(void)
+static bool mavlinkSendRCChannelsAndRSSI(void)
 {
-    uint16_t msgLength;
-    mavlink_msg_rc_channels_raw_pack(0, 200, &mavMsg,
+    mavlink_msg_rc_channels_raw_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // port Servo output port (set of 8 outputs = 1 port). Most MAVs will just use one, but this allows to encode more than 8 servos.
@@ -291,18 +299,16 @@ static void mavlinkSendRCChannelsAndRSSI(void)
         (rxRuntimeState.channelCount >= 8) ? rcData[7] : 0,
         // rssi Receive signal strength indicator, 0: 0%, 254: 100%
         scaleRange(getRssi(), 0, RSSI_MAX_VALUE, 0, 254));
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_RC_CHANNELS_RAW_CRC);
 }
 
 #if defined(USE_GPS)
-static void mavlinkSendPosition(void)
+static bool mavlinkSendGpsRawInt(void)
 {
-    uint16_t msgLength;
     uint8_t gpsFixType = 0;
 
     if (!sensors(SENSOR_GPS))
-        return;
+        return true;
 
     if (!STATE(GPS_FIX)) {
         gpsFixType = 1;
@@ -316,7 +322,7 @@ static void mavlinkSendPosition(void)
         }
     }
 
-    mavlink_msg_gps_raw_int_pack(0, 200, &mavMsg,
+    mavlink_msg_gps_raw_int_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_usec Timestamp (microseconds since UNIX epoch or microseconds since system boot)
         micros(),
         // fix_type 0-1: no fix, 2: 2D fix, 3: 3D fix. Some applications will not use the value of this field unless it is at least two, so always correctly fill in the fix.
@@ -337,11 +343,15 @@ static void mavlinkSendPosition(void)
         gpsSol.groundCourse * 10,
         // satellites_visible Number of satellites visible. If unknown, set to 255
         gpsSol.numSat);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_GPS_RAW_INT_CRC);
+}
 
-    // Global position
-    mavlink_msg_global_position_int_pack(0, 200, &mavMsg,
+static bool mavlinkSendGlobalPosition(void)
+{
+    if (!sensors(SENSOR_GPS))
+        return true;
+
+    mavlink_msg_global_position_int_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_usec Timestamp (microseconds since UNIX epoch or microseconds since system boot)
         micros(),
         // lat Latitude in 1E7 degrees
@@ -361,25 +371,28 @@ static void mavlinkSendPosition(void)
         // heading Current heading in degrees, in compass units (0..360, 0=north)
         headingOrScaledMilliAmpereHoursDrawn()
     );
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_GLOBAL_POSITION_INT_CRC);
+}
+
+static bool mavlinkSendGpsGlobalOrigin(void)
+{
+    if (!sensors(SENSOR_GPS))
+        return true;
 
-    mavlink_msg_gps_global_origin_pack(0, 200, &mavMsg,
+    mavlink_msg_gps_global_origin_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // latitude Latitude (WGS84), expressed as * 1E7
         GPS_home_llh.lat,
         // longitude Longitude (WGS84), expressed as * 1E7
         GPS_home_llh.lon,
         // altitude Altitude(WGS84), expressed as * 1000
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN_CRC);
 }
 #endif
 
-static void mavlinkSendAttitude(void)
+static bool mavlinkSendAttitude(void)
 {
-    uint16_t msgLength;
-    mavlink_msg_attitude_pack(0, 200, &mavMsg,
+    mavlink_msg_attitude_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // roll Roll angle (rad)
@@ -394,13 +407,11 @@ static void mavlinkSendAttitude(void)
         0,
         // yawspeed Yaw angular speed (rad/s)
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_ATTITUDE_CRC);
 }
 
-static void mavlinkSendHUDAndHeartbeat(void)
+static bool mavlinkSendHUD(void)
 {
-    uint16_t msgLength;
     float mavAltitude = 0;
     float mavGroundSpeed = 0;
     float mavAirSpeed = 0;
@@ -415,7 +426,7 @@ static void mavlinkSendHUDAndHeartbeat(void)
 
     mavAltitude = getEstimatedAltitudeCm() / 100.0;
 
-    mavlink_msg_vfr_hud_pack(0, 200, &mavMsg,
+    mavlink_msg_vfr_hud_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // airspeed Current airspeed in m/s
         mavAirSpeed,
         // groundspeed Current ground speed in m/s
@@ -428,9 +439,11 @@ static void mavlinkSendHUDAndHeartbeat(void)
         mavAltitude,
         // climb Current climb rate in meters/second
         mavClimbRate);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_VFR_HUD_CRC);
+}
 
+static bool mavlinkSendHeartbeat(void)
+{
     uint8_t mavModes = MAV_MODE_FLAG_MANUAL_INPUT_ENABLED;
     if (ARMING_FLAG(ARMED))
         mavModes |= MAV_MODE_FLAG_SAFETY_ARMED;
@@ -493,7 +506,7 @@ static void mavlinkSendHUDAndHeartbeat(void)
         mavSystemState = MAV_STATE_STANDBY;
     }
 
-    mavlink_msg_heartbeat_pack(0, 200, &mavMsg,
+    mavlink_msg_heartbeat_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // type Type of the MAV (quadrotor, helicopter, etc., up to 15 types, defined in MAV_TYPE ENUM)
         mavSystemType,
         // autopilot Autopilot type / class. defined in MAV_AUTOPILOT ENUM
@@ -504,37 +517,430 @@ static void mavlinkSendHUDAndHeartbeat(void)
         mavCustomMode,
         // system_status System status flag, see MAV_STATE ENUM
         mavSystemState);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_HEARTBEAT_CRC);
+}
+
+
+static bool mavlinkSendAttitudeQuaternion(void)
+{
+    float q[4];
+    mavlink_euler_to_quaternion(DECIDEGREES_TO_RADIANS(attitude.values.roll), DECIDEGREES_TO_RADIANS(-attitude.values.pitch), DECIDEGREES_TO_RADIANS(attitude.values.yaw), q);
+
+    mavlink_msg_attitude_quaternion_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        // time_boot_ms Timestamp (milliseconds since system boot)
+        millis(),
+        // q1 Quaternion component 1, w (1 in null-rotation)
+        q[0],
+        // q2 Quaternion component 2, x (0 in null-rotation)
+        q[1],
+        // q3 Quaternion component 3, y (0 in null-rotation)
+        q[2],
+        // q4 Quaternion component 4, z (0 in null-rotation)
+        q[3],
+        // rollspeed Roll angular speed (rad/s)
+        DEGREES_TO_RADIANS(gyro.gyroADCf[FD_ROLL]),
+        // pitchspeed Pitch angular speed (rad/s)
+        DEGREES_TO_RADIANS(-gyro.gyroADCf[FD_PITCH]),
+        // yawspeed Yaw angular speed (rad/s)
+        DEGREES_TO_RADIANS(gyro.gyroADCf[FD_YAW]));
+    return mavlinkSendMessage(MAVLINK_MSG_ID_ATTITUDE_QUATERNION_CRC);
+}
+
+static bool mavlinkSendHighresImu(void)
+{
+    const float accScale = acc.dev.acc_1G_rec * G_ACCELERATION;
+    uint16_t fieldsUpdated = 0x003F; // acc and gyro
+    float pressure = 0;
+    float pressureAltitude = 0;
+    float temperature = 0;
+
+#if defined(USE_BARO)
+    if (sensors(SENSOR_BARO)) {
+        pressure = baro.pressure / 100.0f;
+        pressureAltitude = baro.altitude / 100.0f;
+        temperature = baro.temperature / 100.0f;
+        fieldsUpdated |= 0x1A00; // abs_pressure, pressure_alt and temperature
+    }
+#endif
+
+    mavlink_msg_highres_imu_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        // time_usec Timestamp (microseconds since system boot)
+        micros(),
+        // xacc, yacc, zacc Acceleration (m/s^2)
+        acc.accADC.x * accScale,
+        acc.accADC.y * accScale,
+        acc.accADC.z * accScale,
+        // xgyro, ygyro, zgyro Angular speed (rad/s)
+        DEGREES_TO_RADIANS(gyro.gyroADCf[X]),
+        DEGREES_TO_RADIANS(gyro.gyroADCf[Y]),
+        DEGREES_TO_RADIANS(gyro.gyroADCf[Z]),
+        // xmag, ymag, zmag Magnetic field (Gauss), not sent
+        0, 0, 0,
+        // abs_pressure Absolute pressure (millibar)
+        pressure,
+        // diff_pressure Differential pressure (millibar)
+        0,
+        // pressure_alt Altitude calculated from pressure (m)
+        pressureAltitude,
+        // temperature Temperature (degrees celsius)
+        temperature,
+        // fields_updated Bitmask of the fields updated since the last message
+        fieldsUpdated);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_HIGHRES_IMU_CRC);
+}
+
+typedef struct mavlinkMessage_s {
+    uint32_t msgId;
+    uint8_t stream;                 // MAV_DATA_STREAM switching the message, MAVLINK_STREAM_NONE if none
+    uint8_t defaultRateHz;          // 0 for off until requested
+    bool (*send)(void);             // returns false if the message did not fit in the transmit buffer
+} mavlinkMessage_t;
+
+static const mavlinkMessage_t mavlinkMessages[] = {
+    { MAVLINK_MSG_ID_HEARTBEAT,           MAVLINK_STREAM_NONE,              10, mavlinkSendHeartbeat },
+    { MAVLINK_MSG_ID_SYS_STATUS,          MAV_DATA_STREAM_EXTENDED_STATUS,  2,  mavlinkSendSystemStatus },
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW,     MAV_DATA_STREAM_RC_CHANNELS,      5,  mavlinkSendRCChannelsAndRSSI },
+#if defined(USE_GPS)
+    { MAVLINK_MSG_ID_GPS_RAW_INT,         MAV_DATA_STREAM_POSITION,         2,  mavlinkSendGpsRawInt },
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, MAV_DATA_STREAM_POSITION,         2,  mavlinkSendGlobalPosition },
+    { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,   MAV_DATA_STREAM_POSITION,         2,  mavlinkSendGpsGlobalOrigin },
+#endif
+    { MAVLINK_MSG_ID_ATTITUDE,            MAV_DATA_STREAM_EXTRA1,           10, mavlinkSendAttitude },
+    { MAVLINK_MSG_ID_ATTITUDE_QUATERNION, MAV_DATA_STREAM_EXTRA1,           0,  mavlinkSendAttitudeQuaternion },
+    { MAVLINK_MSG_ID_VFR_HUD,             MAV_DATA_STREAM_EXTRA2,           10, mavlinkSendHUD },
+    { MAVLINK_MSG_ID_HIGHRES_IMU,         MAV_DATA_STREAM_RAW_SENSORS,      0,  mavlinkSendHighresImu },
+};
+
+#define MAVLINK_MESSAGE_COUNT ARRAYLEN(mavlinkMessages)
+
+static timeDelta_t mavlinkIntervalUs[MAVLINK_MESSAGE_COUNT];   // 0 when the message is off
+static timeUs_t mavlinkDueUs[MAVLINK_MESSAGE_COUNT];
+
+static int mavlinkMessageIndex(uint32_t msgId)
+{
+    for (unsigned i = 0; i < MAVLINK_MESSAGE_COUNT; i++) {
+        if (mavlinkMessages[i].msgId == msgId) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-static void processMAVLinkTelemetry(void)
+static timeDelta_t mavlinkRateToInterval(uint16_t rateHz)
 {
-    // is executed @ TELEMETRY_MAVLINK_MAXRATE rate
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTENDED_STATUS)) {
-        mavlinkSendSystemStatus();
+    if (rateHz == 0) {
+        return 0;
     }
+    return MAX(1000000 / rateHz, TELEMETRY_MAVLINK_MIN_INTERVAL_US);
+}
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_RC_CHANNELS)) {
-        mavlinkSendRCChannelsAndRSSI();
+static void mavlinkSetInterval(int index, timeDelta_t intervalUs)
+{
+    if (intervalUs > 0) {
+        intervalUs = MAX(intervalUs, TELEMETRY_MAVLINK_MIN_INTERVAL_US);
     }
+    mavlinkIntervalUs[index] = intervalUs;
+    mavlinkDueUs[index] = micros();
+}
 
-#ifdef USE_GPS
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_POSITION)) {
-        mavlinkSendPosition();
+static void mavlinkResetIntervals(void)
+{
+    for (unsigned i = 0; i < MAVLINK_MESSAGE_COUNT; i++) {
+        mavlinkSetInterval(i, mavlinkRateToInterval(mavlinkMessages[i].defaultRateHz));
+    }
+}
+
+static void processMAVLinkTelemetry(timeUs_t currentTimeUs)
+{
+    for (unsigned i = 0; i < MAVLINK_MESSAGE_COUNT; i++) {
+        if (mavlinkIntervalUs[i] == 0 || cmpTimeUs(currentTimeUs, mavlinkDueUs[i]) < 0) {
+            continue;
+        }
+
+        if (!mavlinkMessages[i].send()) {
+            // the transmit buffer is full, the rest is sent on the next call
+            return;
+        }
+
+        mavlinkDueUs[i] += mavlinkIntervalUs[i];
+        if (cmpTimeUs(currentTimeUs, mavlinkDueUs[i]) >= 0) {
+            // fallen behind, do not try to catch up
+            mavlinkDueUs[i] = currentTimeUs + mavlinkIntervalUs[i];
+        }
+    }
+}
+
+static int mavlinkCrcExtra(uint32_t msgId)
+{
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+        return MAVLINK_MSG_ID_HEARTBEAT_CRC;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        return MAVLINK_MSG_ID_PARAM_REQUEST_READ_CRC;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        return MAVLINK_MSG_ID_PARAM_REQUEST_LIST_CRC;
+    case MAVLINK_MSG_ID_PARAM_SET:
+        return MAVLINK_MSG_ID_PARAM_SET_CRC;
+    case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+        return MAVLINK_MSG_ID_REQUEST_DATA_STREAM_CRC;
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+        return MAVLINK_MSG_ID_COMMAND_LONG_CRC;
+    default:
+        return -1;
+    }
+}
+
+static bool mavlinkIsForUs(uint8_t targetSystem)
+{
+    return targetSystem == 0 || targetSystem == MAVLINK_SYSTEM_ID;
+}
+
+static bool mavlinkSendParam(uint16_t index)
+{
+    mavlinkParam_t param;
+    if (!mavlinkParamGet(index, &param)) {
+        return true;
     }
-#endif
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA1)) {
-        mavlinkSendAttitude();
+    mavlink_msg_param_value_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        param.id, param.value,
+        // MAV_PARAM_TYPE_UINT8 .. MAV_PARAM_TYPE_INT32 follow the order of VAR_UINT8 .. VAR_INT32
+        param.type + MAV_PARAM_TYPE_UINT8,
+        mavlinkParamCount(), index);
+    return mavlinkSendMessage(MAVLINK_MSG_ID_PARAM_VALUE_CRC);
+}
+
+// Replies to a read or set, a reply that does not fit is sent on the next call
+static void mavlinkReplyParam(uint16_t index)
+{
+    mavlinkParamReplyIndex = mavlinkSendParam(index) ? -1 : index;
+}
+
+static void mavlinkSendParamReply(void)
+{
+    if (mavlinkParamReplyIndex >= 0 && mavlinkSendParam(mavlinkParamReplyIndex)) {
+        mavlinkParamReplyIndex = -1;
+    }
+}
+
+static void mavlinkSendParamList(void)
+{
+    while (mavlinkParamListIndex >= 0) {
+        if (mavlinkParamListIndex >= mavlinkParamCount()) {
+            mavlinkParamListIndex = -1;
+        } else if (mavlinkSendParam(mavlinkParamListIndex)) {
+            mavlinkParamListIndex++;
+        } else {
+            return;
+        }
+    }
+}
+
+static void mavlinkHandleParamRequestRead(const mavlinkFrame_t *frame)
+{
+    mavlink_param_request_read_t request;
+    memcpy(&request, frame->payload, sizeof(request));
+    if (!mavlinkIsForUs(request.target_system)) {
+        return;
+    }
+
+    int index = request.param_index;
+    if (index < 0) {
+        index = mavlinkParamFind(request.param_id);
+    }
+    if (index >= 0) {
+        mavlinkReplyParam(index);
+    }
+}
+
+static void mavlinkHandleParamSet(const mavlinkFrame_t *frame)
+{
+    mavlink_param_set_t request;
+    memcpy(&request, frame->payload, sizeof(request));
+    if (!mavlinkIsForUs(request.target_system)) {
+        return;
+    }
+
+    const int index = mavlinkParamFind(request.param_id);
+    if (index < 0) {
+        return;
+    }
+
+    if (!ARMING_FLAG(ARMED)) {
+        mavlinkParamSet(index, request.param_value);
+    }
+    // the current value tells the sender whether the value was accepted
+    mavlinkReplyParam(index);
+}
+
+static void mavlinkHandleRequestDataStream(const mavlinkFrame_t *frame)
+{
+    mavlink_request_data_stream_t request;
+    memcpy(&request, frame->payload, sizeof(request));
+    if (!mavlinkIsForUs(request.target_system)) {
+        return;
+    }
+
+    for (unsigned i = 0; i < MAVLINK_MESSAGE_COUNT; i++) {
+        const uint8_t stream = mavlinkMessages[i].stream;
+        if (stream == MAVLINK_STREAM_NONE || (request.req_stream_id != MAV_DATA_STREAM_ALL && request.req_stream_id != stream)) {
+            continue;
+        }
+
+        timeDelta_t intervalUs = 0;
+        if (request.start_stop) {
+            const uint16_t rateHz = request.req_message_rate ? request.req_message_rate : mavlinkMessages[i].defaultRateHz;
+            // a message that is off by default is sent at the lowest rate when its stream is started
+            intervalUs = mavlinkRateToInterval(rateHz ? rateHz : 1);
+        }
+        mavlinkSetInterval(i, intervalUs);
+    }
+}
+
+static void mavlinkSendCommandAck(uint16_t command, uint8_t result)
+{
+    mavlink_msg_command_ack_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg, command, result);
+    mavlinkSendMessage(MAVLINK_MSG_ID_COMMAND_ACK_CRC);
+}
+
+static void mavlinkSendMessageInterval(uint32_t msgId)
+{
+    const int index = mavlinkMessageIndex(msgId);
+    int32_t intervalUs = 0;
+    if (index >= 0) {
+        intervalUs = mavlinkIntervalUs[index] ? mavlinkIntervalUs[index] : -1;
+    }
+
+    // MESSAGE_INTERVAL is not in the bundled library, the payload is interval_us then message_id
+    mavMsg.msgid = MAVLINK_MSG_ID_MESSAGE_INTERVAL;
+    mavMsg.len = MAVLINK_MSG_ID_MESSAGE_INTERVAL_LEN;
+    uint8_t *payload = (uint8_t *)_MAV_PAYLOAD_NON_CONST(&mavMsg);
+    memcpy(&payload[0], &intervalUs, sizeof(intervalUs));
+    payload[4] = msgId;
+    payload[5] = msgId >> 8;
+    mavlinkSendMessage(MAVLINK_MSG_ID_MESSAGE_INTERVAL_CRC);
+}
+
+static void mavlinkSendAutopilotVersion(void)
+{
+    const uint8_t customVersion[8] = { 0 };
+    mavlink_msg_autopilot_version_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        // capabilities Bitmask of MAV_PROTOCOL_CAPABILITY
+        MAV_PROTOCOL_CAPABILITY_PARAM_FLOAT | MAV_PROTOCOL_CAPABILITY_MAVLINK2,
+        // flight_sw_version major, minor, patch and release type
+        (FC_VERSION_MAJOR << 24) | (FC_VERSION_MINOR << 16) | (FC_VERSION_PATCH_LEVEL << 8),
+        0, 0, 0,
+        customVersion, customVersion, customVersion,
+        0, 0, 0);
+    mavlinkSendMessage(MAVLINK_MSG_ID_AUTOPILOT_VERSION_CRC);
+}
+
+static uint8_t mavlinkCommandSetMessageInterval(const mavlink_command_long_t *command)
+{
+    const int index = mavlinkMessageIndex(command->param1);
+    if (index < 0) {
+        return MAV_RESULT_UNSUPPORTED;
     }
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA2)) {
-        mavlinkSendHUDAndHeartbeat();
+    if (command->param2 < 0) {
+        mavlinkSetInterval(index, 0);
+    } else if (command->param2 == 0) {
+        mavlinkSetInterval(index, mavlinkRateToInterval(mavlinkMessages[index].defaultRateHz));
+    } else {
+        mavlinkSetInterval(index, command->param2);
     }
+    return MAV_RESULT_ACCEPTED;
 }
 
-void handleMAVLinkTelemetry(void)
+static uint8_t mavlinkCommandPreflightStorage(const mavlink_command_long_t *command)
+{
+    // only writing the parameters is supported, as MSP_EEPROM_WRITE
+    if (command->param1 != 1) {
+        return MAV_RESULT_UNSUPPORTED;
+    }
+    if (ARMING_FLAG(ARMED)) {
+        return MAV_RESULT_DENIED;
+    }
+
+    writeEEPROM();
+    readEEPROM();
+    schedulerIgnoreTaskStateTime();
+    return MAV_RESULT_ACCEPTED;
+}
+
+static void mavlinkHandleCommandLong(const mavlinkFrame_t *frame)
+{
+    mavlink_command_long_t command;
+    memcpy(&command, frame->payload, sizeof(command));
+    if (!mavlinkIsForUs(command.target_system)) {
+        return;
+    }
+
+    uint8_t result;
+    switch (command.command) {
+    case MAV_CMD_SET_MESSAGE_INTERVAL:
+        result = mavlinkCommandSetMessageInterval(&command);
+        break;
+    case MAV_CMD_GET_MESSAGE_INTERVAL:
+        mavlinkSendMessageInterval(command.param1);
+        result = MAV_RESULT_ACCEPTED;
+        break;
+    case MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES:
+        if (command.param1 == 1) {
+            mavlinkSendAutopilotVersion();
+            result = MAV_RESULT_ACCEPTED;
+        } else {
+            result = MAV_RESULT_UNSUPPORTED;
+        }
+        break;
+    case MAV_CMD_PREFLIGHT_STORAGE:
+        result = mavlinkCommandPreflightStorage(&command);
+        break;
+    default:
+        result = MAV_RESULT_UNSUPPORTED;
+        break;
+    }
+    mavlinkSendCommandAck(command.command, result);
+}
+
+static void mavlinkHandleFrame(const mavlinkFrame_t *frame)
+{
+    if (frame->version == 2) {
+        // the ground station speaks MAVLink 2, answer in kind
+        mavlinkVersion = 2;
+    }
+
+    switch (frame->msgId) {
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        mavlinkParamListIndex = 0;
+        break;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        mavlinkHandleParamRequestRead(frame);
+        break;
+    case MAVLINK_MSG_ID_PARAM_SET:
+        mavlinkHandleParamSet(frame);
+        break;
+    case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+        mavlinkHandleRequestDataStream(frame);
+        break;
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+        mavlinkHandleCommandLong(frame);
+        break;
+    default:
+        break;
+    }
+}
+
+static void mavlinkInitLink(void)
+{
+    mavlinkFrameParserInit(&mavlinkParser, mavlinkCrcExtra);
+    mavlinkVersion = telemetryConfig()->mavlink_version;
+    mavlinkParamListIndex = -1;
+    mavlinkParamReplyIndex = -1;
+    mavlinkResetIntervals();
+}
+
+void handleMAVLinkTelemetry(timeUs_t currentTimeUs)
 {
     if (!mavlinkTelemetryEnabled) {
         return;
@@ -544,11 +950,26 @@ void handleMAVLinkTelemetry(void)
         return;
     }
 
-    uint32_t now = micros();
-    if ((now - lastMavlinkMessage) >= TELEMETRY_MAVLINK_DELAY) {
-        processMAVLinkTelemetry();
-        lastMavlinkMessage = now;
+    serialBeginWrite(mavlinkPort);
+
+    if (!mavlinkPortShared) {
+        while (serialRxBytesWaiting(mavlinkPort) > 0) {
+            mavlinkFrame_t frame;
+            if (mavlinkFrameParse(&mavlinkParser, serialRead(mavlinkPort), &frame)) {
+                mavlinkHandleFrame(&frame);
+            }
+        }
     }
+
+    // a reply the ground station waits for goes before the telemetry
+    mavlinkSendParamReply();
+
+    processMAVLinkTelemetry(currentTimeUs);
+
+    // parameters fill the transmit buffer left over by the telemetry
+    mavlinkSendParamList();
+
+    serialEndWrite(mavlinkPort);
 }
 
 #endif
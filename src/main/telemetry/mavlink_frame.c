@@ -0,0 +1,192 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MAVLink 1 and 2 framing.
+ *
+ * The bundled MAVLink library only frames MAVLink 1, so frames of both versions are written and
+ * parsed here. Messages are still packed and decoded with the library.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_TELEMETRY_MAVLINK)
+
+#include "drivers/serial.h"
+
+#include "telemetry/mavlink_frame.h"
+
+#include "checksum.h"
+
+// MAVLink 2 drops the trailing zero bytes of the payload, the first byte is always sent
+static uint8_t mavlinkFrameV2PayloadLength(const mavlinkFrame_t *frame)
+{
+    uint8_t length = frame->length;
+    while (length > 1 && frame->payload[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+uint16_t mavlinkFrameSize(const mavlinkFrame_t *frame)
+{
+    if (frame->version == 1) {
+        return MAVLINK_FRAME_V1_HEADER_SIZE + frame->length + MAVLINK_FRAME_CHECKSUM_SIZE;
+    }
+    return MAVLINK_FRAME_V2_HEADER_SIZE + mavlinkFrameV2PayloadLength(frame) + MAVLINK_FRAME_CHECKSUM_SIZE;
+}
+
+bool mavlinkFrameWrite(serialPort_t *port, const mavlinkFrame_t *frame, uint8_t crcExtra)
+{
+    uint8_t header[MAVLINK_FRAME_V2_HEADER_SIZE];
+    uint8_t headerSize;
+    uint8_t length;
+
+    if (frame->version == 1) {
+        length = frame->length;
+        header[0] = MAVLINK_FRAME_V1_STX;
+        header[1] = length;
+        header[2] = frame->seq;
+        header[3] = frame->systemId;
+        header[4] = frame->componentId;
+        header[5] = frame->msgId;
+        headerSize = MAVLINK_FRAME_V1_HEADER_SIZE;
+    } else {
+        length = mavlinkFrameV2PayloadLength(frame);
+        header[0] = MAVLINK_FRAME_V2_STX;
+        header[1] = length;
+        header[2] = 0; // incompatibility flags
+        header[3] = 0; // compatibility flags
+        header[4] = frame->seq;
+        header[5] = frame->systemId;
+        header[6] = frame->componentId;
+        header[7] = frame->msgId;
+        header[8] = frame->msgId >> 8;
+        header[9] = frame->msgId >> 16;
+        headerSize = MAVLINK_FRAME_V2_HEADER_SIZE;
+    }
+
+    if (serialTxBytesFree(port) < (uint32_t)(headerSize + length + MAVLINK_FRAME_CHECKSUM_SIZE)) {
+        return false;
+    }
+
+    // the checksum covers everything but the start byte, and the CRC extra of the message
+    uint16_t crc;
+    crc_init(&crc);
+    crc_accumulate_buffer(&crc, (const char *)&header[1], headerSize - 1);
+    crc_accumulate_buffer(&crc, (const char *)frame->payload, length);
+    crc_accumulate(crcExtra, &crc);
+    const uint8_t checksum[MAVLINK_FRAME_CHECKSUM_SIZE] = { crc & 0xFF, crc >> 8 };
+
+    serialWriteBufNoFlush(port, header, headerSize);
+    serialWriteBufNoFlush(port, frame->payload, length);
+    serialWriteBufNoFlush(port, checksum, sizeof(checksum));
+
+    return true;
+}
+
+void mavlinkFrameParserInit(mavlinkFrameParser_t *parser, mavlinkCrcExtraFnPtr crcExtra)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->crcExtra = crcExtra;
+}
+
+static bool mavlinkFrameDecode(mavlinkFrameParser_t *parser, mavlinkFrame_t *frame)
+{
+    const uint8_t *buffer = parser->buffer;
+    uint8_t headerSize;
+
+    if (buffer[0] == MAVLINK_FRAME_V2_STX) {
+        if (buffer[2] & ~MAVLINK_FRAME_INCOMPAT_FLAG_SIGNED) {
+            return false;
+        }
+        frame->version = 2;
+        frame->seq = buffer[4];
+        frame->systemId = buffer[5];
+        frame->componentId = buffer[6];
+        frame->msgId = buffer[7] | (buffer[8] << 8) | ((uint32_t)buffer[9] << 16);
+        headerSize = MAVLINK_FRAME_V2_HEADER_SIZE;
+    } else {
+        frame->version = 1;
+        frame->seq = buffer[2];
+        frame->systemId = buffer[3];
+        frame->componentId = buffer[4];
+        frame->msgId = buffer[5];
+        headerSize = MAVLINK_FRAME_V1_HEADER_SIZE;
+    }
+    frame->length = buffer[1];
+
+    const int crcExtra = parser->crcExtra(frame->msgId);
+    if (crcExtra < 0) {
+        return false;
+    }
+
+    // the signature of a signed frame follows the checksum and is not checked
+    uint16_t crc;
+    crc_init(&crc);
+    crc_accumulate_buffer(&crc, (const char *)&buffer[1], headerSize - 1 + frame->length);
+    crc_accumulate(crcExtra, &crc);
+    const uint8_t *checksum = &buffer[headerSize + frame->length];
+    if (checksum[0] != (crc & 0xFF) || checksum[1] != (crc >> 8)) {
+        return false;
+    }
+
+    // a MAVLink 2 payload may have been truncated, the missing bytes are zero
+    memcpy(parser->payload, &buffer[headerSize], frame->length);
+    memset(&parser->payload[frame->length], 0, sizeof(parser->payload) - frame->length);
+    frame->payload = parser->payload;
+
+    return true;
+}
+
+bool mavlinkFrameParse(mavlinkFrameParser_t *parser, uint8_t c, mavlinkFrame_t *frame)
+{
+    if (parser->index == 0 && c != MAVLINK_FRAME_V1_STX && c != MAVLINK_FRAME_V2_STX) {
+        return false;
+    }
+
+    parser->buffer[parser->index++] = c;
+
+    const bool isV2 = parser->buffer[0] == MAVLINK_FRAME_V2_STX;
+    if (parser->index == 2) {
+        parser->frameSize = (isV2 ? MAVLINK_FRAME_V2_HEADER_SIZE : MAVLINK_FRAME_V1_HEADER_SIZE) + c + MAVLINK_FRAME_CHECKSUM_SIZE;
+    } else if (parser->index == 3 && isV2 && (c & MAVLINK_FRAME_INCOMPAT_FLAG_SIGNED)) {
+        parser->frameSize += MAVLINK_FRAME_SIGNATURE_SIZE;
+    }
+
+    if (parser->index < 3 || parser->index < parser->frameSize) {
+        return false;
+    }
+
+    parser->index = 0;
+    if (!mavlinkFrameDecode(parser, frame)) {
+        parser->errors++;
+        return false;
+    }
+    parser->frames++;
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "drivers/serial.h"
+
+#define MAVLINK_FRAME_V1_STX                0xFE
+#define MAVLINK_FRAME_V2_STX                0xFD
+#define MAVLINK_FRAME_V1_HEADER_SIZE        6
+#define MAVLINK_FRAME_V2_HEADER_SIZE        10
+#define MAVLINK_FRAME_CHECKSUM_SIZE         2
+#define MAVLINK_FRAME_SIGNATURE_SIZE        13
+#define MAVLINK_FRAME_PAYLOAD_SIZE_MAX      255
+#define MAVLINK_FRAME_SIZE_MAX              (MAVLINK_FRAME_V2_HEADER_SIZE + MAVLINK_FRAME_PAYLOAD_SIZE_MAX + MAVLINK_FRAME_CHECKSUM_SIZE + MAVLINK_FRAME_SIGNATURE_SIZE)
+
+#define MAVLINK_FRAME_INCOMPAT_FLAG_SIGNED  0x01
+
+typedef struct mavlinkFrame_s {
+    uint8_t version;                // 1 or 2
+    uint8_t seq;
+    uint8_t systemId;
+    uint8_t componentId;
+    uint32_t msgId;                 // 8 bits on MAVLink 1, 24 bits on MAVLink 2
+    uint8_t length;                 // payload length on the wire
+    const uint8_t *payload;         // zero padded up to MAVLINK_FRAME_PAYLOAD_SIZE_MAX on a parsed frame
+} mavlinkFrame_t;
+
+// Returns the CRC extra byte of a message, or a negative value for a message that is not known
+typedef int (*mavlinkCrcExtraFnPtr)(uint32_t msgId);
+
+typedef struct mavlinkFrameParser_s {
+    mavlinkCrcExtraFnPtr crcExtra;
+    uint16_t index;
+    uint16_t frameSize;
+    uint32_t frames;
+    uint32_t errors;                // frames dropped for a bad checksum, unknown message or unsupported flags
+    uint8_t buffer[MAVLINK_FRAME_SIZE_MAX];
+    uint8_t payload[MAVLINK_FRAME_PAYLOAD_SIZE_MAX];
+} mavlinkFrameParser_t;
+
+// Bytes needed to send the payload, MAVLink 2 drops the trailing zero bytes of the payload
+uint16_t mavlinkFrameSize(const mavlinkFrame_t *frame);
+
+// Writes the frame straight into the transmit buffer of the port, in pieces, without assembling it
+// in a packet buffer first. Returns false and writes nothing if the frame does not fit.
+bool mavlinkFrameWrite(serialPort_t *port, const mavlinkFrame_t *frame, uint8_t crcExtra);
+
+void mavlinkFrameParserInit(mavlinkFrameParser_t *parser, mavlinkCrcExtraFnPtr crcExtra);
+
+// Feeds one byte to the parser, returns true and fills in frame when a valid frame of either version is complete.
+// The frame payload points into the parser and stays valid until the next byte is fed.
+bool mavlinkFrameParse(mavlinkFrameParser_t *parser, uint8_t c, mavlinkFrame_t *frame);
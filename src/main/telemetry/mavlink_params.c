@@ -0,0 +1,293 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The CLI settings as MAVLink parameters.
+ *
+ * Settings with a name that fits in a parameter id and a single numeric value are exposed, in the
+ * order of the settings table. Lookup settings are the index of their value and bit settings are 0
+ * or 1. Profile settings are those of the current profile. Values are read from and written to the
+ * live configuration, as MSP does, and are saved with the rest of the configuration.
+ *
+ * A PID or rate profile setting is applied when it is set, as MSP applies its profile messages. Like a
+ * CLI set, the other settings are only stored: they take effect once saved with MAV_CMD_PREFLIGHT_STORAGE,
+ * which activates the configuration as MSP_EEPROM_WRITE does, or after a reboot for those read at startup.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_TELEMETRY_MAVLINK)
+
+#include "cli/settings.h"
+
+#include "common/utils.h"
+
+#include "config/config.h"
+
+#include "fc/controlrate_profile.h"
+#include "fc/rc.h"
+
+#include "flight/pid.h"
+#include "flight/pid_init.h"
+
+#include "pg/pg.h"
+
+#include "telemetry/mavlink_params.h"
+
+static bool mavlinkParamIsExposed(const clivalue_t *var)
+{
+    switch (var->type & VALUE_MODE_MASK) {
+    case MODE_DIRECT:
+    case MODE_LOOKUP:
+    case MODE_BITSET:
+        return strlen(var->name) <= MAVLINK_PARAM_ID_LENGTH;
+    default:
+        return false;
+    }
+}
+
+uint16_t mavlinkParamCount(void)
+{
+    static int count = -1;
+
+    if (count < 0) {
+        count = 0;
+        for (unsigned i = 0; i < valueTableEntryCount; i++) {
+            count += mavlinkParamIsExposed(&valueTable[i]);
+        }
+    }
+    return count;
+}
+
+// Parameters are mostly read in order, so the search continues from the last parameter found
+static const clivalue_t *mavlinkParamSetting(uint16_t index)
+{
+    static uint16_t lastIndex = 0;
+    static uint16_t lastTableIndex = 0;
+
+    uint16_t paramIndex = 0;
+    uint16_t tableIndex = 0;
+    if (index >= lastIndex) {
+        paramIndex = lastIndex;
+        tableIndex = lastTableIndex;
+    }
+
+    for (; tableIndex < valueTableEntryCount; tableIndex++) {
+        if (!mavlinkParamIsExposed(&valueTable[tableIndex])) {
+            continue;
+        }
+        if (paramIndex == index) {
+            lastIndex = index;
+            lastTableIndex = tableIndex;
+            return &valueTable[tableIndex];
+        }
+        paramIndex++;
+    }
+    return NULL;
+}
+
+int mavlinkParamFind(const char *id)
+{
+    char name[MAVLINK_PARAM_ID_LENGTH + 1];
+    strncpy(name, id, MAVLINK_PARAM_ID_LENGTH);
+    name[MAVLINK_PARAM_ID_LENGTH] = '\0';
+
+    int paramIndex = 0;
+    for (unsigned i = 0; i < valueTableEntryCount; i++) {
+        if (!mavlinkParamIsExposed(&valueTable[i])) {
+            continue;
+        }
+        if (strcmp(valueTable[i].name, name) == 0) {
+            return paramIndex;
+        }
+        paramIndex++;
+    }
+    return -1;
+}
+
+static void *mavlinkParamPointer(const clivalue_t *var)
+{
+    const pgRegistry_t *rec = pgFind(var->pgn);
+    uint16_t offset = var->offset;
+
+    switch (var->type & VALUE_SECTION_MASK) {
+    case PROFILE_VALUE:
+        offset += sizeof(pidProfile_t) * getCurrentPidProfileIndex();
+        break;
+    case PROFILE_RATE_VALUE:
+        offset += sizeof(controlRateConfig_t) * getCurrentControlRateProfileIndex();
+        break;
+    default:
+        break;
+    }
+    return rec->address + offset;
+}
+
+bool mavlinkParamGet(uint16_t index, mavlinkParam_t *param)
+{
+    const clivalue_t *var = mavlinkParamSetting(index);
+    if (!var) {
+        return false;
+    }
+
+    const void *ptr = mavlinkParamPointer(var);
+    uint32_t raw = 0;
+    switch (var->type & VALUE_TYPE_MASK) {
+    case VAR_UINT8:
+        param->value = *(uint8_t *)ptr;
+        raw = *(uint8_t *)ptr;
+        break;
+    case VAR_INT8:
+        param->value = *(int8_t *)ptr;
+        break;
+    case VAR_UINT16:
+        param->value = *(uint16_t *)ptr;
+        raw = *(uint16_t *)ptr;
+        break;
+    case VAR_INT16:
+        param->value = *(int16_t *)ptr;
+        break;
+    case VAR_UINT32:
+        param->value = *(uint32_t *)ptr;
+        raw = *(uint32_t *)ptr;
+        break;
+    case VAR_INT32:
+        param->value = *(int32_t *)ptr;
+        raw = *(int32_t *)ptr;
+        break;
+    }
+
+    param->type = var->type & VALUE_TYPE_MASK;
+    switch (var->type & VALUE_MODE_MASK) {
+    case MODE_BITSET:
+        param->value = (raw >> var->config.bitpos) & 1;
+        FALLTHROUGH;
+    case MODE_LOOKUP:
+        param->type = VAR_UINT8;
+        break;
+    default:
+        break;
+    }
+
+    strncpy(param->id, var->name, MAVLINK_PARAM_ID_LENGTH);
+    param->id[MAVLINK_PARAM_ID_LENGTH] = '\0';
+
+    return true;
+}
+
+bool mavlinkParamSet(uint16_t index, float value)
+{
+    const clivalue_t *var = mavlinkParamSetting(index);
+    if (!var) {
+        return false;
+    }
+
+    float min = 0;
+    float max;
+    switch (var->type & VALUE_MODE_MASK) {
+    case MODE_LOOKUP:
+        max = lookupTables[var->config.lookup.tableIndex].valueCount - 1;
+        break;
+    case MODE_BITSET:
+        max = 1;
+        break;
+    default:
+        switch (var->type & VALUE_TYPE_MASK) {
+        case VAR_UINT32:
+            max = var->config.u32Max;
+            break;
+        case VAR_INT32:
+            min = -var->config.d32Max;
+            max = var->config.d32Max;
+            break;
+        case VAR_INT8:
+        case VAR_INT16:
+            min = var->config.minmax.min;
+            max = var->config.minmax.max;
+            break;
+        default:
+            min = var->config.minmaxUnsigned.min;
+            max = var->config.minmaxUnsigned.max;
+            break;
+        }
+        break;
+    }
+
+    value = roundf(value);
+    if (!(value >= min && value <= max)) {
+        return false;
+    }
+
+    void *ptr = mavlinkParamPointer(var);
+    if ((var->type & VALUE_MODE_MASK) == MODE_BITSET) {
+        const uint32_t mask = 1U << var->config.bitpos;
+        switch (var->type & VALUE_TYPE_MASK) {
+        case VAR_UINT8:
+            *(uint8_t *)ptr = value ? (*(uint8_t *)ptr | mask) : (*(uint8_t *)ptr & ~mask);
+            break;
+        case VAR_UINT16:
+            *(uint16_t *)ptr = value ? (*(uint16_t *)ptr | mask) : (*(uint16_t *)ptr & ~mask);
+            break;
+        default:
+            *(uint32_t *)ptr = value ? (*(uint32_t *)ptr | mask) : (*(uint32_t *)ptr & ~mask);
+            break;
+        }
+    } else {
+        switch (var->type & VALUE_TYPE_MASK) {
+        case VAR_UINT8:
+            *(uint8_t *)ptr = value;
+            break;
+        case VAR_INT8:
+            *(int8_t *)ptr = value;
+            break;
+        case VAR_UINT16:
+            *(uint16_t *)ptr = value;
+            break;
+        case VAR_INT16:
+            *(int16_t *)ptr = value;
+            break;
+        case VAR_UINT32:
+            *(uint32_t *)ptr = value;
+            break;
+        case VAR_INT32:
+            *(int32_t *)ptr = value;
+            break;
+        }
+    }
+
+    switch (var->type & VALUE_SECTION_MASK) {
+    case PROFILE_VALUE:
+        pidInitConfig(currentPidProfile);
+        break;
+    case PROFILE_RATE_VALUE:
+        initRcProcessing();
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+#endif
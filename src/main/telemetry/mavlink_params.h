@@ -0,0 +1,43 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAVLINK_PARAM_ID_LENGTH 16
+
+typedef struct mavlinkParam_s {
+    char id[MAVLINK_PARAM_ID_LENGTH + 1];
+    float value;
+    uint8_t type;                   // VAR_UINT8 .. VAR_INT32 of the CLI setting
+} mavlinkParam_t;
+
+// Number of CLI settings exposed as parameters
+uint16_t mavlinkParamCount(void);
+
+// Index of the parameter named id, which is not terminated when MAVLINK_PARAM_ID_LENGTH long, -1 if none
+int mavlinkParamFind(const char *id);
+
+bool mavlinkParamGet(uint16_t index, mavlinkParam_t *param);
+
+// Sets the live value of the parameter, returns false if the value is out of range
+bool mavlinkParamSet(uint16_t index, float value);
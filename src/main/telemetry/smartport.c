@@ -32,6 +32,8 @@
 
 #if defined(USE_TELEMETRY_SMARTPORT)
 
+#include "build/build_config.h"
+
 #include "common/axis.h"
 #include "common/color.h"
 #include "common/maths.h"
@@ -82,7 +84,9 @@
 
 #include "telemetry/msp_shared.h"
 #include "telemetry/smartport.h"
+#include "telemetry/smartport_response.h"
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_sensors.h"
 
 #define SMARTPORT_MIN_TELEMETRY_RESPONSE_DELAY_US 500
 
@@ -212,6 +216,10 @@ static smartPortWriteFrameFn *smartPortWriteFrame;
 static bool smartPortMspReplyPending = false;
 #endif
 
+// request received by the interrupt, held until the task has processed it
+static smartPortPayload_t smartPortRequest;
+static volatile bool smartPortRequestPending = false;
+
 smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPortReadyToSendFn *readyToSend, bool useChecksum)
 {
     static uint8_t rxBuffer[sizeof(smartPortPayload_t)];
@@ -277,39 +285,26 @@ smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPor
     return NULL;
 }
 
-void smartPortSendByte(uint8_t c, uint16_t *checksum, serialPort_t *port)
-{
-    // smart port escape sequence
-    if (c == FSSP_DLE || c == FSSP_START_STOP) {
-        serialWrite(port, FSSP_DLE);
-        serialWrite(port, c ^ FSSP_DLE_XOR);
-    } else {
-        serialWrite(port, c);
-    }
-
-    if (checksum != NULL) {
-        frskyCheckSumStep(checksum, c);
-    }
-}
-
 bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload)
 {
     return payload->frameId == FSSP_MSPC_FRAME_SMARTPORT || payload->frameId == FSSP_MSPC_FRAME_FPORT;
 }
 
-void smartPortWriteFrameSerial(const smartPortPayload_t *payload, serialPort_t *port, uint16_t checksum)
+void smartPortArmFrame(const smartPortPayload_t *payload, uint16_t checksum)
 {
-    uint8_t *data = (uint8_t *)payload;
+    const uint8_t *data = (const uint8_t *)payload;
     for (unsigned i = 0; i < sizeof(smartPortPayload_t); i++) {
-        smartPortSendByte(*data++, &checksum, port);
+        smartPortResponseWrite(*data++, &checksum);
     }
     frskyCheckSumFini(&checksum);
-    smartPortSendByte(checksum, NULL, port);
+    smartPortResponseWrite(checksum, NULL);
+    smartPortResponseArm(payload->frameId == FSSP_DATA_FRAME ? payload->valueId : SMARTPORT_RESPONSE_ID_OTHER);
 }
 
 static void smartPortWriteFrameInternal(const smartPortPayload_t *payload)
 {
-    smartPortWriteFrameSerial(payload, smartPortSerialPort, 0);
+    smartPortResponseStart();
+    smartPortArmFrame(payload, 0);
 }
 
 static void smartPortSendPackage(uint16_t id, uint32_t val)
@@ -322,10 +317,335 @@ static void smartPortSendPackage(uint16_t id, uint32_t val)
     smartPortWriteFrame(&payload);
 }
 
+// Gets the value of a data id, false if there is none to send. index picks the latitude (0) or longitude (1) of LATLONG.
+static bool smartPortGetValue(uint16_t id, uint8_t index, uint32_t *data)
+{
+    static uint8_t t1Cnt = 0;
+    static uint8_t t2Cnt = 0;
+
+    int32_t tmpi;
+    uint32_t tmp2 = 0;
+
+#ifdef USE_ESC_SENSOR_TELEMETRY
+    escSensorData_t *escData;
+#endif
+#ifndef USE_GPS
+    UNUSED(index);
+#endif
+
+    switch (id) {
+        case FSSP_DATAID_VFAS       :
+            *data = telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage(); // in 0.01V according to SmartPort spec
+            return true;
+#ifdef USE_ESC_SENSOR_TELEMETRY
+        case FSSP_DATAID_VFAS1      :
+        case FSSP_DATAID_VFAS2      :
+        case FSSP_DATAID_VFAS3      :
+        case FSSP_DATAID_VFAS4      :
+        case FSSP_DATAID_VFAS5      :
+        case FSSP_DATAID_VFAS6      :
+        case FSSP_DATAID_VFAS7      :
+        case FSSP_DATAID_VFAS8      :
+            escData = getEscSensorData(id - FSSP_DATAID_VFAS1);
+            if (escData != NULL) {
+                *data = escData->voltage;
+                return true;
+            }
+            return false;
+#endif
+        case FSSP_DATAID_CURRENT    :
+            *data = getAmperage() / 10; // in 0.1A according to SmartPort spec
+            return true;
+#ifdef USE_ESC_SENSOR_TELEMETRY
+        case FSSP_DATAID_CURRENT1   :
+        case FSSP_DATAID_CURRENT2   :
+        case FSSP_DATAID_CURRENT3   :
+        case FSSP_DATAID_CURRENT4   :
+        case FSSP_DATAID_CURRENT5   :
+        case FSSP_DATAID_CURRENT6   :
+        case FSSP_DATAID_CURRENT7   :
+        case FSSP_DATAID_CURRENT8   :
+            escData = getEscSensorData(id - FSSP_DATAID_CURRENT1);
+            if (escData != NULL) {
+                *data = escData->current;
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_RPM        :
+            escData = getEscSensorData(ESC_SENSOR_COMBINED);
+            if (escData != NULL) {
+                *data = lrintf(erpmToRpm(escData->rpm));
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_RPM1       :
+        case FSSP_DATAID_RPM2       :
+        case FSSP_DATAID_RPM3       :
+        case FSSP_DATAID_RPM4       :
+        case FSSP_DATAID_RPM5       :
+        case FSSP_DATAID_RPM6       :
+        case FSSP_DATAID_RPM7       :
+        case FSSP_DATAID_RPM8       :
+            escData = getEscSensorData(id - FSSP_DATAID_RPM1);
+            if (escData != NULL) {
+                *data = lrintf(erpmToRpm(escData->rpm));
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_TEMP        :
+            escData = getEscSensorData(ESC_SENSOR_COMBINED);
+            if (escData != NULL) {
+                *data = escData->temperature;
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_TEMP1      :
+        case FSSP_DATAID_TEMP2      :
+        case FSSP_DATAID_TEMP3      :
+        case FSSP_DATAID_TEMP4      :
+        case FSSP_DATAID_TEMP5      :
+        case FSSP_DATAID_TEMP6      :
+        case FSSP_DATAID_TEMP7      :
+        case FSSP_DATAID_TEMP8      :
+            escData = getEscSensorData(id - FSSP_DATAID_TEMP1);
+            if (escData != NULL) {
+                *data = escData->temperature;
+                return true;
+            }
+            return false;
+#endif
+        case FSSP_DATAID_ALTITUDE   :
+            *data = getEstimatedAltitudeCm(); // in cm according to SmartPort spec
+            return true;
+        case FSSP_DATAID_FUEL       :
+            if (batteryConfig()->batteryCapacity > 0) {
+                *data = calculateBatteryPercentageRemaining();
+            } else {
+                *data = getMAhDrawn();
+            }
+            return true;
+        case FSSP_DATAID_CAP_USED   :
+            *data = getMAhDrawn(); // given in mAh, should be in percent according to SmartPort spec
+            return true;
+#if defined(USE_VARIO)
+        case FSSP_DATAID_VARIO      :
+            *data = getEstimatedVario(); // in cm/s according to SmartPort spec
+            return true;
+#endif
+        case FSSP_DATAID_HEADING    :
+            *data = attitude.values.yaw * 10; // in degrees * 100 according to SmartPort spec
+            return true;
+#if defined(USE_ACC)
+        case FSSP_DATAID_PITCH      :
+            *data = attitude.values.pitch; // given in 10*deg
+            return true;
+        case FSSP_DATAID_ROLL       :
+            *data = attitude.values.roll; // given in 10*deg
+            return true;
+        case FSSP_DATAID_ACCX       :
+            *data = lrintf(100 * acc.accADC.x * acc.dev.acc_1G_rec); // Multiply by 100 to show as x.xx g on Taranis
+            return true;
+        case FSSP_DATAID_ACCY       :
+            *data = lrintf(100 * acc.accADC.y * acc.dev.acc_1G_rec);
+            return true;
+        case FSSP_DATAID_ACCZ       :
+            *data = lrintf(100 * acc.accADC.z * acc.dev.acc_1G_rec);
+            return true;
+#endif
+        case FSSP_DATAID_T1         :
+            // we send all the flags as decimal digits for easy reading
+
+            // the t1Cnt simply allows the telemetry view to show at least some changes
+            t1Cnt++;
+            if (t1Cnt == 4) {
+                t1Cnt = 1;
+            }
+            tmpi = t1Cnt * 10000; // start off with at least one digit so the most significant 0 won't be cut off
+            // the Taranis seems to be able to fit 5 digits on the screen
+            // the Taranis seems to consider this number a signed 16 bit integer
+
+            if (!isArmingDisabled()) {
+                tmpi += 1;
+            } else {
+                tmpi += 2;
+            }
+            if (ARMING_FLAG(ARMED)) {
+                tmpi += 4;
+            }
+
+            if (FLIGHT_MODE(ANGLE_MODE | ALT_HOLD_MODE | POS_HOLD_MODE)) {
+                tmpi += 10;
+            }
+            if (FLIGHT_MODE(HORIZON_MODE)) {
+                tmpi += 20;
+            }
+            if (FLIGHT_MODE(PASSTHRU_MODE)) {
+                tmpi += 40;
+            }
+
+            if (FLIGHT_MODE(MAG_MODE)) {
+                tmpi += 100;
+            }
+
+            if (FLIGHT_MODE(HEADFREE_MODE)) {
+                tmpi += 4000;
+            }
+
+            *data = (uint32_t)tmpi;
+            return true;
+        case FSSP_DATAID_T2         :
+#ifdef USE_GPS
+            if (sensors(SENSOR_GPS)) {
+                // satellite accuracy PDOP: 0 = worst [PDOP > 5.5m], 9 = best [PDOP <= 1.0m]
+                // the above comment isn't entirely right. DOP is accuracy relative to specified accuracy of the module, not a value in meters
+                // eg a value of 1.0 means 1.0 times specified accuracy (typically 2m)
+                uint16_t pdop = constrain(scaleRange(gpsSol.dop.pdop, 100, 550, 9, 0), 0, 9) * 100;
+                *data = (STATE(GPS_FIX) ? 1000 : 0) + (STATE(GPS_FIX_HOME) ? 2000 : 0) + pdop + gpsSol.numSat;
+                return true;
+            } else if (featureIsEnabled(FEATURE_GPS)) {
+                *data = 0;
+                return true;
+            } else
+#endif
+            if (telemetryConfig()->pidValuesAsTelemetry) {
+                switch (t2Cnt) {
+                    case 0:
+                        tmp2 = currentPidProfile->pid[PID_ROLL].P;
+                        tmp2 += (currentPidProfile->pid[PID_PITCH].P<<8);
+                        tmp2 += (currentPidProfile->pid[PID_YAW].P<<16);
+                    break;
+                    case 1:
+                        tmp2 = currentPidProfile->pid[PID_ROLL].I;
+                        tmp2 += (currentPidProfile->pid[PID_PITCH].I<<8);
+                        tmp2 += (currentPidProfile->pid[PID_YAW].I<<16);
+                    break;
+                    case 2:
+                        tmp2 = currentPidProfile->pid[PID_ROLL].D;
+                        tmp2 += (currentPidProfile->pid[PID_PITCH].D<<8);
+                        tmp2 += (currentPidProfile->pid[PID_YAW].D<<16);
+                    break;
+                    case 3:
+                        tmp2 = currentControlRateProfile->rates[FD_ROLL];
+                        tmp2 += (currentControlRateProfile->rates[FD_PITCH]<<8);
+                        tmp2 += (currentControlRateProfile->rates[FD_YAW]<<16);
+                    break;
+                }
+                tmp2 += t2Cnt<<24;
+                t2Cnt++;
+                if (t2Cnt == 4) {
+                    t2Cnt = 0;
+                }
+                *data = tmp2;
+                return true;
+            }
+            return false;
+#if defined(USE_ADC_INTERNAL)
+        case FSSP_DATAID_T11        :
+            *data = getCoreTemperatureCelsius();
+            return true;
+#endif
+#ifdef USE_GPS
+        case FSSP_DATAID_SPEED      :
+            if (STATE(GPS_FIX)) {
+                //convert to knots: 1cm/s = 0.0194384449 knots
+                //Speed should be sent in knots/1000 (GPS speed is in cm/s)
+                *data = gpsSol.groundSpeed * 1944 / 100;
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_LATLONG    :
+            if (STATE(GPS_FIX)) {
+                uint32_t tmpui = 0;
+                // the same ID is sent twice, one for longitude, one for latitude
+                // the MSB of the sent uint32_t helps FrSky keep track
+                if (index & 1) {
+                    tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
+                    tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
+                    if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
+                }
+                else {
+                    tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
+                    tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
+                    if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
+                }
+                *data = tmpui;
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_HOME_DIST  :
+            if (STATE(GPS_FIX)) {
+                *data = GPS_distanceToHome;
+                return true;
+            }
+            return false;
+        case FSSP_DATAID_GPS_ALT    :
+            if (STATE(GPS_FIX)) {
+                *data = gpsSol.llh.altCm; // in cm according to SmartPort spec
+                return true;
+            }
+            return false;
+#endif
+        case FSSP_DATAID_A4         :
+            *data = getBatteryAverageCellVoltage(); // in 0.01V according to SmartPort spec
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the largest number of values of a sensor, the attitude
+#define SMARTPORT_SENSOR_VALUES_MAX 6
+
+// values of the sensor last taken off the schedule, sent one per slot
+static smartPortPayload_t smartPortSensorValues[SMARTPORT_SENSOR_VALUES_MAX];
+static uint8_t smartPortSensorValueCount = 0;
+static uint8_t smartPortSensorValueIndex = 0;
+
+static telemetrySensorId_e smartPortSensorOf(uint16_t id)
+{
+    switch (id) {
+        case FSSP_DATAID_VFAS       :
+        case FSSP_DATAID_A4         :
+        case FSSP_DATAID_CURRENT    :
+        case FSSP_DATAID_FUEL       :
+        case FSSP_DATAID_CAP_USED   :
+            return TELEMETRY_SENSOR_BATTERY;
+        case FSSP_DATAID_HEADING    :
+#if defined(USE_ACC)
+        case FSSP_DATAID_PITCH      :
+        case FSSP_DATAID_ROLL       :
+        case FSSP_DATAID_ACCX       :
+        case FSSP_DATAID_ACCY       :
+        case FSSP_DATAID_ACCZ       :
+#endif
+            return TELEMETRY_SENSOR_ATTITUDE;
+        case FSSP_DATAID_SPEED      :
+        case FSSP_DATAID_LATLONG    :
+        case FSSP_DATAID_GPS_ALT    :
+            return TELEMETRY_SENSOR_GPS;
+        case FSSP_DATAID_ALTITUDE   :
+            return TELEMETRY_SENSOR_ALTITUDE;
+        case FSSP_DATAID_VARIO      :
+            return TELEMETRY_SENSOR_VARIO;
+        case FSSP_DATAID_HOME_DIST  :
+        case FSSP_DATAID_T2         :
+            return TELEMETRY_SENSOR_GPS_EXTRA;
+        default:
+            // the status flags and core temperature
+            return TELEMETRY_SENSOR_FLIGHT_MODE;
+    }
+}
+
+static uint8_t smartPortValueCount(uint16_t id)
+{
+    // latitude and longitude are sent with the same id
+    return id == FSSP_DATAID_LATLONG ? 2 : 1;
+}
+
 #define ADD_SENSOR(dataId) frSkyDataIdTableInfo.table[frSkyDataIdTableInfo.index++] = dataId
 #define ADD_ESC_SENSOR(dataId) frSkyEscDataIdTableInfo.table[frSkyEscDataIdTableInfo.index++] = dataId
 
-static void initSmartPortSensors(void)
+STATIC_UNIT_TESTED void initSmartPortSensors(void)
 {
     frSkyDataIdTableInfo.index = 0;
 
@@ -408,7 +728,6 @@ static void initSmartPortSensors(void)
         }
         if (telemetryIsSensorEnabled(SENSOR_LAT_LONG)) {
             ADD_SENSOR(FSSP_DATAID_LATLONG);
-            ADD_SENSOR(FSSP_DATAID_LATLONG); // twice (one for lat, one for long)
         }
         if (telemetryIsSensorEnabled(SENSOR_DISTANCE)) {
             ADD_SENSOR(FSSP_DATAID_HOME_DIST);
@@ -422,6 +741,20 @@ static void initSmartPortSensors(void)
     frSkyDataIdTableInfo.size = frSkyDataIdTableInfo.index;
     frSkyDataIdTableInfo.index = 0;
 
+    uint8_t valueCounts[TELEMETRY_SENSOR_COUNT] = { 0 };
+    for (int i = 0; i < frSkyDataIdTableInfo.size; i++) {
+        valueCounts[smartPortSensorOf(frSkyDataIdTable[i])] += smartPortValueCount(frSkyDataIdTable[i]);
+    }
+
+    telemetrySensorsReset();
+    for (int sensor = 0; sensor < TELEMETRY_SENSOR_COUNT; sensor++) {
+        if (valueCounts[sensor]) {
+            telemetrySensorRegister(sensor, valueCounts[sensor] * sizeof(smartPortPayload_t));
+        }
+    }
+    smartPortSensorValueCount = 0;
+    smartPortSensorValueIndex = 0;
+
 #ifdef USE_ESC_SENSOR_TELEMETRY
     frSkyEscDataIdTableInfo.index = 0;
 
@@ -443,6 +776,66 @@ static void initSmartPortSensors(void)
 #endif
 }
 
+// Builds the values of a sensor from its enabled data ids, returns how many there are to send
+static uint8_t smartPortBuildSensor(telemetrySensorId_e sensor)
+{
+    uint8_t count = 0;
+
+    for (int i = 0; i < frSkyDataIdTableInfo.size; i++) {
+        const uint16_t id = frSkyDataIdTable[i];
+        if (smartPortSensorOf(id) != sensor) {
+            continue;
+        }
+        for (int index = 0; index < smartPortValueCount(id) && count < SMARTPORT_SENSOR_VALUES_MAX; index++) {
+            uint32_t data;
+            if (smartPortGetValue(id, index, &data)) {
+                smartPortPayload_t *value = &smartPortSensorValues[count++];
+                value->frameId = FSSP_DATA_FRAME;
+                value->valueId = id;
+                value->data = data;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Gets the next value to send, the values of a sensor taken off the schedule go out before the next sensor is asked for
+static bool smartPortNextValue(smartPortPayload_t *payload)
+{
+    if (smartPortSensorValueIndex >= smartPortSensorValueCount) {
+        const timeUs_t currentTimeUs = micros();
+        smartPortSensorValueIndex = 0;
+        smartPortSensorValueCount = 0;
+
+        // the due sensors whose values have not changed, or that have none, give way to the next
+        telemetrySensorId_e sensor;
+        while ((sensor = telemetrySensorNext(currentTimeUs, UINT8_MAX)) != TELEMETRY_SENSOR_NONE) {
+            const uint8_t count = smartPortBuildSensor(sensor);
+            if (telemetrySensorCommit(sensor, currentTimeUs, (const uint8_t *)smartPortSensorValues, count * sizeof(smartPortPayload_t), false) && count) {
+                smartPortSensorValueCount = count;
+                break;
+            }
+        }
+
+        if (!smartPortSensorValueCount) {
+            // nothing due, the slot carries the sensor sent longest ago
+            sensor = telemetrySensorStalest(currentTimeUs, UINT8_MAX);
+            if (sensor != TELEMETRY_SENSOR_NONE) {
+                smartPortSensorValueCount = smartPortBuildSensor(sensor);
+                telemetrySensorCommit(sensor, currentTimeUs, (const uint8_t *)smartPortSensorValues, smartPortSensorValueCount * sizeof(smartPortPayload_t), true);
+            }
+        }
+    }
+
+    if (smartPortSensorValueIndex < smartPortSensorValueCount) {
+        *payload = smartPortSensorValues[smartPortSensorValueIndex++];
+        return true;
+    }
+
+    return false;
+}
+
 bool initSmartPortTelemetry(void)
 {
     if (telemetryState == TELEMETRY_STATE_UNINITIALIZED) {
@@ -453,6 +846,7 @@ bool initSmartPortTelemetry(void)
             smartPortWriteFrame = smartPortWriteFrameInternal;
 
             initSmartPortSensors();
+            smartPortResponseInit();
 
             telemetryState = TELEMETRY_STATE_INITIALIZED_SERIAL;
         }
@@ -469,6 +863,7 @@ bool initSmartPortTelemetryExternal(smartPortWriteFrameFn *smartPortWriteFrameEx
         smartPortWriteFrame = smartPortWriteFrameExternal;
 
         initSmartPortSensors();
+        smartPortResponseInit();
 
         telemetryState = TELEMETRY_STATE_INITIALIZED_EXTERNAL;
 
@@ -484,6 +879,36 @@ static void freeSmartPortTelemetryPort(void)
     smartPortSerialPort = NULL;
 }
 
+static bool smartPortPollReady(void)
+{
+    // whether there is a frame to send is up to the response slot, which counts the misses
+    return true;
+}
+
+// Receive ISR callback, answers a poll for our sensor id with the frame armed by the task
+static void smartPortDataReceiveIsr(uint16_t c, void *data)
+{
+    UNUSED(data);
+
+    bool clearToSend = false;
+    const smartPortPayload_t *payload = smartPortDataReceive(c, &clearToSend, smartPortPollReady, true);
+    if (clearToSend) {
+        smartPortResponseSend(smartPortSerialPort);
+    }
+    if (payload && !smartPortRequestPending) {
+        smartPortRequest = *payload;
+        smartPortRequestPending = true;
+    }
+}
+
+// Idle line callback; with RX DMA the receive callback is not called, the poll is in the port's buffer
+static void smartPortIdle(void)
+{
+    while (serialRxBytesWaiting(smartPortSerialPort)) {
+        smartPortDataReceiveIsr(serialRead(smartPortSerialPort), NULL);
+    }
+}
+
 static void configureSmartPortTelemetryPort(void)
 {
     if (portConfig) {
@@ -491,7 +916,10 @@ static void configureSmartPortTelemetryPort(void)
         const portOptions_e portOptions = (telemetryConfig()->halfDuplex ? SERIAL_BIDIR : 0)
             | (telemetryConfig()->telemetry_inverted ? SERIAL_NOT_INVERTED : SERIAL_INVERTED);
 
-        smartPortSerialPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_SMARTPORT, NULL, NULL, SMARTPORT_BAUD, SMARTPORT_UART_MODE, portOptions);
+        smartPortSerialPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_SMARTPORT, smartPortDataReceiveIsr, NULL, SMARTPORT_BAUD, SMARTPORT_UART_MODE, portOptions);
+        if (smartPortSerialPort) {
+            serialSetIdleCallback(smartPortSerialPort, smartPortIdle);
+        }
     }
 }
 
@@ -521,11 +949,9 @@ static void smartPortSendMspResponse(uint8_t *data, const uint8_t dataSize)
 
 void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clearToSend, const timeUs_t *requestTimeout)
 {
-    static uint8_t smartPortIdCycleCnt = 0;
-    static uint8_t t1Cnt = 0;
-    static uint8_t t2Cnt = 0;
     static uint8_t skipRequests = 0;
 #ifdef USE_ESC_SENSOR_TELEMETRY
+    static uint8_t smartPortIdCycleCnt = 0;
     static uint8_t smartPortIdOffset = 0;
 #endif
 
@@ -573,13 +999,11 @@ void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clear
         }
 #endif
 
-        // we can send back any data we want, our tables keep track of the order and frequency of each data type we send
-        frSkyTableInfo_t * tableInfo = &frSkyDataIdTableInfo;
-
 #ifdef USE_ESC_SENSOR_TELEMETRY
-        if (smartPortIdCycleCnt >= ESC_SENSOR_PERIOD) {
-            // send ESC sensors
-            tableInfo = &frSkyEscDataIdTableInfo;
+        if (smartPortIdCycleCnt >= ESC_SENSOR_PERIOD && frSkyEscDataIdTableInfo.size) {
+            // send ESC sensors, one table of them for a motor at a time
+            frSkyTableInfo_t *tableInfo = &frSkyEscDataIdTableInfo;
+            const uint16_t id = tableInfo->table[tableInfo->index++] + smartPortIdOffset;
             if (tableInfo->index == tableInfo->size) { // end of ESC table, return to other sensors
                 tableInfo->index = 0;
                 smartPortIdCycleCnt = 0;
@@ -588,338 +1012,41 @@ void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clear
                     smartPortIdOffset = 0;
                 }
             }
-        }
-        if (smartPortIdCycleCnt < ESC_SENSOR_PERIOD) {
-            // send other sensors
-            tableInfo = &frSkyDataIdTableInfo;
-#endif
-            if (tableInfo->index == tableInfo->size) { // end of table reached, loop back
-                tableInfo->index = 0;
+
+            uint32_t data;
+            if (smartPortGetValue(id, 0, &data)) {
+                smartPortSendPackage(id, data);
+                *clearToSend = false;
             }
-#ifdef USE_ESC_SENSOR_TELEMETRY
-        }
-#endif
-        uint16_t id = tableInfo->table[tableInfo->index];
-#ifdef USE_ESC_SENSOR_TELEMETRY
-        if (smartPortIdCycleCnt >= ESC_SENSOR_PERIOD) {
-            id += smartPortIdOffset;
+            // if nothing is sent, clearToSend isn't cleared, just loop back to the start
+            continue;
         }
-#endif
         smartPortIdCycleCnt++;
-        tableInfo->index++;
-
-        int32_t tmpi;
-        uint32_t tmp2 = 0;
-        uint16_t vfasVoltage;
-
-#ifdef USE_ESC_SENSOR_TELEMETRY
-        escSensorData_t *escData;
 #endif
 
-        switch (id) {
-            case FSSP_DATAID_VFAS       :
-                vfasVoltage = telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage();
-                smartPortSendPackage(id, vfasVoltage); // in 0.01V according to SmartPort spec
-                *clearToSend = false;
-                break;
-#ifdef USE_ESC_SENSOR_TELEMETRY
-            case FSSP_DATAID_VFAS1      :
-            case FSSP_DATAID_VFAS2      :
-            case FSSP_DATAID_VFAS3      :
-            case FSSP_DATAID_VFAS4      :
-            case FSSP_DATAID_VFAS5      :
-            case FSSP_DATAID_VFAS6      :
-            case FSSP_DATAID_VFAS7      :
-            case FSSP_DATAID_VFAS8      :
-                escData = getEscSensorData(id - FSSP_DATAID_VFAS1);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, escData->voltage);
-                    *clearToSend = false;
-                }
-                break;
-#endif
-            case FSSP_DATAID_CURRENT    :
-                smartPortSendPackage(id, getAmperage() / 10); // in 0.1A according to SmartPort spec
-                *clearToSend = false;
-                break;
-#ifdef USE_ESC_SENSOR_TELEMETRY
-            case FSSP_DATAID_CURRENT1   :
-            case FSSP_DATAID_CURRENT2   :
-            case FSSP_DATAID_CURRENT3   :
-            case FSSP_DATAID_CURRENT4   :
-            case FSSP_DATAID_CURRENT5   :
-            case FSSP_DATAID_CURRENT6   :
-            case FSSP_DATAID_CURRENT7   :
-            case FSSP_DATAID_CURRENT8   :
-                escData = getEscSensorData(id - FSSP_DATAID_CURRENT1);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, escData->current);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_RPM        :
-                escData = getEscSensorData(ESC_SENSOR_COMBINED);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, lrintf(erpmToRpm(escData->rpm)));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_RPM1       :
-            case FSSP_DATAID_RPM2       :
-            case FSSP_DATAID_RPM3       :
-            case FSSP_DATAID_RPM4       :
-            case FSSP_DATAID_RPM5       :
-            case FSSP_DATAID_RPM6       :
-            case FSSP_DATAID_RPM7       :
-            case FSSP_DATAID_RPM8       :
-                escData = getEscSensorData(id - FSSP_DATAID_RPM1);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, lrintf(erpmToRpm(escData->rpm)));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_TEMP        :
-                escData = getEscSensorData(ESC_SENSOR_COMBINED);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, escData->temperature);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_TEMP1      :
-            case FSSP_DATAID_TEMP2      :
-            case FSSP_DATAID_TEMP3      :
-            case FSSP_DATAID_TEMP4      :
-            case FSSP_DATAID_TEMP5      :
-            case FSSP_DATAID_TEMP6      :
-            case FSSP_DATAID_TEMP7      :
-            case FSSP_DATAID_TEMP8      :
-                escData = getEscSensorData(id - FSSP_DATAID_TEMP1);
-                if (escData != NULL) {
-                    smartPortSendPackage(id, escData->temperature);
-                    *clearToSend = false;
-                }
-                break;
-#endif
-            case FSSP_DATAID_ALTITUDE   :
-                smartPortSendPackage(id, getEstimatedAltitudeCm()); // in cm according to SmartPort spec
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_FUEL       :
-                {
-                    uint32_t data;
-                    if (batteryConfig()->batteryCapacity > 0) {
-                        data = calculateBatteryPercentageRemaining();
-                    } else {
-                        data = getMAhDrawn();
-                    }
-                    smartPortSendPackage(id, data);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_CAP_USED   :
-                smartPortSendPackage(id, getMAhDrawn()); // given in mAh, should be in percent according to SmartPort spec
-                *clearToSend = false;
-                break;
-#if defined(USE_VARIO)
-            case FSSP_DATAID_VARIO      :
-                smartPortSendPackage(id, getEstimatedVario()); // in cm/s according to SmartPort spec
-                *clearToSend = false;
-                break;
-#endif
-            case FSSP_DATAID_HEADING    :
-                smartPortSendPackage(id, attitude.values.yaw * 10); // in degrees * 100 according to SmartPort spec
-                *clearToSend = false;
-                break;
-#if defined(USE_ACC)
-            case FSSP_DATAID_PITCH      :
-                smartPortSendPackage(id, attitude.values.pitch); // given in 10*deg
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_ROLL       :
-                smartPortSendPackage(id, attitude.values.roll); // given in 10*deg
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_ACCX       :
-                smartPortSendPackage(id, lrintf(100 * acc.accADC.x * acc.dev.acc_1G_rec)); // Multiply by 100 to show as x.xx g on Taranis
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_ACCY       :
-                smartPortSendPackage(id, lrintf(100 * acc.accADC.y * acc.dev.acc_1G_rec));
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_ACCZ       :
-                smartPortSendPackage(id, lrintf(100 * acc.accADC.z * acc.dev.acc_1G_rec));
-                *clearToSend = false;
-                break;
-#endif
-            case FSSP_DATAID_T1         :
-                // we send all the flags as decimal digits for easy reading
-
-                // the t1Cnt simply allows the telemetry view to show at least some changes
-                t1Cnt++;
-                if (t1Cnt == 4) {
-                    t1Cnt = 1;
-                }
-                tmpi = t1Cnt * 10000; // start off with at least one digit so the most significant 0 won't be cut off
-                // the Taranis seems to be able to fit 5 digits on the screen
-                // the Taranis seems to consider this number a signed 16 bit integer
-
-                if (!isArmingDisabled()) {
-                    tmpi += 1;
-                } else {
-                    tmpi += 2;
-                }
-                if (ARMING_FLAG(ARMED)) {
-                    tmpi += 4;
-                }
-
-                if (FLIGHT_MODE(ANGLE_MODE | ALT_HOLD_MODE | POS_HOLD_MODE)) {
-                    tmpi += 10;
-                }
-                if (FLIGHT_MODE(HORIZON_MODE)) {
-                    tmpi += 20;
-                }
-                if (FLIGHT_MODE(PASSTHRU_MODE)) {
-                    tmpi += 40;
-                }
-
-                if (FLIGHT_MODE(MAG_MODE)) {
-                    tmpi += 100;
-                }
-
-                if (FLIGHT_MODE(HEADFREE_MODE)) {
-                    tmpi += 4000;
-                }
-
-                smartPortSendPackage(id, (uint32_t)tmpi);
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_T2         :
-#ifdef USE_GPS
-                if (sensors(SENSOR_GPS)) {
-                    // satellite accuracy PDOP: 0 = worst [PDOP > 5.5m], 9 = best [PDOP <= 1.0m]
-                    // the above comment isn't entirely right. DOP is accuracy relative to specified accuracy of the module, not a value in meters
-                    // eg a value of 1.0 means 1.0 times specified accuracy (typically 2m)
-                    uint16_t pdop = constrain(scaleRange(gpsSol.dop.pdop, 100, 550, 9, 0), 0, 9) * 100;
-                    smartPortSendPackage(id, (STATE(GPS_FIX) ? 1000 : 0) + (STATE(GPS_FIX_HOME) ? 2000 : 0) + pdop + gpsSol.numSat);
-                    *clearToSend = false;
-                } else if (featureIsEnabled(FEATURE_GPS)) {
-                    smartPortSendPackage(id, 0);
-                    *clearToSend = false;
-                } else
-#endif
-                if (telemetryConfig()->pidValuesAsTelemetry) {
-                    switch (t2Cnt) {
-                        case 0:
-                            tmp2 = currentPidProfile->pid[PID_ROLL].P;
-                            tmp2 += (currentPidProfile->pid[PID_PITCH].P<<8);
-                            tmp2 += (currentPidProfile->pid[PID_YAW].P<<16);
-                        break;
-                        case 1:
-                            tmp2 = currentPidProfile->pid[PID_ROLL].I;
-                            tmp2 += (currentPidProfile->pid[PID_PITCH].I<<8);
-                            tmp2 += (currentPidProfile->pid[PID_YAW].I<<16);
-                        break;
-                        case 2:
-                            tmp2 = currentPidProfile->pid[PID_ROLL].D;
-                            tmp2 += (currentPidProfile->pid[PID_PITCH].D<<8);
-                            tmp2 += (currentPidProfile->pid[PID_YAW].D<<16);
-                        break;
-                        case 3:
-                            tmp2 = currentControlRateProfile->rates[FD_ROLL];
-                            tmp2 += (currentControlRateProfile->rates[FD_PITCH]<<8);
-                            tmp2 += (currentControlRateProfile->rates[FD_YAW]<<16);
-                        break;
-                    }
-                    tmp2 += t2Cnt<<24;
-                    t2Cnt++;
-                    if (t2Cnt == 4) {
-                        t2Cnt = 0;
-                    }
-                    smartPortSendPackage(id, tmp2);
-                    *clearToSend = false;
-                }
-
-                break;
-#if defined(USE_ADC_INTERNAL)
-            case FSSP_DATAID_T11        :
-                smartPortSendPackage(id, getCoreTemperatureCelsius());
-                *clearToSend = false;
-                break;
-#endif
-#ifdef USE_GPS
-            case FSSP_DATAID_SPEED      :
-                if (STATE(GPS_FIX)) {
-                    //convert to knots: 1cm/s = 0.0194384449 knots
-                    //Speed should be sent in knots/1000 (GPS speed is in cm/s)
-                    uint32_t tmpui = gpsSol.groundSpeed * 1944 / 100;
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_LATLONG    :
-                if (STATE(GPS_FIX)) {
-                    uint32_t tmpui = 0;
-                    // the same ID is sent twice, one for longitude, one for latitude
-                    // the MSB of the sent uint32_t helps FrSky keep track
-                    // the even/odd bit of our counter helps us keep track
-                    if (tableInfo->index & 1) {
-                        tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
-                    }
-                    else {
-                        tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
-                    }
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_HOME_DIST  :
-                if (STATE(GPS_FIX)) {
-                    smartPortSendPackage(id, GPS_distanceToHome);
-                     *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_GPS_ALT    :
-                if (STATE(GPS_FIX)) {
-                    smartPortSendPackage(id, gpsSol.llh.altCm); // in cm according to SmartPort spec
-                    *clearToSend = false;
-                }
-                break;
-#endif
-            case FSSP_DATAID_A4         :
-                vfasVoltage = getBatteryAverageCellVoltage(); // in 0.01V according to SmartPort spec
-                smartPortSendPackage(id, vfasVoltage);
-                *clearToSend = false;
-                break;
-            default:
-                break;
-                // if nothing is sent, hasRequest isn't cleared, we already incremented the counter, just loop back to the start
+        // the shared sensor schedule keeps track of the order and frequency of the values we send
+        smartPortPayload_t value;
+        if (smartPortNextValue(&value)) {
+            smartPortSendPackage(value.valueId, value.data);
+            *clearToSend = false;
         }
     }
 }
 
-static bool serialReadyToSend(void)
-{
-    return (serialRxBytesWaiting(smartPortSerialPort) == 0);
-}
-
 void handleSmartPortTelemetry(void)
 {
     const timeUs_t requestTimeout = micros() + SMARTPORT_SERVICE_TIMEOUT_US;
 
     if (telemetryState == TELEMETRY_STATE_INITIALIZED_SERIAL && smartPortSerialPort) {
-        smartPortPayload_t *payload = NULL;
-        bool clearToSend = false;
-        while (serialRxBytesWaiting(smartPortSerialPort) > 0 && !payload) {
-            uint8_t c = serialRead(smartPortSerialPort);
-            payload = smartPortDataReceive(c, &clearToSend, serialReadyToSend, true);
+        smartPortPayload_t *payload = smartPortRequestPending ? &smartPortRequest : NULL;
+        // build the next frame once the last one went out, the poll sends it
+        bool clearToSend = !smartPortResponseIsArmed();
+
+        processSmartPortTelemetry(payload, &clearToSend, &requestTimeout);
+        if (payload) {
+            // a request received while this one was processed is kept for the next run
+            smartPortRequestPending = false;
         }
-
-            processSmartPortTelemetry(payload, &clearToSend, &requestTimeout);
     }
 }
 #endif
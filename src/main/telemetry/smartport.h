@@ -72,7 +72,6 @@ void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *hasRe
 
 smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPortReadyToSendFn *checkQueueEmpty, bool withChecksum);
 
-struct serialPort_s;
-void smartPortWriteFrameSerial(const smartPortPayload_t *payload, struct serialPort_s *port, uint16_t checksum);
-void smartPortSendByte(uint8_t c, uint16_t *checksum, struct serialPort_s *port);
+// Escapes the payload and its checksum, continuing the checksum of any header already written, into the response slot and arms it
+void smartPortArmFrame(const smartPortPayload_t *payload, uint16_t checksum);
 bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload);
@@ -0,0 +1,159 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Response slot of the SmartPort and FPort telemetry.
+ *
+ * A sensor has to answer a poll within a short window, which the telemetry task used to meet only when
+ * it happened to run in time. Instead the task builds the next frame, escaped and with its checksum, as
+ * soon as the last one went out and arms it. The poll is then answered from wherever it is detected, by
+ * writing the armed frame to the port as it is, so the response no longer depends on when the task runs.
+ *
+ * The slot has a single producer, the task, and a single consumer, the poll; the frame is only written
+ * while nothing is armed and only read while it is.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_TELEMETRY_SMARTPORT
+
+#include "drivers/serial.h"
+
+#include "rx/frsky_crc.h"
+
+#include "telemetry/smartport.h"
+#include "telemetry/smartport_response.h"
+
+static uint8_t frame[SMARTPORT_RESPONSE_FRAME_SIZE_MAX];
+static uint8_t frameLength;
+static smartPortResponseStats_t *volatile frameStats;
+static volatile bool armed;
+
+// polls that found nothing armed, the task has yet to build the frame scheduled for them and charges them when it is armed
+static volatile uint32_t missCount;
+static uint32_t missCountCharged;
+
+static smartPortResponseStats_t stats[SMARTPORT_RESPONSE_STATS_COUNT];
+static uint8_t statsCount;
+
+void smartPortResponseInit(void)
+{
+    armed = false;
+    frameLength = 0;
+    frameStats = NULL;
+    missCount = 0;
+    missCountCharged = 0;
+    memset(stats, 0, sizeof(stats));
+    statsCount = 0;
+}
+
+bool smartPortResponseIsArmed(void)
+{
+    return armed;
+}
+
+void smartPortResponseStart(void)
+{
+    frameLength = 0;
+}
+
+void smartPortResponseWrite(uint8_t c, uint16_t *checksum)
+{
+    if (frameLength + 2 > SMARTPORT_RESPONSE_FRAME_SIZE_MAX) {
+        return;
+    }
+    if (c == FSSP_DLE || c == FSSP_START_STOP) {
+        frame[frameLength++] = FSSP_DLE;
+        frame[frameLength++] = c ^ FSSP_DLE_XOR;
+    } else {
+        frame[frameLength++] = c;
+    }
+
+    if (checksum != NULL) {
+        frskyCheckSumStep(checksum, c);
+    }
+}
+
+static smartPortResponseStats_t *findStats(uint16_t valueId)
+{
+    for (unsigned i = 0; i < statsCount; i++) {
+        if (stats[i].valueId == valueId) {
+            return &stats[i];
+        }
+    }
+    if (statsCount < SMARTPORT_RESPONSE_STATS_COUNT) {
+        stats[statsCount].valueId = valueId;
+        return &stats[statsCount++];
+    }
+    return NULL;
+}
+
+void smartPortResponseArm(uint16_t valueId)
+{
+    smartPortResponseStats_t *armedStats = findStats(valueId);
+    frameStats = armedStats;
+    armed = true;
+
+    // a poll finding the frame armed answers it, the misses counted up to here were waiting for this frame
+    const uint32_t misses = missCount;
+    if (armedStats) {
+        armedStats->misses += misses - missCountCharged;
+    }
+    missCountCharged = misses;
+}
+
+bool smartPortResponseSend(serialPort_t *port)
+{
+    if (!armed) {
+        smartPortResponseMiss();
+        return false;
+    }
+
+    serialWriteBuf(port, frame, frameLength);
+    if (frameStats) {
+        frameStats->hits++;
+    }
+    armed = false;
+
+    return true;
+}
+
+void smartPortResponseMiss(void)
+{
+    if (armed) {
+        // the window passed with the frame scheduled for the poll armed, it stays armed for the next one
+        if (frameStats) {
+            frameStats->misses++;
+        }
+    } else {
+        missCount++;
+    }
+}
+
+const smartPortResponseStats_t *smartPortResponseGetStats(unsigned index)
+{
+    return index < statsCount ? &stats[index] : NULL;
+}
+
+#endif // USE_TELEMETRY_SMARTPORT
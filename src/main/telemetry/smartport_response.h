@@ -0,0 +1,56 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// an FPort response with every byte escaped: length, type, payload and checksum
+#define SMARTPORT_RESPONSE_FRAME_SIZE_MAX   (2 * (2 + 7 + 1))
+#define SMARTPORT_RESPONSE_STATS_COUNT      24
+#define SMARTPORT_RESPONSE_ID_OTHER         0       // MSP and empty frames
+
+typedef struct smartPortResponseStats_s {
+    uint16_t valueId;
+    // updated by the poll, from the receive interrupt
+    volatile uint32_t hits;     // frames sent in the response window of a poll
+    volatile uint32_t misses;   // polls this frame was scheduled for but did not answer
+} smartPortResponseStats_t;
+
+struct serialPort_s;
+
+void smartPortResponseInit(void);
+
+// The task builds the next frame whenever none is armed
+bool smartPortResponseIsArmed(void);
+void smartPortResponseStart(void);
+void smartPortResponseWrite(uint8_t c, uint16_t *checksum);
+void smartPortResponseArm(uint16_t valueId);
+
+// Called in the response window of a poll, from the receive interrupt or the RX frame check.
+// Sends the armed frame, or counts a miss if there is none. A poll whose window has passed is a miss
+// of the armed frame, one that found nothing armed is a miss of the frame armed next.
+bool smartPortResponseSend(struct serialPort_s *port);
+void smartPortResponseMiss(void);
+
+// Returns NULL past the last sensor seen
+const smartPortResponseStats_t *smartPortResponseGetStats(unsigned index);
@@ -84,6 +84,7 @@ typedef struct telemetryConfig_s {
     uint8_t report_cell_voltage;
     uint8_t flysky_sensors[IBUS_SENSOR_COUNT];
     uint16_t mavlink_mah_as_heading_divisor;
+    uint8_t mavlink_version;                // 1 or 2, a link switches to 2 when a MAVLink 2 frame is received
     uint32_t disabledSensors; // bit flags
 } telemetryConfig_t;
 
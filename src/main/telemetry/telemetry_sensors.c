@@ -0,0 +1,218 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Shared schedule of the telemetry sensors.
+ *
+ * A protocol registers the sensors it can send with the size of their frames and asks for the next
+ * sensor whenever it has a slot. Each sensor is due once its interval has passed since it was last
+ * sent, and of the due sensors the one most overdue, weighed by its priority, is built first. The
+ * frame built is compared with the one last sent, an unchanged frame is dropped until its keepalive
+ * interval has passed, leaving the slot to the other sensors. A slot no sensor is due for carries
+ * the sensor sent longest ago, so the link is never left idle.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_TELEMETRY
+
+#include "common/crc.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "telemetry/telemetry_sensors.h"
+
+#define TELEMETRY_SENSOR_RATE_WINDOW_US 1000000
+
+typedef struct telemetrySensorState_s {
+    bool registered;
+    bool sent;                      // lastSentUs and fingerprint are valid
+    uint8_t size;
+    timeUs_t lastSentUs;
+    timeUs_t lastCheckedUs;         // last time the sensor was due, sent or not
+    uint32_t fingerprint;
+    uint32_t sentCount;
+    uint32_t unchangedCount;
+    timeUs_t windowStartUs;
+    uint16_t windowCount;
+    uint16_t rateCentiHz;
+} telemetrySensorState_t;
+
+static const telemetrySensorInfo_t telemetrySensorInfos[TELEMETRY_SENSOR_COUNT] = {
+    // the intervals are those of the fixed 10Hz schedule the protocols used, the priorities order the sensors when slots are short
+    [TELEMETRY_SENSOR_BATTERY]     = { "BATTERY",     100, 1000, 3 },
+    [TELEMETRY_SENSOR_ATTITUDE]    = { "ATTITUDE",    100, 1000, 3 },
+    [TELEMETRY_SENSOR_GPS]         = { "GPS",         100, 1000, 3 },
+    [TELEMETRY_SENSOR_ALTITUDE]    = { "ALTITUDE",    100, 1000, 2 },
+    [TELEMETRY_SENSOR_VARIO]       = { "VARIO",       100, 1000, 2 },
+    [TELEMETRY_SENSOR_GPS_EXTRA]   = { "GPS_EXTRA",   100, 2000, 1 },
+    [TELEMETRY_SENSOR_FLIGHT_MODE] = { "FLIGHT_MODE", 100, 2000, 1 },
+};
+
+static telemetrySensorState_t telemetrySensors[TELEMETRY_SENSOR_COUNT];
+
+void telemetrySensorsReset(void)
+{
+    memset(telemetrySensors, 0, sizeof(telemetrySensors));
+}
+
+void telemetrySensorRegister(telemetrySensorId_e id, uint8_t size)
+{
+    if (id >= TELEMETRY_SENSOR_COUNT) {
+        return;
+    }
+
+    telemetrySensors[id].registered = true;
+    telemetrySensors[id].size = size;
+}
+
+uint8_t telemetrySensorsRegisteredCount(void)
+{
+    uint8_t count = 0;
+    for (int i = 0; i < TELEMETRY_SENSOR_COUNT; i++) {
+        count += telemetrySensors[i].registered;
+    }
+    return count;
+}
+
+static void telemetrySensorSent(telemetrySensorState_t *sensor, uint32_t fingerprint, timeUs_t currentTimeUs)
+{
+    if (sensor->sent) {
+        // the rate is taken over the sends following the one that started the window
+        const timeDelta_t windowUs = cmpTimeUs(currentTimeUs, sensor->windowStartUs);
+        sensor->windowCount++;
+        if (windowUs >= TELEMETRY_SENSOR_RATE_WINDOW_US) {
+            sensor->rateCentiHz = (uint64_t)sensor->windowCount * 100 * 1000000 / windowUs;
+            sensor->windowCount = 0;
+            sensor->windowStartUs = currentTimeUs;
+        }
+    } else {
+        sensor->windowStartUs = currentTimeUs;
+    }
+
+    sensor->sent = true;
+    sensor->lastSentUs = currentTimeUs;
+    sensor->lastCheckedUs = currentTimeUs;
+    sensor->fingerprint = fingerprint;
+    sensor->sentCount++;
+}
+
+telemetrySensorId_e telemetrySensorNext(timeUs_t currentTimeUs, uint8_t maxSize)
+{
+    telemetrySensorId_e next = TELEMETRY_SENSOR_NONE;
+    uint32_t nextScore = 0;
+
+    for (int id = 0; id < TELEMETRY_SENSOR_COUNT; id++) {
+        const telemetrySensorState_t *sensor = &telemetrySensors[id];
+        const telemetrySensorInfo_t *info = &telemetrySensorInfos[id];
+
+        if (!sensor->registered || sensor->size > maxSize) {
+            continue;
+        }
+
+        // never sent sensors go first, in order of priority
+        uint32_t score = UINT32_MAX - id;
+        if (sensor->sent) {
+            const timeDelta_t sinceCheckedUs = cmpTimeUs(currentTimeUs, sensor->lastCheckedUs);
+            if (sinceCheckedUs < info->intervalMs * 1000) {
+                continue;
+            }
+            // how overdue, per mille of the interval, capped to stay clear of the never sent sensors
+            const timeDelta_t sinceSentUs = MIN(cmpTimeUs(currentTimeUs, sensor->lastSentUs), 60 * 1000000);
+            score = (uint32_t)sinceSentUs / info->intervalMs * info->priority;
+        }
+        if (next == TELEMETRY_SENSOR_NONE || score > nextScore) {
+            next = id;
+            nextScore = score;
+        }
+    }
+
+    return next;
+}
+
+telemetrySensorId_e telemetrySensorStalest(timeUs_t currentTimeUs, uint8_t maxSize)
+{
+    telemetrySensorId_e stalest = TELEMETRY_SENSOR_NONE;
+    timeDelta_t stalestUs = -1;
+
+    for (int id = 0; id < TELEMETRY_SENSOR_COUNT; id++) {
+        const telemetrySensorState_t *sensor = &telemetrySensors[id];
+        if (!sensor->registered || sensor->size > maxSize) {
+            continue;
+        }
+        const timeDelta_t sinceSentUs = sensor->sent ? cmpTimeUs(currentTimeUs, sensor->lastSentUs) : INT32_MAX;
+        if (sinceSentUs > stalestUs) {
+            stalest = id;
+            stalestUs = sinceSentUs;
+        }
+    }
+
+    return stalest;
+}
+
+bool telemetrySensorCommit(telemetrySensorId_e id, timeUs_t currentTimeUs, const uint8_t *frame, uint8_t length, bool force)
+{
+    if (id >= TELEMETRY_SENSOR_COUNT) {
+        return false;
+    }
+
+    telemetrySensorState_t *sensor = &telemetrySensors[id];
+    const uint32_t fingerprint = fnv_update(0x811C9DC5, frame, length);
+
+    if (!force && sensor->sent && fingerprint == sensor->fingerprint
+        && cmpTimeUs(currentTimeUs, sensor->lastSentUs) < telemetrySensorInfos[id].keepaliveMs * 1000) {
+        // unchanged, check again once the interval has passed
+        sensor->lastCheckedUs = currentTimeUs;
+        sensor->unchangedCount++;
+        return false;
+    }
+
+    telemetrySensorSent(sensor, fingerprint, currentTimeUs);
+    return true;
+}
+
+const telemetrySensorInfo_t *telemetrySensorInfo(telemetrySensorId_e id)
+{
+    return id < TELEMETRY_SENSOR_COUNT ? &telemetrySensorInfos[id] : NULL;
+}
+
+void telemetrySensorGetStats(telemetrySensorId_e id, timeUs_t currentTimeUs, telemetrySensorStats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (id >= TELEMETRY_SENSOR_COUNT) {
+        return;
+    }
+
+    const telemetrySensorState_t *sensor = &telemetrySensors[id];
+    stats->registered = sensor->registered;
+    stats->size = sensor->size;
+    stats->sent = sensor->sentCount;
+    stats->unchanged = sensor->unchangedCount;
+    // a sensor that stopped being sent has no rate
+    if (sensor->sent && cmpTimeUs(currentTimeUs, sensor->windowStartUs) < 2 * TELEMETRY_SENSOR_RATE_WINDOW_US) {
+        stats->rateCentiHz = sensor->rateCentiHz;
+    }
+}
+
+#endif
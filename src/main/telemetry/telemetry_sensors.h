@@ -0,0 +1,69 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/time.h"
+
+// Sensors shared by the frame based telemetry protocols, in order of the default priority
+typedef enum {
+    TELEMETRY_SENSOR_BATTERY = 0,
+    TELEMETRY_SENSOR_ATTITUDE,
+    TELEMETRY_SENSOR_GPS,
+    TELEMETRY_SENSOR_ALTITUDE,
+    TELEMETRY_SENSOR_VARIO,
+    TELEMETRY_SENSOR_GPS_EXTRA,     // satellites, home distance and direction
+    TELEMETRY_SENSOR_FLIGHT_MODE,
+    TELEMETRY_SENSOR_COUNT,
+    TELEMETRY_SENSOR_NONE = TELEMETRY_SENSOR_COUNT
+} telemetrySensorId_e;
+
+typedef struct telemetrySensorInfo_s {
+    const char *name;
+    uint16_t intervalMs;            // the sensor is due this long after it was last sent
+    uint16_t keepaliveMs;           // an unchanged value is sent again this long after it was last sent
+    uint8_t priority;               // weighs how overdue a sensor is, higher is sent first
+} telemetrySensorInfo_t;
+
+typedef struct telemetrySensorStats_s {
+    bool registered;
+    uint8_t size;
+    uint32_t sent;
+    uint32_t unchanged;             // due but not sent as the value had not changed
+    uint16_t rateCentiHz;           // sent per second over the last second, * 100
+} telemetrySensorStats_t;
+
+void telemetrySensorsReset(void);
+void telemetrySensorRegister(telemetrySensorId_e id, uint8_t size);
+uint8_t telemetrySensorsRegisteredCount(void);
+
+// Returns the most overdue registered sensor whose frame fits in maxSize bytes, TELEMETRY_SENSOR_NONE if none
+// is due. The caller builds its frame and passes it to telemetrySensorCommit().
+telemetrySensorId_e telemetrySensorNext(timeUs_t currentTimeUs, uint8_t maxSize);
+
+// Returns the registered sensor sent longest ago whose frame fits in maxSize bytes, to fill a slot no sensor is due for
+telemetrySensorId_e telemetrySensorStalest(timeUs_t currentTimeUs, uint8_t maxSize);
+
+// Returns true if the frame built for the sensor is to be sent, which it is taken to be. A frame equal to the one
+// last sent is dropped until the keepalive interval has passed, unless forced; ask for the next sensor then.
+bool telemetrySensorCommit(telemetrySensorId_e id, timeUs_t currentTimeUs, const uint8_t *frame, uint8_t length, bool force);
+
+const telemetrySensorInfo_t *telemetrySensorInfo(telemetrySensorId_e id);
+void telemetrySensorGetStats(telemetrySensorId_e id, timeUs_t currentTimeUs, telemetrySensorStats_t *stats);
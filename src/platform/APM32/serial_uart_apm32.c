@@ -119,9 +119,13 @@ void uartReconfigure(uartPort_t *uartPort)
 
             /* Enable the UART Data Register not empty Interrupt */
             SET_BIT(uartPort->USARTx->CTRL1, USART_CTRL1_RXBNEIEN);
+        }
 
-            /* Enable Idle Line detection */
+        /* Enable Idle Line detection for ports with an idle callback, with RX DMA it tells the receiver a burst is complete in the DMA buffer */
+        if (uartPort->port.idleCallback) {
             SET_BIT(uartPort->USARTx->CTRL1, USART_CTRL1_IDLEIEN);
+        } else {
+            CLEAR_BIT(uartPort->USARTx->CTRL1, USART_CTRL1_IDLEIEN);
         }
     }
 
@@ -288,8 +288,10 @@ FAST_IRQ_HANDLER void uartIrqHandler(uartPort_t *s)
     /* UART in mode Receiver ---------------------------------------------------*/
     if (!s->rxDMAResource && (((isrflags & USART_STS_RXBNEFLG) != RESET) && ((cr1its & USART_CTRL1_RXBNEIEN) != RESET))) {
         if (s->port.rxCallback) {
+            serialStatsRxCallback(&s->port);
             s->port.rxCallback(huart->Instance->DATA, s->port.rxCallbackData);
         } else {
+            serialStatsRxStore(&s->port);
             s->port.rxBuffer[s->port.rxBufferHead] = huart->Instance->DATA;
             s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
         }
@@ -315,6 +317,7 @@ FAST_IRQ_HANDLER void uartIrqHandler(uartPort_t *s)
     if (((isrflags & USART_STS_OVREFLG) != RESET) && (((cr1its & USART_CTRL1_RXBNEIEN) != RESET)
                                                  || ((cr3its & USART_CTRL3_ERRIEN) != RESET))) {
         __DAL_UART_CLEAR_OREFLAG(huart);
+        serialStatsRxOverrun(&s->port);
     }
 
     if (((isrflags & USART_STS_IDLEFLG) != RESET) && ((cr1its & USART_STS_IDLEFLG) != RESET)) {
@@ -30,6 +30,8 @@
 #include "build/debug.h"
 #include "build/debug_pin.h"
 
+#include "common/utils.h"
+
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
 #include "drivers/dma.h"
@@ -40,6 +42,7 @@
 #include "drivers/dshot_command.h"
 #include "drivers/motor.h"
 #include "drivers/nvic.h"
+#include "drivers/system.h"
 #include "pwm_output_dshot_shared.h"
 #include "drivers/dshot_bitbang_decode.h"
 #include "drivers/time.h"
@@ -494,12 +497,21 @@ static bool bbDecodeTelemetry(void)
             SCB_InvalidateDCache_by_Addr((uint32_t *)bbPort->portInputBuffer, DSHOT_BB_PORT_IP_BUF_CACHE_ALIGN_BYTES);
         }
 #endif
+        // all motors of a port are decoded from one pass over its samples
+        const uint32_t decodeStartCycles = getCycleCounter();
+        uint16_t pinMasks[MAX_SUPPORTED_MOTOR_PORTS] = { 0 };
         for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < dshotMotorCount; motorIndex++) {
+            pinMasks[bbMotors[motorIndex].bbPort - bbPorts] |= 1 << bbMotors[motorIndex].pinIndex;
+        }
+        uint32_t rawValues[MAX_SUPPORTED_MOTOR_PORTS][DSHOT_BB_PORT_PIN_COUNT];
+        for (int i = 0; i < usedMotorPorts; i++) {
+            decode_bb_port(bbPorts[i].portInputBuffer, bbPorts[i].portInputCount, pinMasks[i], rawValues[i]);
+        }
+        DEBUG_SET(DEBUG_DSHOT_TELEMETRY_COUNTS, 4, clockCyclesTo10thMicros(cmp32(getCycleCounter(), decodeStartCycles)));
 
-            uint32_t rawValue = decode_bb_bitband(
-                bbMotors[motorIndex].bbPort->portInputBuffer,
-                bbMotors[motorIndex].bbPort->portInputCount,
-                bbMotors[motorIndex].pinIndex);
+        for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < dshotMotorCount; motorIndex++) {
+            const bbMotor_t *bbMotor = &bbMotors[motorIndex];
+            uint32_t rawValue = rawValues[bbMotor->bbPort - bbPorts][bbMotor->pinIndex];
 
             if (rawValue == DSHOT_TELEMETRY_NOEDGE) {
                 DEBUG_SET(DEBUG_DSHOT_TELEMETRY_COUNTS, 1, debug[1] + 1);
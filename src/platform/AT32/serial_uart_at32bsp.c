@@ -121,8 +121,10 @@ void uartReconfigure(uartPort_t *uartPort)
         } else {
             usart_flag_clear(uartPort->USARTx, USART_RDBF_FLAG);
             usart_interrupt_enable(uartPort->USARTx, USART_RDBF_INT, TRUE);
-            usart_interrupt_enable(uartPort->USARTx, USART_IDLE_INT, TRUE);
         }
+        // only ports with an idle callback take the idle line interrupt, with RX DMA it is
+        // the only point the receiver learns about data in the DMA buffer
+        usart_interrupt_enable(uartPort->USARTx, USART_IDLE_INT, uartPort->port.idleCallback ? TRUE : FALSE);
     }
 
     // Transmit DMA or IRQ
@@ -270,8 +272,10 @@ void uartIrqHandler(uartPort_t *s)
 {
     if (!s->rxDMAResource && (usart_flag_get(s->USARTx, USART_RDBF_FLAG) == SET)) {
         if (s->port.rxCallback) {
+            serialStatsRxCallback(&s->port);
             s->port.rxCallback(s->USARTx->dt, s->port.rxCallbackData);
         } else {
+            serialStatsRxStore(&s->port);
             s->port.rxBuffer[s->port.rxBufferHead] = s->USARTx->dt;
             s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
         }
@@ -296,6 +300,7 @@ void uartIrqHandler(uartPort_t *s)
 
     if (usart_flag_get(s->USARTx, USART_ROERR_FLAG) == SET) {
         usart_flag_clear(s->USARTx, USART_ROERR_FLAG);
+        serialStatsRxOverrun(&s->port);
     }
 
     if (usart_flag_get(s->USARTx, USART_IDLEF_FLAG) == SET) {
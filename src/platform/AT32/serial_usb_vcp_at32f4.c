@@ -476,6 +476,7 @@ static const struct serialPortVTable usbVTable[] = {
         .setMode = usbVcpSetMode,
         .setCtrlLineStateCb = usbVcpSetCtrlLineStateCb,
         .setBaudRateCb = usbVcpSetBaudRateCb,
+        .setIdleCallback = NULL,
         .writeBuf =  usbVcpWriteBuf,
         .beginWrite = usbVcpBeginWrite,
         .endWrite = usbVcpEndWrite
@@ -681,6 +681,9 @@ bool loadEEPROMFromFile(void)
         return false;
     }
 
+    // Start from erased flash, so that a new or short file can be journaled behind the saved copy
+    memset(eepromData, CONFIG_ERASED_BYTE, sizeof(eepromData));
+
     // open or create
     eepromFd = fopen(EEPROM_FILENAME, "r+");
     if (eepromFd != NULL) {
@@ -735,6 +738,11 @@ configStreamerResult_e configWriteWord(uintptr_t address, config_streamer_buffer
     STATIC_ASSERT(CONFIG_STREAMER_BUFFER_SIZE == sizeof(uint32_t), "CONFIG_STREAMER_BUFFER_SIZE does not match written size");
 
     if ((address >= (uintptr_t)eepromData) && (address + sizeof(uint32_t) <= (uintptr_t)ARRAYEND(eepromData))) {
+        // As on flash, a page is erased when the streamer enters it
+        const size_t offset = address - (uintptr_t)eepromData;
+        if (offset % FLASH_PAGE_SIZE == 0) {
+            memset((void*)address, CONFIG_ERASED_BYTE, MIN((size_t)FLASH_PAGE_SIZE, sizeof(eepromData) - offset));
+        }
         memcpy((void*)address, buffer, sizeof(config_streamer_buffer_type_t));
         printf("[FLASH_ProgramWord]%p = %08x\n", (void*)address, *((uint32_t*)address));
     } else {
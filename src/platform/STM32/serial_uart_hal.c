@@ -164,9 +164,13 @@ void uartReconfigure(uartPort_t *uartPort)
 
             /* Enable the UART Data Register not empty Interrupt */
             SET_BIT(uartPort->USARTx->CR1, USART_CR1_RXNEIE);
+        }
 
-            /* Enable Idle Line detection */
+        /* Enable Idle Line detection for ports with an idle callback, with RX DMA it tells the receiver a burst is complete in the DMA buffer */
+        if (uartPort->port.idleCallback) {
             SET_BIT(uartPort->USARTx->CR1, USART_CR1_IDLEIE);
+        } else {
+            CLEAR_BIT(uartPort->USARTx->CR1, USART_CR1_IDLEIE);
         }
     }
 
@@ -340,8 +344,10 @@ FAST_IRQ_HANDLER void uartIrqHandler(uartPort_t *s)
         uint8_t rbyte = (uint8_t)(huart->Instance->RDR & (uint8_t) 0xff);
 
         if (s->port.rxCallback) {
+            serialStatsRxCallback(&s->port);
             s->port.rxCallback(rbyte, s->port.rxCallbackData);
         } else {
+            serialStatsRxStore(&s->port);
             s->port.rxBuffer[s->port.rxBufferHead] = rbyte;
             s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
         }
@@ -371,6 +377,7 @@ FAST_IRQ_HANDLER void uartIrqHandler(uartPort_t *s)
     /* UART Over-Run interrupt occurred -----------------------------------------*/
     if ((__HAL_UART_GET_IT(huart, UART_IT_ORE) != RESET)) {
         __HAL_UART_CLEAR_IT(huart, UART_CLEAR_OREF);
+        serialStatsRxOverrun(&s->port);
     }
 
     // UART transmission completed
@@ -124,8 +124,10 @@ void uartReconfigure(uartPort_t *uartPort)
         {
             USART_ClearITPendingBit(uartPort->USARTx, USART_IT_RXNE);
             USART_ITConfig(uartPort->USARTx, USART_IT_RXNE, ENABLE);
-            USART_ITConfig(uartPort->USARTx, USART_IT_IDLE, ENABLE);
         }
+        // only ports with an idle callback take the idle line interrupt, with RX DMA it is
+        // the only point the receiver learns about data in the DMA buffer
+        USART_ITConfig(uartPort->USARTx, USART_IT_IDLE, uartPort->port.idleCallback ? ENABLE : DISABLE);
     }
 
     // Transmit DMA or IRQ
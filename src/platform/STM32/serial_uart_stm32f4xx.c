@@ -300,8 +300,10 @@ void uartIrqHandler(uartPort_t *s)
 {
     if (!s->rxDMAResource && (USART_GetITStatus(s->USARTx, USART_IT_RXNE) == SET)) {
         if (s->port.rxCallback) {
+            serialStatsRxCallback(&s->port);
             s->port.rxCallback(s->USARTx->DR, s->port.rxCallbackData);
         } else {
+            serialStatsRxStore(&s->port);
             s->port.rxBuffer[s->port.rxBufferHead] = s->USARTx->DR;
             s->port.rxBufferHead = (s->port.rxBufferHead + 1) % s->port.rxBufferSize;
         }
@@ -326,6 +328,7 @@ void uartIrqHandler(uartPort_t *s)
 
     if (USART_GetITStatus(s->USARTx, USART_IT_ORE) == SET) {
         USART_ClearITPendingBit(s->USARTx, USART_IT_ORE);
+        serialStatsRxOverrun(&s->port);
     }
 
     if (USART_GetITStatus(s->USARTx, USART_IT_IDLE) == SET) {
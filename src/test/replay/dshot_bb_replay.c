@@ -0,0 +1,349 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target benchmark of the bitbang DShot telemetry decoders.
+ *
+ * Builds port sample buffers as the input DMA leaves them, 3 samples per bit of each motor's GCR answer,
+ * and decodes every buffer once with decode_bb() per motor and once with decode_bb_port() for the whole
+ * port, each from the same decoder state. The answers start at slightly different times and rates and
+ * a few buffers carry glitches, so the failure paths are timed too. The values of both are compared;
+ * the rare mismatches come from the preamble skip, which the per motor decoder can lower between the
+ * motors of a buffer.
+ *
+ * Captured lines can be replayed instead of synthetic ones: build with DEBUG_BBDECODE and copy the raw
+ * sample lines of the cli command dshot_telemetry_info (one line of 0 and 1 per failed decode) to a file.
+ * The lines are spread over the motors of the port in turn. Those are the decodes that failed on the
+ * flight controller, so they time the worst case rather than the usual one.
+ *
+ * The flight controller figure scales the host time by -k, as nav_replay does; 30 is a rough value
+ * for this integer code on a current desktop core against a Cortex-M4F at 168MHz.
+ *
+ * Usage: dshot_bb_replay [-m motors] [-n buffers] [-k scale] [-r seed] [file]
+ *   -m  motors on the port, 4 by default, up to 16
+ *   -n  port buffers to decode, 100000 by default
+ *   -k  host to F4 time scale, 30 by default
+ *   -r  random seed, so runs can be repeated
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/dshot.h"
+#include "drivers/dshot_bitbang_decode.h"
+#include "drivers/time.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+#define REPLAY_F4_CLOCK_MHZ     168
+#define REPLAY_PORT_SAMPLES     140     // DSHOT_BB_PORT_IP_BUF_LENGTH
+#define REPLAY_FRAME_BITS       21
+#define REPLAY_LOOP_US          125     // 8kHz PID loop, one telemetry answer per loop
+#define REPLAY_BATCH            1024    // buffers decoded between two clock readings
+#define REPLAY_MAX_LINES        4096
+
+static timeUs_t replayTimeUs;
+
+static uint16_t *buffers;
+static uint32_t bufferCount;
+
+static uint16_t lines[REPLAY_MAX_LINES][REPLAY_PORT_SAMPLES];
+static uint32_t lineCount;
+
+static const uint8_t gcrEncode[16] = {
+    0x19, 0x1b, 0x12, 0x13, 0x1d, 0x15, 0x16, 0x17, 0x1a, 0x09, 0x0a, 0x0b, 0x1e, 0x0d, 0x0e, 0x0f
+};
+
+static float replayUniform(float min, float max)
+{
+    return min + (max - min) * (replayRandom() / (float)UINT32_MAX);
+}
+
+// The 21 bits of the answer carrying a 12 bit value, a 1 is a level change
+static uint32_t replayFrame(uint16_t value)
+{
+    const uint16_t checksum = 0xf ^ (value & 0xf) ^ ((value >> 4) & 0xf) ^ ((value >> 8) & 0xf);
+    const uint16_t data = (value << 4) | checksum;
+    uint32_t gcr = 0;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        gcr = (gcr << 5) | gcrEncode[(data >> shift) & 0xf];
+    }
+    return (1 << 20) | gcr;
+}
+
+static void replaySynthesise(uint16_t *buffer, unsigned motors)
+{
+    // the pins of the port that are not motors hold some level
+    const uint16_t others = replayRandom() & ~((1 << motors) - 1);
+    for (unsigned i = 0; i < REPLAY_PORT_SAMPLES; i++) {
+        buffer[i] = others;
+    }
+    for (unsigned pin = 0; pin < motors; pin++) {
+        const uint32_t bits = replayFrame(replayRandom() & 0xfff);
+        const float start = replayUniform(20, 30);
+        const float samplesPerBit = 3 * replayUniform(0.97f, 1.03f);
+        bool high = true;
+        int bit = -1;
+        for (unsigned i = 0; i < REPLAY_PORT_SAMPLES; i++) {
+            const int t = floorf((i - start) / samplesPerBit);
+            while (bit < t && bit < REPLAY_FRAME_BITS - 1) {
+                bit++;
+                if (bits & (1 << (REPLAY_FRAME_BITS - 1 - bit))) {
+                    high = !high;
+                }
+            }
+            if (bit >= REPLAY_FRAME_BITS - 1 && t >= REPLAY_FRAME_BITS) {
+                high = true;
+            }
+            if (high) {
+                buffer[i] |= 1 << pin;
+            }
+        }
+    }
+    // one buffer in 16 has a glitch
+    if ((replayRandom() & 0xf) == 0) {
+        buffer[30 + replayRandom() % (REPLAY_PORT_SAMPLES - 30)] ^= 1 << (replayRandom() % motors);
+    }
+}
+
+static void replayFromLines(uint16_t *buffer, unsigned motors, uint32_t index)
+{
+    memset(buffer, 0, REPLAY_PORT_SAMPLES * sizeof(*buffer));
+    for (unsigned pin = 0; pin < motors; pin++) {
+        const uint16_t *line = lines[(index * motors + pin) % lineCount];
+        for (unsigned i = 0; i < REPLAY_PORT_SAMPLES; i++) {
+            buffer[i] |= line[i] << pin;
+        }
+    }
+}
+
+static bool readLines(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    char text[2048];
+    while (lineCount < REPLAY_MAX_LINES && fgets(text, sizeof(text), file)) {
+        uint16_t *line = lines[lineCount];
+        unsigned samples = 0;
+        bool valid = true;
+        for (char *token = strtok(text, " \t\r\n"); token && samples < REPLAY_PORT_SAMPLES; token = strtok(NULL, " \t\r\n")) {
+            if (strcmp(token, "0") && strcmp(token, "1")) {
+                // the edge lengths and the table of the command
+                valid = false;
+                break;
+            }
+            line[samples++] = token[0] == '1';
+        }
+        if (!valid || samples < 2 * REPLAY_FRAME_BITS) {
+            continue;
+        }
+        // the capture is shorter than the port buffer, the line idles high after it
+        while (samples < REPLAY_PORT_SAMPLES) {
+            line[samples++] = 1;
+        }
+        lineCount++;
+    }
+    fclose(file);
+    return lineCount > 0;
+}
+
+typedef struct replayResult_s {
+    uint64_t ns;
+    uint32_t valid;
+    uint32_t invalid;
+    uint32_t noEdge;
+} replayResult_t;
+
+typedef void (*replayDecoderFn)(uint16_t *buffer, unsigned motors, uint32_t *values);
+
+static void decodePerMotor(uint16_t *buffer, unsigned motors, uint32_t *values)
+{
+    for (unsigned pin = 0; pin < motors; pin++) {
+        values[pin] = decode_bb(buffer, REPLAY_PORT_SAMPLES, pin);
+    }
+}
+
+static void decodePort(uint16_t *buffer, unsigned motors, uint32_t *values)
+{
+    decode_bb_port(buffer, REPLAY_PORT_SAMPLES, (1 << motors) - 1, values);
+}
+
+static void replayDecode(replayDecoderFn decoder, unsigned motors, uint32_t *values, replayResult_t *result)
+{
+    for (uint32_t batch = 0; batch < bufferCount; batch += REPLAY_BATCH) {
+        const uint32_t count = MIN(bufferCount - batch, (uint32_t)REPLAY_BATCH);
+        const uint64_t start = nanosNow();
+        for (uint32_t i = batch; i < batch + count; i++) {
+            decoder(&buffers[i * REPLAY_PORT_SAMPLES], motors, &values[i * DSHOT_BB_PORT_PIN_COUNT]);
+            replayTimeUs += REPLAY_LOOP_US;
+        }
+        result->ns += nanosNow() - start;
+    }
+
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        for (unsigned pin = 0; pin < motors; pin++) {
+            const uint32_t value = values[i * DSHOT_BB_PORT_PIN_COUNT + pin];
+            if (value == DSHOT_TELEMETRY_NOEDGE) {
+                result->noEdge++;
+            } else if (value == DSHOT_TELEMETRY_INVALID) {
+                result->invalid++;
+            } else {
+                result->valid++;
+            }
+        }
+    }
+}
+
+// The decoders keep the preamble skip between calls, so each runs in its own process from the same state
+static bool replayDecodeForked(replayDecoderFn decoder, unsigned motors, uint32_t *values, replayResult_t *result)
+{
+    const pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        replayDecode(decoder, motors, values, result);
+        _exit(0);
+    }
+    int status;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void *sharedAlloc(size_t size)
+{
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? NULL : memory;
+}
+
+static void printResult(const char *name, const replayResult_t *result, double scale)
+{
+    const double avgNs = (double)result->ns / MAX(bufferCount, 1U);
+    fprintf(stderr, "%-22s %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %12.1f %12.2f %12.0f\n", name,
+        result->valid, result->invalid, result->noEdge, avgNs, avgNs * scale * 1e-3, avgNs * scale * 1e-3 * REPLAY_F4_CLOCK_MHZ);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned motors = 4;
+    bufferCount = 100000;
+    double scale = 30;
+    const char *path = NULL;
+
+    bool usage = false;
+    for (int arg = 1; arg < argc && !usage; arg++) {
+        const bool hasValue = arg + 1 < argc;
+        if (strcmp(argv[arg], "-m") == 0 && hasValue) {
+            motors = constrain(atoi(argv[++arg]), 1, DSHOT_BB_PORT_PIN_COUNT);
+        } else if (strcmp(argv[arg], "-n") == 0 && hasValue) {
+            bufferCount = MAX(atoi(argv[++arg]), 1);
+        } else if (strcmp(argv[arg], "-k") == 0 && hasValue) {
+            scale = atof(argv[++arg]);
+            usage = scale <= 0;
+        } else if (strcmp(argv[arg], "-r") == 0 && hasValue) {
+            replayRandomSeed(strtoul(argv[++arg], NULL, 0));
+        } else if (argv[arg][0] != '-' && !path) {
+            path = argv[arg];
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        fprintf(stderr, "usage: %s [-m motors] [-n buffers] [-k scale] [-r seed] [file]\n", argv[0]);
+        return 1;
+    }
+    if (path && !readLines(path)) {
+        fprintf(stderr, "%s: no sample lines found\n", path);
+        return 1;
+    }
+
+    buffers = malloc(bufferCount * REPLAY_PORT_SAMPLES * sizeof(*buffers));
+    if (!buffers) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        uint16_t *buffer = &buffers[i * REPLAY_PORT_SAMPLES];
+        if (path) {
+            replayFromLines(buffer, motors, i);
+        } else {
+            replaySynthesise(buffer, motors);
+        }
+    }
+
+    fprintf(stderr, "%" PRIu32 " port buffers of %u motors, %s\n", bufferCount, motors, path ? path : "synthetic");
+
+    const size_t valuesSize = bufferCount * DSHOT_BB_PORT_PIN_COUNT * sizeof(uint32_t);
+    uint32_t *perMotorValues = sharedAlloc(valuesSize);
+    uint32_t *portValues = sharedAlloc(valuesSize);
+    replayResult_t *results = sharedAlloc(2 * sizeof(replayResult_t));
+    if (!perMotorValues || !portValues || !results) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    if (!replayDecodeForked(decodePerMotor, motors, perMotorValues, &results[0])
+        || !replayDecodeForked(decodePort, motors, portValues, &results[1])) {
+        return 1;
+    }
+
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        for (unsigned pin = 0; pin < motors; pin++) {
+            mismatches += perMotorValues[i * DSHOT_BB_PORT_PIN_COUNT + pin] != portValues[i * DSHOT_BB_PORT_PIN_COUNT + pin];
+        }
+    }
+
+    fprintf(stderr, "%-22s %10s %10s %10s %12s %12s %12s\n", "", "valid", "invalid", "no edge", "host ns avg", "F4 us avg", "F4 cycles");
+    printResult("decode_bb per motor", &results[0], scale);
+    printResult("decode_bb_port", &results[1], scale);
+    fprintf(stderr, "%-22s %10" PRIu32 "\n", "mismatches", mismatches);
+
+    free(buffers);
+
+    return 0;
+}
+
+timeUs_t micros(void)
+{
+    return replayTimeUs;
+}
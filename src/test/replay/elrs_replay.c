@@ -0,0 +1,764 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target simulation of an ExpressLRS SPI receiver link.
+ *
+ * A simulated transmitter sends OTA packets at one of the 2.4GHz air rates, hopping through the FHSS
+ * sequence of its UID, sending sync packets on the sync channel and leaving the telemetry slots free.
+ * The unmodified rx/expresslrs.c receives them through a simulated SX1280 and a simulated timer, which
+ * stand in for drivers/rx/rx_sx1280.c and drivers/rx/expresslrs_driver.c. The timer follows the driver's
+ * tick/tock logic, with its phase shift and frequency offset, on a simulated clock, so the receiver has to
+ * find the sync packets, lock its timer to the packet arrivals and answer the telemetry slots the same
+ * way it does on hardware. Telemetry is sent by the unmodified rx/expresslrs_telemetry.c and acknowledged
+ * by the transmitter the way its stubborn receiver does.
+ *
+ * Packets can be lost in either direction, their arrival jittered and the transmitter clock offset. The
+ * statistics on stderr cover the host time spent in the packet handling, the timer tick and tock ISRs,
+ * building telemetry and the RX task, the time to connect and to lock the timer, the phase of the tock
+ * ISR against the packet arrivals once locked, uplink LQ and the telemetry slots answered and received.
+ * Every received packet is written to stdout as CSV with the host time taken to handle it.
+ *
+ * Usage: elrs_replay [-m rate] [-s rate] [-d seconds] [-l loss] [-j jitter_us] [-p ppm] [-t ratio] [-r seed]
+ *   -m  air rate of the transmitter, f1000, f500 or 500, f1000 by default
+ *   -s  air rate the receiver starts on, the transmitter's by default, others exercise the rate cycling
+ *   -d  simulated seconds, 10 by default
+ *   -l  probability of a packet being lost, in either direction
+ *   -j  maximum jitter added to the packet arrivals, in us
+ *   -p  transmitter clock offset in ppm
+ *   -t  telemetry ratio denominator, 2 to 128 or 1 for no telemetry, the rate's default by default
+ *   -r  random seed, so impaired runs can be repeated
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/feature.h"
+
+#include "drivers/bus_spi.h"
+#include "drivers/io.h"
+#include "drivers/time.h"
+#include "drivers/timer.h"
+#include "drivers/rx/expresslrs_driver.h"
+#include "drivers/rx/rx_spi.h"
+#include "drivers/rx/rx_sx1280.h"
+
+#include "fc/init.h"
+
+#include "pg/pg.h"
+#include "pg/rx_spi.h"
+#include "pg/rx_spi_expresslrs.h"
+
+#include "rx/rx.h"
+#include "rx/rx_spi.h"
+#include "rx/rx_spi_common.h"
+#include "rx/expresslrs.h"
+#include "rx/expresslrs_common.h"
+#include "rx/expresslrs_impl.h"
+#include "rx/expresslrs_telemetry.h"
+
+#include "sensors/battery.h"
+#include "sensors/sensors.h"
+
+#include "telemetry/crsf.h"
+#include "telemetry/telemetry.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+extern elrsReceiver_t receiver;
+
+// As in rx/expresslrs.c, the phase lock aims the tock ISR this long after the packet arrival
+#define SIM_PACKET_TO_TOCK_US 250
+#define SIM_RX_TASK_INTERVAL_US 250
+#define SIM_SYNC_INTERVAL_LOST_MS 250
+#define SIM_SYNC_INTERVAL_CONNECTED_MS 1500
+#define SIM_TX_CONNECTION_TIMEOUT_MS 1000
+#define SIM_RSSI_DBM -70
+#define SIM_SNR 40
+// Leaves the receiver some time in its first rate before the transmitter starts
+#define SIM_START_US 100000
+
+static const uint8_t simUid[6] = { 1, 2, 3, 4, 5, 6 };
+
+typedef struct simRate_s {
+    const char *name;
+    uint8_t index;                  // into airRateConfig
+    uint8_t airRate;                // as sent in sync packets
+} simRate_t;
+
+static const simRate_t simRates[] = {
+    { "f1000", 0, 0 },
+    { "f500", 1, 1 },
+    { "500", 2, 4 },
+};
+
+// The SX1280 as far as the receiver can tell
+typedef struct simRadio_s {
+    bool listening;
+    uint8_t bw;
+    uint8_t sfbt;
+    uint8_t cr;
+    bool isFlrc;
+    uint32_t freq;
+    uint32_t packets;               // received, whether they pass the CRC or not
+    uint32_t missed;                // sent on another frequency or air rate
+} simRadio_t;
+
+// As in drivers/rx/expresslrs_driver.c, but on the simulated clock
+typedef struct simTimer_s {
+    bool running;
+    bool tick;                      // the next expiry runs the tick ISR
+    uint32_t intervalUs;
+    int32_t frequencyOffsetTicks;
+    int32_t phaseShiftUs;
+    double nextUs;
+} simTimer_t;
+
+typedef struct simTx_s {
+    const simRate_t *rate;
+    const elrsModSettings_t *modParams;
+    double intervalUs;              // on the receiver clock
+    double nextUs;                  // nominal time of the next packet
+    uint8_t nonce;
+    uint8_t fhssIndex;
+    uint8_t fhssCount;              // FHSS sequence length
+    uint32_t *fhssFreqs;
+    uint8_t tlmDenom;
+    uint8_t tlmRatio;
+    double lastSyncUs;
+    double lastLinkTlmUs;
+    uint16_t channels[4];           // of the last RC packet
+    bool tlmConfirm;
+    uint8_t tlmPackage;             // next telemetry package expected
+    uint32_t sent;
+    uint32_t syncs;
+    uint32_t lost;
+    uint32_t tlmSlots;
+    uint32_t tlmLink;
+    uint32_t tlmData;
+    uint32_t tlmFrames;
+    uint32_t tlmBadCrc;
+    uint8_t rxLq;                   // as reported by the link telemetry
+} simTx_t;
+
+typedef struct simStats_s {
+    replayTiming_t packet;
+    replayTiming_t rxIsr;
+    replayTiming_t tick;
+    replayTiming_t tock;
+    replayTiming_t telemetry;
+    replayTiming_t rxTask;
+    uint32_t crcFailures;
+    uint32_t tlmSent;
+    uint32_t rcFrames;
+    uint32_t rcMismatches;
+    double connectedUs;
+    double lockedUs;
+    uint32_t disconnects;
+    uint32_t phaseCount;
+    double phaseTotalUs;
+    double phaseMaxUs;
+    uint32_t lqCount;
+    uint32_t lqTotal;
+    uint8_t lqMin;
+} simStats_t;
+
+static simRadio_t radio;
+static simTimer_t simTimer;
+static simTx_t tx;
+static simStats_t stats;
+static double simTimeUs;
+static double lastTockUs;
+static double lossProbability;
+static uint16_t crcInitializer;
+static uint16_t receivedChannels[4];
+static uint8_t tlmFrameCounter;
+
+static bool simChance(double probability)
+{
+    return probability > 0 && replayRandom() < probability * UINT32_MAX;
+}
+
+//
+// Timer
+//
+
+static void simTimerExpired(void)
+{
+    uint64_t startNs;
+
+    if (simTimer.tick) {
+        simTimer.nextUs = simTimeUs + (simTimer.intervalUs / 2) + simTimer.frequencyOffsetTicks;
+        startNs = nanosNow();
+        expressLrsOnTimerTickISR();
+        timingAdd(&stats.tick, nanosNow() - startNs);
+        simTimer.tick = false;
+    } else {
+        simTimer.nextUs = simTimeUs + (simTimer.intervalUs / 2) + simTimer.phaseShiftUs + simTimer.frequencyOffsetTicks;
+        simTimer.phaseShiftUs = 0;
+        lastTockUs = simTimeUs;
+        startNs = nanosNow();
+        expressLrsOnTimerTockISR();
+        timingAdd(&stats.tock, nanosNow() - startNs);
+        simTimer.tick = true;
+    }
+}
+
+//
+// Transmitter
+//
+
+static bool simTxConnected(void)
+{
+    return tx.lastLinkTlmUs >= 0 && simTimeUs - tx.lastLinkTlmUs < SIM_TX_CONNECTION_TIMEOUT_MS * 1000.0;
+}
+
+static void simTxSetCrc(elrsOtaPacket_t *otaPkt)
+{
+    otaPkt->crcHigh = 0;
+    const uint16_t crc = calcCrc14((uint8_t *)otaPkt, 7, crcInitializer);
+    otaPkt->crcHigh = crc >> 8;
+    otaPkt->crcLow = crc;
+}
+
+static void simTxBuildPacket(elrsOtaPacket_t *otaPkt)
+{
+    memset(otaPkt, 0, sizeof(*otaPkt));
+
+    const double syncIntervalUs = (simTxConnected() ? SIM_SYNC_INTERVAL_CONNECTED_MS : SIM_SYNC_INTERVAL_LOST_MS) * 1000.0;
+    if (tx.fhssIndex % fhssGetNumEntries() == 0 && simTimeUs - tx.lastSyncUs > syncIntervalUs) {
+        tx.lastSyncUs = simTimeUs;
+        tx.syncs++;
+
+        otaPkt->type = ELRS_SYNC_PACKET;
+        otaPkt->sync.fhssIndex = tx.fhssIndex;
+        otaPkt->sync.nonce = tx.nonce;
+        otaPkt->sync.switchEncMode = SM_HYBRID;
+        otaPkt->sync.newTlmRatio = tx.tlmRatio - TLM_RATIO_NO_TLM;
+        otaPkt->sync.rateIndex = tx.rate->airRate;
+        otaPkt->sync.UID3 = simUid[3];
+        otaPkt->sync.UID4 = simUid[4];
+        otaPkt->sync.UID5 = simUid[5];
+    } else {
+        otaPkt->type = ELRS_RC_DATA_PACKET;
+
+        // slow sticks, so every packet carries different values
+        uint64_t packed = 0;
+        for (int i = 0; i < 4; i++) {
+            tx.channels[i] = 988 + (tx.sent * (i + 1) + i * 256) % 1024;
+            packed |= (uint64_t)(tx.channels[i] - 988) << (i * 10);
+        }
+        for (int i = 0; i < 5; i++) {
+            otaPkt->rc.ch[i] = packed >> (i * 8);
+        }
+        otaPkt->rc.ch4 = (tx.sent / 100) & 1;
+        otaPkt->rc.switches = (tx.tlmConfirm << 6) | ((tx.sent % 6) << 3) | (tx.sent & 0x07);
+    }
+
+    simTxSetCrc(otaPkt);
+}
+
+static void simTxReceiveTelemetry(const volatile uint8_t *buffer)
+{
+    elrsOtaPacket_t otaPkt;
+    memcpy(&otaPkt, (const uint8_t *)buffer, sizeof(otaPkt));
+
+    const uint16_t inCrc = ((uint16_t)otaPkt.crcHigh << 8) | otaPkt.crcLow;
+    otaPkt.crcHigh = 0;
+    if (otaPkt.type != ELRS_TLM_PACKET || calcCrc14((uint8_t *)&otaPkt, 7, crcInitializer) != inCrc) {
+        tx.tlmBadCrc++;
+        return;
+    }
+
+    if (otaPkt.tlm_dl.type == ELRS_TELEMETRY_TYPE_LINK) {
+        tx.tlmLink++;
+        tx.lastLinkTlmUs = simTimeUs;
+        tx.rxLq = otaPkt.tlm_dl.ul_link_stats.lq;
+        return;
+    }
+
+    // The transmitter's stubborn receiver, each accepted package is acknowledged by toggling the confirm bit
+    tx.tlmData++;
+    const uint8_t packageIndex = otaPkt.tlm_dl.packageIndex;
+    if (packageIndex == ELRS_TELEMETRY_MAX_PACKAGES) {
+        tx.tlmPackage = 1;
+        tx.tlmConfirm = !tx.tlmConfirm;
+    } else if (packageIndex == 0 && tx.tlmPackage > 1) {
+        tx.tlmFrames++;
+        tx.tlmPackage = 1;
+        tx.tlmConfirm = !tx.tlmConfirm;
+    } else if (packageIndex == tx.tlmPackage) {
+        tx.tlmPackage++;
+        tx.tlmConfirm = !tx.tlmConfirm;
+    }
+}
+
+//
+// Radio
+//
+
+static bool simRadioTunedTo(const elrsModSettings_t *modParams, uint32_t freq)
+{
+    return radio.listening && radio.freq == freq && radio.bw == modParams->bw && radio.sfbt == modParams->sf
+        && radio.cr == modParams->cr && radio.isFlrc == (modParams->radioType == RADIO_TYPE_SX128x_FLRC);
+}
+
+static void simRadioTelemetry(void)
+{
+    if (expressLrsTelemRespReq()) {
+        const uint64_t startNs = nanosNow();
+        expressLrsDoTelem();
+        timingAdd(&stats.telemetry, nanosNow() - startNs);
+
+        stats.tlmSent++;
+        if (!simChance(lossProbability)) {
+            simTxReceiveTelemetry(expressLrsGetTelemetryBuffer());
+        }
+    }
+}
+
+// As rx_sx1280.c does after a packet, hop if due and then send telemetry or go back to receiving
+static void simRadioHopAndTelemetry(void)
+{
+    if (expressLrsIsFhssReq()) {
+        radio.freq = expressLrsGetCurrentFreq();
+    }
+    simRadioTelemetry();
+}
+
+static void simRadioReceive(const elrsOtaPacket_t *otaPkt, uint8_t *rxPayload)
+{
+    radio.packets++;
+    memcpy((uint8_t *)expressLrsGetRxBuffer(), otaPkt, sizeof(*otaPkt));
+
+    const uint64_t startNs = nanosNow();
+    const rx_spi_received_e status = processRFPacket(expressLrsGetPayloadBuffer(), (uint32_t)simTimeUs);
+    const uint64_t packetNs = nanosNow() - startNs;
+    expressLrsSetRfPacketStatus(status);
+    simRadioHopAndTelemetry();
+    const uint64_t rxIsrNs = nanosNow() - startNs;
+
+    timingAdd(&stats.packet, packetNs);
+    timingAdd(&stats.rxIsr, rxIsrNs);
+
+    if (status == RX_SPI_RECEIVED_NONE) {
+        stats.crcFailures++;
+    } else if (otaPkt->type == ELRS_RC_DATA_PACKET && rxPayload) {
+        memcpy(receivedChannels, tx.channels, sizeof(receivedChannels));
+    }
+
+    // where the tock ISR is against the packet arrival, as the receiver's phase lock sees it
+    double phaseUs = NAN;
+    if (status != RX_SPI_RECEIVED_NONE && simTimer.running && lastTockUs > 0) {
+        phaseUs = remainder(simTimeUs + SIM_PACKET_TO_TOCK_US - lastTockUs, tx.intervalUs);
+        if (receiver.timerState == ELRS_TIM_LOCKED) {
+            stats.phaseCount++;
+            stats.phaseTotalUs += fabs(phaseUs);
+            stats.phaseMaxUs = MAX(stats.phaseMaxUs, fabs(phaseUs));
+        }
+    }
+
+    printf("%.0f,%u,%u,%d,%" PRIu64 ",%" PRIu64 ",", simTimeUs, otaPkt->type == ELRS_SYNC_PACKET ? otaPkt->sync.nonce : tx.nonce,
+        otaPkt->type, status != RX_SPI_RECEIVED_NONE, packetNs, rxIsrNs);
+    if (isnan(phaseUs)) {
+        printf(",");
+    } else {
+        printf("%.0f,", phaseUs);
+    }
+    printf("%d,%d,%u\n", receiver.connectionState, receiver.timerState, receiver.uplinkLQ);
+}
+
+static void simTxSend(uint8_t *rxPayload)
+{
+    // the transmitter listens in the telemetry slots
+    if (tx.tlmDenom > 1 && tx.nonce % tx.tlmDenom == 0) {
+        tx.tlmSlots++;
+    } else {
+        elrsOtaPacket_t otaPkt;
+        simTxBuildPacket(&otaPkt);
+        tx.sent++;
+
+        if (simChance(lossProbability)) {
+            tx.lost++;
+        } else if (!simRadioTunedTo(tx.modParams, tx.fhssFreqs[tx.fhssIndex])) {
+            radio.missed++;
+        } else {
+            simRadioReceive(&otaPkt, rxPayload);
+        }
+    }
+
+    if ((tx.nonce + 1) % tx.modParams->fhssHopInterval == 0) {
+        tx.fhssIndex = (tx.fhssIndex + 1) % tx.fhssCount;
+    }
+    tx.nonce++;
+}
+
+//
+// Simulation
+//
+
+static uint8_t tlmRatioFromDenominator(uint8_t denom)
+{
+    for (uint8_t ratio = TLM_RATIO_NO_TLM; ratio <= TLM_RATIO_1_2; ratio++) {
+        if (tlmRatioEnumToValue(ratio) == denom) {
+            return ratio;
+        }
+    }
+    return 0;
+}
+
+static bool simInit(const simRate_t *txRate, const simRate_t *rxRate, uint8_t tlmDenom, double ppm)
+{
+    pgResetAll();
+    rxExpressLrsSpiConfigMutable()->domain = ISM2400;
+    rxExpressLrsSpiConfigMutable()->rateIndex = rxRate->index;
+    memcpy(rxExpressLrsSpiConfigMutable()->UID, simUid, sizeof(simUid));
+
+    systemState = SYSTEM_STATE_READY;
+    debugMode = DEBUG_RX_EXPRESSLRS_PHASELOCK;
+
+    static rxRuntimeState_t rxRuntimeState;
+    rxSpiExtiConfig_t extiConfig;
+    if (!expressLrsSpiInit(rxSpiConfig(), &rxRuntimeState, &extiConfig)) {
+        return false;
+    }
+
+    // The transmitter hops through the same sequence as the receiver, whose state must not be disturbed
+    crcInitializer = ((simUid[4] << 8) | simUid[5]) ^ ELRS_OTA_VERSION_ID;
+    tx.fhssCount = (256 / fhssGetNumEntries()) * fhssGetNumEntries();
+    tx.fhssFreqs = malloc(tx.fhssCount * sizeof(*tx.fhssFreqs));
+    if (!tx.fhssFreqs) {
+        return false;
+    }
+    const uint8_t fhssIndex = fhssGetCurrIndex();
+    for (int i = 0; i < tx.fhssCount; i++) {
+        fhssSetCurrIndex((i + tx.fhssCount - 1) % tx.fhssCount);
+        tx.fhssFreqs[i] = fhssGetNextFreq(0);
+    }
+    fhssSetCurrIndex(fhssIndex);
+
+    tx.rate = txRate;
+    tx.modParams = &airRateConfig[0][txRate->index];
+    tx.intervalUs = tx.modParams->interval / (1 + ppm * 1e-6);
+    tx.nextUs = SIM_START_US;
+    tx.tlmDenom = tlmDenom ? tlmDenom : tlmRatioEnumToValue(tx.modParams->tlmInterval);
+    tx.tlmRatio = tlmRatioFromDenominator(tx.tlmDenom);
+    tx.lastSyncUs = -1e9;
+    tx.lastLinkTlmUs = -1;
+    tx.tlmPackage = 1;
+
+    stats.connectedUs = -1;
+    stats.lockedUs = -1;
+    stats.lqMin = 100;
+
+    return tx.tlmRatio != 0;
+}
+
+static void simRxTask(uint8_t *rxPayload)
+{
+    const connectionState_e previousState = receiver.connectionState;
+
+    const uint64_t startNs = nanosNow();
+    const rx_spi_received_e status = expressLrsDataReceived(rxPayload);
+    timingAdd(&stats.rxTask, nanosNow() - startNs);
+
+    if (status == RX_SPI_RECEIVED_DATA && receiver.connectionState == ELRS_CONNECTED) {
+        uint16_t rcData[ELRS_MAX_CHANNELS];
+        expressLrsSetRcDataFromPayload(rcData, rxPayload);
+        stats.rcFrames++;
+        if (memcmp(rcData, receivedChannels, sizeof(receivedChannels)) != 0) {
+            stats.rcMismatches++;
+        }
+    }
+
+    if (receiver.connectionState == ELRS_CONNECTED) {
+        if (stats.connectedUs < 0) {
+            stats.connectedUs = simTimeUs - SIM_START_US;
+        }
+        stats.lqCount++;
+        stats.lqTotal += receiver.uplinkLQ;
+        // the minimum is of the steady state, LQ still ramps up after connecting
+        if (receiver.timerState == ELRS_TIM_LOCKED) {
+            stats.lqMin = MIN(stats.lqMin, receiver.uplinkLQ);
+        }
+    } else if (previousState == ELRS_CONNECTED) {
+        stats.disconnects++;
+    }
+    if (receiver.timerState == ELRS_TIM_LOCKED && stats.lockedUs < 0) {
+        stats.lockedUs = simTimeUs - SIM_START_US;
+    }
+}
+
+static void simRun(double durationUs, double jitterUs)
+{
+    static uint8_t rxPayload[ELRS_RX_TX_BUFF_SIZE];
+    const double endUs = SIM_START_US + durationUs;
+    double nextRxTaskUs = 0;
+    double nextTxUs = tx.nextUs;
+
+    printf("time (us),nonce,type,valid,packet ns,rx isr ns,phase (us),connection,timer,lq\n");
+
+    while (simTimeUs < endUs) {
+        if (simTimer.running && simTimer.nextUs <= nextTxUs && simTimer.nextUs <= nextRxTaskUs) {
+            simTimeUs = simTimer.nextUs;
+            simTimerExpired();
+        } else if (nextTxUs <= nextRxTaskUs) {
+            simTimeUs = nextTxUs;
+            simTxSend(rxPayload);
+            tx.nextUs += tx.intervalUs;
+            nextTxUs = tx.nextUs + (jitterUs > 0 ? (double)replayRandom() / UINT32_MAX * jitterUs : 0);
+        } else {
+            simTimeUs = nextRxTaskUs;
+            simRxTask(rxPayload);
+            nextRxTaskUs += SIM_RX_TASK_INTERVAL_US;
+        }
+    }
+}
+
+static void printTiming(const char *name, const replayTiming_t *timing)
+{
+    fprintf(stderr, "%-22s %10u %10" PRIu64 " %10" PRIu64 "\n", name, timing->calls,
+        timing->calls ? timing->totalNs / timing->calls : 0, timing->maxNs);
+}
+
+static void printStats(void)
+{
+    fprintf(stderr, "%-22s %10s %10s %10s\n", "isr", "calls", "avg ns", "max ns");
+    printTiming("processRFPacket", &stats.packet);
+    printTiming("rx isr", &stats.rxIsr);
+    printTiming("timer tick", &stats.tick);
+    printTiming("timer tock", &stats.tock);
+    printTiming("telemetry", &stats.telemetry);
+    printTiming("rx task", &stats.rxTask);
+    fprintf(stderr, "\n");
+
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "packets sent", tx.sent);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "sync packets", tx.syncs);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "packets lost", tx.lost);
+    // sent while the receiver was on another channel or air rate
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "packets missed", radio.missed);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "packets received", radio.packets);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "crc failures", stats.crcFailures);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "rc frames", stats.rcFrames);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "rc mismatches", stats.rcMismatches);
+    fprintf(stderr, "%-22s %12.1f\n", "connected after ms", stats.connectedUs >= 0 ? stats.connectedUs / 1000 : NAN);
+    fprintf(stderr, "%-22s %12.1f\n", "locked after ms", stats.lockedUs >= 0 ? stats.lockedUs / 1000 : NAN);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "disconnects", stats.disconnects);
+    fprintf(stderr, "%-22s %12.1f %12.1f\n", "locked phase avg/max us",
+        stats.phaseCount ? stats.phaseTotalUs / stats.phaseCount : NAN, stats.phaseMaxUs);
+    fprintf(stderr, "%-22s %12" PRId32 "\n", "frequency offset", simTimer.frequencyOffsetTicks);
+    fprintf(stderr, "%-22s %12.1f %12u\n", "uplink lq avg/min", stats.lqCount ? (double)stats.lqTotal / stats.lqCount : NAN,
+        stats.lqCount ? stats.lqMin : 0);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "telemetry slots", tx.tlmSlots);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "telemetry sent", stats.tlmSent);
+    fprintf(stderr, "%-22s %12" PRIu32 " %12" PRIu32 "\n", "telemetry link/data", tx.tlmLink, tx.tlmData);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "telemetry crc failures", tx.tlmBadCrc);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "telemetry frames", tx.tlmFrames);
+}
+
+static const simRate_t *findRate(const char *name)
+{
+    for (unsigned i = 0; i < ARRAYLEN(simRates); i++) {
+        if (strcmp(simRates[i].name, name) == 0) {
+            return &simRates[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    const simRate_t *txRate = &simRates[0];
+    const simRate_t *rxRate = NULL;
+    double durationS = 10;
+    double jitterUs = 0;
+    double ppm = 0;
+    int tlmDenom = 0;
+
+    bool usage = false;
+    for (int arg = 1; arg < argc && !usage; arg++) {
+        const bool hasValue = arg + 1 < argc;
+        if (strcmp(argv[arg], "-m") == 0 && hasValue) {
+            txRate = findRate(argv[++arg]);
+            usage = !txRate;
+        } else if (strcmp(argv[arg], "-s") == 0 && hasValue) {
+            rxRate = findRate(argv[++arg]);
+            usage = !rxRate;
+        } else if (strcmp(argv[arg], "-d") == 0 && hasValue) {
+            durationS = atof(argv[++arg]);
+            usage = durationS <= 0;
+        } else if (strcmp(argv[arg], "-l") == 0 && hasValue) {
+            lossProbability = atof(argv[++arg]);
+            usage = lossProbability < 0 || lossProbability > 1;
+        } else if (strcmp(argv[arg], "-j") == 0 && hasValue) {
+            jitterUs = atof(argv[++arg]);
+            usage = jitterUs < 0;
+        } else if (strcmp(argv[arg], "-p") == 0 && hasValue) {
+            ppm = atof(argv[++arg]);
+        } else if (strcmp(argv[arg], "-t") == 0 && hasValue) {
+            tlmDenom = atoi(argv[++arg]);
+            usage = tlmDenom < 1 || tlmDenom > 128;
+        } else if (strcmp(argv[arg], "-r") == 0 && hasValue) {
+            replayRandomSeed(strtoul(argv[++arg], NULL, 0));
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        fprintf(stderr, "usage: %s [-m rate] [-s rate] [-d seconds] [-l loss] [-j jitter_us] [-p ppm] [-t ratio] [-r seed]\n", argv[0]);
+        return 1;
+    }
+
+    if (!simInit(txRate, rxRate ? rxRate : txRate, tlmDenom, ppm)) {
+        fprintf(stderr, "receiver failed to start or telemetry ratio not supported\n");
+        return 1;
+    }
+    fprintf(stderr, "simulating %.1fs of %s at 1:%u telemetry\n", durationS, txRate->name, tx.tlmDenom);
+
+    simRun(durationS * 1e6, jitterUs);
+
+    printStats();
+    free(tx.fhssFreqs);
+
+    return 0;
+}
+
+// The simulated clock
+
+uint32_t micros(void) { return (uint32_t)simTimeUs; }
+uint32_t millis(void) { return (uint32_t)(simTimeUs / 1000); }
+
+// The SX1280, replacing drivers/rx/rx_sx1280.c
+
+bool sx1280Init(IO_t resetPin, IO_t busyPin) { UNUSED(resetPin); UNUSED(busyPin); return true; }
+
+void sx1280Config(const uint8_t bw, const uint8_t sfbt, const uint8_t cr, const uint32_t freq, const uint8_t preambleLength,
+    const bool iqInverted, const uint32_t flrcSyncWord, const uint16_t flrcCrcSeed, const bool isFlrc)
+{
+    UNUSED(preambleLength); UNUSED(iqInverted); UNUSED(flrcSyncWord); UNUSED(flrcCrcSeed);
+    radio.bw = bw;
+    radio.sfbt = sfbt;
+    radio.cr = cr;
+    radio.isFlrc = isFlrc;
+    radio.freq = freq;
+    radio.listening = false;
+}
+
+void sx1280StartReceiving(void) { radio.listening = true; }
+void sx1280ISR(void) {}
+// A hop the packet handling did not do, when the packet was lost, is done from the tock ISR
+void sx1280HandleFromTock(void)
+{
+    if (expressLrsIsFhssReq()) {
+        radio.freq = expressLrsGetCurrentFreq();
+        simRadioTelemetry();
+    }
+}
+
+bool sx1280HandleFromTick(void) { return false; }
+void sx1280SetOutputPower(const int8_t power) { UNUSED(power); }
+
+void sx1280GetLastPacketStats(int8_t *rssi, int8_t *snr)
+{
+    *rssi = SIM_RSSI_DBM;
+    *snr = SIM_SNR;
+}
+
+void sx1280AdjustFrequency(int32_t *offset, const uint32_t freq) { UNUSED(offset); UNUSED(freq); }
+
+// The timer, replacing drivers/rx/expresslrs_driver.c
+
+void expressLrsInitialiseTimer(TIM_TypeDef *timer, timerOvrHandlerRec_t *timerUpdateCb) { UNUSED(timer); UNUSED(timerUpdateCb); }
+void expressLrsTimerEnableIRQs(void) {}
+void expressLrsUpdateTimerInterval(uint16_t intervalUs) { simTimer.intervalUs = intervalUs; }
+
+void expressLrsUpdatePhaseShift(int32_t newPhaseShift)
+{
+    const int32_t limit = simTimer.intervalUs / 2;
+    simTimer.phaseShiftUs = constrain(newPhaseShift, -limit, limit);
+}
+
+void expressLrsTimerIncreaseFrequencyOffset(void) { simTimer.frequencyOffsetTicks++; }
+void expressLrsTimerDecreaseFrequencyOffset(void) { simTimer.frequencyOffsetTicks--; }
+void expressLrsTimerResetFrequencyOffset(void) { simTimer.frequencyOffsetTicks = 0; }
+void expressLrsTimerStop(void) { simTimer.running = false; }
+
+void expressLrsTimerResume(void)
+{
+    simTimer.tick = false;
+    simTimer.nextUs = simTimeUs + simTimer.intervalUs / 2;
+    simTimer.running = true;
+}
+
+bool expressLrsTimerIsRunning(void) { return simTimer.running; }
+void expressLrsTimerDebug(void) {}
+
+// Telemetry, two CRSF frames for the stubborn sender to split into packages
+
+bool featureIsEnabled(const uint32_t mask) { return mask == FEATURE_TELEMETRY; }
+bool sensors(uint32_t mask) { UNUSED(mask); return false; }
+bool telemetryIsSensorEnabled(sensor_e sensor) { return sensor & (SENSOR_VOLTAGE | SENSOR_MODE); }
+bool isBatteryVoltageConfigured(void) { return true; }
+bool isAmperageConfigured(void) { return false; }
+
+int getCrsfFrame(uint8_t *frame, crsfFrameType_e frameType)
+{
+    const int length = frameType == CRSF_FRAMETYPE_BATTERY_SENSOR ? 12 : 9;
+    for (int i = 0; i < length; i++) {
+        frame[i] = frameType + tlmFrameCounter + i;
+    }
+    tlmFrameCounter++;
+    return length;
+}
+
+// STUBS
+
+uint8_t systemState;
+rssiSource_e rssiSource;
+linkQualitySource_e linkQualitySource;
+
+void setRssi(uint16_t rssiValue, rssiSource_e source) { UNUSED(rssiValue); UNUSED(source); }
+void setRssiDirect(uint16_t newRssi, rssiSource_e source) { UNUSED(newRssi); UNUSED(source); }
+IO_t IOGetByTag(ioTag_t tag) { UNUSED(tag); return IO_NONE; }
+SPIDevice spiDeviceByInstance(const SPI_TypeDef *instance) { UNUSED(instance); return SPIINVALID; }
+void saveConfigAndNotify(void) {}
+void rxSpiCommonIOInit(const rxSpiConfig_t *rxSpiConfig) { UNUSED(rxSpiConfig); }
+void rxSpiLedBlinkRxLoss(rx_spi_received_e result) { UNUSED(result); }
+void rxSpiLedBlinkBind(void) {}
+bool rxSpiCheckBindRequested(bool reset) { UNUSED(reset); return false; }
+bool rxSpiExtiConfigured(void) { return true; }
+void dbgPinHi(int index) { UNUSED(index); }
+void dbgPinLo(int index) { UNUSED(index); }
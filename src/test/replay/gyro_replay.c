@@ -0,0 +1,424 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target replay of recorded flight data.
+ *
+ * Reads a blackbox log decoded to CSV by blackbox_decode and pushes every frame through the unmodified
+ * gyroUpdate() -> gyroFiltering() -> pidController() -> mixTable() path as fast as possible, using the
+ * virtual gyro and accelerometer as the sensors. The motor outputs are written to stdout as CSV and the
+ * time spent in each stage is reported on stderr, so filter and PID changes can be compared run to run.
+ *
+ * The unfiltered gyro (gyroUnfilt, falling back to gyroADC), accSmooth, rcCommand and setpoint fields
+ * are used. RC processing is not replayed: the logged setpoints drive the PID controller directly and
+ * feedforward is taken as the setpoint rate of change.
+ *
+ * Usage: gyro_replay [-l looptime_us] [-H] [-n repeat] log.csv > motors.csv
+ *   -l  gyro/PID looptime in us, defaults to the average interval of the logged frames
+ *   -H  the log was recorded with blackbox_high_resolution
+ *   -n  replay the log this many times to get stable timings
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/config.h"
+#include "config/feature.h"
+
+#include "drivers/accgyro/accgyro.h"
+#include "drivers/accgyro/accgyro_virtual.h"
+#include "drivers/dshot.h"
+#include "drivers/dshot_command.h"
+#include "drivers/motor.h"
+#include "drivers/sound_beeper.h"
+#include "drivers/time.h"
+
+#include "fc/controlrate_profile.h"
+#include "fc/core.h"
+#include "fc/rc.h"
+#include "fc/rc_controls.h"
+#include "fc/rc_modes.h"
+#include "fc/runtime_config.h"
+
+#include "flight/failsafe.h"
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/mixer_init.h"
+#include "flight/mixer_tricopter.h"
+#include "flight/pid.h"
+#include "flight/pid_init.h"
+
+#include "io/beeper.h"
+#include "io/gps.h"
+
+#include "pg/pg.h"
+#include "pg/pg_ids.h"
+#include "pg/rx.h"
+
+#include "rx/rx.h"
+
+#include "scheduler/scheduler.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/acceleration_init.h"
+#include "sensors/battery.h"
+#include "sensors/gyro.h"
+#include "sensors/gyro_init.h"
+#include "sensors/sensors.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+pidProfile_t *currentPidProfile;
+
+typedef enum {
+    REPLAY_TIME = 0,
+    REPLAY_GYRO,
+    REPLAY_ACC = REPLAY_GYRO + XYZ_AXIS_COUNT,
+    REPLAY_RC_COMMAND = REPLAY_ACC + XYZ_AXIS_COUNT,
+    REPLAY_SETPOINT = REPLAY_RC_COMMAND + 4,
+    REPLAY_FIELD_COUNT = REPLAY_SETPOINT + 4
+} replayField_e;
+
+typedef enum {
+    STAGE_GYRO_UPDATE = 0,
+    STAGE_ACC_UPDATE,
+    STAGE_GYRO_FILTERING,
+    STAGE_PID_CONTROLLER,
+    STAGE_MIX_TABLE,
+    STAGE_COUNT
+} replayStage_e;
+
+static const char * const stageNames[STAGE_COUNT] = {
+    "gyroUpdate", "accUpdate", "gyroFiltering", "pidController", "mixTable"
+};
+
+static replayTiming_t stageTiming[STAGE_COUNT];
+
+static timeUs_t replayTimeUs;
+static float replaySetpoint[XYZ_AXIS_COUNT];
+static float replayFeedforward[XYZ_AXIS_COUNT];
+static float replayThrottle;
+
+static void stageTimingAdd(replayStage_e stage, uint64_t startNs)
+{
+    timingAdd(&stageTiming[stage], nanosNow() - startNs);
+}
+
+// Field names are matched with the surrounding spaces blackbox_decode puts after each comma removed
+static int findField(char * const *names, int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool mapFields(char **names, int count, int *columns, float *scales)
+{
+    UNUSED(scales);
+    char name[32];
+
+    columns[REPLAY_TIME] = findField(names, count, "time (us)");
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        snprintf(name, sizeof(name), "gyroUnfilt[%d]", axis);
+        columns[REPLAY_GYRO + axis] = findField(names, count, name);
+        if (columns[REPLAY_GYRO + axis] < 0) {
+            snprintf(name, sizeof(name), "gyroADC[%d]", axis);
+            columns[REPLAY_GYRO + axis] = findField(names, count, name);
+        }
+        snprintf(name, sizeof(name), "accSmooth[%d]", axis);
+        columns[REPLAY_ACC + axis] = findField(names, count, name);
+    }
+    for (int i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "rcCommand[%d]", i);
+        columns[REPLAY_RC_COMMAND + i] = findField(names, count, name);
+        snprintf(name, sizeof(name), "setpoint[%d]", i);
+        columns[REPLAY_SETPOINT + i] = findField(names, count, name);
+    }
+
+    // time, gyro and the setpoints are needed to run the PID loop, the rest is optional
+    bool found = columns[REPLAY_TIME] >= 0;
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        found = found && columns[REPLAY_GYRO + i] >= 0 && columns[REPLAY_SETPOINT + i] >= 0;
+    }
+    if (!found) {
+        fprintf(stderr, "log has no time, gyro or setpoint fields\n");
+    }
+    return found;
+}
+
+static void replayInit(uint32_t looptimeUs)
+{
+    pgResetAll();
+
+    gyroInit();
+    accInit(gyro.accSampleRateHz);
+    setAccelerationTrims(&accelerometerConfigMutable()->accZero);
+
+    // the virtual gyro is a 2000dps device running at the logged rate
+    gyroDev_t *gyroDev = gyroActiveDev();
+    gyroDev->scale = GYRO_SCALE_2000DPS;
+    gyroDev->gyroSampleRateHz = 1000000 / looptimeUs;
+    gyro.sampleRateHz = gyroDev->gyroSampleRateHz;
+    gyroSetTargetLooptime(1);
+    gyroInitFilters();
+
+    currentPidProfile = pidProfilesMutable(0);
+    currentControlRateProfile = controlRateProfilesMutable(0);
+    pidInit(currentPidProfile);
+
+    mixerInit(mixerConfig()->mixerMode);
+    mixerInitProfile();
+
+    // the gyro is assumed to have been calibrated in flight, so the logged values are used as they are
+    ENABLE_ARMING_FLAG(ARMED);
+    pidStabilisationState(PID_STABILISATION_ON);
+}
+
+static void replayFrame(const float *frame, float rateScale, float frameRateHz)
+{
+    replayTimeUs = lrintf(frame[REPLAY_TIME]);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float setpoint = frame[REPLAY_SETPOINT + axis] * rateScale;
+        replayFeedforward[axis] = (setpoint - replaySetpoint[axis]) * frameRateHz;
+        replaySetpoint[axis] = setpoint;
+    }
+    for (int i = 0; i < 4; i++) {
+        rcCommand[i] = frame[REPLAY_RC_COMMAND + i] * rateScale;
+    }
+    // the throttle setpoint is always logged in thousandths
+    replayThrottle = frame[REPLAY_SETPOINT + THROTTLE] / 1000.0f;
+
+    const float gyroScale = rateScale / gyroActiveDev()->scale;
+    virtualGyroSet(virtualGyroDev,
+        constrain(lrintf(frame[REPLAY_GYRO + X] * gyroScale), INT16_MIN, INT16_MAX),
+        constrain(lrintf(frame[REPLAY_GYRO + Y] * gyroScale), INT16_MIN, INT16_MAX),
+        constrain(lrintf(frame[REPLAY_GYRO + Z] * gyroScale), INT16_MIN, INT16_MAX));
+    virtualAccSet(virtualAccDev,
+        frame[REPLAY_ACC + X], frame[REPLAY_ACC + Y], frame[REPLAY_ACC + Z]);
+
+    uint64_t startNs = nanosNow();
+    gyroUpdate();
+    stageTimingAdd(STAGE_GYRO_UPDATE, startNs);
+
+    startNs = nanosNow();
+    accUpdate(replayTimeUs);
+    stageTimingAdd(STAGE_ACC_UPDATE, startNs);
+
+    startNs = nanosNow();
+    gyroFiltering(replayTimeUs);
+    stageTimingAdd(STAGE_GYRO_FILTERING, startNs);
+
+    startNs = nanosNow();
+    pidController(currentPidProfile, replayTimeUs);
+    stageTimingAdd(STAGE_PID_CONTROLLER, startNs);
+
+    startNs = nanosNow();
+    mixTable(replayTimeUs);
+    stageTimingAdd(STAGE_MIX_TABLE, startNs);
+}
+
+static void printMotorHeader(void)
+{
+    printf("time (us)");
+    for (int i = 0; i < getMotorCount(); i++) {
+        printf(",motor[%d]", i);
+    }
+    printf("\n");
+}
+
+static void printMotors(void)
+{
+    printf("%u", replayTimeUs);
+    for (int i = 0; i < getMotorCount(); i++) {
+        printf(",%.1f", motor[i]);
+    }
+    printf("\n");
+}
+
+static void printTimings(int frameCount)
+{
+    fprintf(stderr, "%-16s %10s %10s\n", "stage", "avg ns", "max ns");
+    uint64_t totalNs = 0;
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        fprintf(stderr, "%-16s %10" PRIu64 " %10" PRIu64 "\n", stageNames[stage], stageTiming[stage].totalNs / frameCount, stageTiming[stage].maxNs);
+        totalNs += stageTiming[stage].totalNs;
+    }
+    fprintf(stderr, "%-16s %10" PRIu64 "\n", "total", totalNs / frameCount);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t looptimeUs = 0;
+    float rateScale = 1.0f;
+    int repeat = 1;
+    int arg = 1;
+
+    bool usage = false;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-l") == 0 && arg + 1 < argc) {
+            looptimeUs = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-H") == 0) {
+            rateScale = 0.1f;
+        } else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            repeat = MAX(atoi(argv[++arg]), 1);
+        } else {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || arg != argc - 1) {
+        fprintf(stderr, "usage: %s [-l looptime_us] [-H] [-n repeat] log.csv\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[arg], "r");
+    if (!file) {
+        perror(argv[arg]);
+        return 1;
+    }
+    int columns[REPLAY_FIELD_COUNT];
+    int frameCount = 0;
+    float *frames = loadFrames(file, REPLAY_FIELD_COUNT, mapFields, columns, &frameCount);
+    fclose(file);
+    if (!frames || frameCount < 2) {
+        fprintf(stderr, "%s: not enough frames to replay\n", argv[arg]);
+        free(frames);
+        return 1;
+    }
+
+    if (!looptimeUs) {
+        looptimeUs = lrintf((frames[(frameCount - 1) * REPLAY_FIELD_COUNT + REPLAY_TIME] - frames[REPLAY_TIME]) / (frameCount - 1));
+    }
+    if (!looptimeUs) {
+        fprintf(stderr, "%s: cannot derive the looptime from the log, use -l\n", argv[arg]);
+        free(frames);
+        return 1;
+    }
+
+    replayInit(looptimeUs);
+    fprintf(stderr, "replaying %d frames at %uus\n", frameCount, looptimeUs);
+
+    // only the motor outputs of the first pass are written, the others are for timing
+    printMotorHeader();
+    for (int pass = 0; pass < repeat; pass++) {
+        for (int i = 0; i < frameCount; i++) {
+            replayFrame(&frames[i * REPLAY_FIELD_COUNT], rateScale, 1e6f / looptimeUs);
+            if (pass == 0) {
+                printMotors();
+            }
+        }
+    }
+
+    printTimings(frameCount * repeat);
+    free(frames);
+
+    return 0;
+}
+
+// The replay clock follows the log, RC processing is replaced by the logged setpoints
+
+uint32_t micros(void) { return replayTimeUs; }
+uint32_t millis(void) { return replayTimeUs / 1000; }
+timeUs_t microsISR(void) { return replayTimeUs; }
+
+// assumes actual rates, the default rates type
+float getMaxRcRate(int axis) { return MAX(currentControlRateProfile->rates[axis] * 10.0f, 1.0f); }
+float getSetpointRate(int axis) { return replaySetpoint[axis]; }
+float getRawSetpoint(int axis) { return replaySetpoint[axis]; }
+float getFeedforward(int axis) { return replayFeedforward[axis]; }
+float getRcDeflection(int axis) { return replaySetpoint[axis] / getMaxRcRate(axis); }
+float getRcDeflectionRaw(int axis) { return getRcDeflection(axis); }
+float getRcDeflectionAbs(int axis) { return fabsf(getRcDeflection(axis)); }
+float getMaxRcDeflectionAbs(void) { return MAX(getRcDeflectionAbs(FD_ROLL), getRcDeflectionAbs(FD_PITCH)); }
+bool wasThrottleRaised(void) { return replayThrottle > 0.0f; }
+
+// STUBS
+
+PG_REGISTER(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 0);
+PG_REGISTER(flight3DConfig_t, flight3DConfig, PG_MOTOR_3D_CONFIG, 0);
+
+float rcCommand[4];
+float rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+rxRuntimeState_t rxRuntimeState;
+attitudeEulerAngles_t attitude;
+gpsSolutionData_t gpsSol;
+uint8_t detectedSensors[SENSOR_INDEX_COUNT] = { GYRO_VIRTUAL, ACC_VIRTUAL };
+bool useDshotTelemetry;
+
+bool AccInflightCalibrationMeasurementDone;
+bool AccInflightCalibrationSavetoEEProm;
+bool AccInflightCalibrationActive;
+uint16_t InflightcalibratingA;
+
+void delay(uint32_t ms) { UNUSED(ms); }
+void delayMicroseconds(uint32_t us) { UNUSED(us); }
+bool featureIsEnabled(const uint32_t mask) { UNUSED(mask); return false; }
+bool IS_RC_MODE_ACTIVE(boxId_e boxId) { UNUSED(boxId); return false; }
+bool isAirmodeEnabled(void) { return true; }
+bool isMotorsReversed(void) { return false; }
+bool isCrashFlipModeActive(void) { return false; }
+bool isLaunchControlActive(void) { return false; }
+bool failsafeIsActive(void) { return false; }
+uint8_t calculateThrottlePercentAbs(void) { return lrintf(replayThrottle * 100.0f); }
+float getCosTiltAngle(void) { return 1.0f; }
+uint16_t getBatteryVoltage(void) { return 0; }
+float getMinMotorFrequencyHz(void) { return 0.0f; }
+void initRcProcessing(void) { }
+void parseRcChannels(const char *input, rxConfig_t *rxConfig) { UNUSED(input); UNUSED(rxConfig); }
+void disarm(flightLogDisarmReason_e reason) { UNUSED(reason); }
+void systemBeep(bool on) { UNUSED(on); }
+void beeper(beeperMode_e mode) { UNUSED(mode); }
+void beeperConfirmationBeeps(uint8_t beepCount) { UNUSED(beepCount); }
+void saveConfigAndNotify(void) { }
+void writeEEPROM(void) { }
+void schedulerResetTaskStatistics(taskId_e taskId) { UNUSED(taskId); }
+void dshotSetPidLoopTime(uint32_t pidLoopTime) { UNUSED(pidLoopTime); }
+void mixerTricopterInit(void) { }
+float mixerTricopterMotorCorrection(int motor) { UNUSED(motor); return 0.0f; }
+
+// the replay drives DShot outputs, the default protocol
+void motorInitEndpoints(const motorConfig_t *motorConfig, float outputLimit, float *outputLow, float *outputHigh, float *disarm, float *deadbandMotor3dHigh, float *deadbandMotor3dLow)
+{
+    dshotInitEndpoints(motorConfig, outputLimit, outputLow, outputHigh, disarm, deadbandMotor3dHigh, deadbandMotor3dLow);
+}
+
+void motorWriteAll(float *values) { UNUSED(values); }
+bool isMotorProtocolDshot(void) { return true; }
@@ -0,0 +1,356 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target run of the navigation filter on a synthetic flight.
+ *
+ * The craft flies circles while climbing and descending. The accelerometer (with bias and noise), GPS
+ * position and velocity and the baro are synthesised from the true trajectory at their own rates and
+ * fed to the unmodified updateNavFilter() task at its rate. The estimate and the truth are written to
+ * stdout as CSV; stderr has the estimate and raw GPS errors and the cost of the task.
+ *
+ * The cost is measured on the host per task call, split into the calls that only predict and those
+ * that also fuse GPS or baro. The flight controller figure scales it by -k, the ratio of the time a
+ * Cortex-M4F at 168MHz takes for this kind of scalar float code against the host; the default of 60
+ * is a rough value for a current desktop core, measure it on a board for a better one.
+ *
+ * Usage: nav_replay [-t seconds] [-g gps_hz] [-b baro_hz] [-k scale] [-r seed] [-n repeat]
+ *   -t  length of the flight, 120s by default
+ *   -g  GPS rate, 10Hz by default
+ *   -b  baro rate, 40Hz by default
+ *   -k  host to F4 time scale, 60 by default
+ *   -r  random seed, so runs can be repeated
+ *   -n  run the flight this many times to get stable timings
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "flight/imu.h"
+#include "flight/nav_filter.h"
+
+#include "io/gps.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "sensors/sensors.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+acc_t acc;
+matrix33_t rMat;
+gpsSolutionData_t gpsSol;
+
+#define REPLAY_GRAVITY_CMSS     980.665f
+#define REPLAY_ACC_1G           2048
+#define REPLAY_F4_CLOCK_MHZ     168
+
+#define REPLAY_CIRCLE_RADIUS_CM 2000.0f
+#define REPLAY_CIRCLE_SPEED_CMS 500.0f
+#define REPLAY_CLIMB_CM         1000.0f
+#define REPLAY_CLIMB_PERIOD_S   20.0f
+
+#define REPLAY_ACC_NOISE_CMSS   40.0f
+#define REPLAY_ACC_BIAS_CMSS    15.0f
+#define REPLAY_GPS_POS_CM       100.0f
+#define REPLAY_GPS_VEL_CMS      20.0f
+#define REPLAY_BARO_CM          50.0f
+
+typedef struct replayTruth_s {
+    vector3_t position;         // cm, East North Up
+    vector3_t velocity;
+    vector3_t acceleration;
+} replayTruth_t;
+
+typedef enum {
+    COST_PREDICT = 0,
+    COST_BARO,
+    COST_GPS,
+    COST_COUNT
+} replayCostType_e;
+
+static const char * const costNames[COST_COUNT] = { "predict only", "predict + baro", "predict + gps" };
+
+typedef struct replayStats_s {
+    replayTiming_t cost[COST_COUNT];
+    double posErrorSq[NAV_AXIS_COUNT];
+    double velErrorSq[NAV_AXIS_COUNT];
+    uint32_t samples;
+    double gpsErrorSq;
+    uint32_t gpsSamples;
+    double sigmaSum[NAV_AXIS_COUNT];
+} replayStats_t;
+
+static bool gpsNewData;
+static timeUs_t gpsFixTime;
+static bool baroNewData;
+static float baroAltitude;
+static vector2_t gpsVelocity;   // north, east
+
+// Standard normal, Box-Muller
+static float replayGaussian(void)
+{
+    const double u1 = (replayRandom() + 1.0) / (UINT32_MAX + 2.0);
+    const double u2 = (replayRandom() + 1.0) / (UINT32_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static void replayTruthAt(replayTruth_t *truth, double t)
+{
+    const double w = REPLAY_CIRCLE_SPEED_CMS / REPLAY_CIRCLE_RADIUS_CM;
+    const double wz = 2.0 * M_PI / REPLAY_CLIMB_PERIOD_S;
+    const double r = REPLAY_CIRCLE_RADIUS_CM;
+    const double h = REPLAY_CLIMB_CM / 2;
+
+    truth->position = (vector3_t){{ r * sin(w * t), r * (1.0 - cos(w * t)), h * (1.0 - cos(wz * t)) }};
+    truth->velocity = (vector3_t){{ r * w * cos(w * t), r * w * sin(w * t), h * wz * sin(wz * t) }};
+    truth->acceleration = (vector3_t){{ -r * w * w * sin(w * t), r * w * w * cos(w * t), h * wz * wz * cos(wz * t) }};
+}
+
+static void replaySensors(const replayTruth_t *truth)
+{
+    // level and pointing north, so the body frame is North West Up
+    const float scale = REPLAY_ACC_1G / REPLAY_GRAVITY_CMSS;
+    acc.accADC.x = (truth->acceleration.y + REPLAY_ACC_BIAS_CMSS + REPLAY_ACC_NOISE_CMSS * replayGaussian()) * scale;
+    acc.accADC.y = (-truth->acceleration.x - REPLAY_ACC_BIAS_CMSS + REPLAY_ACC_NOISE_CMSS * replayGaussian()) * scale;
+    acc.accADC.z = (truth->acceleration.z + REPLAY_GRAVITY_CMSS + REPLAY_ACC_BIAS_CMSS + REPLAY_ACC_NOISE_CMSS * replayGaussian()) * scale;
+}
+
+static void replayGps(const replayTruth_t *truth, replayStats_t *stats)
+{
+    const float eastCm = truth->position.x + REPLAY_GPS_POS_CM * replayGaussian();
+    const float northCm = truth->position.y + REPLAY_GPS_POS_CM * replayGaussian();
+    // the flight is close to the equator, so a unit of longitude is as long as one of latitude
+    gpsSol.llh.lon = lrintf(eastCm / EARTH_ANGLE_TO_CM);
+    gpsSol.llh.lat = lrintf(northCm / EARTH_ANGLE_TO_CM);
+    gpsSol.llh.altCm = lrintf(truth->position.z + 2 * REPLAY_GPS_POS_CM * replayGaussian());
+    gpsSol.acc.hAcc = REPLAY_GPS_POS_CM * 10;
+    gpsSol.acc.vAcc = 2 * REPLAY_GPS_POS_CM * 10;
+    gpsSol.acc.sAcc = REPLAY_GPS_VEL_CMS * 10;
+    gpsVelocity.x = truth->velocity.y + REPLAY_GPS_VEL_CMS * replayGaussian();
+    gpsVelocity.y = truth->velocity.x + REPLAY_GPS_VEL_CMS * replayGaussian();
+    gpsNewData = true;
+
+    stats->gpsErrorSq += sq(eastCm - truth->position.x) + sq(northCm - truth->position.y);
+    stats->gpsSamples++;
+}
+
+static void replayFlight(double durationS, float gpsHz, float baroHz, replayStats_t *stats, bool output)
+{
+    memset(&acc, 0, sizeof(acc));
+    acc.dev.acc_1G = REPLAY_ACC_1G;
+    acc.dev.acc_1G_rec = 1.0f / REPLAY_ACC_1G;
+    memset(&rMat, 0, sizeof(rMat));
+    rMat.m[0][0] = rMat.m[1][1] = rMat.m[2][2] = 1.0f;
+    memset(&gpsSol, 0, sizeof(gpsSol));
+    navFilterInit();
+
+    const timeUs_t taskIntervalUs = HZ_TO_INTERVAL_US(NAV_FILTER_TASK_RATE_HZ);
+    const timeUs_t gpsIntervalUs = 1e6f / gpsHz;
+    const timeUs_t baroIntervalUs = 1e6f / baroHz;
+    timeUs_t nextGpsUs = 0;
+    timeUs_t nextBaroUs = 0;
+
+    // the clock measurement itself is taken off every call
+    const uint64_t start = nanosNow();
+    const uint64_t overheadNs = nanosNow() - start;
+
+    for (timeUs_t timeUs = taskIntervalUs; timeUs <= durationS * 1e6; timeUs += taskIntervalUs) {
+        replayTruth_t truth;
+        replayTruthAt(&truth, timeUs * 1e-6);
+        replaySensors(&truth);
+
+        replayCostType_e type = COST_PREDICT;
+        if (cmpTimeUs(timeUs, nextGpsUs) >= 0) {
+            replayGps(&truth, stats);
+            gpsFixTime = timeUs;    // the simulated fixes arrive without latency
+            nextGpsUs += gpsIntervalUs;
+            type = COST_GPS;
+        }
+        if (cmpTimeUs(timeUs, nextBaroUs) >= 0) {
+            baroAltitude = truth.position.z + REPLAY_BARO_CM * replayGaussian();
+            baroNewData = true;
+            nextBaroUs += baroIntervalUs;
+            type = type == COST_GPS ? COST_GPS : COST_BARO;
+        }
+
+        const uint64_t before = nanosNow();
+        updateNavFilter(timeUs);
+        const uint64_t ns = nanosNow() - before;
+        timingAdd(&stats->cost[type], ns > overheadNs ? ns - overheadNs : 0);
+
+        // compared as locations, the filter position is relative to the noisy first fix
+        gpsLocation_t location;
+        navFilterGetLocation(&location);
+        const vector3_t position = {{ location.lon * EARTH_ANGLE_TO_CM, location.lat * EARTH_ANGLE_TO_CM, location.altCm }};
+        vector3_t velocity, variance;
+        navFilterGetVelocity(&velocity);
+        navFilterGetPositionVariance(&variance);
+        // the first seconds are the filter converging
+        if (timeUs > 5000000) {
+            for (int i = 0; i < NAV_AXIS_COUNT; i++) {
+                stats->posErrorSq[i] += sq(position.v[i] - truth.position.v[i]);
+                stats->velErrorSq[i] += sq(velocity.v[i] - truth.velocity.v[i]);
+                stats->sigmaSum[i] += sqrtf(variance.v[i]);
+            }
+            stats->samples++;
+        }
+        if (output) {
+            printf("%" PRIu32 ",%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", timeUs,
+                position.x, position.y, position.z, velocity.x, velocity.y, velocity.z,
+                truth.position.x, truth.position.y, truth.position.z, truth.velocity.x, truth.velocity.y, truth.velocity.z);
+        }
+    }
+}
+
+static void printStats(const replayStats_t *stats, double scale)
+{
+    static const char * const axisNames[NAV_AXIS_COUNT] = { "east", "north", "up" };
+
+    fprintf(stderr, "%-22s %12s %12s %12s\n", "", "rms error", "rms vel err", "avg sigma");
+    for (int i = 0; i < NAV_AXIS_COUNT; i++) {
+        const double samples = MAX(stats->samples, 1U);
+        fprintf(stderr, "%-22s %12.1f %12.1f %12.1f\n", axisNames[i],
+            sqrt(stats->posErrorSq[i] / samples), sqrt(stats->velErrorSq[i] / samples), stats->sigmaSum[i] / samples);
+    }
+    fprintf(stderr, "%-22s %12.1f\n", "gps rms error (2D)", sqrt(stats->gpsErrorSq / MAX(stats->gpsSamples, 1U)));
+
+    fprintf(stderr, "\n%-22s %12s %12s %12s %12s %12s\n", "", "calls", "host ns avg", "host ns max", "F4 us avg", "F4 cycles");
+    double totalUs = 0;
+    uint32_t totalCalls = 0;
+    for (int i = 0; i < COST_COUNT; i++) {
+        const replayTiming_t *cost = &stats->cost[i];
+        const double avgNs = cost->calls ? (double)cost->totalNs / cost->calls : 0.0;
+        fprintf(stderr, "%-22s %12" PRIu32 " %12.1f %12" PRIu64 " %12.2f %12.0f\n", costNames[i], cost->calls,
+            avgNs, cost->maxNs, avgNs * scale * 1e-3, avgNs * scale * 1e-3 * REPLAY_F4_CLOCK_MHZ);
+        totalUs += cost->totalNs * scale * 1e-3;
+        totalCalls += cost->calls;
+    }
+    const double periodUs = 1e6 / NAV_FILTER_TASK_RATE_HZ;
+    fprintf(stderr, "%-22s %12.3f\n", "F4 load at task rate %", totalCalls ? 100.0 * totalUs / totalCalls / periodUs : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    double durationS = 120;
+    float gpsHz = 10;
+    float baroHz = 40;
+    double scale = 60;
+    int repeat = 1;
+
+    bool usage = false;
+    for (int arg = 1; arg < argc && !usage; arg++) {
+        const bool hasValue = arg + 1 < argc;
+        if (strcmp(argv[arg], "-t") == 0 && hasValue) {
+            durationS = MAX(atof(argv[++arg]), 10.0);
+        } else if (strcmp(argv[arg], "-g") == 0 && hasValue) {
+            gpsHz = constrainf(atof(argv[++arg]), 1, 25);
+        } else if (strcmp(argv[arg], "-b") == 0 && hasValue) {
+            baroHz = constrainf(atof(argv[++arg]), 1, NAV_FILTER_TASK_RATE_HZ);
+        } else if (strcmp(argv[arg], "-k") == 0 && hasValue) {
+            scale = atof(argv[++arg]);
+            usage = scale <= 0;
+        } else if (strcmp(argv[arg], "-r") == 0 && hasValue) {
+            replayRandomSeed(strtoul(argv[++arg], NULL, 0));
+        } else if (strcmp(argv[arg], "-n") == 0 && hasValue) {
+            repeat = MAX(atoi(argv[++arg]), 1);
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        fprintf(stderr, "usage: %s [-t seconds] [-g gps_hz] [-b baro_hz] [-k scale] [-r seed] [-n repeat]\n", argv[0]);
+        return 1;
+    }
+
+    fprintf(stderr, "flying %.0fs at %dHz, GPS at %.0fHz, baro at %.0fHz\n", durationS, NAV_FILTER_TASK_RATE_HZ, gpsHz, baroHz);
+
+    // only the first pass is written, the others are for timing
+    printf("time (us),pos east,pos north,pos up,vel east,vel north,vel up,true pos east,true pos north,true pos up,true vel east,true vel north,true vel up\n");
+    replayStats_t stats = { 0 };
+    for (int pass = 0; pass < repeat; pass++) {
+        replayFlight(durationS, gpsHz, baroHz, &stats, pass == 0);
+    }
+
+    printStats(&stats, scale);
+
+    return 0;
+}
+
+// Sensor state seen by the filter task
+
+bool sensors(uint32_t mask)
+{
+    return mask & (SENSOR_ACC | SENSOR_BARO | SENSOR_GPS);
+}
+
+bool gpsHasNewData(uint16_t *stamp)
+{
+    UNUSED(stamp);
+    const bool newData = gpsNewData;
+    gpsNewData = false;
+    return newData;
+}
+
+bool gpsFixVelocity(float *velNorthCmS, float *velEastCmS)
+{
+    *velNorthCmS = gpsVelocity.x;
+    *velEastCmS = gpsVelocity.y;
+    return true;
+}
+
+timeUs_t gpsFixTimeUs(void)
+{
+    return gpsFixTime;
+}
+
+bool baroIsCalibrated(void)
+{
+    return true;
+}
+
+float getBaroAltitude(void)
+{
+    return baroAltitude;
+}
+
+bool baroHasNewData(uint16_t *stamp)
+{
+    UNUSED(stamp);
+    const bool newData = baroNewData;
+    baroNewData = false;
+    return newData;
+}
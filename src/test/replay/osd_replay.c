@@ -0,0 +1,880 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target OSD rendering.
+ *
+ * Reads a blackbox log decoded to CSV by blackbox_decode and runs the unmodified osdUpdate() state machine and
+ * cmsHandler() against a framebuffer displayPort, with the battery, RSSI, altitude and stick values taken from
+ * the log. Every completed OSD frame is written to stdout as a character grid, or as a PNG when an MCM font is
+ * given, and the time spent in each OSD state is reported on stderr next to the estimate osd.c schedules with.
+ *
+ * The log is treated as armed throughout. Once it ends the craft is disarmed and the replay carries on for
+ * OSD_REPLAY_STATS_US so the post flight statistics are rendered too. The CMS is opened by the logged sticks
+ * when disarmed, or at a given log time with -m, and shows a placeholder main menu.
+ *
+ * Glyphs outside printable ASCII are written as '*' in the text output.
+ *
+ * Usage: osd_replay [-H] [-r hz] [-L layout] [-m ms] [-f font.mcm -p prefix] [-q] log.csv > frames.txt
+ *   -H  render on the 53x20 HD canvas instead of the 30x16 SD one
+ *   -r  OSD frame rate, defaults to osd_framerate_hz
+ *   -L  layout file, one "<osd_items_e index> <x> <y>" per line, defaults to a typical race layout
+ *   -m  open the CMS this many ms into the log
+ *   -f  MAX7456 .mcm font to render PNG frames with
+ *   -p  PNG file name prefix, frames are written to <prefix>NNNNN.png
+ *   -q  don't write text frames, only report the timings
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "blackbox/blackbox.h"
+
+#include "build/debug.h"
+
+#include "cms/cms.h"
+#include "cms/cms_types.h"
+
+#include "common/maths.h"
+#include "common/time.h"
+#include "common/utils.h"
+
+#include "config/config.h"
+#include "config/feature.h"
+
+#include "drivers/display.h"
+#include "drivers/persistent.h"
+#include "drivers/time.h"
+
+#include "fc/core.h"
+#include "fc/rc_controls.h"
+#include "fc/rc_modes.h"
+#include "fc/runtime_config.h"
+
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/pid.h"
+
+#include "io/beeper.h"
+#include "io/gps.h"
+
+#include "osd/osd.h"
+#include "osd/osd_elements.h"
+
+#include "pg/pg.h"
+#include "pg/pg_ids.h"
+#include "pg/pilot.h"
+#include "pg/rx.h"
+
+#include "rx/rx.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/battery.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+#define REPLAY_LINE_LENGTH 4096
+
+// The OSD shows the post flight statistics for this long after the log ends
+#define OSD_REPLAY_STATS_US 5000000
+// The CMS task runs at 20Hz on the flight controller
+#define OSD_REPLAY_CMS_INTERVAL_US 50000
+// Bound on osdUpdate() calls per frame in case the state machine never gets back to idle
+#define OSD_REPLAY_MAX_STEPS 1000
+
+#define REPLAY_COLS OSD_HD_COLS
+#define REPLAY_ROWS OSD_HD_ROWS
+
+// MAX7456 character cells are 12x18 pixels, stored as 54 bytes of four 2 bit pixels
+#define FONT_CHAR_COUNT 256
+#define FONT_CHAR_WIDTH 12
+#define FONT_CHAR_HEIGHT 18
+#define FONT_CHAR_BYTES 54
+#define FONT_CHAR_STORED_BYTES 64
+
+typedef enum {
+    REPLAY_TIME = 0,
+    REPLAY_RC_COMMAND,
+    REPLAY_VBAT = REPLAY_RC_COMMAND + 4,
+    REPLAY_AMPERAGE,
+    REPLAY_MAH_DRAWN,
+    REPLAY_RSSI,
+    REPLAY_BARO_ALT,
+    REPLAY_FIELD_COUNT
+} replayField_e;
+
+typedef struct replayFieldName_s {
+    const char *name;
+    replayField_e field;
+} replayFieldName_t;
+
+static const replayFieldName_t replayFieldNames[] = {
+    { "time", REPLAY_TIME },
+    { "rcCommand[0]", REPLAY_RC_COMMAND + ROLL },
+    { "rcCommand[1]", REPLAY_RC_COMMAND + PITCH },
+    { "rcCommand[2]", REPLAY_RC_COMMAND + YAW },
+    { "rcCommand[3]", REPLAY_RC_COMMAND + THROTTLE },
+    { "vbatLatest", REPLAY_VBAT },
+    { "amperageLatest", REPLAY_AMPERAGE },
+    { "energyCumulative", REPLAY_MAH_DRAWN },
+    { "rssi", REPLAY_RSSI },
+    { "baroAlt", REPLAY_BARO_ALT },
+};
+
+// blackbox_decode converts some fields to SI units, the firmware works in centivolts, centiamps and cm
+typedef struct replayUnit_s {
+    const char *unit;
+    float scale;
+} replayUnit_t;
+
+static const replayUnit_t replayUnits[] = {
+    { "(V)", 100.0f },
+    { "(A)", 100.0f },
+    { "(m)", 100.0f },
+};
+
+static const char * const stateNames[OSD_STATE_COUNT] = {
+    "INIT", "IDLE", "CHECK", "PROCESS_STATS1", "REFRESH_STATS", "PROCESS_STATS2", "PROCESS_STATS3",
+    "UPDATE_ALARMS", "REFRESH_PREARM", "UPDATE_CANVAS", "DRAW_ELEMENT", "DISPLAY_ELEMENT",
+    "UPDATE_HEARTBEAT", "COMMIT", "TRANSFER"
+};
+
+static replayTiming_t stateTiming[OSD_STATE_COUNT];
+static replayTiming_t cmsTiming;
+static replayTiming_t frameTiming;
+
+static timeUs_t replayTimeUs;
+static uint64_t callStartNs;
+
+static uint16_t replayVoltage;
+static int32_t replayAmperage;
+static int32_t replayMahDrawn;
+static float replayMahDrawnF;
+static uint8_t replayCellCount;
+static uint16_t replayRssi;
+static int32_t replayAltitudeCm;
+static int32_t replayVario;
+
+static uint8_t screen[REPLAY_ROWS][REPLAY_COLS];
+static displayPort_t replayDisplayPort;
+
+static uint8_t font[FONT_CHAR_COUNT][FONT_CHAR_BYTES];
+
+// Framebuffer displayPort
+
+static int replayGrab(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return 0;
+}
+
+static int replayRelease(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return 0;
+}
+
+static int replayClearScreen(displayPort_t *displayPort, displayClearOption_e options)
+{
+    UNUSED(displayPort);
+    UNUSED(options);
+    memset(screen, ' ', sizeof(screen));
+    return 0;
+}
+
+static bool replayDrawScreen(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return false;
+}
+
+static int replayScreenSize(const displayPort_t *displayPort)
+{
+    return displayPort->rows * displayPort->cols;
+}
+
+static int replayWriteChar(displayPort_t *displayPort, uint8_t x, uint8_t y, uint8_t attr, uint8_t c)
+{
+    UNUSED(attr);
+    if (x < displayPort->cols && y < displayPort->rows) {
+        screen[y][x] = c;
+    }
+    return 0;
+}
+
+static int replayWriteString(displayPort_t *displayPort, uint8_t x, uint8_t y, uint8_t attr, const char *text)
+{
+    for (; *text; text++, x++) {
+        replayWriteChar(displayPort, x, y, attr, *text);
+    }
+    return 0;
+}
+
+static bool replayIsTransferInProgress(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return false;
+}
+
+static bool replayIsSynced(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return true;
+}
+
+static int replayHeartbeat(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return 0;
+}
+
+static void replayRedraw(displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+}
+
+static uint32_t replayTxBytesFree(const displayPort_t *displayPort)
+{
+    UNUSED(displayPort);
+    return UINT32_MAX;
+}
+
+static const displayPortVTable_t replayDisplayPortVTable = {
+    .grab = replayGrab,
+    .release = replayRelease,
+    .clearScreen = replayClearScreen,
+    .drawScreen = replayDrawScreen,
+    .screenSize = replayScreenSize,
+    .writeString = replayWriteString,
+    .writeChar = replayWriteChar,
+    .isTransferInProgress = replayIsTransferInProgress,
+    .heartbeat = replayHeartbeat,
+    .redraw = replayRedraw,
+    .isSynced = replayIsSynced,
+    .txBytesFree = replayTxBytesFree,
+};
+
+// Log parsing
+
+// Field names are matched without the unit blackbox_decode may append, which sets the scale instead
+static bool mapFields(char **names, int count, int *columns, float *scales)
+{
+    for (int column = 0; column < count; column++) {
+        char *unit = strstr(names[column], " (");
+        if (unit) {
+            *unit++ = '\0';
+        }
+        for (unsigned i = 0; i < ARRAYLEN(replayFieldNames); i++) {
+            if (strcmp(names[column], replayFieldNames[i].name) != 0) {
+                continue;
+            }
+            const replayField_e field = replayFieldNames[i].field;
+            columns[field] = column;
+            for (unsigned j = 0; unit && j < ARRAYLEN(replayUnits); j++) {
+                if (strcmp(unit, replayUnits[j].unit) == 0) {
+                    scales[field] = replayUnits[j].scale;
+                }
+            }
+        }
+    }
+
+    if (columns[REPLAY_TIME] < 0) {
+        fprintf(stderr, "log has no time field\n");
+        return false;
+    }
+    return true;
+}
+
+static bool loadLayout(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        perror(filename);
+        return false;
+    }
+
+    memset(osdElementConfigMutable(), 0, sizeof(osdElementConfig_t));
+
+    char line[REPLAY_LINE_LENGTH];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        int item, x, y;
+        const int count = sscanf(line, "%d %d %d", &item, &x, &y);
+        if (count <= 0 || line[strspn(line, " \t")] == '#') {
+            continue;
+        }
+        if (count != 3 || item < 0 || item >= OSD_ITEM_COUNT || x < 0 || x >= REPLAY_COLS || y < 0 || y >= REPLAY_ROWS) {
+            fprintf(stderr, "%s:%d: expected \"<item> <x> <y>\"\n", filename, lineNumber);
+            ok = false;
+        } else {
+            osdElementConfigMutable()->item_pos[item] = OSD_POS(x, y) | OSD_PROFILE_1_FLAG;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+static void defaultLayout(void)
+{
+    osdElementConfig_t *config = osdElementConfigMutable();
+
+    config->item_pos[OSD_CRAFT_NAME] = OSD_POS(11, 1) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_RSSI_VALUE] = OSD_POS(1, 1) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_MAIN_BATT_VOLTAGE] = OSD_POS(23, 1) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_AVG_CELL_VOLTAGE] = OSD_POS(23, 2) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_CROSSHAIRS] |= OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_HORIZON_SIDEBARS] |= OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_ALTITUDE] = OSD_POS(23, 7) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_THROTTLE_POS] = OSD_POS(1, 7) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_FLYMODE] = OSD_POS(1, 13) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_CURRENT_DRAW] = OSD_POS(1, 14) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_MAH_DRAWN] = OSD_POS(1, 12) | OSD_PROFILE_1_FLAG;
+    config->item_pos[OSD_ITEM_TIMER_2] = OSD_POS(22, 14) | OSD_PROFILE_1_FLAG;
+}
+
+// Font and PNG output
+
+static bool loadFont(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        perror(filename);
+        return false;
+    }
+
+    char line[32];
+    bool ok = fgets(line, sizeof(line), file) && strncmp(line, "MAX7456", 7) == 0;
+    for (int c = 0; ok && c < FONT_CHAR_COUNT; c++) {
+        for (int i = 0; ok && i < FONT_CHAR_STORED_BYTES; i++) {
+            ok = fgets(line, sizeof(line), file) && strspn(line, "01") == 8;
+            if (ok && i < FONT_CHAR_BYTES) {
+                font[c][i] = strtoul(line, NULL, 2);
+            }
+        }
+    }
+
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s: not a MAX7456 font\n", filename);
+    }
+    return ok;
+}
+
+static uint32_t crcTable[256];
+
+static void pngInit(void)
+{
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        }
+        crcTable[n] = c;
+    }
+}
+
+static uint32_t pngCrc(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc = crcTable[(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putBe32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+}
+
+static void pngChunk(FILE *file, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t header[8];
+    putBe32(header, len);
+    memcpy(header + 4, type, 4);
+    fwrite(header, 1, 8, file);
+    fwrite(data, 1, len, file);
+
+    uint8_t crc[4];
+    putBe32(crc, pngCrc(pngCrc(0, header + 4, 4), data, len));
+    fwrite(crc, 1, 4, file);
+}
+
+// 8 bit greyscale, with the image data in uncompressed deflate blocks so no zlib is needed
+static bool writePng(const char *filename, const uint8_t *pixels, int width, int height)
+{
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        perror(filename);
+        return false;
+    }
+
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+
+    uint8_t ihdr[13] = { 0 };
+    putBe32(ihdr, width);
+    putBe32(ihdr + 4, height);
+    ihdr[8] = 8;
+    pngChunk(file, "IHDR", ihdr, sizeof(ihdr));
+
+    // each row is prefixed with filter type 0
+    const size_t rawLen = (size_t)(width + 1) * height;
+    const size_t blockCount = (rawLen + 0xfffe) / 0xffff;
+    uint8_t *idat = malloc(2 + rawLen + 5 * blockCount + 4);
+    uint8_t *out = idat;
+    uint32_t adlerA = 1, adlerB = 0;
+
+    *out++ = 0x78;
+    *out++ = 0x01;
+    size_t rawPos = 0;
+    for (size_t block = 0; block < blockCount; block++) {
+        const uint16_t len = MIN(rawLen - rawPos, (size_t)0xffff);
+        *out++ = (block == blockCount - 1) ? 1 : 0;
+        *out++ = len & 0xff;
+        *out++ = len >> 8;
+        *out++ = ~len & 0xff;
+        *out++ = (~len >> 8) & 0xff;
+        for (int i = 0; i < len; i++, rawPos++) {
+            const int x = rawPos % (width + 1);
+            const uint8_t byte = x ? pixels[(rawPos / (width + 1)) * width + x - 1] : 0;
+            *out++ = byte;
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+    putBe32(out, (adlerB << 16) | adlerA);
+    out += 4;
+
+    pngChunk(file, "IDAT", idat, out - idat);
+    pngChunk(file, "IEND", NULL, 0);
+    free(idat);
+
+    return fclose(file) == 0;
+}
+
+// Black and white pixels are drawn as such, transparent ones as the mid grey of the video behind them
+static bool writeFramePng(const char *prefix, int frame)
+{
+    const int width = replayDisplayPort.cols * FONT_CHAR_WIDTH;
+    const int height = replayDisplayPort.rows * FONT_CHAR_HEIGHT;
+    uint8_t *pixels = malloc(width * height);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t *glyph = font[screen[y / FONT_CHAR_HEIGHT][x / FONT_CHAR_WIDTH]];
+            const int bit = (y % FONT_CHAR_HEIGHT) * FONT_CHAR_WIDTH + x % FONT_CHAR_WIDTH;
+            const uint8_t pixel = (glyph[bit / 4] >> (6 - 2 * (bit % 4))) & 0x03;
+            pixels[y * width + x] = (pixel == 0x00) ? 0 : (pixel == 0x02) ? 255 : 128;
+        }
+    }
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s%05d.png", prefix, frame);
+    const bool ok = writePng(filename, pixels, width, height);
+    free(pixels);
+    return ok;
+}
+
+static void printFrame(int frame)
+{
+    printf("frame %d time %u%s\n", frame, replayTimeUs, cmsInMenu ? " cms" : "");
+    for (int y = 0; y < replayDisplayPort.rows; y++) {
+        putchar('|');
+        for (int x = 0; x < replayDisplayPort.cols; x++) {
+            const uint8_t c = screen[y][x];
+            putchar((c >= 0x20 && c < 0x7f) ? c : '*');
+        }
+        printf("|\n");
+    }
+}
+
+// Replay
+
+static void replayInit(bool hd, int framerateHz)
+{
+    pgResetAll();
+
+    osdConfigMutable()->canvas_cols = hd ? OSD_HD_COLS : OSD_SD_COLS;
+    osdConfigMutable()->canvas_rows = hd ? OSD_HD_ROWS : OSD_SD_ROWS;
+    if (framerateHz) {
+        osdConfigMutable()->framerate_hz = framerateHz;
+    }
+    strcpy(pilotConfigMutable()->craftName, "REPLAY");
+
+    // the battery code isn't replayed, so its defaults are set here
+    batteryConfigMutable()->vbatmincellvoltage = 330;
+    batteryConfigMutable()->vbatwarningcellvoltage = 350;
+    batteryConfigMutable()->vbatmaxcellvoltage = 430;
+
+    displayInit(&replayDisplayPort, &replayDisplayPortVTable, DISPLAYPORT_DEVICE_TYPE_MAX7456);
+    replayDisplayPort.cols = osdConfig()->canvas_cols;
+    replayDisplayPort.rows = osdConfig()->canvas_rows;
+    replayClearScreen(&replayDisplayPort, DISPLAY_CLEAR_WAIT);
+
+    cmsInit();
+    osdInit(&replayDisplayPort, OSD_DISPLAYPORT_DEVICE_MAX7456);
+}
+
+static void replaySetState(const float *frame, const float *previous, const bool *logged)
+{
+    const timeUs_t timeUs = lrintf(frame[REPLAY_TIME]);
+    const timeDelta_t deltaUs = previous ? cmpTimeUs(timeUs, replayTimeUs) : 0;
+    replayTimeUs = timeUs;
+
+    replayVoltage = lrintf(frame[REPLAY_VBAT]);
+    if (!replayCellCount && replayVoltage) {
+        // the same detection the firmware does on connecting the battery, assuming LiPo cells
+        replayCellCount = constrain(replayVoltage / batteryConfig()->vbatmaxcellvoltage + 1, 1, 8);
+    }
+
+    replayAmperage = lrintf(frame[REPLAY_AMPERAGE]);
+    if (logged[REPLAY_MAH_DRAWN]) {
+        replayMahDrawn = lrintf(frame[REPLAY_MAH_DRAWN]);
+    } else {
+        replayMahDrawnF += replayAmperage * 10.0f * deltaUs / (3600.0f * 1e6f);
+        replayMahDrawn = lrintf(replayMahDrawnF);
+    }
+
+    replayRssi = constrain(lrintf(frame[REPLAY_RSSI]), 0, RSSI_MAX_VALUE);
+
+    const int32_t altitudeCm = lrintf(frame[REPLAY_BARO_ALT]);
+    if (previous && deltaUs > 0) {
+        replayVario = (altitudeCm - replayAltitudeCm) * 1000000LL / deltaUs;
+    }
+    replayAltitudeCm = altitudeCm;
+
+    // rcCommand is close enough to the raw RC data for the CMS stick commands, yaw has the opposite sign
+    rcData[ROLL] = 1500 + frame[REPLAY_RC_COMMAND + ROLL];
+    rcData[PITCH] = 1500 + frame[REPLAY_RC_COMMAND + PITCH];
+    rcData[YAW] = 1500 - frame[REPLAY_RC_COMMAND + YAW];
+    rcData[THROTTLE] = frame[REPLAY_RC_COMMAND + THROTTLE];
+    for (int i = 0; i < 4; i++) {
+        rcCommand[i] = frame[REPLAY_RC_COMMAND + i];
+    }
+}
+
+// Runs the OSD to completion of the frame, returns true if a frame was rendered
+static bool replayOsdUpdate(void)
+{
+    if (!osdUpdateCheck(replayTimeUs, 0)) {
+        return false;
+    }
+
+    const uint64_t frameStartNs = nanosNow();
+    for (int step = 0; osdState != OSD_STATE_IDLE && step < OSD_REPLAY_MAX_STEPS; step++) {
+        const osdState_e state = osdState;
+        callStartNs = nanosNow();
+        osdUpdate(replayTimeUs);
+        timingAdd(&stateTiming[state], nanosNow() - callStartNs);
+    }
+    timingAdd(&frameTiming, nanosNow() - frameStartNs);
+
+    return true;
+}
+
+static void replayCmsUpdate(void)
+{
+    static timeUs_t cmsDueUs;
+
+    if (cmpTimeUs(replayTimeUs, cmsDueUs) < 0) {
+        return;
+    }
+    cmsDueUs = replayTimeUs + OSD_REPLAY_CMS_INTERVAL_US;
+
+    callStartNs = nanosNow();
+    cmsHandler(replayTimeUs);
+    timingAdd(&cmsTiming, nanosNow() - callStartNs);
+}
+
+static void printTiming(const char *name, const replayTiming_t *timing, const char *estimate)
+{
+    fprintf(stderr, "%-18s %8u %10" PRIu64 " %10" PRIu64 " %12s\n", name, timing->calls,
+        timing->calls ? timing->totalNs / timing->calls : 0, timing->maxNs, estimate);
+}
+
+static void printTimings(int frameCount)
+{
+    fprintf(stderr, "%-18s %8s %10s %10s %12s\n", "state", "calls", "avg ns", "max ns", "estimate us");
+    for (int state = 0; state < OSD_STATE_COUNT; state++) {
+        char estimate[16];
+        snprintf(estimate, sizeof(estimate), "%d", osdGetStateDurationUs(state));
+        printTiming(stateNames[state], &stateTiming[state], estimate);
+    }
+    printTiming("cmsHandler", &cmsTiming, "");
+    printTiming("frame", &frameTiming, "");
+    fprintf(stderr, "%d frames\n", frameCount);
+}
+
+int main(int argc, char *argv[])
+{
+    bool hd = false;
+    int framerateHz = 0;
+    const char *layoutFile = NULL;
+    int cmsOpenMs = -1;
+    const char *fontFile = NULL;
+    const char *pngPrefix = NULL;
+    bool quiet = false;
+    int arg = 1;
+
+    bool usage = false;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-H") == 0) {
+            hd = true;
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            framerateHz = constrain(atoi(argv[++arg]), 1, 60);
+        } else if (strcmp(argv[arg], "-L") == 0 && arg + 1 < argc) {
+            layoutFile = argv[++arg];
+        } else if (strcmp(argv[arg], "-m") == 0 && arg + 1 < argc) {
+            cmsOpenMs = MAX(atoi(argv[++arg]), 0);
+        } else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) {
+            fontFile = argv[++arg];
+        } else if (strcmp(argv[arg], "-p") == 0 && arg + 1 < argc) {
+            pngPrefix = argv[++arg];
+        } else if (strcmp(argv[arg], "-q") == 0) {
+            quiet = true;
+        } else {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || arg != argc - 1 || !fontFile != !pngPrefix) {
+        fprintf(stderr, "usage: %s [-H] [-r hz] [-L layout] [-m ms] [-f font.mcm -p prefix] [-q] log.csv\n", argv[0]);
+        return 1;
+    }
+
+    if (fontFile) {
+        if (!loadFont(fontFile)) {
+            return 1;
+        }
+        pngInit();
+    }
+
+    FILE *file = fopen(argv[arg], "r");
+    if (!file) {
+        perror(argv[arg]);
+        return 1;
+    }
+    int columns[REPLAY_FIELD_COUNT];
+    int frameCount = 0;
+    float *frames = loadFrames(file, REPLAY_FIELD_COUNT, mapFields, columns, &frameCount);
+    fclose(file);
+    if (!frames || frameCount < 2) {
+        fprintf(stderr, "%s: not enough frames to replay\n", argv[arg]);
+        free(frames);
+        return 1;
+    }
+
+    bool logged[REPLAY_FIELD_COUNT];
+    for (int i = 0; i < REPLAY_FIELD_COUNT; i++) {
+        logged[i] = columns[i] >= 0;
+    }
+
+    replayInit(hd, framerateHz);
+    if (logged[REPLAY_BARO_ALT]) {
+        sensorsSet(SENSOR_BARO);
+    }
+    if (layoutFile) {
+        if (!loadLayout(layoutFile)) {
+            free(frames);
+            return 1;
+        }
+    } else {
+        defaultLayout();
+    }
+    osdAnalyzeActiveElements();
+
+    const timeUs_t startUs = lrintf(frames[REPLAY_TIME]);
+    const timeUs_t endUs = lrintf(frames[(frameCount - 1) * REPLAY_FIELD_COUNT + REPLAY_TIME]) + OSD_REPLAY_STATS_US;
+    const timeDelta_t intervalUs = cmpTimeUs(endUs - OSD_REPLAY_STATS_US, startUs) / (frameCount - 1);
+    fprintf(stderr, "replaying %d frames\n", frameCount);
+
+    int rendered = 0;
+    for (int i = 0; i < frameCount || cmpTimeUs(replayTimeUs, endUs) < 0; i++) {
+        if (i < frameCount) {
+            replaySetState(&frames[i * REPLAY_FIELD_COUNT], i ? &frames[(i - 1) * REPLAY_FIELD_COUNT] : NULL, logged);
+        } else {
+            // keep the last logged values on screen while the statistics are shown
+            DISABLE_ARMING_FLAG(ARMED);
+            replayTimeUs += MAX(intervalUs, 1);
+        }
+
+        if (cmsOpenMs >= 0 && cmpTimeUs(replayTimeUs, startUs) >= cmsOpenMs * 1000) {
+            cmsMenuOpen();
+            cmsOpenMs = -1;
+        }
+        replayCmsUpdate();
+
+        if (replayOsdUpdate()) {
+            if (!quiet) {
+                printFrame(rendered);
+            }
+            if (pngPrefix && !writeFramePng(pngPrefix, rendered)) {
+                free(frames);
+                return 1;
+            }
+            rendered++;
+        }
+
+        // the OSD initialises disarmed, the log starts on arming
+        if (i == 0) {
+            ENABLE_ARMING_FLAG(ARMED);
+        }
+    }
+
+    printTimings(rendered);
+    free(frames);
+
+    return 0;
+}
+
+// The replay clock follows the log, advanced by the host time spent in the current call so that
+// osdUpdate() measures its own execution time as it does on the flight controller
+
+uint32_t micros(void) { return replayTimeUs + (nanosNow() - callStartNs) / 1000; }
+uint32_t millis(void) { return micros() / 1000; }
+
+uint16_t getBatteryVoltage(void) { return replayVoltage; }
+uint16_t getLegacyBatteryVoltage(void) { return (replayVoltage + 5) / 10; }
+uint16_t getBatteryAverageCellVoltage(void) { return replayCellCount ? replayVoltage / replayCellCount : 0; }
+uint8_t getBatteryCellCount(void) { return replayCellCount; }
+bool isBatteryVoltageConfigured(void) { return true; }
+bool isAmperageConfigured(void) { return true; }
+int32_t getAmperage(void) { return replayAmperage; }
+int32_t getMAhDrawn(void) { return replayMahDrawn; }
+float getWhDrawn(void) { return replayMahDrawn * replayVoltage / 100000.0f; }
+uint16_t getRssi(void) { return replayRssi; }
+uint8_t getRssiPercent(void) { return scaleRange(replayRssi, 0, RSSI_MAX_VALUE, 0, 100); }
+int32_t getEstimatedAltitudeCm(void) { return replayAltitudeCm; }
+int32_t getEstimatedVario(void) { return replayVario; }
+int8_t calculateThrottlePercent(void) { return constrain((rcCommand[THROTTLE] - 1000) / 10, 0, 100); }
+uint8_t calculateThrottlePercentAbs(void) { return calculateThrottlePercent(); }
+
+batteryState_e getBatteryState(void)
+{
+    const uint16_t cellVoltage = getBatteryAverageCellVoltage();
+    if (!cellVoltage) {
+        return BATTERY_NOT_PRESENT;
+    } else if (cellVoltage < batteryConfig()->vbatmincellvoltage) {
+        return BATTERY_CRITICAL;
+    } else if (cellVoltage < batteryConfig()->vbatwarningcellvoltage) {
+        return BATTERY_WARNING;
+    }
+    return BATTERY_OK;
+}
+
+// The CMS shows a placeholder main menu, the real menus need most of the firmware
+
+static const OSD_Entry menuMainEntries[] =
+{
+    { "-- MAIN --", OME_Label, NULL, NULL },
+    { "SAVE&REBOOT", OME_OSD_Exit, cmsMenuExit, (void *)CMS_EXIT_SAVEREBOOT },
+    { "EXIT", OME_OSD_Exit, cmsMenuExit, (void *)CMS_EXIT },
+    { NULL, OME_END, NULL, NULL }
+};
+
+CMS_Menu cmsx_menuMain = {
+#ifdef CMS_MENU_DEBUG
+    .GUARD_text = "MENUMAIN",
+    .GUARD_type = OME_MENU,
+#endif
+    .onEnter = NULL,
+    .onExit = NULL,
+    .onDisplayUpdate = NULL,
+    .entries = menuMainEntries,
+};
+
+// STUBS
+
+PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+PG_REGISTER(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 0);
+PG_REGISTER(gpsConfig_t, gpsConfig, PG_GPS_CONFIG, 0);
+PG_REGISTER(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 0);
+PG_REGISTER(pilotConfig_t, pilotConfig, PG_PILOT_CONFIG, 0);
+PG_REGISTER(imuConfig_t, imuConfig, PG_IMU_CONFIG, 0);
+
+float rcCommand[4];
+float rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+attitudeEulerAngles_t attitude;
+matrix33_t rMat;
+pidProfile_t *currentPidProfile;
+float motor[MAX_SUPPORTED_MOTORS];
+acc_t acc;
+linkQualitySource_e linkQualitySource;
+gpsSolutionData_t gpsSol;
+uint16_t GPS_distanceToHome;
+int16_t GPS_directionToHome;
+uint32_t GPS_distanceFlownInCm;
+
+void delay(uint32_t ms) { UNUSED(ms); }
+bool featureIsEnabled(const uint32_t mask) { UNUSED(mask); return false; }
+bool IS_RC_MODE_ACTIVE(boxId_e boxId) { UNUSED(boxId); return false; }
+bool isModeActivationConditionPresent(boxId_e modeId) { UNUSED(modeId); return false; }
+bool isAirmodeEnabled(void) { return false; }
+bool isBeeperOn(void) { return false; }
+void beeperConfirmationBeeps(uint8_t beepCount) { UNUSED(beepCount); }
+uint8_t getCurrentPidProfileIndex(void) { return 0; }
+uint8_t getCurrentControlRateProfileIndex(void) { return 0; }
+uint16_t rxGetLinkQuality(void) { return LINK_QUALITY_MAX_VALUE; }
+uint16_t getCoreTemperatureCelsius(void) { return 0; }
+int32_t getAltitudeAsl(void) { return replayAltitudeCm; }
+bool gpsIsHealthy(void) { return false; }
+int32_t blackboxGetLogNumber(void) { return 0; }
+bool isBlackboxDeviceWorking(void) { return false; }
+bool isBlackboxDeviceFull(void) { return false; }
+bool isCrashFlipModeActive(void) { return false; }
+float pidItermAccelerator(void) { return 1.0f; }
+uint8_t getMotorCount(void) { return 4; }
+bool areMotorsRunning(void) { return ARMING_FLAG(ARMED); }
+bool pidOsdAntiGravityActive(void) { return false; }
+bool failsafeIsActive(void) { return false; }
+bool isUpright(void) { return true; }
+float getMotorOutputLow(void) { return 1000.0f; }
+float getMotorOutputHigh(void) { return 2047.0f; }
+uint32_t persistentObjectRead(persistentObjectId_e id) { UNUSED(id); return 0; }
+void persistentObjectWrite(persistentObjectId_e id, uint32_t value) { UNUSED(id); UNUSED(value); }
+void schedulerIgnoreTaskStateTime(void) { }
+void schedulerIgnoreTaskExecRate(void) { }
+void schedulerIgnoreTaskExecTime(void) { }
+bool schedulerGetIgnoreTaskExecTime(void) { return false; }
+void schedulerSetNextStateTime(timeDelta_t nextStateTime) { UNUSED(nextStateTime); }
+void saveConfigAndNotify(void) { }
+void stopMotors(void) { }
+void motorShutdown(void) { }
+void systemReset(void) { }
+void setRebootRequired(void) { }
+bool getRebootRequired(void) { return false; }
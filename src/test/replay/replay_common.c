@@ -0,0 +1,118 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/maths.h"
+
+#include "replay_common.h"
+
+static uint32_t replayRandomState = 1;
+
+uint64_t nanosNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void timingAdd(replayTiming_t *timing, uint64_t elapsedNs)
+{
+    timing->calls++;
+    timing->totalNs += elapsedNs;
+    timing->maxNs = MAX(timing->maxNs, elapsedNs);
+}
+
+void replayRandomSeed(uint32_t seed)
+{
+    replayRandomState = MAX(seed, 1U);
+}
+
+uint32_t replayRandom(void)
+{
+    replayRandomState ^= replayRandomState << 13;
+    replayRandomState ^= replayRandomState >> 17;
+    replayRandomState ^= replayRandomState << 5;
+    return replayRandomState;
+}
+
+int splitFields(char *line, char **fields)
+{
+    int count = 0;
+    char *saveptr;
+    for (char *token = strtok_r(line, ",\r\n", &saveptr); token && count < REPLAY_LOG_MAX_FIELDS; token = strtok_r(NULL, ",\r\n", &saveptr)) {
+        while (*token == ' ') {
+            token++;
+        }
+        fields[count++] = token;
+    }
+    return count;
+}
+
+float *loadFrames(FILE *file, int fieldCount, replayMapFieldsFn mapFields, int *columns, int *frameCount)
+{
+    char line[REPLAY_LOG_LINE_LENGTH];
+    char *fields[REPLAY_LOG_MAX_FIELDS];
+    float scales[fieldCount];
+
+    if (!fgets(line, sizeof(line), file)) {
+        return NULL;
+    }
+    for (int i = 0; i < fieldCount; i++) {
+        columns[i] = -1;
+        scales[i] = 1.0f;
+    }
+    const int nameCount = splitFields(line, fields);
+    if (!mapFields(fields, nameCount, columns, scales) || columns[0] < 0) {
+        return NULL;
+    }
+
+    int capacity = 1024;
+    int count = 0;
+    float *frames = malloc(capacity * fieldCount * sizeof(*frames));
+
+    while (frames && fgets(line, sizeof(line), file)) {
+        const int valueCount = splitFields(line, fields);
+        if (valueCount <= columns[0]) {
+            continue;
+        }
+        if (count == capacity) {
+            float *grown = realloc(frames, 2 * capacity * fieldCount * sizeof(*frames));
+            if (!grown) {
+                break;
+            }
+            frames = grown;
+            capacity *= 2;
+        }
+        float *frame = &frames[count * fieldCount];
+        for (int i = 0; i < fieldCount; i++) {
+            frame[i] = (columns[i] >= 0 && columns[i] < valueCount) ? strtof(fields[columns[i]], NULL) * scales[i] : 0.0f;
+        }
+        count++;
+    }
+
+    *frameCount = count;
+    return frames;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Helpers shared by the off-target replay tools: a monotonic clock and call timings for the cost
+ * reports, a pseudo random generator that repeats across hosts, and the loader for blackbox logs
+ * decoded to CSV by blackbox_decode.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define REPLAY_LOG_LINE_LENGTH 4096
+#define REPLAY_LOG_MAX_FIELDS 256
+
+typedef struct replayTiming_s {
+    uint32_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+} replayTiming_t;
+
+uint64_t nanosNow(void);
+void timingAdd(replayTiming_t *timing, uint64_t elapsedNs);
+
+// xorshift32, a zero seed is taken as 1
+void replayRandomSeed(uint32_t seed);
+uint32_t replayRandom(void);
+
+// Splits a CSV line in place, dropping the spaces blackbox_decode puts after each comma
+int splitFields(char *line, char **fields);
+
+// Finds the column of each field a tool replays in the log header. The columns start at -1 and the
+// scales at 1, returning false rejects the log.
+typedef bool (*replayMapFieldsFn)(char **names, int count, int *columns, float *scales);
+
+// Loads a log as frameCount rows of fieldCount values, each scaled as mapped. Field 0 is the time,
+// lines without it are skipped, and fields which are not logged read 0. The rows are malloc'd,
+// NULL if the log is rejected.
+float *loadFrames(FILE *file, int fieldCount, replayMapFieldsFn mapFields, int *columns, int *frameCount);
@@ -0,0 +1,890 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Off-target replay of serial RX byte streams.
+ *
+ * Feeds a byte stream through the unmodified serial receive callback of one of the serial RX protocols,
+ * with the clock following the byte timing, and polls the frame status the way the RX task does. The
+ * stream is either a capture or is synthesised for the protocols that have an encoder here, in which
+ * case every decoded frame is checked against the channels that were sent.
+ *
+ * Noise can be added to either: flipped bits, dropped and inserted bytes, and baud glitches that garble
+ * a burst of bytes. The statistics on stderr cover the host cost per byte and per poll, decoded frames
+ * per host second, the latency from the last byte of a frame to its channels being read, corrupted
+ * frames that were accepted, clean frames that were lost and how long the parser takes to recover after
+ * an impaired frame. The decoded channels are written to stdout as CSV.
+ *
+ * With -m the bytes are not handed to the receive callback but collect in the port's buffer, as with RX DMA, and
+ * the idle line callback is run once the line has been quiet for a byte time, for the protocols that frame
+ * from it. The callback cost is then that of the idle interrupts, so the cost per frame of the two ways of
+ * receiving can be compared, also at the faster baud rates of -b.
+ *
+ * Captures are text files with one "time,byte" pair per line, time in us (or seconds with -s, as
+ * exported by logic analysers) and the byte in decimal or 0x hex. Lines that do not parse are skipped.
+ *
+ * Usage: rx_replay -p protocol [-c capture.csv [-s]] [-f frames] [-t poll_us] [-b baud] [-l frame_us] [-m]
+ *                  [-e bit_error] [-d drop] [-i insert] [-g glitch] [-r seed] [-n repeat]
+ *   -p  crsf, sbus, ghst, ibus, sumd, fport, spektrum, srxl2 or jetiexbus
+ *   -c  replay a capture, synthetic streams are only available for crsf, sbus, ibus and sumd
+ *   -f  number of synthetic frames, 1000 by default
+ *   -t  interval the frame status is polled at, 0 polls after every byte, 125us by default
+ *   -b  baud rate of the link instead of the protocol's own, as after a CRSF baud rate negotiation
+ *   -l  interval of synthetic frames instead of the protocol's own, e.g. 1000 for a 1kHz link
+ *   -m  receive through the port's buffer and the idle line callback, only for crsf
+ *   -e  probability of a bit error in a byte
+ *   -d  probability of a byte being dropped
+ *   -i  probability of a garbage byte being inserted before a byte
+ *   -g  probability of a frame being hit by a baud glitch
+ *   -r  random seed, so impaired runs can be repeated
+ *   -n  replay the stream this many times to get stable timings
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/serial.h"
+#include "drivers/time.h"
+
+#include "io/serial.h"
+
+#include "pg/pg.h"
+#include "pg/rx.h"
+
+#include "rx/rx.h"
+#include "rx/crsf.h"
+#include "rx/fport.h"
+#include "rx/ghst.h"
+#include "rx/ibus.h"
+#include "rx/jetiexbus.h"
+#include "rx/sbus.h"
+#include "rx/spektrum.h"
+#include "rx/srxl2.h"
+#include "rx/sumd.h"
+
+#include "telemetry/ibus_shared.h"
+#include "telemetry/smartport.h"
+#include "telemetry/smartport_response.h"
+#include "telemetry/telemetry.h"
+
+#include "replay_common.h"
+
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+#define REPLAY_LINE_LENGTH 256
+#define REPLAY_MAX_CHANNELS 16
+#define REPLAY_MAX_FRAME_SIZE 64
+#define REPLAY_CHANNEL_TOLERANCE 2
+// Leaves room for the inter frame gap checks of the parsers before the first byte
+#define REPLAY_START_US 1000000
+#define REPLAY_RX_BUFFER_SIZE 256
+
+typedef int (*replayEncodeFn)(uint8_t *frame, const uint16_t *channels);
+
+typedef struct replayProtocol_s {
+    const char *name;
+    SerialRXType provider;
+    bool (*init)(const rxConfig_t *rxConfig, rxRuntimeState_t *rxRuntimeState);
+    uint32_t baudRate;
+    uint8_t bitsPerByte;            // including start, parity and stop bits
+    uint32_t frameIntervalUs;       // of synthetic streams
+    uint8_t channelCount;           // checked in synthetic streams
+    replayEncodeFn encode;          // NULL if only captures can be replayed
+    bool idleFraming;               // frames the bytes of the port's buffer from the idle line callback
+} replayProtocol_t;
+
+// A byte as it arrives at the UART
+typedef struct replayByte_s {
+    double timeUs;
+    int32_t frameIndex;             // -1 for captured or inserted bytes
+    uint8_t value;
+    bool frameEnd;
+} replayByte_t;
+
+typedef struct replayFrame_s {
+    uint16_t channels[REPLAY_MAX_CHANNELS];
+    double endUs;
+    bool impaired;
+    bool decoded;
+} replayFrame_t;
+
+typedef struct replayStream_s {
+    replayByte_t *bytes;
+    int byteCount;
+    int byteCapacity;
+    replayFrame_t *frames;
+    int frameCount;
+    double durationUs;
+} replayStream_t;
+
+typedef struct replayImpairment_s {
+    double bitError;
+    double drop;
+    double insert;
+    double glitch;
+} replayImpairment_t;
+
+// Where a pass over the stream is, times are on the replay clock
+typedef struct replayPass_s {
+    double offsetUs;                // of the stream
+    double lastByteUs;
+    double resyncStartUs;           // negative unless recovering from an impaired frame
+    int lastFrame;                  // last frame whose final byte was received
+} replayPass_t;
+
+typedef struct replayStats_s {
+    uint64_t callbackNs;
+    uint64_t pollNs;
+    uint32_t bytes;
+    uint32_t idles;
+    uint32_t overruns;
+    uint32_t polls;
+    uint32_t decoded;
+    uint32_t good;
+    uint32_t bad;
+    uint32_t failsafe;
+    uint32_t latencyCount;
+    double latencyTotalUs;
+    double latencyMaxUs;
+    uint32_t resyncCount;
+    double resyncTotalUs;
+    double resyncMaxUs;
+} replayStats_t;
+
+static serialReceiveCallbackPtr replayCallback;
+static void *replayCallbackData;
+static serialPort_t replaySerialPort;
+static uint8_t replayRxBuffer[REPLAY_RX_BUFFER_SIZE];
+static uint32_t replayBaudRate;     // of the link if not the one the receiver opens the port at
+static bool replayIdleFraming;
+static uint32_t replayTimeUs;
+
+rxRuntimeState_t rxRuntimeState;
+
+static bool replayChance(double probability)
+{
+    return probability > 0 && replayRandom() < probability * UINT32_MAX;
+}
+
+static uint8_t crc8DvbS2(uint8_t crc, uint8_t a)
+{
+    crc ^= a;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+    }
+    return crc;
+}
+
+static uint16_t crc16Ccitt(uint16_t crc, uint8_t a)
+{
+    crc ^= (uint16_t)a << 8;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+// 16 channels of 11 bits, LSB first, as used by SBUS and CRSF
+static void packChannels11(uint8_t *packed, const uint16_t *values)
+{
+    memset(packed, 0, 22);
+    for (int i = 0; i < 16; i++) {
+        const int bit = i * 11;
+        const uint32_t value = (uint32_t)(values[i] & 0x7FF) << (bit % 8);
+        packed[bit / 8] |= value;
+        packed[bit / 8 + 1] |= value >> 8;
+        if (bit / 8 + 2 < 22) {
+            packed[bit / 8 + 2] |= value >> 16;
+        }
+    }
+}
+
+static int encodeCrsf(uint8_t *frame, const uint16_t *channels)
+{
+    uint16_t values[16];
+    for (int i = 0; i < 16; i++) {
+        values[i] = lrintf((channels[i] - 881) / 0.62477120195241f);
+    }
+
+    frame[0] = 0xC8;        // flight controller
+    frame[1] = 24;          // type, payload and crc
+    frame[2] = 0x16;        // RC channels packed
+    packChannels11(&frame[3], values);
+    uint8_t crc = 0;
+    for (int i = 2; i < 25; i++) {
+        crc = crc8DvbS2(crc, frame[i]);
+    }
+    frame[25] = crc;
+    return 26;
+}
+
+static int encodeSbus(uint8_t *frame, const uint16_t *channels)
+{
+    uint16_t values[16];
+    for (int i = 0; i < 16; i++) {
+        values[i] = ((channels[i] - 880) * 8) / 5;
+    }
+
+    frame[0] = 0x0F;
+    packChannels11(&frame[1], values);
+    frame[23] = 0;          // flags
+    frame[24] = 0;
+    return 25;
+}
+
+static int encodeIbus(uint8_t *frame, const uint16_t *channels)
+{
+    frame[0] = 0x20;
+    frame[1] = 0x40;
+    for (int i = 0; i < 14; i++) {
+        frame[2 + i * 2] = channels[i] & 0xFF;
+        frame[3 + i * 2] = channels[i] >> 8;
+    }
+    uint16_t checksum = 0xFFFF;
+    for (int i = 0; i < 30; i++) {
+        checksum -= frame[i];
+    }
+    frame[30] = checksum & 0xFF;
+    frame[31] = checksum >> 8;
+    return 32;
+}
+
+static int encodeSumd(uint8_t *frame, const uint16_t *channels)
+{
+    const int channelCount = 16;
+    frame[0] = 0xA8;
+    frame[1] = 0x01;        // SUMD v1, frame ok
+    frame[2] = channelCount;
+    for (int i = 0; i < channelCount; i++) {
+        frame[3 + i * 2] = (channels[i] * 8) >> 8;
+        frame[4 + i * 2] = (channels[i] * 8) & 0xFF;
+    }
+    const int length = 3 + channelCount * 2;
+    uint16_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc = crc16Ccitt(crc, frame[i]);
+    }
+    frame[length] = crc >> 8;
+    frame[length + 1] = crc & 0xFF;
+    return length + 2;
+}
+
+static const replayProtocol_t replayProtocols[] = {
+    { "crsf",      SERIALRX_CRSF,         crsfRxInit,    420000, 10,  4000, 16, encodeCrsf, true },
+    { "sbus",      SERIALRX_SBUS,         sbusInit,      100000, 12, 14000, 16, encodeSbus },
+    { "ghst",      SERIALRX_GHST,         ghstRxInit,    420000, 10,  4000,  0, NULL },
+    { "ibus",      SERIALRX_IBUS,         ibusInit,      115200, 10,  7000, 14, encodeIbus },
+    { "sumd",      SERIALRX_SUMD,         sumdInit,      115200, 10, 10000, 16, encodeSumd },
+    { "fport",     SERIALRX_FPORT,        fportRxInit,   115200, 10,  9000,  0, NULL },
+    { "spektrum",  SERIALRX_SPEKTRUM2048, spektrumInit,  115200, 10, 11000,  0, NULL },
+    { "srxl2",     SERIALRX_SRXL2,        srxl2RxInit,   115200, 10, 11000,  0, NULL },
+    { "jetiexbus", SERIALRX_JETIEXBUS,    jetiExBusInit, 125000, 10, 10000,  0, NULL },
+};
+
+static const replayProtocol_t *findProtocol(const char *name)
+{
+    for (unsigned i = 0; i < ARRAYLEN(replayProtocols); i++) {
+        if (strcmp(replayProtocols[i].name, name) == 0) {
+            return &replayProtocols[i];
+        }
+    }
+    return NULL;
+}
+
+static bool streamAddByte(replayStream_t *stream, double timeUs, uint8_t value, int frameIndex)
+{
+    if (stream->byteCount == stream->byteCapacity) {
+        const int capacity = stream->byteCapacity ? 2 * stream->byteCapacity : 4096;
+        replayByte_t *grown = realloc(stream->bytes, capacity * sizeof(*grown));
+        if (!grown) {
+            return false;
+        }
+        stream->bytes = grown;
+        stream->byteCapacity = capacity;
+    }
+    stream->bytes[stream->byteCount++] = (replayByte_t) {
+        .timeUs = timeUs,
+        .frameIndex = frameIndex,
+        .value = value,
+        .frameEnd = false,
+    };
+    return true;
+}
+
+// Channels sweep independently across 1000-2000us so a frame decoded from the wrong bytes stands out
+static void synthChannels(uint16_t *channels, int frameIndex)
+{
+    for (int i = 0; i < REPLAY_MAX_CHANNELS; i++) {
+        channels[i] = 1000 + (frameIndex * (7 + 2 * i) + i * 131) % 1001;
+    }
+}
+
+static bool synthStream(replayStream_t *stream, const replayProtocol_t *protocol, int frameCount, const replayImpairment_t *impairment)
+{
+    const double byteTimeUs = protocol->bitsPerByte * 1e6 / protocol->baudRate;
+
+    stream->frames = calloc(frameCount, sizeof(*stream->frames));
+    if (!stream->frames) {
+        return false;
+    }
+    stream->frameCount = frameCount;
+
+    for (int f = 0; f < frameCount; f++) {
+        replayFrame_t *frame = &stream->frames[f];
+        uint8_t bytes[REPLAY_MAX_FRAME_SIZE];
+
+        synthChannels(frame->channels, f);
+        const int length = protocol->encode(bytes, frame->channels);
+
+        // a baud glitch garbles a burst of bytes
+        int glitchStart = length;
+        int glitchEnd = length;
+        if (replayChance(impairment->glitch)) {
+            glitchStart = replayRandom() % length;
+            glitchEnd = glitchStart + 1 + replayRandom() % (length - glitchStart);
+            frame->impaired = true;
+        }
+
+        double timeUs = (double)f * protocol->frameIntervalUs;
+        for (int i = 0; i < length; i++) {
+            uint8_t value = bytes[i];
+            // bytes are timed at their stop bit, when the UART hands them over
+            if (replayChance(impairment->insert)) {
+                timeUs += byteTimeUs;
+                streamAddByte(stream, timeUs, replayRandom() & 0xFF, -1);
+                frame->impaired = true;
+            }
+            if (replayChance(impairment->drop)) {
+                timeUs += byteTimeUs;
+                frame->impaired = true;
+                continue;
+            }
+            if (i >= glitchStart && i < glitchEnd) {
+                value = replayRandom() & 0xFF;
+            }
+            if (replayChance(impairment->bitError)) {
+                value ^= 1 << (replayRandom() % 8);
+                frame->impaired = true;
+            }
+            timeUs += byteTimeUs;
+            if (!streamAddByte(stream, timeUs, value, f)) {
+                return false;
+            }
+        }
+        frame->endUs = timeUs;
+        if (stream->byteCount > 0 && stream->bytes[stream->byteCount - 1].frameIndex == f) {
+            stream->bytes[stream->byteCount - 1].frameEnd = true;
+        }
+    }
+    stream->durationUs = (double)frameCount * protocol->frameIntervalUs;
+
+    return true;
+}
+
+static bool loadCapture(replayStream_t *stream, FILE *file, bool seconds, const replayImpairment_t *impairment)
+{
+    char line[REPLAY_LINE_LENGTH];
+    double firstUs = -1;
+    double timeUs = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        char *end;
+        double time = strtod(line, &end);
+        if (end == line || *end != ',') {
+            continue;
+        }
+        char *valueStart = end + 1;
+        const unsigned long value = strtoul(valueStart, &end, 0);
+        if (end == valueStart || value > 0xFF) {
+            continue;
+        }
+
+        timeUs = seconds ? time * 1e6 : time;
+        if (firstUs < 0) {
+            firstUs = timeUs;
+        }
+        timeUs -= firstUs;
+
+        if (replayChance(impairment->insert)) {
+            streamAddByte(stream, timeUs, replayRandom() & 0xFF, -1);
+        }
+        if (replayChance(impairment->drop)) {
+            continue;
+        }
+        uint8_t byte = value;
+        if (replayChance(impairment->bitError)) {
+            byte ^= 1 << (replayRandom() % 8);
+        }
+        if (!streamAddByte(stream, timeUs, byte, -1)) {
+            return false;
+        }
+    }
+    stream->durationUs = timeUs;
+
+    return stream->byteCount > 0;
+}
+
+static void replayInit(const replayProtocol_t *protocol)
+{
+    pgResetAll();
+
+    rxRuntimeState.rxProvider = RX_PROVIDER_SERIAL;
+    rxRuntimeState.serialrxProvider = protocol->provider;
+    rxConfigMutable()->serialrx_provider = protocol->provider;
+
+    replayTimeUs = REPLAY_START_US;
+    protocol->init(rxConfig(), &rxRuntimeState);
+}
+
+static bool channelsMatch(const float *decoded, const uint16_t *expected, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (fabsf(decoded[i] - expected[i]) > REPLAY_CHANNEL_TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printDecoded(double timeUs, int frameIndex, const float *channels)
+{
+    printf("%.1f,%d", timeUs, frameIndex);
+    for (int i = 0; i < rxRuntimeState.channelCount && i < REPLAY_MAX_CHANNELS; i++) {
+        printf(",%.0f", channels[i]);
+    }
+    printf("\n");
+}
+
+// Runs the RX task side: frame status, processing and reading the channels into rcData
+static void replayPoll(const replayProtocol_t *protocol, replayStream_t *stream, replayPass_t *pass, double nowUs,
+                       replayStats_t *stats, bool output)
+{
+    float channels[REPLAY_MAX_CHANNELS] = { 0 };
+
+    replayTimeUs = REPLAY_START_US + lrint(nowUs);
+
+    uint64_t startNs = nanosNow();
+    uint8_t frameStatus = rxRuntimeState.rcFrameStatusFn(&rxRuntimeState);
+    if ((frameStatus & RX_FRAME_PROCESSING_REQUIRED) && rxRuntimeState.rcProcessFrameFn) {
+        if (!rxRuntimeState.rcProcessFrameFn(&rxRuntimeState)) {
+            frameStatus = RX_FRAME_DROPPED;
+        }
+    }
+    const bool complete = (frameStatus & RX_FRAME_COMPLETE) && !(frameStatus & (RX_FRAME_FAILSAFE | RX_FRAME_DROPPED));
+    if (complete) {
+        for (int i = 0; i < rxRuntimeState.channelCount && i < REPLAY_MAX_CHANNELS; i++) {
+            channels[i] = rxRuntimeState.rcReadRawFn(&rxRuntimeState, i);
+        }
+    }
+    stats->pollNs += nanosNow() - startNs;
+    stats->polls++;
+
+    if (frameStatus & RX_FRAME_FAILSAFE) {
+        stats->failsafe++;
+    }
+    if (!complete) {
+        return;
+    }
+    stats->decoded++;
+
+    if (!stream->frames) {
+        // only the byte timing is known for captures
+        const double latencyUs = nowUs - pass->lastByteUs;
+        stats->latencyCount++;
+        stats->latencyTotalUs += latencyUs;
+        stats->latencyMaxUs = MAX(stats->latencyMaxUs, latencyUs);
+        if (output) {
+            printDecoded(nowUs, -1, channels);
+        }
+        return;
+    }
+
+    replayFrame_t *frame = pass->lastFrame >= 0 ? &stream->frames[pass->lastFrame] : NULL;
+    if (!frame || frame->decoded || !channelsMatch(channels, frame->channels, protocol->channelCount)) {
+        stats->bad++;
+        if (output) {
+            printDecoded(nowUs, -1, channels);
+        }
+        return;
+    }
+
+    frame->decoded = true;
+    stats->good++;
+    const double latencyUs = nowUs - (pass->offsetUs + frame->endUs);
+    stats->latencyCount++;
+    stats->latencyTotalUs += latencyUs;
+    stats->latencyMaxUs = MAX(stats->latencyMaxUs, latencyUs);
+
+    if (pass->resyncStartUs >= 0) {
+        const double resyncUs = nowUs - pass->resyncStartUs;
+        stats->resyncCount++;
+        stats->resyncTotalUs += resyncUs;
+        stats->resyncMaxUs = MAX(stats->resyncMaxUs, resyncUs);
+        pass->resyncStartUs = -1;
+    }
+
+    if (output) {
+        printDecoded(nowUs, pass->lastFrame, channels);
+    }
+}
+
+static void replayPass(const replayProtocol_t *protocol, replayStream_t *stream, double offsetUs, uint32_t pollIntervalUs,
+                       replayStats_t *stats, bool output)
+{
+    replayPass_t pass = {
+        .offsetUs = offsetUs,
+        .lastByteUs = offsetUs,
+        .resyncStartUs = -1,
+        .lastFrame = -1,
+    };
+    double nextPollUs = offsetUs;
+    const double byteTimeUs = protocol->bitsPerByte * 1e6 / protocol->baudRate;
+
+    for (int i = 0; i < stream->frameCount; i++) {
+        stream->frames[i].decoded = false;
+    }
+
+    for (int i = 0; i < stream->byteCount; i++) {
+        const replayByte_t *byte = &stream->bytes[i];
+        const double byteUs = offsetUs + byte->timeUs;
+
+        while (pollIntervalUs && nextPollUs < byteUs) {
+            replayPoll(protocol, stream, &pass, nextPollUs, stats, output);
+            nextPollUs += pollIntervalUs;
+        }
+
+        replayTimeUs = REPLAY_START_US + lrint(byteUs);
+        if (replayIdleFraming) {
+            serialPort_t *port = &replaySerialPort;
+            const uint32_t head = (port->rxBufferHead + 1) % port->rxBufferSize;
+            if (head == port->rxBufferTail) {
+                stats->overruns++;
+            } else {
+                port->rxBuffer[port->rxBufferHead] = byte->value;
+                port->rxBufferHead = head;
+            }
+            // the line is taken as idle once a byte time passes without the start of another byte
+            if (i + 1 == stream->byteCount || stream->bytes[i + 1].timeUs - byte->timeUs > 2 * byteTimeUs) {
+                replayTimeUs = REPLAY_START_US + lrint(byteUs + 2 * byteTimeUs);
+                const uint64_t startNs = nanosNow();
+                port->idleCallback();
+                stats->callbackNs += nanosNow() - startNs;
+                stats->idles++;
+            }
+        } else {
+            const uint64_t startNs = nanosNow();
+            replayCallback(byte->value, replayCallbackData);
+            stats->callbackNs += nanosNow() - startNs;
+        }
+        stats->bytes++;
+        pass.lastByteUs = byteUs;
+
+        if (byte->frameEnd) {
+            pass.lastFrame = byte->frameIndex;
+            // recovery is timed from the end of the last impaired frame in a run
+            if (stream->frames[pass.lastFrame].impaired) {
+                pass.resyncStartUs = offsetUs + stream->frames[pass.lastFrame].endUs;
+            }
+        }
+
+        if (!pollIntervalUs) {
+            replayPoll(protocol, stream, &pass, byteUs, stats, output);
+        }
+    }
+
+    // let the last frame be picked up
+    replayPoll(protocol, stream, &pass, pass.lastByteUs + MAX(pollIntervalUs, 1U), stats, output);
+}
+
+static void printStats(const replayStream_t *stream, const replayStats_t *stats, int repeat)
+{
+    const uint64_t parseNs = stats->callbackNs + stats->pollNs;
+
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "bytes", stats->bytes / repeat);
+    fprintf(stderr, "%-22s %12.1f\n", "callback ns/byte", stats->bytes ? (double)stats->callbackNs / stats->bytes : 0.0);
+    fprintf(stderr, "%-22s %12.1f\n", "callback ns/frame", stats->decoded ? (double)stats->callbackNs / stats->decoded : 0.0);
+    if (stats->idles) {
+        fprintf(stderr, "%-22s %12" PRIu32 "\n", "idle interrupts", stats->idles / repeat);
+        fprintf(stderr, "%-22s %12" PRIu32 "\n", "rx overruns", stats->overruns / repeat);
+    }
+    fprintf(stderr, "%-22s %12.1f\n", "poll ns", stats->polls ? (double)stats->pollNs / stats->polls : 0.0);
+    fprintf(stderr, "%-22s %12.0f\n", "frames/s (host)", parseNs ? stats->decoded * 1e9 / parseNs : 0.0);
+    fprintf(stderr, "%-22s %12.1f\n", "frames/s (stream)", stream->durationUs > 0 ? stats->decoded / repeat * 1e6 / stream->durationUs : 0.0);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "frames decoded", stats->decoded / repeat);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "failsafe frames", stats->failsafe / repeat);
+    fprintf(stderr, "%-22s %12.1f %12.1f\n", "latency avg/max us",
+        stats->latencyCount ? stats->latencyTotalUs / stats->latencyCount : 0.0, stats->latencyMaxUs);
+
+    if (!stream->frames) {
+        return;
+    }
+
+    int impaired = 0;
+    int cleanLost = 0;
+    for (int i = 0; i < stream->frameCount; i++) {
+        if (stream->frames[i].impaired) {
+            impaired++;
+        } else if (!stream->frames[i].decoded) {
+            cleanLost++;
+        }
+    }
+    fprintf(stderr, "%-22s %12d\n", "frames sent", stream->frameCount);
+    fprintf(stderr, "%-22s %12d\n", "frames impaired", impaired);
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "frames good", stats->good / repeat);
+    // channels other than the ones sent, corrupted frames the protocol let through
+    fprintf(stderr, "%-22s %12" PRIu32 "\n", "frames bad", stats->bad / repeat);
+    // clean frames lost while the parser was out of sync from an earlier impairment
+    fprintf(stderr, "%-22s %12d\n", "clean frames lost", cleanLost);
+    fprintf(stderr, "%-22s %12.1f %12.1f\n", "resync avg/max us",
+        stats->resyncCount ? stats->resyncTotalUs / stats->resyncCount : 0.0, stats->resyncMaxUs);
+}
+
+static bool parseProbability(const char *arg, double *probability)
+{
+    char *end;
+    *probability = strtod(arg, &end);
+    return *end == '\0' && *probability >= 0 && *probability <= 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const replayProtocol_t *protocol = NULL;
+    replayImpairment_t impairment = { 0 };
+    const char *capture = NULL;
+    bool seconds = false;
+    int frameCount = 1000;
+    uint32_t pollIntervalUs = 125;
+    uint32_t frameIntervalUs = 0;
+    int repeat = 1;
+
+    bool usage = argc < 2;
+    for (int arg = 1; arg < argc && !usage; arg++) {
+        const bool hasValue = arg + 1 < argc;
+        if (strcmp(argv[arg], "-p") == 0 && hasValue) {
+            protocol = findProtocol(argv[++arg]);
+            usage = !protocol;
+        } else if (strcmp(argv[arg], "-c") == 0 && hasValue) {
+            capture = argv[++arg];
+        } else if (strcmp(argv[arg], "-s") == 0) {
+            seconds = true;
+        } else if (strcmp(argv[arg], "-f") == 0 && hasValue) {
+            frameCount = MAX(atoi(argv[++arg]), 1);
+        } else if (strcmp(argv[arg], "-t") == 0 && hasValue) {
+            pollIntervalUs = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-b") == 0 && hasValue) {
+            replayBaudRate = strtoul(argv[++arg], NULL, 0);
+            usage = !replayBaudRate;
+        } else if (strcmp(argv[arg], "-l") == 0 && hasValue) {
+            frameIntervalUs = strtoul(argv[++arg], NULL, 0);
+            usage = !frameIntervalUs;
+        } else if (strcmp(argv[arg], "-m") == 0) {
+            replayIdleFraming = true;
+        } else if (strcmp(argv[arg], "-e") == 0 && hasValue) {
+            usage = !parseProbability(argv[++arg], &impairment.bitError);
+        } else if (strcmp(argv[arg], "-d") == 0 && hasValue) {
+            usage = !parseProbability(argv[++arg], &impairment.drop);
+        } else if (strcmp(argv[arg], "-i") == 0 && hasValue) {
+            usage = !parseProbability(argv[++arg], &impairment.insert);
+        } else if (strcmp(argv[arg], "-g") == 0 && hasValue) {
+            usage = !parseProbability(argv[++arg], &impairment.glitch);
+        } else if (strcmp(argv[arg], "-r") == 0 && hasValue) {
+            replayRandomSeed(strtoul(argv[++arg], NULL, 0));
+        } else if (strcmp(argv[arg], "-n") == 0 && hasValue) {
+            repeat = MAX(atoi(argv[++arg]), 1);
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || !protocol) {
+        fprintf(stderr, "usage: %s -p protocol [-c capture.csv [-s]] [-f frames] [-t poll_us] [-b baud] [-l frame_us] [-m] [-e bit_error] [-d drop] [-i insert] [-g glitch] [-r seed] [-n repeat]\n", argv[0]);
+        return 1;
+    }
+    if (replayIdleFraming && !protocol->idleFraming) {
+        fprintf(stderr, "%s: does not frame from the idle line, -m is not available\n", protocol->name);
+        return 1;
+    }
+
+    // the stream is synthesised and timed for the link as configured
+    replayProtocol_t link = *protocol;
+    if (replayBaudRate) {
+        link.baudRate = replayBaudRate;
+    }
+    if (frameIntervalUs) {
+        link.frameIntervalUs = frameIntervalUs;
+    }
+    protocol = &link;
+
+    replayStream_t stream = { 0 };
+    if (capture) {
+        FILE *file = fopen(capture, "r");
+        if (!file) {
+            perror(capture);
+            return 1;
+        }
+        const bool loaded = loadCapture(&stream, file, seconds, &impairment);
+        fclose(file);
+        if (!loaded) {
+            fprintf(stderr, "%s: no bytes to replay\n", capture);
+            free(stream.bytes);
+            return 1;
+        }
+    } else if (!protocol->encode) {
+        fprintf(stderr, "%s: no encoder for synthetic streams, use -c\n", protocol->name);
+        return 1;
+    } else if (!synthStream(&stream, protocol, frameCount, &impairment)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    replayInit(protocol);
+    if (!replayCallback) {
+        fprintf(stderr, "%s: receiver did not open a serial port\n", protocol->name);
+        return 1;
+    }
+    fprintf(stderr, "replaying %d bytes of %s at %u baud\n", stream.byteCount, protocol->name, protocol->baudRate);
+
+    // only the decoded channels of the first pass are written, the others are for timing
+    replayStats_t stats = { 0 };
+    printf("time (us),frame");
+    for (int i = 0; i < rxRuntimeState.channelCount && i < REPLAY_MAX_CHANNELS; i++) {
+        printf(",rcData[%d]", i);
+    }
+    printf("\n");
+    for (int pass = 0; pass < repeat; pass++) {
+        // passes are separated by a gap every parser takes as the end of a frame
+        const double offsetUs = pass * (stream.durationUs + 100000);
+        replayPass(protocol, &stream, offsetUs, pollIntervalUs, &stats, pass == 0);
+    }
+
+    printStats(&stream, &stats, repeat);
+    free(stream.bytes);
+    free(stream.frames);
+
+    return 0;
+}
+
+// The replay clock follows the byte stream
+
+uint32_t micros(void) { return replayTimeUs; }
+uint32_t millis(void) { return replayTimeUs / 1000; }
+timeUs_t microsISR(void) { return replayTimeUs; }
+
+// The receiver opens a port whose transmit side goes nowhere
+
+static const serialPortConfig_t replayPortConfig = {
+    .identifier = SERIAL_PORT_USART1,
+    .functionMask = FUNCTION_RX_SERIAL,
+};
+
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    return function == FUNCTION_RX_SERIAL ? &replayPortConfig : NULL;
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr rxCallback,
+                             void *rxCallbackData, uint32_t baudRate, portMode_e mode, portOptions_e options)
+{
+    UNUSED(function);
+    replayCallback = rxCallback;
+    replayCallbackData = rxCallbackData;
+    replaySerialPort.identifier = identifier;
+    replaySerialPort.baudRate = replayBaudRate ? replayBaudRate : baudRate;
+    replaySerialPort.rxBuffer = replayRxBuffer;
+    replaySerialPort.rxBufferSize = REPLAY_RX_BUFFER_SIZE;
+    replaySerialPort.mode = mode;
+    replaySerialPort.options = options;
+    return &replaySerialPort;
+}
+
+// STUBS
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count) { UNUSED(instance); UNUSED(data); UNUSED(count); }
+void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate) { instance->baudRate = baudRate; }
+void serialSetIdleCallback(serialPort_t *instance, serialIdleCallbackPtr cb) { instance->idleCallback = cb; }
+uint32_t serialGetBaudRate(serialPort_t *instance) { return instance->baudRate; }
+
+uint32_t serialRxBytesWaiting(const serialPort_t *instance)
+{
+    return (instance->rxBufferHead - instance->rxBufferTail + instance->rxBufferSize) % instance->rxBufferSize;
+}
+
+uint8_t serialRead(serialPort_t *instance)
+{
+    const uint8_t ch = instance->rxBuffer[instance->rxBufferTail];
+    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    return ch;
+}
+bool isSerialPortShared(const serialPortConfig_t *portConfig, uint16_t functionMask, serialPortFunction_e sharedWithFunction)
+{
+    UNUSED(portConfig); UNUSED(functionMask); UNUSED(sharedWithFunction);
+    return false;
+}
+
+// the receivers run without telemetry
+serialPort_t *telemetrySharedPort;
+rssiSource_e rssiSource;
+
+bool telemetryCheckRxPortShared(const serialPortConfig_t *portConfig, const SerialRXType serialrxProvider)
+{
+    UNUSED(portConfig); UNUSED(serialrxProvider);
+    return false;
+}
+bool initSmartPortTelemetryExternal(smartPortWriteFrameFn *smartPortWriteFrameExternal) { UNUSED(smartPortWriteFrameExternal); return false; }
+void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *hasRequest, const uint32_t *requestTimeout)
+{
+    UNUSED(payload); UNUSED(hasRequest); UNUSED(requestTimeout);
+}
+void smartPortArmFrame(const smartPortPayload_t *payload, uint16_t checksum) { UNUSED(payload); UNUSED(checksum); }
+void smartPortResponseStart(void) {}
+void smartPortResponseWrite(uint8_t c, uint16_t *checksum) { UNUSED(c); UNUSED(checksum); }
+bool smartPortResponseIsArmed(void) { return false; }
+bool smartPortResponseSend(struct serialPort_s *port) { UNUSED(port); return false; }
+void smartPortResponseMiss(void) {}
+bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload) { UNUSED(payload); return false; }
+uint8_t respondToIbusRequest(uint8_t const * const ibusPacket) { UNUSED(ibusPacket); return 0; }
+void initSharedIbusTelemetry(serialPort_t *port) { UNUSED(port); }
+
+// as in telemetry/ibus_shared.c, which needs the rest of the telemetry
+bool isChecksumOkIa6b(const uint8_t *ibusPacket, const uint8_t length)
+{
+    uint16_t checksum = 0xFFFF;
+    for (unsigned i = 0; i < ibusPacket[0] - 2U; i++) {
+        checksum -= ibusPacket[i];
+    }
+    return (checksum >> 8) == ibusPacket[length - 1] && (checksum & 0xFF) == ibusPacket[length - 2];
+}
+
+void setRssi(uint16_t rssiValue, rssiSource_e source) { UNUSED(rssiValue); UNUSED(source); }
+void setRssiDirect(uint16_t newRssi, rssiSource_e source) { UNUSED(newRssi); UNUSED(source); }
+void parseRcChannels(const char *input, rxConfig_t *rxConfig) { UNUSED(input); UNUSED(rxConfig); }
@@ -55,10 +55,13 @@ extern "C" {
     #include "pg/gps.h"
     #include "pg/pilot.h"
     #include "pg/rx.h"
+    #include "pg/serial_uart.h"
     #include "rx/rx.h"
     #include "scheduler/scheduler.h"
     #include "sensors/battery.h"
     #include "sensors/gyro.h"
+    #include "telemetry/smartport_response.h"
+    #include "telemetry/telemetry_sensors.h"
 
     void cliSet(const char *cmdName, char *cmdline);
     int cliGetSettingIndex(char *name, uint8_t length);
@@ -91,6 +94,7 @@ extern "C" {
     PG_REGISTER(beeperConfig_t, beeperConfig, PG_BEEPER_CONFIG, 0);
     PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
     PG_REGISTER(serialConfig_t, serialConfig, PG_SERIAL_CONFIG, 0);
+    PG_REGISTER_ARRAY(serialUartConfig_t, UARTDEV_CONFIG_MAX, serialUartConfig, PG_SERIAL_UART_CONFIG, 1);
     PG_REGISTER_ARRAY(rxChannelRangeConfig_t, NON_AUX_CHANNEL_COUNT, rxChannelRangeConfigs, PG_RX_CHANNEL_RANGE_CONFIG, 0);
     PG_REGISTER_ARRAY(rxFailsafeChannelConfig_t, MAX_SUPPORTED_RC_CHANNEL_COUNT, rxFailsafeChannelConfigs, PG_RX_FAILSAFE_CHANNEL_CONFIG, 0);
     PG_REGISTER(pidConfig_t, pidConfig, PG_PID_CONFIG, 0);
@@ -311,6 +315,7 @@ void changeControlRateProfile(uint8_t) {}
 void resetAllRxChannelRangeConfigurations(rxChannelRangeConfig_t *) {}
 void writeEEPROM() {}
 serialPortConfig_t *serialFindPortConfigurationMutable(serialPortIdentifier_e) {return NULL; }
+const serialPortIdentifier_e serialPortIdentifiers[SERIAL_PORT_COUNT] = {};
 baudRate_e lookupBaudRateIndex(uint32_t){return BAUD_9600; }
 serialPortUsage_t *findSerialPortUsageByIdentifier(serialPortIdentifier_e){ return NULL; }
 serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) { return NULL; }
@@ -341,6 +346,10 @@ void getCheckFuncInfo(cfCheckFuncInfo_t *) {}
 void schedulerResetTaskMaxExecutionTime(taskId_e) {}
 void schedulerResetCheckFunctionMaxExecutionTime(void) {}
 
+const telemetrySensorInfo_t *telemetrySensorInfo(telemetrySensorId_e) { return NULL; }
+void telemetrySensorGetStats(telemetrySensorId_e, timeUs_t, telemetrySensorStats_t *stats) { memset(stats, 0, sizeof(*stats)); }
+const smartPortResponseStats_t *smartPortResponseGetStats(unsigned) { return NULL; }
+
 const char * const targetName = "UNITTEST";
 const char * const buildDate = "Jan 01 2017";
 const char * const buildTime = "00:00:00";
@@ -362,6 +371,9 @@ void writeUnmodifiedConfigToEEPROM(void) {}
 
 void changePidProfile(uint8_t) {}
 bool serialIsPortAvailable(serialPortIdentifier_e) { return false; }
+uint16_t uartRxBufferSizeMax(void) { return 256; }
+uint16_t uartTxBufferSizeMax(void) { return 256; }
+bool uartGetBufferSizes(serialPortIdentifier_e, uint16_t *, uint16_t *) { return false; }
 void generateLedConfig(ledConfig_t *, char *, size_t) {}
 //bool isSerialTransmitBufferEmpty(const serialPort_t *) {return true; }
 //void serialWrite(serialPort_t *, uint8_t ch) { printf("%c", ch);}
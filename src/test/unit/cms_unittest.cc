@@ -23,6 +23,8 @@
 
 #include <math.h>
 
+#include <string>
+
 #define USE_BARO
 
 extern "C" {
@@ -42,6 +44,7 @@ extern "C" {
     const void *cmsMenuBack(displayPort_t *pDisplay);
     uint16_t cmsHandleKey(displayPort_t *pDisplay, uint8_t key);
     extern CMS_Menu *currentMenu;    // Points to top entry of the current page
+    extern float rcData[18];
 }
 
 #include "unittest_macros.h"
@@ -129,6 +132,52 @@ TEST(CMSUnittest, TestCmsMenuKey)
     uint16_t result = cmsHandleKey(displayPort, KEY_ESC);
     EXPECT_EQ(BUTTON_PAUSE, result);
 }
+
+static uint8_t polledValue;
+static OSD_UINT8_t polledEntry = { &polledValue, 0, 100, 1 };
+
+static const OSD_Entry menuPolledEntries[] =
+{
+    {"-- POLLED --", OME_Label, NULL, NULL},
+    {"VALUE", OME_UINT8 | DYNAMIC, NULL, &polledEntry},
+    {"BACK", OME_Back, NULL, NULL},
+    {NULL, OME_END, NULL, NULL}
+};
+
+static CMS_Menu menuPolled = {
+    .onEnter = NULL,
+    .onExit = NULL,
+    .onDisplayUpdate = NULL,
+    .entries = menuPolledEntries,
+};
+
+TEST(CMSUnittest, TestCmsPolledValueOnlyWrittenOnChange)
+{
+    for (int i = 0; i < 4; i++) {
+        rcData[i] = 1500; // no stick commands
+    }
+    cmsInit();
+    displayPort_t *displayPort = displayPortTestInit();
+    cmsDisplayPortRegister(displayPort);
+    cmsMenuOpen();
+    cmsMenuChange(displayPort, &menuPolled);
+
+    polledValue = 42;
+    cmsHandler(1000000);
+    const std::string screen(testDisplayPortBuffer, UNITTEST_DISPLAYPORT_BUFFER_LEN);
+    const size_t pos = screen.find("42 ");
+    ASSERT_NE(std::string::npos, pos);
+
+    // An unchanged value isn't sent to the display again when polled
+    testDisplayPortBuffer[pos] = 'X';
+    cmsHandler(1200000);
+    EXPECT_EQ('X', testDisplayPortBuffer[pos]);
+
+    polledValue = 43;
+    cmsHandler(1400000);
+    EXPECT_EQ('4', testDisplayPortBuffer[pos]);
+    EXPECT_EQ('3', testDisplayPortBuffer[pos + 1]);
+}
 // STUBS
 
 extern "C" {
@@ -0,0 +1,353 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "config/config_eeprom.h"
+    #include "config/config_streamer.h"
+    #include "config/config_streamer_impl.h"
+
+    #include "drivers/system.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    typedef struct testConfigA_s {
+        uint32_t value;
+        uint8_t data[196];
+    } testConfigA_t;
+
+    typedef struct testConfigB_s {
+        uint16_t value;
+        uint8_t data[298];
+    } testConfigB_t;
+
+    typedef struct testConfigC_s {
+        uint32_t value;
+        uint8_t data[36];
+    } testConfigC_t;
+
+    PG_DECLARE(testConfigA_t, testConfigA);
+    PG_DECLARE(testConfigB_t, testConfigB);
+    PG_DECLARE(testConfigC_t, testConfigC);
+
+    PG_REGISTER(testConfigA_t, testConfigA, PG_RESERVED_FOR_TESTING_1, 0);
+    PG_REGISTER(testConfigB_t, testConfigB, PG_RESERVED_FOR_TESTING_2, 0);
+    PG_REGISTER(testConfigC_t, testConfigC, PG_RESERVED_FOR_TESTING_3, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BANK_SIZE (EEPROM_SIZE / 2)
+
+// Simulated flash: pages are erased to 0xFF when the streamer enters them and words can only be programmed once.
+static int eraseCount;
+static int programmedBytes;
+static int programErrors;
+static int wordsUntilPowerLoss;
+static int failureModeCount;
+
+static uint16_t bankGeneration(int bank)
+{
+    uint16_t generation;
+    memcpy(&generation, &eepromData[bank * BANK_SIZE + 2], sizeof(generation));
+    return generation;
+}
+
+static void flashReset(void)
+{
+    memset(eepromData, 0xFF, sizeof(eepromData));
+    eraseCount = 0;
+    programmedBytes = 0;
+    programErrors = 0;
+    wordsUntilPowerLoss = -1;
+    failureModeCount = 0;
+}
+
+static void clearCounters(void)
+{
+    eraseCount = 0;
+    programmedBytes = 0;
+}
+
+static void clearConfigs(void)
+{
+    memset(testConfigAMutable(), 0, sizeof(testConfigA_t));
+    memset(testConfigBMutable(), 0, sizeof(testConfigB_t));
+    memset(testConfigCMutable(), 0, sizeof(testConfigC_t));
+}
+
+static void setConfigs(uint32_t value)
+{
+    testConfigAMutable()->value = value;
+    testConfigAMutable()->data[10] = value + 1;
+    testConfigBMutable()->value = value + 2;
+    testConfigCMutable()->value = value + 3;
+}
+
+static void expectConfigs(uint32_t value)
+{
+    EXPECT_EQ(value, testConfigA()->value);
+    EXPECT_EQ((uint8_t)(value + 1), testConfigA()->data[10]);
+    EXPECT_EQ(value + 2, testConfigB()->value);
+    EXPECT_EQ(value + 3, testConfigC()->value);
+}
+
+static void saveInitialConfig(void)
+{
+    flashReset();
+    clearConfigs();
+    setConfigs(100);
+    writeConfigToEEPROM();
+    ASSERT_TRUE(isEEPROMStructureValid());
+    clearCounters();
+}
+
+TEST(ConfigEepromUnittest, TestFirstSaveWritesCompleteCopy)
+{
+    flashReset();
+    clearConfigs();
+    setConfigs(100);
+
+    EXPECT_FALSE(isEEPROMStructureValid());
+
+    writeConfigToEEPROM();
+
+    EXPECT_EQ(0, failureModeCount);
+    EXPECT_EQ(0, programErrors);
+    EXPECT_TRUE(isEEPROMStructureValid());
+    EXPECT_TRUE(isEEPROMVersionValid());
+    EXPECT_EQ(1, eraseCount);
+    EXPECT_EQ(0xBE, eepromData[1]);
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    expectConfigs(100);
+}
+
+TEST(ConfigEepromUnittest, TestUnchangedConfigIsNotWritten)
+{
+    saveInitialConfig();
+    const uint16_t configSize = getEEPROMConfigSize();
+
+    writeConfigToEEPROM();
+
+    EXPECT_EQ(0, eraseCount);
+    EXPECT_EQ(0, programmedBytes);
+    EXPECT_TRUE(isEEPROMStructureValid());
+    EXPECT_EQ(configSize, getEEPROMConfigSize());
+}
+
+TEST(ConfigEepromUnittest, TestChangedPgIsAppendedWithoutErase)
+{
+    saveInitialConfig();
+    const uint16_t configSize = getEEPROMConfigSize();
+
+    testConfigCMutable()->value = 1234;
+    writeConfigToEEPROM();
+
+    // header + record + PG + checksum, padded to the streamer word size
+    const int entrySize = 4 + 6 + sizeof(testConfigC_t) + 2;
+    EXPECT_EQ(0, failureModeCount);
+    EXPECT_EQ(0, programErrors);
+    EXPECT_EQ(0, eraseCount);
+    EXPECT_EQ((entrySize + 3) / 4 * 4, programmedBytes);
+    EXPECT_TRUE(isEEPROMStructureValid());
+    EXPECT_EQ(configSize + programmedBytes, getEEPROMConfigSize());
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(100u, testConfigA()->value);
+    EXPECT_EQ(102u, testConfigB()->value);
+    EXPECT_EQ(1234u, testConfigC()->value);
+}
+
+TEST(ConfigEepromUnittest, TestLatestJournalEntryWins)
+{
+    saveInitialConfig();
+
+    for (uint32_t value = 1; value <= 5; value++) {
+        testConfigCMutable()->value = value;
+        writeConfigToEEPROM();
+    }
+    testConfigAMutable()->value = 77;
+    writeConfigToEEPROM();
+
+    // the journal grew into the next page without touching the other bank
+    EXPECT_EQ(0, programErrors);
+    EXPECT_EQ(0xFF, eepromData[BANK_SIZE + 1]);
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(77u, testConfigA()->value);
+    EXPECT_EQ(102u, testConfigB()->value);
+    EXPECT_EQ(5u, testConfigC()->value);
+}
+
+TEST(ConfigEepromUnittest, TestFullJournalAlternatesBanks)
+{
+    saveInitialConfig();
+
+    // fill the journal of the first bank until a complete copy is written to the second one
+    uint32_t value = 200;
+    while (eepromData[BANK_SIZE + 1] != 0xBE) {
+        setConfigs(++value);
+        writeConfigToEEPROM();
+        ASSERT_EQ(0, failureModeCount);
+        ASSERT_LT(value, 300u);
+    }
+
+    EXPECT_EQ(0, programErrors);
+    EXPECT_EQ(0xBE, eepromData[BANK_SIZE + 1]);
+    // the previous copy is left intact until the next full write
+    EXPECT_EQ(0xBE, eepromData[1]);
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    expectConfigs(value);
+
+    // the second bank fills up in turn and the first one takes over again
+    while (bankGeneration(0) != bankGeneration(1) + 1) {
+        setConfigs(++value);
+        writeConfigToEEPROM();
+        ASSERT_EQ(0, failureModeCount);
+        ASSERT_LT(value, 400u);
+    }
+
+    EXPECT_EQ(0, programErrors);
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    expectConfigs(value);
+
+    // a stale journal left in the first bank is not applied to the new copy
+    testConfigBMutable()->value = 5;
+    writeConfigToEEPROM();
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(5u, testConfigB()->value);
+    EXPECT_EQ(value + 3, testConfigC()->value);
+}
+
+TEST(ConfigEepromUnittest, TestInterruptedAppendKeepsPreviousConfig)
+{
+    saveInitialConfig();
+
+    testConfigCMutable()->value = 500;
+    writeConfigToEEPROM();
+
+    // lose power half way through the next entry
+    testConfigAMutable()->value = 600;
+    testConfigCMutable()->value = 700;
+    wordsUntilPowerLoss = 20;
+    writeConfigToEEPROM();
+    wordsUntilPowerLoss = -1;
+
+    clearConfigs();
+    EXPECT_TRUE(isEEPROMStructureValid());
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(100u, testConfigA()->value);
+    EXPECT_EQ(500u, testConfigC()->value);
+
+    // the partially programmed area cannot be appended to, so the next save writes a complete copy
+    failureModeCount = 0;
+    clearCounters();
+    testConfigCMutable()->value = 800;
+    writeConfigToEEPROM();
+
+    EXPECT_EQ(0, failureModeCount);
+    EXPECT_EQ(0, programErrors);
+    EXPECT_LT(0, eraseCount);
+
+    clearConfigs();
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(100u, testConfigA()->value);
+    EXPECT_EQ(800u, testConfigC()->value);
+}
+
+TEST(ConfigEepromUnittest, TestCorruptedStorageResetsConfig)
+{
+    flashReset();
+    setConfigs(100);
+
+    EXPECT_FALSE(loadEEPROM());
+    EXPECT_EQ(0u, testConfigA()->value);
+    EXPECT_EQ(0u, testConfigC()->value);
+}
+
+// STUBS
+
+extern "C" {
+
+void failureMode(failureMode_e mode)
+{
+    UNUSED(mode);
+    failureModeCount++;
+}
+
+bool loadEEPROMFromFile(void)
+{
+    return true;
+}
+
+void configUnlock(void) {}
+void configLock(void) {}
+
+configStreamerResult_e configWriteWord(uintptr_t address, config_streamer_buffer_type_t *buffer)
+{
+    const uintptr_t offset = address - (uintptr_t)eepromData;
+    if (offset + sizeof(*buffer) > sizeof(eepromData)) {
+        return CONFIG_RESULT_ADDRESS_INVALID;
+    }
+
+    if (wordsUntilPowerLoss == 0) {
+        return CONFIG_RESULT_SUCCESS;
+    }
+    if (wordsUntilPowerLoss > 0) {
+        wordsUntilPowerLoss--;
+    }
+
+    if (offset % FLASH_PAGE_SIZE == 0) {
+        memset(&eepromData[offset], 0xFF, FLASH_PAGE_SIZE);
+        eraseCount++;
+    }
+
+    for (unsigned i = 0; i < sizeof(*buffer); i++) {
+        if (eepromData[offset + i] != 0xFF) {
+            programErrors++;
+            return CONFIG_RESULT_FAILURE;
+        }
+    }
+
+    memcpy(&eepromData[offset], buffer, sizeof(*buffer));
+    programmedBytes += sizeof(*buffer);
+
+    return CONFIG_RESULT_SUCCESS;
+}
+
+}
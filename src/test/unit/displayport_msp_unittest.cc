@@ -0,0 +1,301 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "drivers/display.h"
+    #include "drivers/osd.h"
+
+    #include "io/displayport_msp.h"
+
+    #include "msp/msp.h"
+    #include "msp/msp_protocol.h"
+    #include "msp/msp_serial.h"
+
+    #include "osd/osd.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+    #include "pg/vcd.h"
+
+    PG_REGISTER(osdConfig_t, osdConfig, PG_OSD_CONFIG, 0);
+
+    int mspDpEncodeSpan(uint8_t *buf, const uint16_t *cells, int count);
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define MAX_PUSHED 8
+
+static uint8_t pushed[MAX_PUSHED][256];
+static int pushedCount;
+static uint32_t txBytesFree = 256;
+
+static void resetPushed(void)
+{
+    pushedCount = 0;
+}
+
+static displayPort_t *initDisplayPort(uint8_t capabilities)
+{
+    pgResetAll();
+    vcdProfileMutable()->video_system = VIDEO_SYSTEM_HD;
+    osdConfigMutable()->canvas_cols = OSD_HD_COLS;
+    osdConfigMutable()->canvas_rows = OSD_HD_ROWS;
+
+    displayPortMspSetCapabilities(capabilities);
+    displayPort_t *displayPort = displayPortMspInit();
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayDrawScreen(displayPort);
+    resetPushed();
+
+    return displayPort;
+}
+
+TEST(DisplayPortMspUnittest, EncodeLiteral)
+{
+    const uint16_t cells[] = { 'A', 'B', 'C' };
+    uint8_t buf[16];
+
+    const int len = mspDpEncodeSpan(buf, cells, 3);
+
+    const uint8_t expected[] = { 3, 'A', 'B', 'C', 0 };
+    ASSERT_EQ((int)sizeof(expected), len);
+    EXPECT_EQ(0, memcmp(expected, buf, len));
+}
+
+TEST(DisplayPortMspUnittest, EncodeRepeat)
+{
+    const uint16_t cells[] = { 'A', ' ', ' ', ' ', ' ', ' ', 'B', 'B' };
+    uint8_t buf[16];
+
+    const int len = mspDpEncodeSpan(buf, cells, 8);
+
+    // Runs shorter than three are cheaper as literals
+    const uint8_t expected[] = { 1, 'A', 0x80 | 5, ' ', 2, 'B', 'B', 0 };
+    ASSERT_EQ((int)sizeof(expected), len);
+    EXPECT_EQ(0, memcmp(expected, buf, len));
+}
+
+static void drawFrame(displayPort_t *displayPort, const char *text)
+{
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    if (text) {
+        displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, text);
+    }
+    displayCommitTransaction(displayPort);
+    while (displayDrawScreen(displayPort));
+}
+
+TEST(DisplayPortMspUnittest, LegacyBufferedSendsChangedStrings)
+{
+    displayPort_t *displayPort = initDisplayPort(0);
+    ASSERT_TRUE(displayIsBuffered(displayPort));
+
+    // Push the periodic row refresh past the rows used below
+    for (int i = 0; i < 4; i++) {
+        drawFrame(displayPort, NULL);
+    }
+    resetPushed();
+
+    // Nothing is sent until the frame is committed
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "12.6V");
+    EXPECT_FALSE(displayDrawScreen(displayPort));
+    EXPECT_EQ(0, pushedCount);
+
+    displayCommitTransaction(displayPort);
+    while (displayDrawScreen(displayPort));
+
+    // No clear is sent, the new string and the two halves of the refresh row are followed by a draw
+    ASSERT_EQ(4, pushedCount);
+    const uint8_t string[] = { MSP_DP_WRITE_STRING, 1, 2, 0, '1', '2', '.', '6', 'V' };
+    EXPECT_EQ(0, memcmp(string, pushed[0], sizeof(string)));
+    EXPECT_EQ(MSP_DP_WRITE_STRING, pushed[1][0]);
+    EXPECT_EQ(MSP_DP_WRITE_STRING, pushed[2][0]);
+    EXPECT_EQ(MSP_DP_DRAW_SCREEN, pushed[3][0]);
+
+    // Only the changed character of an updated string is sent
+    resetPushed();
+    drawFrame(displayPort, "12.5V");
+
+    ASSERT_EQ(4, pushedCount);
+    const uint8_t changed[] = { MSP_DP_WRITE_STRING, 1, 5, 0, '5' };
+    EXPECT_EQ(0, memcmp(changed, pushed[0], sizeof(changed)));
+}
+
+TEST(DisplayPortMspUnittest, LegacyBufferedWaitsForTxSpace)
+{
+    displayPort_t *displayPort = initDisplayPort(0);
+
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "12.6V");
+    displayCommitTransaction(displayPort);
+
+    txBytesFree = 8;
+    EXPECT_TRUE(displayDrawScreen(displayPort));
+    EXPECT_TRUE(displayIsDrawPending(displayPort));
+    EXPECT_EQ(0, pushedCount);
+
+    // The OSD task isn't run again until the run it waits for, 30 cells of the refresh row, fits
+    EXPECT_FALSE(displayIsDrawReady(displayPort));
+    txBytesFree = 45;
+    EXPECT_FALSE(displayIsDrawReady(displayPort));
+    txBytesFree = 46;
+    EXPECT_TRUE(displayIsDrawReady(displayPort));
+    txBytesFree = 8;
+
+    // A frame committed while the previous one is being sent is merged into it
+    displayWrite(displayPort, 2, 5, DISPLAYPORT_SEVERITY_NORMAL, "MERGED");
+    displayCommitTransaction(displayPort);
+
+    txBytesFree = 256;
+    while (displayDrawScreen(displayPort));
+    EXPECT_FALSE(displayIsDrawPending(displayPort));
+    EXPECT_FALSE(displayIsDrawReady(displayPort));
+    ASSERT_LT(0, pushedCount);
+    EXPECT_EQ(MSP_DP_DRAW_SCREEN, pushed[pushedCount - 1][0]);
+    bool merged = false;
+    for (int i = 0; i < pushedCount; i++) {
+        merged |= pushed[i][0] == MSP_DP_WRITE_STRING && pushed[i][1] == 5 && pushed[i][2] == 2;
+    }
+    EXPECT_TRUE(merged);
+}
+
+TEST(DisplayPortMspUnittest, LegacyBufferedMergesBehindDrainOnNextPass)
+{
+    displayPort_t *displayPort = initDisplayPort(0);
+    for (int i = 0; i < 4; i++) {
+        drawFrame(displayPort, NULL);
+    }
+
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "A");
+    displayWrite(displayPort, 2, 10, DISPLAYPORT_SEVERITY_NORMAL, "B");
+    displayCommitTransaction(displayPort);
+
+    // Room for the first string only
+    txBytesFree = 20;
+    resetPushed();
+    EXPECT_TRUE(displayDrawScreen(displayPort));
+    ASSERT_EQ(1, pushedCount);
+    txBytesFree = 8;
+    EXPECT_TRUE(displayDrawScreen(displayPort));
+    EXPECT_EQ(1, pushedCount);
+
+    // The next frame changes a row already sent and one still to come
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "C");
+    displayWrite(displayPort, 2, 10, DISPLAYPORT_SEVERITY_NORMAL, "D");
+    displayCommitTransaction(displayPort);
+
+    // This pass sends the newer row 10 and draws, row 1 follows on the next pass
+    txBytesFree = 256;
+    resetPushed();
+    EXPECT_TRUE(displayDrawScreen(displayPort));
+    int draws = 0;
+    for (int i = 0; i < pushedCount; i++) {
+        if (pushed[i][0] == MSP_DP_WRITE_STRING && pushed[i][1] == 10) {
+            EXPECT_EQ('D', pushed[i][4]);
+        }
+        EXPECT_FALSE(pushed[i][0] == MSP_DP_WRITE_STRING && pushed[i][1] == 1);
+        draws += pushed[i][0] == MSP_DP_DRAW_SCREEN;
+    }
+    EXPECT_EQ(1, draws);
+
+    resetPushed();
+    EXPECT_FALSE(displayDrawScreen(displayPort));
+    const uint8_t row1[] = { MSP_DP_WRITE_STRING, 1, 2, 0, 'C' };
+    ASSERT_LT(0, pushedCount);
+    EXPECT_EQ(0, memcmp(row1, pushed[0], sizeof(row1)));
+    EXPECT_EQ(MSP_DP_DRAW_SCREEN, pushed[pushedCount - 1][0]);
+}
+
+TEST(DisplayPortMspUnittest, DeltaSendsOnlyChangedCells)
+{
+    displayPort_t *displayPort = initDisplayPort(DISPLAYPORT_MSP_CAP_WRITE_RUNS);
+
+    // Push the periodic row refresh past the rows used below
+    for (int i = 0; i < 4; i++) {
+        displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+        displayDrawScreen(displayPort);
+    }
+    resetPushed();
+
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "12.6V");
+    displayDrawScreen(displayPort);
+
+    // No clear is sent, the new span and the periodic refresh row share a frame
+    ASSERT_EQ(2, pushedCount);
+    EXPECT_EQ(MSP_DP_WRITE_RUNS, pushed[0][0]);
+    const uint8_t span[] = { 1, 2, 0, 5, '1', '2', '.', '6', 'V', 0 };
+    EXPECT_EQ(0, memcmp(span, &pushed[0][1], sizeof(span)));
+    EXPECT_EQ(MSP_DP_DRAW_SCREEN, pushed[1][0]);
+
+    // Only the changed cell of an updated string is sent
+    resetPushed();
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayWrite(displayPort, 2, 1, DISPLAYPORT_SEVERITY_NORMAL, "12.5V");
+    displayDrawScreen(displayPort);
+
+    ASSERT_EQ(2, pushedCount);
+    const uint8_t changed[] = { 1, 5, 0, 1, '5', 0 };
+    EXPECT_EQ(0, memcmp(changed, &pushed[0][1], sizeof(changed)));
+
+    // Removing the string blanks its cells with a single run
+    resetPushed();
+    displayClearScreen(displayPort, DISPLAY_CLEAR_WAIT);
+    displayDrawScreen(displayPort);
+
+    ASSERT_EQ(2, pushedCount);
+    const uint8_t blanked[] = { 1, 2, 0, 0x80 | 5, ' ', 0 };
+    EXPECT_EQ(0, memcmp(blanked, &pushed[0][1], sizeof(blanked)));
+}
+
+// STUBS
+
+extern "C" {
+
+int mspSerialPush(serialPortIdentifier_e, uint8_t cmd, uint8_t *data, int datalen, mspDirection_e, mspVersion_e)
+{
+    EXPECT_EQ(MSP_DISPLAYPORT, cmd);
+
+    if (pushedCount < MAX_PUSHED) {
+        memcpy(pushed[pushedCount], data, datalen);
+        pushedCount++;
+    }
+
+    return datalen + 6;
+}
+
+uint32_t mspSerialTxBytesFree(void)
+{
+    return txBytesFree;
+}
+
+}
@@ -0,0 +1,224 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "drivers/dshot.h"
+    #include "drivers/dshot_bitbang_decode.h"
+    #include "drivers/time.h"
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define PORT_SAMPLES    140     // DSHOT_BB_PORT_IP_BUF_LENGTH
+#define FRAME_BITS      21
+
+static const uint8_t gcrEncode[16] = {
+    0x19, 0x1b, 0x12, 0x13, 0x1d, 0x15, 0x16, 0x17, 0x1a, 0x09, 0x0a, 0x0b, 0x1e, 0x0d, 0x0e, 0x0f
+};
+
+// The 21 bits of the telemetry frame of a 12 bit value, a 1 is a level change
+static uint32_t telemetryFrame(uint16_t value)
+{
+    const uint16_t checksum = 0xf ^ (value & 0xf) ^ ((value >> 4) & 0xf) ^ ((value >> 8) & 0xf);
+    const uint16_t data = (value << 4) | checksum;
+    uint32_t gcr = 0;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        gcr = (gcr << 5) | gcrEncode[(data >> shift) & 0xf];
+    }
+    return (1 << 20) | gcr;
+}
+
+typedef struct pinFrame_s {
+    unsigned pin;
+    uint16_t value;
+    float start;        // sample of the start bit
+    float samplesPerBit;
+} pinFrame_t;
+
+// Samples the line of each pin 3 times per bit, as the bitbang input DMA does
+static std::vector<uint16_t> portSamples(const std::vector<pinFrame_t> &frames, uint16_t otherPins = 0)
+{
+    std::vector<uint16_t> samples(PORT_SAMPLES, otherPins);
+    for (const pinFrame_t &frame : frames) {
+        const uint32_t bits = telemetryFrame(frame.value);
+        for (int i = 0; i < PORT_SAMPLES; i++) {
+            const float t = (i - frame.start) / frame.samplesPerBit;
+            bool high = true;
+            if (t >= 0 && t < FRAME_BITS) {
+                for (int bit = 0; bit <= (int)t; bit++) {
+                    if (bits & (1 << (FRAME_BITS - 1 - bit))) {
+                        high = !high;
+                    }
+                }
+            }
+            if (high) {
+                samples[i] |= 1 << frame.pin;
+            } else {
+                samples[i] &= ~(1 << frame.pin);
+            }
+        }
+    }
+    return samples;
+}
+
+static float randomFloat(float min, float max)
+{
+    return min + (max - min) * rand() / (float)RAND_MAX;
+}
+
+static pinFrame_t randomFrame(unsigned pin)
+{
+    // the ESCs answer at slightly different times and clocks
+    return { pin, (uint16_t)(rand() & 0xfff), randomFloat(20, 30), 3 * randomFloat(0.97f, 1.03f) };
+}
+
+static uint16_t pinMaskOf(const std::vector<pinFrame_t> &frames)
+{
+    uint16_t pinMask = 0;
+    for (const pinFrame_t &frame : frames) {
+        pinMask |= 1 << frame.pin;
+    }
+    return pinMask;
+}
+
+TEST(DshotBitbangDecodeTest, DecodesSinglePin)
+{
+    std::vector<pinFrame_t> frames = { { 3, 0x123, 24, 3 } };
+    std::vector<uint16_t> samples = portSamples(frames);
+
+    EXPECT_EQ(0x123u, decode_bb(samples.data(), PORT_SAMPLES, 3));
+
+    uint32_t values[DSHOT_BB_PORT_PIN_COUNT];
+    decode_bb_port(samples.data(), PORT_SAMPLES, 1 << 3, values);
+    EXPECT_EQ(0x123u, values[3]);
+}
+
+TEST(DshotBitbangDecodeTest, DecodesAllPinsOfPortInOnePass)
+{
+    std::vector<pinFrame_t> frames;
+    for (unsigned pin : { 0, 1, 4, 6, 7, 9, 12, 15 }) {
+        frames.push_back(randomFrame(pin));
+    }
+    // pins of the port that are not motors are ignored
+    std::vector<uint16_t> samples = portSamples(frames, 0x0104);
+
+    uint32_t values[DSHOT_BB_PORT_PIN_COUNT];
+    decode_bb_port(samples.data(), PORT_SAMPLES, pinMaskOf(frames), values);
+    for (const pinFrame_t &frame : frames) {
+        EXPECT_EQ(frame.value, values[frame.pin]) << "pin " << frame.pin;
+    }
+}
+
+TEST(DshotBitbangDecodeTest, ReportsPinsWithoutTelemetry)
+{
+    std::vector<pinFrame_t> frames = { randomFrame(2), randomFrame(5) };
+    std::vector<uint16_t> samples = portSamples(frames);
+
+    // pin 8 stays high, pin 10 answers too late for a whole frame
+    const uint16_t pinMask = pinMaskOf(frames) | (1 << 8) | (1 << 10);
+    for (int i = 0; i < PORT_SAMPLES; i++) {
+        samples[i] |= 1 << 8;
+        if (i < PORT_SAMPLES - 40) {
+            samples[i] |= 1 << 10;
+        }
+    }
+
+    uint32_t values[DSHOT_BB_PORT_PIN_COUNT];
+    decode_bb_port(samples.data(), PORT_SAMPLES, pinMask, values);
+    EXPECT_EQ(frames[0].value, values[2]);
+    EXPECT_EQ(frames[1].value, values[5]);
+    EXPECT_EQ(DSHOT_TELEMETRY_NOEDGE, values[8]);
+    EXPECT_EQ(DSHOT_TELEMETRY_NOEDGE, values[10]);
+}
+
+TEST(DshotBitbangDecodeTest, RejectsCorruptFrame)
+{
+    std::vector<pinFrame_t> frames = { { 0, 0x456, 22, 3 }, { 1, 0x456, 22, 3 } };
+    std::vector<uint16_t> samples = portSamples(frames);
+    // a glitch in the middle of the frame of pin 1
+    for (int i = 50; i < 53; i++) {
+        samples[i] ^= 1 << 1;
+    }
+
+    uint32_t values[DSHOT_BB_PORT_PIN_COUNT];
+    decode_bb_port(samples.data(), PORT_SAMPLES, 0x0003, values);
+    EXPECT_EQ(0x456u, values[0]);
+    EXPECT_NE(0x456u, values[1]);
+    EXPECT_EQ(decode_bb(samples.data(), PORT_SAMPLES, 1), values[1]);
+}
+
+TEST(DshotBitbangDecodeTest, MatchesPerPinDecoder)
+{
+    srand(1);
+    for (int run = 0; run < 2000; run++) {
+        std::vector<pinFrame_t> frames;
+        for (unsigned pin = 0; pin < DSHOT_BB_PORT_PIN_COUNT; pin++) {
+            if (rand() % 3 == 0) {
+                frames.push_back(randomFrame(pin));
+            }
+        }
+        std::vector<uint16_t> samples = portSamples(frames);
+        // noise on the lines after the frames started
+        const int glitches = rand() % 4;
+        for (int i = 0; i < glitches; i++) {
+            samples[30 + rand() % (PORT_SAMPLES - 30)] ^= 1 << (rand() % DSHOT_BB_PORT_PIN_COUNT);
+        }
+
+        const uint16_t pinMask = pinMaskOf(frames);
+        uint32_t expected[DSHOT_BB_PORT_PIN_COUNT];
+        for (const pinFrame_t &frame : frames) {
+            expected[frame.pin] = decode_bb(samples.data(), PORT_SAMPLES, frame.pin);
+            if (glitches == 0) {
+                EXPECT_EQ(frame.value, expected[frame.pin]);
+            }
+        }
+
+        uint32_t values[DSHOT_BB_PORT_PIN_COUNT];
+        decode_bb_port(samples.data(), PORT_SAMPLES, pinMask, values);
+        for (const pinFrame_t &frame : frames) {
+            ASSERT_EQ(expected[frame.pin], values[frame.pin]) << "run " << run << " pin " << frame.pin;
+        }
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+timeUs_t micros(void)
+{
+    return 0;
+}
+
+}
@@ -0,0 +1,216 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "io/gps.h"
+    #include "io/gps_fix.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static const gpsLocation_t equator = { .lat = 0, .lon = 0, .altCm = 0 };
+
+static void fixAt(uint32_t timeMs, timeUs_t arrivalUs)
+{
+    gpsFixUpdate(&equator, 0.0f, 0.0f, true, timeMs, arrivalUs, 0);
+}
+
+TEST(GpsFixTest, FirstFixSetsClock)
+{
+    gpsFixInit();
+
+    fixAt(1000, 5000000);
+
+    EXPECT_EQ(5000000, gpsFixTimeUs());
+    EXPECT_EQ(0, gpsFixGetStats()->transportDelayUs);
+    EXPECT_EQ(1, gpsFixGetStats()->fixCount);
+}
+
+TEST(GpsFixTest, LateFixFollowsClock)
+{
+    gpsFixInit();
+    fixAt(1000, 5000000);
+
+    // 100ms of GPS time later, arriving 6.4ms later than the first fix did
+    fixAt(1100, 5106400);
+
+    // the fix is stamped on the mapping, which creeps 1/64 of the delay towards it
+    EXPECT_EQ(5100000 + 100, gpsFixTimeUs());
+    EXPECT_EQ(6400, gpsFixGetStats()->transportDelayUs);
+}
+
+TEST(GpsFixTest, FasterFixResetsClock)
+{
+    gpsFixInit();
+    fixAt(1000, 5010000);
+
+    // arrives 5ms quicker after its GPS time than the first fix
+    fixAt(1100, 5105000);
+
+    EXPECT_EQ(5105000, gpsFixTimeUs());
+    EXPECT_EQ(0, gpsFixGetStats()->transportDelayUs);
+
+    // and sets the mapping for the following fixes
+    fixAt(1200, 5207000);
+    EXPECT_EQ(5205000 + (2000 >> 6), gpsFixTimeUs());
+    EXPECT_EQ(2000, gpsFixGetStats()->transportDelayUs);
+}
+
+TEST(GpsFixTest, TimeJumpResetsClock)
+{
+    gpsFixInit();
+    fixAt(1000, 5000000);
+
+    // GPS time jumped back, so the fix would be far too late
+    fixAt(500, 5100000);
+
+    EXPECT_EQ(5100000, gpsFixTimeUs());
+    EXPECT_EQ(0, gpsFixGetStats()->transportDelayUs);
+}
+
+TEST(GpsFixTest, ClockFollowsWeekRollover)
+{
+    const uint32_t weekMs = 7 * 24 * 3600 * 1000;
+    gpsFixInit();
+    fixAt(weekMs - 50, 5000000);
+
+    fixAt(50, 5100000);
+
+    EXPECT_EQ(5100000, gpsFixTimeUs());
+    EXPECT_EQ(0, gpsFixGetStats()->transportDelayUs);
+}
+
+TEST(GpsFixTest, FixWithoutTimeUsesArrival)
+{
+    gpsFixInit();
+    fixAt(1000, 5000000);
+
+    gpsFixUpdate(&equator, 0.0f, 0.0f, false, 0, 5123000, 0);
+
+    EXPECT_EQ(5123000, gpsFixTimeUs());
+}
+
+TEST(GpsFixTest, NoPredictionWithoutFix)
+{
+    gpsFixInit();
+
+    gpsLocation_t llh;
+    EXPECT_FALSE(gpsFixPredict(&llh, 1000000));
+}
+
+TEST(GpsFixTest, PredictNorth)
+{
+    gpsFixInit();
+    const gpsLocation_t fix = { .lat = 100000000, .lon = 200000000, .altCm = 1000 };
+    gpsFixUpdate(&fix, 500.0f, 0.0f, false, 0, 1000000, 0);
+
+    gpsLocation_t llh;
+    EXPECT_TRUE(gpsFixPredict(&llh, 1000000));
+    EXPECT_EQ(fix.lat, llh.lat);
+    EXPECT_EQ(fix.lon, llh.lon);
+
+    // 200ms at 5m/s is 1m to the north
+    EXPECT_TRUE(gpsFixPredict(&llh, 1200000));
+    EXPECT_EQ(lrintf(100.0f / EARTH_ANGLE_TO_CM), llh.lat - fix.lat);
+    EXPECT_EQ(fix.lon, llh.lon);
+    EXPECT_EQ(fix.altCm, llh.altCm);
+}
+
+TEST(GpsFixTest, PredictEastScalesWithLatitude)
+{
+    gpsFixInit();
+    // at 60 degrees a unit of longitude is half as long as at the equator
+    const gpsLocation_t fix = { .lat = 600000000, .lon = 0, .altCm = 0 };
+    gpsFixUpdate(&fix, 0.0f, -1000.0f, false, 0, 1000000, 0);
+
+    gpsLocation_t llh;
+    EXPECT_TRUE(gpsFixPredict(&llh, 1100000));
+    EXPECT_EQ(fix.lat, llh.lat);
+    EXPECT_NEAR(-2 * 100.0f / EARTH_ANGLE_TO_CM, llh.lon, 2);
+}
+
+TEST(GpsFixTest, PredictionIsLimited)
+{
+    gpsFixInit();
+    gpsFixUpdate(&equator, 1000.0f, 0.0f, false, 0, 1000000, 0);
+
+    gpsLocation_t llh;
+    gpsFixPredict(&llh, 1000000 + GPS_FIX_PREDICT_MAX_US);
+    const int32_t maxLat = llh.lat;
+
+    gpsFixPredict(&llh, 1000000 + 5 * GPS_FIX_PREDICT_MAX_US);
+    EXPECT_EQ(maxLat, llh.lat);
+
+    // never predicts backwards
+    gpsFixPredict(&llh, 900000);
+    EXPECT_EQ(0, llh.lat);
+}
+
+TEST(GpsFixTest, PredictionStartsAtFixTime)
+{
+    gpsFixInit();
+    fixAt(1000, 5000000);
+    const gpsLocation_t fix = { .lat = 0, .lon = 0, .altCm = 0 };
+    // arrives 50ms after the mapping expects it, so it is already 50ms old
+    gpsFixUpdate(&fix, 1000.0f, 0.0f, true, 1100, 5150000, 0);
+
+    gpsLocation_t llh;
+    gpsFixPredict(&llh, 5150000);
+    EXPECT_NEAR((1000.0f * (0.05f - 0.05f / 64)) / EARTH_ANGLE_TO_CM, llh.lat, 1);
+}
+
+TEST(GpsFixTest, FixToUseRecordedOnce)
+{
+    gpsFixInit();
+
+    // no fix yet
+    gpsFixUsed(1000);
+    EXPECT_EQ(0, gpsFixGetStats()->fixToUseUs);
+
+    gpsFixUpdate(&equator, 0.0f, 0.0f, false, 0, 1000000, 0);
+    gpsFixUsed(1003000);
+    gpsFixUsed(1010000);
+    EXPECT_EQ(3000, gpsFixGetStats()->fixToUseUs);
+
+    gpsFixUpdate(&equator, 0.0f, 0.0f, false, 0, 1100000, 0);
+    gpsFixUsed(1101000);
+    EXPECT_EQ(1000, gpsFixGetStats()->fixToUseUs);
+    EXPECT_EQ(3000, gpsFixGetStats()->fixToUseMaxUs);
+}
+
+TEST(GpsFixTest, ParseTimeStats)
+{
+    gpsFixInit();
+
+    gpsFixUpdate(&equator, 0.0f, 0.0f, false, 0, 1000000, 40);
+    gpsFixUpdate(&equator, 0.0f, 0.0f, false, 0, 1100000, 25);
+
+    EXPECT_EQ(25, gpsFixGetStats()->parseTimeUs);
+    EXPECT_EQ(40, gpsFixGetStats()->parseTimeMaxUs);
+    EXPECT_EQ(2, gpsFixGetStats()->fixCount);
+}
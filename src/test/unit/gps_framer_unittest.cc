@@ -0,0 +1,261 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "io/gps_framer.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static std::vector<uint8_t> received;
+static int handlerCalls;
+
+static void handler(const uint8_t *data, uint32_t count)
+{
+    received.insert(received.end(), data, data + count);
+    handlerCalls++;
+}
+
+static bool nextFrame(void)
+{
+    received.clear();
+    handlerCalls = 0;
+    return gpsFramerProcessFrame(handler);
+}
+
+static bool acceptAll(gpsFrameType_e type, const uint8_t *id)
+{
+    UNUSED(type);
+    UNUSED(id);
+    return true;
+}
+
+// keeps UBX NAV messages and NMEA GGA sentences
+static bool navOnly(gpsFrameType_e type, const uint8_t *id)
+{
+    if (type == GPS_FRAME_UBX) {
+        return id[0] == 0x01;
+    }
+    return memcmp(&id[2], "GGA", 3) == 0;
+}
+
+static std::vector<uint8_t> ubxFrame(uint8_t cls, uint8_t id, uint16_t length)
+{
+    std::vector<uint8_t> frame = { 0xB5, 0x62, cls, id, (uint8_t)(length & 0xff), (uint8_t)(length >> 8) };
+    for (int i = 0; i < length; i++) {
+        frame.push_back(i);
+    }
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        a += frame[i];
+        b += a;
+    }
+    frame.push_back(a);
+    frame.push_back(b);
+    return frame;
+}
+
+static const char gga[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char gsv[] = "$GPGSV,1,1,00*79\r\n";
+static const char vtg[] = "$GPVTG,,T,,M,0.00,N,0.00,K,N*2C\r\n";
+
+static std::vector<uint8_t> nmeaFrame(const char *sentence)
+{
+    return std::vector<uint8_t>(sentence, sentence + strlen(sentence));
+}
+
+static void receive(const std::vector<uint8_t> &bytes)
+{
+    for (uint8_t c : bytes) {
+        gpsFramerReceive(c);
+    }
+}
+
+TEST(GpsFramerTest, QueuesCompleteUbxFrame)
+{
+    gpsFramerInit(acceptAll);
+    const std::vector<uint8_t> pvt = ubxFrame(0x01, 0x07, 92);
+
+    // nothing is visible until the last byte of the checksum
+    for (size_t i = 0; i < pvt.size() - 1; i++) {
+        gpsFramerReceive(pvt[i]);
+    }
+    EXPECT_FALSE(gpsFramerFrameWaiting());
+    gpsFramerReceive(pvt.back());
+    EXPECT_TRUE(gpsFramerFrameWaiting());
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(pvt, received);
+    EXPECT_FALSE(gpsFramerFrameWaiting());
+    EXPECT_FALSE(nextFrame());
+    EXPECT_EQ(1, gpsFramerGetStats()->frames);
+}
+
+TEST(GpsFramerTest, QueuesNmeaSentenceAndSkipsNoise)
+{
+    gpsFramerInit(acceptAll);
+
+    receive({ 0x00, 'x', 0x62, 0xB5, '\n' });
+    receive(nmeaFrame(gga));
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(nmeaFrame(gga), received);
+    EXPECT_FALSE(nextFrame());
+}
+
+TEST(GpsFramerTest, RejectsBadChecksums)
+{
+    gpsFramerInit(acceptAll);
+
+    std::vector<uint8_t> ubx = ubxFrame(0x01, 0x07, 20);
+    ubx[10] ^= 0x01;
+    receive(ubx);
+    std::vector<uint8_t> nmea = nmeaFrame(gga);
+    nmea[20] = '9';
+    receive(nmea);
+
+    EXPECT_FALSE(gpsFramerFrameWaiting());
+    EXPECT_EQ(2, gpsFramerGetStats()->errors);
+
+    // and the framer is back in step for the next frames
+    receive(ubxFrame(0x01, 0x07, 20));
+    receive(nmeaFrame(gsv));
+    EXPECT_TRUE(nextFrame());
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(nmeaFrame(gsv), received);
+}
+
+TEST(GpsFramerTest, ResynchronisesOnCutShortSentence)
+{
+    gpsFramerInit(acceptAll);
+
+    // a sentence cut short by the start of the next one, then by a UBX message
+    receive(nmeaFrame("$GPGGA,1235"));
+    receive(nmeaFrame("$GPGGA,1235"));
+    const std::vector<uint8_t> ubx = ubxFrame(0x05, 0x01, 2);
+    receive(ubx);
+    receive(nmeaFrame(gga));
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(ubx, received);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(nmeaFrame(gga), received);
+    EXPECT_EQ(2, gpsFramerGetStats()->errors);
+}
+
+TEST(GpsFramerTest, FilterDiscardsBeforeQueueing)
+{
+    gpsFramerInit(navOnly);
+
+    receive(ubxFrame(0x0a, 0x04, 160));     // MON-VER
+    receive(nmeaFrame(vtg));
+    receive(nmeaFrame(gsv));
+    const std::vector<uint8_t> posllh = ubxFrame(0x01, 0x02, 28);
+    receive(posllh);
+    receive(nmeaFrame(gga));
+
+    EXPECT_EQ(3, gpsFramerGetStats()->discarded);
+    EXPECT_EQ(2, gpsFramerGetStats()->frames);
+    EXPECT_EQ(0, gpsFramerGetStats()->errors);
+    // the discarded frames took no room in the queue
+    EXPECT_EQ(posllh.size() + strlen(gga) + 4, gpsFramerGetStats()->queueMax);
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(posllh, received);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(nmeaFrame(gga), received);
+}
+
+TEST(GpsFramerTest, RejectsOversizedFrames)
+{
+    gpsFramerInit(acceptAll);
+
+    receive({ 0xB5, 0x62, 0x01, 0x35, 0xff, 0xff });
+    std::string longSentence = "$GPGGA,";
+    longSentence.append(GPS_FRAMER_NMEA_LENGTH_MAX, '0');
+    receive(nmeaFrame(longSentence.c_str()));
+
+    EXPECT_EQ(2, gpsFramerGetStats()->errors);
+    EXPECT_FALSE(gpsFramerFrameWaiting());
+
+    receive(nmeaFrame(gga));
+    EXPECT_TRUE(nextFrame());
+}
+
+TEST(GpsFramerTest, DropsFramesWhenQueueIsFull)
+{
+    gpsFramerInit(acceptAll);
+
+    // the largest sat info message fills most of the queue
+    const std::vector<uint8_t> sat = ubxFrame(0x01, 0x35, GPS_FRAMER_UBX_PAYLOAD_MAX);
+    receive(sat);
+    const std::vector<uint8_t> pvt = ubxFrame(0x01, 0x07, 92);
+    receive(pvt);
+    receive(pvt);
+    receive(pvt);
+
+    EXPECT_EQ(3, gpsFramerGetStats()->frames);
+    EXPECT_EQ(1, gpsFramerGetStats()->dropped);
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(sat, received);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(pvt, received);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_FALSE(nextFrame());
+
+    // room again once the task caught up
+    receive(pvt);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(pvt, received);
+}
+
+TEST(GpsFramerTest, FrameWrapsAroundQueue)
+{
+    gpsFramerInit(acceptAll);
+
+    const std::vector<uint8_t> pvt = ubxFrame(0x01, 0x07, 92);
+    // a 100 byte frame and its length take 102 bytes, so the eleventh starts 1020 bytes in
+    for (int i = 0; i < 10; i++) {
+        receive(pvt);
+        EXPECT_TRUE(nextFrame());
+        EXPECT_EQ(1, handlerCalls);
+    }
+    receive(pvt);
+    receive(pvt);
+
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(2, handlerCalls);
+    EXPECT_EQ(pvt, received);
+    EXPECT_TRUE(nextFrame());
+    EXPECT_EQ(1, handlerCalls);
+    EXPECT_EQ(pvt, received);
+    EXPECT_EQ(0, gpsFramerGetStats()->dropped);
+}
@@ -68,6 +68,7 @@ extern "C" {
     uint32_t serialRxBytesWaiting(const serialPort_t *) { return 0; }
     uint8_t serialRead(serialPort_t *) { return 0; }
     void serialWrite(serialPort_t *, uint8_t) {}
+    void serialResetStats(serialPort_t *) {}
 
     serialPort_t *usbVcpOpen(void) { return NULL; }
 
@@ -24,6 +24,7 @@
 extern "C" {
     #include "platform.h"
     #include "build/build_config.h"
+    #include "build/debug.h"
 
     #include "common/axis.h"
     #include "common/color.h"
@@ -67,6 +68,8 @@ extern "C" {
     extern uint8_t ledGridRows;
 
     extern ledCounts_t ledCounts;
+    extern ledMask_t overlayLeds[LED_OVERLAY_COUNT];
+    extern ledMask_t functionLeds[LED_BASEFUNCTION_COUNT];
 
     void reevaluateLedConfig();
 
@@ -220,6 +223,14 @@ TEST(LedStripTest, smallestGridWithCenter)
     EXPECT_EQ(2, lowestXValueForEast);
     EXPECT_EQ(0, highestYValueForNorth);
     EXPECT_EQ(2, lowestYValueForSouth);
+
+    // and the layers only visit the LEDs using them
+    EXPECT_EQ((ledMask_t)0x55, overlayLeds[LED_OVERLAY_INDICATOR]);
+    EXPECT_EQ((ledMask_t)0x2a, overlayLeds[LED_OVERLAY_WARNING]);
+    EXPECT_EQ((ledMask_t)0, overlayLeds[LED_OVERLAY_RAINBOW]);
+    EXPECT_EQ((ledMask_t)0x55, functionLeds[LED_FUNCTION_ARM_STATE]);
+    EXPECT_EQ((ledMask_t)0x2a, functionLeds[LED_FUNCTION_FLIGHT_MODE]);
+    EXPECT_EQ((ledMask_t)0, functionLeds[LED_FUNCTION_BATTERY]);
 }
 
 TEST(LedStripTest, smallestGrid)
@@ -408,6 +419,8 @@ bool isCrashFlipModeActive(void) { return false; }
 void ws2811LedStripEnable(void) { }
 
 void setUsedLedCount(unsigned) { }
+uint8_t debugMode;
+int16_t debug[DEBUG16_VALUE_COUNT];
 void pinioBoxTaskControl(void) {}
 void rescheduleTask(taskId_e, timeDelta_t){}
 void schedulerIgnoreTaskExecTime(void) {}
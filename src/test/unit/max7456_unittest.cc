@@ -0,0 +1,146 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "drivers/bus_spi.h"
+    #include "drivers/io.h"
+    #include "drivers/max7456.h"
+    #include "drivers/osd.h"
+    #include "drivers/time.h"
+
+    #include "pg/max7456.h"
+    #include "pg/vcd.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// MAX7456 registers, as in max7456.c
+#define DMM     0x04
+#define DMAH    0x05
+#define DMAL    0x06
+#define DMDI    0x07
+#define AUTO_INC 0x01
+#define END_STRING 0xff
+
+static std::vector<uint8_t> spiBytes;      // bytes of the spiSequence() calls
+
+static void initDevice(void)
+{
+    const max7456Config_t config = { .clockConfig = MAX7456_CLOCK_CONFIG_NOMINAL, .csTag = 1, .spiDevice = 0, .preInitOPU = false };
+    const vcdProfile_t vcd = { .video_system = VIDEO_SYSTEM_PAL, .h_offset = 0, .v_offset = 0 };
+    ASSERT_EQ(MAX7456_INIT_OK, max7456Init(&config, &vcd, false));
+
+    // the first draws send the whole screen
+    for (int i = 0; i < 100 && !max7456BuffersSynced(); i++) {
+        max7456DrawScreen();
+    }
+    ASSERT_TRUE(max7456BuffersSynced());
+    spiBytes.clear();
+}
+
+TEST(Max7456Test, EachBurstSetsAutoIncrement)
+{
+    initDevice();
+
+    // two runs and a single cell, sent in one pass
+    max7456Write(0, 1, "ABC");
+    max7456Write(0, 5, "XYZ");
+    max7456WriteChar(20, 6, 'Q');
+    max7456DrawScreen();
+
+    // END_STRING ends auto-increment mode, so the second burst enables it again and the
+    // single cell that follows is written without it
+    const std::vector<uint8_t> expected = {
+        DMM, AUTO_INC, DMAH, 0, DMAL, 30, DMDI, 'A', DMDI, 'B', DMDI, 'C', DMDI, END_STRING,
+        DMM, AUTO_INC, DMAH, 0, DMAL, 150, DMDI, 'X', DMDI, 'Y', DMDI, 'Z', DMDI, END_STRING,
+        DMAH, 0, DMAL, 200, DMDI, 'Q',
+    };
+    EXPECT_EQ(expected, spiBytes);
+    EXPECT_TRUE(max7456BuffersSynced());
+}
+
+TEST(Max7456Test, SingleCellsAfterBurst)
+{
+    initDevice();
+
+    max7456WriteChar(10, 0, 'P');
+    max7456Write(0, 2, "LONG");
+    max7456DrawScreen();
+
+    // a single cell never switches auto-increment on, the burst after it does
+    const std::vector<uint8_t> expected = {
+        DMAH, 0, DMAL, 10, DMDI, 'P',
+        DMM, AUTO_INC, DMAH, 0, DMAL, 60, DMDI, 'L', DMDI, 'O', DMDI, 'N', DMDI, 'G', DMDI, END_STRING,
+    };
+    EXPECT_EQ(expected, spiBytes);
+}
+
+// STUBS
+
+extern "C" {
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+
+timeUs_t micros(void) { return 0; }
+timeMs_t millis(void) { return 0; }
+void delay(timeMs_t) {}
+void delayMicroseconds(timeUs_t) {}
+
+void ioPreinitByTag(ioTag_t, uint8_t, ioPreinitPinState_e) {}
+IO_t IOGetByTag(ioTag_t tag) { return tag ? (IO_t)1 : NULL; }
+bool IOIsFreeOrPreinit(IO_t) { return true; }
+void IOInit(IO_t, resourceOwner_e, uint8_t) {}
+void IOConfigGPIO(IO_t, ioConfig_t) {}
+void IOHi(IO_t) {}
+
+bool spiSetBusInstance(extDevice_t *, uint32_t) { return true; }
+uint16_t spiCalculateDivider(uint32_t) { return 2; }
+uint32_t spiCalculateClock(uint16_t) { return 10000000; }
+void spiSetClkDivisor(const extDevice_t *, uint16_t) {}
+bool spiUseSDO_DMA(const extDevice_t *) { return true; }
+bool spiIsBusy(const extDevice_t *) { return false; }
+void spiWait(const extDevice_t *) {}
+void spiWrite(const extDevice_t *, uint8_t) {}
+void spiWriteReg(const extDevice_t *, uint8_t, uint8_t) {}
+void spiReadWriteBuf(const extDevice_t *, uint8_t *, uint8_t *, int) {}
+
+// VM0 reads back with the reset done, every other register as the OSDM default
+uint8_t spiReadRegMsk(const extDevice_t *, uint8_t reg) { return reg == 0x00 ? 0 : 0x1B; }
+
+void spiSequence(const extDevice_t *, busSegment_t *segments)
+{
+    for (busSegment_t *segment = segments; segment->len; segment++) {
+        spiBytes.insert(spiBytes.end(), segment->u.buffers.txData, segment->u.buffers.txData + segment->len);
+    }
+}
+
+}
@@ -0,0 +1,363 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "flight/imu.h"
+    #include "flight/nav_filter.h"
+
+    #include "io/gps.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/sensors.h"
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+
+    acc_t acc;
+    matrix33_t rMat;
+    gpsSolutionData_t gpsSol;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static const float dt = 0.01f;
+static const vector3_t noAcc = {{ 0, 0, 0 }};
+
+static bool gpsNewData;
+static timeUs_t gpsFixTime;
+static bool baroNewData;
+static float baroAltitude;
+static float gpsVelNorth;
+static float gpsVelEast;
+
+static void resetSensors(void)
+{
+    memset(&acc, 0, sizeof(acc));
+    acc.dev.acc_1G = 2048;
+    acc.dev.acc_1G_rec = 1.0f / 2048;
+    acc.accADC.z = 2048;
+    memset(&rMat, 0, sizeof(rMat));
+    rMat.m[0][0] = rMat.m[1][1] = rMat.m[2][2] = 1.0f;
+    memset(&gpsSol, 0, sizeof(gpsSol));
+    gpsNewData = false;
+    gpsFixTime = 0;
+    baroNewData = false;
+    baroAltitude = 0.0f;
+    gpsVelNorth = gpsVelEast = 0.0f;
+}
+
+TEST(NavFilterTest, FirstPositionInitialisesAxis)
+{
+    navFilterInit();
+
+    EXPECT_FALSE(navFilterIsValid(NAV_EAST));
+    // velocity alone doesn't start the filter
+    EXPECT_FALSE(navFilterUpdateVelocity(NAV_EAST, 100.0f, 100.0f));
+    EXPECT_FALSE(navFilterIsValid(NAV_EAST));
+
+    EXPECT_TRUE(navFilterUpdatePosition(NAV_EAST, 123.0f, 400.0f));
+    EXPECT_TRUE(navFilterIsValid(NAV_EAST));
+    EXPECT_FALSE(navFilterIsValid(NAV_NORTH));
+
+    vector3_t position, variance;
+    navFilterGetPosition(&position);
+    navFilterGetPositionVariance(&variance);
+    EXPECT_FLOAT_EQ(123.0f, position.x);
+    EXPECT_FLOAT_EQ(400.0f, variance.x);
+}
+
+TEST(NavFilterTest, PredictionGrowsVariance)
+{
+    navFilterInit();
+    navFilterUpdatePosition(NAV_NORTH, 0.0f, 100.0f);
+
+    vector3_t before, after;
+    navFilterGetPositionVariance(&before);
+    for (int i = 0; i < 100; i++) {
+        navFilterPredict(&noAcc, dt);
+    }
+    navFilterGetPositionVariance(&after);
+    EXPECT_GT(after.y, before.y);
+
+    // and the covariance stays symmetric
+    const navFilterAxis_t *axis = navFilterGetAxis(NAV_NORTH);
+    for (int i = 0; i < NAV_STATE_COUNT; i++) {
+        for (int j = 0; j < NAV_STATE_COUNT; j++) {
+            EXPECT_NEAR(axis->P[i][j], axis->P[j][i], 1e-3f * fabsf(axis->P[i][j]) + 1e-6f);
+        }
+    }
+}
+
+TEST(NavFilterTest, TracksConstantAcceleration)
+{
+    navFilterInit();
+    const float a = 200.0f; // cm/s/s
+    const vector3_t accEF = {{ a, 0, 0 }};
+    navFilterUpdatePosition(NAV_EAST, 0.0f, 100.0f);
+    navFilterUpdateVelocity(NAV_EAST, 0.0f, 100.0f);
+
+    for (int i = 1; i <= 300; i++) {
+        navFilterPredict(&accEF, dt);
+        const float t = i * dt;
+        if (i % 10 == 0) {
+            // GPS at 10Hz
+            navFilterUpdatePosition(NAV_EAST, 0.5f * a * t * t, sq(100.0f));
+            navFilterUpdateVelocity(NAV_EAST, a * t, sq(50.0f));
+        }
+    }
+
+    vector3_t position, velocity;
+    navFilterGetPosition(&position);
+    navFilterGetVelocity(&velocity);
+    EXPECT_NEAR(0.5f * a * 9.0f, position.x, 20.0f);
+    EXPECT_NEAR(a * 3.0f, velocity.x, 5.0f);
+}
+
+TEST(NavFilterTest, EstimatesAccelerometerBias)
+{
+    navFilterInit();
+    const float bias = 30.0f;
+    const vector3_t accEF = {{ 0, 0, bias }};
+    navFilterUpdatePosition(NAV_UP, 0.0f, 100.0f);
+
+    // stationary, with the baro at 50Hz
+    for (int i = 1; i <= 3000; i++) {
+        navFilterPredict(&accEF, dt);
+        if (i % 2 == 0) {
+            navFilterUpdatePosition(NAV_UP, 0.0f, sq(100.0f));
+        }
+    }
+
+    const navFilterAxis_t *axis = navFilterGetAxis(NAV_UP);
+    EXPECT_NEAR(bias, axis->x[NAV_STATE_ACC_BIAS], 3.0f);
+    EXPECT_NEAR(0.0f, axis->x[NAV_STATE_VEL], 5.0f);
+    // the fused position is better than a single measurement
+    EXPECT_LT(axis->P[NAV_STATE_POS][NAV_STATE_POS], sq(100.0f));
+}
+
+TEST(NavFilterTest, RejectsOutlierAndRecoversFromJump)
+{
+    navFilterInit();
+    navFilterUpdatePosition(NAV_NORTH, 0.0f, 100.0f);
+    for (int i = 0; i < 20; i++) {
+        navFilterPredict(&noAcc, dt);
+        navFilterUpdatePosition(NAV_NORTH, 0.0f, 100.0f);
+    }
+
+    // a single glitch is ignored
+    EXPECT_FALSE(navFilterUpdatePosition(NAV_NORTH, 5000.0f, 100.0f));
+    vector3_t position;
+    navFilterGetPosition(&position);
+    EXPECT_NEAR(0.0f, position.y, 1.0f);
+    EXPECT_TRUE(navFilterUpdatePosition(NAV_NORTH, 0.0f, 100.0f));
+
+    // a position that stays away is taken after repeated rejections
+    for (int i = 0; i < 20; i++) {
+        navFilterPredict(&noAcc, dt);
+        navFilterUpdatePosition(NAV_NORTH, 5000.0f, 100.0f);
+    }
+    navFilterGetPosition(&position);
+    EXPECT_NEAR(5000.0f, position.y, 10.0f);
+}
+
+TEST(NavFilterTest, TaskFusesGpsRelativeToFirstFix)
+{
+    navFilterInit();
+    resetSensors();
+
+    gpsSol.llh.lat = 450000000;
+    gpsSol.llh.lon = 70000000;
+    gpsSol.llh.altCm = 20000;
+    gpsSol.acc.hAcc = 1000;     // mm
+    gpsSol.acc.vAcc = 2000;
+    gpsNewData = true;
+    gpsFixTime = 10000;
+    updateNavFilter(10000);
+
+    EXPECT_TRUE(navFilterIsValid(NAV_EAST));
+    EXPECT_TRUE(navFilterIsValid(NAV_NORTH));
+    EXPECT_TRUE(navFilterIsValid(NAV_UP));
+    vector3_t position, variance;
+    navFilterGetPosition(&position);
+    navFilterGetPositionVariance(&variance);
+    EXPECT_FLOAT_EQ(0.0f, position.x);
+    EXPECT_FLOAT_EQ(0.0f, position.y);
+    EXPECT_FLOAT_EQ(0.0f, position.z);
+    EXPECT_NEAR(sq(100.0f), variance.x, 1.0f);
+
+    gpsLocation_t location;
+    EXPECT_TRUE(navFilterGetLocation(&location));
+    EXPECT_EQ(450000000, location.lat);
+    EXPECT_EQ(70000000, location.lon);
+    EXPECT_EQ(20000, location.altCm);
+}
+
+TEST(NavFilterTest, TaskRotatesAccelerometerToEarthFrame)
+{
+    navFilterInit();
+    resetSensors();
+    navFilterUpdatePosition(NAV_EAST, 0.0f, 1.0f);
+    navFilterUpdatePosition(NAV_NORTH, 0.0f, 1.0f);
+    navFilterUpdatePosition(NAV_UP, 0.0f, 1.0f);
+
+    // level, accelerating forward at 0.5G while pointing north
+    acc.accADC.x = 1024;
+    timeUs_t timeUs = 10000;
+    for (int i = 0; i < 100; i++) {
+        updateNavFilter(timeUs);
+        timeUs += 10000;
+    }
+
+    vector3_t velocity;
+    navFilterGetVelocity(&velocity);
+    EXPECT_NEAR(0.0f, velocity.x, 1.0f);
+    EXPECT_NEAR(490.0f, velocity.y, 10.0f);
+    EXPECT_NEAR(0.0f, velocity.z, 1.0f);
+
+    // yawed to point east, rMat is body to North West Up
+    navFilterInit();
+    navFilterUpdatePosition(NAV_EAST, 0.0f, 1.0f);
+    navFilterUpdatePosition(NAV_NORTH, 0.0f, 1.0f);
+    memset(&rMat, 0, sizeof(rMat));
+    rMat.m[0][1] = 1.0f;
+    rMat.m[1][0] = -1.0f;
+    rMat.m[2][2] = 1.0f;
+    for (int i = 0; i < 100; i++) {
+        updateNavFilter(timeUs);
+        timeUs += 10000;
+    }
+    navFilterGetVelocity(&velocity);
+    EXPECT_NEAR(490.0f, velocity.x, 10.0f);
+    EXPECT_NEAR(0.0f, velocity.y, 1.0f);
+}
+
+TEST(NavFilterTest, TaskFusesOnlyNewBaroSamples)
+{
+    navFilterInit();
+    resetSensors();
+
+    baroAltitude = 500.0f;
+    baroNewData = true;
+    updateNavFilter(10000);
+    vector3_t position, variance;
+    navFilterGetPosition(&position);
+    // the first baro sample is the zero of the vertical axis
+    EXPECT_FLOAT_EQ(0.0f, position.z);
+
+    navFilterGetPositionVariance(&variance);
+    const float initialVariance = variance.z;
+    updateNavFilter(20000);
+    navFilterGetPositionVariance(&variance);
+    // no new sample, so only the prediction ran
+    EXPECT_GT(variance.z, initialVariance);
+
+    // a new sample with the same altitude is still fused
+    baroNewData = true;
+    updateNavFilter(30000);
+    navFilterGetPositionVariance(&variance);
+    EXPECT_LT(variance.z, initialVariance);
+
+    baroAltitude = 520.0f;
+    baroNewData = true;
+    updateNavFilter(40000);
+    navFilterGetPosition(&position);
+    EXPECT_GT(position.z, 0.0f);
+    EXPECT_LT(position.z, 20.0f);
+}
+
+TEST(NavFilterTest, TaskMovesGpsFixOnByItsAge)
+{
+    for (int pass = 0; pass < 2; pass++) {
+        navFilterInit();
+        resetSensors();
+
+        gpsSol.llh.lat = 450000000;
+        gpsSol.llh.lon = 70000000;
+        gpsSol.acc.hAcc = 500;
+        gpsVelEast = 500.0f;    // flying east at 5m/s
+        gpsNewData = true;
+        gpsFixTime = 1000000;
+        updateNavFilter(1000000);
+
+        // the same location again, on the first pass fixed now, on the second 200ms ago
+        gpsNewData = true;
+        gpsFixTime = pass == 0 ? 1010000 : 810000;
+        updateNavFilter(1010000);
+
+        vector3_t position;
+        navFilterGetPosition(&position);
+        if (pass == 0) {
+            // pulled back towards the fix from the 5cm flown since the first one
+            EXPECT_LT(position.x, 5.0f);
+        } else {
+            // the fix is 1m behind the aircraft by now
+            EXPECT_GT(position.x, 40.0f);
+            EXPECT_LT(position.x, 100.0f);
+        }
+    }
+}
+
+// STUBS
+
+extern "C" {
+    bool sensors(uint32_t mask)
+    {
+        return mask & (SENSOR_ACC | SENSOR_BARO | SENSOR_GPS);
+    }
+
+    bool gpsHasNewData(uint16_t *stamp)
+    {
+        UNUSED(stamp);
+        const bool newData = gpsNewData;
+        gpsNewData = false;
+        return newData;
+    }
+
+    bool gpsFixVelocity(float *velNorthCmS, float *velEastCmS)
+    {
+        *velNorthCmS = gpsVelNorth;
+        *velEastCmS = gpsVelEast;
+        return true;
+    }
+
+    timeUs_t gpsFixTimeUs(void) { return gpsFixTime; }
+
+    bool baroIsCalibrated(void) { return true; }
+    float getBaroAltitude(void) { return baroAltitude; }
+
+    bool baroHasNewData(uint16_t *stamp)
+    {
+        UNUSED(stamp);
+        const bool newData = baroNewData;
+        baroNewData = false;
+        return newData;
+    }
+}
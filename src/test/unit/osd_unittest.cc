@@ -807,6 +807,50 @@ TEST_F(OsdTest, TestElementAmperage)
     displayPortTestBufferSubstring(1, 12, "123.45%c", SYM_AMP);
 }
 
+/*
+ * Tests that a cached element is only re-formatted when its value changes by the threshold.
+ */
+TEST_F(OsdTest, TestElementAmperageChangeThreshold)
+{
+    // given
+    osdElementConfigMutable()->item_pos[OSD_CURRENT_DRAW] = OSD_POS(1, 12) | OSD_PROFILE_1_FLAG;
+
+    osdAnalyzeActiveElements();
+
+    // when
+    simulationBatteryAmperage = 2156;
+    displayClearScreen(&testDisplayPort, DISPLAY_CLEAR_WAIT);
+    osdRefresh();
+
+    // then
+    displayPortTestBufferSubstring(1, 12, " 21.56%c", SYM_AMP);
+
+    // when a change below the threshold
+    simulationBatteryAmperage = 2158;
+    displayClearScreen(&testDisplayPort, DISPLAY_CLEAR_WAIT);
+    osdRefresh();
+
+    // then the cached string is still displayed
+    displayPortTestBufferSubstring(1, 12, " 21.56%c", SYM_AMP);
+
+    // when a change above the threshold
+    simulationBatteryAmperage = 2161;
+    displayClearScreen(&testDisplayPort, DISPLAY_CLEAR_WAIT);
+    osdRefresh();
+
+    // then
+    displayPortTestBufferSubstring(1, 12, " 21.61%c", SYM_AMP);
+
+    // when the cached string has expired
+    simulationBatteryAmperage = 2163;
+    simulationTime += 1e6;
+    displayClearScreen(&testDisplayPort, DISPLAY_CLEAR_WAIT);
+    osdRefresh();
+
+    // then
+    displayPortTestBufferSubstring(1, 12, " 21.63%c", SYM_AMP);
+}
+
 /*
  * Tests the battery capacity drawn OSD element.
  */
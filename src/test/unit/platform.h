@@ -133,4 +133,10 @@ typedef struct
 
 #include "target.h"
 
+#if defined(CONFIG_IN_FILE) || defined(CONFIG_IN_RAM)
+extern uint8_t eepromData[EEPROM_SIZE];
+#define __config_start (*eepromData)
+#define __config_end (*ARRAYEND(eepromData))
+#endif
+
 #include "target/common_defaults_post.h"
@@ -44,6 +44,7 @@ extern "C" {
     rssiSource_e rssiSource;
 
     void crsfDataReceive(uint16_t c);
+    void crsfIdle(void);
     uint8_t crsfFrameCRC(void);
     uint8_t crsfFrameCmdCRC(void);
     uint8_t crsfFrameStatus(void);
@@ -345,6 +346,134 @@ TEST(CrossFireTest, TestCrsfDataReceive)
     EXPECT_EQ(crc, crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]);
 }
 
+// A port whose receive buffer is filled by the test, as the RX DMA does
+#define TEST_RX_BUFFER_SIZE 256
+
+static uint8_t testRxBuffer[TEST_RX_BUFFER_SIZE];
+static serialPort_t testPort;
+static serialPortConfig_t testPortConfig;
+static uint32_t testBaudRate;
+static rxRuntimeState_t testRxRuntimeState;
+
+static uint32_t testRxWaiting(const serialPort_t *instance)
+{
+    return (instance->rxBufferHead - instance->rxBufferTail) % instance->rxBufferSize;
+}
+
+static uint8_t testRead(serialPort_t *instance)
+{
+    const uint8_t ch = instance->rxBuffer[instance->rxBufferTail];
+    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    return ch;
+}
+
+static const struct serialPortVTable testVTable = {
+    .serialWrite = NULL,
+    .serialTotalRxWaiting = testRxWaiting,
+    .serialTotalTxFree = NULL,
+    .serialRead = testRead,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = NULL,
+    .setMode = NULL,
+    .setCtrlLineStateCb = NULL,
+    .setBaudRateCb = NULL,
+    .setIdleCallback = NULL,
+    .writeBuf = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+};
+
+static void initCrsfRx(uint32_t baudRate)
+{
+    memset(&testPort, 0, sizeof(testPort));
+    testPort.vTable = &testVTable;
+    testPort.rxBuffer = testRxBuffer;
+    testPort.rxBufferSize = TEST_RX_BUFFER_SIZE;
+    testBaudRate = baudRate;
+
+    rxConfig_t config;
+    memset(&config, 0, sizeof(config));
+    config.midrc = 1500;
+    memset(&testRxRuntimeState, 0, sizeof(testRxRuntimeState));
+    EXPECT_TRUE(crsfRxInit(&config, &testRxRuntimeState));
+
+    // well clear of anything received by earlier tests
+    dummyTimeUs += 100000;
+    crsfFrameDone = false;
+}
+
+static void dmaReceive(const uint8_t *data, int count)
+{
+    for (int i = 0; i < count; i++) {
+        testPort.rxBuffer[testPort.rxBufferHead] = data[i];
+        testPort.rxBufferHead = (testPort.rxBufferHead + 1) % testPort.rxBufferSize;
+    }
+}
+
+static void rcChannelsFrame(uint8_t *frame)
+{
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
+    frame[2] = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
+    memcpy(&frame[3], &capturedData[3], CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE);
+    frame[3 + CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = crc8_dvb_s2_update(0, &frame[2], CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + 1);
+}
+
+TEST(CrossFireTest, TestIdleLineFramesDmaBuffer)
+{
+    initCrsfRx(CRSF_BAUDRATE);
+    EXPECT_EQ(crsfIdle, testPort.idleCallback);
+
+    uint8_t frame[sizeof(crsfRcChannelsFrame_t)];
+    rcChannelsFrame(frame);
+
+    // an idle line in the middle of the frame leaves the framer where it was
+    dmaReceive(frame, 10);
+    testPort.idleCallback();
+    EXPECT_FALSE(crsfFrameDone);
+    EXPECT_EQ(0, serialRxBytesWaiting(&testPort));
+
+    dummyTimeUs += 200;
+    dmaReceive(&frame[10], sizeof(frame) - 10);
+    testPort.idleCallback();
+    EXPECT_TRUE(crsfFrameDone);
+    EXPECT_EQ(dummyTimeUs, testRxRuntimeState.lastRcFrameTimeUs);
+    EXPECT_EQ(0, serialRxBytesWaiting(&testPort));
+
+    // two frames in one burst
+    crsfFrameDone = false;
+    dummyTimeUs += 1000;
+    dmaReceive(frame, sizeof(frame));
+    dmaReceive(frame, sizeof(frame));
+    testPort.idleCallback();
+    EXPECT_TRUE(crsfFrameDone);
+    EXPECT_EQ(0, serialRxBytesWaiting(&testPort));
+}
+
+TEST(CrossFireTest, TestFrameTimeoutScalesWithBaudRate)
+{
+    uint8_t frame[sizeof(crsfRcChannelsFrame_t)];
+    rcChannelsFrame(frame);
+
+    // at 420000 baud a frame that starts 500us after a broken one is taken as the rest of it
+    initCrsfRx(CRSF_BAUDRATE);
+    dmaReceive(frame, 10);
+    testPort.idleCallback();
+    dummyTimeUs += 500;
+    dmaReceive(frame, sizeof(frame));
+    testPort.idleCallback();
+    EXPECT_FALSE(crsfFrameDone);
+
+    // at 2 Mbaud a whole frame takes less than 400us, so the next frame is found after the same gap
+    initCrsfRx(2000000);
+    dmaReceive(frame, 10);
+    testPort.idleCallback();
+    dummyTimeUs += 500;
+    dmaReceive(frame, sizeof(frame));
+    testPort.idleCallback();
+    EXPECT_TRUE(crsfFrameDone);
+}
+
 // STUBS
 
 extern "C" {
@@ -352,8 +481,12 @@ extern "C" {
 int16_t debug[DEBUG16_VALUE_COUNT];
 uint32_t micros(void) {return dummyTimeUs;}
 uint32_t microsISR(void) {return micros();}
-serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return NULL;}
-const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return NULL;}
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e)
+{
+    testPort.baudRate = testBaudRate;
+    return &testPort;
+}
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return &testPortConfig;}
 bool telemetryCheckRxPortShared(const serialPortConfig_t *) {return false;}
 serialPort_t *telemetrySharedPort = NULL;
 void crsfScheduleDeviceInfoResponse(void) {};
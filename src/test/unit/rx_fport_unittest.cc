@@ -0,0 +1,314 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "drivers/serial.h"
+
+    #include "fc/controlrate_profile.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+    #include "flight/pid.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+    #include "pg/rx.h"
+
+    #include "rx/rx.h"
+    #include "rx/fport.h"
+    #include "rx/frsky_crc.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/esc_sensor.h"
+    #include "sensors/sensors.h"
+
+    #include "telemetry/smartport.h"
+    #include "telemetry/smartport_response.h"
+    #include "telemetry/telemetry.h"
+
+    void initSmartPortSensors(void);
+
+    PG_REGISTER(telemetryConfig_t, telemetryConfig, PG_TELEMETRY_CONFIG, 0);
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+    PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FPORT_FRAME_MARKER                      0x7E
+#define FPORT_FRAME_TYPE_TELEMETRY_REQUEST      0x01
+#define FPORT_FRAME_TYPE_TELEMETRY_RESPONSE     0x81
+#define FPORT_FRAME_ID_DATA                     0x10
+
+#define FSSP_DATAID_VFAS                        0x0210
+
+extern "C" {
+    uint8_t armingFlags = 0;
+    uint8_t stateFlags = 0;
+    uint16_t flightModeFlags = 0;
+    attitudeEulerAngles_t attitude = EULER_INITIALIZE;
+    acc_t acc;
+    gpsSolutionData_t gpsSol;
+    uint16_t GPS_distanceToHome;
+    pidProfile_t *currentPidProfile;
+    controlRateConfig_t *currentControlRateProfile;
+    rssiSource_e rssiSource;
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+}
+
+static timeUs_t fakeMicros;
+
+static serialPort_t testPort;
+static serialReceiveCallbackPtr receiveCallback;
+static std::vector<uint8_t> written;
+static std::vector<timeUs_t> writeTimes;
+
+static rxRuntimeState_t runtimeState;
+
+static void receiveTelemetryRequest(void)
+{
+    uint8_t frame[] = { 8, FPORT_FRAME_TYPE_TELEMETRY_REQUEST, FPORT_FRAME_ID_DATA, 0, 0, 0, 0, 0, 0, 0 };
+    uint16_t checksum = 0;
+    for (unsigned i = 0; i < sizeof(frame) - 1; i++) {
+        frskyCheckSumStep(&checksum, frame[i]);
+    }
+    frskyCheckSumFini(&checksum);
+    frame[sizeof(frame) - 1] = checksum;
+
+    receiveCallback(FPORT_FRAME_MARKER, NULL);
+    for (uint8_t c : frame) {
+        receiveCallback(c, NULL);
+    }
+    receiveCallback(FPORT_FRAME_MARKER, NULL);
+}
+
+static const smartPortResponseStats_t *vfasStats(void)
+{
+    const smartPortResponseStats_t *stats = smartPortResponseGetStats(0);
+    EXPECT_NE(nullptr, stats);
+    EXPECT_EQ(FSSP_DATAID_VFAS, stats->valueId);
+    return stats;
+}
+
+class FportTelemetryTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        static bool initialised = false;
+        if (!initialised) {
+            // telemetry is set up once, by the first init
+            ASSERT_TRUE(fportRxInit(rxConfig(), &runtimeState));
+            initialised = true;
+        }
+        initSmartPortSensors();
+        smartPortResponseInit();
+
+        // well clear of the last test
+        fakeMicros += 1000000;
+        written.clear();
+        writeTimes.clear();
+    }
+
+    // the task builds the frame for the next request
+    void arm(void) {
+        EXPECT_TRUE(runtimeState.rcProcessFrameFn(&runtimeState));
+        EXPECT_TRUE(smartPortResponseIsArmed());
+        EXPECT_TRUE(written.empty());
+    }
+};
+
+TEST_F(FportTelemetryTest, ArmedFrameIsSentWhenTheWindowOpens)
+{
+    // given
+    arm();
+    receiveTelemetryRequest();
+    const timeUs_t requestUs = fakeMicros;
+
+    // when the frame is checked before the window opens
+    fakeMicros += 300;
+    EXPECT_EQ(RX_FRAME_PENDING, runtimeState.rcFrameStatusFn(&runtimeState));
+
+    // then
+    EXPECT_TRUE(written.empty());
+
+    // when it opens
+    fakeMicros += 300;
+    EXPECT_TRUE(runtimeState.rcFrameStatusFn(&runtimeState) & RX_FRAME_PROCESSING_REQUIRED);
+
+    // then the armed response goes out from the frame check
+    ASSERT_EQ(1u, writeTimes.size());
+    EXPECT_EQ(600, cmpTimeUs(writeTimes[0], requestUs));
+    ASSERT_EQ(10u, written.size());
+    EXPECT_EQ(8, written[0]);
+    EXPECT_EQ(FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, written[1]);
+    EXPECT_EQ(FSSP_DATA_FRAME, written[2]);
+    EXPECT_EQ(FSSP_DATAID_VFAS & 0xff, written[3]);
+    EXPECT_EQ(FSSP_DATAID_VFAS >> 8, written[4]);
+    EXPECT_TRUE(frskyCheckSumIsGood(written.data(), written.size()));
+    EXPECT_FALSE(smartPortResponseIsArmed());
+    EXPECT_EQ(1u, vfasStats()->hits);
+    EXPECT_EQ(0u, vfasStats()->misses);
+}
+
+TEST_F(FportTelemetryTest, LateWindowIsAMissOfTheArmedFrame)
+{
+    // given
+    arm();
+    receiveTelemetryRequest();
+
+    // when the frame is only checked after the window closed
+    fakeMicros += 2500;
+    runtimeState.rcFrameStatusFn(&runtimeState);
+    runtimeState.rcProcessFrameFn(&runtimeState);
+
+    // then the frame is kept for the next request
+    EXPECT_TRUE(written.empty());
+    EXPECT_TRUE(smartPortResponseIsArmed());
+    EXPECT_EQ(0u, vfasStats()->hits);
+    EXPECT_EQ(1u, vfasStats()->misses);
+
+    // when
+    receiveTelemetryRequest();
+    fakeMicros += 600;
+    runtimeState.rcFrameStatusFn(&runtimeState);
+
+    // then
+    EXPECT_EQ(1u, writeTimes.size());
+    EXPECT_EQ(1u, vfasStats()->hits);
+    EXPECT_EQ(1u, vfasStats()->misses);
+}
+
+TEST_F(FportTelemetryTest, FrameBuiltInTheWindowIsSent)
+{
+    // given nothing armed
+    receiveTelemetryRequest();
+    const timeUs_t requestUs = fakeMicros;
+
+    // when the window opens
+    fakeMicros += 600;
+    EXPECT_TRUE(runtimeState.rcFrameStatusFn(&runtimeState) & RX_FRAME_PROCESSING_REQUIRED);
+    EXPECT_TRUE(written.empty());
+
+    // and the frame is built while it is open
+    fakeMicros += 400;
+    runtimeState.rcProcessFrameFn(&runtimeState);
+
+    // then it is sent as soon as it is built
+    ASSERT_EQ(1u, writeTimes.size());
+    EXPECT_EQ(1000, cmpTimeUs(writeTimes[0], requestUs));
+    EXPECT_EQ(1u, vfasStats()->hits);
+    EXPECT_EQ(0u, vfasStats()->misses);
+}
+
+TEST_F(FportTelemetryTest, FrameBuiltTooLateIsAMissOfThatFrame)
+{
+    // given nothing armed
+    receiveTelemetryRequest();
+    fakeMicros += 600;
+    runtimeState.rcFrameStatusFn(&runtimeState);
+
+    // when the frame is built after the window closed
+    fakeMicros += 2000;
+    runtimeState.rcProcessFrameFn(&runtimeState);
+
+    // then it waits for the next request, charged with the miss
+    EXPECT_TRUE(written.empty());
+    EXPECT_TRUE(smartPortResponseIsArmed());
+    EXPECT_EQ(0u, vfasStats()->hits);
+    EXPECT_EQ(1u, vfasStats()->misses);
+}
+
+// STUBS
+
+extern "C" {
+
+timeUs_t micros(void) { return fakeMicros; }
+timeUs_t microsISR(void) { return fakeMicros; }
+timeMs_t millis(void) { return fakeMicros / 1000; }
+
+bool telemetryIsSensorEnabled(sensor_e sensor) { return sensor & SENSOR_VOLTAGE; }
+bool featureIsEnabled(const uint32_t mask) { UNUSED(mask); return false; }
+bool sensors(uint32_t mask) { UNUSED(mask); return false; }
+
+bool isBatteryVoltageConfigured(void) { return true; }
+bool isAmperageConfigured(void) { return false; }
+uint16_t getBatteryVoltage(void) { return 1680; }
+uint16_t getBatteryAverageCellVoltage(void) { return 420; }
+int32_t getAmperage(void) { return 0; }
+int32_t getMAhDrawn(void) { return 0; }
+uint8_t calculateBatteryPercentageRemaining(void) { return 0; }
+int32_t getEstimatedAltitudeCm(void) { return 0; }
+int16_t getEstimatedVario(void) { return 0; }
+
+bool isArmingDisabled(void) { return false; }
+uint8_t getMotorCount(void) { return 4; }
+escSensorData_t *getEscSensorData(uint8_t motorNumber) { UNUSED(motorNumber); return NULL; }
+float erpmToRpm(uint32_t erpm) { return erpm; }
+
+void setRssi(uint16_t rssiValue, rssiSource_e source) { UNUSED(rssiValue); UNUSED(source); }
+void setRssiDirect(uint16_t newRssi, rssiSource_e source) { UNUSED(newRssi); UNUSED(source); }
+
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    static serialPortConfig_t portConfig;
+    portConfig.identifier = SERIAL_PORT_USART1;
+    portConfig.functionMask = function;
+    return &portConfig;
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr callback, void *, uint32_t, portMode_e, portOptions_e)
+{
+    receiveCallback = callback;
+    return &testPort;
+}
+
+portSharing_e determinePortSharing(const serialPortConfig_t *portConfig, serialPortFunction_e function) { UNUSED(portConfig); UNUSED(function); return PORTSHARING_UNUSED; }
+void closeSerialPort(serialPort_t *serialPort) { UNUSED(serialPort); }
+void serialSetIdleCallback(serialPort_t *serialPort, serialIdleCallbackPtr cb) { serialPort->idleCallback = cb; }
+bool telemetryDetermineEnabledState(portSharing_e portSharing) { UNUSED(portSharing); return true; }
+uint32_t serialRxBytesWaiting(const serialPort_t *instance) { UNUSED(instance); return 0; }
+uint8_t serialRead(serialPort_t *instance) { UNUSED(instance); return 0; }
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    EXPECT_EQ(&testPort, instance);
+    written.insert(written.end(), data, data + count);
+    writeTimes.push_back(fakeMicros);
+}
+
+}
@@ -396,6 +396,8 @@ extern "C" {
 
     attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
     gpsSolutionData_t gpsSol;
+    uint16_t GPS_distanceToHome;
+    int16_t GPS_directionToHome;
     rssiSource_e rssiSource;
     uint8_t armingFlags;
     uint8_t stateFlags;
@@ -429,7 +431,10 @@ extern "C" {
 
     const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return NULL;}
     serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) { return NULL; }
+    void serialSetIdleCallback(serialPort_t *, serialIdleCallbackPtr) {}
     void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+    uint32_t serialRxBytesWaiting(const serialPort_t *) { return 0; }
+    uint8_t serialRead(serialPort_t *) { return 0; }
 
     int32_t getEstimatedAltitudeCm(void) { return gpsSol.llh.altCm; }
 
@@ -0,0 +1,280 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/feature.h"
+
+    #include "flight/mixer.h"
+
+    #include "sensors/esc_state.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+class EscStateTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        escStateReset();
+    }
+};
+
+static void setErpm(uint8_t motorIndex, int32_t erpm, timeUs_t currentTimeUs)
+{
+    escStateBeginUpdate(motorIndex);
+    escStateSet(motorIndex, ESC_STATE_ERPM, erpm, ESC_STATE_SOURCE_DSHOT, currentTimeUs);
+    escStateEndUpdate(motorIndex, currentTimeUs);
+}
+
+// one history sample of each of four motors, commanded to the given outputs
+static void sampleMotors(const int32_t erpm[4], const float command[4], timeUs_t currentTimeUs)
+{
+    for (int i = 0; i < 4; i++) {
+        motor[i] = command[i];
+        setErpm(i, erpm[i], currentTimeUs);
+    }
+}
+
+static const float hoverCommand[4] = { 1500, 1520, 1480, 1510 };
+
+TEST_F(EscStateTest, ReadsWhatWasWritten)
+{
+    escState_t state;
+    EXPECT_FALSE(escStateRead(0, &state));
+    EXPECT_FALSE(escStateRead(MAX_SUPPORTED_MOTORS, &state));
+
+    escStateBeginUpdate(1);
+    escStateSet(1, ESC_STATE_TEMPERATURE, 45, ESC_STATE_SOURCE_ESC_SENSOR, 1000);
+    escStateSet(1, ESC_STATE_VOLTAGE, 1620, ESC_STATE_SOURCE_ESC_SENSOR, 1000);
+    escStateEndUpdate(1, 1000);
+
+    EXPECT_FALSE(escStateRead(0, &state));
+    ASSERT_TRUE(escStateRead(1, &state));
+    EXPECT_EQ(45, state.data[ESC_STATE_TEMPERATURE]);
+    EXPECT_EQ(1620, state.data[ESC_STATE_VOLTAGE]);
+    EXPECT_EQ(1000u, state.updatedUs[ESC_STATE_VOLTAGE]);
+    EXPECT_TRUE(escStateHasField(&state, ESC_STATE_TEMPERATURE));
+    EXPECT_FALSE(escStateHasField(&state, ESC_STATE_ERPM));
+    EXPECT_EQ(0, state.historyCount);
+}
+
+TEST_F(EscStateTest, ReaderDoesNotSeeUpdateInProgress)
+{
+    setErpm(0, 100, 1000);
+
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 200, ESC_STATE_SOURCE_DSHOT, 2000);
+    escState_t state;
+    EXPECT_FALSE(escStateRead(0, &state));
+    escStateEndUpdate(0, 2000);
+
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_EQ(200, state.data[ESC_STATE_ERPM]);
+}
+
+TEST_F(EscStateTest, SourceKeepsFieldWhileFresh)
+{
+    setErpm(0, 300, 1000);
+
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 250, ESC_STATE_SOURCE_ESC_SENSOR, 2000);
+    escStateSet(0, ESC_STATE_TEMPERATURE, 50, ESC_STATE_SOURCE_ESC_SENSOR, 2000);
+    escStateEndUpdate(0, 2000);
+
+    escState_t state;
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_EQ(300, state.data[ESC_STATE_ERPM]);
+    EXPECT_EQ(ESC_STATE_SOURCE_DSHOT, state.source[ESC_STATE_ERPM]);
+    EXPECT_EQ(ESC_STATE_SOURCE_ESC_SENSOR, state.source[ESC_STATE_TEMPERATURE]);
+
+    // the other source takes over once the field is stale
+    const timeUs_t staleUs = 1000 + ESC_STATE_STALE_US;
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 250, ESC_STATE_SOURCE_ESC_SENSOR, staleUs);
+    escStateEndUpdate(0, staleUs);
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_EQ(250, state.data[ESC_STATE_ERPM]);
+    EXPECT_EQ(ESC_STATE_SOURCE_ESC_SENSOR, state.source[ESC_STATE_ERPM]);
+
+    // the preferred source takes the field back at once
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 310, ESC_STATE_SOURCE_DSHOT, staleUs + 1000);
+    escStateEndUpdate(0, staleUs + 1000);
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_EQ(310, state.data[ESC_STATE_ERPM]);
+    EXPECT_EQ(ESC_STATE_SOURCE_DSHOT, state.source[ESC_STATE_ERPM]);
+}
+
+TEST_F(EscStateTest, PreferredSourceIsPerField)
+{
+    // the serial sensor delivered first, DShot is preferred for eRPM and replaces it
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 250, ESC_STATE_SOURCE_ESC_SENSOR, 1000);
+    escStateSet(0, ESC_STATE_VOLTAGE, 1612, ESC_STATE_SOURCE_ESC_SENSOR, 1000);
+    escStateEndUpdate(0, 1000);
+
+    escStateBeginUpdate(0);
+    escStateSet(0, ESC_STATE_ERPM, 260, ESC_STATE_SOURCE_DSHOT, 2000);
+    escStateSet(0, ESC_STATE_VOLTAGE, 1600, ESC_STATE_SOURCE_DSHOT, 2000);
+    escStateEndUpdate(0, 2000);
+
+    // the serial sensor is preferred for the voltage and keeps it
+    escState_t state;
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_EQ(260, state.data[ESC_STATE_ERPM]);
+    EXPECT_EQ(ESC_STATE_SOURCE_DSHOT, state.source[ESC_STATE_ERPM]);
+    EXPECT_EQ(1612, state.data[ESC_STATE_VOLTAGE]);
+    EXPECT_EQ(ESC_STATE_SOURCE_ESC_SENSOR, state.source[ESC_STATE_VOLTAGE]);
+}
+
+TEST_F(EscStateTest, HistoryIsSampledAtInterval)
+{
+    timeUs_t currentTimeUs = 1000;
+    for (int i = 0; i < 100; i++) {
+        setErpm(0, 100 + i, currentTimeUs);
+        currentTimeUs += 125;   // 8kHz loop
+    }
+
+    escState_t state;
+    ASSERT_TRUE(escStateRead(0, &state));
+    // samples at 0 and 10ms of the 12.5ms the loop ran
+    EXPECT_EQ(2, state.historyCount);
+    EXPECT_EQ(100, state.erpmHistory[0]);
+    EXPECT_EQ(180, state.erpmHistory[1]);
+}
+
+TEST_F(EscStateTest, DetectsDesyncOfOneMotor)
+{
+    const int32_t hover[4] = { 200, 210, 190, 205 };
+    const int32_t desync[4] = { 200, 30, 190, 205 };
+    timeUs_t currentTimeUs = 1000;
+
+    for (int i = 0; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        sampleMotors(hover, hoverCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+    escState_t state;
+    ASSERT_TRUE(escStateRead(1, &state));
+    EXPECT_FALSE(state.desync);
+
+    sampleMotors(desync, hoverCommand, currentTimeUs);
+    currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    sampleMotors(desync, hoverCommand, currentTimeUs);
+    currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+
+    ASSERT_TRUE(escStateRead(1, &state));
+    EXPECT_TRUE(state.desync);
+    EXPECT_EQ(1, state.desyncCount);
+    ASSERT_TRUE(escStateRead(0, &state));
+    EXPECT_FALSE(state.desync);
+
+    // cleared once the motor recovers, the count remains
+    sampleMotors(hover, hoverCommand, currentTimeUs);
+    ASSERT_TRUE(escStateRead(1, &state));
+    EXPECT_FALSE(state.desync);
+    EXPECT_EQ(1, state.desyncCount);
+}
+
+TEST_F(EscStateTest, ThrottleCutIsNotDesync)
+{
+    const int32_t hover[4] = { 200, 210, 190, 205 };
+    const int32_t idle[4] = { 40, 35, 45, 30 };
+    const float idleCommand[4] = { 1050, 1050, 1050, 1050 };
+    timeUs_t currentTimeUs = 1000;
+
+    for (int i = 0; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        sampleMotors(hover, hoverCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+    for (int i = 0; i < 3; i++) {
+        sampleMotors(idle, idleCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        escState_t state;
+        ASSERT_TRUE(escStateRead(i, &state));
+        EXPECT_FALSE(state.desync);
+        EXPECT_EQ(0, state.desyncCount);
+    }
+}
+
+TEST_F(EscStateTest, RollSnapIsNotDesync)
+{
+    // the mixer drops two motors hard and raises the others, the slowed motors lag their command
+    const int32_t hover[4] = { 200, 210, 190, 205 };
+    const int32_t rolling[4] = { 60, 220, 70, 230 };
+    const float rollCommand[4] = { 1050, 1900, 1050, 1900 };
+    timeUs_t currentTimeUs = 1000;
+
+    for (int i = 0; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        sampleMotors(hover, hoverCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+    for (int i = 0; i < 2; i++) {
+        sampleMotors(rolling, rollCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+    // back to hover, the slowed motors have not spun up yet
+    for (int i = 0; i < 2; i++) {
+        sampleMotors(rolling, hoverCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        escState_t state;
+        ASSERT_TRUE(escStateRead(i, &state));
+        EXPECT_FALSE(state.desync);
+        EXPECT_EQ(0, state.desyncCount);
+    }
+}
+
+TEST_F(EscStateTest, SlowMotorsAreNotChecked)
+{
+    const int32_t slow[4] = { 40, 45, 40, 42 };
+    const int32_t stopped[4] = { 40, 0, 40, 42 };
+    timeUs_t currentTimeUs = 1000;
+
+    for (int i = 0; i < ESC_STATE_HISTORY_LENGTH; i++) {
+        sampleMotors(slow, hoverCommand, currentTimeUs);
+        currentTimeUs += ESC_STATE_HISTORY_INTERVAL_US;
+    }
+    sampleMotors(stopped, hoverCommand, currentTimeUs);
+
+    escState_t state;
+    ASSERT_TRUE(escStateRead(1, &state));
+    EXPECT_FALSE(state.desync);
+}
+
+// STUBS
+
+extern "C" {
+    float motor[MAX_SUPPORTED_MOTORS];
+
+    float getMotorOutputLow(void) { return 1000; }
+    float getMotorOutputHigh(void) { return 2000; }
+
+    bool featureIsEnabled(const uint32_t mask) { UNUSED(mask); return false; }
+}
@@ -152,6 +152,111 @@ TEST(SensorGyro, Update)
     EXPECT_NEAR(90 * gyroDevPtr->scale, gyro.gyroADC[Z], 1e-3);
 }
 
+static int16_t fakeFifoSamples[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT];
+static uint8_t fakeFifoCount;
+
+static bool fakeGyroReadFifo(gyroDev_t *gyroDev)
+{
+    memcpy(gyroDev->fifoSamples, fakeFifoSamples, sizeof(fakeFifoSamples));
+    gyroDev->fifoCount = fakeFifoCount;
+    return true;
+}
+
+static void fakeFifoSet(uint8_t count, int16_t x, int16_t y, int16_t z, int16_t step)
+{
+    for (int i = 0; i < count; i++) {
+        fakeFifoSamples[i][X] = x + i * step;
+        fakeFifoSamples[i][Y] = y + i * step;
+        fakeFifoSamples[i][Z] = z + i * step;
+    }
+    fakeFifoCount = count;
+}
+
+TEST(SensorGyro, UpdateFifo)
+{
+    pgResetAll();
+    // turn off filters
+    gyroConfigMutable()->gyro_lpf1_static_hz = 0;
+    gyroConfigMutable()->gyro_lpf2_static_hz = 0;
+    gyroConfigMutable()->gyro_soft_notch_hz_1 = 0;
+    gyroConfigMutable()->gyro_soft_notch_hz_2 = 0;
+    gyroInit();
+    gyroSetTargetLooptime(1);
+    gyroDevPtr->readFn = fakeGyroReadFifo;
+    gyroDevPtr->fifoDepth = 4;
+    gyro.fifoDepth = 4;
+
+    // calibration uses every sample of the burst
+    gyroStartCalibration(false);
+    fakeFifoSet(4, 5, 6, 7, 0);
+    while (!gyroIsCalibrationComplete()) {
+        gyroUpdate();
+    }
+    EXPECT_EQ(5, gyroDevPtr->gyroZero[X]);
+    EXPECT_EQ(6, gyroDevPtr->gyroZero[Y]);
+    EXPECT_EQ(7, gyroDevPtr->gyroZero[Z]);
+
+    // all samples of the burst are summed for downsampling
+    gyro.sampleSum[X] = gyro.sampleSum[Y] = gyro.sampleSum[Z] = 0;
+    gyro.sampleCount = 0;
+    fakeFifoSet(4, 9, 10, 11, 4);
+    gyroUpdate();
+    EXPECT_EQ(4, gyro.sampleCount);
+    EXPECT_NEAR((4 + 8 + 12 + 16) * gyroDevPtr->scale, gyro.sampleSum[X], 1e-3);
+    EXPECT_NEAR((4 + 8 + 12 + 16) * gyroDevPtr->scale, gyro.sampleSum[Y], 1e-3);
+    EXPECT_NEAR((4 + 8 + 12 + 16) * gyroDevPtr->scale, gyro.sampleSum[Z], 1e-3);
+    // gyro.gyroADC holds the newest sample
+    EXPECT_NEAR(16 * gyroDevPtr->scale, gyro.gyroADC[X], 1e-3);
+    EXPECT_EQ(21, gyroDevPtr->gyroADCRaw[X]);
+
+    // without a new burst the previous sample is used once
+    fakeFifoSet(0, 0, 0, 0, 0);
+    gyroUpdate();
+    EXPECT_EQ(5, gyro.sampleCount);
+    EXPECT_NEAR((4 + 8 + 12 + 16 + 16) * gyroDevPtr->scale, gyro.sampleSum[X], 1e-3);
+
+    gyroDevPtr->fifoDepth = 0;
+    gyro.fifoDepth = 0;
+}
+
+TEST(SensorGyro, CalibrateFifoDuration)
+{
+    pgResetAll();
+    gyroInit();
+    gyroSetTargetLooptime(1);
+    gyroDevPtr->readFn = virtualGyroRead;
+
+    // without the FIFO one sample is read per gyro task
+    int updates = 0;
+    gyroStartCalibration(false);
+    while (!gyroIsCalibrationComplete()) {
+        virtualGyroSet(gyroDevPtr, 5, 6, 7);
+        gyroUpdate();
+        updates++;
+    }
+    const int calibrationUpdates = updates;
+    EXPECT_EQ(gyroConfig()->gyroCalibrationDuration * 10000 / gyro.sampleLooptime, calibrationUpdates);
+
+    // a burst of 4 samples per task calibrates over the same number of gyro tasks
+    gyroDevPtr->readFn = fakeGyroReadFifo;
+    gyroDevPtr->fifoDepth = 4;
+    gyro.fifoDepth = 4;
+    fakeFifoSet(4, 5, 6, 7, 0);
+    updates = 0;
+    gyroStartCalibration(false);
+    while (!gyroIsCalibrationComplete()) {
+        gyroUpdate();
+        updates++;
+    }
+    EXPECT_EQ(calibrationUpdates, updates);
+    EXPECT_EQ(5, gyroDevPtr->gyroZero[X]);
+    EXPECT_EQ(6, gyroDevPtr->gyroZero[Y]);
+    EXPECT_EQ(7, gyroDevPtr->gyroZero[Z]);
+
+    gyroDevPtr->fifoDepth = 0;
+    gyro.fifoDepth = 0;
+}
+
 // STUBS
 
 extern "C" {
@@ -164,4 +269,5 @@ void sensorsSet(uint32_t) {}
 void schedulerResetTaskStatistics(taskId_e) {}
 int getArmingDisableFlags(void) {return 0;}
 void writeEEPROM(void) {}
+int32_t clockCyclesToMicros(int32_t clockCycles) {return clockCycles;}
 }
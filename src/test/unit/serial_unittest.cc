@@ -0,0 +1,248 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute this software
+ * and/or modify this software under the terms of the GNU General
+ * Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Betaflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/serial.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_BUFFER_SIZE 16
+
+static uint8_t testRxBuffer[TEST_BUFFER_SIZE];
+static uint8_t testTxBuffer[TEST_BUFFER_SIZE];
+
+// A port whose transmit buffer is only drained by the test
+static void testWrite(serialPort_t *instance, uint8_t ch)
+{
+    instance->txBuffer[instance->txBufferHead] = ch;
+    instance->txBufferHead = (instance->txBufferHead + 1) % instance->txBufferSize;
+}
+
+static int rxWaitingCalls;
+static int txFreeCalls;
+
+static uint32_t testRxWaiting(const serialPort_t *instance)
+{
+    rxWaitingCalls++;
+    return (instance->rxBufferHead - instance->rxBufferTail) % instance->rxBufferSize;
+}
+
+static uint32_t testTxFree(const serialPort_t *instance)
+{
+    txFreeCalls++;
+    return instance->txBufferSize - 1 - (instance->txBufferHead - instance->txBufferTail) % instance->txBufferSize;
+}
+
+static uint8_t testRead(serialPort_t *instance)
+{
+    const uint8_t ch = instance->rxBuffer[instance->rxBufferTail];
+    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    return ch;
+}
+
+static const struct serialPortVTable testVTable = {
+    .serialWrite = testWrite,
+    .serialTotalRxWaiting = testRxWaiting,
+    .serialTotalTxFree = testTxFree,
+    .serialRead = testRead,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = NULL,
+    .setMode = NULL,
+    .setCtrlLineStateCb = NULL,
+    .setBaudRateCb = NULL,
+    .setIdleCallback = NULL,
+    .writeBuf = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+};
+
+static serialPort_t testPort;
+static timeUs_t testTimeUs;
+
+static void initTestPort(void)
+{
+    memset(&testPort, 0, sizeof(testPort));
+    testPort.vTable = &testVTable;
+    testPort.rxBuffer = testRxBuffer;
+    testPort.rxBufferSize = TEST_BUFFER_SIZE;
+    testPort.txBuffer = testTxBuffer;
+    testPort.txBufferSize = TEST_BUFFER_SIZE;
+    testTimeUs = 0;
+}
+
+static void receiveByte(uint8_t ch)
+{
+    serialStatsRxStore(&testPort);
+    testPort.rxBuffer[testPort.rxBufferHead] = ch;
+    testPort.rxBufferHead = (testPort.rxBufferHead + 1) % testPort.rxBufferSize;
+}
+
+TEST(SerialTest, CountsTransmittedBytes)
+{
+    initTestPort();
+
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    serialWriteBuf(&testPort, data, sizeof(data));
+    serialWrite(&testPort, 11);
+
+    EXPECT_EQ(11U, testPort.stats.txBytes);
+    EXPECT_EQ(0, testPort.stats.txStalls);
+    EXPECT_EQ(11, testPort.stats.txHighWater);
+
+    // Draining the buffer leaves the high water mark in place
+    testPort.txBufferTail = testPort.txBufferHead;
+    serialWrite(&testPort, 12);
+
+    EXPECT_EQ(12U, testPort.stats.txBytes);
+    EXPECT_EQ(11, testPort.stats.txHighWater);
+}
+
+TEST(SerialTest, CountsTransmitStalls)
+{
+    initTestPort();
+
+    // Fill the buffer, the next write finds no room
+    for (int i = 0; i < TEST_BUFFER_SIZE - 1; i++) {
+        serialWrite(&testPort, i);
+    }
+    EXPECT_EQ(0, testPort.stats.txStalls);
+
+    serialWrite(&testPort, 0);
+    EXPECT_EQ(1, testPort.stats.txStalls);
+    EXPECT_EQ(TEST_BUFFER_SIZE, testPort.stats.txHighWater);
+
+    serialResetStats(&testPort);
+    EXPECT_EQ(0U, testPort.stats.txBytes);
+    EXPECT_EQ(0, testPort.stats.txStalls);
+    EXPECT_EQ(0, testPort.stats.txHighWater);
+}
+
+TEST(SerialTest, SamplesLevelsOncePerPass)
+{
+    initTestPort();
+
+    for (int i = 0; i < 5; i++) {
+        receiveByte(i);
+    }
+
+    // Draining the buffer samples its level once
+    rxWaitingCalls = 0;
+    for (int i = 0; i < 5; i++) {
+        serialRead(&testPort);
+    }
+    EXPECT_EQ(1, rxWaitingCalls);
+    EXPECT_EQ(5, testPort.stats.rxHighWater);
+
+    // The next byte is sampled again
+    receiveByte(5);
+    receiveByte(6);
+    serialRead(&testPort);
+    EXPECT_EQ(2, rxWaitingCalls);
+
+    // Single byte writes sample once for the room they found
+    txFreeCalls = 0;
+    for (int i = 0; i < 5; i++) {
+        serialWrite(&testPort, i);
+    }
+    EXPECT_EQ(1, txFreeCalls);
+    EXPECT_EQ(5U, testPort.stats.txBytes);
+    // The level is as seen at the sample, the next sample catches up
+    EXPECT_EQ(1, testPort.stats.txHighWater);
+}
+
+TEST(SerialTest, CountsReceivedBytes)
+{
+    initTestPort();
+
+    for (int i = 0; i < 5; i++) {
+        receiveByte(i);
+    }
+    serialStatsRxCallback(&testPort);
+
+    EXPECT_EQ(5U, serialRxBytesWaiting(&testPort));
+    while (serialRxBytesWaiting(&testPort)) {
+        serialRead(&testPort);
+    }
+
+    // Bytes passed to the receive callback are counted along with those read
+    EXPECT_EQ(6U, testPort.stats.rxBytes);
+    EXPECT_EQ(5, testPort.stats.rxHighWater);
+    EXPECT_EQ(0, testPort.stats.rxOverruns);
+}
+
+TEST(SerialTest, CountsReceiveOverruns)
+{
+    initTestPort();
+
+    for (int i = 0; i < TEST_BUFFER_SIZE - 1; i++) {
+        receiveByte(i);
+    }
+    EXPECT_EQ(0, testPort.stats.rxOverruns);
+
+    // Storing another byte wraps the head onto the tail, losing the buffer contents
+    receiveByte(0);
+    EXPECT_EQ(1, testPort.stats.rxOverruns);
+
+    serialStatsRxOverrun(&testPort);
+    EXPECT_EQ(2, testPort.stats.rxOverruns);
+}
+
+TEST(SerialTest, TimesReceiveLatency)
+{
+    initTestPort();
+
+    // The first byte into the empty buffer is timed, the bytes behind it are not
+    testTimeUs = 1000;
+    receiveByte(1);
+    testTimeUs = 1200;
+    receiveByte(2);
+    testTimeUs = 1500;
+    serialRead(&testPort);
+    EXPECT_EQ(500U, testPort.stats.rxLatencyMaxUs);
+    testTimeUs = 5000;
+    serialRead(&testPort);
+    EXPECT_EQ(500U, testPort.stats.rxLatencyMaxUs);
+
+    // A byte served sooner leaves the maximum in place
+    receiveByte(3);
+    testTimeUs = 5100;
+    serialRead(&testPort);
+    EXPECT_EQ(500U, testPort.stats.rxLatencyMaxUs);
+
+    receiveByte(4);
+    testTimeUs = 7000;
+    serialRead(&testPort);
+    EXPECT_EQ(1900U, testPort.stats.rxLatencyMaxUs);
+}
+
+// STUBS
+
+extern "C" {
+    timeUs_t micros(void) { return testTimeUs; }
+}
@@ -259,6 +259,8 @@ TEST(CrossFireMSPTest, SendMspReply)
 extern "C" {
 
     gpsSolutionData_t gpsSol;
+    uint16_t GPS_distanceToHome;
+    int16_t GPS_directionToHome;
     attitudeEulerAngles_t attitude = { { 0, 0, 0 } };
     extern uint8_t responseBuffer[MSP_TLM_OUTBUF_SIZE];
 
@@ -21,6 +21,8 @@
 
 #include <limits.h>
 
+#include <vector>
+
 extern "C" {
     #include <platform.h>
 
@@ -38,6 +40,7 @@ extern "C" {
     #include "pg/pg_ids.h"
     #include "pg/rx.h"
 
+    #include "drivers/persistent.h"
     #include "drivers/serial.h"
     #include "drivers/system.h"
 
@@ -49,6 +52,7 @@ extern "C" {
     #include "flight/gps_rescue.h"
     #include "flight/imu.h"
 
+    #include "io/displayport_crsf.h"
     #include "io/gps.h"
     #include "io/serial.h"
 
@@ -304,6 +308,143 @@ TEST(TelemetryCrsfTest, TestFlightMode)
     EXPECT_EQ(crfsCrc(frame, frameLen), frame[7]);
 }
 
+static crsfDisplayPortScreen_t testScreen;
+static bool displayPortReady;
+static int menuOpenCount;
+static int menuExitCount;
+static int refreshCount;
+static uint8_t openRows;
+static uint8_t openCols;
+static bool openRowUpdates;
+
+static serialPort_t testPort;
+static std::vector<std::vector<uint8_t>> writtenFrames;
+
+static void displayPortTelemetryInit(void)
+{
+    static rxRuntimeState_t rxRuntimeState;
+    static bool rxInitialised = false;
+    if (!rxInitialised) {
+        ASSERT_TRUE(crsfRxInit(rxConfig(), &rxRuntimeState));
+        rxInitialised = true;
+    }
+    initCrsfTelemetry();
+    ASSERT_TRUE(checkCrsfTelemetryState());
+
+    memset(&testScreen, 0, sizeof(testScreen));
+    displayPortReady = true;
+    // drop any telemetry frame left by the last test
+    crsfRxSendTelemetryData();
+    writtenFrames.clear();
+}
+
+TEST(TelemetryCrsfTest, TestDisplayPortOpen)
+{
+    // given an OPEN without the flags byte
+    uint8_t open[] = { CRSF_DISPLAYPORT_SUBCMD_OPEN, 9, 32, CRSF_DISPLAYPORT_OPEN_FLAG_ROW_UPDATES };
+    menuOpenCount = 0;
+    openRowUpdates = true;
+
+    // when
+    crsfProcessDisplayPortCmd(open, 3);
+
+    // then the flags are not read past the end
+    EXPECT_EQ(9, openRows);
+    EXPECT_EQ(32, openCols);
+    EXPECT_FALSE(openRowUpdates);
+    EXPECT_EQ(1, menuOpenCount);
+
+    // when the client asks for row updates
+    open[1] = 6;
+    open[2] = 24;
+    crsfProcessDisplayPortCmd(open, sizeof(open));
+
+    // then
+    EXPECT_EQ(6, openRows);
+    EXPECT_EQ(24, openCols);
+    EXPECT_TRUE(openRowUpdates);
+    EXPECT_EQ(2, menuOpenCount);
+
+    // when
+    uint8_t close[] = { CRSF_DISPLAYPORT_SUBCMD_CLOSE };
+    uint8_t poll[] = { CRSF_DISPLAYPORT_SUBCMD_POLL };
+    menuExitCount = 0;
+    refreshCount = 0;
+    crsfProcessDisplayPortCmd(close, sizeof(close));
+    crsfProcessDisplayPortCmd(poll, sizeof(poll));
+
+    // then
+    EXPECT_EQ(1, menuExitCount);
+    EXPECT_EQ(1, refreshCount);
+    EXPECT_EQ(2, menuOpenCount);
+}
+
+TEST(TelemetryCrsfTest, TestDisplayPortUpdateRows)
+{
+    // given a 3x8 screen with rows 0 and 2 changed
+    displayPortTelemetryInit();
+    testScreen.rows = 3;
+    testScreen.cols = 8;
+    testScreen.rowUpdates = true;
+    memcpy(testScreen.buffer, "ABCDEFGH" "--------" "   X    ", 3 * 8);
+    testScreen.dirtyRows = (1 << 0) | (1 << 2);
+
+    // when
+    handleCrsfTelemetry(1000000);
+
+    // then only the changed rows are sent, each as [row][RLE encoded row]
+    ASSERT_EQ(1u, writtenFrames.size());
+    std::vector<uint8_t> &frame = writtenFrames[0];
+    const uint8_t expected[] = {
+        CRSF_SYNC_BYTE, 0, CRSF_FRAMETYPE_DISPLAYPORT_CMD, CRSF_ADDRESS_RADIO_TRANSMITTER, CRSF_ADDRESS_FLIGHT_CONTROLLER,
+        CRSF_DISPLAYPORT_SUBCMD_UPDATE_ROWS,
+        0, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
+        2, ' ' | 0x80, 3, 'X', ' ' | 0x80, 4,
+    };
+    ASSERT_EQ(sizeof(expected) + 1, frame.size());
+    EXPECT_EQ(frame.size() - 2, frame[1]);
+    for (unsigned i = 0; i < sizeof(expected); i++) {
+        if (i != 1) {
+            EXPECT_EQ(expected[i], frame[i]) << "at " << i;
+        }
+    }
+    EXPECT_EQ(crfsCrc(frame.data(), frame.size()), frame.back());
+    EXPECT_EQ(0, testScreen.dirtyRows);
+
+    // when nothing has changed since
+    handleCrsfTelemetry(2000000);
+
+    // then no rows are sent
+    EXPECT_EQ(1u, writtenFrames.size());
+}
+
+TEST(TelemetryCrsfTest, TestDisplayPortResetBeforeRows)
+{
+    // given a cleared screen with a row written since
+    displayPortTelemetryInit();
+    testScreen.rows = 3;
+    testScreen.cols = 8;
+    testScreen.rowUpdates = true;
+    memset(testScreen.buffer, ' ', 3 * 8);
+    testScreen.buffer[8] = 'X';
+    testScreen.reset = true;
+    testScreen.dirtyRows = 1 << 1;
+
+    // when
+    handleCrsfTelemetry(3000000);
+    handleCrsfTelemetry(4000000);
+
+    // then the client clears its screen before it takes the row
+    ASSERT_EQ(2u, writtenFrames.size());
+    EXPECT_EQ(CRSF_FRAMETYPE_DISPLAYPORT_CMD, writtenFrames[0][2]);
+    EXPECT_EQ(CRSF_DISPLAYPORT_SUBCMD_CLEAR, writtenFrames[0][5]);
+    EXPECT_EQ(CRSF_FRAMETYPE_DISPLAYPORT_CMD, writtenFrames[1][2]);
+    EXPECT_EQ(CRSF_DISPLAYPORT_SUBCMD_UPDATE_ROWS, writtenFrames[1][5]);
+    EXPECT_EQ(1, writtenFrames[1][6]);
+    EXPECT_FALSE(testScreen.reset);
+    EXPECT_EQ(0, testScreen.dirtyRows);
+}
+
 // STUBS
 
 extern "C" {
@@ -318,6 +459,7 @@ uint8_t useHottAlarmSoundPeriod (void) { return 0; }
 attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
 
 uint16_t GPS_distanceToHome;        // distance to home point in meters
+int16_t GPS_directionToHome;        // direction to home point in degrees * 10
 gpsSolutionData_t gpsSol;
 
 void beeperConfirmationBeeps(uint8_t beepCount) {UNUSED(beepCount);}
@@ -331,13 +473,25 @@ uint32_t serialRxBytesWaiting(const serialPort_t *) {return 0;}
 uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
 uint8_t serialRead(serialPort_t *) {return 0;}
 void serialWrite(serialPort_t *, uint8_t) {}
-void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    EXPECT_EQ(&testPort, instance);
+    writtenFrames.push_back(std::vector<uint8_t>(data, data + count));
+}
 void serialSetMode(serialPort_t *, portMode_e) {}
-serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return NULL;}
+void serialSetBaudRate(serialPort_t *, uint32_t) {}
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return &testPort;}
 void closeSerialPort(serialPort_t *) {}
+void serialSetIdleCallback(serialPort_t *serialPort, serialIdleCallbackPtr cb) { serialPort->idleCallback = cb; }
 bool isSerialTransmitBufferEmpty(const serialPort_t *) { return true; }
 
-const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) {return NULL;}
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    static serialPortConfig_t portConfig;
+    portConfig.identifier = SERIAL_PORT_USART1;
+    portConfig.functionMask = function;
+    return &portConfig;
+}
 
 bool telemetryDetermineEnabledState(portSharing_e) {return true;}
 bool telemetryCheckRxPortShared(const serialPortConfig_t *, SerialRXType) {return true;}
@@ -389,6 +543,9 @@ int32_t getMAhDrawn(void)
   return testmAhDrawn;
 }
 
+bool isEepromWriteInProgress(void) { return false; }
+uint32_t persistentObjectRead(persistentObjectId_e) { return 0; }
+void persistentObjectWrite(persistentObjectId_e, uint32_t) {}
 bool sendMspReply(uint8_t, mspResponseFnPtr) { return false; }
 bool handleMspFrame(uint8_t *, uint8_t, uint8_t *)  { return false; }
 bool isBatteryVoltageConfigured(void) { return true; }
@@ -396,4 +553,14 @@ bool isAmperageConfigured(void) { return true; }
 timeUs_t rxFrameTimeUs(void) { return 0; }
 bool IS_RC_MODE_ACTIVE(boxId_e) { return false; }
 bool gpsRescueIsConfigured(void) { return false; }
+
+void crsfDisplayportRegister(void) {}
+crsfDisplayPortScreen_t *crsfDisplayPortScreen(void) { return &testScreen; }
+void crsfDisplayPortMenuOpen(void) { menuOpenCount++; }
+void crsfDisplayPortMenuExit(void) { menuExitCount++; }
+void crsfDisplayPortRefresh(void) { refreshCount++; }
+bool crsfDisplayPortIsReady(void) { return displayPortReady; }
+void crsfDisplayPortSetDimensions(uint8_t rows, uint8_t cols) { openRows = rows; openCols = cols; }
+void crsfDisplayPortSetRowUpdates(bool rowUpdates) { openRowUpdates = rowUpdates; }
+
 }
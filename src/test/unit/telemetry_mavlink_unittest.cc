@@ -0,0 +1,873 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "cli/settings.h"
+
+    #include "common/utils.h"
+
+    #include "config/config.h"
+
+    #include "drivers/serial.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/position.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+
+    #include "telemetry/mavlink.h"
+    #include "telemetry/mavlink_frame.h"
+    #include "telemetry/mavlink_params.h"
+    #include "telemetry/telemetry.h"
+
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+    #pragma GCC diagnostic ignored "-Wignored-qualifiers"
+    #include "common/mavlink.h"
+    #pragma GCC diagnostic pop
+
+    PG_REGISTER(telemetryConfig_t, telemetryConfig, PG_TELEMETRY_CONFIG, 0);
+    PG_REGISTER(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 0);
+
+    const char * const lookupTableOffOn[] = { "OFF", "ON" };
+
+    const lookupTableEntry_t lookupTables[] = {
+        { lookupTableOffOn, ARRAYLEN(lookupTableOffOn) },
+    };
+
+    const clivalue_t valueTable[] = {
+        { .name = "mavlink_version", .type = VAR_UINT8 | MASTER_VALUE, .config = { .minmaxUnsigned = { 1, 2 } }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, mavlink_version) },
+        { .name = "mavlink_mah_as_heading_divisor", .type = VAR_UINT16 | MASTER_VALUE, .config = { .minmaxUnsigned = { 0, 30000 } }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, mavlink_mah_as_heading_divisor) },
+        { .name = "tlm_inverted", .type = VAR_UINT8 | MASTER_VALUE | MODE_LOOKUP, .config = { .lookup = { TABLE_OFF_ON } }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, telemetry_inverted) },
+        { .name = "flysky_sensors", .type = VAR_UINT8 | MASTER_VALUE | MODE_ARRAY, .config = { .array = { IBUS_SENSOR_COUNT } }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, flysky_sensors) },
+        { .name = "tlm_dis_voltage", .type = VAR_UINT32 | MASTER_VALUE | MODE_BITSET, .config = { .bitpos = 2 }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, disabledSensors) },
+        { .name = "hott_alarm_int", .type = VAR_UINT8 | MASTER_VALUE, .config = { .minmaxUnsigned = { 0, 120 } }, .pgn = PG_TELEMETRY_CONFIG, .offset = offsetof(telemetryConfig_t, hottAlarmSoundInterval) },
+    };
+    const uint16_t valueTableEntryCount = ARRAYLEN(valueTable);
+
+    uint8_t armingFlags;
+    uint16_t flightModeFlags;
+    uint8_t stateFlags;
+    attitudeEulerAngles_t attitude;
+    acc_t acc;
+    gyro_t gyro;
+    baro_t baro;
+    gpsSolutionData_t gpsSol;
+    gpsLocation_t GPS_home_llh;
+    rxRuntimeState_t rxRuntimeState;
+    float rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    serialPort_t *telemetrySharedPort;
+    const uint32_t baudRates[] = { 0, 9600, 19200, 38400, 57600, 115200 };
+
+    static timeUs_t testTimeUs;
+    static int eepromWrites;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SERIAL_BUFFER_SIZE 4096
+
+static serialPort_t serialTestInstance;
+static const serialPortConfig_t serialTestInstanceConfig = {
+    .functionMask = FUNCTION_TELEMETRY_MAVLINK,
+    .identifier = SERIAL_PORT_USART1,
+    .msp_baudrateIndex = BAUD_115200,
+    .gps_baudrateIndex = BAUD_115200,
+    .blackbox_baudrateIndex = BAUD_115200,
+    .telemetry_baudrateIndex = BAUD_115200,
+};
+
+static std::vector<uint8_t> txData;
+static uint32_t txFree;
+static uint32_t txBufferSize;       // the transmit buffer drains between telemetry calls
+static std::vector<uint8_t> rxData;
+static size_t rxPos;
+
+// MAVLink X.25 checksum, independent of the one in the MAVLink library
+static uint16_t testCrc(const uint8_t *data, size_t length, uint8_t crcExtra)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i <= length; i++) {
+        uint8_t tmp = (i < length ? data[i] : crcExtra) ^ (crc & 0xFF);
+        tmp ^= tmp << 4;
+        crc = (crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4);
+    }
+    return crc;
+}
+
+static int testCrcExtra(uint32_t msgId)
+{
+    switch (msgId) {
+    case 0: return 50;          // HEARTBEAT
+    case 1: return 124;         // SYS_STATUS
+    case 20: return 214;        // PARAM_REQUEST_READ
+    case 21: return 159;        // PARAM_REQUEST_LIST
+    case 22: return 220;        // PARAM_VALUE
+    case 23: return 168;        // PARAM_SET
+    case 24: return 24;         // GPS_RAW_INT
+    case 30: return 39;         // ATTITUDE
+    case 31: return 246;        // ATTITUDE_QUATERNION
+    case 33: return 104;        // GLOBAL_POSITION_INT
+    case 35: return 244;        // RC_CHANNELS_RAW
+    case 49: return 39;         // GPS_GLOBAL_ORIGIN
+    case 66: return 148;        // REQUEST_DATA_STREAM
+    case 74: return 20;         // VFR_HUD
+    case 76: return 152;        // COMMAND_LONG
+    case 77: return 143;        // COMMAND_ACK
+    case 105: return 93;        // HIGHRES_IMU
+    case 148: return 178;       // AUTOPILOT_VERSION
+    case 244: return 95;        // MESSAGE_INTERVAL
+    default: return -1;
+    }
+}
+
+typedef struct testFrame_s {
+    int version;
+    uint8_t seq;
+    uint8_t systemId;
+    uint8_t componentId;
+    uint32_t msgId;
+    std::vector<uint8_t> payload;   // zero padded to 255 bytes
+} testFrame_t;
+
+// Splits the transmitted bytes into frames, every frame must have a valid checksum
+static std::vector<testFrame_t> decodeFrames(const std::vector<uint8_t> &data)
+{
+    std::vector<testFrame_t> frames;
+    size_t i = 0;
+    while (i < data.size()) {
+        testFrame_t frame;
+        size_t headerSize;
+        const uint8_t length = data[i + 1];
+        if (data[i] == 0xFE) {
+            frame.version = 1;
+            frame.seq = data[i + 2];
+            frame.systemId = data[i + 3];
+            frame.componentId = data[i + 4];
+            frame.msgId = data[i + 5];
+            headerSize = 6;
+        } else {
+            EXPECT_EQ(0xFD, data[i]);
+            EXPECT_EQ(0, data[i + 2]);
+            frame.version = 2;
+            frame.seq = data[i + 4];
+            frame.systemId = data[i + 5];
+            frame.componentId = data[i + 6];
+            frame.msgId = data[i + 7] | (data[i + 8] << 8) | (data[i + 9] << 16);
+            headerSize = 10;
+        }
+        EXPECT_LE(i + headerSize + length + 2, data.size());
+        const int crcExtra = testCrcExtra(frame.msgId);
+        EXPECT_GE(crcExtra, 0);
+        const uint16_t crc = testCrc(&data[i + 1], headerSize - 1 + length, crcExtra);
+        EXPECT_EQ(crc & 0xFF, data[i + headerSize + length]);
+        EXPECT_EQ(crc >> 8, data[i + headerSize + length + 1]);
+
+        frame.payload.assign(&data[i + headerSize], &data[i + headerSize + length]);
+        frame.payload.resize(255, 0);
+        frames.push_back(frame);
+        i += headerSize + length + 2;
+    }
+    return frames;
+}
+
+static std::vector<uint8_t> encodeFrame(int version, uint32_t msgId, const void *payload, uint8_t length, bool sign = false, int crcExtra = -1)
+{
+    std::vector<uint8_t> frame;
+    if (version == 1) {
+        frame = { 0xFE, length, 7, 255, 190, (uint8_t)msgId };
+    } else {
+        frame = { 0xFD, length, (uint8_t)(sign ? 0x01 : 0), 0, 7, 255, 190, (uint8_t)msgId, (uint8_t)(msgId >> 8), (uint8_t)(msgId >> 16) };
+    }
+    frame.insert(frame.end(), (const uint8_t *)payload, (const uint8_t *)payload + length);
+    const uint16_t crc = testCrc(&frame[1], frame.size() - 1, crcExtra < 0 ? testCrcExtra(msgId) : crcExtra);
+    frame.push_back(crc & 0xFF);
+    frame.push_back(crc >> 8);
+    if (sign) {
+        frame.insert(frame.end(), 13, 0xA5);
+    }
+    return frame;
+}
+
+static void receive(const std::vector<uint8_t> &frame)
+{
+    rxData.insert(rxData.end(), frame.begin(), frame.end());
+}
+
+static std::vector<testFrame_t> framesWithId(const std::vector<testFrame_t> &frames, uint32_t msgId)
+{
+    std::vector<testFrame_t> result;
+    for (const testFrame_t &frame : frames) {
+        if (frame.msgId == msgId) {
+            result.push_back(frame);
+        }
+    }
+    return result;
+}
+
+static float payloadFloat(const testFrame_t &frame, int offset)
+{
+    float value;
+    memcpy(&value, &frame.payload[offset], sizeof(value));
+    return value;
+}
+
+static void resetSerial(void)
+{
+    txData.clear();
+    txBufferSize = SERIAL_BUFFER_SIZE;
+    txFree = txBufferSize;
+    rxData.clear();
+    rxPos = 0;
+}
+
+static void resetTestConfig(void)
+{
+    memset(telemetryConfigMutable(), 0, sizeof(telemetryConfig_t));
+    telemetryConfigMutable()->mavlink_version = 1;
+    armingFlags = 0;
+    eepromWrites = 0;
+}
+
+// Frame layer
+
+static uint8_t testPayload[255];
+
+static mavlinkFrame_t testFrame(uint8_t version, uint8_t length)
+{
+    mavlinkFrame_t frame = {
+        .version = version,
+        .seq = 3,
+        .systemId = 1,
+        .componentId = 1,
+        .msgId = 0, // HEARTBEAT
+        .length = length,
+        .payload = testPayload,
+    };
+    return frame;
+}
+
+TEST(MavlinkFrameTest, WriteV1)
+{
+    resetSerial();
+    memset(testPayload, 0, sizeof(testPayload));
+    testPayload[0] = 0x11;
+    testPayload[4] = 0x22;
+
+    const mavlinkFrame_t frame = testFrame(1, 9);
+    EXPECT_EQ(6 + 9 + 2, mavlinkFrameSize(&frame));
+    EXPECT_TRUE(mavlinkFrameWrite(&serialTestInstance, &frame, 50));
+    EXPECT_EQ(17u, txData.size());
+
+    const std::vector<testFrame_t> frames = decodeFrames(txData);
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(1, frames[0].version);
+    EXPECT_EQ(3, frames[0].seq);
+    EXPECT_EQ(0x11, frames[0].payload[0]);
+    EXPECT_EQ(0x22, frames[0].payload[4]);
+}
+
+TEST(MavlinkFrameTest, WriteV2TruncatesPayload)
+{
+    resetSerial();
+    memset(testPayload, 0, sizeof(testPayload));
+    testPayload[0] = 0x11;
+    testPayload[4] = 0x22;
+
+    mavlinkFrame_t frame = testFrame(2, 9);
+    EXPECT_EQ(10 + 5 + 2, mavlinkFrameSize(&frame));
+    EXPECT_TRUE(mavlinkFrameWrite(&serialTestInstance, &frame, 50));
+    EXPECT_EQ(17u, txData.size());
+    EXPECT_EQ(5, txData[1]);
+
+    std::vector<testFrame_t> frames = decodeFrames(txData);
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(2, frames[0].version);
+    EXPECT_EQ(0x22, frames[0].payload[4]);
+
+    // the first byte is kept even if it is zero
+    resetSerial();
+    memset(testPayload, 0, sizeof(testPayload));
+    EXPECT_EQ(10 + 1 + 2, mavlinkFrameSize(&frame));
+    EXPECT_TRUE(mavlinkFrameWrite(&serialTestInstance, &frame, 50));
+    EXPECT_EQ(1, txData[1]);
+    frames = decodeFrames(txData);
+    EXPECT_EQ(1u, frames.size());
+}
+
+TEST(MavlinkFrameTest, WriteNothingWhenFull)
+{
+    resetSerial();
+    memset(testPayload, 0, sizeof(testPayload));
+
+    const mavlinkFrame_t frame = testFrame(1, 9);
+    txFree = 16;
+    EXPECT_FALSE(mavlinkFrameWrite(&serialTestInstance, &frame, 50));
+    EXPECT_TRUE(txData.empty());
+
+    txFree = 17;
+    EXPECT_TRUE(mavlinkFrameWrite(&serialTestInstance, &frame, 50));
+    EXPECT_EQ(17u, txData.size());
+}
+
+#define TEST_MSG_ID_24BIT 0x12345
+#define TEST_MSG_24BIT_CRC 77
+
+static int parseCrcExtra(uint32_t msgId)
+{
+    switch (msgId) {
+    case 0:
+    case 23:
+        return testCrcExtra(msgId);
+    case TEST_MSG_ID_24BIT:
+        return TEST_MSG_24BIT_CRC;
+    default:
+        return -1;
+    }
+}
+
+static int parseAll(mavlinkFrameParser_t *parser, const std::vector<uint8_t> &data, mavlinkFrame_t *frame)
+{
+    int count = 0;
+    for (uint8_t c : data) {
+        count += mavlinkFrameParse(parser, c, frame);
+    }
+    return count;
+}
+
+TEST(MavlinkFrameTest, Parse)
+{
+    mavlinkFrameParser_t parser;
+    mavlinkFrameParserInit(&parser, parseCrcExtra);
+    mavlinkFrame_t frame;
+
+    const uint8_t payload[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+    // noise before the frame is skipped
+    std::vector<uint8_t> data = { 0x00, 0x55 };
+    std::vector<uint8_t> v1 = encodeFrame(1, 0, payload, sizeof(payload));
+    data.insert(data.end(), v1.begin(), v1.end());
+    EXPECT_EQ(1, parseAll(&parser, data, &frame));
+    EXPECT_EQ(1, frame.version);
+    EXPECT_EQ(0u, frame.msgId);
+    EXPECT_EQ(255, frame.systemId);
+    EXPECT_EQ(9, frame.length);
+    EXPECT_EQ(0, memcmp(payload, frame.payload, sizeof(payload)));
+
+    // a truncated payload is zero padded
+    EXPECT_EQ(1, parseAll(&parser, encodeFrame(2, TEST_MSG_ID_24BIT, payload, 3, false, TEST_MSG_24BIT_CRC), &frame));
+    EXPECT_EQ(2, frame.version);
+    EXPECT_EQ((uint32_t)TEST_MSG_ID_24BIT, frame.msgId);
+    EXPECT_EQ(3, frame.payload[2]);
+    EXPECT_EQ(0, frame.payload[3]);
+    EXPECT_EQ(0, frame.payload[254]);
+
+    // the signature is skipped
+    EXPECT_EQ(1, parseAll(&parser, encodeFrame(2, 23, payload, sizeof(payload), true), &frame));
+    EXPECT_EQ(23u, frame.msgId);
+    EXPECT_EQ(1, parseAll(&parser, v1, &frame));
+
+    EXPECT_EQ(4u, parser.frames);
+    EXPECT_EQ(0u, parser.errors);
+}
+
+TEST(MavlinkFrameTest, ParseRejects)
+{
+    mavlinkFrameParser_t parser;
+    mavlinkFrameParserInit(&parser, parseCrcExtra);
+    mavlinkFrame_t frame;
+
+    const uint8_t payload[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+    std::vector<uint8_t> corrupt = encodeFrame(1, 0, payload, sizeof(payload));
+    corrupt[8] ^= 0x01;
+    EXPECT_EQ(0, parseAll(&parser, corrupt, &frame));
+
+    // unknown message
+    EXPECT_EQ(0, parseAll(&parser, encodeFrame(2, 21, payload, sizeof(payload)), &frame));
+
+    // unknown incompatibility flag
+    std::vector<uint8_t> flagged = encodeFrame(2, 0, payload, sizeof(payload));
+    flagged[2] = 0x02;
+    EXPECT_EQ(0, parseAll(&parser, flagged, &frame));
+
+    EXPECT_EQ(3u, parser.errors);
+
+    // and recovers
+    EXPECT_EQ(1, parseAll(&parser, encodeFrame(1, 0, payload, sizeof(payload)), &frame));
+    EXPECT_EQ(1u, parser.frames);
+}
+
+// Parameters
+
+TEST(MavlinkParamsTest, ExposedSettings)
+{
+    resetTestConfig();
+
+    // the long name and the array are not exposed
+    EXPECT_EQ(4, mavlinkParamCount());
+    EXPECT_EQ(0, mavlinkParamFind("mavlink_version"));
+    EXPECT_EQ(1, mavlinkParamFind("tlm_inverted"));
+    EXPECT_EQ(2, mavlinkParamFind("tlm_dis_voltage"));
+    EXPECT_EQ(3, mavlinkParamFind("hott_alarm_int"));
+    EXPECT_EQ(-1, mavlinkParamFind("flysky_sensors"));
+    EXPECT_EQ(-1, mavlinkParamFind("mavlink_mah_as_heading_divisor"));
+    EXPECT_EQ(-1, mavlinkParamFind("mavlink_mah_as_h"));
+
+    mavlinkParam_t param;
+    EXPECT_FALSE(mavlinkParamGet(4, &param));
+}
+
+TEST(MavlinkParamsTest, GetAndSet)
+{
+    resetTestConfig();
+    telemetryConfigMutable()->hottAlarmSoundInterval = 5;
+    telemetryConfigMutable()->disabledSensors = 1 << 2;
+
+    mavlinkParam_t param;
+    EXPECT_TRUE(mavlinkParamGet(3, &param));
+    EXPECT_STREQ("hott_alarm_int", param.id);
+    EXPECT_EQ(5, param.value);
+    EXPECT_EQ(VAR_UINT8, param.type);
+
+    EXPECT_TRUE(mavlinkParamGet(2, &param));
+    EXPECT_EQ(1, param.value);
+    EXPECT_EQ(VAR_UINT8, param.type);
+
+    // out of range values are refused
+    EXPECT_FALSE(mavlinkParamSet(3, 121));
+    EXPECT_FALSE(mavlinkParamSet(0, 3));
+    EXPECT_FALSE(mavlinkParamSet(1, 2));
+    EXPECT_EQ(5, telemetryConfig()->hottAlarmSoundInterval);
+
+    EXPECT_TRUE(mavlinkParamSet(3, 99.8f));
+    EXPECT_EQ(100, telemetryConfig()->hottAlarmSoundInterval);
+    EXPECT_TRUE(mavlinkParamSet(1, 1));
+    EXPECT_EQ(1, telemetryConfig()->telemetry_inverted);
+
+    telemetryConfigMutable()->disabledSensors = 0xF0;
+    EXPECT_TRUE(mavlinkParamSet(2, 1));
+    EXPECT_EQ(0xF4u, telemetryConfig()->disabledSensors);
+    EXPECT_TRUE(mavlinkParamSet(2, 0));
+    EXPECT_EQ(0xF0u, telemetryConfig()->disabledSensors);
+}
+
+// Telemetry
+
+static void startTelemetry(void)
+{
+    resetSerial();
+    testTimeUs = 1000000;
+    initMAVLinkTelemetry();
+    configureMAVLinkTelemetryPort();
+}
+
+static std::vector<testFrame_t> runTelemetry(timeDelta_t forUs, timeDelta_t stepUs = 4000)
+{
+    txData.clear();
+    for (timeDelta_t t = 0; t < forUs; t += stepUs) {
+        txFree = txBufferSize;
+        handleMAVLinkTelemetry(testTimeUs);
+        testTimeUs += stepUs;
+    }
+    return decodeFrames(txData);
+}
+
+TEST(MavlinkTelemetryTest, DefaultStreams)
+{
+    resetTestConfig();
+    startTelemetry();
+
+    const std::vector<testFrame_t> frames = runTelemetry(1000000);
+    ASSERT_FALSE(frames.empty());
+    EXPECT_EQ(1, frames[0].version);
+    EXPECT_EQ(1, frames[0].systemId);
+    EXPECT_EQ(1, frames[0].componentId);
+    for (size_t i = 1; i < frames.size(); i++) {
+        EXPECT_EQ((uint8_t)(frames[i - 1].seq + 1), frames[i].seq);
+    }
+
+    EXPECT_EQ(10u, framesWithId(frames, 0).size());     // HEARTBEAT
+    EXPECT_EQ(2u, framesWithId(frames, 1).size());      // SYS_STATUS
+    EXPECT_EQ(5u, framesWithId(frames, 35).size());     // RC_CHANNELS_RAW
+    EXPECT_EQ(10u, framesWithId(frames, 30).size());    // ATTITUDE
+    EXPECT_EQ(10u, framesWithId(frames, 74).size());    // VFR_HUD
+    EXPECT_EQ(0u, framesWithId(frames, 31).size());     // ATTITUDE_QUATERNION
+    EXPECT_EQ(0u, framesWithId(frames, 105).size());    // HIGHRES_IMU
+}
+
+TEST(MavlinkTelemetryTest, FullTransmitBuffer)
+{
+    resetTestConfig();
+    startTelemetry();
+
+    txBufferSize = 0;
+    EXPECT_TRUE(runTelemetry(100000).empty());
+
+    // due messages go out once there is room again, without a backlog
+    txBufferSize = SERIAL_BUFFER_SIZE;
+    const std::vector<testFrame_t> frames = runTelemetry(4000);
+    EXPECT_EQ(1u, framesWithId(frames, 0).size());
+    EXPECT_EQ(1u, framesWithId(frames, 30).size());
+}
+
+TEST(MavlinkTelemetryTest, RequestDataStream)
+{
+    resetTestConfig();
+    startTelemetry();
+
+    mavlink_request_data_stream_t request = {
+        .req_message_rate = 50,
+        .target_system = 1,
+        .target_component = 1,
+        .req_stream_id = MAV_DATA_STREAM_RAW_SENSORS,
+        .start_stop = 1,
+    };
+    receive(encodeFrame(1, 66, &request, sizeof(request)));
+    std::vector<testFrame_t> frames = runTelemetry(1000000);
+    EXPECT_EQ(50u, framesWithId(frames, 105).size());
+
+    // rates above the telemetry task rate are limited to it
+    request.req_stream_id = MAV_DATA_STREAM_EXTRA1;
+    request.req_message_rate = 500;
+    receive(encodeFrame(1, 66, &request, sizeof(request)));
+    frames = runTelemetry(100000);
+    EXPECT_EQ(25u, framesWithId(frames, 30).size());
+    EXPECT_EQ(25u, framesWithId(frames, 31).size());
+
+    // all streams off, the heartbeat is not a stream
+    request.req_stream_id = MAV_DATA_STREAM_ALL;
+    request.start_stop = 0;
+    receive(encodeFrame(1, 66, &request, sizeof(request)));
+    frames = runTelemetry(1000000);
+    EXPECT_EQ(10u, frames.size());
+    EXPECT_EQ(10u, framesWithId(frames, 0).size());
+
+    // requests for another system are ignored
+    request.target_system = 2;
+    request.start_stop = 1;
+    receive(encodeFrame(1, 66, &request, sizeof(request)));
+    frames = runTelemetry(1000000);
+    EXPECT_EQ(10u, frames.size());
+}
+
+static mavlink_command_long_t commandLong(uint16_t command, float param1, float param2 = 0)
+{
+    mavlink_command_long_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.command = command;
+    cmd.param1 = param1;
+    cmd.param2 = param2;
+    cmd.target_system = 1;
+    return cmd;
+}
+
+static void expectAck(const std::vector<testFrame_t> &frames, uint16_t command, uint8_t result)
+{
+    const std::vector<testFrame_t> acks = framesWithId(frames, 77);
+    ASSERT_EQ(1u, acks.size());
+    EXPECT_EQ(command, acks[0].payload[0] | (acks[0].payload[1] << 8));
+    EXPECT_EQ(result, acks[0].payload[2]);
+}
+
+TEST(MavlinkTelemetryTest, MessageInterval)
+{
+    resetTestConfig();
+    startTelemetry();
+
+    // SET_MESSAGE_INTERVAL HIGHRES_IMU every 10ms
+    mavlink_command_long_t cmd = commandLong(511, 105, 10000);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    std::vector<testFrame_t> frames = runTelemetry(1000000);
+    expectAck(frames, 511, MAV_RESULT_ACCEPTED);
+    EXPECT_EQ(100u, framesWithId(frames, 105).size());
+
+    // the link follows the ground station to MAVLink 2
+    for (const testFrame_t &frame : frames) {
+        EXPECT_EQ(2, frame.version);
+    }
+
+    // GET_MESSAGE_INTERVAL
+    cmd = commandLong(510, 105);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    frames = runTelemetry(4000);
+    expectAck(frames, 510, MAV_RESULT_ACCEPTED);
+    std::vector<testFrame_t> intervals = framesWithId(frames, 244);
+    ASSERT_EQ(1u, intervals.size());
+    int32_t intervalUs;
+    memcpy(&intervalUs, &intervals[0].payload[0], sizeof(intervalUs));
+    EXPECT_EQ(10000, intervalUs);
+    EXPECT_EQ(105, intervals[0].payload[4]);
+
+    // -1 disables the message, 0 restores the default rate
+    cmd = commandLong(511, 30, -1);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    frames = runTelemetry(1000000);
+    expectAck(frames, 511, MAV_RESULT_ACCEPTED);
+    EXPECT_EQ(0u, framesWithId(frames, 30).size());
+
+    cmd = commandLong(510, 30);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    frames = runTelemetry(4000);
+    intervals = framesWithId(frames, 244);
+    ASSERT_EQ(1u, intervals.size());
+    memcpy(&intervalUs, &intervals[0].payload[0], sizeof(intervalUs));
+    EXPECT_EQ(-1, intervalUs);
+
+    cmd = commandLong(511, 30, 0);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    frames = runTelemetry(1000000);
+    EXPECT_EQ(10u, framesWithId(frames, 30).size());
+
+    // unknown message
+    cmd = commandLong(511, 200, 1000);
+    receive(encodeFrame(2, 76, &cmd, sizeof(cmd)));
+    expectAck(runTelemetry(4000), 511, MAV_RESULT_UNSUPPORTED);
+}
+
+TEST(MavlinkTelemetryTest, Commands)
+{
+    resetTestConfig();
+    startTelemetry();
+
+    // REQUEST_AUTOPILOT_CAPABILITIES
+    mavlink_command_long_t cmd = commandLong(MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES, 1);
+    receive(encodeFrame(1, 76, &cmd, sizeof(cmd)));
+    std::vector<testFrame_t> frames = runTelemetry(4000);
+    expectAck(frames, MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES, MAV_RESULT_ACCEPTED);
+    const std::vector<testFrame_t> versions = framesWithId(frames, 148);
+    ASSERT_EQ(1u, versions.size());
+    uint64_t capabilities;
+    memcpy(&capabilities, &versions[0].payload[0], sizeof(capabilities));
+    EXPECT_EQ((uint64_t)(MAV_PROTOCOL_CAPABILITY_PARAM_FLOAT | 8192), capabilities);
+
+    // PREFLIGHT_STORAGE writes the configuration, but not when armed
+    cmd = commandLong(MAV_CMD_PREFLIGHT_STORAGE, 1);
+    receive(encodeFrame(1, 76, &cmd, sizeof(cmd)));
+    expectAck(runTelemetry(4000), MAV_CMD_PREFLIGHT_STORAGE, MAV_RESULT_ACCEPTED);
+    EXPECT_EQ(1, eepromWrites);
+
+    ENABLE_ARMING_FLAG(ARMED);
+    receive(encodeFrame(1, 76, &cmd, sizeof(cmd)));
+    expectAck(runTelemetry(4000), MAV_CMD_PREFLIGHT_STORAGE, MAV_RESULT_DENIED);
+    EXPECT_EQ(1, eepromWrites);
+
+    cmd = commandLong(MAV_CMD_NAV_TAKEOFF, 0);
+    receive(encodeFrame(1, 76, &cmd, sizeof(cmd)));
+    expectAck(runTelemetry(4000), MAV_CMD_NAV_TAKEOFF, MAV_RESULT_UNSUPPORTED);
+}
+
+static void expectParamValue(const testFrame_t &frame, const char *id, float value, uint16_t index)
+{
+    EXPECT_EQ(value, payloadFloat(frame, 0));
+    EXPECT_EQ(4, frame.payload[4] | (frame.payload[5] << 8));      // param_count
+    EXPECT_EQ(index, frame.payload[6] | (frame.payload[7] << 8));
+    EXPECT_EQ(0, strncmp(id, (const char *)&frame.payload[8], 16));
+    EXPECT_EQ(MAV_PARAM_TYPE_UINT8, frame.payload[24]);
+}
+
+TEST(MavlinkTelemetryTest, ParamList)
+{
+    resetTestConfig();
+    telemetryConfigMutable()->hottAlarmSoundInterval = 7;
+    startTelemetry();
+
+    const uint8_t request[2] = { 1, 1 };
+    receive(encodeFrame(1, 21, request, sizeof(request)));
+
+    // the list is sent as the transmit buffer has room, after the telemetry
+    txBufferSize = 100;
+    std::vector<testFrame_t> frames = runTelemetry(4000);
+    EXPECT_EQ(0u, framesWithId(frames, 22).size());
+
+    txBufferSize = 120;
+    frames = runTelemetry(4000);
+    std::vector<testFrame_t> params = framesWithId(frames, 22);
+    EXPECT_FALSE(params.empty());
+    EXPECT_LT(params.size(), 4u);
+    txBufferSize = SERIAL_BUFFER_SIZE;
+    frames = runTelemetry(4000);
+    const std::vector<testFrame_t> rest = framesWithId(frames, 22);
+    params.insert(params.end(), rest.begin(), rest.end());
+
+    ASSERT_EQ(4u, params.size());
+    expectParamValue(params[0], "mavlink_version", 1, 0);
+    expectParamValue(params[1], "tlm_inverted", 0, 1);
+    expectParamValue(params[2], "tlm_dis_voltage", 0, 2);
+    expectParamValue(params[3], "hott_alarm_int", 7, 3);
+
+    // the list is sent once
+    frames = runTelemetry(100000);
+    EXPECT_EQ(0u, framesWithId(frames, 22).size());
+}
+
+TEST(MavlinkTelemetryTest, ParamReadAndSet)
+{
+    resetTestConfig();
+    telemetryConfigMutable()->hottAlarmSoundInterval = 7;
+    startTelemetry();
+
+    mavlink_param_request_read_t read;
+    memset(&read, 0, sizeof(read));
+    read.param_index = -1;
+    strncpy(read.param_id, "hott_alarm_int", sizeof(read.param_id));
+    receive(encodeFrame(1, 20, &read, sizeof(read)));
+    read.param_index = 1;
+    receive(encodeFrame(1, 20, &read, sizeof(read)));
+    std::vector<testFrame_t> params = framesWithId(runTelemetry(4000), 22);
+    ASSERT_EQ(2u, params.size());
+    expectParamValue(params[0], "hott_alarm_int", 7, 3);
+    expectParamValue(params[1], "tlm_inverted", 0, 1);
+
+    // the new value is echoed back
+    mavlink_param_set_t set;
+    memset(&set, 0, sizeof(set));
+    set.param_value = 42;
+    set.target_system = 1;
+    strncpy(set.param_id, "hott_alarm_int", sizeof(set.param_id));
+    set.param_type = MAV_PARAM_TYPE_UINT8;
+    receive(encodeFrame(1, 23, &set, sizeof(set)));
+    params = framesWithId(runTelemetry(4000), 22);
+    ASSERT_EQ(1u, params.size());
+    expectParamValue(params[0], "hott_alarm_int", 42, 3);
+    EXPECT_EQ(42, telemetryConfig()->hottAlarmSoundInterval);
+
+    // out of range, and armed, the current value is echoed back
+    set.param_value = 200;
+    receive(encodeFrame(1, 23, &set, sizeof(set)));
+    params = framesWithId(runTelemetry(4000), 22);
+    ASSERT_EQ(1u, params.size());
+    expectParamValue(params[0], "hott_alarm_int", 42, 3);
+
+    ENABLE_ARMING_FLAG(ARMED);
+    set.param_value = 10;
+    receive(encodeFrame(1, 23, &set, sizeof(set)));
+    params = framesWithId(runTelemetry(4000), 22);
+    ASSERT_EQ(1u, params.size());
+    expectParamValue(params[0], "hott_alarm_int", 42, 3);
+    EXPECT_EQ(42, telemetryConfig()->hottAlarmSoundInterval);
+}
+
+TEST(MavlinkTelemetryTest, ParamReplyWaitsForRoom)
+{
+    resetTestConfig();
+    telemetryConfigMutable()->hottAlarmSoundInterval = 7;
+    startTelemetry();
+
+    mavlink_param_request_read_t read;
+    memset(&read, 0, sizeof(read));
+    read.param_index = 3;
+    receive(encodeFrame(1, 20, &read, sizeof(read)));
+
+    // no room for the reply, it is not lost
+    txBufferSize = 20;
+    EXPECT_EQ(0u, framesWithId(runTelemetry(4000), 22).size());
+
+    txBufferSize = SERIAL_BUFFER_SIZE;
+    std::vector<testFrame_t> params = framesWithId(runTelemetry(4000), 22);
+    ASSERT_EQ(1u, params.size());
+    expectParamValue(params[0], "hott_alarm_int", 7, 3);
+
+    // and sent once
+    EXPECT_EQ(0u, framesWithId(runTelemetry(100000), 22).size());
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return testTimeUs; }
+uint32_t millis(void) { return testTimeUs / 1000; }
+
+uint32_t serialTxBytesFree(const serialPort_t *) { return txFree; }
+
+void serialWriteBufNoFlush(serialPort_t *instance, const uint8_t *data, int count)
+{
+    EXPECT_EQ(&serialTestInstance, instance);
+    EXPECT_LE((uint32_t)count, txFree);
+    txData.insert(txData.end(), data, data + count);
+    txFree -= count;
+}
+
+void serialBeginWrite(serialPort_t *) {}
+void serialEndWrite(serialPort_t *) {}
+
+uint32_t serialRxBytesWaiting(const serialPort_t *) { return rxData.size() - rxPos; }
+uint8_t serialRead(serialPort_t *) { return rxData[rxPos++]; }
+
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e mode, portOptions_e)
+{
+    EXPECT_EQ(MODE_RXTX, mode);
+    return &serialTestInstance;
+}
+
+void closeSerialPort(serialPort_t *) {}
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return &serialTestInstanceConfig; }
+portSharing_e determinePortSharing(const serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+bool telemetryDetermineEnabledState(portSharing_e) { return true; }
+bool telemetryCheckRxPortShared(const serialPortConfig_t *, SerialRXType) { return false; }
+
+bool sensors(uint32_t) { return false; }
+uint16_t getRssi(void) { return 0; }
+batteryState_e getBatteryState(void) { return BATTERY_NOT_PRESENT; }
+uint8_t calculateBatteryPercentageRemaining(void) { return 100; }
+bool isBatteryVoltageConfigured(void) { return false; }
+uint16_t getBatteryVoltage(void) { return 0; }
+bool isAmperageConfigured(void) { return false; }
+int32_t getAmperage(void) { return 0; }
+int32_t getMAhDrawn(void) { return 0; }
+int32_t getEstimatedAltitudeCm(void) { return 0; }
+bool failsafeIsActive(void) { return false; }
+
+void writeEEPROM(void) { eepromWrites++; }
+bool readEEPROM(void) { return true; }
+void schedulerIgnoreTaskStateTime(void) {}
+uint8_t getCurrentPidProfileIndex(void) { return 0; }
+uint8_t getCurrentControlRateProfileIndex(void) { return 0; }
+pidProfile_t *currentPidProfile;
+void pidInitConfig(const pidProfile_t *) {}
+void initRcProcessing(void) {}
+
+}
@@ -0,0 +1,189 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "telemetry/telemetry_sensors.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define MS 1000
+
+// the frame each sensor would be sent with now
+static uint8_t frames[TELEMETRY_SENSOR_COUNT][4];
+
+// A protocol slot, the due sensors with an unchanged frame give way to the next
+static telemetrySensorId_e slot(timeUs_t time, uint8_t maxSize = 64)
+{
+    telemetrySensorId_e id;
+    while ((id = telemetrySensorNext(time, maxSize)) != TELEMETRY_SENSOR_NONE) {
+        if (telemetrySensorCommit(id, time, frames[id], sizeof(frames[id]), false)) {
+            return id;
+        }
+    }
+    return TELEMETRY_SENSOR_NONE;
+}
+
+class TelemetrySensorsTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        telemetrySensorsReset();
+        memset(frames, 0, sizeof(frames));
+    }
+};
+
+TEST_F(TelemetrySensorsTest, NothingRegistered)
+{
+    EXPECT_EQ(0, telemetrySensorsRegisteredCount());
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, telemetrySensorNext(0, 64));
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, telemetrySensorStalest(0, 64));
+}
+
+TEST_F(TelemetrySensorsTest, NeverSentSensorsFirst)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_FLIGHT_MODE, 10);
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+    telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, 12);
+    EXPECT_EQ(3, telemetrySensorsRegisteredCount());
+
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(0));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(10 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_FLIGHT_MODE, slot(20 * MS));
+    // nothing due until the battery interval has passed
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(30 * MS));
+}
+
+TEST_F(TelemetrySensorsTest, MostOverdueFirst)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, 12);
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+    telemetrySensorRegister(TELEMETRY_SENSOR_GPS_EXTRA, 14);
+
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(0));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(0));
+    EXPECT_EQ(TELEMETRY_SENSOR_GPS_EXTRA, slot(0));
+
+    // all due, only the attitude changed
+    frames[TELEMETRY_SENSOR_ATTITUDE][0] = 10;
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(100 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(150 * MS));
+
+    // both changed, the battery is further past its interval
+    frames[TELEMETRY_SENSOR_BATTERY][0] = 1;
+    frames[TELEMETRY_SENSOR_ATTITUDE][0] = 20;
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(250 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(260 * MS));
+
+    // the low priority sensor waits for the higher priority one
+    frames[TELEMETRY_SENSOR_BATTERY][0] = 2;
+    frames[TELEMETRY_SENSOR_GPS_EXTRA][1] = 100;
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(1000 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_GPS_EXTRA, slot(1000 * MS));
+}
+
+TEST_F(TelemetrySensorsTest, UnchangedFrameKeptAlive)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(0));
+
+    // unchanged frames are dropped until the keepalive interval has passed
+    for (timeUs_t time = 100 * MS; time < 1000 * MS; time += 100 * MS) {
+        EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(time));
+    }
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(1000 * MS));
+
+    // a change anywhere in the frame is sent at the next interval
+    frames[TELEMETRY_SENSOR_ATTITUDE][3] = 1;
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(1050 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(1100 * MS));
+
+    telemetrySensorStats_t stats;
+    telemetrySensorGetStats(TELEMETRY_SENSOR_ATTITUDE, 1100 * MS, &stats);
+    EXPECT_EQ(3, stats.sent);
+    EXPECT_EQ(9, stats.unchanged);
+}
+
+TEST_F(TelemetrySensorsTest, IdleSlotCarriesStalestSensor)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, 12);
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+    telemetrySensorRegister(TELEMETRY_SENSOR_GPS, 20);
+
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(0));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(10 * MS));
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(20 * MS, 12));
+
+    // the never sent sensor first, then by the time since sent, only those that fit
+    EXPECT_EQ(TELEMETRY_SENSOR_GPS, telemetrySensorStalest(20 * MS, 64));
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, telemetrySensorStalest(20 * MS, 12));
+
+    // forced frames go out unchanged
+    EXPECT_TRUE(telemetrySensorCommit(TELEMETRY_SENSOR_BATTERY, 20 * MS, frames[TELEMETRY_SENSOR_BATTERY], 4, true));
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, telemetrySensorStalest(30 * MS, 12));
+    EXPECT_TRUE(telemetrySensorCommit(TELEMETRY_SENSOR_ATTITUDE, 30 * MS, frames[TELEMETRY_SENSOR_ATTITUDE], 4, true));
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, telemetrySensorStalest(40 * MS, 12));
+
+    telemetrySensorStats_t stats;
+    telemetrySensorGetStats(TELEMETRY_SENSOR_BATTERY, 40 * MS, &stats);
+    EXPECT_EQ(2, stats.sent);
+}
+
+TEST_F(TelemetrySensorsTest, SensorsTooLargeAreSkipped)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_BATTERY, 20);
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+
+    EXPECT_EQ(TELEMETRY_SENSOR_ATTITUDE, slot(0, 12));
+    EXPECT_EQ(TELEMETRY_SENSOR_NONE, slot(0, 12));
+    EXPECT_EQ(TELEMETRY_SENSOR_BATTERY, slot(0, 20));
+}
+
+TEST_F(TelemetrySensorsTest, EffectiveRate)
+{
+    telemetrySensorRegister(TELEMETRY_SENSOR_ATTITUDE, 10);
+
+    telemetrySensorStats_t stats;
+    timeUs_t time;
+    for (time = 0; time <= 3000 * MS; time += 50 * MS) {
+        frames[TELEMETRY_SENSOR_ATTITUDE][0] = time / MS;
+        slot(time);
+    }
+    telemetrySensorGetStats(TELEMETRY_SENSOR_ATTITUDE, time, &stats);
+    EXPECT_TRUE(stats.registered);
+    EXPECT_EQ(10, stats.size);
+    EXPECT_EQ(31, stats.sent);
+    EXPECT_EQ(1000, stats.rateCentiHz);
+
+    // no rate once the sensor stops being sent
+    telemetrySensorGetStats(TELEMETRY_SENSOR_ATTITUDE, time + 5000 * MS, &stats);
+    EXPECT_EQ(0, stats.rateCentiHz);
+
+    telemetrySensorGetStats(TELEMETRY_SENSOR_BATTERY, time, &stats);
+    EXPECT_FALSE(stats.registered);
+    EXPECT_EQ(0, stats.sent);
+}
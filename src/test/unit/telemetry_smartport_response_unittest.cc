@@ -0,0 +1,190 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/serial.h"
+
+    #include "rx/frsky_crc.h"
+
+    #include "telemetry/smartport.h"
+    #include "telemetry/smartport_response.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static serialPort_t testPort;
+static std::vector<uint8_t> sent;
+static int writes;
+
+class SmartPortResponseTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        smartPortResponseInit();
+        sent.clear();
+        writes = 0;
+    }
+};
+
+static void armFrame(uint16_t valueId)
+{
+    smartPortResponseStart();
+    smartPortResponseWrite(FSSP_DATA_FRAME, NULL);
+    smartPortResponseWrite(valueId & 0xff, NULL);
+    smartPortResponseWrite(valueId >> 8, NULL);
+    smartPortResponseArm(valueId);
+}
+
+static const smartPortResponseStats_t *findStats(uint16_t valueId)
+{
+    const smartPortResponseStats_t *stats;
+    for (unsigned i = 0; (stats = smartPortResponseGetStats(i)); i++) {
+        if (stats->valueId == valueId) {
+            return stats;
+        }
+    }
+    return NULL;
+}
+
+TEST_F(SmartPortResponseTest, SendsArmedFrameEscaped)
+{
+    uint16_t checksum = 0;
+    smartPortResponseStart();
+    smartPortResponseWrite(FSSP_START_STOP, &checksum);
+    smartPortResponseWrite(FSSP_DLE, &checksum);
+    smartPortResponseWrite(0x10, &checksum);
+    EXPECT_FALSE(smartPortResponseIsArmed());
+    smartPortResponseArm(0x0210);
+    EXPECT_TRUE(smartPortResponseIsArmed());
+
+    uint16_t expectedChecksum = 0;
+    frskyCheckSumStep(&expectedChecksum, FSSP_START_STOP);
+    frskyCheckSumStep(&expectedChecksum, FSSP_DLE);
+    frskyCheckSumStep(&expectedChecksum, 0x10);
+    EXPECT_EQ(expectedChecksum, checksum);
+
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+    const std::vector<uint8_t> expected = { FSSP_DLE, FSSP_START_STOP ^ FSSP_DLE_XOR, FSSP_DLE, FSSP_DLE ^ FSSP_DLE_XOR, 0x10 };
+    EXPECT_EQ(expected, sent);
+    EXPECT_EQ(1, writes);
+    EXPECT_FALSE(smartPortResponseIsArmed());
+
+    const smartPortResponseStats_t *stats = findStats(0x0210);
+    ASSERT_NE(nullptr, stats);
+    EXPECT_EQ(1, stats->hits);
+    EXPECT_EQ(0, stats->misses);
+}
+
+TEST_F(SmartPortResponseTest, MissesWithNothingArmedAreChargedToTheNextFrame)
+{
+    armFrame(0x0210);
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+
+    // two polls find nothing armed, a response window expires before the frame is built
+    EXPECT_FALSE(smartPortResponseSend(&testPort));
+    EXPECT_FALSE(smartPortResponseSend(&testPort));
+    smartPortResponseMiss();
+    EXPECT_EQ(1, writes);
+
+    armFrame(0x0200);
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+
+    EXPECT_EQ(0, findStats(0x0210)->misses);
+    EXPECT_EQ(3, findStats(0x0200)->misses);
+    EXPECT_EQ(1, findStats(0x0200)->hits);
+
+    // and only once
+    armFrame(0x0200);
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+    EXPECT_EQ(3, findStats(0x0200)->misses);
+    EXPECT_EQ(2, findStats(0x0200)->hits);
+}
+
+TEST_F(SmartPortResponseTest, LateWindowIsChargedToTheArmedFrame)
+{
+    armFrame(0x0210);
+
+    // the window of the poll the frame was armed for has passed
+    smartPortResponseMiss();
+    EXPECT_TRUE(smartPortResponseIsArmed());
+    EXPECT_EQ(1, findStats(0x0210)->misses);
+
+    // it answers the next poll, the frame armed after it is not charged
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+    armFrame(0x0200);
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+
+    EXPECT_EQ(1, findStats(0x0210)->misses);
+    EXPECT_EQ(1, findStats(0x0210)->hits);
+    EXPECT_EQ(0, findStats(0x0200)->misses);
+}
+
+TEST_F(SmartPortResponseTest, FrameStaysArmedUntilPolled)
+{
+    armFrame(0x0100);
+    armFrame(0x0100);
+    EXPECT_TRUE(smartPortResponseIsArmed());
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+    EXPECT_FALSE(smartPortResponseSend(&testPort));
+    EXPECT_EQ(1, writes);
+}
+
+TEST_F(SmartPortResponseTest, SendsWhenStatsAreFull)
+{
+    for (int i = 0; i < SMARTPORT_RESPONSE_STATS_COUNT + 2; i++) {
+        armFrame(0x0400 + i);
+        EXPECT_TRUE(smartPortResponseSend(&testPort));
+    }
+    EXPECT_EQ(SMARTPORT_RESPONSE_STATS_COUNT + 2, writes);
+    EXPECT_NE(nullptr, smartPortResponseGetStats(SMARTPORT_RESPONSE_STATS_COUNT - 1));
+    EXPECT_EQ(nullptr, smartPortResponseGetStats(SMARTPORT_RESPONSE_STATS_COUNT));
+    EXPECT_EQ(nullptr, findStats(0x0400 + SMARTPORT_RESPONSE_STATS_COUNT));
+}
+
+TEST_F(SmartPortResponseTest, ProtectsFrameBuffer)
+{
+    smartPortResponseStart();
+    for (int i = 0; i < SMARTPORT_RESPONSE_FRAME_SIZE_MAX; i++) {
+        smartPortResponseWrite(FSSP_DLE, NULL);
+    }
+    smartPortResponseArm(SMARTPORT_RESPONSE_ID_OTHER);
+    EXPECT_TRUE(smartPortResponseSend(&testPort));
+    EXPECT_EQ((size_t)SMARTPORT_RESPONSE_FRAME_SIZE_MAX, sent.size());
+}
+
+// STUBS
+
+extern "C" {
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    EXPECT_EQ(&testPort, instance);
+    sent.insert(sent.end(), data, data + count);
+    writes++;
+}
+
+}
@@ -0,0 +1,326 @@
+/*
+ * This file is part of Betaflight.
+ *
+ * Betaflight is free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Betaflight is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <initializer_list>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "drivers/serial.h"
+
+    #include "fc/controlrate_profile.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+    #include "flight/pid.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/esc_sensor.h"
+    #include "sensors/sensors.h"
+
+    #include "telemetry/smartport.h"
+    #include "telemetry/smartport_response.h"
+    #include "telemetry/telemetry.h"
+
+    void initSmartPortSensors(void);
+
+    PG_REGISTER(telemetryConfig_t, telemetryConfig, PG_TELEMETRY_CONFIG, 0);
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FSSP_DATAID_VFAS        0x0210
+#define FSSP_DATAID_A4          0x0910
+#define FSSP_DATAID_HEADING     0x0840
+#define FSSP_DATAID_LATLONG     0x0800
+
+extern "C" {
+    uint8_t armingFlags = 0;
+    uint8_t stateFlags = 0;
+    uint16_t flightModeFlags = 0;
+    attitudeEulerAngles_t attitude = EULER_INITIALIZE;
+    acc_t acc;
+    gpsSolutionData_t gpsSol;
+    uint16_t GPS_distanceToHome;
+    pidProfile_t *currentPidProfile;
+    controlRateConfig_t *currentControlRateProfile;
+}
+
+static timeUs_t fakeMicros;
+static uint32_t enabledSensors;
+
+static serialPort_t testPort;
+static serialReceiveCallbackPtr receiveCallback;
+static std::vector<uint8_t> written;
+static int writes;
+
+// the frames answered to the polls
+static std::vector<smartPortPayload_t> frames;
+
+static void receive(std::initializer_list<uint8_t> bytes)
+{
+    for (uint8_t c : bytes) {
+        receiveCallback(c, NULL);
+    }
+}
+
+static void decodeWritten(void)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i < written.size(); i++) {
+        bytes.push_back(written[i] == FSSP_DLE ? written[++i] ^ FSSP_DLE_XOR : written[i]);
+    }
+    written.clear();
+
+    ASSERT_EQ(sizeof(smartPortPayload_t) + 1, bytes.size());
+    smartPortPayload_t payload;
+    memcpy(&payload, bytes.data(), sizeof(payload));
+    frames.push_back(payload);
+}
+
+// builds the next frame as the task does, and polls for it
+static void runSlot(void)
+{
+    bool clearToSend = !smartPortResponseIsArmed();
+    processSmartPortTelemetry(NULL, &clearToSend, NULL);
+
+    receive({ FSSP_START_STOP, FSSP_SENSOR_ID1 });
+    if (!written.empty()) {
+        decodeWritten();
+    }
+}
+
+class SmartPortTelemetryTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        fakeMicros = 1000000;
+        enabledSensors = 0;
+        stateFlags = 0;
+        attitude.values.yaw = 0;
+        written.clear();
+        writes = 0;
+        frames.clear();
+    }
+
+    void init(uint32_t sensors) {
+        enabledSensors = sensors;
+        initSmartPortTelemetry();
+        checkSmartPortTelemetryState();
+        ASSERT_NE(nullptr, receiveCallback);
+        // the tables of the sensors are built again for each test
+        initSmartPortSensors();
+        smartPortResponseInit();
+    }
+};
+
+TEST_F(SmartPortTelemetryTest, SendsEachValueOfASensorInTurn)
+{
+    // given
+    init(SENSOR_VOLTAGE | SENSOR_HEADING);
+
+    // when
+    for (int i = 0; i < 3; i++) {
+        runSlot();
+    }
+
+    // then the battery values go out before the attitude, as its priority is higher
+    ASSERT_EQ(3u, frames.size());
+    EXPECT_EQ(FSSP_DATA_FRAME, frames[0].frameId);
+    EXPECT_EQ(FSSP_DATAID_VFAS, frames[0].valueId);
+    EXPECT_EQ(FSSP_DATAID_A4, frames[1].valueId);
+    EXPECT_EQ(FSSP_DATAID_HEADING, frames[2].valueId);
+}
+
+TEST_F(SmartPortTelemetryTest, UnchangedSensorGivesWay)
+{
+    // given both sensors sent
+    init(SENSOR_VOLTAGE | SENSOR_HEADING);
+    for (int i = 0; i < 3; i++) {
+        runSlot();
+    }
+    frames.clear();
+
+    // when only the heading changes by the next interval
+    attitude.values.yaw = 900;
+    fakeMicros += 100000;
+    runSlot();
+
+    // then the battery gives way to it
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(FSSP_DATAID_HEADING, frames[0].valueId);
+    EXPECT_EQ(9000u, frames[0].data);
+}
+
+TEST_F(SmartPortTelemetryTest, SendsLatitudeThenLongitude)
+{
+    // given
+    stateFlags = GPS_FIX;
+    gpsSol.llh.lat = 500000000;
+    gpsSol.llh.lon = -10000000;
+    init(SENSOR_LAT_LONG);
+
+    // when
+    runSlot();
+    runSlot();
+
+    // then the same id carries both, the longitude flagged by the MSB
+    ASSERT_EQ(2u, frames.size());
+    EXPECT_EQ(FSSP_DATAID_LATLONG, frames[0].valueId);
+    EXPECT_EQ(30000000u, frames[0].data);
+    EXPECT_EQ(FSSP_DATAID_LATLONG, frames[1].valueId);
+    EXPECT_EQ(0x80000000u | 0x40000000u | 600000u, frames[1].data);
+}
+
+TEST_F(SmartPortTelemetryTest, NothingSentWithoutAValue)
+{
+    // given the position enabled, but no fix
+    init(SENSOR_LAT_LONG);
+
+    // when
+    runSlot();
+
+    // then
+    EXPECT_EQ(0u, frames.size());
+}
+
+TEST_F(SmartPortTelemetryTest, PollIsAnsweredOnItsSensorId)
+{
+    // given
+    init(SENSOR_VOLTAGE);
+    bool clearToSend = true;
+    processSmartPortTelemetry(NULL, &clearToSend, NULL);
+    EXPECT_FALSE(clearToSend);
+    EXPECT_TRUE(smartPortResponseIsArmed());
+
+    // when another sensor is polled
+    receive({ FSSP_START_STOP, FSSP_SENSOR_ID3 });
+
+    // then
+    EXPECT_EQ(0, writes);
+    EXPECT_TRUE(smartPortResponseIsArmed());
+
+    // when ours is polled, the frame goes out as the id is received
+    receive({ FSSP_START_STOP });
+    EXPECT_EQ(0, writes);
+    receive({ FSSP_SENSOR_ID1 });
+
+    // then
+    EXPECT_EQ(1, writes);
+    EXPECT_FALSE(smartPortResponseIsArmed());
+    decodeWritten();
+    EXPECT_EQ(FSSP_DATAID_VFAS, frames[0].valueId);
+    EXPECT_EQ(1680u, frames[0].data);
+    EXPECT_EQ(1u, smartPortResponseGetStats(0)->hits);
+}
+
+TEST_F(SmartPortTelemetryTest, PollsFindingNothingArmedAreMissesOfTheNextFrame)
+{
+    // given
+    init(SENSOR_VOLTAGE);
+
+    // when polled twice before the task builds a frame
+    receive({ FSSP_START_STOP, FSSP_SENSOR_ID1 });
+    receive({ FSSP_START_STOP, FSSP_SENSOR_ID1 });
+    EXPECT_EQ(0, writes);
+    runSlot();
+    runSlot();
+
+    // then
+    ASSERT_EQ(2u, frames.size());
+    const smartPortResponseStats_t *vfas = smartPortResponseGetStats(0);
+    const smartPortResponseStats_t *a4 = smartPortResponseGetStats(1);
+    EXPECT_EQ(FSSP_DATAID_VFAS, vfas->valueId);
+    EXPECT_EQ(1u, vfas->hits);
+    EXPECT_EQ(2u, vfas->misses);
+    EXPECT_EQ(FSSP_DATAID_A4, a4->valueId);
+    EXPECT_EQ(1u, a4->hits);
+    EXPECT_EQ(0u, a4->misses);
+}
+
+// STUBS
+
+extern "C" {
+
+timeUs_t micros(void) { return fakeMicros; }
+timeMs_t millis(void) { return fakeMicros / 1000; }
+
+bool telemetryIsSensorEnabled(sensor_e sensor) { return enabledSensors & sensor; }
+bool featureIsEnabled(const uint32_t mask) { return mask == FEATURE_GPS; }
+bool sensors(uint32_t mask) { UNUSED(mask); return false; }
+
+bool isBatteryVoltageConfigured(void) { return true; }
+bool isAmperageConfigured(void) { return false; }
+uint16_t getBatteryVoltage(void) { return 1680; }
+uint16_t getBatteryAverageCellVoltage(void) { return 420; }
+int32_t getAmperage(void) { return 0; }
+int32_t getMAhDrawn(void) { return 0; }
+uint8_t calculateBatteryPercentageRemaining(void) { return 0; }
+int32_t getEstimatedAltitudeCm(void) { return 0; }
+int16_t getEstimatedVario(void) { return 0; }
+
+bool isArmingDisabled(void) { return false; }
+uint8_t getMotorCount(void) { return 4; }
+escSensorData_t *getEscSensorData(uint8_t motorNumber) { UNUSED(motorNumber); return NULL; }
+float erpmToRpm(uint32_t erpm) { return erpm; }
+
+const serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    static serialPortConfig_t portConfig;
+    portConfig.identifier = SERIAL_PORT_USART1;
+    portConfig.functionMask = function;
+    return &portConfig;
+}
+portSharing_e determinePortSharing(const serialPortConfig_t *portConfig, serialPortFunction_e function) { UNUSED(portConfig); UNUSED(function); return PORTSHARING_UNUSED; }
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr callback, void *, uint32_t, portMode_e, portOptions_e)
+{
+    receiveCallback = callback;
+    return &testPort;
+}
+void closeSerialPort(serialPort_t *serialPort) { UNUSED(serialPort); }
+void serialSetIdleCallback(serialPort_t *serialPort, serialIdleCallbackPtr cb) { serialPort->idleCallback = cb; }
+bool telemetryDetermineEnabledState(portSharing_e portSharing) { UNUSED(portSharing); return true; }
+uint32_t serialRxBytesWaiting(const serialPort_t *instance) { UNUSED(instance); return 0; }
+uint8_t serialRead(serialPort_t *instance) { UNUSED(instance); return 0; }
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    EXPECT_EQ(&testPort, instance);
+    written.insert(written.end(), data, data + count);
+    writes++;
+}
+
+}
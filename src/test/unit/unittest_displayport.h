@@ -116,7 +116,7 @@ static int displayportWriteSys(displayPort_t *displayPort, uint8_t x, uint8_t y,
 static uint32_t displayPortTestTxBytesFree(const displayPort_t *displayPort)
 {
     UNUSED(displayPort);
-    return 0;
+    return UINT32_MAX;
 }
 
 static const displayPortVTable_t testDisplayPortVTable = {
@@ -21,10 +21,13 @@
 
 extern "C" {
     #include "build/build_config.h"
+    #include "build/debug.h"
 
     #include "common/color.h"
 
     #include "drivers/light_ws2811strip.h"
+
+    #include "io/ledstrip.h"
 }
 
 #include "unittest_macros.h"
@@ -36,8 +39,13 @@ extern "C" {
     void updateLEDDMABuffer(ledStripFormatRGB_e ledFormat, rgbColor24bpp_t *color, unsigned ledIndex);
     void schedulerIgnoreTaskExecTime(void) {}
     void schedulerIgnoreTaskStateTime(void) {}
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
 }
 
+static int hsvConversions;
+
 TEST(WS2812, updateDMABuffer)
 {
     // given
@@ -80,11 +88,74 @@ TEST(WS2812, updateDMABuffer)
     byteIndex++;
 }
 
+TEST(WS2812, updateStripOnlyEncodesChangedLeds)
+{
+    // given
+    debugMode = DEBUG_LED_STRIP;
+    ws2811LedStripInit(IO_TAG_NONE);
+    ws2811LedStripEnable();
+    ws2811LedDataTransferInProgress = false;
+
+    setUsedLedCount(3);
+    const hsvColor_t red = { 0, 0, 255 };
+    setStripColor(&red);
+
+    // when
+    hsvConversions = 0;
+    EXPECT_TRUE(ws2811UpdateStrip(LED_GRB, 100));
+    ws2811LedDataTransferInProgress = false;
+
+    // then
+    // changing the LED count refreshes the whole strip, but red and black are only converted once each
+    EXPECT_EQ(WS2811_DATA_BUFFER_SIZE, debug[DEBUG_LED_STRIP_ENCODED]);
+    EXPECT_EQ(2, hsvConversions);
+
+    // when
+    const hsvColor_t dim = { 0, 0, 0x55 };
+    setLedHsv(1, &dim);
+    hsvConversions = 0;
+    EXPECT_TRUE(ws2811UpdateStrip(LED_GRB, 100));
+    ws2811LedDataTransferInProgress = false;
+
+    // then
+    EXPECT_EQ(1, debug[DEBUG_LED_STRIP_ENCODED]);
+    EXPECT_EQ(1, hsvConversions);
+
+    // and the green byte of LED 1 carries the new value
+    const unsigned offset = 1 * 24;
+    for (int bit = 0; bit < 8; bit++) {
+        EXPECT_EQ((0x55 & (0x80 >> bit)) ? BIT_COMPARE_1 : BIT_COMPARE_0, ledStripDMABuffer[offset + bit]);
+    }
+
+    // when
+    hsvConversions = 0;
+    EXPECT_TRUE(ws2811UpdateStrip(LED_GRB, 100));
+    ws2811LedDataTransferInProgress = false;
+
+    // then
+    EXPECT_EQ(0, debug[DEBUG_LED_STRIP_ENCODED]);
+    EXPECT_EQ(0, hsvConversions);
+
+    // when the format changes every LED is re-encoded
+    EXPECT_TRUE(ws2811UpdateStrip(LED_RGB, 100));
+    ws2811LedDataTransferInProgress = false;
+
+    // then
+    EXPECT_EQ(WS2811_DATA_BUFFER_SIZE, debug[DEBUG_LED_STRIP_ENCODED]);
+}
+
 extern "C" {
+// Map the colour straight through so the encoded bits can be checked: green = value
 rgbColor24bpp_t* hsvToRgb24(const hsvColor_t *c)
 {
-    UNUSED(c);
-    return NULL;
+    static rgbColor24bpp_t rgb;
+
+    hsvConversions++;
+    rgb.rgb.r = c->s;
+    rgb.rgb.g = c->v;
+    rgb.rgb.b = c->h;
+
+    return &rgb;
 }
 
 bool ws2811LedStripHardwareInit(ioTag_t ioTag)